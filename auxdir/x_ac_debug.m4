@@ -7,8 +7,8 @@
 #
 #  DESCRIPTION:
 #    Add support for the "--enable-debug", "--enable-memory-leak-debug",
-#    "--disable-partial-attach", "--enable-front-end", and "--enable-developer"
-#    configure script options.
+#    "--disable-partial-attach", "--enable-front-end", "--enable-developer"
+#    and "--enable-usdt" configure script options.
 #
 #    options.
 #    If debugging is enabled, CFLAGS will be prepended with the debug flags.
@@ -154,6 +154,25 @@ AC_DEFUN([X_AC_DEBUG], [
     AC_MSG_RESULT([no])
   fi
 
+  AC_MSG_CHECKING([whether USDT probe points are enabled])
+  AC_ARG_ENABLE(
+    [usdt],
+    AS_HELP_STRING(--enable-usdt,compile in USDT probe points for SystemTap and bpftrace (needs sys/sdt.h)),
+    [ case "$enableval" in
+        yes) x_ac_usdt=yes ;;
+         no) x_ac_usdt=no ;;
+          *) AC_MSG_RESULT([doh!])
+             AC_MSG_ERROR([bad value "$enableval" for --enable-usdt]) ;;
+      esac
+    ]
+  )
+  AC_MSG_RESULT([${x_ac_usdt=no}])
+  if test "$x_ac_usdt" = yes; then
+    AC_CHECK_HEADER([sys/sdt.h],
+      [AC_DEFINE(HAVE_USDT, 1, [Define to 1 to compile in USDT probe points.])],
+      [AC_MSG_ERROR([--enable-usdt requires sys/sdt.h])])
+  fi
+
   if test "$x_ac_optimizations" = no; then
     test "$GCC" = yes && CFLAGS="$CFLAGS -O0"
   fi
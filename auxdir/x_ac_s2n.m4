@@ -64,6 +64,10 @@ AC_DEFUN([X_AC_S2N], [
       else
         S2N_LDFLAGS="-L$x_ac_cv_s2n_dir/$bit"
       fi
+      _x_ac_s2n_libs_save="$LIBS"
+      LIBS="$S2N_LDFLAGS $S2N_LIBS $LIBS"
+      AC_CHECK_FUNCS([s2n_connection_ktls_enable_send])
+      LIBS="$_x_ac_s2n_libs_save"
     fi
 
     AC_SUBST(S2N_LIBS)
@@ -0,0 +1,973 @@
+/*****************************************************************************\
+ *  ctld_bench.c - Generate and replay slurmctld RPC and workload traces
+ *****************************************************************************
+ *  Copyright (C) SchedMD LLC.
+ *
+ *  This file is part of Slurm, a resource management program.
+ *  For details, see <https://slurm.schedmd.com/>.
+ *  Please also read the included file: DISCLAIMER.
+ *
+ *  Slurm is free software; you can redistribute it and/or modify it under
+ *  the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the License, or (at your option)
+ *  any later version.
+ *
+ *  In addition, as a special exception, the copyright holders give permission
+ *  to link the code of portions of this program with the OpenSSL library under
+ *  certain conditions as described in each individual source file, and
+ *  distribute linked combinations including the two. You must obey the GNU
+ *  General Public License in all respects for all of the code used other than
+ *  OpenSSL. If you modify file(s) with this exception, you may extend this
+ *  exception to your version of the file(s), but you are not obligated to do
+ *  so. If you do not wish to do so, delete this exception statement from your
+ *  version.  If you delete this exception statement from all source files in
+ *  the program, then also delete it here.
+ *
+ *  Slurm is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with Slurm; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA.
+\*****************************************************************************/
+
+#include "config.h"
+
+#include <getopt.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "slurm/slurm.h"
+#include "slurm/slurm_errno.h"
+
+#include "src/common/log.h"
+#include "src/common/macros.h"
+#include "src/common/msg_type.h"
+#include "src/common/parse_time.h"
+#include "src/common/slurm_protocol_defs.h"
+#include "src/common/xmalloc.h"
+#include "src/common/xstring.h"
+
+#define MIX_FILE_HEADER "# ctld_bench mix v1"
+
+typedef enum {
+	OP_SUBMIT,
+	OP_JOBS,
+	OP_STEPS,
+	OP_NODES,
+	OP_PARTS,
+	OP_PING,
+	OP_STATS,
+	OP_CNT
+} op_type_t;
+
+/* RPC types generated by each operation, used to map recorded mixes */
+static const struct {
+	const char *name;
+	const char *rpcs[4];
+} ops[OP_CNT] = {
+	[OP_SUBMIT] = { "submit", { "REQUEST_SUBMIT_BATCH_JOB" } },
+	[OP_JOBS] = { "jobs", { "REQUEST_JOB_INFO", "REQUEST_JOB_USER_INFO",
+				"REQUEST_JOB_INFO_SINGLE" } },
+	[OP_STEPS] = { "steps", { "REQUEST_JOB_STEP_INFO" } },
+	[OP_NODES] = { "nodes", { "REQUEST_NODE_INFO",
+				  "REQUEST_NODE_INFO_SINGLE" } },
+	[OP_PARTS] = { "parts", { "REQUEST_PARTITION_INFO" } },
+	[OP_PING] = { "ping", { "REQUEST_PING" } },
+	[OP_STATS] = { "stats", { "REQUEST_STATS_INFO" } },
+};
+
+typedef struct {
+	uint32_t *usec;
+	uint32_t cnt;
+	uint32_t size;
+	uint32_t fail;
+} op_stats_t;
+
+/* One job from a workload trace */
+typedef struct {
+	time_t submit;		/* submit time, later offset from first job */
+	uint32_t run_secs;	/* elapsed time of the original job */
+	uint32_t limit_mins;	/* time limit or NO_VAL */
+	uint32_t nodes;		/* node count or NO_VAL */
+	uint32_t cpus;		/* CPU count or NO_VAL */
+} trace_job_t;
+
+typedef struct {
+	pthread_t tid;
+	unsigned int seed;
+	op_stats_t stats[OP_CNT];
+} worker_t;
+
+static struct {
+	int duration;
+	bool keep;
+	char *mix;
+	char *partition;
+	double rate;
+	char *record_file;
+	char *replay_file;
+	bool reset;
+	double scale;
+	int threads;
+	char *trace_file;
+} params = {
+	.duration = 60,
+	.scale = 1.0,
+	.threads = 4,
+};
+
+static uint32_t weights[OP_CNT];
+static uint64_t weight_total = 0;
+static struct timespec end_time;
+static volatile sig_atomic_t stop = 0;
+
+static uint32_t *submitted = NULL;
+static uint32_t submitted_cnt = 0, submitted_size = 0;
+static pthread_mutex_t submitted_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static void _usage(void)
+{
+	printf("\
+Usage: ctld_bench [OPTIONS]\n\
+  -d, --duration=secs     length of the run or recording (default 60)\n\
+  -k, --keep              do not cancel submitted jobs at the end\n\
+  -m, --mix=op:weight,... synthetic mix of submit, jobs, steps, nodes,\n\
+                          parts, ping and stats (default jobs:50,nodes:20,\n\
+                          parts:10,steps:10,submit:5,ping:5)\n\
+  -p, --partition=name    partition for submitted jobs\n\
+  -R, --rate=ops          target total rate in operations per second\n\
+                          (default as fast as possible)\n\
+  -r, --record=file       record the RPC mix seen by slurmctld to file\n\
+  -P, --replay=file       replay a recorded mix at its recorded rate\n\
+      --reset             reset slurmctld statistics before the run\n\
+  -s, --scale=factor      multiply the replayed rate by factor\n\
+  -t, --threads=count     concurrent client threads (default 4)\n\
+  -T, --trace=file        submit the jobs of a workload trace (sacct -P\n\
+                          with Submit, Elapsed, Timelimit, NNodes and NCPUS)\n\
+                          with submit and run times divided by --scale\n\
+  -h, --help              show this message\n");
+}
+
+static void _parse_args(int argc, char **argv)
+{
+	static struct option long_options[] = {
+		{ "duration", required_argument, 0, 'd' },
+		{ "help", no_argument, 0, 'h' },
+		{ "keep", no_argument, 0, 'k' },
+		{ "mix", required_argument, 0, 'm' },
+		{ "partition", required_argument, 0, 'p' },
+		{ "rate", required_argument, 0, 'R' },
+		{ "record", required_argument, 0, 'r' },
+		{ "replay", required_argument, 0, 'P' },
+		{ "reset", no_argument, 0, 'Z' },
+		{ "scale", required_argument, 0, 's' },
+		{ "threads", required_argument, 0, 't' },
+		{ "trace", required_argument, 0, 'T' },
+		{ NULL, 0, 0, 0 }
+	};
+	int c;
+
+	while ((c = getopt_long(argc, argv, "d:hkm:p:P:r:R:s:t:T:",
+				long_options, NULL)) != -1) {
+		switch (c) {
+		case 'd':
+			params.duration = atoi(optarg);
+			break;
+		case 'h':
+			_usage();
+			exit(0);
+		case 'k':
+			params.keep = true;
+			break;
+		case 'm':
+			params.mix = xstrdup(optarg);
+			break;
+		case 'p':
+			params.partition = xstrdup(optarg);
+			break;
+		case 'P':
+			params.replay_file = xstrdup(optarg);
+			break;
+		case 'r':
+			params.record_file = xstrdup(optarg);
+			break;
+		case 'R':
+			params.rate = strtod(optarg, NULL);
+			break;
+		case 's':
+			params.scale = strtod(optarg, NULL);
+			break;
+		case 't':
+			params.threads = atoi(optarg);
+			break;
+		case 'T':
+			params.trace_file = xstrdup(optarg);
+			break;
+		case 'Z':
+			params.reset = true;
+			break;
+		default:
+			_usage();
+			exit(1);
+		}
+	}
+
+	if ((params.duration <= 0) || (params.threads <= 0) ||
+	    (params.rate < 0) || (params.scale <= 0))
+		fatal("--duration, --threads and --scale must be positive");
+	if ((!!params.mix + !!params.replay_file + !!params.trace_file) > 1)
+		fatal("--mix, --replay and --trace are mutually exclusive");
+}
+
+static void _on_signal(int sig)
+{
+	stop = 1;
+}
+
+static uint64_t _elapsed_usec(const struct timespec *start,
+			      const struct timespec *end)
+{
+	return ((end->tv_sec - start->tv_sec) * USEC_IN_SEC) +
+		((end->tv_nsec - start->tv_nsec) / NSEC_IN_USEC);
+}
+
+static stats_info_response_msg_t *_get_stats(void)
+{
+	stats_info_request_msg_t req = { .command_id = STAT_COMMAND_GET };
+	stats_info_response_msg_t *buf = NULL;
+
+	if (slurm_get_statistics(&buf, &req))
+		fatal("slurm_get_statistics: %s", slurm_strerror(errno));
+
+	return buf;
+}
+
+static int _find_op(const char *name)
+{
+	for (int i = 0; i < OP_CNT; i++)
+		if (!xstrcasecmp(ops[i].name, name))
+			return i;
+	return -1;
+}
+
+static int _find_rpc_op(const char *rpc)
+{
+	for (int i = 0; i < OP_CNT; i++)
+		for (int j = 0; (j < ARRAY_SIZE(ops[i].rpcs)) && ops[i].rpcs[j];
+		     j++)
+			if (!xstrcmp(ops[i].rpcs[j], rpc))
+				return i;
+	return -1;
+}
+
+static void _parse_mix(const char *mix)
+{
+	char *tmp = xstrdup(mix), *save_ptr = NULL, *tok;
+
+	for (tok = strtok_r(tmp, ",", &save_ptr); tok;
+	     tok = strtok_r(NULL, ",", &save_ptr)) {
+		char *sep = strchr(tok, ':');
+		int op;
+
+		if (sep)
+			*sep++ = '\0';
+		if ((op = _find_op(tok)) < 0)
+			fatal("Unknown operation \"%s\" in --mix", tok);
+		weights[op] = sep ? strtoul(sep, NULL, 10) : 1;
+	}
+	xfree(tmp);
+}
+
+/* Write the per RPC type delta between two statistics snapshots */
+static void _record(void)
+{
+	stats_info_response_msg_t *before, *after;
+	FILE *fp;
+
+	if (!(fp = fopen(params.record_file, "w")))
+		fatal("Unable to open %s: %m", params.record_file);
+
+	before = _get_stats();
+	printf("Recording slurmctld RPC mix for %d seconds\n",
+	       params.duration);
+	for (int i = 0; (i < params.duration) && !stop; i++)
+		sleep(1);
+	after = _get_stats();
+
+	fprintf(fp, "%s\nduration %ld\n", MIX_FILE_HEADER,
+		(long) (after->req_time - before->req_time));
+	for (int i = 0; i < after->rpc_type_size; i++) {
+		uint32_t cnt = after->rpc_type_cnt[i];
+		uint64_t usec = after->rpc_type_time[i];
+
+		for (int j = 0; j < before->rpc_type_size; j++) {
+			if (before->rpc_type_id[j] != after->rpc_type_id[i])
+				continue;
+			cnt -= MIN(cnt, before->rpc_type_cnt[j]);
+			usec -= MIN(usec, before->rpc_type_time[j]);
+			break;
+		}
+		if (cnt)
+			fprintf(fp, "%s %u %"PRIu64"\n",
+				rpc_num2string(after->rpc_type_id[i]), cnt,
+				usec);
+	}
+
+	if (fclose(fp))
+		fatal("Unable to write %s: %m", params.record_file);
+	printf("Wrote %s\n", params.record_file);
+
+	slurm_free_stats_response_msg(before);
+	slurm_free_stats_response_msg(after);
+}
+
+/* Load a recorded mix, setting weights and the target rate */
+static void _load_replay(void)
+{
+	char line[256], rpc[128];
+	long duration = 0;
+	uint64_t total = 0;
+	FILE *fp;
+
+	if (!(fp = fopen(params.replay_file, "r")))
+		fatal("Unable to open %s: %m", params.replay_file);
+
+	if (!fgets(line, sizeof(line), fp) ||
+	    xstrncmp(line, MIX_FILE_HEADER, strlen(MIX_FILE_HEADER)))
+		fatal("%s is not a ctld_bench mix file", params.replay_file);
+
+	while (fgets(line, sizeof(line), fp)) {
+		uint32_t cnt;
+		int op;
+
+		if (sscanf(line, "duration %ld", &duration) == 1)
+			continue;
+		if (sscanf(line, "%127s %u", rpc, &cnt) != 2)
+			continue;
+		if ((op = _find_rpc_op(rpc)) < 0) {
+			printf("Not replaying %u %s\n", cnt, rpc);
+			continue;
+		}
+		weights[op] += cnt;
+		total += cnt;
+	}
+	fclose(fp);
+
+	if (!total)
+		fatal("%s has no replayable RPCs", params.replay_file);
+	if (!params.rate && (duration > 0))
+		params.rate = ((double) total / duration) * params.scale;
+}
+
+static void _add_sample(op_stats_t *stats, uint32_t usec)
+{
+	if (stats->cnt == stats->size) {
+		stats->size = stats->size ? (stats->size * 2) : 1024;
+		xrecalloc(stats->usec, stats->size, sizeof(*stats->usec));
+	}
+	stats->usec[stats->cnt++] = usec;
+}
+
+static void _add_submitted(uint32_t job_id)
+{
+	slurm_mutex_lock(&submitted_lock);
+	if (submitted_cnt == submitted_size) {
+		submitted_size = submitted_size ? (submitted_size * 2) : 1024;
+		xrecalloc(submitted, submitted_size, sizeof(*submitted));
+	}
+	submitted[submitted_cnt++] = job_id;
+	slurm_mutex_unlock(&submitted_lock);
+}
+
+/*
+ * Submit a held job, or a job from a workload trace which sleeps for its
+ * scaled run time
+ */
+static int _op_submit(const trace_job_t *trace)
+{
+	char *env[] = { "CTLD_BENCH=1" };
+	char *script = NULL;
+	job_desc_msg_t desc;
+	submit_response_msg_t *resp = NULL;
+	int rc;
+
+	slurm_init_job_desc_msg(&desc);
+	desc.name = "ctld_bench";
+	desc.partition = params.partition;
+	if (trace) {
+		xstrfmtcat(script, "#!/bin/sh\nsleep %.0f\n",
+			   trace->run_secs / params.scale);
+		desc.script = script;
+		if (trace->limit_mins != NO_VAL)
+			desc.time_limit =
+				MAX(trace->limit_mins / params.scale, 1);
+		desc.min_nodes = trace->nodes;
+		desc.min_cpus = trace->cpus;
+	} else {
+		desc.script = "#!/bin/sh\ntrue\n";
+		desc.priority = 0; /* held so it never runs */
+		desc.min_nodes = 1;
+		desc.time_limit = 1;
+	}
+	desc.user_id = getuid();
+	desc.group_id = getgid();
+	desc.work_dir = "/tmp";
+	desc.std_out = "/dev/null";
+	desc.environment = env;
+	desc.env_size = ARRAY_SIZE(env);
+
+	rc = slurm_submit_batch_job(&desc, &resp);
+	xfree(script);
+	if (rc)
+		return rc;
+
+	_add_submitted(resp->job_id);
+	slurm_free_submit_response_response_msg(resp);
+
+	return SLURM_SUCCESS;
+}
+
+static int _run_op(op_type_t op)
+{
+	stats_info_request_msg_t req = { .command_id = STAT_COMMAND_GET };
+	stats_info_response_msg_t *stats = NULL;
+	job_info_msg_t *jobs = NULL;
+	job_step_info_response_msg_t *steps = NULL;
+	node_info_msg_t *nodes = NULL;
+	partition_info_msg_t *parts = NULL;
+	int rc = SLURM_ERROR;
+
+	switch (op) {
+	case OP_SUBMIT:
+		rc = _op_submit(NULL);
+		break;
+	case OP_JOBS:
+		if (!(rc = slurm_load_jobs(0, &jobs, SHOW_ALL)))
+			slurm_free_job_info_msg(jobs);
+		break;
+	case OP_STEPS:
+		if (!(rc = slurm_get_job_steps(0, NO_VAL, NO_VAL, &steps,
+					       SHOW_ALL)))
+			slurm_free_job_step_info_response_msg(steps);
+		break;
+	case OP_NODES:
+		if (!(rc = slurm_load_node(0, &nodes, SHOW_ALL)))
+			slurm_free_node_info_msg(nodes);
+		break;
+	case OP_PARTS:
+		if (!(rc = slurm_load_partitions(0, &parts, SHOW_ALL)))
+			slurm_free_partition_info_msg(parts);
+		break;
+	case OP_PING:
+		rc = slurm_ping(0);
+		break;
+	case OP_STATS:
+		if (!(rc = slurm_get_statistics(&stats, &req)))
+			slurm_free_stats_response_msg(stats);
+		break;
+	case OP_CNT:
+		break;
+	}
+
+	return rc;
+}
+
+static op_type_t _pick_op(worker_t *worker)
+{
+	uint64_t pick = rand_r(&worker->seed) % weight_total;
+
+	for (op_type_t op = 0; op < OP_CNT; op++) {
+		if (pick < weights[op])
+			return op;
+		pick -= weights[op];
+	}
+
+	return OP_PING;
+}
+
+static bool _past(const struct timespec *ts)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return ((now.tv_sec > ts->tv_sec) ||
+		((now.tv_sec == ts->tv_sec) && (now.tv_nsec >= ts->tv_nsec)));
+}
+
+static void *_worker(void *arg)
+{
+	worker_t *worker = arg;
+	struct timespec next, start, end;
+	uint64_t interval_nsec = 0;
+
+	/* Each thread issues its share of the target rate */
+	if (params.rate > 0)
+		interval_nsec = (NSEC_IN_SEC * params.threads) / params.rate;
+	clock_gettime(CLOCK_MONOTONIC, &next);
+
+	while (!stop && !_past(&end_time)) {
+		op_type_t op = _pick_op(worker);
+
+		if (interval_nsec) {
+			next.tv_nsec += interval_nsec;
+			next.tv_sec += next.tv_nsec / NSEC_IN_SEC;
+			next.tv_nsec %= NSEC_IN_SEC;
+			clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next,
+					NULL);
+		}
+
+		clock_gettime(CLOCK_MONOTONIC, &start);
+		if (_run_op(op))
+			worker->stats[op].fail++;
+		clock_gettime(CLOCK_MONOTONIC, &end);
+		_add_sample(&worker->stats[op], _elapsed_usec(&start, &end));
+	}
+
+	return NULL;
+}
+
+static int _cmp_u32(const void *a, const void *b)
+{
+	uint32_t x = *(const uint32_t *) a, y = *(const uint32_t *) b;
+
+	return (x > y) - (x < y);
+}
+
+static uint32_t _percentile(op_stats_t *stats, int pct)
+{
+	uint32_t inx;
+
+	if (!stats->cnt)
+		return 0;
+	inx = ((uint64_t) stats->cnt * pct) / 100;
+	return stats->usec[MIN(inx, stats->cnt - 1)];
+}
+
+static void _print_client_stats(worker_t *workers, uint64_t run_usec)
+{
+	uint64_t total = 0;
+
+	printf("\nClient latency (usec):\n");
+	printf("%-8s %10s %8s %10s %10s %10s %10s %10s\n", "op", "count",
+	       "failed", "ops/sec", "p50", "p90", "p99", "max");
+
+	for (int op = 0; op < OP_CNT; op++) {
+		op_stats_t all = { 0 };
+
+		for (int i = 0; i < params.threads; i++) {
+			op_stats_t *s = &workers[i].stats[op];
+
+			for (int j = 0; j < s->cnt; j++)
+				_add_sample(&all, s->usec[j]);
+			all.fail += s->fail;
+		}
+		if (!all.cnt)
+			continue;
+
+		qsort(all.usec, all.cnt, sizeof(*all.usec), _cmp_u32);
+		printf("%-8s %10u %8u %10.1f %10u %10u %10u %10u\n",
+		       ops[op].name, all.cnt, all.fail,
+		       (all.cnt * (double) USEC_IN_SEC) / run_usec,
+		       _percentile(&all, 50), _percentile(&all, 90),
+		       _percentile(&all, 99), all.usec[all.cnt - 1]);
+		total += all.cnt;
+		xfree(all.usec);
+	}
+
+	printf("Total %"PRIu64" operations in %.1f seconds, %.1f ops/sec\n",
+	       total, run_usec / (double) USEC_IN_SEC,
+	       (total * (double) USEC_IN_SEC) / run_usec);
+}
+
+static void _print_server_stats(stats_info_response_msg_t *before,
+				stats_info_response_msg_t *after)
+{
+	printf("\nslurmctld during the run:\n");
+	printf("  Server thread count: %u  Agent queue size: %u\n",
+	       after->server_thread_count, after->agent_queue_size);
+	printf("  Jobs submitted: %u\n",
+	       after->jobs_submitted - MIN(after->jobs_submitted,
+					   before->jobs_submitted));
+	printf("  Main schedule cycles: %u  last: %u usec  max: %u usec\n",
+	       after->schedule_cycle_counter -
+	       MIN(after->schedule_cycle_counter,
+		   before->schedule_cycle_counter),
+	       after->schedule_cycle_last, after->schedule_cycle_max);
+
+	if (!after->lock_stats_type_cnt ||
+	    (before->lock_stats_type_cnt != after->lock_stats_type_cnt))
+		return;
+
+	printf("\nLock statistics during the run (usec, max since reset):\n");
+	printf("  %-16s %12s %10s %10s %10s %10s\n", "lock", "count",
+	       "wait avg", "wait max", "hold avg", "hold max");
+	for (int i = 0; i < after->lock_stats_type_cnt; i++) {
+		uint64_t cnt = after->lock_stats_count[i] -
+			MIN(after->lock_stats_count[i],
+			    before->lock_stats_count[i]);
+		uint64_t wait = after->lock_stats_wait_time[i] -
+			MIN(after->lock_stats_wait_time[i],
+			    before->lock_stats_wait_time[i]);
+		uint64_t hold = after->lock_stats_hold_time[i] -
+			MIN(after->lock_stats_hold_time[i],
+			    before->lock_stats_hold_time[i]);
+
+		if (!cnt)
+			continue;
+		printf("  %-16s %12"PRIu64" %10"PRIu64" %10"PRIu64" %10"PRIu64" %10"PRIu64"\n",
+		       after->lock_stats_name[i], cnt, (wait / cnt),
+		       after->lock_stats_wait_max[i], (hold / cnt),
+		       after->lock_stats_hold_max[i]);
+	}
+}
+
+static void _cancel_submitted(void)
+{
+	uint32_t failed = 0;
+
+	for (int i = 0; i < submitted_cnt; i++)
+		if (slurm_kill_job(submitted[i], SIGKILL, 0))
+			failed++;
+	printf("Cancelled %u submitted jobs", submitted_cnt - failed);
+	if (failed)
+		printf(", %u could not be cancelled", failed);
+	printf("\n");
+}
+
+static int _cmp_trace(const void *a, const void *b)
+{
+	const trace_job_t *x = a, *y = b;
+
+	return (x->submit > y->submit) - (x->submit < y->submit);
+}
+
+static int _trace_column(char **cols, int cnt, const char *name)
+{
+	for (int i = 0; i < cnt; i++)
+		if (!xstrcasecmp(cols[i], name))
+			return i;
+	return -1;
+}
+
+static int _split_line(char *line, char **cols, int max)
+{
+	int cnt = 0;
+	char *save_ptr = NULL;
+
+	line[strcspn(line, "\n")] = '\0';
+	/* empty fields are meaningful, so do not use strtok_r() */
+	for (char *tok = line; tok && (cnt < max); cnt++) {
+		cols[cnt] = tok;
+		if ((save_ptr = strchr(tok, '|')))
+			*save_ptr++ = '\0';
+		tok = save_ptr;
+	}
+
+	return cnt;
+}
+
+static uint32_t _trace_count(char **cols, int inx)
+{
+	unsigned long val;
+
+	if ((inx < 0) || !cols[inx][0])
+		return NO_VAL;
+	val = strtoul(cols[inx], NULL, 10);
+	return val ? val : NO_VAL;
+}
+
+/* Load "sacct -P" output into an array of jobs sorted by submit time */
+static trace_job_t *_load_trace(uint32_t *cnt)
+{
+	char line[4096], *cols[64];
+	int ncols, submit_inx, elapsed_inx, limit_inx, nodes_inx, cpus_inx;
+	trace_job_t *jobs = NULL;
+	uint32_t size = 0;
+	FILE *fp;
+
+	*cnt = 0;
+	if (!(fp = fopen(params.trace_file, "r")))
+		fatal("Unable to open %s: %m", params.trace_file);
+
+	if (!fgets(line, sizeof(line), fp))
+		fatal("%s is empty", params.trace_file);
+	ncols = _split_line(line, cols, ARRAY_SIZE(cols));
+	submit_inx = _trace_column(cols, ncols, "Submit");
+	elapsed_inx = _trace_column(cols, ncols, "Elapsed");
+	limit_inx = _trace_column(cols, ncols, "Timelimit");
+	nodes_inx = _trace_column(cols, ncols, "NNodes");
+	if ((cpus_inx = _trace_column(cols, ncols, "NCPUS")) < 0)
+		cpus_inx = _trace_column(cols, ncols, "ReqCPUS");
+	if ((submit_inx < 0) || (elapsed_inx < 0))
+		fatal("%s needs at least Submit and Elapsed columns",
+		      params.trace_file);
+
+	while (fgets(line, sizeof(line), fp)) {
+		trace_job_t *job;
+		int secs;
+
+		if (_split_line(line, cols, ARRAY_SIZE(cols)) != ncols)
+			continue;
+		/* skip job steps, only allocations are submitted */
+		if (strchr(cols[0], '.'))
+			continue;
+
+		if (*cnt == size) {
+			size = size ? (size * 2) : 1024;
+			xrecalloc(jobs, size, sizeof(*jobs));
+		}
+		job = &jobs[*cnt];
+		if (!(job->submit = parse_time(cols[submit_inx], 0)))
+			continue;
+		secs = time_str2secs(cols[elapsed_inx]);
+		if ((secs == NO_VAL) || (secs == INFINITE))
+			continue;
+		job->run_secs = secs;
+		job->limit_mins = NO_VAL;
+		if (limit_inx >= 0) {
+			int mins = time_str2mins(cols[limit_inx]);
+
+			if ((mins != NO_VAL) && (mins != INFINITE))
+				job->limit_mins = mins;
+		}
+		job->nodes = _trace_count(cols, nodes_inx);
+		job->cpus = _trace_count(cols, cpus_inx);
+		(*cnt)++;
+	}
+	fclose(fp);
+
+	if (!*cnt)
+		fatal("%s has no usable jobs", params.trace_file);
+
+	qsort(jobs, *cnt, sizeof(*jobs), _cmp_trace);
+	for (int i = *cnt - 1; i >= 0; i--)
+		jobs[i].submit -= jobs[0].submit;
+
+	return jobs;
+}
+
+static int _cmp_time(const void *a, const void *b)
+{
+	time_t x = *(const time_t *) a, y = *(const time_t *) b;
+
+	return (x > y) - (x < y);
+}
+
+static uint32_t _find_submitted(uint32_t job_id)
+{
+	for (uint32_t i = 0; i < submitted_cnt; i++)
+		if (submitted[i] == job_id)
+			return i;
+	return NO_VAL;
+}
+
+/* Report queue wait times and utilization of the jobs submitted */
+static void _print_trace_stats(time_t start)
+{
+	job_info_msg_t *jobs = NULL;
+	node_info_msg_t *nodes = NULL;
+	time_t *waits, first = 0, last = 0;
+	uint64_t used = 0, total_cpus = 0;
+	uint32_t started = 0, pending = 0;
+
+	if (slurm_load_jobs(0, &jobs, SHOW_ALL))
+		fatal("slurm_load_jobs: %s", slurm_strerror(errno));
+	if (slurm_load_node(0, &nodes, SHOW_ALL))
+		fatal("slurm_load_node: %s", slurm_strerror(errno));
+
+	waits = xcalloc(MAX(submitted_cnt, 1), sizeof(*waits));
+	for (uint32_t i = 0; i < jobs->record_count; i++) {
+		slurm_job_info_t *job = &jobs->job_array[i];
+		time_t end;
+
+		if (_find_submitted(job->job_id) == NO_VAL)
+			continue;
+		if (!job->start_time || (job->job_state == JOB_PENDING)) {
+			pending++;
+			continue;
+		}
+		waits[started++] = (job->start_time - job->submit_time) *
+			params.scale;
+		end = ((job->job_state == JOB_RUNNING) || !job->end_time) ?
+			time(NULL) : job->end_time;
+		used += (uint64_t) job->num_cpus * (end - job->start_time);
+		if (!first || (job->start_time < first))
+			first = job->start_time;
+		if (end > last)
+			last = end;
+	}
+	for (uint32_t i = 0; i < nodes->record_count; i++)
+		total_cpus += nodes->node_array[i].cpus;
+
+	printf("\nTrace jobs: %u started, %u still pending\n", started,
+	       pending);
+	if (started) {
+		qsort(waits, started, sizeof(*waits), _cmp_time);
+		printf("Queue wait in trace seconds: p50 %ld  p90 %ld  p99 %ld  max %ld\n",
+		       (long) waits[(started * 50) / 100],
+		       (long) waits[(started * 90) / 100],
+		       (long) waits[(started * 99) / 100],
+		       (long) waits[started - 1]);
+	}
+	if (total_cpus && (last > first))
+		printf("CPU utilization while jobs ran: %.1f%% over %ld seconds (%ld since first submit)\n",
+		       (100.0 * used) / (total_cpus * (last - first)),
+		       (long) (last - first), (long) (last - start));
+
+	xfree(waits);
+	slurm_free_job_info_msg(jobs);
+	slurm_free_node_info_msg(nodes);
+}
+
+static void _run_trace(void)
+{
+	stats_info_response_msg_t *before, *after;
+	struct timespec start, now;
+	time_t start_time = time(NULL);
+	trace_job_t *jobs;
+	uint32_t cnt, failed = 0;
+
+	jobs = _load_trace(&cnt);
+	before = _get_stats();
+
+	printf("Submitting %u trace jobs spanning %ld seconds, scaled by %.1f\n",
+	       cnt, (long) jobs[cnt - 1].submit, params.scale);
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for (uint32_t i = 0; (i < cnt) && !stop; i++) {
+		uint64_t due = (jobs[i].submit * USEC_IN_SEC) / params.scale;
+		uint64_t elapsed;
+
+		clock_gettime(CLOCK_MONOTONIC, &now);
+		if ((elapsed = _elapsed_usec(&start, &now)) < due)
+			usleep(due - elapsed);
+		if (_op_submit(&jobs[i]))
+			failed++;
+	}
+	if (failed)
+		printf("%u trace jobs failed to submit\n", failed);
+
+	/* Let the scheduler work through the queue */
+	printf("Waiting up to %d seconds for jobs to run\n", params.duration);
+	for (int i = 0; (i < params.duration) && !stop; i++) {
+		job_info_msg_t *info = NULL;
+		bool active = false;
+
+		sleep(1);
+		if (slurm_load_jobs(0, &info, SHOW_ALL))
+			continue;
+		for (uint32_t j = 0; !active && (j < info->record_count); j++) {
+			slurm_job_info_t *job = &info->job_array[j];
+
+			active = (!IS_JOB_FINISHED(job) &&
+				  (_find_submitted(job->job_id) != NO_VAL));
+		}
+		slurm_free_job_info_msg(info);
+		if (!active)
+			break;
+	}
+
+	after = _get_stats();
+	_print_trace_stats(start_time);
+	printf("Backfilled jobs: %u  backfill cycles: %u  max cycle: %u usec\n",
+	       after->bf_backfilled_jobs -
+	       MIN(after->bf_backfilled_jobs, before->bf_backfilled_jobs),
+	       after->bf_cycle_counter -
+	       MIN(after->bf_cycle_counter, before->bf_cycle_counter),
+	       after->bf_cycle_max);
+	_print_server_stats(before, after);
+
+	if (submitted_cnt && !params.keep)
+		_cancel_submitted();
+	xfree(jobs);
+	xfree(submitted);
+	slurm_free_stats_response_msg(before);
+	slurm_free_stats_response_msg(after);
+}
+
+static void _run(void)
+{
+	stats_info_request_msg_t req = { .command_id = STAT_COMMAND_RESET };
+	stats_info_response_msg_t *before, *after;
+	struct timespec start, end;
+	worker_t *workers;
+
+	if (params.replay_file)
+		_load_replay();
+	else
+		_parse_mix(params.mix ? params.mix :
+			   "jobs:50,nodes:20,parts:10,steps:10,submit:5,ping:5");
+
+	for (int i = 0; i < OP_CNT; i++)
+		weight_total += weights[i];
+	if (!weight_total)
+		fatal("Operation mix is empty");
+
+	if (params.reset && slurm_reset_statistics(&req))
+		fatal("slurm_reset_statistics: %s", slurm_strerror(errno));
+
+	before = _get_stats();
+	workers = xcalloc(params.threads, sizeof(*workers));
+
+	printf("Running %d threads for %d seconds", params.threads,
+	       params.duration);
+	if (params.rate > 0)
+		printf(" at %.1f ops/sec", params.rate);
+	printf("\n");
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	end_time = start;
+	end_time.tv_sec += params.duration;
+	for (int i = 0; i < params.threads; i++) {
+		workers[i].seed = getpid() + i;
+		slurm_thread_create(&workers[i].tid, _worker, &workers[i]);
+	}
+	for (int i = 0; i < params.threads; i++)
+		slurm_thread_join(workers[i].tid);
+	clock_gettime(CLOCK_MONOTONIC, &end);
+
+	after = _get_stats();
+
+	_print_client_stats(workers, MAX(_elapsed_usec(&start, &end), 1));
+	_print_server_stats(before, after);
+
+	if (submitted_cnt && !params.keep)
+		_cancel_submitted();
+
+	for (int i = 0; i < params.threads; i++)
+		for (int op = 0; op < OP_CNT; op++)
+			xfree(workers[i].stats[op].usec);
+	xfree(workers);
+	xfree(submitted);
+	slurm_free_stats_response_msg(before);
+	slurm_free_stats_response_msg(after);
+}
+
+int main(int argc, char **argv)
+{
+	log_options_t opts = LOG_OPTS_STDERR_ONLY;
+
+	log_init(xbasename(argv[0]), opts, SYSLOG_FACILITY_USER, NULL);
+	_parse_args(argc, argv);
+	slurm_init(NULL);
+
+	signal(SIGINT, _on_signal);
+	signal(SIGTERM, _on_signal);
+
+	if (params.record_file)
+		_record();
+	else if (params.trace_file)
+		_run_trace();
+	else
+		_run();
+
+	slurm_fini();
+	return 0;
+}
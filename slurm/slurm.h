@@ -1696,6 +1696,10 @@ typedef struct job_descriptor {	/* For submit, allocate, and update requests */
 	char *script;		/* the actual job script, default NONE */
 	void *script_buf;	/* job script as mmap buf */
 	slurm_hash_t script_hash; /* hash value of script NO NOT PACK */
+	bool script_env_borrowed; /* script and environment strings point
+				   * into the RPC buffer NO NOT PACK */
+	char *script_stage_dir;	/* batch files already written by slurmctld
+				 * outside of locks DO NOT PACK */
 	uint16_t shared;	/* 2 if the job can only share nodes with other
 				 *   jobs owned by that user,
 				 * 1 if job can share nodes with other jobs,
@@ -1989,6 +1993,14 @@ typedef struct {
 	job_state_response_job_t *jobs;
 } job_state_response_msg_t;
 
+typedef struct {
+	uint64_t generation;	/* pass to the next slurm_load_jobs_delta() */
+	bool full;		/* jobs holds every job, not only changes */
+	job_info_msg_t *jobs;	/* jobs created or changed since generation */
+	uint32_t purged_cnt;	/* number of purged_job_ids */
+	uint32_t *purged_job_ids; /* jobs purged since generation */
+} job_info_delta_msg_t;
+
 typedef struct step_update_request_msg {
 	uint32_t job_id;
 	uint32_t step_id;
@@ -2833,6 +2845,7 @@ typedef struct reservation_name_msg {
 #define DEBUG_FLAG_JAG		SLURM_BIT(54) /* Job Account Gather debug */
 #define DEBUG_FLAG_CGROUP	SLURM_BIT(55) /* cgroup debug */
 #define DEBUG_FLAG_SCRIPT	SLURM_BIT(56) /* slurmscriptd debug */
+#define DEBUG_FLAG_XMALLOC	SLURM_BIT(57) /* xmalloc call site stats */
 
 #define PREEMPT_MODE_OFF	0x0000	/* disable job preemption */
 #define PREEMPT_MODE_SUSPEND	0x0001	/* suspend jobs to preempt */
@@ -2866,6 +2879,9 @@ typedef struct reservation_name_msg {
 #define PROLOG_FLAG_DEFER_BATCH	0x0020 /* defer REQUEST_BATCH_JOB_LAUNCH until prolog end on all nodes */
 #define PROLOG_FLAG_FORCE_REQUEUE_ON_FAIL 0x0040 /* always requeue job on prolog failure */
 #define PROLOG_FLAG_RUN_IN_JOB 0x0080 /* run prolog/epilog in slurmstepd */
+#define PROLOG_FLAG_PARALLEL_SCRIPTS 0x0100 /* run the scripts matched by
+					      * each Prolog/Epilog entry
+					      * concurrently */
 
 #define CONF_FLAG_OR		SLURM_BIT(0) /* SlurmdParameters=config_overrides */
 #define CONF_FLAG_SJC		SLURM_BIT(1) /* AccountingStoreFlags=job_comment */
@@ -2960,6 +2976,7 @@ typedef struct {
 	char *fed_params;       /* Federation parameters */
 	uint32_t first_job_id;	/* first slurm generated job_id to assign */
 	uint16_t fs_dampening_factor; /* dampening for Fairshare factor */
+	uint16_t getaddrinfo_cache_timeout; /* for slurm_set_addr() cache */
 	uint16_t getnameinfo_cache_timeout; /* for getnameinfo() cache*/
 	uint16_t get_env_timeout; /* timeout for srun --get-user-env option */
 	char * gres_plugins;	/* list of generic resource plugins */
@@ -3194,6 +3211,12 @@ typedef struct submit_response_msg {
 	char *job_submit_user_msg; /* job submit plugin user_msg */
 } submit_response_msg_t;
 
+typedef struct {
+	submit_response_msg_t *job_responses; /* in job request order, job_id
+					       * is 0 if the job was rejected */
+	uint32_t jobs_cnt;
+} submit_jobs_response_msg_t;
+
 /* NOTE: If setting node_addr and/or node_hostname then comma separate names
  * and include an equal number of node_names */
 typedef struct slurm_update_node_msg {
@@ -3247,10 +3270,40 @@ typedef struct slurm_step_ctx_struct slurm_step_ctx_t;
 
 #define STAT_COMMAND_RESET	0x0000
 #define STAT_COMMAND_GET	0x0001
+#define STAT_COMMAND_HISTORY	0x0002	/* GET plus history samples */
 typedef struct stats_info_request_msg {
 	uint16_t command_id;
 } stats_info_request_msg_t;
 
+/*
+ * One sample of slurmctld statistics history. Counters hold the activity
+ * within the sample interval, the other fields the value at its end.
+ */
+typedef struct {
+	time_t sample_time;		/* end of interval */
+	uint32_t schedule_cycles;
+	uint64_t schedule_cycle_sum;	/* usec */
+	uint32_t schedule_cycle_last;	/* usec */
+	uint32_t schedule_depth_sum;
+	uint32_t schedule_queue_len;
+	uint32_t bf_cycles;
+	uint64_t bf_cycle_sum;		/* usec */
+	uint32_t bf_cycle_last;		/* usec */
+	uint32_t bf_depth_sum;
+	uint32_t bf_backfilled_jobs;
+	uint32_t jobs_submitted;
+	uint32_t jobs_started;
+	uint32_t jobs_completed;
+	uint32_t jobs_canceled;
+	uint32_t jobs_failed;
+	uint32_t jobs_pending;
+	uint32_t jobs_running;
+	uint64_t rpc_count;
+	uint64_t rpc_time;		/* usec */
+	uint32_t server_thread_count;
+	uint32_t agent_queue_size;
+} stats_history_t;
+
 typedef struct stats_info_response_msg {
 	uint32_t parts_packed;
 	time_t req_time;
@@ -3323,6 +3376,36 @@ typedef struct stats_info_response_msg {
 	uint32_t rpc_dump_count;
 	uint32_t *rpc_dump_types;
 	char **rpc_dump_hostlist;
+
+	uint32_t lock_stats_hist_cnt;	/* histogram buckets per entry */
+	uint32_t lock_stats_type_cnt;	/* leading entries per lock type */
+	uint32_t lock_stats_cnt;	/* lock types plus callers */
+	char **lock_stats_name;
+	uint64_t *lock_stats_count;
+	uint64_t *lock_stats_wait_time;
+	uint64_t *lock_stats_wait_max;
+	uint64_t *lock_stats_hold_time;
+	uint64_t *lock_stats_hold_max;
+	uint32_t *lock_stats_wait_hist;	/* lock_stats_cnt * hist_cnt */
+	uint32_t *lock_stats_hold_hist;	/* lock_stats_cnt * hist_cnt */
+
+	uint32_t sched_phase_hist_cnt;	/* histogram buckets per phase */
+	uint32_t sched_phase_cnt;
+	char **sched_phase_name;
+	uint64_t *sched_phase_count;
+	uint64_t *sched_phase_time;	/* usec */
+	uint64_t *sched_phase_max;	/* usec */
+	uint32_t *sched_phase_hist;	/* sched_phase_cnt * hist_cnt */
+
+	uint32_t rpc_type_hist_cnt;	/* latency buckets per RPC type */
+	uint32_t *rpc_type_time_hist;	/* processing time,
+					 * rpc_type_size * hist_cnt */
+	uint32_t *rpc_type_wait_hist;	/* wait before processing,
+					 * rpc_type_size * hist_cnt */
+
+	uint32_t history_interval;	/* seconds per history sample */
+	uint32_t history_cnt;
+	stats_history_t *history;	/* oldest first */
 } stats_info_response_msg_t;
 
 #define TRIGGER_FLAG_PERM		0x0001
@@ -3616,6 +3699,24 @@ extern int slurm_submit_batch_job(job_desc_msg_t *job_desc_msg,
 extern int slurm_submit_batch_het_job(list_t *job_req_list,
 				      submit_response_msg_t **slurm_alloc_msg);
 
+/*
+ * slurm_submit_batch_jobs - issue one RPC to submit several independent batch
+ *			     jobs for later execution
+ * NOTE: free the response using slurm_free_submit_jobs_response_msg
+ * IN job_req_list - list of batch job requests, type job_desc_msg_t
+ * OUT resp - result of each job request
+ * RET SLURM_SUCCESS if the jobs were processed, check each job response for
+ *	its own result. Otherwise return SLURM_ERROR with errno set.
+ */
+extern int slurm_submit_batch_jobs(list_t *job_req_list,
+				   submit_jobs_response_msg_t **resp);
+
+/*
+ * slurm_free_submit_jobs_response_msg - free slurm_submit_batch_jobs() response
+ */
+extern void slurm_free_submit_jobs_response_msg(
+	submit_jobs_response_msg_t *msg);
+
 /*
  * slurm_free_submit_response_response_msg - free slurm
  *	job submit response message
@@ -4046,6 +4147,9 @@ extern void slurm_free_job_info_msg(job_info_msg_t *job_buffer_ptr);
 /* Free jobs states response message */
 extern void slurm_free_job_state_response_msg(job_state_response_msg_t *msg);
 
+/* Free job information delta response message */
+extern void slurm_free_job_info_delta_msg(job_info_delta_msg_t *msg);
+
 /*
  * slurm_free_priority_factors_response_msg - free the job priority factor
  *	information response message
@@ -4134,6 +4238,22 @@ extern int slurm_load_jobs(time_t update_time,
 			   job_info_msg_t **job_info_msg_pptr,
 			   uint16_t show_flags);
 
+/*
+ * slurm_load_jobs_delta - issue RPC to get information about the jobs of the
+ *	local cluster created, changed or purged since a job info generation
+ * IN generation - generation of an earlier response, 0 for all jobs
+ * IN/OUT resp - place to store the response pointer. If resp->full is set,
+ *	resp->jobs holds every job and any earlier job information must be
+ *	discarded, otherwise it holds only the jobs created or changed and
+ *	resp->purged_job_ids those removed since generation.
+ * IN show_flags - job filtering options
+ * RET SLURM_SUCCESS or error
+ * NOTE: free the response using slurm_free_job_info_delta_msg
+ */
+extern int slurm_load_jobs_delta(uint64_t generation,
+				 job_info_delta_msg_t **resp,
+				 uint16_t show_flags);
+
 /*
  * slurm_load_job_state - issue RPC to get state of requested jobs
  * IN job_id_count - number of jobs in job_ids pointer.
@@ -5252,6 +5372,67 @@ extern crontab_update_response_msg_t *slurm_update_crontab(uid_t uid, gid_t gid,
 
 extern int slurm_remove_crontab(uid_t uid, gid_t gid);
 
+/*****************************************************************************\
+ *      SLURM ASYNCHRONOUS QUERY FUNCTIONS
+\*****************************************************************************/
+
+/*
+ * Callback for completion of an asynchronous request
+ * IN rc - SLURM_SUCCESS or error code of the request
+ * IN resp - response message on success or NULL on error. Ownership is handed
+ *	to the callback, which must release it with the slurm_free_*() function
+ *	matching the request (e.g. slurm_free_job_info_msg()).
+ * IN arg - arbitrary pointer given when the request was queued
+ * NOTE: Callbacks run in a libslurm worker thread, see slurm_async_init().
+ *	They should not block for long and must not call slurm_async_wait() or
+ *	slurm_async_fini().
+ */
+typedef void (*slurm_async_cb_t)(int rc, void *resp, void *arg);
+
+/*
+ * slurm_async_init - Start the worker threads used for asynchronous requests.
+ *	Called automatically by the first asynchronous request when not called
+ *	explicitly.
+ * IN thread_count - number of worker threads or 0 for the default
+ * NOTE: The worker threads handle SIGALRM in the calling process.
+ */
+extern void slurm_async_init(int thread_count);
+
+/*
+ * slurm_async_wait - Wait for all queued asynchronous requests to complete
+ */
+extern void slurm_async_wait(void);
+
+/*
+ * slurm_async_fini - Wait for all queued asynchronous requests to complete and
+ *	stop the worker threads
+ */
+extern void slurm_async_fini(void);
+
+/*
+ * Queue asynchronous requests to the slurmctld of the local cluster, or
+ * working_cluster_rec when set. Requests are multiplexed over a small pool of
+ * threads, allowing many requests to be in flight without one thread per
+ * request. Federated results are not merged (SHOW_LOCAL is implied).
+ * IN cb - callback with the response (see slurm_async_cb_t)
+ * IN arg - arbitrary pointer handed to cb
+ * RET SLURM_SUCCESS if request was queued (cb will always be called) or error
+ *	(cb will never be called)
+ */
+
+/* resp is job_info_msg_t, see slurm_load_jobs() */
+extern int slurm_load_jobs_async(time_t update_time, uint16_t show_flags,
+				 slurm_async_cb_t cb, void *arg);
+/* resp is node_info_msg_t, see slurm_load_node() (SHOW_MIXED is ignored) */
+extern int slurm_load_node_async(time_t update_time, uint16_t show_flags,
+				 slurm_async_cb_t cb, void *arg);
+/* resp is partition_info_msg_t, see slurm_load_partitions() */
+extern int slurm_load_partitions_async(time_t update_time, uint16_t show_flags,
+				       slurm_async_cb_t cb, void *arg);
+/* resp is stats_info_response_msg_t, see slurm_get_statistics() */
+extern int slurm_get_statistics_async(stats_info_request_msg_t *req,
+				      slurm_async_cb_t cb, void *arg);
+
 #ifdef __cplusplus
 }
 #endif
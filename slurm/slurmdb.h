@@ -284,6 +284,7 @@ typedef enum {
 #define DB_CONN_FLAG_CLUSTER_DEL SLURM_BIT(0)
 #define DB_CONN_FLAG_ROLLBACK SLURM_BIT(1)
 #define DB_CONN_FLAG_FEDUPDATE SLURM_BIT(2)
+#define DB_CONN_FLAG_REPLICA SLURM_BIT(3)
 
 /********************************************/
 
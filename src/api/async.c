@@ -0,0 +1,419 @@
+/*****************************************************************************\
+ *  async.c - asynchronous requests to slurmctld
+ *****************************************************************************
+ *  Copyright (C) SchedMD LLC.
+ *
+ *  This file is part of Slurm, a resource management program.
+ *  For details, see <https://slurm.schedmd.com/>.
+ *  Please also read the included file: DISCLAIMER.
+ *
+ *  Slurm is free software; you can redistribute it and/or modify it under
+ *  the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the License, or (at your option)
+ *  any later version.
+ *
+ *  In addition, as a special exception, the copyright holders give permission
+ *  to link the code of portions of this program with the OpenSSL library under
+ *  certain conditions as described in each individual source file, and
+ *  distribute linked combinations including the two. You must obey the GNU
+ *  General Public License in all respects for all of the code used other than
+ *  OpenSSL. If you modify file(s) with this exception, you may extend this
+ *  exception to your version of the file(s), but you are not obligated to do
+ *  so. If you do not wish to do so, delete this exception statement from your
+ *  version.  If you delete this exception statement from all source files in
+ *  the program, then also delete it here.
+ *
+ *  Slurm is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with Slurm; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA.
+\*****************************************************************************/
+
+#include <errno.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#include "slurm/slurm.h"
+#include "slurm/slurm_errno.h"
+
+#include "src/common/fd.h"
+#include "src/common/macros.h"
+#include "src/common/read_config.h"
+#include "src/common/slurm_protocol_api.h"
+#include "src/common/slurm_protocol_defs.h"
+#include "src/common/xassert.h"
+#include "src/common/xmalloc.h"
+
+#include "src/conmgr/conmgr.h"
+
+#include "src/interfaces/select.h"
+
+#define MAGIC_ASYNC_REQ 0xa1b0c39e
+
+/*
+ * Each request is sent over its own connection as slurmctld services a single
+ * RPC per connection. The connections are handed to conmgr so waiting on the
+ * replies costs a poll() entry instead of a blocked thread.
+ */
+typedef struct {
+	int magic; /* MAGIC_ASYNC_REQ */
+	uint16_t msg_type; /* request RPC type */
+	void *data; /* request body (no pointers, released with xfree()) */
+	uint16_t resp_type; /* expected response RPC type */
+	uint16_t protocol_version;
+	bool global_auth; /* request uses SLURM_GLOBAL_AUTH_KEY */
+	slurm_addr_t *addrs; /* candidate controller addresses */
+	int addr_cnt;
+	int addr_inx; /* address currently being tried */
+	bool retry; /* try next controller once connection is closed */
+	int rc;
+	void *resp;
+	slurm_async_cb_t cb;
+	void *arg;
+} async_req_t;
+
+static pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t cond = PTHREAD_COND_INITIALIZER;
+static bool initialized = false;
+static int pending = 0;
+
+static int _connect(async_req_t *req);
+
+extern void slurm_async_init(int thread_count)
+{
+	slurm_mutex_lock(&mutex);
+	if (!initialized) {
+		conmgr_init(thread_count, 0, (conmgr_callbacks_t) {0});
+		initialized = true;
+	}
+	slurm_mutex_unlock(&mutex);
+}
+
+extern void slurm_async_wait(void)
+{
+	slurm_mutex_lock(&mutex);
+	while (pending)
+		slurm_cond_wait(&cond, &mutex);
+	slurm_mutex_unlock(&mutex);
+}
+
+extern void slurm_async_fini(void)
+{
+	slurm_async_wait();
+
+	slurm_mutex_lock(&mutex);
+	if (initialized) {
+		conmgr_fini();
+		initialized = false;
+	}
+	slurm_mutex_unlock(&mutex);
+}
+
+static void _complete(async_req_t *req)
+{
+	xassert(req->magic == MAGIC_ASYNC_REQ);
+
+	if (req->rc)
+		log_flag(NET, "%s: %s failed: %s", __func__,
+			 rpc_num2string(req->msg_type),
+			 slurm_strerror(req->rc));
+
+	req->cb(req->rc, req->resp, req->arg);
+
+	req->magic = ~MAGIC_ASYNC_REQ;
+	xfree(req->addrs);
+	xfree(req->data);
+	xfree(req);
+
+	slurm_mutex_lock(&mutex);
+	xassert(pending > 0);
+	if (!--pending)
+		slurm_cond_broadcast(&cond);
+	slurm_mutex_unlock(&mutex);
+}
+
+static void *_on_connection(conmgr_fd_t *con, void *arg)
+{
+	async_req_t *req = arg;
+	slurm_msg_t msg;
+	int rc;
+
+	xassert(req->magic == MAGIC_ASYNC_REQ);
+
+	slurm_msg_t_init(&msg);
+	msg.msg_type = req->msg_type;
+	msg.data = req->data;
+	msg.protocol_version = req->protocol_version;
+	if (req->global_auth)
+		msg.flags |= SLURM_GLOBAL_AUTH_KEY;
+	slurm_msg_set_r_uid(&msg, SLURM_AUTH_UID_ANY);
+
+	if ((rc = conmgr_queue_write_msg(con, &msg))) {
+		req->rc = rc;
+		conmgr_queue_close_fd(con);
+	} else {
+		/* replaced once the response is received */
+		req->rc = SLURM_COMMUNICATIONS_RECEIVE_ERROR;
+	}
+
+	return req;
+}
+
+static int _on_msg(conmgr_fd_t *con, slurm_msg_t *msg, void *arg)
+{
+	async_req_t *req = arg;
+
+	xassert(req->magic == MAGIC_ASYNC_REQ);
+
+	if (msg->msg_type == req->resp_type) {
+		req->rc = SLURM_SUCCESS;
+		req->resp = msg->data;
+		msg->data = NULL;
+	} else if (msg->msg_type == RESPONSE_SLURM_RC) {
+		req->rc = ((return_code_msg_t *) msg->data)->return_code;
+
+		if (((req->rc == ESLURM_IN_STANDBY_MODE) ||
+		     (req->rc == ESLURM_IN_STANDBY_USE_BACKUP)) &&
+		    ((req->addr_inx + 1) < req->addr_cnt)) {
+			log_flag(NET, "%s: SlurmctldHost[%d] is in standby, trying next",
+				 __func__, req->addr_inx);
+			req->retry = true;
+		}
+	} else {
+		req->rc = SLURM_UNEXPECTED_MSG_ERROR;
+	}
+
+	slurm_free_msg(msg);
+	conmgr_queue_close_fd(con);
+	return SLURM_SUCCESS;
+}
+
+static int _on_timeout(conmgr_fd_t *con, void *arg)
+{
+	async_req_t *req = arg;
+
+	xassert(req->magic == MAGIC_ASYNC_REQ);
+
+	req->rc = SLURM_PROTOCOL_SOCKET_IMPL_TIMEOUT;
+	return SLURM_PROTOCOL_SOCKET_IMPL_TIMEOUT;
+}
+
+static void _on_finish(conmgr_fd_t *con, void *arg)
+{
+	async_req_t *req = arg;
+
+	xassert(req->magic == MAGIC_ASYNC_REQ);
+
+	/* Only fail over when told to use another controller */
+	if (req->retry && (++req->addr_inx < req->addr_cnt)) {
+		req->retry = false;
+		if (!_connect(req))
+			return;
+	}
+
+	_complete(req);
+}
+
+static const conmgr_events_t events = {
+	.on_connection = _on_connection,
+	.on_msg = _on_msg,
+	.on_finish = _on_finish,
+	.on_read_timeout = _on_timeout,
+	.on_write_timeout = _on_timeout,
+};
+
+/* Connect to the next usable controller address and hand it to conmgr */
+static int _connect(async_req_t *req)
+{
+	int rc = SLURMCTLD_COMMUNICATIONS_CONNECTION_ERROR;
+
+	for (; req->addr_inx < req->addr_cnt; req->addr_inx++) {
+		slurm_addr_t *addr = &req->addrs[req->addr_inx];
+		int fd;
+
+		if (slurm_addr_is_unspec(addr))
+			continue;
+
+		/*
+		 * Connect synchronously (as slurm_send_recv_controller_msg()
+		 * does) so failing over to a backup controller is handled here
+		 * instead of depending on conmgr reporting a failed connect().
+		 * Only the wait for the reply is asynchronous.
+		 */
+		if ((fd = slurm_open_msg_conn(addr)) < 0) {
+			rc = errno;
+			log_flag(NET, "%s: Failed to contact SlurmctldHost[%d](%pA): %s",
+				 __func__, req->addr_inx, addr,
+				 slurm_strerror(rc));
+			continue;
+		}
+
+		if (!(rc = conmgr_process_fd(CON_TYPE_RPC, fd, fd, &events,
+					     (CON_FLAG_WATCH_READ_TIMEOUT |
+					      CON_FLAG_WATCH_WRITE_TIMEOUT),
+					     addr, sizeof(*addr), req)))
+			return SLURM_SUCCESS;
+
+		fd_close(&fd);
+	}
+
+	req->rc = rc;
+	return rc;
+}
+
+/* Resolve the addresses of the controllers requests may be sent to */
+static int _set_addrs(async_req_t *req)
+{
+	slurm_conf_t *conf;
+	uint16_t port;
+
+	if (working_cluster_rec) {
+		if (slurm_addr_is_unspec(&working_cluster_rec->control_addr))
+			slurm_set_addr(&working_cluster_rec->control_addr,
+				       working_cluster_rec->control_port,
+				       working_cluster_rec->control_host);
+
+		req->addrs = xmalloc(sizeof(*req->addrs));
+		req->addrs[0] = working_cluster_rec->control_addr;
+		req->addr_cnt = 1;
+		req->global_auth = true;
+		if (working_cluster_rec->rpc_version)
+			req->protocol_version = working_cluster_rec->rpc_version;
+		return SLURM_SUCCESS;
+	}
+
+	conf = slurm_conf_lock();
+
+	if (!conf->control_cnt || !conf->control_addr ||
+	    !conf->control_addr[0] || !conf->slurmctld_port) {
+		slurm_conf_unlock();
+		error("Unable to establish controller address");
+		return SLURMCTLD_COMMUNICATIONS_CONNECTION_ERROR;
+	}
+
+	/* same port selection as _slurm_api_get_comm_config() */
+	port = conf->slurmctld_port;
+	port += (time(NULL) + getpid()) % conf->slurmctld_port_count;
+
+	if (conf->slurmctld_addr) {
+		req->addrs = xmalloc(sizeof(*req->addrs));
+		slurm_set_addr(&req->addrs[0], port, conf->slurmctld_addr);
+		req->addr_cnt = 1;
+	} else {
+		req->addrs = xcalloc(conf->control_cnt, sizeof(*req->addrs));
+		req->addr_cnt = conf->control_cnt;
+		for (int i = 0; i < conf->control_cnt; i++)
+			if (conf->control_addr[i])
+				slurm_set_addr(&req->addrs[i], port,
+					       conf->control_addr[i]);
+	}
+
+	slurm_conf_unlock();
+	return SLURM_SUCCESS;
+}
+
+/*
+ * Queue request to slurmctld
+ * IN msg_type - request RPC type
+ * IN data - request body to copy (must not contain pointers)
+ * IN data_size - sizeof(*data)
+ * IN resp_type - RPC type of a successful response
+ * IN cb - callback on completion
+ * IN arg - arbitrary pointer handed to cb
+ * RET SLURM_SUCCESS or error
+ */
+static int _queue_request(uint16_t msg_type, const void *data, size_t data_size,
+			  uint16_t resp_type, slurm_async_cb_t cb, void *arg)
+{
+	async_req_t *req;
+	int rc;
+
+	if (!cb)
+		return EINVAL;
+
+	slurm_async_init(0);
+
+	req = xmalloc(sizeof(*req));
+	req->magic = MAGIC_ASYNC_REQ;
+	req->msg_type = msg_type;
+	req->data = xmalloc(data_size);
+	memcpy(req->data, data, data_size);
+	req->resp_type = resp_type;
+	req->protocol_version = SLURM_PROTOCOL_VERSION;
+	req->cb = cb;
+	req->arg = arg;
+
+	slurm_mutex_lock(&mutex);
+	pending++;
+	slurm_mutex_unlock(&mutex);
+
+	if ((rc = _set_addrs(req)) || (rc = _connect(req))) {
+		slurm_mutex_lock(&mutex);
+		if (!--pending)
+			slurm_cond_broadcast(&cond);
+		slurm_mutex_unlock(&mutex);
+
+		req->magic = ~MAGIC_ASYNC_REQ;
+		xfree(req->addrs);
+		xfree(req->data);
+		xfree(req);
+		return rc;
+	}
+
+	/* Starts (or restarts) the conmgr watch thread if it is not running */
+	if ((rc = conmgr_run(false)))
+		error("%s: conmgr_run() failed: %s",
+		      __func__, slurm_strerror(rc));
+
+	return SLURM_SUCCESS;
+}
+
+extern int slurm_load_jobs_async(time_t update_time, uint16_t show_flags,
+				 slurm_async_cb_t cb, void *arg)
+{
+	job_info_request_msg_t req = {
+		.last_update = update_time,
+		.show_flags = (show_flags | SHOW_LOCAL),
+	};
+
+	return _queue_request(REQUEST_JOB_INFO, &req, sizeof(req),
+			      RESPONSE_JOB_INFO, cb, arg);
+}
+
+extern int slurm_load_node_async(time_t update_time, uint16_t show_flags,
+				 slurm_async_cb_t cb, void *arg)
+{
+	node_info_request_msg_t req = {
+		.last_update = update_time,
+		.show_flags = (show_flags | SHOW_LOCAL),
+	};
+
+	if (select_g_init(0) != SLURM_SUCCESS)
+		fatal("failed to initialize node selection plugin");
+
+	return _queue_request(REQUEST_NODE_INFO, &req, sizeof(req),
+			      RESPONSE_NODE_INFO, cb, arg);
+}
+
+extern int slurm_load_partitions_async(time_t update_time, uint16_t show_flags,
+				       slurm_async_cb_t cb, void *arg)
+{
+	part_info_request_msg_t req = {
+		.last_update = update_time,
+		.show_flags = ((show_flags | SHOW_LOCAL) & ~SHOW_FEDERATION),
+	};
+
+	return _queue_request(REQUEST_PARTITION_INFO, &req, sizeof(req),
+			      RESPONSE_PARTITION_INFO, cb, arg);
+}
+
+extern int slurm_get_statistics_async(stats_info_request_msg_t *req,
+				      slurm_async_cb_t cb, void *arg)
+{
+	return _queue_request(REQUEST_STATS_INFO, req, sizeof(*req),
+			      RESPONSE_STATS_INFO, cb, arg);
+}
@@ -663,6 +663,45 @@ slurm_load_job (job_info_msg_t **job_info_msg_pptr, uint32_t job_id,
 	return rc;
 }
 
+extern int slurm_load_jobs_delta(uint64_t generation,
+				 job_info_delta_msg_t **resp,
+				 uint16_t show_flags)
+{
+	slurm_msg_t req_msg;
+	slurm_msg_t resp_msg;
+	int rc = SLURM_SUCCESS;
+	job_info_delta_request_msg_t req = {
+		.generation = generation,
+		.show_flags = show_flags,
+	};
+
+	slurm_msg_t_init(&req_msg);
+	slurm_msg_t_init(&resp_msg);
+	req_msg.msg_type = REQUEST_JOB_INFO_DELTA;
+	req_msg.data = &req;
+
+	if (slurm_send_recv_controller_msg(&req_msg, &resp_msg,
+					   working_cluster_rec) < 0)
+		return SLURM_ERROR;
+
+	switch (resp_msg.msg_type) {
+	case RESPONSE_JOB_INFO_DELTA:
+		*resp = resp_msg.data;
+		break;
+	case RESPONSE_SLURM_RC:
+		rc = ((return_code_msg_t *) resp_msg.data)->return_code;
+		slurm_free_return_code_msg(resp_msg.data);
+		if (rc)
+			slurm_seterrno_ret(rc);
+		break;
+	default:
+		slurm_seterrno_ret(SLURM_UNEXPECTED_MSG_ERROR);
+		break;
+	}
+
+	return rc;
+}
+
 extern int slurm_load_job_state(int job_id_count,
 				slurm_selected_step_t *job_ids,
 				job_state_response_msg_t **jsr_pptr)
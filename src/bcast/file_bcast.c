@@ -88,6 +88,17 @@ void *src;				/* source mmap'd address */
 struct stat f_stat;			/* source file stats */
 job_sbcast_cred_msg_t *sbcast_cred;	/* job alloc info and sbcast cred */
 
+typedef struct {
+	struct bcast_parameters *params;
+	char *buffer;		/* block data, compressed or in the mmap */
+	int32_t block_len;	/* bytes in buffer */
+	int32_t orig_len;	/* bytes of the file in this block */
+	uint16_t compress;	/* compression used for this block */
+	bool more;		/* true if more blocks follow */
+	bool file_start;	/* true for the first block */
+	uint32_t usec;		/* time spent reading/compressing */
+} bcast_block_t;
+
 static int   _bcast_file(struct bcast_parameters *params);
 static int   _file_bcast(struct bcast_parameters *params,
 			 file_bcast_msg_t *bcast_msg,
@@ -206,8 +217,8 @@ static int _file_bcast(struct bcast_parameters *params,
 	return rc;
 }
 
-/* load a buffer with data from the file to broadcast,
- * return number of bytes read, zero on end of file */
+/* point buffer at the next block of the mmap'd file to broadcast,
+ * return number of bytes in the block, zero on end of file */
 static int _get_block_none(char **buffer, int *orig_len, bool *more,
 			   bool file_start)
 {
@@ -221,13 +232,13 @@ static int _get_block_none(char **buffer, int *orig_len, bool *more,
 	}
 
 	if (remaining < 0) {
-		*buffer = xmalloc(block_len);
 		remaining = f_stat.st_size;
 		position = src;
 	}
 
+	/* The file is mmap'd, so send straight from the mapping */
 	size = MIN(block_len, remaining);
-	memcpy(*buffer, position, size);
+	*buffer = position;
 	remaining -= size;
 	position += size;
 
@@ -236,6 +247,8 @@ static int _get_block_none(char **buffer, int *orig_len, bool *more,
 	return size;
 }
 
+/* compress the next block of the file into *buffer, which must hold
+ * block_len bytes, return the compressed size */
 static int _get_block_lz4(struct bcast_parameters *params,
 			  char **buffer,
 			  int32_t *orig_len,
@@ -260,7 +273,6 @@ static int _get_block_lz4(struct bcast_parameters *params,
 	if (remaining < 0) {
 		position = src;
 		remaining = f_stat.st_size;
-		*buffer = xmalloc(block_len);
 	}
 
 	/* intentionally limit decompressed size to 10x compressed
@@ -305,17 +317,41 @@ static int _next_block(struct bcast_parameters *params,
 	return _get_block_none(buffer, orig_len, more, file_start);
 }
 
-/* read and broadcast the file */
+/* Load the next block of the file, timing how long it took */
+static void _read_block(bcast_block_t *block)
+{
+	DEF_TIMERS;
+
+	START_TIMER;
+	block->block_len = _next_block(block->params, &block->buffer,
+				       &block->orig_len, &block->more,
+				       block->file_start);
+	END_TIMER;
+	block->compress = block->params->compress;
+	block->usec = DELTA_TIMER;
+}
+
+static void *_read_block_thread(void *arg)
+{
+	_read_block(arg);
+	return NULL;
+}
+
+/*
+ * Read and broadcast the file.
+ *
+ * When compressing, the next block is compressed by a separate thread while
+ * the current block is being sent, using two alternating buffers.
+ */
 static int _bcast_file(struct bcast_parameters *params)
 {
 	int rc = SLURM_SUCCESS;
 	file_bcast_msg_t bcast_msg;
-	char *buffer = NULL;
-	int32_t orig_len = 0;
+	bcast_block_t block[2];
+	char *comp_buf[2] = { NULL, NULL };
 	uint64_t size_uncompressed = 0, size_compressed = 0;
 	uint32_t time_compression = 0;
-	bool more = true, file_start = true;
-	DEF_TIMERS;
+	int cur = 0;
 
 	if (params->block_size)
 		block_len = MIN(params->block_size, f_stat.st_size);
@@ -349,33 +385,60 @@ static int _bcast_file(struct bcast_parameters *params)
 	else if (params->tree_width != 0xfffd)
 		params->tree_width = MIN(MAX_THREADS, params->tree_width);
 
-	while (more) {
-		START_TIMER;
-		bcast_msg.block_len = _next_block(params, &buffer, &orig_len,
-						  &more, file_start);
-		END_TIMER;
-		file_start = false;
-		time_compression += DELTA_TIMER;
-		size_uncompressed += orig_len;
-		size_compressed += bcast_msg.block_len;
+	if (params->compress == COMPRESS_LZ4) {
+		comp_buf[0] = xmalloc(block_len);
+		comp_buf[1] = xmalloc(block_len);
+	}
+
+	memset(block, 0, sizeof(block));
+	block[cur].params = params;
+	block[cur].buffer = comp_buf[cur];
+	block[cur].file_start = true;
+	_read_block(&block[cur]);
+
+	while (true) {
+		pthread_t read_thread = 0;
+		int next = !cur;
+
+		time_compression += block[cur].usec;
+		size_uncompressed += block[cur].orig_len;
+		size_compressed += block[cur].block_len;
 		debug("block %u, size %u", bcast_msg.block_no,
-		      bcast_msg.block_len);
-		bcast_msg.compress = params->compress;
-		bcast_msg.uncomp_len = orig_len;
-		bcast_msg.block = buffer;
-		if (!more)
+		      block[cur].block_len);
+		bcast_msg.block_len = block[cur].block_len;
+		bcast_msg.compress = block[cur].compress;
+		bcast_msg.uncomp_len = block[cur].orig_len;
+		bcast_msg.block = block[cur].buffer;
+		if (!block[cur].more)
 			bcast_msg.flags |= FILE_BCAST_LAST_BLOCK;
 
+		if (block[cur].more) {
+			memset(&block[next], 0, sizeof(block[next]));
+			block[next].params = params;
+			block[next].buffer = comp_buf[next];
+			if (block[cur].compress != COMPRESS_OFF)
+				slurm_thread_create(&read_thread,
+						    _read_block_thread,
+						    &block[next]);
+		}
+
 		rc = _file_bcast(params, &bcast_msg, sbcast_cred);
+
+		if (read_thread)
+			slurm_thread_join(read_thread);
 		if (rc != SLURM_SUCCESS)
 			break;
 		if (bcast_msg.flags & FILE_BCAST_LAST_BLOCK)
 			break;	/* end of file */
+		if (!read_thread)
+			_read_block(&block[next]);
 		bcast_msg.block_no++;
-		bcast_msg.block_offset += orig_len;
+		bcast_msg.block_offset += block[cur].orig_len;
+		cur = next;
 	}
 	xfree(bcast_msg.user_name);
-	xfree(buffer);
+	xfree(comp_buf[0]);
+	xfree(comp_buf[1]);
 
 	if (size_uncompressed && (params->compress != 0)) {
 		int64_t pct = (int64_t) size_uncompressed - size_compressed;
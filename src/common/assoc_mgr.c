@@ -46,6 +46,7 @@
 
 #include "src/common/slurmdbd_pack.h"
 #include "src/common/uid.h"
+#include "src/common/xhash.h"
 #include "src/common/xstring.h"
 
 #include "src/interfaces/gres.h"
@@ -92,7 +93,15 @@ static pthread_mutex_t assoc_lock_init = PTHREAD_MUTEX_INITIALIZER;
 static assoc_init_args_t init_setup;
 static slurmdb_assoc_rec_t **assoc_hash_id = NULL;
 static slurmdb_assoc_rec_t **assoc_hash = NULL;
+static xhash_t *user_uid_hash = NULL;
 static int *assoc_mgr_tres_old_pos = NULL;
+/*
+ * Per TRES position: true if the TRES is billed per node under
+ * PriorityFlags=MAX_TRES (cpu, mem, node and gres). Rebuilt with
+ * assoc_mgr_tres_array so assoc_mgr_tres_weighted() doesn't compare type
+ * strings for every TRES of every job.
+ */
+static bool *assoc_mgr_tres_node_billed = NULL;
 
 static bool _running_cache(void)
 {
@@ -536,6 +545,101 @@ static int _clear_used_qos_info(slurmdb_qos_rec_t *qos)
 }
 
 /* Locks should be in place before calling this. */
+static int _list_find_uid(void *x, void *key)
+{
+	slurmdb_user_rec_t *user = (slurmdb_user_rec_t *) x;
+	uint32_t uid = *(uint32_t *) key;
+
+	if (user->uid == uid)
+		return 1;
+	return 0;
+}
+
+static int _list_find_other_uid(void *x, void *key)
+{
+	slurmdb_user_rec_t *user = x;
+	slurmdb_user_rec_t *other = key;
+
+	return ((user != other) && (user->uid == other->uid));
+}
+
+static void _user_uid_hash_id(void *item, const char **key,
+			      uint32_t *key_len)
+{
+	slurmdb_user_rec_t *user = item;
+
+	*key = (const char *) &user->uid;
+	*key_len = sizeof(user->uid);
+}
+
+/*
+ * Index users by uid, users without a uid are only found by name.
+ * locks should be put in place before calling this function USER_WRITE
+ */
+static void _add_user_uid_hash(slurmdb_user_rec_t *user)
+{
+	if (user->uid == NO_VAL)
+		return;
+
+	if (!user_uid_hash)
+		user_uid_hash = xhash_init(_user_uid_hash_id, NULL);
+
+	/* Keep the first user found if there is more than one per uid */
+	if (!xhash_get(user_uid_hash, (const char *) &user->uid,
+		       sizeof(user->uid)))
+		xhash_add(user_uid_hash, user);
+}
+
+/*
+ * Call before changing the uid of a user or removing it from
+ * assoc_mgr_user_list.
+ * locks should be put in place before calling this function USER_WRITE
+ */
+static void _delete_user_uid_hash(slurmdb_user_rec_t *user)
+{
+	slurmdb_user_rec_t *other;
+
+	if (!user_uid_hash || (user->uid == NO_VAL) ||
+	    (xhash_get(user_uid_hash, (const char *) &user->uid,
+		       sizeof(user->uid)) != user))
+		return;
+
+	xhash_pop(user_uid_hash, (const char *) &user->uid, sizeof(user->uid));
+
+	if (assoc_mgr_user_list &&
+	    (other = list_find_first(assoc_mgr_user_list,
+				     _list_find_other_uid, user)))
+		xhash_add(user_uid_hash, other);
+}
+
+static int _for_each_add_user_uid_hash(void *x, void *arg)
+{
+	_add_user_uid_hash(x);
+
+	return 0;
+}
+
+/* locks should be put in place before calling this function USER_WRITE */
+static void _rebuild_user_uid_hash(void)
+{
+	if (user_uid_hash)
+		xhash_clear(user_uid_hash);
+
+	if (assoc_mgr_user_list)
+		list_for_each(assoc_mgr_user_list, _for_each_add_user_uid_hash,
+			      NULL);
+}
+
+/* locks should be put in place before calling this function USER_READ */
+static slurmdb_user_rec_t *_find_user_uid(uint32_t uid)
+{
+	if (user_uid_hash && (uid != NO_VAL))
+		return xhash_get(user_uid_hash, (const char *) &uid,
+				 sizeof(uid));
+
+	return list_find_first_ro(assoc_mgr_user_list, _list_find_uid, &uid);
+}
+
 static int _change_user_name(slurmdb_user_rec_t *user)
 {
 	int rc = SLURM_SUCCESS;
@@ -547,12 +651,14 @@ static int _change_user_name(slurmdb_user_rec_t *user)
 	xassert(user->name);
 	xassert(user->old_name);
 
+	_delete_user_uid_hash(user);
 	if (uid_from_string(user->name, &pw_uid) < 0) {
 		debug("%s: couldn't get new uid for user %s",
 		      __func__, user->name);
 		user->uid = NO_VAL;
 	} else
 		user->uid = pw_uid;
+	_add_user_uid_hash(user);
 
 	if (assoc_mgr_assoc_list) {
 		itr = list_iterator_create(assoc_mgr_assoc_list);
@@ -683,16 +789,6 @@ static int _local_update_assoc_qos_list(slurmdb_assoc_rec_t *assoc,
 	return SLURM_SUCCESS;
 }
 
-static int _list_find_uid(void *x, void *key)
-{
-	slurmdb_user_rec_t *user = (slurmdb_user_rec_t *) x;
-	uint32_t uid = *(uint32_t *) key;
-
-	if (user->uid == uid)
-		return 1;
-	return 0;
-}
-
 static int _list_find_user(void *x, void *key)
 {
 	slurmdb_user_rec_t *found_user = x;
@@ -706,6 +802,15 @@ static int _list_find_user(void *x, void *key)
 	return 0;
 }
 
+/* locks should be put in place before calling this function USER_READ */
+static slurmdb_user_rec_t *_find_user(slurmdb_user_rec_t *user)
+{
+	if (user->uid != NO_VAL)
+		return _find_user_uid(user->uid);
+
+	return list_find_first_ro(assoc_mgr_user_list, _list_find_user, user);
+}
+
 static int _list_find_coord(void *x, void *key)
 {
 	slurmdb_user_rec_t *user = x;
@@ -739,8 +844,7 @@ static void _set_user_default_acct(slurmdb_assoc_rec_t *assoc,
 	/* set up the default if this is it */
 	if ((assoc->is_def == 1) && (assoc->uid != NO_VAL)) {
 		if (!user)
-			user = list_find_first(assoc_mgr_user_list,
-					       _list_find_uid, &assoc->uid);
+			user = _find_user_uid(assoc->uid);
 
 		if (!user)
 			return;
@@ -770,8 +874,7 @@ static void _clear_user_default_acct(slurmdb_assoc_rec_t *assoc)
 
 	/* set up the default if this is it */
 	if ((assoc->is_def == 0) && (assoc->uid != NO_VAL)) {
-		slurmdb_user_rec_t *user = list_find_first(
-			assoc_mgr_user_list, _list_find_uid, &assoc->uid);
+		slurmdb_user_rec_t *user = _find_user_uid(assoc->uid);
 
 		if (!user)
 			return;
@@ -798,8 +901,7 @@ static void _set_user_default_wckey(slurmdb_wckey_rec_t *wckey,
 	/* set up the default if this is it */
 	if ((wckey->is_def == 1) && (wckey->uid != NO_VAL)) {
 		if (!user)
-			user = list_find_first(assoc_mgr_user_list,
-					       _list_find_uid, &wckey->uid);
+			user = _find_user_uid(wckey->uid);
 
 		if (!user)
 			return;
@@ -1324,6 +1426,7 @@ extern int assoc_mgr_post_tres_list(list_t *new_list)
 	list_itr_t *itr;
 	slurmdb_tres_rec_t *tres_rec, **new_array;
 	char **new_name_array;
+	bool *new_node_billed;
 	bool changed_size = false, changed_pos = false;
 	int i;
 	int new_cnt;
@@ -1336,6 +1439,7 @@ extern int assoc_mgr_post_tres_list(list_t *new_list)
 
 	new_array = xcalloc(new_cnt, sizeof(slurmdb_tres_rec_t *));
 	new_name_array = xcalloc(new_cnt, sizeof(char *));
+	new_node_billed = xcalloc(new_cnt, sizeof(bool));
 
 	list_sort(new_list, (ListCmpF)slurmdb_sort_tres_by_id_asc);
 
@@ -1351,6 +1455,10 @@ extern int assoc_mgr_post_tres_list(list_t *new_list)
 	while ((tres_rec = list_next(itr))) {
 
 		new_array[i] = tres_rec;
+		new_node_billed[i] = ((i == TRES_ARRAY_CPU) ||
+				      (i == TRES_ARRAY_MEM) ||
+				      (i == TRES_ARRAY_NODE) ||
+				      !xstrcasecmp(tres_rec->type, "gres"));
 
 		new_name_array[i] = xstrdup_printf(
 			"%s%s%s",
@@ -1405,6 +1513,10 @@ extern int assoc_mgr_post_tres_list(list_t *new_list)
 	assoc_mgr_tres_name_array = new_name_array;
 	new_name_array = NULL;
 
+	xfree(assoc_mgr_tres_node_billed);
+	assoc_mgr_tres_node_billed = new_node_billed;
+	new_node_billed = NULL;
+
 	FREE_NULL_LIST(assoc_mgr_tres_list);
 	assoc_mgr_tres_list = new_list;
 	new_list = NULL;
@@ -1769,6 +1881,7 @@ static int _get_assoc_mgr_user_list(void *db_conn, int enforce)
 	}
 
 	_post_user_list(assoc_mgr_user_list);
+	_rebuild_user_uid_hash();
 
 	assoc_mgr_unlock(&locks);
 	return SLURM_SUCCESS;
@@ -1836,7 +1949,7 @@ static int _refresh_assoc_mgr_tres_list(void *db_conn, int enforce)
 static int _refresh_assoc_mgr_assoc_list(void *db_conn, int enforce)
 {
 	slurmdb_assoc_cond_t assoc_q = {0};
-	list_t *current_assocs = NULL;
+	list_t *current_assocs = NULL, *new_assocs = NULL;
 	uid_t uid = getuid();
 	list_itr_t *curr_itr = NULL;
 	slurmdb_assoc_rec_t *curr_assoc = NULL, *assoc = NULL;
@@ -1852,26 +1965,28 @@ static int _refresh_assoc_mgr_assoc_list(void *db_conn, int enforce)
 		      __func__);
 	}
 
-	assoc_mgr_lock(&locks);
-
-	current_assocs = assoc_mgr_assoc_list;
-
+	/*
+	 * Get the new list before locking, with many associations the
+	 * transfer from the slurmdbd can take a long time and nothing here
+	 * needs the cached lists until we swap them.
+	 */
 //	START_TIMER;
-	assoc_mgr_assoc_list =
-		acct_storage_g_get_assocs(db_conn, uid, &assoc_q);
+	new_assocs = acct_storage_g_get_assocs(db_conn, uid, &assoc_q);
 //	END_TIMER2("get_assocs");
 
 	FREE_NULL_LIST(assoc_q.cluster_list);
 
-	if (!assoc_mgr_assoc_list) {
-		assoc_mgr_assoc_list = current_assocs;
-		assoc_mgr_unlock(&locks);
-
+	if (!new_assocs) {
 		error("%s: no new list given back keeping cached one.",
 		      __func__);
 		return SLURM_ERROR;
 	}
 
+	assoc_mgr_lock(&locks);
+
+	current_assocs = assoc_mgr_assoc_list;
+	assoc_mgr_assoc_list = new_assocs;
+
 	_post_assoc_list();
 
 	if (!current_assocs) {
@@ -2021,6 +2136,7 @@ static int _refresh_assoc_mgr_user_list(void *db_conn, int enforce)
 	FREE_NULL_LIST(assoc_mgr_user_list);
 
 	assoc_mgr_user_list = current_users;
+	_rebuild_user_uid_hash();
 
 	assoc_mgr_unlock(&locks);
 
@@ -2166,6 +2282,7 @@ extern int assoc_mgr_fini(bool save_state)
 	FREE_NULL_LIST(assoc_mgr_qos_list);
 	FREE_NULL_LIST(assoc_mgr_user_list);
 	FREE_NULL_LIST(assoc_mgr_wckey_list);
+	xhash_free(user_uid_hash);
 	if (assoc_mgr_tres_name_array) {
 		int i;
 		for (i=0; i<g_tres_count; i++)
@@ -2174,6 +2291,7 @@ extern int assoc_mgr_fini(bool save_state)
 	}
 	xfree(assoc_mgr_tres_array);
 	xfree(assoc_mgr_tres_old_pos);
+	xfree(assoc_mgr_tres_node_billed);
 	assoc_mgr_assoc_list = NULL;
 	assoc_mgr_res_list = NULL;
 	assoc_mgr_qos_list = NULL;
@@ -2216,8 +2334,7 @@ static slurmdb_admin_level_t _get_admin_level_internal(void *db_conn,
 		return SLURMDB_ADMIN_NOTSET;
 	}
 
-	found_user = list_find_first_ro(assoc_mgr_user_list,
-					_list_find_uid, &uid);
+	found_user = _find_user_uid(uid);
 
 	if (found_user)
 		level = found_user->admin_level;
@@ -2887,8 +3004,7 @@ extern int assoc_mgr_fill_in_user(void *db_conn, slurmdb_user_rec_t *user,
 		return SLURM_SUCCESS;
 	}
 
-	if (!(found_user = list_find_first_ro(assoc_mgr_user_list,
-					      _list_find_user, user))) {
+	if (!(found_user = _find_user(user))) {
 		if (!locked)
 			assoc_mgr_unlock(&locks);
 		if (enforce & ACCOUNTING_ENFORCE_ASSOCS)
@@ -4708,6 +4824,7 @@ extern int assoc_mgr_update_users(slurmdb_update_object_t *update, bool locked)
 			} else
 				object->uid = pw_uid;
 			list_append(assoc_mgr_user_list, object);
+			_add_user_uid_hash(object);
 			_handle_new_user_coord(object);
 			object = NULL;
 			break;
@@ -4718,6 +4835,7 @@ extern int assoc_mgr_update_users(slurmdb_update_object_t *update, bool locked)
 			}
 			list_delete_first(assoc_mgr_coord_list,
 					  slurm_find_ptr_in_list, rec);
+			_delete_user_uid_hash(rec);
 			list_delete_item(itr);
 			break;
 		case SLURMDB_ADD_COORD:
@@ -6413,6 +6531,7 @@ extern int load_assoc_mgr_state(bool only_tres)
 			FREE_NULL_LIST(assoc_mgr_user_list);
 			assoc_mgr_user_list = msg->my_list;
 			_post_user_list(assoc_mgr_user_list);
+			_rebuild_user_uid_hash();
 			debug("Recovered %u users",
 			      list_count(assoc_mgr_user_list));
 			msg->my_list = NULL;
@@ -6607,7 +6726,7 @@ extern void assoc_mgr_set_uid(uid_t uid, char *username)
 		return;
 	}
 
-	if (list_find_first_ro(assoc_mgr_user_list, _list_find_uid, &uid)) {
+	if (_find_user_uid(uid)) {
 		debug2("%s: uid=%u already known", __func__, uid);
 		assoc_mgr_unlock(&read_lock);
 		return;
@@ -6631,7 +6750,9 @@ extern void assoc_mgr_set_uid(uid_t uid, char *username)
 
 	debug2("%s: adding mapping for user %s uid %u",
 	       __func__, username, uid);
+	_delete_user_uid_hash(user);
 	user->uid = uid;
+	_add_user_uid_hash(user);
 
 	if (assoc_mgr_assoc_list)
 		list_for_each(assoc_mgr_assoc_list, _each_assoc_set_uid, user);
@@ -6701,6 +6822,7 @@ static int _for_each_user_missing_uids(void *x, void *arg)
 		debug3("%s: found uid %u for user %s",
 		       __func__, pw_uid, object->name);
 		object->uid = pw_uid;
+		_add_user_uid_hash(object);
 	}
 
 	return 1;
@@ -7178,6 +7300,8 @@ extern double assoc_mgr_tres_weighted(uint64_t *tres_cnt, double *weights,
 	double to_bill_node   = 0.0;
 	double to_bill_global = 0.0;
 	double billable_tres  = 0.0;
+	bool max_tres = (flags & PRIORITY_FLAGS_MAX_TRES);
+	bool log_weights = (get_log_level() >= LOG_LEVEL_DEBUG3);
 	assoc_mgr_lock_t tres_read_lock = { .tres = READ_LOCK };
 
 	/* We don't have any resources allocated, just return 0. */
@@ -7192,27 +7316,20 @@ extern double assoc_mgr_tres_weighted(uint64_t *tres_cnt, double *weights,
 		assoc_mgr_lock(&tres_read_lock);
 
 	for (i = 0; i < g_tres_count; i++) {
-		double tres_weight = weights[i];
-		char  *tres_type   = assoc_mgr_tres_array[i]->type;
-		double tres_value  = tres_cnt[i];
-
-		if (i == TRES_ARRAY_BILLING)
-			continue;
+		double tres_value;
 
-		if (tres_cnt[i] == NO_CONSUME_VAL64)
+		if ((i == TRES_ARRAY_BILLING) ||
+		    (tres_cnt[i] == NO_CONSUME_VAL64))
 			continue;
 
-		debug3("TRES Weight: %s = %f * %f = %f",
-		       assoc_mgr_tres_name_array[i], tres_value, tres_weight,
-		       tres_value * tres_weight);
+		tres_value = tres_cnt[i] * weights[i];
 
-		tres_value *= tres_weight;
+		if (log_weights)
+			debug3("TRES Weight: %s = %f * %f = %f",
+			       assoc_mgr_tres_name_array[i],
+			       (double) tres_cnt[i], weights[i], tres_value);
 
-		if ((flags & PRIORITY_FLAGS_MAX_TRES) &&
-		    ((i == TRES_ARRAY_CPU) ||
-		     (i == TRES_ARRAY_MEM) ||
-		     (i == TRES_ARRAY_NODE) ||
-		     (!xstrcasecmp(tres_type, "gres"))))
+		if (max_tres && assoc_mgr_tres_node_billed[i])
 			to_bill_node = MAX(to_bill_node, tres_value);
 		else
 			to_bill_global += tres_value;
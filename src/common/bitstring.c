@@ -53,6 +53,20 @@
 #include "src/common/xmalloc.h"
 #include "src/common/xstring.h"
 
+/*
+ * Build the population count loops for both the baseline target and CPUs with
+ * the popcnt instruction, with the version used picked when the library is
+ * loaded. Otherwise on generic x86_64 builds __builtin_popcountll() is a
+ * libgcc call per word.
+ */
+#if defined(__x86_64__) && defined(__GNUC__) && !defined(__clang__) && \
+    defined(__ELF__) && defined(__GLIBC__) && \
+    defined(HAVE___BUILTIN_POPCOUNTLL)
+#define BIT_POPCNT_CLONES __attribute__((target_clones("default", "popcnt")))
+#else
+#define BIT_POPCNT_CLONES
+#endif
+
 /* word of the bitstring bit is in */
 #define	_bit_word(bit) 		(((bit) >> BITSTR_SHIFT) + BITSTR_OVERHEAD)
 
@@ -522,26 +536,43 @@ bit_noc(bitstr_t *b, int32_t n, int32_t seed)
 bitoff_t
 bit_nffs(bitstr_t *b, int32_t n)
 {
-	bitoff_t value = -1;
-	bitoff_t bit;
+	bitoff_t bit, bit_cnt;
 	int32_t cnt = 0;
 
 	_assert_bitstr_valid(b);
 	xassert(n > 0 && n <= _bitstr_bits(b));
 
-	for (bit = 0; bit <= _bitstr_bits(b) - n; bit++) {
+	bit_cnt = _bitstr_bits(b);
+	for (bit = 0; bit < bit_cnt; ) {
+		/* Empty or full words are skipped or counted at once */
+		if (!(bit & BITSTR_MAXPOS) &&
+		    ((bit + BITSTR_WORD_SIZE) <= bit_cnt)) {
+			bitstr_t word = b[_bit_word(bit)];
+
+			if (!word) {
+				cnt = 0;
+				bit += BITSTR_WORD_SIZE;
+				continue;
+			} else if (word == ~((bitstr_t) 0)) {
+				cnt += BITSTR_WORD_SIZE;
+				bit += BITSTR_WORD_SIZE;
+				if (cnt >= n)
+					return bit - cnt;
+				continue;
+			}
+		}
+
 		if (!bit_test(b, bit)) {	/* fail */
 			cnt = 0;
 		} else {
 			cnt++;
-			if (cnt >= n) {
-				value = bit - (cnt - 1);
-				break;
-			}
+			if (cnt >= n)
+				return bit - (cnt - 1);
 		}
+		bit++;
 	}
 
-	return value;
+	return -1;
 }
 
 /*
@@ -930,7 +961,7 @@ hweight(uint64_t w)
  *   b (IN)		bitstring to check
  *   RETURN		count of set bits
  */
-int32_t
+BIT_POPCNT_CLONES int32_t
 bit_set_count(bitstr_t *b)
 {
 	int32_t count = 0;
@@ -957,7 +988,7 @@ bit_set_count(bitstr_t *b)
  *   end (IN)	last bit to check+1
  *   RETURN		count of set bits
  */
-int32_t
+BIT_POPCNT_CLONES int32_t
 bit_set_count_range(bitstr_t *b, int32_t start, int32_t end)
 {
 	int32_t count = 0, eow;
@@ -992,6 +1023,7 @@ bit_set_count_range(bitstr_t *b, int32_t start, int32_t end)
 	return count;
 }
 
+BIT_POPCNT_CLONES
 static int32_t _bit_overlap_internal(bitstr_t *b1, bitstr_t *b2, bool count_it)
 {
 	int32_t count = 0;
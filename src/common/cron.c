@@ -192,7 +192,7 @@ extern char *cronspec_from_cron_entry(cron_entry_t *entry)
  */
 static int _next_month(cron_entry_t *entry, struct tm *tm)
 {
-	int months_to_advance = 0;
+	int months_to_advance, next_month;
 
 	/* tm_mon should be 0-11 */
 	xassert(tm->tm_mon >= 0);
@@ -203,23 +203,14 @@ static int _next_month(cron_entry_t *entry, struct tm *tm)
 	    bit_test(entry->month, tm->tm_mon + 1))
 		return 0;
 
-	/* Start testing from now to get the closest month */
-	for (int i = tm->tm_mon; i < 12; i++) {
-		if (bit_test(entry->month, i + 1))
-			goto found;
-		months_to_advance++;
+	/* Closest month from now, else loop around to begining of the year */
+	if ((next_month = bit_ffs_from_bit(entry->month, tm->tm_mon + 1)) < 0) {
+		if ((next_month = bit_ffs(entry->month)) < 1)
+			fatal("Could not find a valid month, this should be impossible");
+		next_month += 12;
 	}
+	months_to_advance = next_month - (tm->tm_mon + 1);
 
-	/* Loop around to begining of the year if needed */
-	for (int i = 0; i < tm->tm_mon; i++) {
-		if (bit_test(entry->month, i + 1))
-			goto found;
-		months_to_advance++;
-	}
-
-	fatal("Could not find a valid month, this should be impossible");
-
-found:
 	/*
 	 * Next usable month is not this month. Reset other timing to midnight
 	 * on the first of the next valid month.
@@ -241,25 +232,21 @@ found:
  */
 static int _next_day_of_week(cron_entry_t *entry, struct tm *tm)
 {
-	int days_to_advance = 0;
+	int next_day;
 
 	/* tm_wday should be 0-6 */
 	xassert(tm->tm_wday >= 0);
 	xassert(tm->tm_wday <= 6);
 
 	/* Start testing from now to get the closest day */
-	for (int i = tm->tm_wday; i < 7; i++) {
-		if (bit_test(entry->day_of_week, i))
-			return days_to_advance;
-		days_to_advance++;
-	}
+	next_day = bit_ffs_from_bit(entry->day_of_week, tm->tm_wday);
+	if ((next_day >= 0) && (next_day < 7))
+		return next_day - tm->tm_wday;
 
 	/* Loop around to begining of the week if needed */
-	for (int i = 0; i < tm->tm_wday; i++) {
-		if (bit_test(entry->day_of_week, i))
-			return days_to_advance;
-		days_to_advance++;
-	}
+	next_day = bit_ffs(entry->day_of_week);
+	if ((next_day >= 0) && (next_day < tm->tm_wday))
+		return next_day + 7 - tm->tm_wday;
 
 	return 0;
 }
@@ -394,14 +381,13 @@ month:
 hour:
 	if (!(entry->flags & CRON_WILD_HOUR) &&
 	    !bit_test(entry->hour, tm.tm_hour)) {
+		int next_hour = bit_ffs_from_bit(entry->hour, tm.tm_hour);
+
 		/* must be in future, reset minutes */
 		tm.tm_min = 0;
+		tm.tm_hour = ((next_hour < 0) || (next_hour > 23)) ?
+			24 : next_hour;
 
-		while (tm.tm_hour < 24) {
-			if (bit_test(entry->hour, tm.tm_hour))
-				break;
-			tm.tm_hour++;
-		}
 		if (tm.tm_hour == 24) {
 			/*
 			 * tm_hour set to 24 rolls the day and possibly
@@ -414,11 +400,9 @@ hour:
 
 	if (!(entry->flags & CRON_WILD_MINUTE) &&
 	    !bit_test(entry->minute, tm.tm_min)) {
-		while (tm.tm_min < 60) {
-			if (bit_test(entry->minute, tm.tm_min))
-				break;
-			tm.tm_min++;
-		}
+		int next_min = bit_ffs_from_bit(entry->minute, tm.tm_min);
+
+		tm.tm_min = ((next_min < 0) || (next_min > 59)) ? 60 : next_min;
 		if (tm.tm_min == 60 && tm.tm_hour == 23) {
 			/*
 			 * this will roll into the next day,
@@ -37,16 +37,20 @@
 
 #include <ctype.h>
 #include <math.h>
+#include <string.h>
 
 #include "src/common/data.h"
 #include "src/common/list.h"
 #include "src/common/log.h"
 #include "src/common/read_config.h"
 #include "src/common/xassert.h"
+#include "src/common/xhash.h"
 #include "src/common/xmalloc.h"
 #include "src/common/xstring.h"
 
 #define DATA_DEFINE_DICT_PATH_BUFFER_SIZE 1024
+/* dictionaries with at least this many entries get a key index */
+#define DATA_DICT_INDEX_MIN 32
 #define DATA_MAGIC 0x1992189F
 #define DATA_LIST_MAGIC 0x1992F89F
 #define DATA_LIST_NODE_MAGIC 0x1921F89F
@@ -102,6 +106,7 @@ typedef struct data_list_s {
 
 	data_list_node_t *begin;
 	data_list_node_t *end;
+	xhash_t *index; /* key -> node for large dictionaries (or NULL) */
 } data_list_t;
 
 /*
@@ -222,17 +227,25 @@ static void _release_data_list_node(data_list_t *dl, data_list_node_t *dn)
 	log_flag(DATA, "%s: free data-list(0x%"PRIxPTR")[%zu]",
 		 __func__, (uintptr_t) dl, dl->count);
 
-	/* walk list to find new previous */
-	for (prev = dl->begin; prev && prev->next != dn; ) {
-		_check_data_list_node_magic(prev);
-		prev = prev->next;
-		if (prev)
+	if (dn == dl->begin) {
+		/*
+		 * At the beginning: there is no previous node to find, so
+		 * don't walk the list. _release_data_list() always releases
+		 * from the beginning and would be quadratic otherwise.
+		 */
+		prev = NULL;
+	} else {
+		/* walk list to find new previous */
+		for (prev = dl->begin; prev && prev->next != dn; ) {
 			_check_data_list_node_magic(prev);
+			prev = prev->next;
+			if (prev)
+				_check_data_list_node_magic(prev);
+		}
 	}
 
 	if (dn == dl->begin) {
 		/* at the beginning */
-		xassert(!prev);
 		dl->begin = dn->next;
 
 		if (dl->end == dn) {
@@ -256,8 +269,10 @@ static void _release_data_list_node(data_list_t *dl, data_list_node_t *dn)
 	}
 
 	dl->count--;
+	if (dl->index && dn->key && dn->key[0])
+		xhash_delete_str(dl->index, dn->key);
 	FREE_NULL_DATA(dn->data);
-	xfree(dn->key);
+	/* key is allocated with dn */
 
 	dn->magic = ~DATA_LIST_NODE_MAGIC;
 	xfree(dn);
@@ -273,6 +288,10 @@ static void _release_data_list(data_list_t *dl)
 
 	_check_data_list_magic(dl);
 
+	/* every node is going away, no need to remove them one by one */
+	if (dl->index)
+		xhash_free(dl->index);
+
 	if (!n) {
 		xassert(!dl->count);
 		xassert(!dl->end);
@@ -307,14 +326,17 @@ finish:
  */
 static data_list_node_t *_new_data_list_node(data_t *d, const char *key)
 {
-	data_list_node_t *dn = xmalloc(sizeof(*dn));
+	size_t key_bytes = key ? (strlen(key) + 1) : 0;
+	/* store the key after the node to avoid a second allocation */
+	data_list_node_t *dn = xmalloc(sizeof(*dn) + key_bytes);
 	dn->magic = DATA_LIST_NODE_MAGIC;
 
 	_check_magic(d);
 
 	dn->data = d;
 	if (key) {
-		dn->key = xstrdup(key);
+		dn->key = (char *) (dn + 1);
+		memcpy(dn->key, key, key_bytes);
 
 		log_flag(DATA, "%s: new dictionary entry data-list-node(0x%"PRIxPTR")[%s]=%pD",
 			 __func__, (uintptr_t) dn, dn->key, dn->data);
@@ -326,6 +348,50 @@ static data_list_node_t *_new_data_list_node(data_t *d, const char *key)
 	return dn;
 }
 
+static void _dict_index_id(void *item, const char **key, uint32_t *key_len)
+{
+	data_list_node_t *dn = item;
+
+	*key = dn->key;
+	*key_len = strlen(dn->key);
+}
+
+/* Add new dictionary node to index, creating the index once dl is large */
+static void _dict_index_add(data_list_t *dl, data_list_node_t *dn)
+{
+	/* xhash can't hold empty keys, those are always searched for */
+	if (!dn->key || !dn->key[0])
+		return;
+
+	if (dl->index) {
+		xhash_add(dl->index, dn);
+	} else if (dl->count >= DATA_DICT_INDEX_MIN) {
+		dl->index = xhash_init(_dict_index_id, NULL);
+		for (data_list_node_t *i = dl->begin; i; i = i->next)
+			if (i->key[0])
+				xhash_add(dl->index, i);
+	}
+}
+
+/* Find dictionary node by key */
+static data_list_node_t *_dict_find_key(const data_list_t *dl,
+					const char *key)
+{
+	data_list_node_t *i;
+
+	if (dl->index && key[0])
+		return xhash_get_str(dl->index, key);
+
+	for (i = dl->begin; i; i = i->next) {
+		_check_data_list_node_magic(i);
+
+		if (!xstrcmp(key, i->key))
+			break;
+	}
+
+	return i;
+}
+
 static void _data_list_append(data_list_t *dl, data_t *d, const char *key)
 {
 	data_list_node_t *n = _new_data_list_node(d, key);
@@ -346,6 +412,7 @@ static void _data_list_append(data_list_t *dl, data_t *d, const char *key)
 	}
 
 	dl->count++;
+	_dict_index_add(dl, n);
 
 	if (n->key)
 		log_flag(DATA, "%s: append dictionary entry data-list-node(0x%"PRIxPTR")[%s]=%pD",
@@ -372,6 +439,7 @@ static void _data_list_prepend(data_list_t *dl, data_t *d, const char *key)
 	}
 
 	dl->count++;
+	_dict_index_add(dl, n);
 
 	log_flag(DATA, "%s: prepend %pD[%s]->data-list-node(0x%"PRIxPTR")[%s]=%pD",
 		 __func__, d, key, (uintptr_t) n, n->key, n->data);
@@ -762,15 +830,7 @@ extern const data_t *data_key_get_const(const data_t *data, const char *key)
 		return NULL;
 
 	_check_data_list_magic(data->data.dict_u);
-	i = data->data.dict_u->begin;
-	while (i) {
-		_check_data_list_node_magic(i);
-
-		if (!xstrcmp(key, i->key))
-			break;
-
-		i = i->next;
-	}
+	i = _dict_find_key(data->data.dict_u, key);
 
 	if (i)
 		return i->data;
@@ -778,15 +838,9 @@ extern const data_t *data_key_get_const(const data_t *data, const char *key)
 		return NULL;
 }
 
-static bool _match_string(const char *key, data_t *data, void *needle_ptr)
-{
-	const char *needle = needle_ptr;
-	return !xstrcmp(key, needle);
-}
-
 extern data_t *data_key_get(data_t *data, const char *key)
 {
-	return data_dict_find_first(data, _match_string, (void *) key);
+	return (data_t *) data_key_get_const(data, key);
 }
 
 extern data_t *data_key_get_int(data_t *data, int64_t key)
@@ -922,15 +976,7 @@ extern bool data_key_unset(data_t *data, const char *key)
 		return NULL;
 
 	_check_data_list_magic(data->data.dict_u);
-	i = data->data.dict_u->begin;
-	while (i) {
-		_check_data_list_node_magic(i);
-
-		if (!xstrcmp(key, i->key))
-			break;
-
-		i = i->next;
-	}
+	i = _dict_find_key(data->data.dict_u, key);
 
 	if (!i) {
 		log_flag(DATA, "%s: remove non-existent key in %pD[%s]",
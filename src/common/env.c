@@ -1677,12 +1677,81 @@ int env_array_overwrite(char ***array_ptr, const char *name,
 	return _env_array_update(array_ptr, name, value, true);
 }
 
+/* Order "name=value" entries by name only */
+static int _env_name_cmp(const void *x, const void *y)
+{
+	const char *e1 = *(const char **) x;
+	const char *e2 = *(const char **) y;
+
+	while ((*e1 == *e2) && (*e1 != '=')) {
+		e1++;
+		e2++;
+	}
+	if ((*e1 == '=') && (*e2 == '='))
+		return 0;
+	if (*e1 == '=')
+		return -1;
+	if (*e2 == '=')
+		return 1;
+	return (unsigned char) *e1 - (unsigned char) *e2;
+}
+
+/*
+ * Return true if env_array_merge() would copy every entry of array
+ * unchanged: each entry is a valid "name=value" string that
+ * _env_array_entry_splitter() accepts, and no name appears twice.
+ */
+static bool _env_array_copy_verbatim(const char **array, int cnt)
+{
+	const char **sorted;
+	bool verbatim = true;
+
+	for (int i = 0; i < cnt; i++) {
+		char *eq = xstrchr(array[i], '=');
+
+		if (!eq || ((eq - array[i] + 1) > 256) ||
+		    ((strlen(eq + 1) + 1) > ENV_BUFSIZE))
+			return false;
+	}
+
+	sorted = xcalloc(cnt, sizeof(char *));
+	memcpy(sorted, array, (cnt * sizeof(char *)));
+	qsort(sorted, cnt, sizeof(char *), _env_name_cmp);
+	for (int i = 1; i < cnt; i++) {
+		if (!_env_name_cmp(&sorted[i - 1], &sorted[i])) {
+			verbatim = false;
+			break;
+		}
+	}
+	xfree(sorted);
+
+	return verbatim;
+}
+
 /*
  * Copy env_array must be freed by env_array_free
  */
 char **env_array_copy(const char **array)
 {
 	char **ptr = NULL;
+	int cnt = 0;
+
+	if (array) {
+		while (array[cnt])
+			cnt++;
+	}
+
+	/*
+	 * Merging looks up every name in the array built so far, which is
+	 * quadratic in the environment size. Environments are normally free
+	 * of duplicate and malformed entries, so copy those directly.
+	 */
+	if (cnt && _env_array_copy_verbatim(array, cnt)) {
+		ptr = xcalloc((cnt + 1), sizeof(char *));
+		for (int i = 0; i < cnt; i++)
+			ptr[i] = xstrdup(array[i]);
+		return ptr;
+	}
 
 	env_array_merge(&ptr, array);
 
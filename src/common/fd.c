@@ -35,6 +35,8 @@
  *  Refer to "fd.h" for documentation on public functions.
 \*****************************************************************************/
 
+#define _GNU_SOURCE	/* For close_range() */
+
 #include <dirent.h>
 #include <errno.h>
 #include <fcntl.h>
@@ -119,6 +121,15 @@ extern void closeall(int fd)
 	DIR *d;
 	struct dirent *dir;
 
+#ifdef HAVE_CLOSE_RANGE
+	/*
+	 * A single syscall closes the whole range without walking
+	 * /proc/self/fd. Fall back below if the kernel lacks close_range(2).
+	 */
+	if (!close_range(fd, ~0U, 0))
+		return;
+#endif
+
 	/*
 	 * Blindly closing all file descriptors is slow.
 	 *
@@ -143,6 +154,49 @@ extern void closeall(int fd)
 	closedir(d);
 }
 
+extern void closeall_on_exec(int fd)
+{
+	char *name = "/proc/self/fd";
+	struct rlimit rlim;
+	DIR *d;
+	struct dirent *dir;
+
+#if defined(HAVE_CLOSE_RANGE) && defined(CLOSE_RANGE_CLOEXEC)
+	if (!close_range(fd, ~0U, CLOSE_RANGE_CLOEXEC))
+		return;
+#endif
+
+	if ((d = opendir(name))) {
+		int dir_fd = dirfd(d);
+
+		while ((dir = readdir(d))) {
+			/* Ignore "." and ".." entries */
+			if (dir->d_type != DT_DIR) {
+				int open_fd = atoi(dir->d_name);
+				if ((open_fd >= fd) && (open_fd != dir_fd))
+					fd_set_close_on_exec(open_fd);
+			}
+		}
+		closedir(d);
+		return;
+	}
+
+	debug("Could not read open files from %s: %m, checking all potential file descriptors",
+	      name);
+
+	if (getrlimit(RLIMIT_NOFILE, &rlim) < 0) {
+		error("getrlimit(RLIMIT_NOFILE): %m");
+		rlim.rlim_cur = 4096;
+	}
+
+	for (; fd < rlim.rlim_cur; fd++) {
+		struct stat st;
+
+		if (!fstat(fd, &st))
+			fd_set_close_on_exec(fd);
+	}
+}
+
 extern void fd_close(int *fd)
 {
 	if (fd && *fd >= 0) {
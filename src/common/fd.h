@@ -49,6 +49,9 @@
 /* close all FDs >= a specified value */
 extern void closeall(int fd);
 
+/* set close-on-exec on all FDs >= a specified value */
+extern void closeall_on_exec(int fd);
+
 /* Close a specific file descriptor and replace it with -1 */
 extern void fd_close(int *fd);
 
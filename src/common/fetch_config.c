@@ -555,6 +555,34 @@ extern config_response_msg_t *new_config_response(bool to_slurmd)
 	return msg;
 }
 
+static int _copy_config_file(void *x, void *arg)
+{
+	config_file_t *conf_file = x;
+	config_response_msg_t *msg = arg;
+	config_file_t *copy = xmalloc(sizeof(*copy));
+
+	copy->exists = conf_file->exists;
+	copy->execute = conf_file->execute;
+	copy->file_name = xstrdup(conf_file->file_name);
+	copy->file_content = xstrdup(conf_file->file_content);
+	list_append(msg->config_files, copy);
+
+	return SLURM_SUCCESS;
+}
+
+extern config_response_msg_t *copy_config_response(
+	const config_response_msg_t *msg)
+{
+	config_response_msg_t *copy = xmalloc(sizeof(*copy));
+
+	copy->config_files = list_create(destroy_config_file);
+	if (msg->config_files)
+		list_for_each_ro(msg->config_files, _copy_config_file, copy);
+	copy->slurmd_spooldir = xstrdup(msg->slurmd_spooldir);
+
+	return copy;
+}
+
 extern void destroy_config_file(void *object)
 {
 	config_file_t *conf_file = (config_file_t *)object;
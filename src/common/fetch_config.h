@@ -62,6 +62,10 @@ extern int write_configs_to_conf_cache(config_response_msg_t *msg,
 
 extern config_response_msg_t *new_config_response(bool to_slurmd);
 
+/* Duplicate a config response without reading the files again */
+extern config_response_msg_t *copy_config_response(
+	const config_response_msg_t *msg);
+
 extern void destroy_config_file(void *object);
 
 extern void grab_include_directives(void);
@@ -38,6 +38,7 @@
 \*****************************************************************************/
 
 #include <errno.h>
+#include <poll.h>
 #include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -54,11 +55,41 @@
 #include "src/common/slurm_protocol_defs.h"
 #include "src/common/slurm_protocol_socket.h"
 #include "src/common/slurm_protocol_pack.h"
+#include "src/common/timers.h"
+#include "src/common/xhash.h"
 #include "src/common/xmalloc.h"
 #include "src/common/xstring.h"
 
+/* Seconds a failed forward to a node is held against it */
+#define FWD_HIST_FAIL_AGE 600
+
+/* Seconds an idle kept alive connection may be reused */
+#define KEEP_ALIVE_IDLE 300
+/* Max idle kept alive connections */
+#define KEEP_ALIVE_MAX 256
+
+/* Forwarding history of a node used to pick relays for message trees */
+typedef struct {
+	char *name;
+	uint32_t rtt_usec; /* rolling average of direct round trip time */
+	uint32_t failures; /* consecutive failed forwards */
+	time_t last_fail;
+} fwd_hist_t;
+
 static slurm_node_alias_addrs_t *last_alias_addrs = NULL;
 static pthread_mutex_t alias_addrs_mutex = PTHREAD_MUTEX_INITIALIZER;
+static xhash_t *fwd_hist = NULL;
+static pthread_mutex_t fwd_hist_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/* Idle connection kept alive to a node */
+typedef struct {
+	char *name;
+	int fd;
+	time_t last_used;
+} keep_alive_conn_t;
+
+static list_t *keep_alive_conns = NULL;
+static pthread_mutex_t keep_alive_mutex = PTHREAD_MUTEX_INITIALIZER;
 
 typedef struct {
 	pthread_cond_t *notify;
@@ -96,6 +127,325 @@ void _destroy_tree_fwd(fwd_tree_t *fwd_tree)
 	}
 }
 
+static void _fwd_hist_id(void *item, const char **key, uint32_t *key_len)
+{
+	fwd_hist_t *hist = item;
+
+	*key = hist->name;
+	*key_len = strlen(hist->name);
+}
+
+static void _fwd_hist_free(void *item)
+{
+	fwd_hist_t *hist = item;
+
+	xfree(hist->name);
+	xfree(hist);
+}
+
+/* Caller must hold fwd_hist_mutex */
+static void _fwd_hist_update(const char *name, int rtt_usec, bool failed)
+{
+	fwd_hist_t *hist;
+
+	if (!fwd_hist)
+		fwd_hist = xhash_init(_fwd_hist_id, _fwd_hist_free);
+
+	if (!(hist = xhash_get_str(fwd_hist, name))) {
+		hist = xmalloc(sizeof(*hist));
+		hist->name = xstrdup(name);
+		xhash_add(fwd_hist, hist);
+	}
+
+	if (failed) {
+		hist->failures++;
+		hist->last_fail = time(NULL);
+	} else {
+		hist->failures = 0;
+		if ((rtt_usec >= 0) && hist->rtt_usec)
+			hist->rtt_usec = ((hist->rtt_usec * 7) + rtt_usec) / 8;
+		else if (rtt_usec >= 0)
+			hist->rtt_usec = rtt_usec;
+	}
+}
+
+/*
+ * Record the outcome of forwarding to a node
+ * IN name - node name
+ * IN rtt_usec - round trip time of a direct (non-forwarded) message or -1
+ * IN failed - true if the node could not be reached
+ */
+static void _fwd_hist_record(const char *name, int rtt_usec, bool failed)
+{
+	slurm_mutex_lock(&fwd_hist_mutex);
+	_fwd_hist_update(name, rtt_usec, failed);
+	slurm_mutex_unlock(&fwd_hist_mutex);
+}
+
+static bool _is_comm_error(uint32_t err)
+{
+	return ((err == SLURM_COMMUNICATIONS_CONNECTION_ERROR) ||
+		(err == SLURM_COMMUNICATIONS_SEND_ERROR) ||
+		(err == SLURM_COMMUNICATIONS_RECEIVE_ERROR) ||
+		(err == SLURM_PROTOCOL_SOCKET_IMPL_TIMEOUT));
+}
+
+/*
+ * Record the outcome for every node in a forwarded ret_list. Relays report
+ * nodes they failed to reach, so this learns about nodes deeper in the tree.
+ * IN ret_list - list of ret_data_info_t
+ * IN name - node the message was sent to, responses without a node_name are
+ *	from this node
+ * IN rtt_usec - round trip time to name if sent directly or -1
+ */
+static void _fwd_hist_record_list(list_t *ret_list, const char *name,
+				  int rtt_usec)
+{
+	list_itr_t *itr = list_iterator_create(ret_list);
+	ret_data_info_t *ret_data_info;
+
+	slurm_mutex_lock(&fwd_hist_mutex);
+	while ((ret_data_info = list_next(itr))) {
+		const char *node = ret_data_info->node_name;
+
+		if (!node || !xstrcmp(node, name))
+			_fwd_hist_update(name, rtt_usec,
+					 _is_comm_error(ret_data_info->err));
+		else
+			_fwd_hist_update(node, -1,
+					 _is_comm_error(ret_data_info->err));
+	}
+	slurm_mutex_unlock(&fwd_hist_mutex);
+	list_iterator_destroy(itr);
+}
+
+/*
+ * Remove and return the node in hl best suited to relay to the rest of hl.
+ * Nodes that recently failed and then the slowest nodes are passed over so
+ * they end up as leaves of the tree instead of stalling their branch.
+ * Ties keep the order of hl so the topology split order is preserved.
+ * RET node name, caller must free() or NULL if hl is empty
+ */
+static char *_fwd_hist_shift(hostlist_t *hl)
+{
+	hostlist_iterator_t *itr;
+	char *name, *best = NULL;
+	uint32_t best_failures = 0, best_rtt = 0;
+	time_t now;
+	int i = 0, best_i = 0;
+
+	if (hostlist_count(hl) <= 1)
+		return hostlist_shift(hl);
+
+	slurm_mutex_lock(&fwd_hist_mutex);
+	if (!fwd_hist || !xhash_count(fwd_hist)) {
+		slurm_mutex_unlock(&fwd_hist_mutex);
+		return hostlist_shift(hl);
+	}
+
+	now = time(NULL);
+	itr = hostlist_iterator_create(hl);
+	while ((name = hostlist_next(itr))) {
+		fwd_hist_t *hist = xhash_get_str(fwd_hist, name);
+		uint32_t failures = 0, rtt = 0;
+
+		if (hist) {
+			if (hist->failures &&
+			    ((now - hist->last_fail) < FWD_HIST_FAIL_AGE))
+				failures = hist->failures;
+			rtt = hist->rtt_usec;
+		}
+
+		if (!best || (failures < best_failures) ||
+		    ((failures == best_failures) && (rtt < best_rtt))) {
+			free(best);
+			best = name;
+			best_failures = failures;
+			best_rtt = rtt;
+			best_i = i;
+		} else {
+			free(name);
+		}
+
+		/* Can't do better than a healthy node with no history */
+		if (!best_failures && !best_rtt)
+			break;
+		i++;
+	}
+	hostlist_iterator_destroy(itr);
+	slurm_mutex_unlock(&fwd_hist_mutex);
+
+	if (!best_i) {
+		free(best);
+		return hostlist_shift(hl);
+	}
+
+	log_flag(NET, "%s: relaying through %s instead of first node (failures=%u rtt_usec=%u)",
+		 __func__, best, best_failures, best_rtt);
+	hostlist_delete_host(hl, best);
+	return best;
+}
+
+static int _find_any_conn(void *x, void *key)
+{
+	return 1;
+}
+
+static void _free_keep_alive_conn(void *x)
+{
+	keep_alive_conn_t *conn = x;
+
+	if ((conn->fd >= 0) && close(conn->fd))
+		error("%s: close(%d): %m", __func__, conn->fd);
+	xfree(conn->name);
+	xfree(conn);
+}
+
+static int _find_keep_alive_conn(void *x, void *key)
+{
+	keep_alive_conn_t *conn = x;
+
+	return !xstrcmp(conn->name, key);
+}
+
+/*
+ * Take the idle connection kept alive to name
+ * RET fd or -1 if there is no usable connection
+ */
+static int _keep_alive_take(const char *name)
+{
+	keep_alive_conn_t *conn = NULL;
+	struct pollfd pfd = {
+		.events = POLLIN,
+	};
+	int fd;
+
+	slurm_mutex_lock(&keep_alive_mutex);
+	if (keep_alive_conns)
+		conn = list_remove_first(keep_alive_conns,
+					 _find_keep_alive_conn, (void *) name);
+	slurm_mutex_unlock(&keep_alive_mutex);
+
+	if (!conn)
+		return -1;
+
+	pfd.fd = conn->fd;
+
+	/*
+	 * An idle connection has nothing to read. If it is readable then the
+	 * peer closed it (e.g. slurmd restarted) and it can't be reused.
+	 */
+	if (((time(NULL) - conn->last_used) > KEEP_ALIVE_IDLE) ||
+	    (poll(&pfd, 1, 0) != 0)) {
+		log_flag(NET, "%s: discarding stale connection to %s",
+			 __func__, name);
+		_free_keep_alive_conn(conn);
+		return -1;
+	}
+
+	fd = conn->fd;
+	conn->fd = -1;
+	_free_keep_alive_conn(conn);
+
+	return fd;
+}
+
+/* Keep fd open to reuse for the next RPC to name */
+static void _keep_alive_put(const char *name, int fd)
+{
+	keep_alive_conn_t *conn = xmalloc(sizeof(*conn));
+
+	conn->name = xstrdup(name);
+	conn->fd = fd;
+	conn->last_used = time(NULL);
+
+	slurm_mutex_lock(&keep_alive_mutex);
+	if (!keep_alive_conns)
+		keep_alive_conns = list_create(_free_keep_alive_conn);
+
+	if (list_find_first(keep_alive_conns, _find_keep_alive_conn,
+			    (void *) name)) {
+		/* Another thread already returned a connection to name */
+		_free_keep_alive_conn(conn);
+	} else {
+		/* Evict the least recently used connection when full */
+		if (list_count(keep_alive_conns) >= KEEP_ALIVE_MAX)
+			list_delete_first(keep_alive_conns, _find_any_conn,
+					  NULL);
+		list_append(keep_alive_conns, conn);
+	}
+	slurm_mutex_unlock(&keep_alive_mutex);
+}
+
+/*
+ * Send msg directly to name (no forwarding) and receive the response over a
+ * connection kept alive between RPCs.
+ * RET ret_list as slurm_send_addr_recv_msgs() and sets errno
+ */
+static list_t *_keep_alive_send_recv(slurm_msg_t *msg, char *name,
+				     int timeout)
+{
+	list_t *ret_list = NULL;
+	ret_data_info_t *ret_data_info;
+	slurm_msg_t resp;
+	bool reused = true;
+	int fd;
+
+	xassert(!msg->forward.cnt);
+	xassert(forward_keep_alive_type(msg->msg_type));
+
+	if ((fd = _keep_alive_take(name)) < 0) {
+		reused = false;
+		/* Use the connect retry logic of the normal path on failure */
+		if ((fd = slurm_open_msg_conn(&msg->address)) < 0)
+			return slurm_send_addr_recv_msgs(msg, name, timeout);
+	}
+
+	if (timeout <= 0)
+		timeout = slurm_conf.msg_timeout * 1000;
+
+	msg->ret_list = NULL;
+	msg->forward_struct = NULL;
+	msg->forward.timeout = timeout;
+
+	if (slurm_send_recv_msg(fd, msg, &resp, timeout)) {
+		int rc = errno;
+
+		log_flag(NET, "%s: RPC to %s failed: %s",
+			 __func__, name, slurm_strerror(rc));
+		(void) close(fd);
+
+		/*
+		 * The peer may have closed the connection while it was idle.
+		 * Keep alive RPCs are safe to repeat on a new connection.
+		 */
+		if (reused)
+			return slurm_send_addr_recv_msgs(msg, name, timeout);
+
+		mark_as_failed_forward(&ret_list, name, rc);
+		errno = SLURM_COMMUNICATIONS_CONNECTION_ERROR;
+		return ret_list;
+	}
+
+	if (resp.auth_cred)
+		auth_g_destroy(resp.auth_cred);
+
+	if (resp.flags & SLURM_MSG_KEEP_ALIVE)
+		_keep_alive_put(name, fd);
+	else if (close(fd))
+		error("%s: close(%d): %m", __func__, fd);
+
+	ret_list = list_create(destroy_data_info);
+	ret_data_info = xmalloc(sizeof(*ret_data_info));
+	ret_data_info->type = resp.msg_type;
+	ret_data_info->data = resp.data;
+	ret_data_info->node_name = xstrdup(name);
+	list_append(ret_list, ret_data_info);
+
+	errno = SLURM_SUCCESS;
+	return ret_list;
+}
+
 static int _forward_get_addr(forward_struct_t *fwd_struct, char *name,
 			     slurm_addr_t *address)
 {
@@ -124,9 +474,10 @@ static void *_forward_thread(void *arg)
 	char *buf = NULL;
 	int steps = 0;
 	int start_timeout = fwd_msg->timeout;
+	struct timeval tv;
 
 	/* repeat until we are sure the message was sent */
-	while ((name = hostlist_shift(hl))) {
+	while ((name = _fwd_hist_shift(hl))) {
 		if ((!(fwd_msg->header.flags & SLURM_PACK_ADDRS) ||
 		     _forward_get_addr(fwd_struct, name, &addr)) &&
 		    slurm_conf_get_addr(name, &addr, fwd_msg->header.flags)) {
@@ -142,9 +493,11 @@ static void *_forward_thread(void *arg)
 			}
 			goto cleanup;
 		}
+		gettimeofday(&tv, NULL);
 		if ((fd = slurm_open_msg_conn(&addr)) < 0) {
 			error("%s: failed to %s (%pA): %m",
 			      __func__, name, &addr);
+			_fwd_hist_record(name, -1, true);
 
 			slurm_mutex_lock(&fwd_struct->forward_mutex);
 			mark_as_failed_forward(
@@ -206,6 +559,7 @@ static void *_forward_thread(void *arg)
 				     get_buf_data(buffer),
 				     get_buf_offset(buffer)) < 0) {
 			error("%s: slurm_msg_sendto: %m", __func__);
+			_fwd_hist_record(name, -1, true);
 
 			slurm_mutex_lock(&fwd_struct->forward_mutex);
 			mark_as_failed_forward(&fwd_struct->ret_list, name,
@@ -269,6 +623,7 @@ static void *_forward_thread(void *arg)
 		/*      fwd_ptr->cnt, list_count(ret_list)); */
 
 		if (!ret_list || (fwd_ptr->cnt && list_count(ret_list) <= 1)) {
+			_fwd_hist_record(name, -1, true);
 			slurm_mutex_lock(&fwd_struct->forward_mutex);
 			mark_as_failed_forward(&fwd_struct->ret_list, name,
 					       errno);
@@ -283,7 +638,12 @@ static void *_forward_thread(void *arg)
 				continue;
 			}
 			goto cleanup;
-		} else if ((fwd_ptr->cnt + 1) != list_count(ret_list)) {
+		}
+
+		_fwd_hist_record_list(ret_list, name,
+				      (fwd_ptr->cnt ? -1 : slurm_delta_tv(&tv)));
+
+		if ((fwd_ptr->cnt + 1) != list_count(ret_list)) {
 			/* this should never be called since the above
 			   should catch the failed forwards and pipe
 			   them back down, but this is here so we
@@ -400,6 +760,7 @@ static void *_fwd_tree_thread(void *arg)
 	char *name = NULL;
 	char *buf = NULL;
 	slurm_msg_t send_msg;
+	struct timeval tv;
 
 	slurm_msg_t_init(&send_msg);
 	send_msg.msg_type = fwd_tree->orig_msg->msg_type;
@@ -411,7 +772,7 @@ static void *_fwd_tree_thread(void *arg)
 				    fwd_tree->orig_msg->restrict_uid);
 
 	/* repeat until we are sure the message was sent */
-	while ((name = hostlist_shift(fwd_tree->tree_hl))) {
+	while ((name = _fwd_hist_shift(fwd_tree->tree_hl))) {
 		if (_fwd_tree_get_addr(fwd_tree, name, &send_msg.address)) {
 			free(name);
 
@@ -443,13 +804,27 @@ static void *_fwd_tree_thread(void *arg)
 		} else
 			debug3("Tree sending to %s", name);
 
-		ret_list = slurm_send_addr_recv_msgs(&send_msg, name,
-						     fwd_tree->timeout);
+		gettimeofday(&tv, NULL);
+		if ((send_msg.flags & SLURM_MSG_KEEP_ALIVE) &&
+		    !send_msg.forward.cnt) {
+			ret_list = _keep_alive_send_recv(&send_msg, name,
+							 fwd_tree->timeout);
+		} else {
+			/* Only direct RPCs reuse connections */
+			send_msg.flags &= ~SLURM_MSG_KEEP_ALIVE;
+			ret_list = slurm_send_addr_recv_msgs(
+				&send_msg, name, fwd_tree->timeout);
+			send_msg.flags = fwd_tree->orig_msg->flags;
+		}
 
 		xfree(send_msg.forward.nodelist);
 
 		if (ret_list) {
 			int ret_cnt = list_count(ret_list);
+
+			_fwd_hist_record_list(ret_list, name,
+					      (send_msg.forward.cnt ? -1 :
+					       slurm_delta_tv(&tv)));
 			/* This is most common if a slurmd is running
 			   an older version of Slurm than the
 			   originator of the message.
@@ -459,6 +834,7 @@ static void *_fwd_tree_thread(void *arg)
 				error("%s: %s failed to forward the message, expecting %d ret got only %d",
 				      __func__, name, send_msg.forward.cnt + 1,
 				      ret_cnt);
+				_fwd_hist_record(name, -1, true);
 				if (ret_cnt > 1) { /* not likely */
 					ret_data_info_t *ret_data_info = NULL;
 					list_itr_t *itr =
@@ -623,6 +999,19 @@ static void _forward_msg_internal(hostlist_t *hl, hostlist_t **sp_hl,
 	}
 }
 
+extern bool forward_keep_alive_type(uint16_t msg_type)
+{
+	switch (msg_type) {
+	case REQUEST_ACCT_GATHER_UPDATE:
+	case REQUEST_HEALTH_CHECK:
+	case REQUEST_NODE_REGISTRATION_STATUS:
+	case REQUEST_PING:
+		return true;
+	default:
+		return false;
+	}
+}
+
 /*
  * forward_init    - initialize forward structure
  * IN: forward     - forward_t *   - struct to store forward info
@@ -113,6 +113,13 @@ extern void forward_wait(slurm_msg_t *msg);
 
 extern void fwd_set_alias_addrs(slurm_node_alias_addrs_t *node_alias);
 
+/*
+ * Check if connections carrying msg_type may be kept alive for further RPCs.
+ * Only RPCs whose handlers always reply and never take over or close the
+ * connection qualify.
+ */
+extern bool forward_keep_alive_type(uint16_t msg_type);
+
 /* destroyers */
 extern void destroy_data_info(void *object);
 extern void destroy_forward(forward_t *forward);
@@ -36,10 +36,18 @@
 
 /*
  * Theory of operation:
- * - Cache the extended groups for a (uid/username, gid).
- * - Cache expiration - the daemon needs to call group_cache_expire
- *   periodically to accomplish this, otherwise the cache will continue to
- *   grow.
+ * - Cache the extended groups for a (uid/username, gid) in a hash table keyed
+ *   by uid. Lookups only take a read lock so launches and submits for
+ *   different users do not serialize behind each other.
+ * - The name service is never queried while holding the table lock. A miss or
+ *   an expired entry is resolved by the caller and then inserted.
+ * - Entries that are looked up during the last 1/REFRESH_FRACTION of their
+ *   lifetime are queued for a background thread to refresh before they
+ *   expire, so users that keep launching jobs never see a miss.
+ * - Users that can not be resolved are cached for NEGATIVE_CACHE_TIME to avoid
+ *   repeatedly waiting on the name service to fail.
+ * - Cache expiration - the background thread removes expired records every
+ *   GroupUpdateTime. group_cache_cleanup() may also be called periodically.
  * - This always succeeds. The only error getgrouplist() is allowed to throw
  *   is -1 for not enough space, and we will xrealloc to handle this.
  *   In practice, if the name service cannot resolve a given user ID you will
@@ -50,22 +58,31 @@
 
 #include "src/common/group_cache.h"
 #include "src/common/list.h"
+#include "src/common/macros.h"
 #include "src/common/read_config.h"
 #include "src/common/timers.h"
 #include "src/common/uid.h"
+#include "src/common/xhash.h"
 #include "src/common/xmalloc.h"
 #include "src/common/xstring.h"
 
 /* how many groups to use by default to avoid repeated calls to getgrouplist */
 #define NGROUPS_START 64
 
+/* max seconds to remember that a uid could not be resolved */
+#define NEGATIVE_CACHE_TIME 60
+
+/* refresh entries used during the last 1/REFRESH_FRACTION of GroupUpdateTime */
+#define REFRESH_FRACTION 4
+
 typedef struct gids_cache {
 	uid_t uid;
 	gid_t gid;
-	char *username;
+	char *username; /* NULL if uid could not be resolved */
 	int ngids;
 	gid_t *gids;
 	time_t expiration;
+	bool refresh_queued; /* atomic as it is set under the read lock */
 } gids_cache_t;
 
 typedef struct gids_cache_needle {
@@ -74,10 +91,17 @@ typedef struct gids_cache_needle {
 	char *username;		/* optional, will be looked up if needed */
 } gids_cache_needle_t;
 
-static pthread_mutex_t gids_mutex = PTHREAD_MUTEX_INITIALIZER;
-static list_t *gids_cache_list = NULL;
+/* Entries are never modified once inserted, only replaced or removed */
+static pthread_rwlock_t gids_lock = PTHREAD_RWLOCK_INITIALIZER;
+static xhash_t *gids_cache = NULL;
+
+static pthread_mutex_t refresh_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t refresh_cond = PTHREAD_COND_INITIALIZER;
+static list_t *refresh_list = NULL; /* list of uid_t * to refresh */
+static pthread_t refresh_tid = 0;
+static bool refresh_shutdown = false;
 
-static void _group_cache_list_delete(void *x)
+static void _group_cache_delete(void *x)
 {
 	gids_cache_t *entry = (gids_cache_t *) x;
 	xfree(entry->gids);
@@ -85,32 +109,47 @@ static void _group_cache_list_delete(void *x)
 	xfree(entry);
 }
 
-/* call on daemon shutdown to cleanup properly */
-void group_cache_purge(void)
+static void _group_cache_id(void *item, const char **key, uint32_t *key_len)
 {
-	slurm_mutex_lock(&gids_mutex);
-	FREE_NULL_LIST(gids_cache_list);
-	slurm_mutex_unlock(&gids_mutex);
+	gids_cache_t *entry = item;
+
+	*key = (const char *) &entry->uid;
+	*key_len = sizeof(entry->uid);
 }
 
-static int _find_entry(void *x, void *key)
+/* call on daemon shutdown to cleanup properly */
+void group_cache_purge(void)
 {
-	gids_cache_t *entry = (gids_cache_t *) x;
-	gids_cache_needle_t *needle = (gids_cache_needle_t *) key;
+	slurm_mutex_lock(&refresh_mutex);
+	refresh_shutdown = true;
+	slurm_cond_broadcast(&refresh_cond);
+	slurm_mutex_unlock(&refresh_mutex);
 
-	return (needle->uid == entry->uid);
+	slurm_thread_join(refresh_tid);
+
+	slurm_mutex_lock(&refresh_mutex);
+	FREE_NULL_LIST(refresh_list);
+	refresh_shutdown = false;
+	slurm_mutex_unlock(&refresh_mutex);
+
+	slurm_rwlock_wrlock(&gids_lock);
+	xhash_free_ptr(&gids_cache);
+	slurm_rwlock_unlock(&gids_lock);
 }
 
 /*
- * This populates a new entry (or re-populates an old entry) using getpwuid_r()
- * to determine the primary group. getpwuid_r() should be used here instead of
- * the job's group to handle when the job was submited with a secondary group.
+ * Create a new entry using getpwuid_r() to determine the primary group and
+ * getgrouplist() for the extended groups. getpwuid_r() should be used here
+ * instead of the job's group to handle when the job was submited with a
+ * secondary group.
+ *
+ * On failure of getpwuid_r(), a negative entry is returned and the caller will
+ * fallback to the job's group since it is the only "safe" group we can
+ * determine.
  *
- * On failure of getpwuid_r(), we will fallback to the job's group since it is
- * the only "safe" group we can determine.
+ * WARNING: may block on the name service, never call with gids_lock held.
  */
-static void _init_or_reinit_entry(gids_cache_t **in,
-				  gids_cache_needle_t *needle)
+static gids_cache_t *_fetch_entry(uid_t uid)
 {
 	char buf_stack[PW_BUF_SIZE];
 	char *buf_malloc = NULL;
@@ -119,44 +158,16 @@ static void _init_or_reinit_entry(gids_cache_t **in,
 	gids_cache_t *entry;
 	struct passwd pwd, *result;
 
-	xassert(needle);
+	entry = xmalloc(sizeof(*entry));
+	entry->uid = uid;
 
-	slurm_getpwuid_r(needle->uid, &pwd, &curr_buf, &buf_malloc, &bufsize,
-			 &result);
+	slurm_getpwuid_r(uid, &pwd, &curr_buf, &buf_malloc, &bufsize, &result);
 	if (!result || !result->pw_name) {
-		if (*in) {
-			/* discard this now-invalid cache entry */
-			list_delete_ptr(gids_cache_list, *in);
-			*in = NULL;
-		}
+		error("failed to init group cache entry for uid=%u", uid);
+		entry->expiration = time(NULL) +
+			MIN(slurm_conf.group_time, NEGATIVE_CACHE_TIME);
 		xfree(buf_malloc);
-		return;
-	}
-
-	if (*in) {
-		/*
-		 * Reusing the existing cache record. Reset ngids to the
-		 * current buffer size to avoid needing to loop around
-		 * on getgrouplist() to determine the correct size.
-		 */
-		entry = *in;
-		entry->ngids = xsize(entry->gids) / sizeof(gid_t);
-
-		if (xstrcmp(entry->username, result->pw_name)) {
-			error("Cached username %s did not match queried username %s?",
-			      entry->username, result->pw_name);
-			xfree(entry->username);
-		}
-
-		if (entry->gid != result->pw_gid)
-			debug("Cached user=%s changed primary gid from %u to %u?",
-			      result->pw_name, entry->gid, result->pw_gid);
-	} else {
-		/* Brand new entry */
-		entry = xmalloc(sizeof(*entry));
-		entry->uid = needle->uid;
-		entry->ngids = NGROUPS_START;
-		entry->gids = xcalloc(NGROUPS_START, sizeof(gid_t));
+		return entry;
 	}
 
 	/*
@@ -168,18 +179,160 @@ static void _init_or_reinit_entry(gids_cache_t **in,
 	 * primary gid.
 	 */
 	entry->gid = result->pw_gid;
+	entry->username = xstrdup(result->pw_name);
+	entry->ngids = NGROUPS_START;
+	entry->gids = xcalloc(NGROUPS_START, sizeof(gid_t));
+	xfree(buf_malloc);
 
-	/* Reuse cached value if possible to skip an xstrdup() */
-	if (!entry->username)
-		entry->username = xstrdup(result->pw_name);
+#if defined(__APPLE__)
+	/*
+	 * macOS has (int *) for the third argument instead
+	 * of (gid_t *) like FreeBSD, NetBSD, and Linux.
+	 */
+	while (getgrouplist(entry->username, entry->gid,
+			    (int *)entry->gids, &entry->ngids) == -1) {
+#else
+	/*
+	 * entry->gid will be in the result. This is the users primary
+	 * group as determined from passwd.
+	 */
+	while (getgrouplist(entry->username, entry->gid,
+			    entry->gids, &entry->ngids) == -1) {
+#endif
+		/* group list larger than array, resize array to fit */
+		entry->gids = xrecalloc(entry->gids, entry->ngids,
+					sizeof(gid_t));
+	}
 
 	entry->expiration = time(NULL) + slurm_conf.group_time;
 
-	if (!*in) {
-		*in = entry;
-		list_prepend(gids_cache_list, entry);
+	return entry;
+}
+
+/* Insert entry into the cache, replacing any older entry for the uid */
+static void _store_entry(gids_cache_t *entry)
+{
+	gids_cache_t *old;
+
+	slurm_rwlock_wrlock(&gids_lock);
+	if (!gids_cache)
+		gids_cache = xhash_init(_group_cache_id, _group_cache_delete);
+
+	if ((old = xhash_pop(gids_cache, (const char *) &entry->uid,
+			     sizeof(entry->uid)))) {
+		if (old->username && entry->username &&
+		    xstrcmp(old->username, entry->username))
+			error("Cached username %s did not match queried username %s?",
+			      old->username, entry->username);
+
+		if (old->username && entry->username &&
+		    (old->gid != entry->gid))
+			debug("Cached user=%s changed primary gid from %u to %u?",
+			      entry->username, old->gid, entry->gid);
+
+		_group_cache_delete(old);
 	}
-	xfree(buf_malloc);
+
+	xhash_add(gids_cache, entry);
+	slurm_rwlock_unlock(&gids_lock);
+}
+
+static int _copy_entry(gids_cache_t *entry, gids_cache_needle_t *needle,
+		       gid_t **gids)
+{
+	xfree(*gids);
+
+	if (!entry->username) {
+		/*
+		 * getgrouplist() does not have a way to signal failure, so
+		 * return the primary group as the single member of the
+		 * extended group list.
+		 */
+		*gids = xmalloc(sizeof(gid_t));
+		(*gids)[0] = needle->gid;
+		return 1;
+	}
+
+	*gids = copy_gids(entry->ngids, entry->gids);
+	return entry->ngids;
+}
+
+static void _purge_expired(void *x, void *arg)
+{
+	gids_cache_t *cached = x;
+	time_t *now = arg;
+
+	if (cached->expiration < *now)
+		xhash_delete(gids_cache, (const char *) &cached->uid,
+			     sizeof(cached->uid));
+}
+
+static void *_refresh_thread(void *arg)
+{
+	struct timespec ts = { 0 };
+
+	slurm_mutex_lock(&refresh_mutex);
+	while (!refresh_shutdown) {
+		gids_cache_t *entry;
+		uid_t *uid;
+
+		if (!(uid = list_pop(refresh_list))) {
+			if (ts.tv_sec <= time(NULL)) {
+				slurm_mutex_unlock(&refresh_mutex);
+				group_cache_cleanup();
+				slurm_mutex_lock(&refresh_mutex);
+				ts.tv_sec = time(NULL) + slurm_conf.group_time;
+			}
+			slurm_cond_timedwait(&refresh_cond, &refresh_mutex,
+					     &ts);
+			continue;
+		}
+		slurm_mutex_unlock(&refresh_mutex);
+
+		debug2("%s: refreshing entry for uid=%u", __func__, *uid);
+
+		/*
+		 * Keep the current entry on failure instead of replacing it
+		 * with a negative entry. It will be fetched again by the next
+		 * lookup once it expires.
+		 */
+		if ((entry = _fetch_entry(*uid))->username)
+			_store_entry(entry);
+		else
+			_group_cache_delete(entry);
+		xfree(uid);
+
+		slurm_mutex_lock(&refresh_mutex);
+	}
+	slurm_mutex_unlock(&refresh_mutex);
+
+	return NULL;
+}
+
+/* Queue entry for a background refresh. Caller must hold gids_lock. */
+static void _queue_refresh(gids_cache_t *entry)
+{
+	uid_t *uid;
+
+	if (__atomic_exchange_n(&entry->refresh_queued, true, __ATOMIC_SEQ_CST))
+		return;
+
+	uid = xmalloc(sizeof(*uid));
+	*uid = entry->uid;
+
+	slurm_mutex_lock(&refresh_mutex);
+	if (refresh_shutdown) {
+		slurm_mutex_unlock(&refresh_mutex);
+		xfree(uid);
+		return;
+	}
+	if (!refresh_list)
+		refresh_list = list_create(xfree_ptr);
+	list_append(refresh_list, uid);
+	if (!refresh_tid)
+		slurm_thread_create(&refresh_tid, _refresh_thread, NULL);
+	slurm_cond_signal(&refresh_cond);
+	slurm_mutex_unlock(&refresh_mutex);
 }
 
 /*
@@ -190,20 +343,28 @@ static void _init_or_reinit_entry(gids_cache_t **in,
  */
 static int _group_cache_lookup_internal(gids_cache_needle_t *needle, gid_t **gids)
 {
-	gids_cache_t *entry;
-	int ngids; /* need a copy to safely return outside the lock */
+	gids_cache_t *entry = NULL;
+	time_t now = time(NULL);
+	int ngids;
 	DEF_TIMERS;
 	START_TIMER;
 
-	slurm_mutex_lock(&gids_mutex);
-	if (!gids_cache_list)
-		gids_cache_list = list_create(_group_cache_list_delete);
+	slurm_rwlock_rdlock(&gids_lock);
+	if (gids_cache)
+		entry = xhash_get(gids_cache, (const char *) &needle->uid,
+				  sizeof(needle->uid));
 
-	entry = list_find_first(gids_cache_list, _find_entry, needle);
+	if (entry && (entry->expiration > now)) {
+		debug2("%s: found valid entry for uid=%u",
+		       __func__, entry->uid);
+		ngids = _copy_entry(entry, needle, gids);
+
+		if (entry->username &&
+		    ((entry->expiration - now) <=
+		     (slurm_conf.group_time / REFRESH_FRACTION)))
+			_queue_refresh(entry);
 
-	if (entry && (entry->expiration > time(NULL))) {
-		debug2("%s: found valid entry for user=%s",
-		       __func__, entry->username);
+		slurm_rwlock_unlock(&gids_lock);
 		goto out;
 	}
 
@@ -214,55 +375,21 @@ static int _group_cache_lookup_internal(gids_cache_needle_t *needle, gid_t **gid
 	} else {
 		debug2("%s: no entry found for uid=%u", __func__, needle->uid);
 	}
-
-	_init_or_reinit_entry(&entry, needle);
-
-	if (!entry) {
-		error("failed to init group cache entry for uid=%u",
-		      needle->uid);
-
-		/*
-		 * getgrouplist() does not have a way to signal failure, so
-		 * return the primary group as the single member of the
-		 * extended group list.
-		 */
-		*gids = xmalloc(sizeof(gid_t));
-		*gids[0] = needle->gid;
-		slurm_mutex_unlock(&gids_mutex);
-		return 1;
-	}
+	slurm_rwlock_unlock(&gids_lock);
 
 	/*
 	 * Cache lookup failed or entry value was too old, fetch new value and
 	 * insert it into cache.
 	 */
-#if defined(__APPLE__)
-	/*
-	 * macOS has (int *) for the third argument instead
-	 * of (gid_t *) like FreeBSD, NetBSD, and Linux.
-	 */
-	while (getgrouplist(entry->username, entry->gid,
-			    (int *)entry->gids, &entry->ngids) == -1) {
-#else
-	/*
-	 * entry->gid will be in the result. This is the users primary
-	 * group as determined from passwd.
-	 */
-	while (getgrouplist(entry->username, entry->gid,
-			    entry->gids, &entry->ngids) == -1) {
-#endif
-		/* group list larger than array, resize array to fit */
-		entry->gids = xrecalloc(entry->gids, entry->ngids,
-					sizeof(gid_t));
-	}
-
-out:
-	ngids = entry->ngids;
-	xfree(*gids);
-	*gids = copy_gids(entry->ngids, entry->gids);
+	entry = _fetch_entry(needle->uid);
+	ngids = _copy_entry(entry, needle, gids);
 
-	slurm_mutex_unlock(&gids_mutex);
+	if (slurm_conf.group_time)
+		_store_entry(entry);
+	else
+		_group_cache_delete(entry);
 
+out:
 	END_TIMER3("group_cache_lookup() took",
 		   3000000);
 
@@ -287,17 +414,6 @@ extern int group_cache_lookup(uid_t uid, gid_t gid, char *username, gid_t **gids
 	return _group_cache_lookup_internal(&needle, gids);
 }
 
-static int _cleanup_search(void *x, void *key)
-{
-	gids_cache_t *cached = (gids_cache_t *) x;
-	time_t *now = (time_t *) key;
-
-	if (cached->expiration < *now)
-		return 1;
-
-	return 0;
-}
-
 /*
  * Call periodically to remove old records.
  */
@@ -305,10 +421,9 @@ extern void group_cache_cleanup(void)
 {
 	time_t now = time(NULL);
 
-	slurm_mutex_lock(&gids_mutex);
-	if (gids_cache_list)
-		list_delete_all(gids_cache_list, _cleanup_search, &now);
-	slurm_mutex_unlock(&gids_mutex);
+	slurm_rwlock_wrlock(&gids_lock);
+	xhash_walk(gids_cache, _purge_expired, &now);
+	slurm_rwlock_unlock(&gids_lock);
 }
 
 extern gid_t *copy_gids(int ngids, gid_t *gids)
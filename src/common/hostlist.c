@@ -1872,6 +1872,49 @@ int hostlist_push(hostlist_t *hl, const char *hosts)
 	return retval;
 }
 
+/*
+ * Extend the last hostrange of hl with str without any allocations when str
+ * is the next host of that range (e.g. pushing "node13" onto "node[01-12]").
+ * Only handles single dimension hostnames.
+ * RET true if str was added to hl
+ */
+static bool _hostlist_extend_tail(hostlist_t *hl, const char *str)
+{
+	hostrange_t *tail;
+	unsigned long num;
+	char *end = NULL;
+	int idx = host_prefix_end(str, 1);
+	int width = strlen(str) - idx - 1;
+	bool extended = false;
+
+	/* no numeric suffix */
+	if (width <= 0)
+		return false;
+
+	num = strtoul(str + idx + 1, &end, 10);
+	if (*end != '\0')
+		return false;
+
+	LOCK_HOSTLIST(hl);
+
+	if (hl->nranges > 0) {
+		tail = hl->hr[hl->nranges - 1];
+
+		if (!tail->singlehost && (tail->width == width) &&
+		    (tail->hi == (num - 1)) &&
+		    !strncmp(tail->prefix, str, (idx + 1)) &&
+		    (tail->prefix[idx + 1] == '\0')) {
+			tail->hi = num;
+			hl->nhosts++;
+			extended = true;
+		}
+	}
+
+	UNLOCK_HOSTLIST(hl);
+
+	return extended;
+}
+
 int hostlist_push_host_dims(hostlist_t *hl, const char *str, int dims)
 {
 	hostrange_t *hr;
@@ -1883,6 +1926,9 @@ int hostlist_push_host_dims(hostlist_t *hl, const char *str, int dims)
 	if (!dims)
 		dims = slurmdb_setup_cluster_dims();
 
+	if ((dims == 1) && _hostlist_extend_tail(hl, str))
+		return 1;
+
 	hn = hostname_create_dims(str, dims);
 
 	if (hostname_suffix_is_valid(hn))
@@ -2846,11 +2892,75 @@ char *hostlist_ranged_string_malloc(hostlist_t *hl)
 	return buf;
 }
 
+/*
+ * Single pass version of hostlist_ranged_string_dims() for one dimension
+ * which grows the output string as needed instead of reformatting the whole
+ * hostlist into a larger buffer on truncation.
+ */
+static char *_ranged_string_xmalloc(hostlist_t *hl, int brackets)
+{
+	char *str = NULL, *pos = NULL;
+
+	LOCK_HOSTLIST(hl);
+
+	for (int i = 0; i < hl->nranges;) {
+		int end = i + 1;
+		bool bracket;
+
+		/* find all ranges that go into the same bracketed list */
+		while ((end < hl->nranges) &&
+		       hostrange_within_range(hl->hr[end], hl->hr[end - 1]))
+			end++;
+
+		bracket = brackets && (((end - i) > 1) ||
+				       (hostrange_count(hl->hr[i]) > 1));
+
+		if (i)
+			xstrcatat(str, &pos, ",");
+		xstrcatat(str, &pos, hl->hr[i]->prefix);
+		if (bracket)
+			xstrcatat(str, &pos, "[");
+
+		for (int j = i; j < end; j++) {
+			/* lo and hi with padding plus '-' and '\0' */
+			char num[(2 * MAX(hl->hr[j]->width, 24)) + 2];
+			ssize_t len = hostrange_numstr(hl->hr[j], sizeof(num),
+						       num);
+
+			xassert(len >= 0);
+			if (j > i)
+				xstrcatat(str, &pos, ",");
+			if (len > 0)
+				xstrcatat(str, &pos, num);
+		}
+
+		if (bracket)
+			xstrcatat(str, &pos, "]");
+
+		i = end;
+	}
+
+	UNLOCK_HOSTLIST(hl);
+
+	if (!str)
+		str = xstrdup("");
+
+	return str;
+}
+
 char *hostlist_ranged_string_xmalloc_dims(hostlist_t *hl, int dims,
 					  int brackets)
 {
 	int buf_size = 8192;
-	char *buf = xmalloc_nz(buf_size);
+	char *buf;
+
+	if (!dims)
+		dims = slurmdb_setup_cluster_dims();
+
+	if (dims == 1)
+		return _ranged_string_xmalloc(hl, brackets);
+
+	buf = xmalloc_nz(buf_size);
 	while (hostlist_ranged_string_dims(
 		       hl, buf_size, buf, dims, brackets) < 0) {
 		buf_size *= 2;
@@ -70,12 +70,12 @@ extern list_t *purge_files_list; /* list of job ids to purge files of */
 typedef struct {
 	uint32_t magic;			/* magic cookie for data integrity */
 					/* DO NOT ALPHABETIZE */
+	uint32_t argc;			/* count of argv elements */
 	char *acctg_freq;		/* accounting polling interval */
 	time_t accrue_time;             /* Time when we start accruing time for
 					 * priority, */
 	uint16_t *arbitrary_tpn;	/* array of the number of tasks on each
 					 * node for arbitrary distribution */
-	uint32_t argc;			/* count of argv elements */
 	char **argv;			/* arguments for a batch job script */
 	time_t begin_time;		/* start at this time (srun --begin),
 					 * resets to time first eligible
@@ -84,29 +84,28 @@ typedef struct {
 	uint16_t contiguous;		/* set if requires contiguous nodes */
 	uint16_t core_spec;		/* specialized core/thread count,
 					 * threads if CORE_SPEC_THREAD flag set */
+	uint16_t cpu_bind_type;		/* Default CPU bind type for steps,
+					 * see cpu_bind_type_t */
+	uint16_t cpus_per_task;		/* number of processors required for
+					 * each task */
 	char *cpu_bind;			/* binding map for map/mask_cpu - This
 					 * currently does not matter to the
 					 * job allocation, setting this does
 					 * not do anything for steps. */
-	uint16_t cpu_bind_type;		/* Default CPU bind type for steps,
-					 * see cpu_bind_type_t */
 	uint32_t cpu_freq_min;  	/* Minimum cpu frequency  */
 	uint32_t cpu_freq_max;  	/* Maximum cpu frequency  */
 	uint32_t cpu_freq_gov;  	/* cpu frequency governor */
-	uint16_t cpus_per_task;		/* number of processors required for
-					 * each task */
+	uint16_t orig_cpus_per_task;	/* requested value of cpus_per_task */
+	uint16_t env_cnt;		/* size of env_sup (see below) */
 	cron_entry_t *crontab_entry;	/* crontab entry (job submitted through
 					 * scrontab) */
-	uint16_t orig_cpus_per_task;	/* requested value of cpus_per_task */
 	list_t *depend_list;		/* list of job_ptr:state pairs */
 	char *dependency;		/* wait for other jobs */
 	char *orig_dependency;		/* original value (for archiving) */
-	uint16_t env_cnt;		/* size of env_sup (see below) */
 	char *env_hash;			/* hash value of environment */
 	char **env_sup;			/* supplemental environment variables */
 	bitstr_t *exc_node_bitmap;	/* bitmap of excluded nodes */
 	char *exc_nodes;		/* excluded nodes */
-	uint32_t expanding_jobid;	/* ID of job to be expanded */
 	list_t *feature_list;		/* required features with node counts */
 	list_t *feature_list_use;	/* Use these features for scheduling,
 					 * DO NOT FREE or PACK */
@@ -117,9 +116,11 @@ typedef struct {
 	uint32_t max_cpus;		/* maximum number of cpus */
 	uint32_t orig_max_cpus;		/* requested value of max_cpus */
 	uint32_t max_nodes;		/* maximum number of nodes */
+	uint32_t expanding_jobid;	/* ID of job to be expanded */
 	multi_core_data_t *mc_ptr;	/* multi-core specific data */
 	char *mem_bind;			/* binding map for map/mask_cpu */
 	uint16_t mem_bind_type;		/* see mem_bind_type_t */
+	uint16_t x11;			/* --x11 flags */
 	uint32_t min_cpus;		/* minimum number of cpus */
 	uint32_t orig_min_cpus;		/* requested value of min_cpus */
 	int min_gres_cpu;		/* Minimum CPU count per node required
@@ -136,21 +137,23 @@ typedef struct {
 	uint32_t num_tasks;		/* number of tasks to start */
 	uint8_t open_mode;		/* stdout/err append or truncate */
 	uint8_t overcommit;		/* processors being over subscribed */
+	uint8_t whole_node;		/* WHOLE_NODE_REQUIRED: 1: --exclusive
+					 * WHOLE_NODE_USER: 2: --exclusive=user
+					 * WHOLE_NODE_MCS:  3: --exclusive=mcs */
+	uint16_t x11_target_port;	/* target TCP port on alloc_node */
 
 	/* job constraints: */
 	uint32_t pn_min_cpus;		/* minimum processors per node */
 	uint32_t orig_pn_min_cpus;	/* requested value of pn_min_cpus */
+	uint32_t pn_min_tmp_disk;	/* minimum tempdisk per node, MB */
 	uint64_t pn_min_memory;		/* minimum memory per node (MB) OR
 					 * memory per allocated
 					 * CPU | MEM_PER_CPU */
 	uint64_t orig_pn_min_memory;	/* requested value of pn_min_memory */
-	uint32_t pn_min_tmp_disk;	/* minimum tempdisk per node, MB */
-	list_t *prefer_list;		/* soft features with node counts */
-	char *prefer;			/* soft features */
-	uint8_t prolog_running;		/* set while prolog_slurmctld is
-					 * running */
 	uint32_t reserved_resources;	/* CPU minutes of resources reserved
 					 * for this job while it was pending */
+	list_t *prefer_list;		/* soft features with node counts */
+	char *prefer;			/* soft features */
 	bitstr_t *req_node_bitmap;	/* bitmap of required nodes */
 	time_t preempt_start_time;	/* time that preeption began to start
 					 * this job */
@@ -161,6 +164,8 @@ typedef struct {
 	uint16_t segment_size;
 	uint8_t share_res;		/* set if job can share resources with
 					 * other jobs */
+	uint8_t prolog_running;		/* set while prolog_slurmctld is
+					 * running */
 	char *script;			/* DBD USE ONLY DON'T PACK:
 					 * job's script */
 	char *script_hash;              /* hash value of script NO NOT PACK */
@@ -174,14 +179,9 @@ typedef struct {
 					 * useful when Consumable Resources
 					 * is enabled */
 	uint32_t usable_nodes;		/* node count needed by preemption */
-	uint8_t whole_node;		/* WHOLE_NODE_REQUIRED: 1: --exclusive
-					 * WHOLE_NODE_USER: 2: --exclusive=user
-					 * WHOLE_NODE_MCS:  3: --exclusive=mcs */
 	char *work_dir;			/* pathname of working directory */
-	uint16_t x11;			/* --x11 flags */
 	char *x11_magic_cookie;		/* x11 magic cookie */
 	char *x11_target;		/* target host, or socket if port == 0 */
-	uint16_t x11_target_port;	/* target TCP port on alloc_node */
 } job_details_t;
 
 typedef struct job_array_struct {
@@ -242,22 +242,22 @@ typedef struct job_record job_record_t;
 struct job_record {
 	uint32_t magic;			/* magic cookie for data integrity */
 					/* DO NOT ALPHABETIZE */
+	uint16_t alloc_resp_port;	/* RESPONSE_RESOURCE_ALLOCATION port */
+	uint16_t batch_flag;		/* 1 or 2 if batch job (with script),
+					 * 2 indicates retry mode (one retry) */
 	char    *account;		/* account number to charge */
 	char    *admin_comment;		/* administrator's arbitrary comment */
 	char	*alias_list;		/* node name to address aliases */
 	char    *alloc_node;		/* local node making resource alloc */
-	uint16_t alloc_resp_port;	/* RESPONSE_RESOURCE_ALLOCATION port */
 	uint32_t alloc_sid;		/* local sid making resource alloc */
 	uint32_t array_job_id;		/* job_id of a job array or 0 if N/A */
 	uint32_t array_task_id;		/* task_id of a job array */
+	uint32_t assoc_id;              /* used for accounting plugins */
 	job_array_struct_t *array_recs;	/* job array details,
 					 * only in meta-job record */
-	uint32_t assoc_id;              /* used for accounting plugins */
 	slurmdb_assoc_rec_t *assoc_ptr; /* job's assoc record ptr confirm the
 					 * value before use */
 	char *batch_features;		/* features required for batch script */
-	uint16_t batch_flag;		/* 1 or 2 if batch job (with script),
-					 * 2 indicates retry mode (one retry) */
 	char *batch_host;		/* host executing batch script */
 	double billable_tres;		/* calculated billable tres for the
 					 * job, as defined by the partition's
@@ -275,23 +275,24 @@ struct job_record {
 	uint32_t cpu_cnt;		/* current count of CPUs held
 					 * by the job, decremented while job is
 					 * completing */
-	char *cpus_per_tres;		/* semicolon delimited list of TRES=# values */
 	uint32_t db_flags;              /* Flags to send to the database
 					 * record */
+	char *cpus_per_tres;		/* semicolon delimited list of TRES=# values */
 	uint64_t db_index;              /* used only for database plugins */
 	time_t deadline;		/* deadline */
 	uint32_t delay_boot;		/* Delay boot for desired node mode */
 	uint32_t derived_ec;		/* highest exit code of all job steps */
 	job_details_t *details;		/* job details */
-	uint16_t direct_set_prio;	/* Priority set directly if
-					 * set the system will not
-					 * change the priority any further. */
 	time_t end_time;		/* time execution ended, actual or
 					 * expected. if terminated from suspend
 					 * state, this is time suspend began */
 	time_t end_time_exp;		/* when we believe the job is
 					   going to end. */
+	uint16_t direct_set_prio;	/* Priority set directly if
+					 * set the system will not
+					 * change the priority any further. */
 	bool epilog_running;		/* true of EpilogSlurmctld is running */
+	uint8_t reboot;			/* node reboot requested before start */
 	uint32_t exit_code;		/* exit code for job (status from
 					 * wait call) */
 	char *extra;			/* Arbitrary string */
@@ -315,26 +316,35 @@ struct job_record {
 					 * detail */
 	uint32_t gres_detail_cnt;	/* Count of gres_detail_str records,
 					 * one per allocated node */
+	uint32_t group_id;		/* group submitted under */
 	char **gres_detail_str;		/* Details of GRES index alloc per node */
 	char *gres_used;		/* Actual GRES use added over all nodes
 					 * to be passed to slurmdbd */
-	uint32_t group_id;		/* group submitted under */
 	het_job_details_t *het_details;	/* HetJob details */
 	uint32_t het_job_id;		/* job ID of HetJob leader */
-	char *het_job_id_set;		/* job IDs for all components */
 	uint32_t het_job_offset;	/* HetJob component index */
+	char *het_job_id_set;		/* job IDs for all components */
 	list_t *het_job_list;		/* List of job pointers to all
 					 * components */
 	uint32_t job_id;		/* job ID */
+	uint32_t job_state;		/* state of the job */
 	identity_t *id;			/* job identity */
-	job_record_t *job_next;		/* next entry with same hash index */
-	job_record_t *job_array_next_j;	/* job array linked list by job_id */
-	job_record_t *job_array_next_t;	/* job array linked list by task_id */
+	uint64_t info_gen;		/* job info generation in which the
+					 * packed job info last changed */
+	uint64_t info_hash;		/* hash of packed job info as of
+					 * info_gen */
+	job_record_t *job_array_next_j;	/* next task of same job array */
 	job_record_t *job_preempt_comp; /* het job preempt component */
 	job_resources_t *job_resrcs;	/* details of allocated cores */
-	uint32_t job_state;		/* state of the job */
 	uint16_t kill_on_node_fail;	/* 1 if job should be killed on
 					 * node failure */
+	uint16_t mail_type;		/* see MAIL_JOB_* in slurm.h */
+	uint16_t other_port;		/* port for client communications */
+	bool part_nodes_missing;	/* set if job's nodes removed from this
+					 * partition */
+	bool preempt_in_progress;	/* Preemption of other jobs in progress
+					 * in order to start this job,
+					 * (Internal use only, don't save) */
 	time_t last_sched_eval;		/* last time job was evaluated for scheduling */
 	char *licenses;			/* licenses required by the job */
 	list_t *license_list;		/* structure with license info */
@@ -344,13 +354,13 @@ struct job_record {
 					    * a limit instead of from
 					    * the request, or if the
 					    * limit was set from admin */
-	uint16_t mail_type;		/* see MAIL_JOB_* in slurm.h */
 	char *mail_user;		/* user to get e-mail notification */
 	char *mem_per_tres;		/* semicolon delimited list of TRES=# values */
 	char *mcs_label;		/* mcs_label if mcs plugin in use */
 	char *name;			/* name of the job */
 	char *network;			/* network/switch requirement spec */
 	uint32_t next_step_id;		/* next step id to be used */
+	uint32_t qos_id;		/* quality of service id */
 	char *nodes;			/* list of nodes allocated to job */
 	slurm_addr_t *node_addrs;	/* allocated node addrs */
 	bitstr_t *node_bitmap;		/* bitmap of nodes allocated to job */
@@ -375,39 +385,28 @@ struct job_record {
 					 * used only to dump/load nodes from/to dump file */
 	char *origin_cluster;		/* cluster name that the job was
 					 * submitted from */
-	uint16_t other_port;		/* port for client communications */
 	char *partition;		/* name of job partition(s) */
 	list_t *part_ptr_list;		/* list of pointers to partition recs */
-	bool part_nodes_missing;	/* set if job's nodes removed from this
-					 * partition */
 	part_record_t *part_ptr;	/* pointer to the partition record */
 	priority_parts_t *part_prio;	/* partition based priority */
 	time_t pre_sus_time;		/* time job ran prior to last suspend */
 	time_t preempt_time;		/* job preemption signal time */
-	bool preempt_in_progress;	/* Preemption of other jobs in progress
-					 * in order to start this job,
-					 * (Internal use only, don't save) */
 	uint32_t prep_epilog_cnt;	/* count of epilog async tasks left */
 	uint32_t prep_prolog_cnt;	/* count of prolog async tasks left */
-	bool prep_prolog_failed;	/* any prolog_slurmctld failed */
 	uint32_t priority;		/* relative priority of the job,
 					 * zero == held (don't initiate) */
+	uint32_t profile;		/* Acct_gather_profile option */
 	priority_factors_t *prio_factors; /* cached value of priority factors
 					   * figured out in the priority plugin
 					   */
-	uint32_t profile;		/* Acct_gather_profile option */
 	time_t prolog_launch_time;	/* When the prolog was launched from the
 					 * controller -- PrologFlags=alloc */
-	uint32_t qos_id;		/* quality of service id */
 	slurmdb_qos_rec_t *qos_ptr;	/* pointer to the quality of
 					 * service record used for
 					 * this job, confirm the
 					 * value before use */
 	void *qos_blocking_ptr;		/* internal use only, DON'T PACK */
-	uint8_t reboot;			/* node reboot requested before start */
-	uint16_t restart_cnt;		/* count of restarts */
 	time_t resize_time;		/* time of latest size change */
-	uint32_t resv_id;		/* reservation ID */
 	list_t *resv_list;		/* Filled in if the job is requesting
 					 * more than one reservation,
 					 * DON'T PACK. */
@@ -416,12 +415,14 @@ struct job_record {
 	char *resv_ports;		/* MPI ports reserved for job */
 	int *resv_port_array;		/* MPI reserved port indexes */
 	uint16_t resv_port_cnt;		/* count of MPI ports reserved per node */
+	uint16_t restart_cnt;		/* count of restarts */
 	uint32_t requid;	    	/* requester user ID */
 	char *resp_host;		/* host for srun communications */
 	char *sched_nodes;		/* list of nodes scheduled for job */
 	dynamic_plugin_data_t *select_jobinfo;/* opaque data, BlueGene */
 	char *selinux_context;		/* SELinux context */
 	uint32_t site_factor;		/* factor to consider in priority */
+	uint32_t resv_id;		/* reservation ID */
 	char **spank_job_env;		/* environment variables for job prolog
 					 * and epilog scripts as set by SPANK
 					 * plugins */
@@ -431,9 +432,12 @@ struct job_record {
 					 * creating message or the
 					 * lowest slurmd in the
 					 * allocation */
+	bool prep_prolog_failed;	/* any prolog_slurmctld failed */
 	time_t start_time;		/* time execution begins,
 					 * actual or expected */
 	char *state_desc;		/* optional details for state_reason */
+	uint64_t state_hash;		/* hash of job state last saved to
+					 * StateSaveLocation, 0 if never */
 	uint32_t state_reason;		/* reason job still pending or failed
 					 * see slurm.h:enum job_state_reason */
 	uint32_t state_reason_prev_db;	/* Previous state_reason that isn't
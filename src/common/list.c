@@ -54,6 +54,7 @@
 ** for details.
 */
 strong_alias(list_create,	slurm_list_create);
+strong_alias(list_create_unlocked,	slurm_list_create_unlocked);
 strong_alias(list_destroy,	slurm_list_destroy);
 strong_alias(list_is_empty,	slurm_list_is_empty);
 strong_alias(list_count,	slurm_list_count);
@@ -125,6 +126,7 @@ struct xlist {
 	list_itr_t *iNext;		/* iterator chain for list_destroy() */
 	ListDelF fDel;			/* function to delete node data */
 	pthread_rwlock_t mutex;		/* mutex to protect access to list */
+	bool unlocked;			/* skip mutex for thread local lists */
 	list_node_t *free_nodes;	/* head of unused nodes */
 	list_node_t *node_allocations;	/* memory for additional nodes */
 	list_node_t nodes[];
@@ -146,9 +148,29 @@ static void *_list_node_destroy(list_t *l, list_node_t **pp);
 static void *_list_find_first_locked(list_t *l, ListFindF f, void *key);
 
 #ifndef NDEBUG
-static int _list_mutex_is_locked(pthread_rwlock_t *mutex);
+static int _list_mutex_is_locked(list_t *l);
 #endif
 
+/*
+ * Wrappers around list mutex to allow list_create_unlocked() lists to skip
+ * locking entirely.
+ */
+#define _list_wrlock(l)							\
+	do {								\
+		if (!(l)->unlocked)					\
+			slurm_rwlock_wrlock(&(l)->mutex);		\
+	} while (0)
+#define _list_rdlock(l)							\
+	do {								\
+		if (!(l)->unlocked)					\
+			slurm_rwlock_rdlock(&(l)->mutex);		\
+	} while (0)
+#define _list_unlock(l)							\
+	do {								\
+		if (!(l)->unlocked)					\
+			slurm_rwlock_unlock(&(l)->mutex);		\
+	} while (0)
+
 /***************
  *  Functions  *
  ***************/
@@ -173,6 +195,15 @@ extern list_t *list_create(ListDelF f)
 	return l;
 }
 
+extern list_t *list_create_unlocked(ListDelF f)
+{
+	list_t *l = list_create(f);
+
+	l->unlocked = true;
+
+	return l;
+}
+
 extern void list_destroy(list_t *l)
 {
 	list_itr_t *i, *iTmp;
@@ -180,7 +211,7 @@ extern void list_destroy(list_t *l)
 
 	xassert(l != NULL);
 	xassert(l->magic == LIST_MAGIC);
-	slurm_rwlock_wrlock(&l->mutex);
+	_list_wrlock(l);
 
 	i = l->iNext;
 	while (i) {
@@ -203,7 +234,7 @@ extern void list_destroy(list_t *l)
 		p = pTmp;
 	}
 	l->magic = ~LIST_MAGIC;
-	slurm_rwlock_unlock(&l->mutex);
+	_list_unlock(l);
 	slurm_rwlock_destroy(&l->mutex);
 	xfree(l);
 }
@@ -214,9 +245,9 @@ extern int list_is_empty(list_t *l)
 
 	xassert(l != NULL);
 	xassert(l->magic == LIST_MAGIC);
-	slurm_rwlock_rdlock(&l->mutex);
+	_list_rdlock(l);
 	n = l->count;
-	slurm_rwlock_unlock(&l->mutex);
+	_list_unlock(l);
 
 	return (n == 0);
 }
@@ -233,9 +264,9 @@ extern int list_count(list_t *l)
 		return 0;
 
 	xassert(l->magic == LIST_MAGIC);
-	slurm_rwlock_rdlock(&l->mutex);
+	_list_rdlock(l);
 	n = l->count;
-	slurm_rwlock_unlock(&l->mutex);
+	_list_unlock(l);
 
 	return n;
 }
@@ -254,9 +285,9 @@ extern void list_append(list_t *l, void *x)
 	xassert(l != NULL);
 	xassert(x != NULL);
 	xassert(l->magic == LIST_MAGIC);
-	slurm_rwlock_wrlock(&l->mutex);
+	_list_wrlock(l);
 	_list_node_create(l, l->tail, x);
-	slurm_rwlock_unlock(&l->mutex);
+	_list_unlock(l);
 }
 
 extern int list_append_list(list_t *l, list_t *sub)
@@ -270,8 +301,8 @@ extern int list_append_list(list_t *l, list_t *sub)
 	xassert(sub != NULL);
 	xassert(sub->magic == LIST_MAGIC);
 
-	slurm_rwlock_wrlock(&l->mutex);
-	slurm_rwlock_wrlock(&sub->mutex);
+	_list_wrlock(l);
+	_list_wrlock(sub);
 	p = sub->head;
 	while (p) {
 		_list_node_create(l, l->tail, p->data);
@@ -279,8 +310,8 @@ extern int list_append_list(list_t *l, list_t *sub)
 		p = p->next;
 	}
 
-	slurm_rwlock_unlock(&sub->mutex);
-	slurm_rwlock_unlock(&l->mutex);
+	_list_unlock(sub);
+	_list_unlock(l);
 
 	return n;
 }
@@ -303,14 +334,14 @@ extern int list_transfer_max(list_t *l, list_t *sub, int max)
 	xassert(sub->magic == LIST_MAGIC);
 	xassert(l->fDel == sub->fDel);
 
-	slurm_rwlock_wrlock(&l->mutex);
-	slurm_rwlock_wrlock(&sub->mutex);
+	_list_wrlock(l);
+	_list_wrlock(sub);
 	while ((!max || n <= max) && (v = _list_node_destroy(sub, &sub->head))) {
 		_list_node_create(l, l->tail, v);
 		n++;
 	}
-	slurm_rwlock_unlock(&sub->mutex);
-	slurm_rwlock_unlock(&l->mutex);
+	_list_unlock(sub);
+	_list_unlock(l);
 
 	return n;
 }
@@ -328,8 +359,8 @@ extern int list_transfer_match(list_t *l, list_t *sub, ListFindF f, void *key)
 	xassert(sub->magic == LIST_MAGIC);
 	xassert(l->fDel == sub->fDel);
 
-	slurm_rwlock_wrlock(&l->mutex);
-	slurm_rwlock_wrlock(&sub->mutex);
+	_list_wrlock(l);
+	_list_wrlock(sub);
 
 	pp = &l->head;
 	while (*pp) {
@@ -343,8 +374,8 @@ extern int list_transfer_match(list_t *l, list_t *sub, ListFindF f, void *key)
 		}
 	}
 
-	slurm_rwlock_unlock(&sub->mutex);
-	slurm_rwlock_unlock(&l->mutex);
+	_list_unlock(sub);
+	_list_unlock(l);
 
 	return n;
 }
@@ -382,8 +413,8 @@ extern int list_transfer_unique(list_t *l, ListFindF f, list_t *sub)
 	xassert(sub->magic == LIST_MAGIC);
 	xassert(l->fDel == sub->fDel);
 
-	slurm_rwlock_wrlock(&l->mutex);
-	slurm_rwlock_wrlock(&sub->mutex);
+	_list_wrlock(l);
+	_list_wrlock(sub);
 
 	pp = &sub->head;
 	while (*pp) {
@@ -401,8 +432,8 @@ extern int list_transfer_unique(list_t *l, ListFindF f, list_t *sub)
 			pp = &(*pp)->next;
 	}
 
-	slurm_rwlock_unlock(&sub->mutex);
-	slurm_rwlock_unlock(&l->mutex);
+	_list_unlock(sub);
+	_list_unlock(l);
 
 	return n;
 }
@@ -426,13 +457,13 @@ static void *_list_find_first_lock(list_t *l, ListFindF f, void *key,
 	xassert(f != NULL);
 	xassert(l->magic == LIST_MAGIC);
 	if (write_lock)
-		slurm_rwlock_wrlock(&l->mutex);
+		_list_wrlock(l);
 	else
-		slurm_rwlock_rdlock(&l->mutex);
+		_list_rdlock(l);
 
 	v = _list_find_first_locked(l, f, key);
 
-	slurm_rwlock_unlock(&l->mutex);
+	_list_unlock(l);
 
 	return v;
 }
@@ -459,7 +490,7 @@ extern void *list_remove_first(list_t *l, ListFindF f, void *key)
 	xassert(f != NULL);
 	xassert(key != NULL);
 	xassert(l->magic == LIST_MAGIC);
-	slurm_rwlock_wrlock(&l->mutex);
+	_list_wrlock(l);
 
 	pp = &l->head;
 	while (*pp) {
@@ -470,7 +501,7 @@ extern void *list_remove_first(list_t *l, ListFindF f, void *key)
 			pp = &(*pp)->next;
 		}
 	}
-	slurm_rwlock_unlock(&l->mutex);
+	_list_unlock(l);
 
 	return v;
 }
@@ -484,7 +515,7 @@ extern int list_delete_all(list_t *l, ListFindF f, void *key)
 	xassert(l != NULL);
 	xassert(f != NULL);
 	xassert(l->magic == LIST_MAGIC);
-	slurm_rwlock_wrlock(&l->mutex);
+	_list_wrlock(l);
 
 	pp = &l->head;
 	while (*pp) {
@@ -499,7 +530,7 @@ extern int list_delete_all(list_t *l, ListFindF f, void *key)
 			pp = &(*pp)->next;
 		}
 	}
-	slurm_rwlock_unlock(&l->mutex);
+	_list_unlock(l);
 
 	return n;
 }
@@ -513,7 +544,7 @@ extern int list_delete_first(list_t *l, ListFindF f, void *key)
 	xassert(l != NULL);
 	xassert(f != NULL);
 	xassert(l->magic == LIST_MAGIC);
-	slurm_rwlock_wrlock(&l->mutex);
+	_list_wrlock(l);
 
 	pp = &l->head;
 	while (*pp) {
@@ -533,7 +564,7 @@ extern int list_delete_first(list_t *l, ListFindF f, void *key)
 			pp = &(*pp)->next;
 		}
 	}
-	slurm_rwlock_unlock(&l->mutex);
+	_list_unlock(l);
 
 	return n;
 }
@@ -547,7 +578,7 @@ extern int list_delete_ptr(list_t *l, void *key)
 	xassert(l);
 	xassert(key);
 	xassert(l->magic == LIST_MAGIC);
-	slurm_rwlock_wrlock(&l->mutex);
+	_list_wrlock(l);
 
 	pp = &l->head;
 	while (*pp) {
@@ -561,7 +592,7 @@ extern int list_delete_ptr(list_t *l, void *key)
 		} else
 			pp = &(*pp)->next;
 	}
-	slurm_rwlock_unlock(&l->mutex);
+	_list_unlock(l);
 
 	return n;
 }
@@ -596,9 +627,9 @@ extern int list_for_each_max(list_t *l, int *max, ListForF f, void *arg,
 	xassert(l->magic == LIST_MAGIC);
 
 	if (write_lock)
-		slurm_rwlock_wrlock(&l->mutex);
+		_list_wrlock(l);
 	else
-		slurm_rwlock_rdlock(&l->mutex);
+		_list_rdlock(l);
 
 	for (p = l->head; (*max == -1 || n < *max) && p; p = p->next) {
 		n++;
@@ -609,7 +640,7 @@ extern int list_for_each_max(list_t *l, int *max, ListForF f, void *arg,
 		}
 	}
 	*max = l->count - n;
-	slurm_rwlock_unlock(&l->mutex);
+	_list_unlock(l);
 
 	if (failed)
 		n = -n;
@@ -630,7 +661,7 @@ extern int list_flush_max(list_t *l, int max)
 
 	xassert(l != NULL);
 	xassert(l->magic == LIST_MAGIC);
-	slurm_rwlock_wrlock(&l->mutex);
+	_list_wrlock(l);
 
 	pp = &l->head;
 	for (int i = 0; (max < 0 || i < max) && *pp; i++) {
@@ -640,7 +671,7 @@ extern int list_flush_max(list_t *l, int max)
 			n++;
 		}
 	}
-	slurm_rwlock_unlock(&l->mutex);
+	_list_unlock(l);
 
 	return n;
 }
@@ -650,9 +681,9 @@ extern void list_push(list_t *l, void *x)
 	xassert(l != NULL);
 	xassert(x != NULL);
 	xassert(l->magic == LIST_MAGIC);
-	slurm_rwlock_wrlock(&l->mutex);
+	_list_wrlock(l);
 	_list_node_create(l, &l->head, x);
-	slurm_rwlock_unlock(&l->mutex);
+	_list_unlock(l);
 }
 
 /*
@@ -669,34 +700,32 @@ extern void list_sort(list_t *l, ListCmpF f)
 {
 	char **v;
 	int n;
-	int lsize;
-	void *e;
+	list_node_t *p;
 	list_itr_t *i;
 
 	xassert(l != NULL);
 	xassert(f != NULL);
 	xassert(l->magic == LIST_MAGIC);
-	slurm_rwlock_wrlock(&l->mutex);
+	_list_wrlock(l);
 
 	if (l->count <= 1) {
-		slurm_rwlock_unlock(&l->mutex);
+		_list_unlock(l);
 		return;
 	}
 
-	lsize = l->count;
-	v = xmalloc(lsize * sizeof(char *));
+	v = xmalloc(l->count * sizeof(char *));
 
 	n = 0;
-	while ((e = _list_node_destroy(l, &l->head))) {
-		v[n] = e;
-		++n;
-	}
+	for (p = l->head; p; p = p->next)
+		v[n++] = p->data;
+	xassert(n == l->count);
 
 	qsort(v, n, sizeof(char *), (ConstListCmpF)f);
 
-	for (n = 0; n < lsize; n++) {
-		 _list_node_create(l, l->tail, v[n]);
-	}
+	/* Sort in place by reassigning data instead of relinking nodes */
+	n = 0;
+	for (p = l->head; p; p = p->next)
+		p->data = v[n++];
 
 	xfree(v);
 
@@ -709,7 +738,7 @@ extern void list_sort(list_t *l, ListCmpF f)
 		i->prev = &i->list->head;
 	}
 
-	slurm_rwlock_unlock(&l->mutex);
+	_list_unlock(l);
 }
 
 /*
@@ -722,10 +751,10 @@ extern void list_flip(list_t *l)
 
 	xassert(l);
 	xassert(l->magic == LIST_MAGIC);
-	slurm_rwlock_wrlock(&l->mutex);
+	_list_wrlock(l);
 
 	if (l->count <= 1) {
-		slurm_rwlock_unlock(&l->mutex);
+		_list_unlock(l);
 		return;
 	}
 
@@ -749,7 +778,7 @@ extern void list_flip(list_t *l)
 		i->prev = &i->list->head;
 	}
 
-	slurm_rwlock_unlock(&l->mutex);
+	_list_unlock(l);
 }
 
 extern void *list_pop(list_t *l)
@@ -758,9 +787,9 @@ extern void *list_pop(list_t *l)
 
 	xassert(l != NULL);
 	xassert(l->magic == LIST_MAGIC);
-	slurm_rwlock_wrlock(&l->mutex);
+	_list_wrlock(l);
 	v = _list_node_destroy(l, &l->head);
-	slurm_rwlock_unlock(&l->mutex);
+	_list_unlock(l);
 
 	return v;
 }
@@ -771,10 +800,10 @@ extern void *list_peek(list_t *l)
 
 	xassert(l != NULL);
 	xassert(l->magic == LIST_MAGIC);
-	slurm_rwlock_rdlock(&l->mutex);
+	_list_rdlock(l);
 
 	v = (l->head) ? l->head->data : NULL;
-	slurm_rwlock_unlock(&l->mutex);
+	_list_unlock(l);
 
 	return v;
 }
@@ -792,14 +821,14 @@ extern list_itr_t *list_iterator_create(list_t *l)
 	i->magic = LIST_ITR_MAGIC;
 	i->list = l;
 	xassert(l->magic == LIST_MAGIC);
-	slurm_rwlock_wrlock(&l->mutex);
+	_list_wrlock(l);
 
 	i->pos = l->head;
 	i->prev = &l->head;
 	i->iNext = l->iNext;
 	l->iNext = i;
 
-	slurm_rwlock_unlock(&l->mutex);
+	_list_unlock(l);
 
 	return i;
 }
@@ -809,12 +838,12 @@ extern void list_iterator_reset(list_itr_t *i)
 	xassert(i != NULL);
 	xassert(i->magic == LIST_ITR_MAGIC);
 	xassert(i->list->magic == LIST_MAGIC);
-	slurm_rwlock_wrlock(&i->list->mutex);
+	_list_wrlock(i->list);
 
 	i->pos = i->list->head;
 	i->prev = &i->list->head;
 
-	slurm_rwlock_unlock(&i->list->mutex);
+	_list_unlock(i->list);
 }
 
 extern void list_iterator_destroy(list_itr_t *i)
@@ -824,7 +853,7 @@ extern void list_iterator_destroy(list_itr_t *i)
 	xassert(i != NULL);
 	xassert(i->magic == LIST_ITR_MAGIC);
 	xassert(i->list->magic == LIST_MAGIC);
-	slurm_rwlock_wrlock(&i->list->mutex);
+	_list_wrlock(i->list);
 
 	for (pi = &i->list->iNext; *pi; pi = &(*pi)->iNext) {
 		xassert((*pi)->magic == LIST_ITR_MAGIC);
@@ -833,7 +862,7 @@ extern void list_iterator_destroy(list_itr_t *i)
 			break;
 		}
 	}
-	slurm_rwlock_unlock(&i->list->mutex);
+	_list_unlock(i->list);
 
 	i->magic = ~LIST_ITR_MAGIC;
 	xfree(i);
@@ -858,11 +887,11 @@ extern void *list_next(list_itr_t *i)
 	xassert(i != NULL);
 	xassert(i->magic == LIST_ITR_MAGIC);
 	xassert(i->list->magic == LIST_MAGIC);
-	slurm_rwlock_wrlock(&i->list->mutex);
+	_list_wrlock(i->list);
 
 	rc = _list_next_locked(i);
 
-	slurm_rwlock_unlock(&i->list->mutex);
+	_list_unlock(i->list);
 
 	return rc;
 }
@@ -874,11 +903,11 @@ extern void *list_peek_next(list_itr_t *i)
 	xassert(i != NULL);
 	xassert(i->magic == LIST_ITR_MAGIC);
 	xassert(i->list->magic == LIST_MAGIC);
-	slurm_rwlock_rdlock(&i->list->mutex);
+	_list_rdlock(i->list);
 
 	p = i->pos;
 
-	slurm_rwlock_unlock(&i->list->mutex);
+	_list_unlock(i->list);
 
 	return (p ? p->data : NULL);
 }
@@ -890,9 +919,9 @@ extern void list_insert(list_itr_t *i, void *x)
 	xassert(i->magic == LIST_ITR_MAGIC);
 	xassert(i->list->magic == LIST_MAGIC);
 
-	slurm_rwlock_wrlock(&i->list->mutex);
+	_list_wrlock(i->list);
 	_list_node_create(i->list, i->prev, x);
-	slurm_rwlock_unlock(&i->list->mutex);
+	_list_unlock(i->list);
 }
 
 extern void *list_find(list_itr_t *i, ListFindF f, void *key)
@@ -904,12 +933,12 @@ extern void *list_find(list_itr_t *i, ListFindF f, void *key)
 	xassert(key != NULL);
 	xassert(i->magic == LIST_ITR_MAGIC);
 
-	slurm_rwlock_wrlock(&i->list->mutex);
+	_list_wrlock(i->list);
 	xassert(i->list->magic == LIST_MAGIC);
 
 	while ((v = _list_next_locked(i)) && !f(v, key)) {;}
 
-	slurm_rwlock_unlock(&i->list->mutex);
+	_list_unlock(i->list);
 
 	return v;
 }
@@ -921,11 +950,11 @@ extern void *list_remove(list_itr_t *i)
 	xassert(i != NULL);
 	xassert(i->magic == LIST_ITR_MAGIC);
 	xassert(i->list->magic == LIST_MAGIC);
-	slurm_rwlock_wrlock(&i->list->mutex);
+	_list_wrlock(i->list);
 
 	if (*i->prev != i->pos)
 		v = _list_node_destroy(i->list, i->prev);
-	slurm_rwlock_unlock(&i->list->mutex);
+	_list_unlock(i->list);
 
 	return v;
 }
@@ -959,7 +988,7 @@ static void _list_node_create(list_t *l, list_node_t **pp, void *x)
 
 	xassert(l != NULL);
 	xassert(l->magic == LIST_MAGIC);
-	xassert(_list_mutex_is_locked(&l->mutex));
+	xassert(_list_mutex_is_locked(l));
 	xassert(pp != NULL);
 	xassert(x != NULL);
 
@@ -1016,7 +1045,7 @@ static void *_list_node_destroy(list_t *l, list_node_t **pp)
 
 	xassert(l != NULL);
 	xassert(l->magic == LIST_MAGIC);
-	xassert(_list_mutex_is_locked(&l->mutex));
+	xassert(_list_mutex_is_locked(l));
 	xassert(pp != NULL);
 
 	if (!(p = *pp))
@@ -1045,14 +1074,16 @@ static void *_list_node_destroy(list_t *l, list_node_t **pp)
 }
 
 #ifndef NDEBUG
-static int _list_mutex_is_locked(pthread_rwlock_t *mutex)
+static int _list_mutex_is_locked(list_t *l)
 {
-/*  Returns true if the mutex is locked; o/w, returns false.
+/*  Returns true if the mutex is locked (or not used); o/w, returns false.
  */
 	int rc;
 
-	xassert(mutex != NULL);
-	rc = slurm_rwlock_trywrlock(mutex);
+	if (l->unlocked)
+		return 1;
+
+	rc = slurm_rwlock_trywrlock(&l->mutex);
 	return(rc == EBUSY ? 1 : 0);
 }
 #endif /* !NDEBUG */
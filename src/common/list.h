@@ -102,6 +102,13 @@ typedef int (*ListForF) (void *x, void *arg);
  */
 extern list_t *list_create(ListDelF f);
 
+/*
+ *  Creates and returns a new empty list without any internal locking.
+ *  Only for lists that are never accessed by more than one thread at a time,
+ *    such as temporary lists local to a function.
+ */
+extern list_t *list_create_unlocked(ListDelF f);
+
 /*
  *  Destroys list [l], freeing memory used for list iterators and the
  *    list itself; if a deletion function was specified when the list
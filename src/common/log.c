@@ -131,6 +131,7 @@ typedef struct {
 	char *argv0;
 	char *prefix;            /* optional prefix with log_set_prefix */
 	FILE *logfp;             /* log file pointer                    */
+	bool logfp_regular;      /* logfp is a regular file             */
 	cbuf_t *buf;              /* stderr data buffer                  */
 	cbuf_t *fbuf;             /* logfile data buffer                 */
 	log_facility_t facility;
@@ -252,6 +253,21 @@ size_t log_timestamp(char *s, size_t max)
 	}
 }
 
+/*
+ * Regular files always poll as writable, so there is no reason to pay for a
+ * poll() on every message written to them.
+ */
+static bool _is_regular_file(FILE *fp)
+{
+	struct stat st;
+	int fd;
+
+	if (!fp || ((fd = fileno(fp)) < 0) || fstat(fd, &st))
+		return false;
+
+	return S_ISREG(st.st_mode);
+}
+
 /* check to see if a file is writeable,
  * RET 1 if file can be written now,
  *     0 if can not be written to within 5 seconds
@@ -385,6 +401,7 @@ _log_init(char *prog, log_options_t opt, log_facility_t fac, char *logfile )
 
 	if (log->logfp && (fileno(log->logfp) < 0))
 		log->logfp = NULL;
+	log->logfp_regular = _is_regular_file(log->logfp);
 
 	highest_log_level = _highest_level(log->opt.syslog_level,
 					   log->opt.logfile_level,
@@ -476,6 +493,7 @@ _sched_log_init(char *prog, log_options_t opt, log_facility_t fac,
 
 	if (sched_log->logfp && (fileno(sched_log->logfp) < 0))
 		sched_log->logfp = NULL;
+	sched_log->logfp_regular = _is_regular_file(sched_log->logfp);
 
 	highest_sched_log_level = _highest_level(sched_log->opt.syslog_level,
 						 sched_log->opt.logfile_level,
@@ -624,6 +642,7 @@ int log_alter_with_fp(log_options_t opt, log_facility_t fac, FILE *fp_in)
 		/* don't close fd on out since this fd was made
 		 * outside of the logger */
 	}
+	log->logfp_regular = _is_regular_file(log->logfp);
 	slurm_mutex_unlock(&log_lock);
 	return rc;
 }
@@ -1270,7 +1289,8 @@ static void _log_printf(log_t *log, cbuf_t *cb, FILE *stream,
 
 	/* If the socket has gone away we just return like all is
 	   well. */
-	if (_fd_writeable(fd) != 1)
+	if (!((stream == log->logfp) && log->logfp_regular) &&
+	    (_fd_writeable(fd) != 1))
 		return;
 
 	va_start(ap, fmt);
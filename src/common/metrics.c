@@ -0,0 +1,171 @@
+/*****************************************************************************\
+ *  metrics.c - lock free registry of daemon counters and gauges
+ *****************************************************************************
+ *  Copyright (C) SchedMD LLC.
+ *
+ *  This file is part of Slurm, a resource management program.
+ *  For details, see <https://slurm.schedmd.com/>.
+ *  Please also read the included file: DISCLAIMER.
+ *
+ *  Slurm is free software; you can redistribute it and/or modify it under
+ *  the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the License, or (at your option)
+ *  any later version.
+ *
+ *  In addition, as a special exception, the copyright holders give permission
+ *  to link the code of portions of this program with the OpenSSL library under
+ *  certain conditions as described in each individual source file, and
+ *  distribute linked combinations including the two. You must obey the GNU
+ *  General Public License in all respects for all of the code used other than
+ *  OpenSSL. If you modify file(s) with this exception, you may extend this
+ *  exception to your version of the file(s), but you are not obligated to do
+ *  so. If you do not wish to do so, delete this exception statement from your
+ *  version.  If you delete this exception statement from all source files in
+ *  the program, then also delete it here.
+ *
+ *  Slurm is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with Slurm; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA.
+\*****************************************************************************/
+
+#include <pthread.h>
+
+#include "src/common/log.h"
+#include "src/common/macros.h"
+#include "src/common/metrics.h"
+#include "src/common/xassert.h"
+#include "src/common/xmalloc.h"
+#include "src/common/xstring.h"
+
+#define METRICS_MAX 512
+
+typedef struct {
+	const char *name;
+	const char *labels;
+	const char *help;
+	metric_type_t type;
+	const void *src;
+	size_t size;
+	uint64_t value;	/* when src is NULL */
+} metric_t;
+
+static pthread_mutex_t metrics_mutex = PTHREAD_MUTEX_INITIALIZER;
+static metric_t metrics[METRICS_MAX];
+static uint32_t metrics_cnt = 0;
+
+static metric_t *_add_metric(const char *name, const char *labels,
+			     metric_type_t type, const char *help,
+			     const void *src, size_t size)
+{
+	metric_t *metric;
+
+	xassert(name && help);
+	xassert(!src || (size == 2) || (size == 4) || (size == 8));
+
+	slurm_mutex_lock(&metrics_mutex);
+	if (metrics_cnt >= METRICS_MAX) {
+		slurm_mutex_unlock(&metrics_mutex);
+		error("%s: unable to register metric %s: registry full",
+		      __func__, name);
+		return NULL;
+	}
+
+	metric = &metrics[metrics_cnt];
+	metric->name = name;
+	metric->labels = labels;
+	metric->help = help;
+	metric->type = type;
+	metric->src = src;
+	metric->size = size;
+	metric->value = 0;
+
+	/* publish the filled in entry to metrics_dump() */
+	__atomic_store_n(&metrics_cnt, (metrics_cnt + 1), __ATOMIC_RELEASE);
+	slurm_mutex_unlock(&metrics_mutex);
+
+	return metric;
+}
+
+extern uint64_t *metric_register(const char *name, const char *labels,
+				 metric_type_t type, const char *help)
+{
+	metric_t *metric = _add_metric(name, labels, type, help, NULL, 0);
+
+	return metric ? &metric->value : NULL;
+}
+
+extern void metric_register_src(const char *name, const char *labels,
+				metric_type_t type, const char *help,
+				const void *src, size_t size)
+{
+	(void) _add_metric(name, labels, type, help, src, size);
+}
+
+static uint64_t _read_metric(metric_t *metric)
+{
+	if (!metric->src)
+		return __atomic_load_n(&metric->value, __ATOMIC_RELAXED);
+
+	switch (metric->size) {
+	case 2:
+		return __atomic_load_n((const uint16_t *) metric->src,
+				       __ATOMIC_RELAXED);
+	case 4:
+		return __atomic_load_n((const uint32_t *) metric->src,
+				       __ATOMIC_RELAXED);
+	default:
+		return __atomic_load_n((const uint64_t *) metric->src,
+				       __ATOMIC_RELAXED);
+	}
+}
+
+extern char *metrics_dump(const char *prefix)
+{
+	uint32_t cnt = __atomic_load_n(&metrics_cnt, __ATOMIC_ACQUIRE);
+	char *out = NULL, *pos = NULL;
+	const char *sep = prefix ? "_" : "";
+
+	if (!prefix)
+		prefix = "";
+
+	for (int i = 0; i < cnt; i++) {
+		bool seen = false;
+
+		/* metrics of one family are dumped together */
+		for (int j = 0; !seen && (j < i); j++)
+			seen = !xstrcmp(metrics[j].name, metrics[i].name);
+		if (seen)
+			continue;
+
+		xstrfmtcatat(out, &pos, "# TYPE %s%s%s %s\n# HELP %s%s%s %s\n",
+			     prefix, sep, metrics[i].name,
+			     ((metrics[i].type == METRIC_COUNTER) ?
+			      "counter" : "gauge"),
+			     prefix, sep, metrics[i].name, metrics[i].help);
+
+		for (int j = i; j < cnt; j++) {
+			metric_t *metric = &metrics[j];
+
+			if (xstrcmp(metric->name, metrics[i].name))
+				continue;
+
+			xstrfmtcatat(out, &pos, "%s%s%s%s%s%s%s %"PRIu64"\n",
+				     prefix, sep, metric->name,
+				     ((metric->type == METRIC_COUNTER) ?
+				      "_total" : ""),
+				     (metric->labels ? "{" : ""),
+				     (metric->labels ? metric->labels : ""),
+				     (metric->labels ? "}" : ""),
+				     _read_metric(metric));
+		}
+	}
+
+	xstrcatat(out, &pos, "# EOF\n");
+
+	return out;
+}
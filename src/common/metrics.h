@@ -0,0 +1,102 @@
+/*****************************************************************************\
+ *  metrics.h - lock free registry of daemon counters and gauges
+ *****************************************************************************
+ *  Copyright (C) SchedMD LLC.
+ *
+ *  This file is part of Slurm, a resource management program.
+ *  For details, see <https://slurm.schedmd.com/>.
+ *  Please also read the included file: DISCLAIMER.
+ *
+ *  Slurm is free software; you can redistribute it and/or modify it under
+ *  the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the License, or (at your option)
+ *  any later version.
+ *
+ *  In addition, as a special exception, the copyright holders give permission
+ *  to link the code of portions of this program with the OpenSSL library under
+ *  certain conditions as described in each individual source file, and
+ *  distribute linked combinations including the two. You must obey the GNU
+ *  General Public License in all respects for all of the code used other than
+ *  OpenSSL. If you modify file(s) with this exception, you may extend this
+ *  exception to your version of the file(s), but you are not obligated to do
+ *  so. If you do not wish to do so, delete this exception statement from your
+ *  version.  If you delete this exception statement from all source files in
+ *  the program, then also delete it here.
+ *
+ *  Slurm is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with Slurm; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA.
+\*****************************************************************************/
+
+#ifndef _METRICS_H
+#define _METRICS_H
+
+#include <inttypes.h>
+#include <stddef.h>
+
+/*
+ * Process wide registry of counters and gauges, dumped in the OpenMetrics
+ * text format by the conmgr metrics listener (see conmgr_metrics_listen()).
+ *
+ * Metrics are registered once, normally at startup, and never removed.
+ * Dumping the registry takes no locks at all: values are either owned by the
+ * registry and updated with metric_add()/metric_set(), or read from an
+ * existing variable of the daemon with a relaxed atomic load. Such variables
+ * must be naturally aligned integers that are updated with plain stores, so
+ * the value read is always one that was written even if the writer holds
+ * some other lock.
+ */
+
+typedef enum {
+	METRIC_COUNTER,
+	METRIC_GAUGE,
+} metric_type_t;
+
+/*
+ * Register a metric whose value is owned by the registry
+ * IN name - metric family name without any daemon prefix
+ * IN labels - OpenMetrics labels, e.g. "lock=\"job\"", or NULL
+ * IN type - counter or gauge
+ * IN help - description of the metric family
+ * NOTE: name, labels and help are not copied and must never be freed
+ * RET pointer to the value to update with metric_add() or metric_set(), or
+ *	NULL if the registry is full
+ */
+extern uint64_t *metric_register(const char *name, const char *labels,
+				 metric_type_t type, const char *help);
+
+/*
+ * Register a metric read from an existing variable
+ * IN src - variable to read when the metrics are dumped
+ * IN size - sizeof(*src), one of 2, 4 or 8 bytes
+ * Other arguments are as with metric_register().
+ */
+extern void metric_register_src(const char *name, const char *labels,
+				metric_type_t type, const char *help,
+				const void *src, size_t size);
+
+#define metric_add(value, inc) \
+	do { \
+		if (value) \
+			__atomic_fetch_add((value), (inc), __ATOMIC_RELAXED); \
+	} while (0)
+
+#define metric_set(value, val) \
+	do { \
+		if (value) \
+			__atomic_store_n((value), (val), __ATOMIC_RELAXED); \
+	} while (0)
+
+/*
+ * Dump all registered metrics in the OpenMetrics text exposition format
+ * IN prefix - prepended to every metric family name with a '_', or NULL
+ * RET xmalloc()ed string, caller must xfree()
+ */
+extern char *metrics_dump(const char *prefix);
+
+#endif
@@ -127,6 +127,8 @@ const static entry_t msg_types[] = {
 	ENTRY(RESPONSE_BURST_BUFFER_STATUS),
 	ENTRY(REQUEST_JOB_STATE),
 	ENTRY(RESPONSE_JOB_STATE),
+	ENTRY(REQUEST_JOB_INFO_DELTA),
+	ENTRY(RESPONSE_JOB_INFO_DELTA),
 	ENTRY(REQUEST_CRONTAB),
 	ENTRY(RESPONSE_CRONTAB),
 	ENTRY(REQUEST_UPDATE_CRONTAB),
@@ -165,6 +167,8 @@ const static entry_t msg_types[] = {
 	ENTRY(RESPONSE_HET_JOB_ALLOCATION),
 	ENTRY(REQUEST_HET_JOB_ALLOC_INFO),
 	ENTRY(REQUEST_SUBMIT_BATCH_HET_JOB),
+	ENTRY(REQUEST_SUBMIT_BATCH_JOBS),
+	ENTRY(RESPONSE_SUBMIT_BATCH_JOBS),
 	ENTRY(REQUEST_CTLD_MULT_MSG),
 	ENTRY(RESPONSE_CTLD_MULT_MSG),
 	ENTRY(REQUEST_SIB_MSG),
@@ -138,6 +138,8 @@ typedef enum {
 	RESPONSE_BURST_BUFFER_STATUS,
 	REQUEST_JOB_STATE,
 	RESPONSE_JOB_STATE,
+	REQUEST_JOB_INFO_DELTA,		/* 2060 */
+	RESPONSE_JOB_INFO_DELTA,
 
 	REQUEST_CRONTAB = 2200,
 	RESPONSE_CRONTAB,
@@ -190,6 +192,8 @@ typedef enum {
 	RESPONSE_HET_JOB_ALLOCATION,
 	REQUEST_HET_JOB_ALLOC_INFO,
 	REQUEST_SUBMIT_BATCH_HET_JOB,
+	REQUEST_SUBMIT_BATCH_JOBS,
+	RESPONSE_SUBMIT_BATCH_JOBS,	/* 4030 */
 
 	REQUEST_CTLD_MULT_MSG = 4500,
 	RESPONSE_CTLD_MULT_MSG,
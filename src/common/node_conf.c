@@ -62,6 +62,7 @@
 #include "src/common/pack.h"
 #include "src/common/parse_time.h"
 #include "src/common/read_config.h"
+#include "src/common/working_cluster.h"
 #include "src/common/xassert.h"
 #include "src/common/xmalloc.h"
 #include "src/common/xstring.h"
@@ -86,7 +87,7 @@ list_t *config_list = NULL;	/* list of config_record entries */
 list_t *front_end_list = NULL;	/* list of slurm_conf_frontend_t entries */
 time_t last_node_update = (time_t) 0;	/* time of last update */
 node_record_t **node_record_table_ptr = NULL;	/* node records */
-xhash_t* node_hash_table = NULL;
+xahash_table_t *node_hash_table = NULL;
 int node_record_table_size = 0;		/* size of node_record_table_ptr */
 int node_record_count = 0;		/* number of node slots in
 					 * node_record_table_ptr */
@@ -97,6 +98,31 @@ uint16_t *cr_node_num_cores = NULL;
 uint32_t *cr_node_cores_offset = NULL;
 bool spec_cores_first = false;
 
+/* Must fit in uint32_t */
+#define NODE_RANGE_MAX_DIGITS 9
+/* Allow a few holes in small ranges of node names */
+#define NODE_RANGE_SLACK 64
+
+typedef struct {
+	char *prefix;
+	int prefix_len;
+	int digits; /* digit count of numeric suffix, including leading zeros */
+	uint32_t min; /* number of first node in range */
+	uint32_t cnt; /* numbers in range */
+	int *inx; /* node index by (number - min) or -1 */
+} node_range_t;
+
+typedef struct {
+	const char *name;
+	int prefix_len;
+	int digits;
+	uint32_t num;
+	int index;
+} node_range_key_t;
+
+static node_range_t *node_ranges = NULL; /* sorted by prefix and digits */
+static int node_range_cnt = 0;
+
 /* Local function definitions */
 static void _delete_config_record(void);
 static void _delete_node_config_ptr(node_record_t *node_ptr);
@@ -106,8 +132,7 @@ static void _dump_hash(void);
 static node_record_t *_find_node_record(char *name, bool test_alias,
 					bool log_missing);
 static void _list_delete_config(void *config_entry);
-static void _node_record_hash_identity(void *item, const char **key,
-				       uint32_t *key_len);
+static void _node_hash_add(node_record_t *node_ptr);
 
 /*
  * _delete_config_record - delete all configuration records
@@ -125,13 +150,16 @@ static void _delete_config_record(void)
 /*
  * helper function used by _dump_hash to print the hash table elements
  */
-static void xhash_walk_helper_cbk(void *item, void *arg)
+static xahash_foreach_control_t _dump_hash_entry(void *entry, void *state,
+						  void *arg)
 {
 	int *i_ptr = arg;
-	node_record_t *node_ptr = (node_record_t *) item;
+	node_record_t *node_ptr = *(node_record_t **) entry;
 
 	debug3("node_hash[%d]:%d(%s)", (*i_ptr)++, node_ptr->index,
 	       node_ptr->name);
+
+	return XAHASH_FOREACH_CONT;
 }
 
 /*
@@ -145,9 +173,8 @@ static void _dump_hash(void)
 	int i = 0;
 	if (node_hash_table == NULL)
 		return;
-	debug2("node_hash: indexing %u elements",
-	       xhash_count(node_hash_table));
-	xhash_walk(node_hash_table, xhash_walk_helper_cbk, &i);
+	xahash_foreach_entry(node_hash_table, _dump_hash_entry, &i);
+	debug2("node_hash: indexing %d elements", i);
 }
 #endif
 
@@ -169,16 +196,238 @@ static void _list_delete_config(void *config_entry)
 	xfree (config_ptr);
 }
 
+/* 32-bit FNV-1a hash of node name */
+static xahash_hash_t _node_hash(const void *key, const size_t key_bytes,
+				void *state)
+{
+	const unsigned char *name = key;
+	xahash_hash_t hash = 2166136261U;
+
+	for (size_t i = 0; i < key_bytes; i++) {
+		hash ^= name[i];
+		hash *= 16777619U;
+	}
+
+	return hash;
+}
+
+/* node_hash_table entries hold a node_record_t pointer indexed by name */
+static bool _node_hash_match(void *entry, const void *key,
+			     const size_t key_bytes, void *state)
+{
+	node_record_t *node_ptr = *(node_record_t **) entry;
+
+	return (!strncmp(node_ptr->name, key, key_bytes) &&
+		!node_ptr->name[key_bytes]);
+}
+
+static void _node_hash_add(node_record_t *node_ptr)
+{
+	node_record_t **entry;
+
+	if (!node_hash_table)
+		return;
+
+	entry = xahash_insert_entry(node_hash_table, node_ptr->name,
+				    strlen(node_ptr->name));
+	*entry = node_ptr;
+}
+
+static node_record_t *_node_hash_find(const char *name)
+{
+	node_record_t **entry = xahash_find_entry(node_hash_table, name,
+						  strlen(name));
+
+	return (entry ? *entry : NULL);
+}
+
+extern void node_hash_remove(node_record_t *node_ptr)
+{
+	(void) xahash_free_entry(node_hash_table, node_ptr->name,
+				 strlen(node_ptr->name));
+}
+
+/* Split name into prefix and trailing number. RET false if no number */
+static bool _split_node_name(const char *name, int *prefix_len, int *digits,
+			     uint32_t *num)
+{
+	int len = strlen(name), i = len;
+
+	while ((i > 0) && isdigit((unsigned char) name[i - 1]))
+		i--;
+
+	if (!(*digits = len - i) || (*digits > NODE_RANGE_MAX_DIGITS))
+		return false;
+
+	*prefix_len = i;
+	*num = 0;
+	for (; i < len; i++)
+		*num = (*num * 10) + (name[i] - '0');
+
+	return true;
+}
+
+static int _cmp_node_range(const char *prefix1, int prefix_len1, int digits1,
+			   const char *prefix2, int prefix_len2, int digits2)
+{
+	int rc;
+
+	if ((rc = memcmp(prefix1, prefix2, MIN(prefix_len1, prefix_len2))))
+		return rc;
+	if (prefix_len1 != prefix_len2)
+		return (prefix_len1 - prefix_len2);
+	return (digits1 - digits2);
+}
+
+static int _sort_node_range_key(const void *x, const void *y)
+{
+	const node_range_key_t *key1 = x;
+	const node_range_key_t *key2 = y;
+	int rc;
+
+	if ((rc = _cmp_node_range(key1->name, key1->prefix_len, key1->digits,
+				  key2->name, key2->prefix_len, key2->digits)))
+		return rc;
+	return ((key1->num > key2->num) - (key1->num < key2->num));
+}
+
+static void _free_node_ranges(void)
+{
+	for (int i = 0; i < node_range_cnt; i++) {
+		xfree(node_ranges[i].prefix);
+		xfree(node_ranges[i].inx);
+	}
+	xfree(node_ranges);
+	node_range_cnt = 0;
+}
+
+/*
+ * Index node names made of a prefix and a number (e.g. "tux012"). Names with
+ * the same prefix and digit count are kept in one range when dense enough so
+ * resolving them is a binary search on the prefix and an array lookup.
+ */
+static void _build_node_ranges(void)
+{
+	node_range_key_t *keys;
+	node_record_t *node_ptr;
+	int key_cnt = 0;
+
+	_free_node_ranges();
+
+	keys = xcalloc(node_record_count + 1, sizeof(*keys));
+	for (int i = 0; (node_ptr = next_node(&i)); i++) {
+		node_range_key_t *key = &keys[key_cnt];
+
+		if (!node_ptr->name || !node_ptr->name[0])
+			continue;
+		if (!_split_node_name(node_ptr->name, &key->prefix_len,
+				      &key->digits, &key->num))
+			continue;
+		key->name = node_ptr->name;
+		key->index = node_ptr->index;
+		key_cnt++;
+	}
+
+	qsort(keys, key_cnt, sizeof(*keys), _sort_node_range_key);
+
+	for (int i = 0, j; i < key_cnt; i = j) {
+		node_range_t *range;
+		uint32_t span;
+
+		for (j = i + 1; (j < key_cnt) &&
+		     !_cmp_node_range(keys[i].name, keys[i].prefix_len,
+				      keys[i].digits, keys[j].name,
+				      keys[j].prefix_len, keys[j].digits); j++)
+			;
+
+		span = keys[j - 1].num - keys[i].num + 1;
+		if (span > ((2 * (j - i)) + NODE_RANGE_SLACK))
+			continue; /* too sparse, leave to node_hash_table */
+
+		xrecalloc(node_ranges, (node_range_cnt + 1),
+			  sizeof(*node_ranges));
+		range = &node_ranges[node_range_cnt++];
+		range->prefix = xstrndup(keys[i].name, keys[i].prefix_len);
+		range->prefix_len = keys[i].prefix_len;
+		range->digits = keys[i].digits;
+		range->min = keys[i].num;
+		range->cnt = span;
+		range->inx = xcalloc(span, sizeof(*range->inx));
+		for (uint32_t k = 0; k < span; k++)
+			range->inx[k] = -1;
+		for (int k = i; k < j; k++)
+			range->inx[keys[k].num - range->min] = keys[k].index;
+	}
+
+	xfree(keys);
+}
+
+/* RET node index from node_ranges or -1 if not in any range */
+static int _node_range_inx(const char *prefix, int prefix_len, int digits,
+			   uint32_t num)
+{
+	int lo = 0, hi = node_range_cnt - 1;
+
+	while (lo <= hi) {
+		int mid = (lo + hi) / 2;
+		node_range_t *range = &node_ranges[mid];
+		int rc = _cmp_node_range(prefix, prefix_len, digits,
+					 range->prefix, range->prefix_len,
+					 range->digits);
+
+		if (rc < 0) {
+			hi = mid - 1;
+		} else if (rc > 0) {
+			lo = mid + 1;
+		} else {
+			if ((num < range->min) ||
+			    ((num - range->min) >= range->cnt))
+				return -1;
+			return range->inx[num - range->min];
+		}
+	}
+
+	return -1;
+}
+
 /*
- * xhash helper function to index node_record per name field
- * in node_hash_table
+ * Get node record for a ranged name from node_ranges. The range index is only
+ * rebuilt by rehash_node() so always verify the name in case the slot was
+ * reused by another node since then.
  */
-static void _node_record_hash_identity(void *item, const char **key,
-				       uint32_t *key_len)
+static node_record_t *_node_range_record(const char *prefix, int prefix_len,
+					 int digits, uint32_t num)
 {
-	node_record_t *node_ptr = item;
-	*key = node_ptr->name;
-	*key_len = strlen(node_ptr->name);
+	int inx = _node_range_inx(prefix, prefix_len, digits, num);
+	node_record_t *node_ptr;
+	const char *p;
+	uint32_t node_num = 0;
+
+	if ((inx < 0) || (inx >= node_record_count) ||
+	    !(node_ptr = node_record_table_ptr[inx]) ||
+	    strncmp(node_ptr->name, prefix, prefix_len))
+		return NULL;
+
+	for (p = node_ptr->name + prefix_len; isdigit((unsigned char) *p); p++)
+		node_num = (node_num * 10) + (*p - '0');
+
+	if (*p || ((p - node_ptr->name) != (prefix_len + digits)) ||
+	    (node_num != num))
+		return NULL;
+
+	return node_ptr;
+}
+
+static node_record_t *_node_range_find(const char *name)
+{
+	int prefix_len, digits;
+	uint32_t num;
+
+	if (!node_range_cnt ||
+	    !_split_node_name(name, &prefix_len, &digits, &num))
+		return NULL;
+
+	return _node_range_record(name, prefix_len, digits, num);
 }
 
 /*
@@ -877,7 +1126,7 @@ extern node_record_t *create_node_record_at(int index, char *node_name,
 	node_ptr = node_record_table_ptr[index] = xmalloc(sizeof(*node_ptr));
 	node_ptr->index = index;
 	node_ptr->name = xstrdup(node_name);
-	xhash_add(node_hash_table, node_ptr);
+	_node_hash_add(node_ptr);
 	active_node_record_count++;
 
 	_init_node_record(node_ptr, config_ptr);
@@ -963,7 +1212,7 @@ extern void insert_node_record_at(node_record_t *node_ptr, int index)
 	bit_clear(node_ptr->config_ptr->node_bitmap, node_ptr->index);
 	node_ptr->index = index;
 	bit_set(node_ptr->config_ptr->node_bitmap, node_ptr->index);
-	xhash_add(node_hash_table, node_ptr);
+	_node_hash_add(node_ptr);
 	active_node_record_count++;
 
 	/* add node to conf node hash tables */
@@ -1050,8 +1299,9 @@ static node_record_t *_find_node_record(char *name, bool test_alias,
 	if (!node_hash_table)
 		return NULL;
 
-	/* try to find via hash table, if it exists */
-	if ((node_ptr = xhash_get_str(node_hash_table, name))) {
+	/* try ranged names first, then the hash table */
+	if ((node_ptr = _node_range_find(name)) ||
+	    (node_ptr = _node_hash_find(name))) {
 		xassert(node_ptr->magic == NODE_MAGIC);
 		return node_ptr;
 	}
@@ -1071,7 +1321,7 @@ static node_record_t *_find_node_record(char *name, bool test_alias,
 		if (!alias)
 			return NULL;
 
-		node_ptr = xhash_get_str(node_hash_table, alias);
+		node_ptr = _node_hash_find(alias);
 		if (log_missing)
 			error("%s: lookup failure for node \"%s\", alias \"%s\"",
 			      __func__, name, alias);
@@ -1100,7 +1350,8 @@ extern void init_node_conf(void)
 	node_record_table_size = 0;
 	last_node_index = -1;
 	xfree(node_record_table_ptr);
-	xhash_free(node_hash_table);
+	FREE_NULL_XAHASH_TABLE(node_hash_table);
+	_free_node_ranges();
 
 	if (config_list)	/* delete defunct configuration entries */
 		_delete_config_record();
@@ -1121,7 +1372,8 @@ extern void node_fini2(void)
 	int i;
 	node_record_t *node_ptr;
 
-	xhash_free(node_hash_table);
+	FREE_NULL_XAHASH_TABLE(node_hash_table);
+	_free_node_ranges();
 	for (i = 0; (node_ptr = next_node(&i)); i++)
 		delete_node_record(node_ptr);
 
@@ -1157,6 +1409,104 @@ extern int node_name_get_inx(char *node_name)
 	return node_ptr->index;
 }
 
+/*
+ * Parse a hostlist expression of plain names and single "prefix[ranges]"
+ * tokens (e.g. "tux[001-128,200],login1") directly into bit indexes without
+ * expanding every name through hostlist.
+ * RET true if all names were found, false to fall back to hostlist parsing
+ */
+static bool _node_name2bitmap_fast(const char *node_names, bitstr_t *bitmap)
+{
+	static const uint32_t pow10[] = {
+		1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000,
+		1000000000
+	};
+	const char *p = node_names;
+
+	if (!node_range_cnt || (slurmdb_setup_cluster_dims() > 1))
+		return false;
+
+	while (true) {
+		const char *prefix = p;
+		int prefix_len;
+
+		while (*p && (*p != '[') && (*p != ',')) {
+			if ((*p == ']') || isspace((unsigned char) *p))
+				return false;
+			p++;
+		}
+		if (!(prefix_len = (p - prefix)))
+			return false;
+
+		if (*p != '[') {
+			node_record_t **entry;
+
+			/* plain node name */
+			if (!(entry = xahash_find_entry(node_hash_table, prefix,
+							prefix_len)))
+				return false;
+			bit_set(bitmap, (*entry)->index);
+		} else {
+			if (isdigit((unsigned char) prefix[prefix_len - 1]))
+				return false;
+			p++;
+
+			while (true) {
+				const char *lo_str = p;
+				uint32_t lo = 0, hi;
+				int width;
+
+				while (isdigit((unsigned char) *p))
+					lo = (lo * 10) + (*p++ - '0');
+				width = p - lo_str;
+				if (!width || (width > NODE_RANGE_MAX_DIGITS))
+					return false;
+
+				hi = lo;
+				if (*p == '-') {
+					const char *hi_str = ++p;
+
+					hi = 0;
+					while (isdigit((unsigned char) *p))
+						hi = (hi * 10) + (*p++ - '0');
+					if (!(p - hi_str) ||
+					    ((p - hi_str) >
+					     NODE_RANGE_MAX_DIGITS) ||
+					    (hi < lo))
+						return false;
+				}
+
+				for (uint64_t num = lo; num <= hi; num++) {
+					node_record_t *node_ptr;
+					int digits = width;
+
+					/* numbers wider than lo are not padded */
+					while ((digits < NODE_RANGE_MAX_DIGITS) &&
+					       (num >= pow10[digits]))
+						digits++;
+
+					if (!(node_ptr = _node_range_record(
+						      prefix, prefix_len,
+						      digits, num)))
+						return false;
+					bit_set(bitmap, node_ptr->index);
+				}
+
+				if (*p == ']')
+					break;
+				if (*p++ != ',')
+					return false;
+			}
+			p++;
+		}
+
+		if (!*p)
+			return true;
+		if (*p++ != ',')
+			return false;
+	}
+}
+
 /*
  * node_name2bitmap - given a node name regular expression, build a bitmap
  *	representation
@@ -1182,6 +1532,10 @@ extern int node_name2bitmap(char *node_names, bool best_effort,
 		return rc;
 	}
 
+	if (_node_name2bitmap_fast(node_names, my_bitmap))
+		return rc;
+	bit_clear_all(my_bitmap);
+
 	if ( (host_list = hostlist_create (node_names)) == NULL) {
 		/* likely a badly formatted hostlist */
 		error ("hostlist_create on %s error:", node_names);
@@ -1313,21 +1667,24 @@ extern void purge_node_rec(void *in)
 
 /*
  * rehash_node - build a hash table of the node_record entries.
- * NOTE: using xhash implementation
+ * NOTE: using xahash implementation
  */
 extern void rehash_node(void)
 {
 	int i;
 	node_record_t *node_ptr;
 
-	xhash_free (node_hash_table);
-	node_hash_table = xhash_init(_node_record_hash_identity, NULL);
+	FREE_NULL_XAHASH_TABLE(node_hash_table);
+	node_hash_table = xahash_new_table(_node_hash, _node_hash_match, NULL,
+					   NULL, 0, sizeof(node_record_t *),
+					   0);
 	for (i = 0; (node_ptr = next_node(&i)); i++) {
 		if ((node_ptr->name == NULL) ||
 		    (node_ptr->name[0] == '\0'))
 			continue;	/* vestigial record */
-		xhash_add(node_hash_table, node_ptr);
+		_node_hash_add(node_ptr);
 	}
+	_build_node_ranges();
 
 #if _DEBUG
 	_dump_hash();
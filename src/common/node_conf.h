@@ -53,7 +53,7 @@
 #include "src/common/list.h"
 #include "src/common/read_config.h"
 #include "src/common/slurm_protocol_defs.h"
-#include "src/common/xhash.h"
+#include "src/common/xahash.h"
 
 #define CONFIG_MAGIC	0xc065eded
 #define NODE_MAGIC	0x0de575ed
@@ -88,25 +88,17 @@ extern list_t *front_end_list;	/* list of slurm_conf_frontend_t entries */
 
 typedef struct node_record node_record_t;
 struct node_record {
+	/* grouped by size to avoid padding, alphabetical within each size */
 	char *arch;			/* computer architecture */
 	char *bcast_address;		/* BcastAddr */
-	uint16_t boards; 		/* count of boards configured */
 	time_t boot_req_time;		/* Time of node boot request */
 	time_t boot_time;		/* Time of node boot,
 					 * computed from up_time */
 	char *comm_name;		/* communications path name to node */
 	char *comment;			/* arbitrary comment */
-	uint16_t comp_job_cnt;		/* count of jobs completing on node */
 	config_record_t *config_ptr;	/* configuration spec ptr */
-	uint16_t core_spec_cnt;		/* number of specialized cores on node*/
-	uint16_t cores;			/* number of cores per socket */
-	uint32_t cpu_bind;		/* default CPU binding type */
-	uint32_t cpu_load;		/* CPU load * 100 */
 	time_t cpu_load_time;		/* Time when cpu_load last set */
 	char *cpu_spec_list;		/* node's specialized cpus */
-	uint16_t cpus;			/* count of processors on the node */
-	uint16_t cpus_efctv;		/* count of effective cpus on the node.
-					   i.e. cpus minus specialized cpus*/
 	acct_gather_energy_t *energy;	/* power consumption data */
 	char *extra;			/* arbitrary string */
 	data_t *extra_data;		/* Data serialized from extra */
@@ -126,86 +118,95 @@ struct node_record {
 					 * use for scheduling purposes */
 	list_t *gres_list;		/* list of gres state info managed by
 					 * plugins */
-	uint32_t index;			/* Index into node_record_table_ptr */
 	char *instance_id;		/* cloud instance id */
 	char *instance_type;		/* cloud instance type */
 	time_t last_busy;		/* time node was last busy (no jobs) */
 	time_t last_response;		/* last response from the node */
-	uint32_t magic;			/* magic cookie for data integrity */
 	char *mcs_label;		/* mcs_label if mcs plugin in use */
 	uint64_t mem_spec_limit;	/* MB memory limit for specialization */
 	char *name;			/* name of the node. NULL==defunct */
-	uint32_t next_state;		/* state after reboot */
-	uint16_t no_share_job_cnt;	/* count of jobs running that will
-					 * not share nodes */
 	char *node_hostname;		/* hostname of the node */
 	node_record_t *node_next;	/* next entry with same hash index */
-	uint32_t node_rank;		/* Hilbert number based on node name,
-					 * or other sequence number used to
-					 * order nodes by location,
-					 * no need to save/restore */
 	bitstr_t *node_spec_bitmap;	/* node cpu specialization bitmap */
-	uint32_t node_state;		/* enum node_states, ORed with
-					 * NODE_STATE_NO_RESPOND if not
-					 * responding */
-	bool not_responding;		/* set if fails to respond,
-					 * clear after logging this */
 	char *os;			/* operating system now running */
-	uint32_t owner;			/* User allowed to use node or NO_VAL */
-	uint16_t owner_job_cnt;		/* Count of exclusive jobs by "owner" */
-	uint16_t part_cnt;		/* number of associated partitions */
 	void **part_pptr;		/* array of pointers to partitions
 					 * associated with this node*/
-	uint16_t port;			/* TCP port number of the slurmd */
 	time_t power_save_req_time;	/* Time of power_save request */
-	uint16_t protocol_version;	/* Slurm version number */
 	uint64_t real_memory;		/* MB real memory on the node */
 	char *reason; 			/* why a node is DOWN or DRAINING */
 	time_t reason_time;		/* Time stamp when reason was
 					 * set, ignore if no reason is set. */
-	uint32_t reason_uid;		/* User that set the reason, ignore if
-					 * no reason is set. */
-	uint16_t res_cores_per_gpu;	/* number of cores per GPU to allow to
-					 * only GPU jobs */
 	time_t resume_after;		/* automatically resume DOWN or DRAINED
 					 * node at this point in time */
-	uint16_t resume_timeout; 	/* time required in order to perform a
-					 * node resume operation */
 	char *resv_name;                /* If node is in a reservation this is
 					 * the name of the reservation */
-	uint16_t run_job_cnt;		/* count of jobs running on node */
 	uint64_t sched_weight;		/* Node's weight for scheduling
 					 * purposes. For cons_tres use */
 	dynamic_plugin_data_t *select_nodeinfo; /* opaque data structure,
 						 * use select_g_get_nodeinfo()
 						 * to access contents */
 	time_t slurmd_start_time;	/* Time of slurmd startup */
-	uint16_t sus_job_cnt;		/* count of jobs suspended on node */
+	uint64_t *tres_cnt;		/* tres this node has. NO_PACK*/
+	char *tres_fmt_str;		/* tres this node has */
+	char *tres_str;                 /* tres this node has */
+	char *version;			/* Slurm version */
+	uint32_t cpu_bind;		/* default CPU binding type */
+	uint32_t cpu_load;		/* CPU load * 100 */
+	uint32_t index;			/* Index into node_record_table_ptr */
+	uint32_t magic;			/* magic cookie for data integrity */
+	uint32_t next_state;		/* state after reboot */
+	uint32_t node_rank;		/* Hilbert number based on node name,
+					 * or other sequence number used to
+					 * order nodes by location,
+					 * no need to save/restore */
+	uint32_t node_state;		/* enum node_states, ORed with
+					 * NODE_STATE_NO_RESPOND if not
+					 * responding */
+	uint32_t owner;			/* User allowed to use node or NO_VAL */
+	uint32_t reason_uid;		/* User that set the reason, ignore if
+					 * no reason is set. */
 	uint32_t suspend_time; 		/* node idle for this long before
 					 * power save mode */
+	uint32_t tmp_disk;		/* MB total disk in TMP_FS */
+	uint32_t up_time;		/* seconds since node boot */
+	uint32_t weight;		/* orignal weight, used only for state
+					 * save/restore, DO NOT use for
+					 * scheduling purposes. */
+	uint16_t boards; 		/* count of boards configured */
+	uint16_t comp_job_cnt;		/* count of jobs completing on node */
+	uint16_t core_spec_cnt;		/* number of specialized cores on node*/
+	uint16_t cores;			/* number of cores per socket */
+	uint16_t cpus;			/* count of processors on the node */
+	uint16_t cpus_efctv;		/* count of effective cpus on the node.
+					   i.e. cpus minus specialized cpus*/
+	uint16_t no_share_job_cnt;	/* count of jobs running that will
+					 * not share nodes */
+	uint16_t owner_job_cnt;		/* Count of exclusive jobs by "owner" */
+	uint16_t part_cnt;		/* number of associated partitions */
+	uint16_t port;			/* TCP port number of the slurmd */
+	uint16_t protocol_version;	/* Slurm version number */
+	uint16_t res_cores_per_gpu;	/* number of cores per GPU to allow to
+					 * only GPU jobs */
+	uint16_t resume_timeout; 	/* time required in order to perform a
+					 * node resume operation */
+	uint16_t run_job_cnt;		/* count of jobs running on node */
+	uint16_t sus_job_cnt;		/* count of jobs suspended on node */
 	uint16_t suspend_timeout;	/* time required in order to perform a
 					 * node suspend operation */
-	uint64_t *tres_cnt;		/* tres this node has. NO_PACK*/
-	char *tres_fmt_str;		/* tres this node has */
-	char *tres_str;                 /* tres this node has */
 	uint16_t threads;		/* number of threads per core */
-	uint32_t tmp_disk;		/* MB total disk in TMP_FS */
 	uint16_t tot_cores;		/* number of cores per node */
 	uint16_t tot_sockets;		/* number of sockets per node */
-	uint32_t up_time;		/* seconds since node boot */
-	char *version;			/* Slurm version */
 	uint16_t tpc;	                /* number of threads we are using per
 					 * core */
-	uint32_t weight;		/* orignal weight, used only for state
-					 * save/restore, DO NOT use for
-					 * scheduling purposes. */
+	bool not_responding;		/* set if fails to respond,
+					 * clear after logging this */
 };
 extern node_record_t **node_record_table_ptr;  /* ptr to node records */
 extern int node_record_count;		/* number of node slots
 					 * node_record_table_ptr */
 extern int active_node_record_count;	/* non-null node count in
 					 * node_record_table_ptr */
-extern xhash_t* node_hash_table;	/* hash table for node records */
+extern xahash_table_t *node_hash_table; /* hash table for node records */
 extern time_t last_node_update;		/* time of last node record update */
 
 extern uint16_t *cr_node_num_cores;
@@ -425,6 +426,9 @@ extern void purge_node_rec(void *in);
  */
 extern void rehash_node (void);
 
+/* Remove node from node_hash_table before its name is released */
+extern void node_hash_remove(node_record_t *node_ptr);
+
 /* Convert a node state string to it's equivalent enum value */
 extern int state_str2int(const char *state_str, char *node_name);
 
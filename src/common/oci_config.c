@@ -56,6 +56,7 @@ static s_p_options_t options[] = {
 	{"MountSpoolDir", S_P_STRING},
 	{"RunTimeCreate", S_P_STRING},
 	{"RunTimeDelete", S_P_STRING},
+	{"RunTimeDirectExec", S_P_BOOLEAN},
 	{"RunTimeKill", S_P_STRING},
 	{"RunTimeEnvExclude", S_P_STRING},
 	{"RunTimeQuery", S_P_STRING},
@@ -108,6 +109,8 @@ extern int get_oci_conf(oci_conf_t **oci_ptr)
 	(void) s_p_get_string(&oci->mount_spool_dir, "MountSpoolDir", tbl);
 	(void) s_p_get_string(&oci->runtime_create, "RunTimeCreate", tbl);
 	(void) s_p_get_string(&oci->runtime_delete, "RunTimeDelete", tbl);
+	(void) s_p_get_boolean(&oci->runtime_direct_exec, "RunTimeDirectExec",
+			       tbl);
 	(void) s_p_get_string(&oci->runtime_kill, "RunTimeKill", tbl);
 	(void) s_p_get_string(&runtime_env_exclude, "RunTimeEnvExclude", tbl);
 	(void) s_p_get_string(&oci->runtime_query, "RunTimeQuery", tbl);
@@ -253,11 +256,12 @@ extern int get_oci_conf(oci_conf_t **oci_ptr)
 		else if (oci->create_env_file == NEWLINE_TERMINATED_ENV_FILE)
 			envfile = "newline";
 
-		debug("%s: oci.conf loaded: ContainerPath=%s CreateEnvFile=%s RunTimeCreate=%s RunTimeDelete=%s RunTimeKill=%s RunTimeQuery=%s RunTimeRun=%s RunTimeStart=%s IgnoreFileConfigJson=%c",
+		debug("%s: oci.conf loaded: ContainerPath=%s CreateEnvFile=%s RunTimeCreate=%s RunTimeDelete=%s RunTimeKill=%s RunTimeQuery=%s RunTimeRun=%s RunTimeStart=%s RunTimeDirectExec=%c IgnoreFileConfigJson=%c",
 		      __func__, oci->container_path, envfile,
 		      oci->runtime_create, oci->runtime_delete,
 		      oci->runtime_kill, oci->runtime_query, oci->runtime_run,
 		      oci->runtime_start,
+		      (oci->runtime_direct_exec ? 'T' : 'F'),
 		      (oci->ignore_config_json ? 'T' : 'F'));
 	} else {
 		free_oci_conf(oci);
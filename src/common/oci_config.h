@@ -56,6 +56,7 @@ typedef struct {
 	char *mount_spool_dir; /* OCI runtime pattern to execute create */
 	char *runtime_create; /* OCI runtime pattern to execute create */
 	char *runtime_delete; /* OCI runtime pattern to execute delete */
+	bool runtime_direct_exec; /* exec runtime without /bin/sh if possible */
 	char *runtime_kill; /* OCI runtime pattern to execute kill */
 	regex_t runtime_env_exclude; /* REGEX to filter runtime_* environment */
 	bool runtime_env_exclude_set; /* true if runtime_env_exclude populated */
@@ -192,6 +192,7 @@ void free_buf(buf_t *my_buf)
 	else if (!my_buf->shadow)
 		xfree(my_buf->head);
 
+	xfree(my_buf->refs);
 	xfree(my_buf);
 }
 
@@ -240,8 +241,19 @@ extern int try_grow_buf_remaining(buf_t *buffer, uint32_t size)
 {
 	xassert(buffer->magic == BUF_MAGIC);
 
-	if (remaining_buf(buffer) < size)
-		return try_grow_buf(buffer, size);
+	if (remaining_buf(buffer) < size) {
+		/*
+		 * Grow geometrically so packing many small fields into a
+		 * large buffer (e.g. bulk job or node dumps) does not
+		 * reallocate the buffer for every field once it is full.
+		 */
+		uint64_t grow = MAX(BUF_SIZE, buffer->size / 2);
+
+		grow = MAX(grow, size);
+		if ((grow + buffer->size) > MAX_BUF_SIZE)
+			grow = size;
+		return try_grow_buf(buffer, grow);
+	}
 
 	return SLURM_SUCCESS;
 }
@@ -314,12 +326,50 @@ void *xfer_buf_data(buf_t *my_buf)
 		fatal_abort("attempt to xfer mmap()'d buffer not supported");
 	if (my_buf->shadow)
 		fatal_abort("attempt to xfer shadow buffer not supported");
+	if (my_buf->ref_cnt)
+		fatal_abort("attempt to xfer buffer with references not supported");
 
 	data_ptr = (void *) my_buf->head;
 	xfree(my_buf);
 	return data_ptr;
 }
 
+extern int get_buf_iovec(buf_t *buffer, struct iovec **iov_ptr)
+{
+	struct iovec *iov;
+	uint32_t offset = 0;
+	int cnt = 0;
+
+	xassert(buffer->magic == BUF_MAGIC);
+
+	iov = xcalloc(((buffer->ref_cnt * 2) + 1), sizeof(*iov));
+
+	for (int i = 0; i < buffer->ref_cnt; i++) {
+		buf_ref_t *ref = &buffer->refs[i];
+
+		if (ref->offset > offset) {
+			iov[cnt].iov_base = &buffer->head[offset];
+			iov[cnt].iov_len = ref->offset - offset;
+			cnt++;
+		}
+
+		iov[cnt].iov_base = ref->data;
+		iov[cnt].iov_len = ref->size;
+		cnt++;
+
+		offset = ref->offset;
+	}
+
+	if (buffer->processed > offset) {
+		iov[cnt].iov_base = &buffer->head[offset];
+		iov[cnt].iov_len = buffer->processed - offset;
+		cnt++;
+	}
+
+	*iov_ptr = iov;
+	return cnt;
+}
+
 extern int swap_buf_data(buf_t *x, buf_t *y)
 {
 	if (!x || !y)
@@ -571,19 +621,67 @@ int unpack32(uint32_t *valp, buf_t *buffer)
 	return SLURM_SUCCESS;
 }
 
+/*
+ * Reserve space for an array of cnt elements of elem_size bytes with a single
+ * grow check so the caller can convert elements straight into the buffer.
+ * RET pointer to the reserved bytes or NULL on failure
+ */
+static char *_pack_array_reserve(buf_t *buffer, uint32_t cnt,
+				 size_t elem_size)
+{
+	uint64_t bytes = ((uint64_t) cnt) * elem_size;
+	char *ptr;
+
+	if (bytes > MAX_BUF_SIZE) {
+		error("%s: Buffer size limit exceeded (%"PRIu64" > %u)",
+		      __func__, bytes, MAX_BUF_SIZE);
+		return NULL;
+	}
+
+	if (try_grow_buf_remaining(buffer, bytes))
+		return NULL;
+
+	ptr = &buffer->head[buffer->processed];
+	buffer->processed += bytes;
+	return ptr;
+}
+
+/*
+ * Consume an array of cnt elements of elem_size bytes from the buffer after
+ * checking once that all of them are present.
+ * RET pointer to the array bytes or NULL if the buffer is too short
+ */
+static char *_unpack_array_reserve(buf_t *buffer, uint32_t cnt,
+				   size_t elem_size)
+{
+	uint64_t bytes = ((uint64_t) cnt) * elem_size;
+	char *ptr;
+
+	if (remaining_buf(buffer) < bytes)
+		return NULL;
+
+	ptr = &buffer->head[buffer->processed];
+	buffer->processed += bytes;
+	return ptr;
+}
+
 /*
  * Given a *uint16_t, it will pack an array of size_val
  */
 void pack16_array(uint16_t *valp, uint32_t size_val, buf_t *buffer)
 {
-	uint32_t i = 0;
+	char *dst;
 
 	xassert(valp || !size_val);
 
 	pack32(size_val, buffer);
 
-	for (i = 0; i < size_val; i++) {
-		pack16(*(valp + i), buffer);
+	if (!(dst = _pack_array_reserve(buffer, size_val, sizeof(*valp))))
+		return;
+
+	for (uint32_t i = 0; i < size_val; i++) {
+		uint16_t ns = htons(valp[i]);
+		memcpy(dst + (i * sizeof(ns)), &ns, sizeof(ns));
 	}
 }
 
@@ -592,11 +690,18 @@ void pack16_array(uint16_t *valp, uint32_t size_val, buf_t *buffer)
  */
 int unpack16_array(uint16_t **valp, uint32_t *size_val, buf_t *buffer)
 {
+	char *src;
+
 	*valp = NULL;
 	safe_unpack32(size_val, buffer);
+	if (!(src = _unpack_array_reserve(buffer, *size_val, sizeof(**valp))))
+		goto unpack_error;
 	safe_xcalloc(*valp, *size_val, sizeof(uint16_t));
-	for (uint32_t i = 0; i < *size_val; i++)
-		safe_unpack16(&(*valp)[i], buffer);
+	for (uint32_t i = 0; i < *size_val; i++) {
+		uint16_t ns;
+		memcpy(&ns, src + (i * sizeof(ns)), sizeof(ns));
+		(*valp)[i] = ntohs(ns);
+	}
 	return SLURM_SUCCESS;
 
 unpack_error:
@@ -609,14 +714,18 @@ unpack_error:
  */
 void pack32_array(uint32_t *valp, uint32_t size_val, buf_t *buffer)
 {
-	uint32_t i = 0;
+	char *dst;
 
 	xassert(valp || !size_val);
 
 	pack32(size_val, buffer);
 
-	for (i = 0; i < size_val; i++) {
-		pack32(*(valp + i), buffer);
+	if (!(dst = _pack_array_reserve(buffer, size_val, sizeof(*valp))))
+		return;
+
+	for (uint32_t i = 0; i < size_val; i++) {
+		uint32_t nl = htonl(valp[i]);
+		memcpy(dst + (i * sizeof(nl)), &nl, sizeof(nl));
 	}
 }
 
@@ -625,11 +734,18 @@ void pack32_array(uint32_t *valp, uint32_t size_val, buf_t *buffer)
  */
 int unpack32_array(uint32_t **valp, uint32_t *size_val, buf_t *buffer)
 {
+	char *src;
+
 	*valp = NULL;
 	safe_unpack32(size_val, buffer);
+	if (!(src = _unpack_array_reserve(buffer, *size_val, sizeof(**valp))))
+		goto unpack_error;
 	safe_xcalloc(*valp, *size_val, sizeof(uint32_t));
-	for (uint32_t i = 0; i < *size_val; i++)
-		safe_unpack32(&(*valp)[i], buffer);
+	for (uint32_t i = 0; i < *size_val; i++) {
+		uint32_t nl;
+		memcpy(&nl, src + (i * sizeof(nl)), sizeof(nl));
+		(*valp)[i] = ntohl(nl);
+	}
 	return SLURM_SUCCESS;
 
 unpack_error:
@@ -642,14 +758,18 @@ unpack_error:
  */
 void pack64_array(uint64_t *valp, uint32_t size_val, buf_t *buffer)
 {
-	uint32_t i = 0;
+	char *dst;
 
 	xassert(valp || !size_val);
 
 	pack32(size_val, buffer);
 
-	for (i = 0; i < size_val; i++) {
-		pack64(*(valp + i), buffer);
+	if (!(dst = _pack_array_reserve(buffer, size_val, sizeof(*valp))))
+		return;
+
+	for (uint32_t i = 0; i < size_val; i++) {
+		uint64_t nl = HTON_uint64(valp[i]);
+		memcpy(dst + (i * sizeof(nl)), &nl, sizeof(nl));
 	}
 }
 
@@ -657,11 +777,18 @@ void pack64_array(uint64_t *valp, uint32_t size_val, buf_t *buffer)
  */
 int unpack64_array(uint64_t **valp, uint32_t *size_val, buf_t *buffer)
 {
+	char *src;
+
 	*valp = NULL;
 	safe_unpack32(size_val, buffer);
+	if (!(src = _unpack_array_reserve(buffer, *size_val, sizeof(**valp))))
+		goto unpack_error;
 	safe_xcalloc(*valp, *size_val, sizeof(uint64_t));
-	for (uint32_t i = 0; i < *size_val; i++)
-		safe_unpack64(&(*valp)[i], buffer);
+	for (uint32_t i = 0; i < *size_val; i++) {
+		uint64_t nl;
+		memcpy(&nl, src + (i * sizeof(nl)), sizeof(nl));
+		(*valp)[i] = NTOH_uint64(nl);
+	}
 	return SLURM_SUCCESS;
 
 unpack_error:
@@ -669,26 +796,52 @@ unpack_error:
 	return SLURM_ERROR;
 }
 
+/* Same encoding as packdouble() for each element */
 void packdouble_array(double *valp, uint32_t size_val, buf_t *buffer)
 {
-	uint32_t i = 0;
+	char *dst;
 
 	xassert(valp || !size_val);
 
 	pack32(size_val, buffer);
 
-	for (i = 0; i < size_val; i++) {
-		packdouble(*(valp + i), buffer);
+	if (!(dst = _pack_array_reserve(buffer, size_val, sizeof(uint64_t))))
+		return;
+
+	for (uint32_t i = 0; i < size_val; i++) {
+		union {
+			double d;
+			uint64_t u;
+		} uval;
+		uint64_t nl;
+
+		uval.d = (valp[i] * FLOAT_MULT);
+		nl = HTON_uint64(uval.u);
+		memcpy(dst + (i * sizeof(nl)), &nl, sizeof(nl));
 	}
 }
 
+/* Same decoding as unpackdouble() for each element */
 int unpackdouble_array(double **valp, uint32_t* size_val, buf_t *buffer)
 {
+	char *src;
+
 	*valp = NULL;
 	safe_unpack32(size_val, buffer);
+	if (!(src = _unpack_array_reserve(buffer, *size_val, sizeof(uint64_t))))
+		goto unpack_error;
 	safe_xcalloc(*valp, *size_val, sizeof(double));
-	for (uint32_t i = 0; i < *size_val; i++)
-		safe_unpackdouble(&(*valp)[i], buffer);
+	for (uint32_t i = 0; i < *size_val; i++) {
+		union {
+			double d;
+			uint64_t u;
+		} uval;
+		uint64_t nl;
+
+		memcpy(&nl, src + (i * sizeof(nl)), sizeof(nl));
+		uval.u = NTOH_uint64(nl);
+		(*valp)[i] = uval.d / FLOAT_MULT;
+	}
 	return SLURM_SUCCESS;
 
 unpack_error:
@@ -860,6 +1013,46 @@ extern void packmem(void *valp, uint32_t size_val, buf_t *buffer)
 }
 
 
+extern void packmem_ref(void *valp, uint32_t size_val, buf_t *buffer)
+{
+	uint32_t ns = htonl(size_val);
+	uint64_t packed_size;
+	buf_ref_t *ref;
+
+	if (!buffer->allow_refs || (size_val < PACK_REF_MIN_LEN) ||
+	    (buffer->ref_cnt >= PACK_REF_MAX_CNT)) {
+		packmem(valp, size_val, buffer);
+		return;
+	}
+
+	if (size_val > MAX_PACK_MEM_LEN) {
+		error("%s: Buffer to be packed is too large (%u > %u)",
+		      __func__, size_val, MAX_PACK_MEM_LEN);
+		return;
+	}
+
+	packed_size = ((uint64_t) get_buf_packed_size(buffer)) + sizeof(ns) +
+		      size_val;
+	if (packed_size > MAX_BUF_SIZE) {
+		error("%s: Buffer size limit exceeded (%"PRIu64" > %u)",
+		      __func__, packed_size, MAX_BUF_SIZE);
+		return;
+	}
+
+	if (try_grow_buf_remaining(buffer, sizeof(ns)))
+		return;
+
+	memcpy(&buffer->head[buffer->processed], &ns, sizeof(ns));
+	buffer->processed += sizeof(ns);
+
+	xrecalloc(buffer->refs, (buffer->ref_cnt + 1), sizeof(*buffer->refs));
+	ref = &buffer->refs[buffer->ref_cnt++];
+	ref->offset = buffer->processed;
+	ref->data = valp;
+	ref->size = size_val;
+	buffer->ref_size += size_val;
+}
+
 /*
  * Given a buffer containing a network byte order 32-bit integer,
  * and an arbitrary data string, return a pointer to the
@@ -895,6 +1088,43 @@ unpack_error:
 	return SLURM_ERROR;
 }
 
+/*
+ * Given a buffer containing a network byte order 32-bit integer,
+ * and a NUL terminated string, return a pointer to the string in 'valp'.
+ * Also return the sizes of 'valp' in bytes. Adjust buffer counters.
+ * NOTE: valp is set to point into the buffer bufp, a copy of
+ *	the data is not made. It must not be xfree()'d and is only valid
+ *	for as long as the buffer is.
+ */
+int unpackstr_ptr(char **valp, uint32_t *size_valp, buf_t *buffer)
+{
+	*valp = NULL;
+	safe_unpack32(size_valp, buffer);
+
+	if (!*size_valp)
+		return SLURM_SUCCESS;
+
+	if (*size_valp > MAX_PACK_MEM_LEN) {
+		error("%s: Buffer to be unpacked is too large (%u > %u)",
+		      __func__, *size_valp, MAX_PACK_MEM_LEN);
+		goto unpack_error;
+	}
+
+	if (remaining_buf(buffer) < *size_valp)
+		goto unpack_error;
+	if (buffer->head[buffer->processed + *size_valp - 1] != '\0')
+		goto unpack_error;
+
+	*valp = &buffer->head[buffer->processed];
+	buffer->processed += *size_valp;
+
+	return SLURM_SUCCESS;
+
+unpack_error:
+	*size_valp = 0;
+	return SLURM_ERROR;
+}
+
 /*
  * Given a buffer containing a network byte order 32-bit integer,
  * and an arbitrary data string, copy the data string into the location
@@ -1108,6 +1338,39 @@ unpack_error:
 	return SLURM_ERROR;
 }
 
+/*
+ * Unpack a NULL-terminated array of strings from buffer without copying the
+ * strings, as unpackstr_array() but with unpackstr_ptr() semantics.
+ * OUT: valp - xmalloc()'d array of pointers into buffer or NULL.
+ *	Free with xfree(), never xfree_array().
+ * OUT: size_valp - number of elements, not including the NULL-termination.
+ * IN/OUT: buffer
+ */
+int unpackstr_array_ptr(char ***valp, uint32_t *size_valp, buf_t *buffer)
+{
+	uint32_t len;
+
+	*valp = NULL;
+	safe_unpack32(size_valp, buffer);
+
+	if (!*size_valp)
+		return SLURM_SUCCESS;
+
+	if (*size_valp > MAX_PACK_MEM_LEN)
+		goto unpack_error;
+
+	safe_xcalloc(*valp, *size_valp + 1, sizeof(char *));
+	for (uint32_t i = 0; i < *size_valp; i++)
+		if (unpackstr_ptr(&(*valp)[i], &len, buffer))
+			goto unpack_error;
+	return SLURM_SUCCESS;
+
+unpack_error:
+	*size_valp = 0;
+	xfree(*valp);
+	return SLURM_ERROR;
+}
+
 /*
  * Given a pointer to memory (valp), size (size_val), and buffer,
  * store the memory contents into the buffer
@@ -45,6 +45,7 @@
 #include <time.h>
 #include <stdbool.h>
 #include <string.h>
+#include <sys/uio.h>
 
 #include "src/common/bitstring.h"
 #include "src/common/xassert.h"
@@ -65,6 +66,24 @@
  * allocation error due to array or buffer sizes that are unreasonably large */
 #define MAX_PACK_MEM_LEN	(1024 * 1024 * 1024)
 
+/*
+ * Payloads at least this large are referenced by packmem_ref() instead of
+ * being copied into buffers that allow references.
+ */
+#define PACK_REF_MIN_LEN	(64 * 1024)
+/* Limit references per buffer to stay well under IOV_MAX when sent */
+#define PACK_REF_MAX_CNT	64
+
+/*
+ * Memory referenced by a buffer instead of being copied into it. The
+ * referenced bytes logically follow the first "offset" bytes of head.
+ */
+typedef struct {
+	uint32_t offset;
+	char *data;
+	uint32_t size;
+} buf_ref_t;
+
 typedef struct {
 	uint32_t magic;
 	char *head;
@@ -72,10 +91,16 @@ typedef struct {
 	uint32_t processed;
 	bool mmaped;
 	bool shadow;
+	bool allow_refs;	/* packmem_ref() may reference memory */
+	uint32_t ref_cnt;	/* count of refs */
+	buf_ref_t *refs;	/* memory referenced while packing */
+	uint32_t ref_size;	/* total bytes referenced by refs */
 } buf_t;
 
 #define get_buf_data(__buf)		(__buf->head)
 #define get_buf_offset(__buf)		(__buf->processed)
+/* Bytes packed into buffer including any referenced memory */
+#define get_buf_packed_size(__buf)	(__buf->processed + __buf->ref_size)
 #define set_buf_offset(__buf,__val)	(__buf->processed = __val)
 #define remaining_buf(__buf)		(__buf->size - __buf->processed)
 #define size_buf(__buf)			(__buf->size)
@@ -84,6 +109,7 @@ typedef struct {
 	buf_t *header;
 	buf_t *auth;
 	buf_t *body;
+	bool vectored; /* body may reference payloads, see packmem_ref() */
 } msg_bufs_t;
 
 extern buf_t *create_buf(char *data, uint32_t size);
@@ -110,7 +136,7 @@ extern int try_grow_buf(buf_t *buffer, uint32_t size);
  * Ensure buffer has enough remaining bytes
  * Note: Buffer's head pointer may be resized or replaced.
  * IN my_buf - pointer to buffer
- * IN size - number of bytes to grow buffer by
+ * IN size - minimum number of bytes that must remain in the buffer
  * RET SLURM_SUCCESS or error
  */
 extern int try_grow_buf_remaining(buf_t *buffer, uint32_t size);
@@ -122,6 +148,14 @@ extern void *xfer_buf_data(buf_t *my_buf);
  * RET SLURM_SUCCESS or error
  */
 extern int swap_buf_data(buf_t *x, buf_t *y);
+/*
+ * Describe the packed contents of a buffer, including any memory referenced
+ * by packmem_ref(), as an array of iovecs.
+ * IN buffer - buffer to describe
+ * OUT iov_ptr - xmalloc()ed array of iovecs, caller must xfree()
+ * RET number of iovecs in iov_ptr
+ */
+extern int get_buf_iovec(buf_t *buffer, struct iovec **iov_ptr);
 
 extern void pack_time(time_t val, buf_t *buffer);
 extern int unpack_time(time_t *valp, buf_t *buffer);
@@ -170,7 +204,14 @@ extern int unpacklongdouble_array(long double **valp, uint32_t *size_val,
 extern void packbuf(buf_t *source, buf_t *buffer);
 
 extern void packmem(void *valp, uint32_t size_val, buf_t *buffer);
+/*
+ * Pack memory the same as packmem() but, when the buffer allows references
+ * and size_val is at least PACK_REF_MIN_LEN, only record a reference to valp
+ * instead of copying it. valp must remain valid until the buffer is sent.
+ */
+extern void packmem_ref(void *valp, uint32_t size_val, buf_t *buffer);
 extern int unpackmem_ptr(char **valp, uint32_t *size_valp, buf_t *buffer);
+extern int unpackstr_ptr(char **valp, uint32_t *size_valp, buf_t *buffer);
 extern int unpackmem_xmalloc(char **valp, uint32_t *size_valp, buf_t *buffer);
 
 extern int unpackstr_xmalloc(char **valp, uint32_t *size_valp, buf_t *buffer);
@@ -185,6 +226,8 @@ extern int safe_unpackstr_func(void **object,
 
 extern void packstr_array(char **valp, uint32_t size_val, buf_t *buffer);
 extern int unpackstr_array(char ***valp, uint32_t* size_val, buf_t *buffer);
+extern int unpackstr_array_ptr(char ***valp, uint32_t *size_val,
+			       buf_t *buffer);
 
 extern void packmem_array(char *valp, uint32_t size_val, buf_t *buffer);
 extern int unpackmem_array(char *valp, uint32_t size_valp, buf_t *buffer);
@@ -294,6 +337,13 @@ extern int unpackmem_array(char *valp, uint32_t size_valp, buf_t *buffer);
 		goto unpack_error;			\
 } while (0)
 
+#define safe_unpackstr_ptr(valp,size_valp,buf) do {	\
+	xassert(sizeof(*size_valp) == sizeof(uint32_t));\
+	xassert(buf->magic == BUF_MAGIC);		\
+	if (unpackstr_ptr(valp,size_valp,buf))		\
+		goto unpack_error;			\
+} while (0)
+
 #define safe_unpackmem_xmalloc(valp,size_valp,buf) do {	\
 	xassert(sizeof(*size_valp) == sizeof(uint32_t));\
 	xassert(buf->magic == BUF_MAGIC);		\
@@ -311,6 +361,15 @@ extern int unpackmem_array(char *valp, uint32_t size_valp, buf_t *buffer);
 	packmem(str,(uint32_t)_size,buf);		\
 } while (0)
 
+/* Pack a string that must remain valid until buf is sent, see packmem_ref() */
+#define packstr_ref(str,buf) do {			\
+	uint32_t _size = 0;				\
+	if((char *)str != NULL)				\
+		_size = (uint32_t)strlen(str)+1;	\
+	xassert(buf->magic == BUF_MAGIC);		\
+	packmem_ref(str,(uint32_t)_size,buf);		\
+} while (0)
+
 #define packnull(buf) do { \
 	xassert(buf != NULL); \
 	xassert(buf->magic == BUF_MAGIC); \
@@ -401,6 +460,13 @@ extern int unpackmem_array(char *valp, uint32_t size_valp, buf_t *buffer);
 		goto unpack_error;			\
 } while (0)
 
+#define safe_unpackstr_array_ptr(valp,size_valp,buf) do {	\
+	xassert(sizeof(*size_valp) == sizeof(uint32_t)); \
+	xassert(buf->magic == BUF_MAGIC);		\
+	if (unpackstr_array_ptr(valp,size_valp,buf))	\
+		goto unpack_error;			\
+} while (0)
+
 #define safe_unpackmem_array(valp,size,buf) do {	\
 	xassert(valp != NULL);				\
 	xassert(sizeof(size) == sizeof(uint32_t)); 	\
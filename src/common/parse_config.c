@@ -40,6 +40,7 @@
 \*****************************************************************************/
 
 #include <ctype.h>
+#include <pthread.h>
 #include <regex.h>
 #include <stdbool.h>
 #include <stdint.h>
@@ -98,6 +99,15 @@ static char *keyvalue_pattern =
 					    * or unquoted and no whitespace */
 	"([[:space:]]|$)";
 
+/*
+ * Compiled keyvalue_pattern shared by every hashtbl. Node and partition lines
+ * create a hashtbl per line, so compiling it per table dominated the cost of
+ * parsing large configurations. regexec() does not modify the compiled regex.
+ */
+static regex_t keyvalue_re;
+static bool keyvalue_re_init = false;
+static pthread_mutex_t keyvalue_re_lock = PTHREAD_MUTEX_INITIALIZER;
+
 struct s_p_values {
 	char *key;
 	int type;
@@ -112,7 +122,6 @@ struct s_p_values {
 };
 
 struct s_p_hashtbl {
-	regex_t keyvalue_re;
 	s_p_values_t *hash[CONF_HASH_LEN];
 };
 
@@ -137,6 +146,19 @@ static int _conf_hashtbl_index(const char *key)
 	return hashval % CONF_HASH_LEN;
 }
 
+static const regex_t *_keyvalue_re(void)
+{
+	slurm_mutex_lock(&keyvalue_re_lock);
+	if (!keyvalue_re_init) {
+		if (regcomp(&keyvalue_re, keyvalue_pattern, REG_EXTENDED))
+			fatal("keyvalue regex compilation failed");
+		keyvalue_re_init = true;
+	}
+	slurm_mutex_unlock(&keyvalue_re_lock);
+
+	return &keyvalue_re;
+}
+
 static void _conf_hashtbl_insert(s_p_hashtbl_t *tbl, s_p_values_t *value)
 {
 	int idx;
@@ -200,9 +222,6 @@ s_p_hashtbl_t *s_p_hashtbl_create_cnt(const s_p_options_t options[], int *cnt)
 		_conf_hashtbl_insert(tbl, value);
 	}
 
-	if (regcomp(&tbl->keyvalue_re, keyvalue_pattern, REG_EXTENDED))
-		fatal("keyvalue regex compilation failed");
-
 	return tbl;
 }
 
@@ -286,8 +305,6 @@ void s_p_hashtbl_destroy(s_p_hashtbl_t *tbl)
 		}
 	}
 
-	regfree(&tbl->keyvalue_re);
-
 	xfree(tbl);
 }
 
@@ -304,6 +321,7 @@ static int _keyvalue_regex(s_p_hashtbl_t *tbl, const char *line,
 			   char **key, char **value, char **remaining,
 			   slurm_parser_operator_t *operator)
 {
+	const regex_t *re = _keyvalue_re();
 	size_t nmatch = 8;
 	regmatch_t pmatch[8];
 	char op;
@@ -315,9 +333,9 @@ static int _keyvalue_regex(s_p_hashtbl_t *tbl, const char *line,
 	*operator = S_P_OPERATOR_SET;
 	memset(pmatch, 0, sizeof(regmatch_t)*nmatch);
 
-	if ((rc = regexec(&tbl->keyvalue_re, line, nmatch, pmatch, 0))) {
+	if ((rc = regexec(re, line, nmatch, pmatch, 0))) {
 		if (rc != REG_NOMATCH)
-			dump_regex_error(rc, &tbl->keyvalue_re, "regexec(%s)",
+			dump_regex_error(rc, re, "regexec(%s)",
 					 line);
 		return -1;
 	}
@@ -517,13 +535,6 @@ s_p_hashtbl_t *_hashtbl_copy_keys(const s_p_hashtbl_t *from_tbl)
 		}
 	}
 
-	/*
-	 * We cannot copy a regex since a regfree() on either
-	 * the original or the copy can affect the other one.
-	 */
-	if (regcomp(&to_tbl->keyvalue_re, keyvalue_pattern, REG_EXTENDED))
-		fatal("keyvalue regex compilation failed");
-
 	return to_tbl;
 }
 
@@ -1577,13 +1588,6 @@ static s_p_hashtbl_t *_parse_expline_adapt_table(const s_p_hashtbl_t *tbl)
 		}
 	}
 
-	/*
-	 * We cannot copy a regex since a regfree() on either
-	 * the original or the copy can affect the other one.
-	 */
-	if (regcomp(&to_tbl->keyvalue_re, keyvalue_pattern, REG_EXTENDED))
-		fatal("keyvalue regex compilation failed");
-
 	return to_tbl;
 }
 
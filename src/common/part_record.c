@@ -49,7 +49,7 @@ static void _bf_data_free(bf_part_data_t **datap)
 
 	slurmdb_destroy_bf_usage(data->job_usage);
         slurmdb_destroy_bf_usage(data->resv_usage);
-	xhash_free(data->user_usage);
+	FREE_NULL_XAHASH_TABLE(data->user_usage);
 	xfree(data);
 
 	*datap = NULL;
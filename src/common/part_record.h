@@ -38,12 +38,12 @@
 #include "slurm/slurmdb.h"
 
 #include "src/common/pack.h"
-#include "src/common/xhash.h"
+#include "src/common/xahash.h"
 
 typedef struct {
 	slurmdb_bf_usage_t *job_usage;
 	slurmdb_bf_usage_t *resv_usage;
-	xhash_t *user_usage;
+	xahash_table_t *user_usage;
 } bf_part_data_t;
 
 typedef struct part_record {
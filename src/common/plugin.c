@@ -51,6 +51,7 @@
 
 #include "src/common/log.h"
 #include "src/common/plugrack.h"
+#include "src/common/probes.h"
 #include "src/common/read_config.h"
 #include "src/common/slurm_protocol_api.h"
 #include "src/common/strlcpy.h"
@@ -163,6 +164,7 @@ extern int plugin_load_from_file(plugin_handle_t *p, const char *fq_path)
 		dlclose(plug);
 		return rc;
 	}
+	SLURM_PROBE2(plugin__load, fq_path, plug);
 
 	/*
 	 * Now call its init() function, if present.  If the function
@@ -275,6 +277,7 @@ void plugin_unload(plugin_handle_t plug)
 	void (*fini)(void);
 
 	if (plug != PLUGIN_INVALID_HANDLE) {
+		SLURM_PROBE1(plugin__unload, plug);
 		if ((fini = dlsym(plug, "fini")) != NULL) {
 			(*fini)();
 		}
@@ -0,0 +1,80 @@
+/*****************************************************************************\
+ *  probes.h - USDT probe points for SystemTap, bpftrace and perf
+ *****************************************************************************
+ *  Copyright (C) SchedMD LLC.
+ *
+ *  This file is part of Slurm, a resource management program.
+ *  For details, see <https://slurm.schedmd.com/>.
+ *  Please also read the included file: DISCLAIMER.
+ *
+ *  Slurm is free software; you can redistribute it and/or modify it under
+ *  the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the License, or (at your option)
+ *  any later version.
+ *
+ *  In addition, as a special exception, the copyright holders give permission
+ *  to link the code of portions of this program with the OpenSSL library under
+ *  certain conditions as described in each individual source file, and
+ *  distribute linked combinations including the two. You must obey the GNU
+ *  General Public License in all respects for all of the code used other than
+ *  OpenSSL. If you modify file(s) with this exception, you may extend this
+ *  exception to your version of the file(s), but you are not obligated to do
+ *  so. If you do not wish to do so, delete this exception statement from your
+ *  version.  If you delete this exception statement from all source files in
+ *  the program, then also delete it here.
+ *
+ *  Slurm is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with Slurm; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA.
+\*****************************************************************************/
+
+#ifndef _PROBES_H
+#define _PROBES_H
+
+#include "config.h"
+
+/*
+ * Statically defined probe points, compiled in with "configure --enable-usdt".
+ * Each probe is a single nop until a tracer attaches to it, and expands to
+ * nothing otherwise. Arguments are evaluated even when no tracer is attached,
+ * so only pass values that are already at hand.
+ *
+ * All probes are in the "slurm" provider, e.g.:
+ *	perf probe -x $(which slurmctld) sdt_slurm:rpc__done
+ *	bpftrace -e 'usdt:/usr/sbin/slurmctld:slurm:lock__acquired { ... }'
+ *
+ * rpc__start(msg_type, uid)		slurmctld starts processing an RPC
+ * rpc__done(msg_type, uid, usec)	slurmctld finished processing an RPC
+ * lock__acquired(caller, levels, usec)	slurmctld locks acquired after waiting
+ * lock__released(caller, levels, usec)	slurmctld locks released after holding,
+ *					levels are two bits per lock type
+ * phase__start(name)			timed code phase started
+ * phase__done(name, usec)		timed code phase, see sched_phase_stats
+ * agent__send(msg_type, node_name)	agent sends an RPC, node_name may be NULL
+ * agent__recv(msg_type, node_name, rc)	agent got a response from a node
+ * plugin__load(path, handle)		plugin loaded with dlopen()
+ * plugin__unload(handle)		plugin about to be unloaded
+ */
+
+#ifdef HAVE_USDT
+
+#include <sys/sdt.h>
+
+#define SLURM_PROBE1(name, a1) DTRACE_PROBE1(slurm, name, a1)
+#define SLURM_PROBE2(name, a1, a2) DTRACE_PROBE2(slurm, name, a1, a2)
+#define SLURM_PROBE3(name, a1, a2, a3) DTRACE_PROBE3(slurm, name, a1, a2, a3)
+
+#else
+
+#define SLURM_PROBE1(name, a1)
+#define SLURM_PROBE2(name, a1, a2)
+#define SLURM_PROBE3(name, a1, a2, a3)
+
+#endif
+
+#endif
@@ -4109,6 +4109,14 @@ static int _validate_and_set_defaults(slurm_conf_t *conf,
 	    !(conf->conf_flags & CONF_FLAG_IPV6_ENABLED))
 		fatal("Both IPv4 and IPv6 support disabled, cannot communicate");
 
+	if ((temp_str = xstrcasestr(conf->comm_params,
+				   "getaddrinfo_cache_timeout="))) {
+		slurm_conf.getaddrinfo_cache_timeout = atoi(temp_str + 26);
+	} else {
+		slurm_conf.getaddrinfo_cache_timeout =
+			DEFAULT_GETADDRINFO_CACHE_TIMEOUT;
+	}
+
 	if ((temp_str = xstrcasestr(conf->comm_params,
 				   "getnameinfo_cache_timeout="))) {
 		slurm_conf.getnameinfo_cache_timeout = atoi(temp_str + 26);
@@ -5662,6 +5670,12 @@ extern char * prolog_flags2str(uint16_t prolog_flags)
 		xstrcat(rc, "X11");
 	}
 
+	if (prolog_flags & PROLOG_FLAG_PARALLEL_SCRIPTS) {
+		if (rc)
+			xstrcat(rc, ",");
+		xstrcat(rc, "ParallelScripts");
+	}
+
 	return rc;
 }
 
@@ -5692,6 +5706,8 @@ extern uint16_t prolog_str2flags(char *prolog_flags)
 			rc |= PROLOG_FLAG_DEFER_BATCH;
 		else if (xstrcasecmp(tok, "NoHold") == 0)
 			rc |= PROLOG_FLAG_NOHOLD;
+		else if (!xstrcasecmp(tok, "ParallelScripts"))
+			rc |= PROLOG_FLAG_PARALLEL_SCRIPTS;
 		else if (xstrcasecmp(tok, "ForceRequeueOnFail") == 0)
 			rc |= (PROLOG_FLAG_ALLOC |
 			       PROLOG_FLAG_FORCE_REQUEUE_ON_FAIL);
@@ -6013,6 +6029,11 @@ extern char * debug_flags2str(uint64_t debug_flags)
 			xstrcat(rc, ",");
 		xstrcat(rc, "ConMgr");
 	}
+	if (debug_flags & DEBUG_FLAG_XMALLOC) {
+		if (rc)
+			xstrcat(rc, ",");
+		xstrcat(rc, "XMalloc");
+	}
 
 	return rc;
 }
@@ -6162,6 +6183,8 @@ extern int debug_str2flags(const char *debug_flags, uint64_t *flags_out)
 			 !xstrcasecmp(tok, "WorkQ") ||
 			 !xstrcasecmp(tok, "ConMgr"))
 			(*flags_out) |= DEBUG_FLAG_CONMGR;
+		else if (!xstrcasecmp(tok, "XMalloc"))
+			(*flags_out) |= DEBUG_FLAG_XMALLOC;
 		else {
 			error("Invalid DebugFlag: %s", tok);
 			(*flags_out) = 0;
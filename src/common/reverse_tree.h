@@ -47,6 +47,7 @@
 
 #define REVERSE_TREE_WIDTH 7
 #define REVERSE_TREE_CHILDREN_TIMEOUT 60 /* seconds */
+#define REVERSE_TREE_LEVEL_TIMEOUT 3 /* seconds per tree level below */
 #define REVERSE_TREE_PARENT_RETRY 5 /* count, 1 sec per attempt */
 
 void reverse_tree_info(int rank, int num_nodes, int width,
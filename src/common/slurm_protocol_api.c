@@ -260,6 +260,14 @@ static int _compute_hash(buf_t *buffer, slurm_msg_t *msg, slurm_hash_t *hash)
 		if (hash->type == HASH_PLUGIN_NONE) {
 			memcpy(hash->hash, &msg_type, sizeof(msg_type));
 			h_len = sizeof(msg->msg_type);
+		} else if (buffer->ref_cnt) {
+			struct iovec *iov = NULL;
+			int iovcnt = get_buf_iovec(buffer, &iov);
+
+			h_len = hash_g_compute_iov(iov, iovcnt,
+						   (char *) &msg_type,
+						   sizeof(msg_type), hash);
+			xfree(iov);
 		} else {
 			h_len = hash_g_compute(get_buf_data(buffer),
 					       get_buf_offset(buffer),
@@ -509,6 +517,34 @@ extern int slurm_get_auth_ttl(void)
 	return ttl;
 }
 
+/* slurm_get_auth_session_lifetime
+ * returns the credential session lifetime option from the AuthInfo parameter
+ * cache value in local buffer for best performance
+ * RET int - session lifetime in seconds or 0 if sessions are disabled
+ */
+extern int slurm_get_auth_session_lifetime(void)
+{
+	static int lifetime = -1;
+	char *tmp;
+
+	if (lifetime >= 0)
+		return lifetime;
+
+	if (!slurm_conf.authinfo)
+		return 0;
+
+	tmp = strstr(slurm_conf.authinfo, "session_lifetime=");
+	if (tmp) {
+		lifetime = atoi(tmp + 17);
+		if (lifetime < 0)
+			lifetime = 0;
+	} else {
+		lifetime = 0;
+	}
+
+	return lifetime;
+}
+
 /* _global_auth_key
  * returns the storage password from slurm_conf or slurmdbd_conf object
  * cache value in local buffer for best performance
@@ -1061,11 +1097,13 @@ int slurm_receive_msg(int fd, slurm_msg_t *msg, int timeout)
 	log_flag_hex(NET_RAW, buf, buflen, "%s: read", __func__);
 	buffer = create_buf(buf, buflen);
 
-	rc = slurm_unpack_received_msg(msg, fd, buffer);
-
+	/* Set before unpacking to allow strings to stay in the buffer */
 	if (keep_buffer)
 		msg->buffer = buffer;
-	else
+
+	rc = slurm_unpack_received_msg(msg, fd, buffer);
+
+	if (!keep_buffer)
 		FREE_NULL_BUFFER(buffer);
 
 endit:
@@ -1681,19 +1719,22 @@ skip_auth:
 
 	msg->body_offset = get_buf_offset(buffer);
 
+	/* Set before unpacking to allow strings to stay in the buffer */
+	if (keep_buffer)
+		msg->buffer = buffer;
+
 	if ((header.body_length != remaining_buf(buffer)) ||
 	    _check_hash(buffer, &header, msg, auth_cred) ||
 	     (unpack_msg(msg, buffer) != SLURM_SUCCESS) ) {
 		auth_g_destroy(auth_cred);
+		msg->buffer = NULL;
 		FREE_NULL_BUFFER(buffer);
 		rc = ESLURM_PROTOCOL_INCOMPLETE_PACKET;
 		goto total_return;
 	}
 	msg->auth_cred = auth_cred;
 
-	if (keep_buffer)
-		msg->buffer = buffer;
-	else
+	if (!keep_buffer)
 		FREE_NULL_BUFFER(buffer);
 	rc = SLURM_SUCCESS;
 
@@ -1737,10 +1778,19 @@ extern int slurm_buffers_pack_msg(slurm_msg_t *msg, msg_bufs_t *buffers,
 	if (!msg->restrict_uid_set)
 		fatal("%s: restrict_uid is not set", __func__);
 	/*
-	 * Pack message into buffer
+	 * Pack message into buffer. Bodies packed ahead of time (e.g. by
+	 * pack_all_jobs()) are referenced in place instead of being copied so
+	 * a large response is only held in memory once.
 	 */
-	buffers->body = init_buf(BUF_SIZE);
-	pack_msg(msg, buffers->body);
+	if (!(buffers->body = shadow_msg_body(msg))) {
+		buffers->body = init_buf(BUF_SIZE);
+		/*
+		 * Large payloads (e.g. batch scripts) are only referenced when
+		 * the caller will send the buffers with a vectored write.
+		 */
+		buffers->body->allow_refs = buffers->vectored;
+		pack_msg(msg, buffers->body);
+	}
 	log_flag_hex(NET_RAW, get_buf_data(buffers->body),
 		     get_buf_offset(buffers->body),
 		     "%s: packed body", __func__);
@@ -1755,7 +1805,12 @@ extern int slurm_buffers_pack_msg(slurm_msg_t *msg, msg_bufs_t *buffers,
 	 * but we may need to generate the credential again later if we
 	 * wait too long for the incoming message.
 	 */
-	h_len = _compute_hash(buffers->body, msg, &hash);
+	/*
+	 * Session credentials (AuthInfo=session_lifetime) are reused across
+	 * messages so they cannot carry a hash of this message's body.
+	 */
+	if (!slurm_get_auth_session_lifetime())
+		h_len = _compute_hash(buffers->body, msg, &hash);
 	if (h_len < 0) {
 		error("%s: hash_g_compute: %s has error",
 		      __func__, rpc_num2string(msg->msg_type));
@@ -1835,7 +1890,7 @@ skip_auth2:
 	/*
 	 * Pack and send message
 	 */
-	update_header(&header, get_buf_offset(buffers->body));
+	update_header(&header, get_buf_packed_size(buffers->body));
 	buffers->header = init_buf(BUF_SIZE);
 	pack_header(&header, buffers->header);
 	log_flag_hex(NET_RAW, get_buf_data(buffers->header),
@@ -1855,7 +1910,7 @@ skip_auth2:
  */
 extern int slurm_send_node_msg(int fd, slurm_msg_t *msg)
 {
-	msg_bufs_t buffers = { 0 };
+	msg_bufs_t buffers = { .vectored = true };
 	int rc;
 
 	if (msg->conn) {
@@ -93,6 +93,13 @@ char *slurm_auth_opts_to_socket(char *opts);
  */
 int slurm_get_auth_ttl(void);
 
+/* slurm_get_auth_session_lifetime
+ * returns the credential session lifetime option from the AuthInfo parameter
+ * cache value in local buffer for best performance
+ * RET int - session lifetime in seconds or 0 if sessions are disabled
+ */
+int slurm_get_auth_session_lifetime(void);
+
 /* slurm_get_tres_weight_array
  * IN weights_str - string of tres and weights to be parsed.
  * IN tres_cnt - count of how many tres' are on the system (e.g.
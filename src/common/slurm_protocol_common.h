@@ -105,5 +105,10 @@
 #define CTLD_QUEUE_PROCESSING	SLURM_BIT(5)
 #define SLURM_NO_AUTH_CRED	SLURM_BIT(6)
 #define SLURM_PACK_ADDRS	SLURM_BIT(7)
+/*
+ * Sender will reuse the connection for further RPCs. A receiver that keeps
+ * the connection open echoes the flag in its response.
+ */
+#define SLURM_MSG_KEEP_ALIVE	SLURM_BIT(8)
 
 #endif
@@ -1556,6 +1556,22 @@ extern void slurm_free_job_state_request_msg(job_state_request_msg_t *msg)
 	xfree(msg);
 }
 
+extern void slurm_free_job_info_delta_request_msg(
+	job_info_delta_request_msg_t *msg)
+{
+	xfree(msg);
+}
+
+extern void slurm_free_job_info_delta_msg(job_info_delta_msg_t *msg)
+{
+	if (!msg)
+		return;
+
+	slurm_free_job_info_msg(msg->jobs);
+	xfree(msg->purged_job_ids);
+	xfree(msg);
+}
+
 extern void slurm_free_job_state_response_msg(job_state_response_msg_t *msg)
 {
 	if (!msg)
@@ -1623,7 +1639,10 @@ extern void slurm_free_job_desc_msg(job_desc_msg_t *msg)
 		xfree(msg->cpus_per_tres);
 		free_cron_entry(msg->crontab_entry);
 		xfree(msg->dependency);
-		env_array_free(msg->environment);
+		if (msg->script_env_borrowed)
+			xfree(msg->environment);
+		else
+			env_array_free(msg->environment);
 		msg->environment = NULL;
 		xfree(msg->extra);
 		xfree(msg->exc_nodes);
@@ -1647,8 +1666,10 @@ extern void slurm_free_job_desc_msg(job_desc_msg_t *msg)
 		xfree(msg->req_nodes);
 		xfree(msg->reservation);
 		xfree(msg->resp_host);
-		xfree(msg->script);
+		if (!msg->script_env_borrowed)
+			xfree(msg->script);
 		FREE_NULL_BUFFER(msg->script_buf);
+		xfree(msg->script_stage_dir);
 		xfree(msg->selinux_context);
 		xfree(msg->std_err);
 		xfree(msg->std_in);
@@ -1674,6 +1695,17 @@ extern void slurm_free_job_desc_msg(job_desc_msg_t *msg)
 	}
 }
 
+extern void slurm_own_job_desc_strings(job_desc_msg_t *msg)
+{
+	if (!msg || !msg->script_env_borrowed)
+		return;
+
+	msg->script = xstrdup(msg->script);
+	for (int i = 0; msg->environment && msg->environment[i]; i++)
+		msg->environment[i] = xstrdup(msg->environment[i]);
+	msg->script_env_borrowed = false;
+}
+
 extern void slurm_free_sib_msg(sib_msg_t *msg)
 {
 	if (msg) {
@@ -1771,7 +1803,8 @@ extern void slurm_free_job_launch_msg(batch_job_launch_msg_t * msg)
 		xfree(msg->partition);
 		xfree(msg->qos);
 		xfree(msg->resv_name);
-		xfree(msg->script);
+		if (!msg->script_borrowed)
+			xfree(msg->script);
 		FREE_NULL_BUFFER(msg->script_buf);
 		if (msg->spank_job_env) {
 			for (i = 0; i < msg->spank_job_env_size; i++)
@@ -2348,6 +2381,26 @@ extern void slurm_free_stats_response_msg(stats_info_response_msg_t *msg)
 			xfree(msg->rpc_dump_hostlist[i]);
 		}
 		xfree(msg->rpc_dump_hostlist);
+		for (i = 0; i < msg->lock_stats_cnt; i++)
+			xfree(msg->lock_stats_name[i]);
+		xfree(msg->lock_stats_name);
+		xfree(msg->lock_stats_count);
+		xfree(msg->lock_stats_wait_time);
+		xfree(msg->lock_stats_wait_max);
+		xfree(msg->lock_stats_hold_time);
+		xfree(msg->lock_stats_hold_max);
+		xfree(msg->lock_stats_wait_hist);
+		xfree(msg->lock_stats_hold_hist);
+		for (i = 0; i < msg->sched_phase_cnt; i++)
+			xfree(msg->sched_phase_name[i]);
+		xfree(msg->sched_phase_name);
+		xfree(msg->sched_phase_count);
+		xfree(msg->sched_phase_time);
+		xfree(msg->sched_phase_max);
+		xfree(msg->sched_phase_hist);
+		xfree(msg->rpc_type_time_hist);
+		xfree(msg->rpc_type_wait_hist);
+		xfree(msg->history);
 		xfree(msg);
 	}
 }
@@ -4076,6 +4129,18 @@ extern void slurm_free_submit_response_response_msg(submit_response_msg_t * msg)
 	}
 }
 
+extern void slurm_free_submit_jobs_response_msg(
+	submit_jobs_response_msg_t *msg)
+{
+	if (!msg)
+		return;
+
+	for (int i = 0; i < msg->jobs_cnt; i++)
+		xfree(msg->job_responses[i].job_submit_user_msg);
+	xfree(msg->job_responses);
+	xfree(msg);
+}
+
 
 /*
  * slurm_free_ctl_conf - free slurm control information response message
@@ -4850,6 +4915,12 @@ extern int slurm_free_msg_data(slurm_msg_type_t type, void *data)
 	case RESPONSE_JOB_STATE:
 		slurm_free_job_state_response_msg(data);
 		break;
+	case REQUEST_JOB_INFO_DELTA:
+		slurm_free_job_info_delta_request_msg(data);
+		break;
+	case RESPONSE_JOB_INFO_DELTA:
+		slurm_free_job_info_delta_msg(data);
+		break;
 	case REQUEST_NODE_INFO:
 		slurm_free_node_info_request_msg(data);
 		break;
@@ -5243,9 +5314,13 @@ extern int slurm_free_msg_data(slurm_msg_type_t type, void *data)
 		break;
 	case REQUEST_HET_JOB_ALLOCATION:
 	case REQUEST_SUBMIT_BATCH_HET_JOB:
+	case REQUEST_SUBMIT_BATCH_JOBS:
 	case RESPONSE_HET_JOB_ALLOCATION:
 		FREE_NULL_LIST(data);
 		break;
+	case RESPONSE_SUBMIT_BATCH_JOBS:
+		slurm_free_submit_jobs_response_msg(data);
+		break;
 	case REQUEST_SET_FS_DAMPENING_FACTOR:
 		slurm_free_set_fs_dampening_factor_msg(data);
 		break;
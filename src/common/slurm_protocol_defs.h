@@ -342,6 +342,9 @@ typedef struct slurm_msg {
 				    * message coming from non-default
 				    * slurm protocol.  Initted to
 				    * NO_VAL meaning use the default. */
+	struct timespec recv_time; /* DON'T PACK: when slurmctld received the
+				    * message, zero if not recorded. Used for
+				    * RPC queue wait statistics. */
 	/* The following were all added for the forward.c code */
 	forward_t forward;
 	forward_struct_t *forward_struct;
@@ -465,6 +468,11 @@ typedef struct {
 	slurm_selected_step_t *job_ids;
 } job_state_request_msg_t;
 
+typedef struct {
+	uint64_t generation;	/* from the last response, 0 for all jobs */
+	uint16_t show_flags;
+} job_info_delta_request_msg_t;
+
 typedef struct {
 	uint16_t show_flags;
 	char *container_id;
@@ -928,6 +936,8 @@ typedef struct batch_job_launch_msg {
 	char *nodes;		/* list of nodes allocated to job_step */
 	uint32_t profile;       /* what to profile for the batch step */
 	char *script;		/* the actual job script, default NONE */
+	bool script_borrowed;	/* DON'T PACK: script points into the RPC
+				 * buffer */
 	buf_t *script_buf;	/* the job script as a mmap buf */
 	char *std_err;		/* pathname of stderr */
 	char *std_in;		/* pathname of stdin */
@@ -1466,6 +1476,8 @@ extern void slurm_free_container_id_response_msg(
 	container_id_response_msg_t *msg);
 extern void slurm_free_job_info_request_msg(job_info_request_msg_t *msg);
 extern void slurm_free_job_state_request_msg(job_state_request_msg_t *msg);
+extern void slurm_free_job_info_delta_request_msg(
+	job_info_delta_request_msg_t *msg);
 extern void slurm_free_job_step_info_request_msg(
 		job_step_info_request_msg_t *msg);
 extern void slurm_free_front_end_info_request_msg(
@@ -1499,6 +1511,13 @@ extern void slurm_free_shutdown_msg(shutdown_msg_t * msg);
 
 extern void slurm_free_job_desc_msg(job_desc_msg_t * msg);
 
+/*
+ * Replace script and environment strings that still point into the RPC
+ * buffer they were unpacked from (script_env_borrowed) with xmalloc()'d
+ * copies, so that they may be modified or outlive the message.
+ */
+extern void slurm_own_job_desc_strings(job_desc_msg_t *msg);
+
 extern void
 slurm_free_node_registration_status_msg(slurm_node_registration_status_msg_t *
 					msg);
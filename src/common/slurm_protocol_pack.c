@@ -1541,6 +1541,59 @@ unpack_error:
 	return SLURM_ERROR;
 }
 
+static void _pack_submit_jobs_response_msg(submit_jobs_response_msg_t *msg,
+					   buf_t *buffer,
+					   uint16_t protocol_version)
+{
+	xassert(msg);
+
+	if (protocol_version >= SLURM_24_11_PROTOCOL_VERSION) {
+		pack32(msg->jobs_cnt, buffer);
+		for (int i = 0; i < msg->jobs_cnt; i++) {
+			submit_response_msg_t *job_resp =
+				&msg->job_responses[i];
+
+			pack32(job_resp->job_id, buffer);
+			pack32(job_resp->step_id, buffer);
+			pack32(job_resp->error_code, buffer);
+			packstr(job_resp->job_submit_user_msg, buffer);
+		}
+	}
+}
+
+static int _unpack_submit_jobs_response_msg(
+	submit_jobs_response_msg_t **msg_ptr, buf_t *buffer,
+	uint16_t protocol_version)
+{
+	submit_jobs_response_msg_t *msg = xmalloc(sizeof(*msg));
+	xassert(msg_ptr);
+	*msg_ptr = msg;
+
+	if (protocol_version >= SLURM_24_11_PROTOCOL_VERSION) {
+		safe_unpack32(&msg->jobs_cnt, buffer);
+		if (msg->jobs_cnt >= NO_VAL)
+			goto unpack_error;
+		safe_xcalloc(msg->job_responses, msg->jobs_cnt,
+			     sizeof(*msg->job_responses));
+		for (int i = 0; i < msg->jobs_cnt; i++) {
+			submit_response_msg_t *job_resp =
+				&msg->job_responses[i];
+
+			safe_unpack32(&job_resp->job_id, buffer);
+			safe_unpack32(&job_resp->step_id, buffer);
+			safe_unpack32(&job_resp->error_code, buffer);
+			safe_unpackstr(&job_resp->job_submit_user_msg, buffer);
+		}
+	}
+
+	return SLURM_SUCCESS;
+
+unpack_error:
+	*msg_ptr = NULL;
+	slurm_free_submit_jobs_response_msg(msg);
+	return SLURM_ERROR;
+}
+
 static int _unpack_node_info_msg(node_info_msg_t **msg, buf_t *buffer,
 				 uint16_t protocol_version)
 {
@@ -3293,6 +3346,41 @@ unpack_error:
 	return SLURM_ERROR;
 }
 
+/*
+ * Unpack the multi_core_data_t packed by pack_multi_core_data() straight
+ * into the job_info_t fields, without allocating a temporary record for
+ * every job in the message.
+ */
+static int _unpack_job_info_multi_core(job_info_t *job, buf_t *buffer,
+				       uint16_t protocol_version)
+{
+	uint8_t flag;
+	uint16_t plane_size;
+
+	safe_unpack8(&flag, buffer);
+	if (flag == 0)
+		return SLURM_SUCCESS;
+	if (flag != 0xff)
+		return SLURM_ERROR;
+
+	if (protocol_version >= SLURM_MIN_PROTOCOL_VERSION) {
+		safe_unpack16(&job->boards_per_node, buffer);
+		safe_unpack16(&job->sockets_per_board, buffer);
+		safe_unpack16(&job->sockets_per_node, buffer);
+		safe_unpack16(&job->cores_per_socket, buffer);
+		safe_unpack16(&job->threads_per_core, buffer);
+		safe_unpack16(&job->ntasks_per_board, buffer);
+		safe_unpack16(&job->ntasks_per_socket, buffer);
+		safe_unpack16(&job->ntasks_per_core, buffer);
+		safe_unpack16(&plane_size, buffer);
+	}
+
+	return SLURM_SUCCESS;
+
+unpack_error:
+	return SLURM_ERROR;
+}
+
 /* _unpack_job_info_members
  * unpacks a set of slurm job info for one job
  * OUT job - pointer to the job info buffer
@@ -3303,7 +3391,6 @@ static int
 _unpack_job_info_members(job_info_t * job, buf_t *buffer,
 			 uint16_t protocol_version)
 {
-	multi_core_data_t *mc_ptr;
 	uint32_t uint32_tmp;
 	bool need_unpack = false;
 
@@ -3499,19 +3586,8 @@ _unpack_job_info_members(job_info_t * job, buf_t *buffer,
 		safe_unpackstr(&job->std_in, buffer);
 		safe_unpackstr(&job->std_out, buffer);
 
-		if (unpack_multi_core_data(&mc_ptr, buffer, protocol_version))
+		if (_unpack_job_info_multi_core(job, buffer, protocol_version))
 			goto unpack_error;
-		if (mc_ptr) {
-			job->boards_per_node = mc_ptr->boards_per_node;
-			job->sockets_per_board = mc_ptr->sockets_per_board;
-			job->sockets_per_node = mc_ptr->sockets_per_node;
-			job->cores_per_socket = mc_ptr->cores_per_socket;
-			job->threads_per_core = mc_ptr->threads_per_core;
-			job->ntasks_per_board = mc_ptr->ntasks_per_board;
-			job->ntasks_per_socket = mc_ptr->ntasks_per_socket;
-			job->ntasks_per_core = mc_ptr->ntasks_per_core;
-			xfree(mc_ptr);
-		}
 	} else if (protocol_version >= SLURM_24_05_PROTOCOL_VERSION) {
 		uint8_t uint8_tmp;
 		uint16_t uint16_tmp;
@@ -3655,19 +3731,8 @@ _unpack_job_info_members(job_info_t * job, buf_t *buffer,
 		safe_unpackstr(&job->std_in, buffer);
 		safe_unpackstr(&job->std_out, buffer);
 
-		if (unpack_multi_core_data(&mc_ptr, buffer, protocol_version))
+		if (_unpack_job_info_multi_core(job, buffer, protocol_version))
 			goto unpack_error;
-		if (mc_ptr) {
-			job->boards_per_node = mc_ptr->boards_per_node;
-			job->sockets_per_board = mc_ptr->sockets_per_board;
-			job->sockets_per_node = mc_ptr->sockets_per_node;
-			job->cores_per_socket = mc_ptr->cores_per_socket;
-			job->threads_per_core = mc_ptr->threads_per_core;
-			job->ntasks_per_board = mc_ptr->ntasks_per_board;
-			job->ntasks_per_socket = mc_ptr->ntasks_per_socket;
-			job->ntasks_per_core = mc_ptr->ntasks_per_core;
-			xfree(mc_ptr);
-		}
 		safe_unpack64(&job->bitflags, buffer);
 		safe_unpackstr(&job->tres_alloc_str, buffer);
 		safe_unpackstr(&job->tres_req_str, buffer);
@@ -3832,19 +3897,8 @@ _unpack_job_info_members(job_info_t * job, buf_t *buffer,
 		safe_unpackstr(&job->std_in, buffer);
 		safe_unpackstr(&job->std_out, buffer);
 
-		if (unpack_multi_core_data(&mc_ptr, buffer, protocol_version))
+		if (_unpack_job_info_multi_core(job, buffer, protocol_version))
 			goto unpack_error;
-		if (mc_ptr) {
-			job->boards_per_node = mc_ptr->boards_per_node;
-			job->sockets_per_board = mc_ptr->sockets_per_board;
-			job->sockets_per_node = mc_ptr->sockets_per_node;
-			job->cores_per_socket = mc_ptr->cores_per_socket;
-			job->threads_per_core = mc_ptr->threads_per_core;
-			job->ntasks_per_board = mc_ptr->ntasks_per_board;
-			job->ntasks_per_socket = mc_ptr->ntasks_per_socket;
-			job->ntasks_per_core = mc_ptr->ntasks_per_core;
-			xfree(mc_ptr);
-		}
 		safe_unpack64(&job->bitflags, buffer);
 		safe_unpackstr(&job->tres_alloc_str, buffer);
 		safe_unpackstr(&job->tres_req_str, buffer);
@@ -4009,19 +4063,8 @@ _unpack_job_info_members(job_info_t * job, buf_t *buffer,
 		safe_unpackstr(&job->std_in, buffer);
 		safe_unpackstr(&job->std_out, buffer);
 
-		if (unpack_multi_core_data(&mc_ptr, buffer, protocol_version))
+		if (_unpack_job_info_multi_core(job, buffer, protocol_version))
 			goto unpack_error;
-		if (mc_ptr) {
-			job->boards_per_node = mc_ptr->boards_per_node;
-			job->sockets_per_board = mc_ptr->sockets_per_board;
-			job->sockets_per_node = mc_ptr->sockets_per_node;
-			job->cores_per_socket = mc_ptr->cores_per_socket;
-			job->threads_per_core = mc_ptr->threads_per_core;
-			job->ntasks_per_board = mc_ptr->ntasks_per_board;
-			job->ntasks_per_socket = mc_ptr->ntasks_per_socket;
-			job->ntasks_per_core = mc_ptr->ntasks_per_core;
-			xfree(mc_ptr);
-		}
 		safe_unpack64(&job->bitflags, buffer);
 		safe_unpackstr(&job->tres_alloc_str, buffer);
 		safe_unpackstr(&job->tres_req_str, buffer);
@@ -6226,7 +6269,7 @@ static void _pack_job_desc_msg(job_desc_msg_t *job_desc_ptr, buf_t *buffer,
 			      job_desc_ptr->env_size, buffer);
 		packstr_array(job_desc_ptr->spank_job_env,
 			      job_desc_ptr->spank_job_env_size, buffer);
-		packstr(job_desc_ptr->script, buffer);
+		packstr_ref(job_desc_ptr->script, buffer);
 		packstr_array(job_desc_ptr->argv, job_desc_ptr->argc, buffer);
 
 		packstr(job_desc_ptr->std_err, buffer);
@@ -6364,7 +6407,7 @@ static void _pack_job_desc_msg(job_desc_msg_t *job_desc_ptr, buf_t *buffer,
 			      job_desc_ptr->env_size, buffer);
 		packstr_array(job_desc_ptr->spank_job_env,
 			      job_desc_ptr->spank_job_env_size, buffer);
-		packstr(job_desc_ptr->script, buffer);
+		packstr_ref(job_desc_ptr->script, buffer);
 		packstr_array(job_desc_ptr->argv, job_desc_ptr->argc, buffer);
 
 		packstr(job_desc_ptr->std_err, buffer);
@@ -6502,7 +6545,7 @@ static void _pack_job_desc_msg(job_desc_msg_t *job_desc_ptr, buf_t *buffer,
 			      job_desc_ptr->env_size, buffer);
 		packstr_array(job_desc_ptr->spank_job_env,
 			      job_desc_ptr->spank_job_env_size, buffer);
-		packstr(job_desc_ptr->script, buffer);
+		packstr_ref(job_desc_ptr->script, buffer);
 		packstr_array(job_desc_ptr->argv, job_desc_ptr->argc, buffer);
 
 		packstr(job_desc_ptr->std_err, buffer);
@@ -6593,10 +6636,12 @@ static void _pack_job_desc_msg(job_desc_msg_t *job_desc_ptr, buf_t *buffer,
  * OUT job_desc_buffer_ptr - place to put pointer to allocated job desc struct
  * IN/OUT buffer - source of the unpack, contains pointers that are
  *			automatically updated
+ * IN borrow - point script and environment into buffer instead of copying
+ *	       them, buffer must outlive the job desc struct
  */
 static int
 _unpack_job_desc_msg(job_desc_msg_t ** job_desc_buffer_ptr, buf_t *buffer,
-		     uint16_t protocol_version)
+		     uint16_t protocol_version, bool borrow)
 {
 	uint32_t start, script_len;
 	job_desc_msg_t *job_desc_ptr = NULL;
@@ -6604,6 +6649,7 @@ _unpack_job_desc_msg(job_desc_msg_t ** job_desc_buffer_ptr, buf_t *buffer,
 	if (protocol_version >= SLURM_24_11_PROTOCOL_VERSION) {
 		job_desc_ptr = xmalloc(sizeof(job_desc_msg_t));
 		*job_desc_buffer_ptr = job_desc_ptr;
+		job_desc_ptr->script_env_borrowed = borrow;
 
 		/* load the data values */
 		safe_unpack32(&job_desc_ptr->site_factor, buffer);
@@ -6657,8 +6703,13 @@ _unpack_job_desc_msg(job_desc_msg_t ** job_desc_buffer_ptr, buf_t *buffer,
 		safe_unpackstr(&job_desc_ptr->req_nodes, buffer);
 		safe_unpackstr(&job_desc_ptr->exc_nodes, buffer);
 		start = buffer->processed;
-		safe_unpackstr_array(&job_desc_ptr->environment,
-				     &job_desc_ptr->env_size, buffer);
+		if (borrow)
+			safe_unpackstr_array_ptr(&job_desc_ptr->environment,
+						 &job_desc_ptr->env_size,
+						 buffer);
+		else
+			safe_unpackstr_array(&job_desc_ptr->environment,
+					     &job_desc_ptr->env_size, buffer);
 
 		if (job_desc_ptr->env_size) {
 			job_desc_ptr->env_hash.type = HASH_PLUGIN_K12;
@@ -6676,8 +6727,12 @@ _unpack_job_desc_msg(job_desc_msg_t ** job_desc_buffer_ptr, buf_t *buffer,
 		if (envcount(job_desc_ptr->spank_job_env)
 		    != job_desc_ptr->spank_job_env_size)
 			goto unpack_error;
-		safe_unpackstr_xmalloc(&job_desc_ptr->script,
-				       &script_len, buffer);
+		if (borrow)
+			safe_unpackstr_ptr(&job_desc_ptr->script, &script_len,
+					   buffer);
+		else
+			safe_unpackstr_xmalloc(&job_desc_ptr->script,
+					       &script_len, buffer);
 
 		job_desc_ptr->script_hash.type = HASH_PLUGIN_K12;
 		(void) hash_g_compute(job_desc_ptr->script, script_len,
@@ -6782,6 +6837,7 @@ _unpack_job_desc_msg(job_desc_msg_t ** job_desc_buffer_ptr, buf_t *buffer,
 		uint8_t uint8_tmp;
 		job_desc_ptr = xmalloc(sizeof(job_desc_msg_t));
 		*job_desc_buffer_ptr = job_desc_ptr;
+		job_desc_ptr->script_env_borrowed = borrow;
 
 		/* load the data values */
 		safe_unpack32(&job_desc_ptr->site_factor, buffer);
@@ -6836,8 +6892,13 @@ _unpack_job_desc_msg(job_desc_msg_t ** job_desc_buffer_ptr, buf_t *buffer,
 		safe_unpackstr(&job_desc_ptr->req_nodes, buffer);
 		safe_unpackstr(&job_desc_ptr->exc_nodes, buffer);
 		start = buffer->processed;
-		safe_unpackstr_array(&job_desc_ptr->environment,
-				     &job_desc_ptr->env_size, buffer);
+		if (borrow)
+			safe_unpackstr_array_ptr(&job_desc_ptr->environment,
+						 &job_desc_ptr->env_size,
+						 buffer);
+		else
+			safe_unpackstr_array(&job_desc_ptr->environment,
+					     &job_desc_ptr->env_size, buffer);
 
 		if (job_desc_ptr->env_size) {
 			job_desc_ptr->env_hash.type = HASH_PLUGIN_K12;
@@ -6855,8 +6916,12 @@ _unpack_job_desc_msg(job_desc_msg_t ** job_desc_buffer_ptr, buf_t *buffer,
 		if (envcount(job_desc_ptr->spank_job_env)
 		    != job_desc_ptr->spank_job_env_size)
 			goto unpack_error;
-		safe_unpackstr_xmalloc(&job_desc_ptr->script,
-				       &script_len, buffer);
+		if (borrow)
+			safe_unpackstr_ptr(&job_desc_ptr->script, &script_len,
+					   buffer);
+		else
+			safe_unpackstr_xmalloc(&job_desc_ptr->script,
+					       &script_len, buffer);
 
 		job_desc_ptr->script_hash.type = HASH_PLUGIN_K12;
 		(void) hash_g_compute(job_desc_ptr->script, script_len,
@@ -6961,6 +7026,7 @@ _unpack_job_desc_msg(job_desc_msg_t ** job_desc_buffer_ptr, buf_t *buffer,
 		uint8_t uint8_tmp;
 		job_desc_ptr = xmalloc(sizeof(job_desc_msg_t));
 		*job_desc_buffer_ptr = job_desc_ptr;
+		job_desc_ptr->script_env_borrowed = borrow;
 
 		/* load the data values */
 		safe_unpack32(&job_desc_ptr->site_factor, buffer);
@@ -7015,8 +7081,13 @@ _unpack_job_desc_msg(job_desc_msg_t ** job_desc_buffer_ptr, buf_t *buffer,
 		safe_unpackstr(&job_desc_ptr->req_nodes, buffer);
 		safe_unpackstr(&job_desc_ptr->exc_nodes, buffer);
 		start = buffer->processed;
-		safe_unpackstr_array(&job_desc_ptr->environment,
-				     &job_desc_ptr->env_size, buffer);
+		if (borrow)
+			safe_unpackstr_array_ptr(&job_desc_ptr->environment,
+						 &job_desc_ptr->env_size,
+						 buffer);
+		else
+			safe_unpackstr_array(&job_desc_ptr->environment,
+					     &job_desc_ptr->env_size, buffer);
 
 		if (job_desc_ptr->env_size) {
 			job_desc_ptr->env_hash.type = HASH_PLUGIN_K12;
@@ -7034,8 +7105,12 @@ _unpack_job_desc_msg(job_desc_msg_t ** job_desc_buffer_ptr, buf_t *buffer,
 		if (envcount(job_desc_ptr->spank_job_env)
 		    != job_desc_ptr->spank_job_env_size)
 			goto unpack_error;
-		safe_unpackstr_xmalloc(&job_desc_ptr->script,
-				       &script_len, buffer);
+		if (borrow)
+			safe_unpackstr_ptr(&job_desc_ptr->script, &script_len,
+					   buffer);
+		else
+			safe_unpackstr_xmalloc(&job_desc_ptr->script,
+					       &script_len, buffer);
 
 		job_desc_ptr->script_hash.type = HASH_PLUGIN_K12;
 		(void) hash_g_compute(job_desc_ptr->script, script_len,
@@ -7188,8 +7263,8 @@ static int _unpack_job_desc_list_msg(list_t **job_req_list, buf_t *buffer,
 	*job_req_list = list_create((ListDelF) slurm_free_job_desc_msg);
 	for (i = 0; i < cnt; i++) {
 		req = NULL;
-		if (_unpack_job_desc_msg(&req, buffer, protocol_version) !=
-		    SLURM_SUCCESS)
+		if (_unpack_job_desc_msg(&req, buffer, protocol_version,
+					 false) != SLURM_SUCCESS)
 			goto unpack_error;
 		list_append(*job_req_list, req);
 	}
@@ -9389,6 +9464,64 @@ unpack_error:
 	return SLURM_ERROR;
 }
 
+static void _pack_job_info_delta_request_msg(const slurm_msg_t *smsg,
+					     buf_t *buffer)
+{
+	job_info_delta_request_msg_t *msg = smsg->data;
+
+	if (smsg->protocol_version >= SLURM_24_11_PROTOCOL_VERSION) {
+		pack64(msg->generation, buffer);
+		pack16(msg->show_flags, buffer);
+	}
+}
+
+static int _unpack_job_info_delta_request_msg(slurm_msg_t *smsg,
+					      buf_t *buffer)
+{
+	job_info_delta_request_msg_t *msg = xmalloc(sizeof(*msg));
+	smsg->data = msg;
+
+	if (smsg->protocol_version >= SLURM_24_11_PROTOCOL_VERSION) {
+		safe_unpack64(&msg->generation, buffer);
+		safe_unpack16(&msg->show_flags, buffer);
+	}
+
+	return SLURM_SUCCESS;
+
+unpack_error:
+	smsg->data = NULL;
+	slurm_free_job_info_delta_request_msg(msg);
+	return SLURM_ERROR;
+}
+
+/* NOTE: packed by pack_delta_jobs() in slurmctld/job_mgr.c */
+static int _unpack_job_info_delta_msg(slurm_msg_t *smsg, buf_t *buffer)
+{
+	job_info_delta_msg_t *msg = xmalloc(sizeof(*msg));
+	slurm_msg_t jobs_msg = {
+		.protocol_version = smsg->protocol_version,
+	};
+
+	smsg->data = msg;
+
+	if (smsg->protocol_version >= SLURM_24_11_PROTOCOL_VERSION) {
+		safe_unpack64(&msg->generation, buffer);
+		safe_unpackbool(&msg->full, buffer);
+		safe_unpack32_array(&msg->purged_job_ids, &msg->purged_cnt,
+				    buffer);
+		if (_unpack_job_info_msg(&jobs_msg, buffer))
+			goto unpack_error;
+		msg->jobs = jobs_msg.data;
+	}
+
+	return SLURM_SUCCESS;
+
+unpack_error:
+	smsg->data = NULL;
+	slurm_free_job_info_delta_msg(msg);
+	return SLURM_ERROR;
+}
+
 static int _unpack_burst_buffer_info_msg(
 	burst_buffer_info_msg_t **burst_buffer_info, buf_t *buffer,
 	uint16_t protocol_version)
@@ -9918,7 +10051,7 @@ _pack_batch_job_launch_msg(batch_job_launch_msg_t * msg, buf_t *buffer,
 
 		packstr(msg->cpu_bind, buffer);
 		packstr(msg->nodes, buffer);
-		packstr(msg->script, buffer);
+		packstr_ref(msg->script, buffer);
 		packstr(msg->work_dir, buffer);
 		packstr(msg->std_err, buffer);
 		packstr(msg->std_in, buffer);
@@ -9982,7 +10115,7 @@ _pack_batch_job_launch_msg(batch_job_launch_msg_t * msg, buf_t *buffer,
 
 		packstr(msg->cpu_bind, buffer);
 		packstr(msg->nodes, buffer);
-		packstr(msg->script, buffer);
+		packstr_ref(msg->script, buffer);
 		packstr(msg->work_dir, buffer);
 		packstr(msg->std_err, buffer);
 		packstr(msg->std_in, buffer);
@@ -10044,7 +10177,7 @@ _pack_batch_job_launch_msg(batch_job_launch_msg_t * msg, buf_t *buffer,
 		packstr(msg->alias_list, buffer);
 		packstr(msg->cpu_bind, buffer);
 		packstr(msg->nodes, buffer);
-		packstr(msg->script, buffer);
+		packstr_ref(msg->script, buffer);
 		packstr(msg->work_dir, buffer);
 		packstr(msg->std_err, buffer);
 		packstr(msg->std_in, buffer);
@@ -10077,7 +10210,7 @@ _pack_batch_job_launch_msg(batch_job_launch_msg_t * msg, buf_t *buffer,
 
 static int
 _unpack_batch_job_launch_msg(batch_job_launch_msg_t ** msg, buf_t *buffer,
-			     uint16_t protocol_version)
+			     uint16_t protocol_version, bool borrow)
 {
 	uint32_t uint32_tmp;
 	batch_job_launch_msg_t *launch_msg_ptr;
@@ -10085,6 +10218,7 @@ _unpack_batch_job_launch_msg(batch_job_launch_msg_t ** msg, buf_t *buffer,
 	xassert(msg);
 	launch_msg_ptr = xmalloc(sizeof(batch_job_launch_msg_t));
 	*msg = launch_msg_ptr;
+	launch_msg_ptr->script_borrowed = borrow;
 
 	if (protocol_version >= SLURM_24_11_PROTOCOL_VERSION) {
 		safe_unpack32(&launch_msg_ptr->job_id, buffer);
@@ -10123,7 +10257,11 @@ _unpack_batch_job_launch_msg(batch_job_launch_msg_t ** msg, buf_t *buffer,
 
 		safe_unpackstr(&launch_msg_ptr->cpu_bind, buffer);
 		safe_unpackstr(&launch_msg_ptr->nodes, buffer);
-		safe_unpackstr(&launch_msg_ptr->script, buffer);
+		if (borrow)
+			safe_unpackstr_ptr(&launch_msg_ptr->script,
+					   &uint32_tmp, buffer);
+		else
+			safe_unpackstr(&launch_msg_ptr->script, buffer);
 		safe_unpackstr(&launch_msg_ptr->work_dir, buffer);
 		safe_unpackstr(&launch_msg_ptr->std_err, buffer);
 		safe_unpackstr(&launch_msg_ptr->std_in, buffer);
@@ -10194,7 +10332,11 @@ _unpack_batch_job_launch_msg(batch_job_launch_msg_t ** msg, buf_t *buffer,
 		safe_unpackstr(&launch_msg_ptr->alias_list, buffer);
 		safe_unpackstr(&launch_msg_ptr->cpu_bind, buffer);
 		safe_unpackstr(&launch_msg_ptr->nodes, buffer);
-		safe_unpackstr(&launch_msg_ptr->script, buffer);
+		if (borrow)
+			safe_unpackstr_ptr(&launch_msg_ptr->script,
+					   &uint32_tmp, buffer);
+		else
+			safe_unpackstr(&launch_msg_ptr->script, buffer);
 		safe_unpackstr(&launch_msg_ptr->work_dir, buffer);
 		safe_unpackstr(&launch_msg_ptr->std_err, buffer);
 		safe_unpackstr(&launch_msg_ptr->std_in, buffer);
@@ -10265,7 +10407,11 @@ _unpack_batch_job_launch_msg(batch_job_launch_msg_t ** msg, buf_t *buffer,
 		safe_unpackstr(&launch_msg_ptr->alias_list, buffer);
 		safe_unpackstr(&launch_msg_ptr->cpu_bind, buffer);
 		safe_unpackstr(&launch_msg_ptr->nodes, buffer);
-		safe_unpackstr(&launch_msg_ptr->script, buffer);
+		if (borrow)
+			safe_unpackstr_ptr(&launch_msg_ptr->script,
+					   &uint32_tmp, buffer);
+		else
+			safe_unpackstr(&launch_msg_ptr->script, buffer);
 		safe_unpackstr(&launch_msg_ptr->work_dir, buffer);
 		safe_unpackstr(&launch_msg_ptr->std_err, buffer);
 		safe_unpackstr(&launch_msg_ptr->std_in, buffer);
@@ -11120,7 +11266,9 @@ static void _pack_file_bcast(file_bcast_msg_t * msg , buf_t *buffer,
 {
 	xassert(msg);
 
-	grow_buf(buffer,  msg->block_len);
+	/* Large blocks are referenced by packmem_ref() instead of copied */
+	if (!buffer->allow_refs || (msg->block_len < PACK_REF_MIN_LEN))
+		grow_buf(buffer,  msg->block_len);
 
 	if (protocol_version >= SLURM_24_05_PROTOCOL_VERSION) {
 		pack32(msg->block_no, buffer);
@@ -11141,7 +11289,7 @@ static void _pack_file_bcast(file_bcast_msg_t * msg , buf_t *buffer,
 		pack32(msg->uncomp_len, buffer);
 		pack64(msg->block_offset, buffer);
 		pack64(msg->file_size, buffer);
-		packmem(msg->block, msg->block_len, buffer);
+		packmem_ref(msg->block, msg->block_len, buffer);
 		pack_sbcast_cred(msg->cred, buffer, protocol_version);
 	} else if (protocol_version >= SLURM_MIN_PROTOCOL_VERSION) {
 		pack32(msg->block_no, buffer);
@@ -11161,7 +11309,7 @@ static void _pack_file_bcast(file_bcast_msg_t * msg , buf_t *buffer,
 		pack32(msg->uncomp_len, buffer);
 		pack64(msg->block_offset, buffer);
 		pack64(msg->file_size, buffer);
-		packmem(msg->block, msg->block_len, buffer);
+		packmem_ref(msg->block, msg->block_len, buffer);
 		pack_sbcast_cred(msg->cred, buffer, protocol_version);
 	}
 }
@@ -11902,6 +12050,37 @@ unpack_error:
 	return SLURM_ERROR;
 }
 
+static int _unpack_stats_history(stats_history_t *hist, buf_t *buffer)
+{
+	safe_unpack_time(&hist->sample_time, buffer);
+	safe_unpack32(&hist->schedule_cycles, buffer);
+	safe_unpack64(&hist->schedule_cycle_sum, buffer);
+	safe_unpack32(&hist->schedule_cycle_last, buffer);
+	safe_unpack32(&hist->schedule_depth_sum, buffer);
+	safe_unpack32(&hist->schedule_queue_len, buffer);
+	safe_unpack32(&hist->bf_cycles, buffer);
+	safe_unpack64(&hist->bf_cycle_sum, buffer);
+	safe_unpack32(&hist->bf_cycle_last, buffer);
+	safe_unpack32(&hist->bf_depth_sum, buffer);
+	safe_unpack32(&hist->bf_backfilled_jobs, buffer);
+	safe_unpack32(&hist->jobs_submitted, buffer);
+	safe_unpack32(&hist->jobs_started, buffer);
+	safe_unpack32(&hist->jobs_completed, buffer);
+	safe_unpack32(&hist->jobs_canceled, buffer);
+	safe_unpack32(&hist->jobs_failed, buffer);
+	safe_unpack32(&hist->jobs_pending, buffer);
+	safe_unpack32(&hist->jobs_running, buffer);
+	safe_unpack64(&hist->rpc_count, buffer);
+	safe_unpack64(&hist->rpc_time, buffer);
+	safe_unpack32(&hist->server_thread_count, buffer);
+	safe_unpack32(&hist->agent_queue_size, buffer);
+
+	return SLURM_SUCCESS;
+
+unpack_error:
+	return SLURM_ERROR;
+}
+
 static int  _unpack_stats_response_msg(stats_info_response_msg_t **msg_ptr,
 				       buf_t *buffer, uint16_t protocol_version)
 {
@@ -11912,7 +12091,176 @@ static int  _unpack_stats_response_msg(stats_info_response_msg_t **msg_ptr,
 	msg = xmalloc ( sizeof (stats_info_response_msg_t) );
 	*msg_ptr = msg ;
 
-	if (protocol_version >= SLURM_24_05_PROTOCOL_VERSION) {
+	if (protocol_version >= SLURM_24_11_PROTOCOL_VERSION) {
+		safe_unpack32(&msg->parts_packed, buffer);
+		if (msg->parts_packed) {
+			safe_unpack_time(&msg->req_time, buffer);
+			safe_unpack_time(&msg->req_time_start, buffer);
+			safe_unpack32(&msg->server_thread_count, buffer);
+			safe_unpack32(&msg->agent_queue_size, buffer);
+			safe_unpack32(&msg->agent_count, buffer);
+			safe_unpack32(&msg->agent_thread_count, buffer);
+			safe_unpack32(&msg->dbd_agent_queue_size, buffer);
+			safe_unpack32(&msg->gettimeofday_latency, buffer);
+			safe_unpack32(&msg->jobs_submitted, buffer);
+			safe_unpack32(&msg->jobs_started, buffer);
+			safe_unpack32(&msg->jobs_completed, buffer);
+			safe_unpack32(&msg->jobs_canceled, buffer);
+			safe_unpack32(&msg->jobs_failed, buffer);
+			safe_unpack32(&msg->jobs_pending, buffer);
+			safe_unpack32(&msg->jobs_running, buffer);
+			safe_unpack_time(&msg->job_states_ts, buffer);
+
+			safe_unpack32(&msg->schedule_cycle_max, buffer);
+			safe_unpack32(&msg->schedule_cycle_last, buffer);
+			safe_unpack32(&msg->schedule_cycle_sum, buffer);
+			safe_unpack32(&msg->schedule_cycle_counter, buffer);
+			safe_unpack32(&msg->schedule_cycle_depth, buffer);
+			safe_unpack32_array(&msg->schedule_exit,
+					    &msg->schedule_exit_cnt, buffer);
+			safe_unpack32(&msg->schedule_queue_len, buffer);
+
+			safe_unpack32(&msg->bf_backfilled_jobs, buffer);
+			safe_unpack32(&msg->bf_last_backfilled_jobs, buffer);
+			safe_unpack32(&msg->bf_cycle_counter, buffer);
+			safe_unpack64(&msg->bf_cycle_sum, buffer);
+			safe_unpack32(&msg->bf_cycle_last, buffer);
+			safe_unpack32(&msg->bf_last_depth, buffer);
+			safe_unpack32(&msg->bf_last_depth_try, buffer);
+
+			safe_unpack32(&msg->bf_queue_len, buffer);
+			safe_unpack32(&msg->bf_cycle_max, buffer);
+			safe_unpack_time(&msg->bf_when_last_cycle, buffer);
+			safe_unpack32(&msg->bf_depth_sum, buffer);
+			safe_unpack32(&msg->bf_depth_try_sum, buffer);
+			safe_unpack32(&msg->bf_queue_len_sum, buffer);
+			safe_unpack32(&msg->bf_table_size, buffer);
+			safe_unpack32(&msg->bf_table_size_sum, buffer);
+
+			safe_unpack32(&msg->bf_active, buffer);
+			safe_unpack32(&msg->bf_backfilled_het_jobs, buffer);
+			safe_unpack32_array(&msg->bf_exit,
+					    &msg->bf_exit_cnt, buffer);
+		}
+
+		safe_unpack32(&msg->rpc_type_size, buffer);
+		safe_unpack16_array(&msg->rpc_type_id, &uint32_tmp, buffer);
+		safe_unpack32_array(&msg->rpc_type_cnt, &uint32_tmp, buffer);
+		safe_unpack64_array(&msg->rpc_type_time, &uint32_tmp, buffer);
+
+		safe_unpack8(&msg->rpc_queue_enabled, buffer);
+		if (msg->rpc_queue_enabled) {
+			safe_unpack16_array(&msg->rpc_type_queued,
+					    &uint32_tmp, buffer);
+			safe_unpack64_array(&msg->rpc_type_dropped,
+					    &uint32_tmp, buffer);
+			safe_unpack16_array(&msg->rpc_type_cycle_last,
+					    &uint32_tmp, buffer);
+			safe_unpack16_array(&msg->rpc_type_cycle_max,
+					    &uint32_tmp, buffer);
+		}
+
+		safe_unpack32(&msg->rpc_user_size, buffer);
+		safe_unpack32_array(&msg->rpc_user_id, &uint32_tmp, buffer);
+		safe_unpack32_array(&msg->rpc_user_cnt, &uint32_tmp, buffer);
+		safe_unpack64_array(&msg->rpc_user_time, &uint32_tmp, buffer);
+
+		safe_unpack32_array(&msg->rpc_queue_type_id,
+				    &msg->rpc_queue_type_count,
+				    buffer);
+		safe_unpack32_array(&msg->rpc_queue_count,
+				    &uint32_tmp, buffer);
+		if (uint32_tmp != msg->rpc_queue_type_count)
+			goto unpack_error;
+
+		safe_unpack32_array(&msg->rpc_dump_types,
+				    &msg->rpc_dump_count,
+				    buffer);
+		safe_unpackstr_array(&msg->rpc_dump_hostlist,
+				     &uint32_tmp,
+				     buffer);
+		if (uint32_tmp != msg->rpc_dump_count)
+			goto unpack_error;
+
+		safe_unpack32(&msg->lock_stats_hist_cnt, buffer);
+		safe_unpack32(&msg->lock_stats_type_cnt, buffer);
+		safe_unpackstr_array(&msg->lock_stats_name,
+				     &msg->lock_stats_cnt, buffer);
+		safe_unpack64_array(&msg->lock_stats_count, &uint32_tmp, buffer);
+		if (uint32_tmp != msg->lock_stats_cnt)
+			goto unpack_error;
+		safe_unpack64_array(&msg->lock_stats_wait_time, &uint32_tmp,
+				    buffer);
+		if (uint32_tmp != msg->lock_stats_cnt)
+			goto unpack_error;
+		safe_unpack64_array(&msg->lock_stats_wait_max, &uint32_tmp,
+				    buffer);
+		if (uint32_tmp != msg->lock_stats_cnt)
+			goto unpack_error;
+		safe_unpack64_array(&msg->lock_stats_hold_time, &uint32_tmp,
+				    buffer);
+		if (uint32_tmp != msg->lock_stats_cnt)
+			goto unpack_error;
+		safe_unpack64_array(&msg->lock_stats_hold_max, &uint32_tmp,
+				    buffer);
+		if (uint32_tmp != msg->lock_stats_cnt)
+			goto unpack_error;
+		safe_unpack32_array(&msg->lock_stats_wait_hist, &uint32_tmp,
+				    buffer);
+		if (uint32_tmp !=
+		    (msg->lock_stats_cnt * msg->lock_stats_hist_cnt))
+			goto unpack_error;
+		safe_unpack32_array(&msg->lock_stats_hold_hist, &uint32_tmp,
+				    buffer);
+		if (uint32_tmp !=
+		    (msg->lock_stats_cnt * msg->lock_stats_hist_cnt))
+			goto unpack_error;
+
+		safe_unpack32(&msg->sched_phase_hist_cnt, buffer);
+		safe_unpackstr_array(&msg->sched_phase_name,
+				     &msg->sched_phase_cnt, buffer);
+		safe_unpack64_array(&msg->sched_phase_count, &uint32_tmp,
+				    buffer);
+		if (uint32_tmp != msg->sched_phase_cnt)
+			goto unpack_error;
+		safe_unpack64_array(&msg->sched_phase_time, &uint32_tmp,
+				    buffer);
+		if (uint32_tmp != msg->sched_phase_cnt)
+			goto unpack_error;
+		safe_unpack64_array(&msg->sched_phase_max, &uint32_tmp,
+				    buffer);
+		if (uint32_tmp != msg->sched_phase_cnt)
+			goto unpack_error;
+		safe_unpack32_array(&msg->sched_phase_hist, &uint32_tmp,
+				    buffer);
+		if (uint32_tmp !=
+		    (msg->sched_phase_cnt * msg->sched_phase_hist_cnt))
+			goto unpack_error;
+
+		safe_unpack32(&msg->rpc_type_hist_cnt, buffer);
+		safe_unpack32_array(&msg->rpc_type_time_hist, &uint32_tmp,
+				    buffer);
+		if (uint32_tmp !=
+		    (msg->rpc_type_size * msg->rpc_type_hist_cnt))
+			goto unpack_error;
+		safe_unpack32_array(&msg->rpc_type_wait_hist, &uint32_tmp,
+				    buffer);
+		if (uint32_tmp !=
+		    (msg->rpc_type_size * msg->rpc_type_hist_cnt))
+			goto unpack_error;
+
+		safe_unpack32(&msg->history_interval, buffer);
+		safe_unpack32(&msg->history_cnt, buffer);
+		if (msg->history_cnt >= NO_VAL)
+			goto unpack_error;
+		if (msg->history_cnt)
+			safe_xcalloc(msg->history, msg->history_cnt,
+				     sizeof(*msg->history));
+		for (int i = 0; i < msg->history_cnt; i++) {
+			if (_unpack_stats_history(&msg->history[i], buffer))
+				goto unpack_error;
+		}
+	} else if (protocol_version >= SLURM_24_05_PROTOCOL_VERSION) {
 		safe_unpack32(&msg->parts_packed, buffer);
 		if (msg->parts_packed) {
 			safe_unpack_time(&msg->req_time, buffer);
@@ -13066,6 +13414,46 @@ unpack_error:
 	return SLURM_ERROR;
 }
 
+/* shadow_msg_body
+ * For messages whose body was already packed into a buffer (e.g. the
+ * RESPONSE_JOB_INFO buffer built by pack_all_jobs()), return a shadow buffer
+ * referencing that data so it can be sent without copying it into a second
+ * buffer. The returned buffer must not outlive msg->data.
+ * IN msg - the message to send
+ * RET shadow buffer with offset at end of data or NULL if msg must be packed
+ */
+extern buf_t *shadow_msg_body(slurm_msg_t const *msg)
+{
+	buf_t *msg_buffer = msg->data, *buffer;
+
+	if (msg->protocol_version < SLURM_MIN_PROTOCOL_VERSION)
+		return NULL;
+
+	switch (msg->msg_type) {
+	case RESPONSE_ASSOC_MGR_INFO:
+	case RESPONSE_BURST_BUFFER_INFO:
+	case RESPONSE_FRONT_END_INFO:
+	case RESPONSE_JOB_INFO:
+	case RESPONSE_JOB_INFO_DELTA:
+	case RESPONSE_JOB_STEP_INFO:
+	case RESPONSE_LICENSE_INFO:
+	case RESPONSE_NODE_INFO:
+	case RESPONSE_PARTITION_INFO:
+	case RESPONSE_RESERVATION_INFO:
+	case RESPONSE_STATS_INFO:
+		break;
+	default:
+		return NULL;
+	}
+
+	if (!msg_buffer || !(buffer = create_shadow_buf(msg_buffer->head,
+							 msg_buffer->processed)))
+		return NULL;
+
+	set_buf_offset(buffer, msg_buffer->processed);
+	return buffer;
+}
+
 /* pack_msg
  * packs a generic slurm protocol message body
  * IN msg - the body structure to pack (note: includes message type)
@@ -13088,6 +13476,7 @@ pack_msg(slurm_msg_t const *msg, buf_t *buffer)
 	case RESPONSE_BURST_BUFFER_INFO:
 	case RESPONSE_FRONT_END_INFO:
 	case RESPONSE_JOB_INFO:
+	case RESPONSE_JOB_INFO_DELTA:
 	case RESPONSE_JOB_STEP_INFO:
 	case RESPONSE_LICENSE_INFO:
 	case RESPONSE_NODE_INFO:
@@ -13147,9 +13536,14 @@ pack_msg(slurm_msg_t const *msg, buf_t *buffer)
 		break;
 	case REQUEST_HET_JOB_ALLOCATION:
 	case REQUEST_SUBMIT_BATCH_HET_JOB:
+	case REQUEST_SUBMIT_BATCH_JOBS:
 		_pack_job_desc_list_msg(msg->data, buffer,
 					msg->protocol_version);
 		break;
+	case RESPONSE_SUBMIT_BATCH_JOBS:
+		_pack_submit_jobs_response_msg(msg->data, buffer,
+					       msg->protocol_version);
+		break;
 	case RESPONSE_HET_JOB_ALLOCATION:
 		_pack_job_info_list_msg(msg->data, buffer,
 					msg->protocol_version);
@@ -13326,6 +13720,9 @@ pack_msg(slurm_msg_t const *msg, buf_t *buffer)
 	case RESPONSE_JOB_STATE:
 		_pack_job_state_response_msg(msg, buffer);
 		break;
+	case REQUEST_JOB_INFO_DELTA:
+		_pack_job_info_delta_request_msg(msg, buffer);
+		break;
 	case REQUEST_CANCEL_JOB_STEP:
 	case REQUEST_KILL_JOB:
 	case SRUN_STEP_SIGNAL:
@@ -13711,11 +14108,15 @@ pack_msg(slurm_msg_t const *msg, buf_t *buffer)
  * IN/OUT buffer - source of the unpack, contains pointers that are
  *			automatically updated
  * RET 0 or error code
+ * NOTE: When buffer is msg->buffer, large strings of REQUEST_SUBMIT_BATCH_JOB
+ *	 and REQUEST_BATCH_JOB_LAUNCH are left in the buffer instead of being
+ *	 copied, since the buffer is freed along with the message.
  */
 int
 unpack_msg(slurm_msg_t * msg, buf_t *buffer)
 {
 	int rc = SLURM_SUCCESS;
+	bool borrow = (msg->buffer && (msg->buffer == buffer));
 	msg->data = NULL;	/* Initialize to no data for now */
 
 	if (msg->protocol_version < SLURM_MIN_PROTOCOL_VERSION) {
@@ -13794,13 +14195,21 @@ unpack_msg(slurm_msg_t * msg, buf_t *buffer)
 	case REQUEST_JOB_WILL_RUN:
 	case REQUEST_UPDATE_JOB:
 		rc = _unpack_job_desc_msg((job_desc_msg_t **) & (msg->data),
-					  buffer, msg->protocol_version);
+					  buffer, msg->protocol_version,
+					  (borrow && (msg->msg_type ==
+						      REQUEST_SUBMIT_BATCH_JOB)));
 		break;
 	case REQUEST_HET_JOB_ALLOCATION:
 	case REQUEST_SUBMIT_BATCH_HET_JOB:
+	case REQUEST_SUBMIT_BATCH_JOBS:
 		rc = _unpack_job_desc_list_msg((list_t **) &(msg->data),
 					       buffer, msg->protocol_version);
 		break;
+	case RESPONSE_SUBMIT_BATCH_JOBS:
+		rc = _unpack_submit_jobs_response_msg(
+			(submit_jobs_response_msg_t **) &msg->data, buffer,
+			msg->protocol_version);
+		break;
 	case RESPONSE_HET_JOB_ALLOCATION:
 		rc = _unpack_job_info_list_msg((list_t **) &(msg->data),
 					       buffer, msg->protocol_version);
@@ -13987,6 +14396,12 @@ unpack_msg(slurm_msg_t * msg, buf_t *buffer)
 	case RESPONSE_JOB_STATE:
 		rc = _unpack_job_state_response_msg(msg, buffer);
 		break;
+	case REQUEST_JOB_INFO_DELTA:
+		rc = _unpack_job_info_delta_request_msg(msg, buffer);
+		break;
+	case RESPONSE_JOB_INFO_DELTA:
+		rc = _unpack_job_info_delta_msg(msg, buffer);
+		break;
 	case REQUEST_CANCEL_JOB_STEP:
 	case REQUEST_KILL_JOB:
 	case SRUN_STEP_SIGNAL:
@@ -14065,7 +14480,8 @@ unpack_msg(slurm_msg_t * msg, buf_t *buffer)
 	case REQUEST_BATCH_JOB_LAUNCH:
 		rc = _unpack_batch_job_launch_msg((batch_job_launch_msg_t **)
 						  & (msg->data), buffer,
-						  msg->protocol_version);
+						  msg->protocol_version,
+						  borrow);
 		break;
 	case REQUEST_LAUNCH_PROLOG:
 		rc = _unpack_prolog_launch_msg(msg, buffer);
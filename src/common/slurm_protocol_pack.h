@@ -84,6 +84,12 @@ extern int unpack_header(header_t *header, buf_t *buffer);
  */
 extern int pack_msg(slurm_msg_t const *msg, buf_t *buffer);
 
+/*
+ * Return shadow buffer over an already packed message body or NULL if the
+ * message must be packed with pack_msg(). Buffer must not outlive msg->data.
+ */
+extern buf_t *shadow_msg_body(slurm_msg_t const *msg);
+
 /*
  * unpacks a generic slurm protocol message body
  * OUT msg - the body structure to unpack (note: includes message type)
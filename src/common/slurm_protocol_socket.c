@@ -348,14 +348,24 @@ extern ssize_t slurm_msg_sendto(int fd, char *buffer, size_t size)
 
 extern ssize_t slurm_bufs_sendto(int fd, msg_bufs_t *buffers)
 {
-	struct iovec iov[4];
-	int len;
+	struct iovec iov_static[4], *iov = iov_static, *body_iov = NULL;
+	int len, iovcnt = 4;
 	uint32_t usize;
 	SigFunc *ohandler;
 	int timeout = slurm_conf.msg_timeout * 1000;
 
 	xassert(buffers);
 
+	/* Body references payloads packed by packmem_ref() */
+	if (buffers->body->ref_cnt) {
+		int body_cnt = get_buf_iovec(buffers->body, &body_iov);
+
+		iovcnt = 3 + body_cnt;
+		iov = xcalloc(iovcnt, sizeof(*iov));
+		memcpy(&iov[3], body_iov, (body_cnt * sizeof(*iov)));
+		xfree(body_iov);
+	}
+
 	/*
 	 * Ignore SIGPIPE so that send can return a error code if the other
 	 * side closes the socket
@@ -369,14 +379,19 @@ extern ssize_t slurm_bufs_sendto(int fd, msg_bufs_t *buffers)
 	iov[1].iov_len = get_buf_offset(buffers->header);
 	iov[2].iov_base = buffers->auth ? get_buf_data(buffers->auth) : NULL;
 	iov[2].iov_len = buffers->auth ? get_buf_offset(buffers->auth) : 0;
-	iov[3].iov_base = get_buf_data(buffers->body);
-	iov[3].iov_len = get_buf_offset(buffers->body);
+	if (iov == iov_static) {
+		iov[3].iov_base = get_buf_data(buffers->body);
+		iov[3].iov_len = get_buf_offset(buffers->body);
+	}
 
-	usize = htonl(iov[1].iov_len + iov[2].iov_len + iov[3].iov_len);
+	usize = htonl(iov[1].iov_len + iov[2].iov_len +
+		      get_buf_packed_size(buffers->body));
 
-	len = _writev_timeout(fd, iov, 4, timeout);
+	len = _writev_timeout(fd, iov, iovcnt, timeout);
 
 	xsignal(SIGPIPE, ohandler);
+	if (iov != iov_static)
+		xfree(iov);
 	return len;
 }
 
@@ -706,6 +721,13 @@ extern void slurm_set_addr(slurm_addr_t *addr, uint16_t port, char *host)
 	log_flag(NET, "%s: called with port='%u' host='%s'",
 		__func__, port, host);
 
+	if (host && slurm_conf.getaddrinfo_cache_timeout) {
+		if (xgetaddr_cached(host, port, addr))
+			error_in_daemon("%s: Unable to resolve \"%s\"",
+					__func__, host);
+		return;
+	}
+
 	/*
 	 * xgetaddrinfo uses hints from our config to determine what address
 	 * families to return
@@ -193,6 +193,7 @@
 
 /* list.[ch] functions */
 #define	list_create		slurm_list_create
+#define	list_create_unlocked	slurm_list_create_unlocked
 #define	list_destroy		slurm_list_destroy
 #define	list_is_empty		slurm_list_is_empty
 #define	list_count		slurm_list_count
@@ -37,13 +37,17 @@
 \*****************************************************************************/
 
 #include <stdio.h>
+#include <string.h>
 #include <sys/time.h>
 #include "src/common/log.h"
+#include "src/common/macros.h"
 #include "src/common/slurm_protocol_defs.h"
 #include "src/common/slurm_time.h"
 #include "src/common/timers.h"
 #include "src/common/xassert.h"
 
+static pthread_mutex_t timer_phase_mutex = PTHREAD_MUTEX_INITIALIZER;
+
 /* Return the number of micro-seconds between now and argument "tv",
  * Initialize tv to NOW if zero on entry */
 extern int slurm_delta_tv(struct timeval *tv)
@@ -168,3 +172,84 @@ extern latency_metric_rc_t latency_metric_end(latency_metric_t *metric,
 
 	return rc;
 }
+
+extern void timer_phase_add(timer_phase_t *phase, long usec)
+{
+	uint64_t delta = (usec > 0) ? usec : 0, limit = 10;
+	int bucket = 0;
+
+	while ((bucket < (TIMER_PHASE_HIST_CNT - 1)) && (delta >= limit)) {
+		limit *= 10;
+		bucket++;
+	}
+
+	SLURM_PROBE2(phase__done, phase->name, delta);
+
+	slurm_mutex_lock(&timer_phase_mutex);
+	phase->count++;
+	phase->time += delta;
+	if (phase->max < delta)
+		phase->max = delta;
+	phase->hist[bucket]++;
+	slurm_mutex_unlock(&timer_phase_mutex);
+}
+
+extern void timer_phase_copy(timer_phase_t *phases, int cnt,
+			     timer_phase_t *copy)
+{
+	slurm_mutex_lock(&timer_phase_mutex);
+	memcpy(copy, phases, (sizeof(*phases) * cnt));
+	slurm_mutex_unlock(&timer_phase_mutex);
+}
+
+extern void timer_phase_reset(timer_phase_t *phases, int cnt)
+{
+	slurm_mutex_lock(&timer_phase_mutex);
+	for (int i = 0; i < cnt; i++) {
+		phases[i].count = 0;
+		phases[i].time = 0;
+		phases[i].max = 0;
+		memset(phases[i].hist, 0, sizeof(phases[i].hist));
+	}
+	slurm_mutex_unlock(&timer_phase_mutex);
+}
+
+extern int latency_hist_bucket(uint64_t usec)
+{
+	int bucket;
+
+	if (!usec)
+		return 0;
+
+	bucket = 64 - __builtin_clzll(usec);
+	return MIN(bucket, (LATENCY_HIST_CNT - 1));
+}
+
+extern uint64_t latency_hist_percentile(const uint32_t *hist,
+					uint32_t hist_cnt, double percentile)
+{
+	uint64_t total = 0, want, sum = 0;
+	double rank;
+
+	for (int i = 0; i < hist_cnt; i++)
+		total += hist[i];
+	if (!total)
+		return NO_VAL64;
+
+	/* rank of the wanted sample, counting from 1 */
+	rank = (total * percentile) / 100.0;
+	want = (uint64_t) rank;
+	if ((want < rank) || !want)
+		want++;
+
+	for (int i = 0; i < hist_cnt; i++) {
+		sum += hist[i];
+		if (sum < want)
+			continue;
+		if (i == (hist_cnt - 1))
+			return (i ? (1ULL << (i - 1)) : 0);
+		return (i ? (1ULL << i) : 0);
+	}
+
+	return (1ULL << (hist_cnt - 2));
+}
@@ -42,6 +42,8 @@
 #include <sys/time.h>
 #include <src/common/slurm_time.h>
 
+#include "src/common/probes.h"
+
 #define DEF_TIMERS	struct timeval tv1, tv2; char tv_str[20] = ""; long delta_t;
 #define START_TIMER	gettimeofday(&tv1, NULL)
 #define END_TIMER do {							\
@@ -78,6 +80,68 @@ extern void slurm_diff_tv_str(struct timeval *tv1,struct timeval *tv2,
 			      char *tv_str, int len_tv_str, const char *from,
 			      long limit, long *delta_t);
 
+/*
+ * Phase duration histogram buckets, in microseconds:
+ * <10, <100, <1000, <10000, <100000, <1000000, and anything longer.
+ */
+#define TIMER_PHASE_HIST_CNT 7
+
+/* Accumulated durations of one instrumented code phase */
+typedef struct {
+	const char *name;
+	uint64_t count;
+	uint64_t time;		/* usec */
+	uint64_t max;		/* usec */
+	uint32_t hist[TIMER_PHASE_HIST_CNT];
+} timer_phase_t;
+
+/*
+ * Time one pass through a code phase and account it in a timer_phase_t
+ * NOTE: DEF_PHASE_TIMER(name) must be in scope
+ */
+#define DEF_PHASE_TIMER(name) struct timeval name##_phase_tv
+#define START_PHASE_TIMER(name) \
+	do { \
+		SLURM_PROBE1(phase__start, #name); \
+		gettimeofday(&name##_phase_tv, NULL); \
+	} while (0)
+#define END_PHASE_TIMER(name, phase) \
+	timer_phase_add(phase, slurm_delta_tv(&name##_phase_tv))
+
+/* Account one pass of usec microseconds through phase, thread safe */
+extern void timer_phase_add(timer_phase_t *phase, long usec);
+
+/*
+ * Copy the accumulated values of cnt phases into copy consistently with
+ * concurrent timer_phase_add() calls
+ */
+extern void timer_phase_copy(timer_phase_t *phases, int cnt,
+			     timer_phase_t *copy);
+
+/* Clear the accumulated values of cnt phases, keeping their names */
+extern void timer_phase_reset(timer_phase_t *phases, int cnt);
+
+/*
+ * Latency histogram buckets, in microseconds: bucket 0 counts 0, bucket i
+ * counts [2^(i-1), 2^i), and the last bucket also counts anything longer
+ * (~67 seconds and up).
+ */
+#define LATENCY_HIST_CNT 28
+
+/* Return the latency histogram bucket of usec microseconds */
+extern int latency_hist_bucket(uint64_t usec);
+
+/*
+ * Estimate a percentile from a latency histogram
+ * IN hist - hist_cnt buckets as described above
+ * IN hist_cnt - number of buckets in hist
+ * IN percentile - wanted percentile, e.g. 99.9
+ * RET upper limit in usec of the bucket holding the percentile (the lower
+ *	limit for the last bucket), or NO_VAL64 if hist is empty
+ */
+extern uint64_t latency_hist_percentile(const uint32_t *hist,
+					uint32_t hist_cnt, double percentile);
+
 /* Struct to hold latency metric state */
 typedef struct {
 	timespec_t total;
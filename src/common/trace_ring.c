@@ -0,0 +1,330 @@
+/*****************************************************************************\
+ *  trace_ring.c - always-on binary ring of trace events
+ *****************************************************************************
+ *  Copyright (C) SchedMD LLC.
+ *
+ *  This file is part of Slurm, a resource management program.
+ *  For details, see <https://slurm.schedmd.com/>.
+ *  Please also read the included file: DISCLAIMER.
+ *
+ *  Slurm is free software; you can redistribute it and/or modify it under
+ *  the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the License, or (at your option)
+ *  any later version.
+ *
+ *  In addition, as a special exception, the copyright holders give permission
+ *  to link the code of portions of this program with the OpenSSL library under
+ *  certain conditions as described in each individual source file, and
+ *  distribute linked combinations including the two. You must obey the GNU
+ *  General Public License in all respects for all of the code used other than
+ *  OpenSSL. If you modify file(s) with this exception, you may extend this
+ *  exception to your version of the file(s), but you are not obligated to do
+ *  so. If you do not wish to do so, delete this exception statement from your
+ *  version.  If you delete this exception statement from all source files in
+ *  the program, then also delete it here.
+ *
+ *  Slurm is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with Slurm; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA.
+\*****************************************************************************/
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "slurm/slurm_errno.h"
+
+#include "src/common/log.h"
+#include "src/common/parse_time.h"
+#include "src/common/slurm_protocol_defs.h"
+#include "src/common/trace_ring.h"
+#include "src/common/xmalloc.h"
+#include "src/common/xstring.h"
+
+#define TRACE_RING_MAGIC 0x54524e47 /* "TRNG" */
+#define TRACE_RING_VERSION 1
+#define TRACE_RING_MAX_RECS (1 << 24)
+
+typedef struct {
+	uint32_t magic;
+	uint16_t version;
+	uint16_t rec_size;
+	uint32_t rec_cnt;	/* always a power of 2 */
+	uint32_t pid;
+	uint64_t start_usec;
+	uint64_t head;		/* records ever claimed */
+	char pad[32];
+} trace_ring_hdr_t;
+
+typedef struct {
+	uint64_t usec;		/* wall clock time */
+	uint32_t seq;		/* low bits of claim index + 1, 0 if torn */
+	uint16_t event;
+	uint16_t reserved;
+	uint32_t a;
+	uint32_t b;
+	uint64_t c;
+} trace_ring_rec_t;
+
+static trace_ring_hdr_t *ring = NULL;
+static trace_ring_rec_t *recs = NULL;
+static uint64_t rec_mask = 0;
+
+static const char *event_names[TRACE_EVENT_CNT] = {
+	[TRACE_EVENT_NONE] = "none",
+	[TRACE_EVENT_RPC_RECV] = "rpc_recv",
+	[TRACE_EVENT_RPC_DONE] = "rpc_done",
+	[TRACE_EVENT_LOCK] = "lock",
+	[TRACE_EVENT_UNLOCK] = "unlock",
+	[TRACE_EVENT_JOB_STATE] = "job_state",
+	[TRACE_EVENT_AGENT_SEND] = "agent_send",
+};
+
+/* Same order as slurmctld_lock_t, two bits per lock in the record */
+static const char *lock_names[] = { "conf", "job", "node", "part", "fed" };
+
+static uint64_t _now_usec(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_REALTIME, &ts);
+	return ((uint64_t) ts.tv_sec * USEC_IN_SEC) + (ts.tv_nsec / NSEC_IN_USEC);
+}
+
+static size_t _ring_size(uint32_t rec_cnt)
+{
+	return sizeof(trace_ring_hdr_t) + (rec_cnt * sizeof(trace_ring_rec_t));
+}
+
+static void *_map_file(const char *path, size_t size)
+{
+	void *ptr;
+	int fd;
+
+	if ((fd = open(path, (O_RDWR | O_CREAT | O_CLOEXEC), 0600)) < 0) {
+		error("%s: open(%s): %m", __func__, path);
+		return NULL;
+	}
+
+	/* Truncate first so a ring from a previous run reads as zeros */
+	if (ftruncate(fd, 0) || ftruncate(fd, size)) {
+		error("%s: ftruncate(%s): %m", __func__, path);
+		close(fd);
+		return NULL;
+	}
+
+	ptr = mmap(NULL, size, (PROT_READ | PROT_WRITE), MAP_SHARED, fd, 0);
+	close(fd);
+	if (ptr == MAP_FAILED) {
+		error("%s: mmap(%s): %m", __func__, path);
+		return NULL;
+	}
+
+	return ptr;
+}
+
+extern void trace_ring_init(const char *path, uint32_t rec_cnt)
+{
+	trace_ring_hdr_t *hdr = NULL;
+	uint32_t cnt = 1;
+	size_t size;
+
+	if (ring || !rec_cnt)
+		return;
+
+	rec_cnt = MIN(rec_cnt, TRACE_RING_MAX_RECS);
+	while (cnt < rec_cnt)
+		cnt <<= 1;
+	size = _ring_size(cnt);
+
+	if (path)
+		hdr = _map_file(path, size);
+	if (!hdr) {
+		hdr = mmap(NULL, size, (PROT_READ | PROT_WRITE),
+			   (MAP_PRIVATE | MAP_ANONYMOUS), -1, 0);
+		if (hdr == MAP_FAILED) {
+			error("%s: mmap(): %m", __func__);
+			return;
+		}
+		path = NULL;
+	}
+
+	hdr->magic = TRACE_RING_MAGIC;
+	hdr->version = TRACE_RING_VERSION;
+	hdr->rec_size = sizeof(trace_ring_rec_t);
+	hdr->rec_cnt = cnt;
+	hdr->pid = getpid();
+	hdr->start_usec = _now_usec();
+	hdr->head = 0;
+
+	recs = (trace_ring_rec_t *) (hdr + 1);
+	rec_mask = cnt - 1;
+	__atomic_store_n(&ring, hdr, __ATOMIC_RELEASE);
+
+	debug("%s: recording %u trace events in %s",
+	      __func__, cnt, (path ? path : "memory"));
+}
+
+extern void trace_ring_fini(void)
+{
+	/*
+	 * Threads may still be recording so the mapping is left in place
+	 * until the process exits. The file keeps the final events.
+	 */
+	__atomic_store_n(&ring, NULL, __ATOMIC_RELEASE);
+}
+
+extern void trace_ring_record(trace_event_t event, uint32_t a, uint32_t b,
+			      uint64_t c)
+{
+	trace_ring_hdr_t *hdr = __atomic_load_n(&ring, __ATOMIC_ACQUIRE);
+	trace_ring_rec_t *rec;
+	uint64_t idx;
+
+	if (!hdr)
+		return;
+
+	idx = __atomic_fetch_add(&hdr->head, 1, __ATOMIC_RELAXED);
+	rec = &recs[idx & rec_mask];
+
+	/* Mark the record torn until every field has been written */
+	__atomic_store_n(&rec->seq, 0, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+	rec->usec = _now_usec();
+	rec->event = event;
+	rec->a = a;
+	rec->b = b;
+	rec->c = c;
+	__atomic_store_n(&rec->seq, (uint32_t) (idx + 1), __ATOMIC_RELEASE);
+}
+
+static void _print_locks(uint32_t levels)
+{
+	char *str = NULL, *pos = NULL;
+
+	for (int i = 0; i < ARRAY_SIZE(lock_names); i++) {
+		uint32_t level = (levels >> (i * 2)) & 0x3;
+
+		if (level)
+			xstrfmtcatat(str, &pos, "%s%s:%s", (str ? "," : ""),
+				     lock_names[i],
+				     ((level == 1) ? "R" : "W"));
+	}
+
+	printf("locks=%s", (str ? str : "none"));
+	xfree(str);
+}
+
+static void _print_rec(trace_ring_rec_t *rec)
+{
+	char time_str[64];
+	time_t t = rec->usec / USEC_IN_SEC;
+
+	slurm_make_time_str(&t, time_str, sizeof(time_str));
+	printf("%s.%06"PRIu64" %-10s ", time_str, (rec->usec % USEC_IN_SEC),
+	       ((rec->event < TRACE_EVENT_CNT) ?
+		event_names[rec->event] : "unknown"));
+
+	switch (rec->event) {
+	case TRACE_EVENT_RPC_RECV:
+		printf("%s uid=%u", rpc_num2string(rec->a), rec->b);
+		break;
+	case TRACE_EVENT_RPC_DONE:
+		printf("%s uid=%u usec=%"PRIu64,
+		       rpc_num2string(rec->a), rec->b, rec->c);
+		break;
+	case TRACE_EVENT_LOCK:
+		_print_locks(rec->a);
+		printf(" wait_usec=%"PRIu64, rec->c);
+		break;
+	case TRACE_EVENT_UNLOCK:
+		_print_locks(rec->a);
+		printf(" hold_usec=%"PRIu64, rec->c);
+		break;
+	case TRACE_EVENT_JOB_STATE:
+		printf("JobId=%u %s->%s", rec->a, job_state_string(rec->b),
+		       job_state_string(rec->c));
+		break;
+	case TRACE_EVENT_AGENT_SEND:
+		printf("%s nodes=%u", rpc_num2string(rec->a), rec->b);
+		break;
+	default:
+		printf("a=%u b=%u c=%"PRIu64, rec->a, rec->b, rec->c);
+		break;
+	}
+	printf("\n");
+}
+
+extern int trace_ring_print(const char *path)
+{
+	trace_ring_hdr_t *hdr;
+	trace_ring_rec_t *file_recs;
+	struct stat st;
+	uint64_t head, first;
+	int fd, rc = SLURM_SUCCESS;
+
+	if ((fd = open(path, (O_RDONLY | O_CLOEXEC))) < 0)
+		return errno;
+
+	if (fstat(fd, &st)) {
+		rc = errno;
+		close(fd);
+		return rc;
+	}
+	if (st.st_size < sizeof(*hdr)) {
+		close(fd);
+		return EINVAL;
+	}
+
+	hdr = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	rc = errno;
+	close(fd);
+	if (hdr == MAP_FAILED)
+		return rc;
+	rc = SLURM_SUCCESS;
+
+	if ((hdr->magic != TRACE_RING_MAGIC) ||
+	    (hdr->version != TRACE_RING_VERSION) ||
+	    (hdr->rec_size != sizeof(trace_ring_rec_t)) ||
+	    !hdr->rec_cnt || (hdr->rec_cnt & (hdr->rec_cnt - 1)) ||
+	    (st.st_size < _ring_size(hdr->rec_cnt))) {
+		rc = EINVAL;
+		goto fini;
+	}
+
+	file_recs = (trace_ring_rec_t *) (hdr + 1);
+	head = __atomic_load_n(&hdr->head, __ATOMIC_ACQUIRE);
+	first = (head > hdr->rec_cnt) ? (head - hdr->rec_cnt) : 0;
+
+	printf("Trace ring of pid %u with %u records, %"PRIu64" events recorded\n",
+	       hdr->pid, hdr->rec_cnt, head);
+
+	for (uint64_t idx = first; idx < head; idx++) {
+		trace_ring_rec_t *src = &file_recs[idx & (hdr->rec_cnt - 1)];
+		trace_ring_rec_t rec;
+
+		/* Skip records being written or already overwritten */
+		if (__atomic_load_n(&src->seq, __ATOMIC_ACQUIRE) !=
+		    (uint32_t) (idx + 1))
+			continue;
+		memcpy(&rec, src, sizeof(rec));
+		__atomic_thread_fence(__ATOMIC_ACQUIRE);
+		if (__atomic_load_n(&src->seq, __ATOMIC_RELAXED) != rec.seq)
+			continue;
+
+		_print_rec(&rec);
+	}
+
+fini:
+	munmap(hdr, st.st_size);
+	return rc;
+}
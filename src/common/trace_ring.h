@@ -0,0 +1,81 @@
+/*****************************************************************************\
+ *  trace_ring.h - always-on binary ring of trace events
+ *****************************************************************************
+ *  Copyright (C) SchedMD LLC.
+ *
+ *  This file is part of Slurm, a resource management program.
+ *  For details, see <https://slurm.schedmd.com/>.
+ *  Please also read the included file: DISCLAIMER.
+ *
+ *  Slurm is free software; you can redistribute it and/or modify it under
+ *  the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the License, or (at your option)
+ *  any later version.
+ *
+ *  In addition, as a special exception, the copyright holders give permission
+ *  to link the code of portions of this program with the OpenSSL library under
+ *  certain conditions as described in each individual source file, and
+ *  distribute linked combinations including the two. You must obey the GNU
+ *  General Public License in all respects for all of the code used other than
+ *  OpenSSL. If you modify file(s) with this exception, you may extend this
+ *  exception to your version of the file(s), but you are not obligated to do
+ *  so. If you do not wish to do so, delete this exception statement from your
+ *  version.  If you delete this exception statement from all source files in
+ *  the program, then also delete it here.
+ *
+ *  Slurm is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with Slurm; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA.
+\*****************************************************************************/
+
+#ifndef _TRACE_RING_H
+#define _TRACE_RING_H
+
+#include <inttypes.h>
+
+/*
+ * Fixed size binary trace records written to a memory mapped ring by
+ * slurmctld. Writers never block or allocate: a record is claimed with one
+ * atomic increment and filled in place. When the ring is backed by a file the
+ * kernel keeps the pages after the daemon dies, so the most recent events are
+ * available for post-mortem analysis with "sdiag --trace-ring".
+ */
+
+typedef enum {
+	TRACE_EVENT_NONE = 0,
+	TRACE_EVENT_RPC_RECV,	/* a=msg_type, b=uid */
+	TRACE_EVENT_RPC_DONE,	/* a=msg_type, b=uid, c=usec */
+	TRACE_EVENT_LOCK,	/* a=lock levels, c=wait usec */
+	TRACE_EVENT_UNLOCK,	/* a=lock levels, c=hold usec */
+	TRACE_EVENT_JOB_STATE,	/* a=job_id, b=old state, c=new state */
+	TRACE_EVENT_AGENT_SEND,	/* a=msg_type, b=node count */
+	TRACE_EVENT_CNT
+} trace_event_t;
+
+/*
+ * Map a ring of at least rec_cnt records
+ * IN path - file to back the ring with or NULL for anonymous memory. Falls
+ *	back to anonymous memory if the file can not be mapped.
+ * IN rec_cnt - number of records, rounded up to a power of 2. 0 disables.
+ */
+extern void trace_ring_init(const char *path, uint32_t rec_cnt);
+
+/* Stop recording events */
+extern void trace_ring_fini(void);
+
+/* Append an event to the ring, no-op if trace_ring_init() was not called */
+extern void trace_ring_record(trace_event_t event, uint32_t a, uint32_t b,
+			      uint64_t c);
+
+/*
+ * Print the events of a ring file from oldest to newest to stdout
+ * RET SLURM_SUCCESS or errno
+ */
+extern int trace_ring_print(const char *path);
+
+#endif
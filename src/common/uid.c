@@ -61,9 +61,16 @@ typedef struct {
     char *username;
 } uid_cache_entry_t;
 
+typedef struct {
+    gid_t gid;
+    char *groupname;
+} gid_cache_entry_t;
+
 static pthread_mutex_t uid_lock = PTHREAD_MUTEX_INITIALIZER;
 static uid_cache_entry_t *uid_cache = NULL;
 static int uid_cache_used = 0;
+static gid_cache_entry_t *gid_cache = NULL;
+static int gid_cache_used = 0;
 
 extern void slurm_getpwuid_r(uid_t uid, struct passwd *pwd, char **curr_buf,
 			     char **buf_malloc, size_t *bufsize,
@@ -213,6 +220,10 @@ extern void uid_cache_clear(void)
 		xfree(uid_cache[i].username);
 	xfree(uid_cache);
 	uid_cache_used = 0;
+	for (i = 0; i < gid_cache_used; i++)
+		xfree(gid_cache[i].groupname);
+	xfree(gid_cache);
+	gid_cache_used = 0;
 	slurm_mutex_unlock(&uid_lock);
 }
 
@@ -406,6 +417,33 @@ extern char *gid_to_string(gid_t gid)
 	return result;
 }
 
+extern char *gid_to_string_cached(gid_t gid)
+{
+	gid_cache_entry_t *entry;
+	gid_cache_entry_t target = {gid, NULL};
+
+	slurm_mutex_lock(&uid_lock);
+	/*
+	 * bsearch and qsort depend on the first field of gid_cache_entry
+	 * being a 32 bit integer gid
+	 */
+	entry = bsearch(&target, gid_cache, gid_cache_used,
+			sizeof(gid_cache_entry_t), slurm_sort_uint32_list_asc);
+	if (entry == NULL) {
+		gid_cache_entry_t new_entry = {gid, gid_to_string(gid)};
+		gid_cache_used++;
+		gid_cache = xrealloc(gid_cache,
+				     sizeof(gid_cache_entry_t)*gid_cache_used);
+		gid_cache[gid_cache_used-1] = new_entry;
+		qsort(gid_cache, gid_cache_used, sizeof(gid_cache_entry_t),
+		      slurm_sort_uint32_list_asc);
+		slurm_mutex_unlock(&uid_lock);
+		return new_entry.groupname;
+	}
+	slurm_mutex_unlock(&uid_lock);
+	return entry->groupname;
+}
+
 /*
  * Return an xmalloc'd string, or null on error.
  * Caller must xfree() eventually.
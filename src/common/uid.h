@@ -97,7 +97,8 @@ extern char *uid_to_string_or_null(uid_t uid);
  */
 extern char *uid_to_string(uid_t uid);
 
-/* Free any memory allocated by uid_to_string_cached() */
+/* Free any memory allocated by uid_to_string_cached() and
+ * gid_to_string_cached() */
 extern void uid_cache_clear(void);
 
 /*
@@ -125,6 +126,12 @@ extern char *uid_to_shell(uid_t uid);
  */
 extern char *gid_to_string(gid_t gid);
 
+/*
+ * Translate gid to group name, using a cache.
+ * Call uid_cache_clear() to free memory.
+ */
+extern char *gid_to_string_cached(gid_t gid);
+
 /*
  * Translate gid to user name.
  * Will return NULL on error.
@@ -52,13 +52,21 @@
 
 #include "src/common/read_config.h"
 #include "src/common/run_in_daemon.h"
+#include "src/common/slurm_protocol_util.h"
 #include "src/common/strlcpy.h"
 #include "src/common/util-net.h"
 #include "src/common/macros.h"
 #include "src/common/xassert.h"
+#include "src/common/xhash.h"
 #include "src/common/xmalloc.h"
 #include "src/common/xstring.h"
 
+/* max seconds to remember that a host could not be resolved */
+#define ADDR_NEGATIVE_CACHE_TIME 5
+
+/* refresh entries used during the last 1/ADDR_REFRESH_FRACTION of timeout */
+#define ADDR_REFRESH_FRACTION 4
+
 static pthread_mutex_t hostentLock = PTHREAD_MUTEX_INITIALIZER;
 static pthread_mutex_t getnameinfo_cache_lock = PTHREAD_MUTEX_INITIALIZER;
 
@@ -72,6 +80,23 @@ typedef struct {
 
 static list_t *nameinfo_cache = NULL;
 
+typedef struct {
+	char *host;
+	slurm_addr_t addr; /* AF_UNSPEC if host could not be resolved */
+	time_t expiration;
+	bool refresh_queued; /* atomic as it is set under the read lock */
+} getaddrinfo_cache_t;
+
+/* Entries are never modified once inserted, only replaced or removed */
+static pthread_rwlock_t addrinfo_cache_lock = PTHREAD_RWLOCK_INITIALIZER;
+static xhash_t *addrinfo_cache = NULL;
+
+static pthread_mutex_t addr_refresh_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t addr_refresh_cond = PTHREAD_COND_INITIALIZER;
+static list_t *addr_refresh_list = NULL; /* list of char * hosts */
+static pthread_t addr_refresh_tid = 0;
+static bool addr_refresh_shutdown = false;
+
 
 static int copy_hostent(const struct hostent *src, char *dst, int len);
 #ifndef NDEBUG
@@ -446,3 +471,207 @@ extern char *xgetnameinfo(struct sockaddr *addr, socklen_t addrlen)
 
 	return name;
 }
+
+static void _getaddrinfo_cache_destroy(void *obj)
+{
+	getaddrinfo_cache_t *entry = obj;
+
+	xfree(entry->host);
+	xfree(entry);
+}
+
+static void _getaddrinfo_cache_id(void *item, const char **key,
+				  uint32_t *key_len)
+{
+	getaddrinfo_cache_t *entry = item;
+
+	*key = entry->host;
+	*key_len = strlen(entry->host);
+}
+
+extern void getaddrinfo_cache_purge(void)
+{
+	slurm_mutex_lock(&addr_refresh_mutex);
+	addr_refresh_shutdown = true;
+	slurm_cond_broadcast(&addr_refresh_cond);
+	slurm_mutex_unlock(&addr_refresh_mutex);
+
+	slurm_thread_join(addr_refresh_tid);
+
+	slurm_mutex_lock(&addr_refresh_mutex);
+	FREE_NULL_LIST(addr_refresh_list);
+	addr_refresh_shutdown = false;
+	slurm_mutex_unlock(&addr_refresh_mutex);
+
+	slurm_rwlock_wrlock(&addrinfo_cache_lock);
+	xhash_free_ptr(&addrinfo_cache);
+	slurm_rwlock_unlock(&addrinfo_cache_lock);
+}
+
+/*
+ * Resolve host into a new cache entry. Failures give a negative entry.
+ * WARNING: blocks on the resolver, never call with addrinfo_cache_lock held.
+ */
+static getaddrinfo_cache_t *_getaddrinfo_fetch(const char *host)
+{
+	getaddrinfo_cache_t *entry = xmalloc(sizeof(*entry));
+	struct addrinfo *ai;
+
+	entry->host = xstrdup(host);
+
+	if (!(ai = xgetaddrinfo(host, NULL))) {
+		entry->addr.ss_family = AF_UNSPEC;
+		entry->expiration = time(NULL) +
+			MIN(slurm_conf.getaddrinfo_cache_timeout,
+			    ADDR_NEGATIVE_CACHE_TIME);
+		return entry;
+	}
+
+	memcpy(&entry->addr, ai->ai_addr, ai->ai_addrlen);
+	entry->expiration = time(NULL) + slurm_conf.getaddrinfo_cache_timeout;
+	freeaddrinfo(ai);
+
+	return entry;
+}
+
+/* Insert entry into the cache, replacing any older entry for the host */
+static void _getaddrinfo_store(getaddrinfo_cache_t *entry)
+{
+	getaddrinfo_cache_t *old;
+
+	slurm_rwlock_wrlock(&addrinfo_cache_lock);
+	if (!addrinfo_cache)
+		addrinfo_cache = xhash_init(_getaddrinfo_cache_id,
+					    _getaddrinfo_cache_destroy);
+	if ((old = xhash_pop(addrinfo_cache, entry->host,
+			     strlen(entry->host))))
+		_getaddrinfo_cache_destroy(old);
+	xhash_add(addrinfo_cache, entry);
+	slurm_rwlock_unlock(&addrinfo_cache_lock);
+}
+
+static void _getaddrinfo_purge_expired(void *x, void *arg)
+{
+	getaddrinfo_cache_t *entry = x;
+	time_t *now = arg;
+
+	if (entry->expiration < *now)
+		xhash_delete(addrinfo_cache, entry->host, strlen(entry->host));
+}
+
+static void *_addr_refresh_thread(void *arg)
+{
+	struct timespec ts = { 0 };
+
+	slurm_mutex_lock(&addr_refresh_mutex);
+	while (!addr_refresh_shutdown) {
+		getaddrinfo_cache_t *entry;
+		char *host;
+
+		if (!(host = list_pop(addr_refresh_list))) {
+			time_t now = time(NULL);
+
+			if (ts.tv_sec <= now) {
+				slurm_mutex_unlock(&addr_refresh_mutex);
+				slurm_rwlock_wrlock(&addrinfo_cache_lock);
+				if (addrinfo_cache)
+					xhash_walk(addrinfo_cache,
+						   _getaddrinfo_purge_expired,
+						   &now);
+				slurm_rwlock_unlock(&addrinfo_cache_lock);
+				slurm_mutex_lock(&addr_refresh_mutex);
+				ts.tv_sec = now +
+					slurm_conf.getaddrinfo_cache_timeout;
+			}
+			slurm_cond_timedwait(&addr_refresh_cond,
+					     &addr_refresh_mutex, &ts);
+			continue;
+		}
+		slurm_mutex_unlock(&addr_refresh_mutex);
+
+		log_flag(NET, "%s: refreshing %s", __func__, host);
+
+		/*
+		 * Keep the current entry on failure instead of replacing it
+		 * with a negative entry. It will be resolved again by the next
+		 * lookup once it expires.
+		 */
+		entry = _getaddrinfo_fetch(host);
+		if (entry->addr.ss_family != AF_UNSPEC)
+			_getaddrinfo_store(entry);
+		else
+			_getaddrinfo_cache_destroy(entry);
+		xfree(host);
+
+		slurm_mutex_lock(&addr_refresh_mutex);
+	}
+	slurm_mutex_unlock(&addr_refresh_mutex);
+
+	return NULL;
+}
+
+/* Queue entry for a background refresh. Caller must hold the cache lock. */
+static void _getaddrinfo_queue_refresh(getaddrinfo_cache_t *entry)
+{
+	if (__atomic_exchange_n(&entry->refresh_queued, true, __ATOMIC_SEQ_CST))
+		return;
+
+	slurm_mutex_lock(&addr_refresh_mutex);
+	if (addr_refresh_shutdown) {
+		slurm_mutex_unlock(&addr_refresh_mutex);
+		return;
+	}
+	if (!addr_refresh_list)
+		addr_refresh_list = list_create(xfree_ptr);
+	list_append(addr_refresh_list, xstrdup(entry->host));
+	if (!addr_refresh_tid)
+		slurm_thread_create(&addr_refresh_tid, _addr_refresh_thread,
+				    NULL);
+	slurm_cond_signal(&addr_refresh_cond);
+	slurm_mutex_unlock(&addr_refresh_mutex);
+}
+
+extern int xgetaddr_cached(const char *host, uint16_t port,
+			   slurm_addr_t *addr)
+{
+	getaddrinfo_cache_t *entry = NULL;
+	time_t now = time(NULL);
+	int rc;
+
+	xassert(host);
+	xassert(addr);
+
+	slurm_rwlock_rdlock(&addrinfo_cache_lock);
+	if (addrinfo_cache)
+		entry = xhash_get(addrinfo_cache, host, strlen(host));
+
+	if (entry && (entry->expiration > now)) {
+		*addr = entry->addr;
+
+		if ((addr->ss_family != AF_UNSPEC) &&
+		    ((entry->expiration - now) <=
+		     (slurm_conf.getaddrinfo_cache_timeout /
+		      ADDR_REFRESH_FRACTION)))
+			_getaddrinfo_queue_refresh(entry);
+		slurm_rwlock_unlock(&addrinfo_cache_lock);
+
+		log_flag(NET, "%s: %s = %pA (cached)", __func__, host, addr);
+	} else {
+		slurm_rwlock_unlock(&addrinfo_cache_lock);
+
+		entry = _getaddrinfo_fetch(host);
+		*addr = entry->addr;
+		log_flag(NET, "%s: Adding to cache - %s = %pA",
+			 __func__, host, addr);
+		_getaddrinfo_store(entry);
+	}
+
+	if (addr->ss_family == AF_UNSPEC) {
+		rc = SLURM_ERROR;
+	} else {
+		slurm_set_port(addr, port);
+		rc = SLURM_SUCCESS;
+	}
+
+	return rc;
+}
@@ -44,6 +44,8 @@
 #include <netinet/in.h>
 #include <unistd.h>
 
+#include "slurm/slurm.h"
+
 struct hostent * get_host_by_name(const char *name,
     void *buf, int buflen, int *h_err);
 /*
@@ -87,8 +89,24 @@ extern struct addrinfo *xgetaddrinfo_port(const char *hostname,
 					  uint16_t port);
 extern char *xgetnameinfo(struct sockaddr *addr, socklen_t addrlen);
 
+/*
+ * Resolve hostname to the first address from xgetaddrinfo() through a process
+ * wide cache. Entries live for getaddrinfo_cache_timeout seconds and are
+ * refreshed in the background when used close to expiring. Hosts that fail to
+ * resolve are remembered for a few seconds.
+ * IN hostname - host to resolve (not NULL)
+ * IN port - port to set in addr
+ * OUT addr - resolved address
+ * RET SLURM_SUCCESS or SLURM_ERROR if hostname could not be resolved
+ */
+extern int xgetaddr_cached(const char *hostname, uint16_t port,
+			   slurm_addr_t *addr);
+
 /* Functions responsible for cleanup of getnameinfo cache */
 extern void getnameinfo_cache_destroy(void *obj);
 extern void getnameinfo_cache_purge(void);
 
+/* Stop the refresh thread and free the getaddrinfo cache */
+extern void getaddrinfo_cache_purge(void);
+
 #endif /* !_UTIL_NET_H */
@@ -51,7 +51,7 @@
 static char *_build_label(int task_id, int task_id_width,
 			  uint32_t het_job_offset,
 			  uint32_t het_job_task_offset);
-static int _write_line(int fd, char *prefix, char *suffix, void *buf, int len);
+static int _write_line(int fd, void *buf, int len);
 
 /*
  * fd             is the file descriptor to write to
@@ -78,48 +78,55 @@ extern int write_labelled_message(int fd, void *buf, int len, int task_id,
 				  bool label, int task_id_width)
 {
 	void *start, *end;
-	char *prefix = NULL, *suffix = NULL;
+	char *prefix = NULL, *out = NULL;
 	int remaining = len;
-	int written = 0;
-	int line_len;
+	int written = 0, out_len = 0;
+	int line_len, pre, lines = 1;
 	int rc = -1;
 
-	if (label) {
-		prefix = _build_label(task_id, task_id_width, het_job_offset,
-				      het_job_task_offset);
-	}
+	if (len <= 0)
+		return -1;
+
+	/* Without labels the message is written as is, in one write */
+	if (!label)
+		return _write_line(fd, buf, len);
+
+	prefix = _build_label(task_id, task_id_width, het_job_offset,
+			      het_job_task_offset);
+	pre = strlen(prefix);
+
+	/*
+	 * Build the labelled lines in one buffer so the whole message is
+	 * written with a single write rather than one per line.
+	 */
+	for (start = buf; (end = memchr(start, '\n', (buf + len - start)));
+	     start = end + 1)
+		lines++;
+	out = xmalloc(len + (lines * (pre + 1)));
 
 	while (remaining > 0) {
 		start = buf + written;
 		end = memchr(start, '\n', remaining);
-		if (end == NULL) { /* no newline found */
-			if (label)
-				suffix = "\n";
-			rc = _write_line(fd, prefix, suffix, start, remaining);
-			if (rc <= 0) {
-				goto done;
-			} else {
-				remaining -= rc;
-				written += rc;
-			}
-		} else {
+		if (end == NULL) /* no newline found */
+			line_len = remaining;
+		else
 			line_len = (int)(end - start) + 1;
-			rc = _write_line(fd, prefix, suffix, start, line_len);
-			if (rc <= 0) {
-				goto done;
-			} else {
-				remaining -= rc;
-				written += rc;
-			}
-		}
-
+		memcpy(out + out_len, prefix, pre);
+		out_len += pre;
+		memcpy(out + out_len, start, line_len);
+		out_len += line_len;
+		if (end == NULL)
+			out[out_len++] = '\n';
+		remaining -= line_len;
+		written += line_len;
 	}
-done:
+
+	if ((rc = _write_line(fd, out, out_len)) > 0)
+		rc = written;
+
+	xfree(out);
 	xfree(prefix);
-	if (written > 0)
-		return written;
-	else
-		return rc;
+	return rc;
 }
 
 /*
@@ -153,28 +160,10 @@ static char *_build_label(int task_id, int task_id_width,
  * buffer before issuing write to avoid interleaved output from multiple
  * components.
  */
-static int _write_line(int fd, char *prefix, char *suffix, void *buf, int len)
+static int _write_line(int fd, void *buf, int len)
 {
-	int left, n, pre = 0, post = 0;
-	void *ptr, *tmp = NULL;
-
-	if (prefix || suffix) {
-		if (prefix)
-			pre = strlen(prefix);
-		if (suffix)
-			post = strlen(suffix);
-		tmp = xmalloc(pre + len + post);
-		if (prefix)
-			memcpy(tmp, prefix, pre);
-		memcpy(tmp + pre, buf, len);
-		if (suffix)
-			memcpy(tmp + pre + len, suffix, post);
-		ptr = tmp;
-		left = pre + len + post;
-	} else {
-		ptr = buf;
-		left = len;
-	}
+	int left = len, n;
+	void *ptr = buf;
 
 	while (left > 0) {
 	again:
@@ -191,7 +180,5 @@ static int _write_line(int fd, char *prefix, char *suffix, void *buf, int len)
 		left -= n;
 		ptr += n;
 	}
-	xfree(tmp);
-
 	return len;
 }
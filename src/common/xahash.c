@@ -69,8 +69,31 @@
  *
  * Hash collisions are slow and break the O(1) design and should be avoided.
  *
+ * Dynamic size hash table: xahash_table_t
+ * The dynamic xahash_table_t uses open addressing with linear probing. The
+ * table header and state blob are never moved so the xahash_table_t pointer
+ * stays valid while the slot arrays are reallocated as the table grows. Slot
+ * state, hashes and entry blobs are kept in separate arrays so that probing
+ * only touches the small slot and hash arrays and match_func() is only called
+ * for entries with a matching hash:
+ *
+ * |----------------------------|
+ * | hash table header          | type.dynamic.slots -> uint8_t[count]
+ * |                            | type.dynamic.hashes -> xahash_hash_t[count]
+ * |                            | type.dynamic.blobs -> entry blob[count]
+ * |----------------------------|
+ * | state blob                 | _get_state()
+ * |----------------------------|
+ *
+ * The slot count is always a power of 2 and the table is doubled before more
+ * than 3/4 of the slots are in use (including released slots that still need
+ * to be probed over), keeping the average probe short with no xmalloc() per
+ * entry.
+ *
  */
 
+#include <string.h>
+
 #include "src/common/log.h"
 #include "src/common/macros.h"
 #include "src/common/read_config.h"
@@ -113,6 +136,15 @@ typedef struct {
 		struct {
 			size_t count;
 		} fixed;
+		struct {
+			size_t count; /* number of slots, always power of 2 */
+			size_t used; /* slots with DSLOT_SET */
+			size_t released; /* slots with DSLOT_RELEASED */
+			int shift; /* hash bits to drop to get slot index */
+			uint8_t *slots; /* dslot_state_t for each slot */
+			xahash_hash_t *hashes; /* hash for each set slot */
+			void *blobs; /* entry blob for each slot */
+		} dynamic;
 	} type;
 } xahash_table_header_t;
 
@@ -123,6 +155,18 @@ typedef enum {
 	FENTRY_FLAG_INVALID_MAX
 } fentry_flags_t;
 
+/* Dynamic table slot state */
+typedef enum {
+	DSLOT_EMPTY = 0, /* never used: ends probing */
+	DSLOT_SET, /* entry is populated */
+	DSLOT_RELEASED, /* entry was released: continue probing */
+} dslot_state_t;
+
+/* Initial number of slots in dynamic table */
+#define DYNAMIC_MIN_COUNT 16
+/* Knuth's multiplicative hash constant to spread poorly distributed hashes */
+#define DYNAMIC_HASH_MULT 0x9e3779b9U
+
 /* Fixed size entry struct */
 typedef struct fentry_header_s fentry_header_t;
 struct fentry_header_s {
@@ -164,6 +208,14 @@ static bool _is_fixed(const xahash_table_t *ht,
 	return ((hth->flags & HT_FLAG_STATE_MASK) == HT_FLAG_FIXED_SIZE);
 }
 
+static bool _is_dynamic(const xahash_table_t *ht,
+			const xahash_table_header_t *hth)
+{
+	_check_magic(ht);
+
+	return ((hth->flags & HT_FLAG_STATE_MASK) == HT_FLAG_DYNAMIC_SIZE);
+}
+
 static int _fixed_hash_to_index(const xahash_table_t *ht,
 				const xahash_table_header_t *hth,
 				const xahash_hash_t hash)
@@ -353,6 +405,166 @@ static xahash_table_t *_new_fixed_table(xahash_func_t hash_func,
 	return ht;
 }
 
+static void _alloc_dynamic_slots(xahash_table_header_t *hth, size_t count)
+{
+	int bits = 0;
+
+	xassert(count && !(count & (count - 1)));
+
+	while (((size_t) 1 << bits) < count)
+		bits++;
+
+	hth->type.dynamic.count = count;
+	hth->type.dynamic.used = 0;
+	hth->type.dynamic.released = 0;
+	hth->type.dynamic.shift = (sizeof(xahash_hash_t) * 8) - bits;
+	hth->type.dynamic.slots = xcalloc(count, sizeof(uint8_t));
+	hth->type.dynamic.hashes = xcalloc(count, sizeof(xahash_hash_t));
+	hth->type.dynamic.blobs = xmalloc_nz(count * hth->bytes_per_entry_blob);
+}
+
+static void *_get_dslot_blob(const xahash_table_header_t *hth,
+			     const size_t index)
+{
+	xassert(index < hth->type.dynamic.count);
+
+	return hth->type.dynamic.blobs + (index * hth->bytes_per_entry_blob);
+}
+
+static size_t _dynamic_hash_to_index(const xahash_table_header_t *hth,
+				     const xahash_hash_t hash)
+{
+	/* Avoid undefined shift by type width on a single slot table */
+	if (hth->type.dynamic.shift >= (sizeof(xahash_hash_t) * 8))
+		return 0;
+
+	return ((xahash_hash_t) (hash * DYNAMIC_HASH_MULT)) >>
+		hth->type.dynamic.shift;
+}
+
+/* Move every set entry into new slot arrays of count slots */
+static void _resize_dynamic_table(xahash_table_t *ht,
+				  xahash_table_header_t *hth, size_t count)
+{
+	const size_t old_count = hth->type.dynamic.count;
+	const size_t mask = count - 1;
+	uint8_t *old_slots = hth->type.dynamic.slots;
+	xahash_hash_t *old_hashes = hth->type.dynamic.hashes;
+	void *old_blobs = hth->type.dynamic.blobs;
+
+	log_flag(DATA, "%s: [hashtable@0x%"PRIxPTR"] resizing from %zu slots with %zu entries and %zu released to %zu slots",
+		 __func__, (uintptr_t) ht, old_count, hth->type.dynamic.used,
+		 hth->type.dynamic.released, count);
+
+	_alloc_dynamic_slots(hth, count);
+
+	for (size_t i = 0; i < old_count; i++) {
+		size_t index;
+
+		if (old_slots[i] != DSLOT_SET)
+			continue;
+
+		index = _dynamic_hash_to_index(hth, old_hashes[i]);
+		while (hth->type.dynamic.slots[index] != DSLOT_EMPTY)
+			index = (index + 1) & mask;
+
+		hth->type.dynamic.slots[index] = DSLOT_SET;
+		hth->type.dynamic.hashes[index] = old_hashes[i];
+		memcpy(_get_dslot_blob(hth, index),
+		       (old_blobs + (i * hth->bytes_per_entry_blob)),
+		       hth->bytes_per_entry_blob);
+		hth->type.dynamic.used++;
+	}
+
+	xfree(old_slots);
+	xfree(old_hashes);
+	xfree(old_blobs);
+}
+
+/*
+ * Probe for key in dynamic table
+ * IN/OUT free_ptr - if not NULL and key not found, populated with the index
+ *	of the first slot usable for inserting key
+ * RET index of slot matching key or -1 if not found
+ */
+static ssize_t _find_dynamic_index(const xahash_table_t *ht,
+				   const xahash_table_header_t *hth,
+				   const xahash_hash_t hash, const void *key,
+				   const size_t key_bytes, ssize_t *free_ptr)
+{
+	const size_t mask = hth->type.dynamic.count - 1;
+	size_t index = _dynamic_hash_to_index(hth, hash);
+	ssize_t first_free = -1;
+
+	/* A slot is always DSLOT_EMPTY as the table is never full */
+	while (true) {
+		switch (hth->type.dynamic.slots[index]) {
+		case DSLOT_EMPTY:
+			if (free_ptr)
+				*free_ptr = ((first_free >= 0) ? first_free :
+					     index);
+			return -1;
+		case DSLOT_RELEASED:
+			if (first_free < 0)
+				first_free = index;
+			break;
+		case DSLOT_SET:
+			if ((hth->type.dynamic.hashes[index] == hash) &&
+			    hth->match_func(_get_dslot_blob(hth, index), key,
+					    key_bytes, _get_state(ht)))
+				return index;
+			break;
+		}
+
+		index = (index + 1) & mask;
+	}
+}
+
+static xahash_table_t *_new_dynamic_table(xahash_func_t hash_func,
+					  const char *hash_func_string,
+					  xahash_match_func_t match_func,
+					  const char *match_func_string,
+					  xahash_on_insert_func_t on_insert_func,
+					  const char *on_insert_func_string,
+					  xahash_on_free_func_t on_free_func,
+					  const char *on_free_func_string,
+					  const size_t state_bytes,
+					  const size_t bytes_per_entry)
+{
+	xahash_table_t *ht;
+	xahash_table_header_t *hth;
+
+	xassert(bytes_per_entry > 0);
+
+	log_flag(DATA, "%s: initializing dynamic xahash_table_t with %zu bytes per entry and %zu state bytes. Callbacks: hash_func=%s()@0x%"PRIxPTR" match_func=%s()@0x%"PRIxPTR" on_insert_func=%s()@0x%"PRIxPTR" on_free_func=%s()@0x%"PRIxPTR,
+		__func__, bytes_per_entry, state_bytes, hash_func_string,
+		(uintptr_t) hash_func, match_func_string,
+		(uintptr_t) match_func, on_insert_func_string,
+		(uintptr_t) on_insert_func, on_free_func_string,
+		(uintptr_t) on_free_func);
+
+	hth = ht = xmalloc_nz(sizeof(*hth) + state_bytes);
+	*hth = (xahash_table_header_t){
+		ONLY_DEBUG(.magic = HASH_TABLE_MAGIC,)
+		.flags = HT_FLAG_DYNAMIC_SIZE,
+		.hash_func = hash_func,
+		.match_func = match_func,
+		.match_func_string = match_func_string,
+		.on_insert_func = on_insert_func,
+		.on_insert_func_string = on_insert_func_string,
+		.on_free_func = on_free_func,
+		.on_free_func_string = on_free_func_string,
+		.state_blob_bytes = state_bytes,
+		.bytes_per_entry_blob = bytes_per_entry,
+	};
+
+	_alloc_dynamic_slots(hth, DYNAMIC_MIN_COUNT);
+
+	ONLY_DEBUG(memset(_get_state(ht), 0, state_bytes));
+
+	return ht;
+}
+
 extern xahash_table_t *xahash_new_table_funcname(
 	xahash_func_t hash_func, const char *hash_func_string,
 	xahash_match_func_t match_func, const char *match_func_string,
@@ -368,8 +580,11 @@ extern xahash_table_t *xahash_new_table_funcname(
 					on_free_func_string, state_bytes,
 					bytes_per_entry, fixed_table_size);
 
-	/* TODO: dynamic sizing not implmented yet */
-	fatal_abort("should never execute");
+	return _new_dynamic_table(hash_func, hash_func_string, match_func,
+				  match_func_string, on_insert_func,
+				  on_insert_func_string, on_free_func,
+				  on_free_func_string, state_bytes,
+				  bytes_per_entry);
 }
 
 static void _free_fentry(xahash_table_t *ht, xahash_table_header_t *hth,
@@ -447,6 +662,21 @@ static void _free_fixed_table_members(xahash_table_t *ht,
 	}
 }
 
+static void _free_dynamic_table_members(xahash_table_t *ht,
+					xahash_table_header_t *hth)
+{
+	if (hth->on_free_func) {
+		for (size_t i = 0; i < hth->type.dynamic.count; i++)
+			if (hth->type.dynamic.slots[i] == DSLOT_SET)
+				hth->on_free_func(_get_dslot_blob(hth, i),
+						  _get_state(ht));
+	}
+
+	xfree(hth->type.dynamic.slots);
+	xfree(hth->type.dynamic.hashes);
+	xfree(hth->type.dynamic.blobs);
+}
+
 extern void xahash_free_table(xahash_table_t *ht)
 {
 	xahash_table_header_t *hth;
@@ -462,6 +692,8 @@ extern void xahash_free_table(xahash_table_t *ht)
 
 	if (_is_fixed(ht, hth))
 		_free_fixed_table_members(ht, hth);
+	else
+		_free_dynamic_table_members(ht, hth);
 
 	ONLY_DEBUG(hth->magic = ~HASH_TABLE_MAGIC);
 	xfree(ht);
@@ -571,6 +803,21 @@ static void *_find_fixed_entry_blob(const xahash_table_t *ht,
 	return _get_fentry_blob(ht, hth, fe);
 }
 
+static void *_find_dynamic_entry_blob(const xahash_table_t *ht,
+				      const xahash_table_header_t *hth,
+				      const void *key, const size_t key_bytes)
+{
+	const xahash_hash_t hash =
+		hth->hash_func(key, key_bytes, _get_state(ht));
+	ssize_t index = _find_dynamic_index(ht, hth, hash, key, key_bytes,
+					    NULL);
+
+	if (index < 0)
+		return NULL;
+
+	return _get_dslot_blob(hth, index);
+}
+
 extern void *xahash_find_entry(const xahash_table_t *ht, const void *key,
 			       const size_t key_bytes)
 {
@@ -592,6 +839,8 @@ extern void *xahash_find_entry(const xahash_table_t *ht, const void *key,
 
 	if (_is_fixed(ht, hth))
 		ptr = _find_fixed_entry_blob(ht, hth, key, key_bytes);
+	else if (_is_dynamic(ht, hth))
+		ptr = _find_dynamic_entry_blob(ht, hth, key, key_bytes);
 	else
 		fatal_abort("should never execute");
 
@@ -693,6 +942,50 @@ static void *_insert_fixed_entry(xahash_table_t *ht, xahash_table_header_t *hth,
 	return _get_fentry_blob(ht, hth, fe);
 }
 
+static void *_insert_dynamic_entry(xahash_table_t *ht,
+				   xahash_table_header_t *hth,
+				   const void *key, const size_t key_bytes)
+{
+	const xahash_hash_t hash =
+		hth->hash_func(key, key_bytes, _get_state(ht));
+	ssize_t index, free_index = -1;
+	void *blob;
+
+	if ((index = _find_dynamic_index(ht, hth, hash, key, key_bytes,
+					 &free_index)) >= 0)
+		return _get_dslot_blob(hth, index);
+
+	if (((hth->type.dynamic.used + hth->type.dynamic.released + 1) * 4) >
+	    (hth->type.dynamic.count * 3)) {
+		size_t count = hth->type.dynamic.count;
+
+		/* Only grow if released slots are not enough to make room */
+		if (((hth->type.dynamic.used + 1) * 2) > count)
+			count *= 2;
+
+		_resize_dynamic_table(ht, hth, count);
+		index = _find_dynamic_index(ht, hth, hash, key, key_bytes,
+					    &free_index);
+		xassert(index < 0);
+	}
+
+	xassert(free_index >= 0);
+
+	if (hth->type.dynamic.slots[free_index] == DSLOT_RELEASED)
+		hth->type.dynamic.released--;
+	hth->type.dynamic.slots[free_index] = DSLOT_SET;
+	hth->type.dynamic.hashes[free_index] = hash;
+	hth->type.dynamic.used++;
+
+	blob = _get_dslot_blob(hth, free_index);
+	ONLY_DEBUG(memset(blob, 0, hth->bytes_per_entry_blob));
+
+	if (hth->on_insert_func)
+		hth->on_insert_func(blob, key, key_bytes, _get_state(ht));
+
+	return blob;
+}
+
 extern void *xahash_insert_entry(xahash_table_t *ht, const void *key,
 				 const size_t key_bytes)
 {
@@ -715,8 +1008,10 @@ extern void *xahash_insert_entry(xahash_table_t *ht, const void *key,
 
 	if (_is_fixed(ht, hth))
 		ptr = _insert_fixed_entry(ht, hth, key, key_bytes);
+	else if (_is_dynamic(ht, hth))
+		ptr = _insert_dynamic_entry(ht, hth, key, key_bytes);
 	else
-	fatal_abort("should never execute");
+		fatal_abort("should never execute");
 
 	END_DEBUG_TIMER;
 
@@ -765,6 +1060,35 @@ static bool _find_and_free_fentry(xahash_table_t *ht,
 	return true;
 }
 
+static bool _find_and_free_dslot(xahash_table_t *ht,
+				 xahash_table_header_t *hth, const void *key,
+				 const size_t key_bytes)
+{
+	const xahash_hash_t hash =
+		hth->hash_func(key, key_bytes, _get_state(ht));
+	ssize_t index = _find_dynamic_index(ht, hth, hash, key, key_bytes,
+					    NULL);
+
+	if (index < 0)
+		return false;
+
+	if (hth->on_free_func)
+		hth->on_free_func(_get_dslot_blob(hth, index), _get_state(ht));
+
+	hth->type.dynamic.slots[index] = DSLOT_RELEASED;
+	hth->type.dynamic.used--;
+	hth->type.dynamic.released++;
+
+	/* Nothing left to probe over once the table is empty */
+	if (!hth->type.dynamic.used && hth->type.dynamic.released) {
+		memset(hth->type.dynamic.slots, DSLOT_EMPTY,
+		       hth->type.dynamic.count);
+		hth->type.dynamic.released = 0;
+	}
+
+	return true;
+}
+
 extern bool xahash_free_entry(xahash_table_t *ht, const void *key,
 			      const size_t key_bytes)
 {
@@ -787,6 +1111,8 @@ extern bool xahash_free_entry(xahash_table_t *ht, const void *key,
 
 	if (_is_fixed(ht, hth)) {
 		rc = _find_and_free_fentry(ht, hth, key, key_bytes);
+	} else if (_is_dynamic(ht, hth)) {
+		rc = _find_and_free_dslot(ht, hth, key, key_bytes);
 	} else {
 		fatal_abort("should never execute");
 	}
@@ -864,6 +1190,46 @@ static int _foreach_fentry(xahash_table_t *ht, xahash_table_header_t *hth,
 	return count;
 }
 
+static int _foreach_dslot(xahash_table_t *ht, xahash_table_header_t *hth,
+			  xahash_foreach_func_t callback,
+			  const char *callback_string, void *arg)
+{
+	int count = 0;
+
+	for (size_t i = 0; i < hth->type.dynamic.count; i++) {
+		xahash_foreach_control_t rc;
+
+		if (hth->type.dynamic.slots[i] != DSLOT_SET)
+			continue;
+
+		count++;
+
+		rc = callback(_get_dslot_blob(hth, i), _get_state(ht), arg);
+
+		log_flag(DATA, "%s: [hashtable@0x%"PRIxPTR"] called after %s()@0x%"PRIxPTR"=%s for slot[%zu]",
+			 __func__, (uintptr_t) ht, callback_string,
+			 (uintptr_t) callback, _foreach_control_string(rc), i);
+
+		xassert(rc > XAHASH_FOREACH_INVALID);
+		xassert(rc < XAHASH_FOREACH_INVALID_MAX);
+
+		switch (rc) {
+		case XAHASH_FOREACH_CONT:
+			/* do nothing */
+			break;
+		case XAHASH_FOREACH_STOP:
+			return count;
+		case XAHASH_FOREACH_FAIL:
+			return (count * -1);
+		case XAHASH_FOREACH_INVALID:
+		case XAHASH_FOREACH_INVALID_MAX:
+			fatal_abort("should never execute");
+		}
+	}
+
+	return count;
+}
+
 extern int xahash_foreach_entry_funcname(xahash_table_t *ht,
 					 xahash_foreach_func_t callback,
 					 const char *callback_string, void *arg)
@@ -885,6 +1251,8 @@ extern int xahash_foreach_entry_funcname(xahash_table_t *ht,
 
 	if (_is_fixed(ht, hth))
 		rc = _foreach_fentry(ht, hth, callback, callback_string, arg);
+	else if (_is_dynamic(ht, hth))
+		rc = _foreach_dslot(ht, hth, callback, callback_string, arg);
 	else
 		fatal_abort("should never execute");
 
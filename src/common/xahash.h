@@ -134,7 +134,8 @@ typedef void (*xahash_on_free_func_t)(void *entry, void *state);
  * 	hash table tracks state independently of these bytes.
  * 	Bytes are provided to avoid needing an xmalloc() per entry.
  * IN fixed_table_size - Fixed number of entries in hash table or
- *	0 for dynamic sizing (TODO: NOT IMPLEMENTED YET)
+ *	0 for dynamic sizing. Dynamic tables use open addressing and grow as
+ *	entries are inserted. Entry pointers may move on any insert.
  * RET new hash table pointer to call other xhahash_*().
  *	Must be released by calling FREE_NULL_XAHASH_TABLE().
  *
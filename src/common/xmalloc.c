@@ -42,6 +42,7 @@
 #include "config.h"
 
 #include <errno.h>
+#include <inttypes.h>
 #include <pthread.h>
 #include <stdint.h>
 #include <stdio.h>
@@ -58,6 +59,137 @@ strong_alias(xsize, slurm_xsize);
 
 #define XMALLOC_MAGIC 0x42
 
+/* Must be power of 2 */
+#define XMALLOC_SITES 4096
+
+typedef enum {
+	SITE_EMPTY = 0,
+	SITE_CLAIMED,
+	SITE_READY,
+} site_state_t;
+
+typedef struct {
+	int state; /* site_state_t */
+	const char *file;
+	int line;
+	const char *func;
+	uint64_t count;
+	uint64_t bytes;
+} xmalloc_site_t;
+
+static bool site_stats_enabled = false;
+static xmalloc_site_t *sites = NULL;
+
+/*
+ * Count allocation against call site using lock free open addressing as this
+ * is called for every allocation. file is always a __FILE__ literal and is
+ * compared by address.
+ */
+static void _track_site(const char *file, int line, const char *func,
+			size_t size)
+{
+	xmalloc_site_t *table = __atomic_load_n(&sites, __ATOMIC_ACQUIRE);
+	uint64_t hash = ((uintptr_t) file) ^ (line * 0x9e3779b97f4a7c15ULL);
+
+	if (!table)
+		return;
+
+	for (int i = 0; i < XMALLOC_SITES; i++) {
+		xmalloc_site_t *site = &table[(hash + i) & (XMALLOC_SITES - 1)];
+		int state = __atomic_load_n(&site->state, __ATOMIC_ACQUIRE);
+
+		if (state == SITE_EMPTY) {
+			if (__atomic_compare_exchange_n(&site->state, &state,
+							SITE_CLAIMED, false,
+							__ATOMIC_ACQUIRE,
+							__ATOMIC_ACQUIRE)) {
+				site->file = file;
+				site->line = line;
+				site->func = func;
+				__atomic_store_n(&site->state, SITE_READY,
+						 __ATOMIC_RELEASE);
+				state = SITE_READY;
+			}
+		}
+
+		/* A site being claimed is skipped and may get a second slot */
+		if ((state == SITE_READY) && (site->file == file) &&
+		    (site->line == line)) {
+			__atomic_add_fetch(&site->count, 1, __ATOMIC_RELAXED);
+			__atomic_add_fetch(&site->bytes, size, __ATOMIC_RELAXED);
+			return;
+		}
+	}
+}
+
+void xmalloc_site_stats(bool enable)
+{
+	if (enable && !__atomic_load_n(&sites, __ATOMIC_ACQUIRE)) {
+		/* avoid xmalloc() to not track the table itself */
+		xmalloc_site_t *table = calloc(XMALLOC_SITES, sizeof(*table));
+		xmalloc_site_t *expected = NULL;
+
+		if (!table)
+			return;
+
+		if (!__atomic_compare_exchange_n(&sites, &expected, table,
+						 false, __ATOMIC_RELEASE,
+						 __ATOMIC_RELAXED))
+			free(table);
+	}
+
+	__atomic_store_n(&site_stats_enabled, enable, __ATOMIC_RELAXED);
+}
+
+static int _cmp_site_count(const void *x, const void *y)
+{
+	const xmalloc_site_t *s1 = x, *s2 = y;
+
+	if (s1->count > s2->count)
+		return -1;
+	if (s1->count < s2->count)
+		return 1;
+	return 0;
+}
+
+void xmalloc_site_stats_log(int max)
+{
+	xmalloc_site_t *table = __atomic_load_n(&sites, __ATOMIC_ACQUIRE);
+	xmalloc_site_t *copy;
+	int count = 0;
+
+	if (!table || (max <= 0))
+		return;
+
+	if (!(copy = calloc(XMALLOC_SITES, sizeof(*copy))))
+		return;
+
+	for (int i = 0; i < XMALLOC_SITES; i++) {
+		xmalloc_site_t *site = &table[i];
+
+		if (__atomic_load_n(&site->state, __ATOMIC_ACQUIRE) !=
+		    SITE_READY)
+			continue;
+
+		copy[count] = *site;
+		copy[count].count = __atomic_exchange_n(&site->count, 0,
+							__ATOMIC_RELAXED);
+		copy[count].bytes = __atomic_exchange_n(&site->bytes, 0,
+							__ATOMIC_RELAXED);
+		if (copy[count].count)
+			count++;
+	}
+
+	qsort(copy, count, sizeof(*copy), _cmp_site_count);
+
+	for (int i = 0; (i < count) && (i < max); i++)
+		info("%s: %s:%d %s() allocations:%"PRIu64" bytes:%"PRIu64,
+		     __func__, copy[i].file, copy[i].line, copy[i].func,
+		     copy[i].count, copy[i].bytes);
+
+	free(copy);
+}
+
 /*
  * "Safe" version of malloc().
  *   size (IN)	number of bytes to malloc
@@ -93,6 +225,9 @@ void *slurm_xcalloc(size_t count, size_t size, bool clear, bool try,
 	count_size = count * size;
 	total_size = count_size + 2 * sizeof(size_t);
 
+	if (__atomic_load_n(&site_stats_enabled, __ATOMIC_RELAXED))
+		_track_site(file, line, func, count_size);
+
 	if (clear)
 		p = calloc(1, total_size);
 	else
@@ -146,6 +281,9 @@ extern void * slurm_xrecalloc(void **item, size_t count, size_t size,
 	count_size = count * size;
 	total_size = count_size + 2 * sizeof(size_t);
 
+	if (__atomic_load_n(&site_stats_enabled, __ATOMIC_RELAXED))
+		_track_site(file, line, func, count_size);
+
 	if (*item != NULL) {
 		size_t old_size;
 		p = (size_t *)*item - 2;
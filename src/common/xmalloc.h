@@ -117,4 +117,17 @@ size_t xsize(void *item);
 
 void xfree_ptr(void *);
 
+/*
+ * Enable or disable counting of allocations per xmalloc() call site.
+ * Counting is off by default and costs a single test per allocation.
+ */
+void xmalloc_site_stats(bool enable);
+
+/*
+ * Log the call sites with the most allocations since the last call and
+ * reset their counters.
+ *   max (IN)	maximum number of call sites to log
+ */
+void xmalloc_site_stats_log(int max);
+
 #endif /* !_XMALLOC_H */
@@ -0,0 +1,329 @@
+/*****************************************************************************\
+ *  buffers.c - definitions for connection buffer pool
+ *****************************************************************************
+ *  Copyright (C) SchedMD LLC.
+ *
+ *  This file is part of Slurm, a resource management program.
+ *  For details, see <https://slurm.schedmd.com/>.
+ *  Please also read the included file: DISCLAIMER.
+ *
+ *  Slurm is free software; you can redistribute it and/or modify it under
+ *  the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the License, or (at your option)
+ *  any later version.
+ *
+ *  In addition, as a special exception, the copyright holders give permission
+ *  to link the code of portions of this program with the OpenSSL library under
+ *  certain conditions as described in each individual source file, and
+ *  distribute linked combinations including the two. You must obey the GNU
+ *  General Public License in all respects for all of the code used other than
+ *  OpenSSL. If you modify file(s) with this exception, you may extend this
+ *  exception to your version of the file(s), but you are not obligated to do
+ *  so. If you do not wish to do so, delete this exception statement from your
+ *  version.  If you delete this exception statement from all source files in
+ *  the program, then also delete it here.
+ *
+ *  Slurm is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with Slurm; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA.
+\*****************************************************************************/
+
+
+#include <pthread.h>
+
+#include "src/common/log.h"
+#include "src/common/macros.h"
+#include "src/common/pack.h"
+#include "src/common/read_config.h"
+#include "src/common/xassert.h"
+#include "src/common/xmalloc.h"
+
+#include "src/conmgr/buffers.h"
+#include "src/conmgr/conmgr.h"
+
+/*
+ * Buffers are pooled in power of 2 size classes from 512 bytes to 1MiB.
+ * Larger buffers are always freed to avoid holding onto memory from a single
+ * huge RPC.
+ */
+#define MIN_CLASS_SHIFT 9
+#define MAX_CLASS_SHIFT 20
+#define CLASS_COUNT (MAX_CLASS_SHIFT - MIN_CLASS_SHIFT + 1)
+#define CLASS_BYTES(class) (1U << ((class) + MIN_CLASS_SHIFT))
+
+/* Max bytes held in the shared pool for each size class */
+#define POOL_CLASS_MAX_BYTES (8 * 1024 * 1024)
+/* Min buffers held in the shared pool for each size class */
+#define POOL_CLASS_MIN_COUNT 4
+/* Buffers held by each thread for each size class before using shared pool */
+#define THREAD_CACHE_COUNT 4
+
+typedef struct {
+#define MAGIC_THREAD_CACHE 0xD3AB12CE
+	int magic; /* MAGIC_THREAD_CACHE */
+	int count[CLASS_COUNT];
+	buf_t *bufs[CLASS_COUNT][THREAD_CACHE_COUNT];
+} thread_cache_t;
+
+static struct {
+	pthread_mutex_t mutex;
+	struct {
+		/* stack of available buffers */
+		buf_t **bufs;
+		/* number of buffers in stack */
+		int count;
+		/* max number of buffers in stack */
+		int max;
+	} classes[CLASS_COUNT];
+	/* bytes held by shared pool */
+	uint64_t bytes;
+} pool = {
+	.mutex = PTHREAD_MUTEX_INITIALIZER,
+};
+
+/* Updated atomically as thread caches are used without a lock */
+static conmgr_buffer_stats_t stats = { 0 };
+
+static pthread_key_t cache_key;
+static pthread_once_t cache_once = PTHREAD_ONCE_INIT;
+
+#define STAT_INC(field) __atomic_add_fetch(&stats.field, 1, __ATOMIC_RELAXED)
+#define STAT_GET(field) __atomic_load_n(&stats.field, __ATOMIC_RELAXED)
+
+/* Get smallest class that will hold bytes or -1 if too large */
+static int _bytes_to_class(uint32_t bytes)
+{
+	for (int class = 0; class < CLASS_COUNT; class++)
+		if (bytes <= CLASS_BYTES(class))
+			return class;
+
+	return -1;
+}
+
+/* Get largest class that fits in capacity or -1 if can not be pooled */
+static int _capacity_to_class(size_t capacity)
+{
+	if ((capacity < CLASS_BYTES(0)) ||
+	    (capacity >= (CLASS_BYTES(CLASS_COUNT - 1) * 2)))
+		return -1;
+
+	for (int class = (CLASS_COUNT - 1); class >= 0; class--)
+		if (capacity >= CLASS_BYTES(class))
+			return class;
+
+	fatal_abort("should never happen");
+}
+
+/* Attempt to add buffer to shared pool. RET true if pooled */
+static bool _pool_push(int class, buf_t *buf)
+{
+	bool pooled = false;
+
+	slurm_mutex_lock(&pool.mutex);
+
+	if (!pool.classes[class].max) {
+		pool.classes[class].max = MAX(POOL_CLASS_MIN_COUNT,
+					      (POOL_CLASS_MAX_BYTES /
+					       CLASS_BYTES(class)));
+		pool.classes[class].bufs =
+			xcalloc(pool.classes[class].max,
+				sizeof(*pool.classes[class].bufs));
+	}
+
+	if (pool.classes[class].count < pool.classes[class].max) {
+		pool.classes[class].bufs[pool.classes[class].count++] = buf;
+		pool.bytes += CLASS_BYTES(class);
+		pooled = true;
+	}
+
+	slurm_mutex_unlock(&pool.mutex);
+
+	return pooled;
+}
+
+/* Pop buffer from shared pool or NULL if none available */
+static buf_t *_pool_pop(int class)
+{
+	buf_t *buf = NULL;
+
+	slurm_mutex_lock(&pool.mutex);
+
+	if (pool.classes[class].count > 0) {
+		buf = pool.classes[class].bufs[--pool.classes[class].count];
+		pool.bytes -= CLASS_BYTES(class);
+	}
+
+	slurm_mutex_unlock(&pool.mutex);
+
+	return buf;
+}
+
+static void _release(buf_t *buf)
+{
+	STAT_INC(released);
+	free_buf(buf);
+}
+
+static void _flush_thread_cache(thread_cache_t *cache)
+{
+	xassert(cache->magic == MAGIC_THREAD_CACHE);
+
+	for (int class = 0; class < CLASS_COUNT; class++) {
+		while (cache->count[class] > 0) {
+			buf_t *buf = cache->bufs[class][--cache->count[class]];
+
+			if (!_pool_push(class, buf))
+				_release(buf);
+		}
+	}
+}
+
+static void _thread_cache_destructor(void *arg)
+{
+	thread_cache_t *cache = arg;
+
+	_flush_thread_cache(cache);
+	cache->magic = ~MAGIC_THREAD_CACHE;
+	xfree(cache);
+}
+
+static void _create_cache_key(void)
+{
+	int rc;
+
+	if ((rc = pthread_key_create(&cache_key, _thread_cache_destructor)))
+		fatal_abort("%s: pthread_key_create() failed: %s",
+			    __func__, slurm_strerror(rc));
+}
+
+static thread_cache_t *_get_thread_cache(void)
+{
+	thread_cache_t *cache = NULL;
+
+	(void) pthread_once(&cache_once, _create_cache_key);
+
+	if (!(cache = pthread_getspecific(cache_key))) {
+		int rc;
+
+		cache = xmalloc(sizeof(*cache));
+		cache->magic = MAGIC_THREAD_CACHE;
+
+		if ((rc = pthread_setspecific(cache_key, cache)))
+			fatal_abort("%s: pthread_setspecific() failed: %s",
+				    __func__, slurm_strerror(rc));
+	}
+
+	xassert(cache->magic == MAGIC_THREAD_CACHE);
+	return cache;
+}
+
+extern buf_t *buffer_pool_get(uint32_t bytes)
+{
+	const int class = _bytes_to_class(bytes);
+	thread_cache_t *cache = NULL;
+	buf_t *buf = NULL;
+
+	if (class < 0) {
+		STAT_INC(misses);
+		return init_buf(bytes);
+	}
+
+	cache = _get_thread_cache();
+
+	if (cache->count[class] > 0)
+		buf = cache->bufs[class][--cache->count[class]];
+	else
+		buf = _pool_pop(class);
+
+	if (buf) {
+		STAT_INC(hits);
+	} else {
+		STAT_INC(misses);
+		buf = init_buf(CLASS_BYTES(class));
+	}
+
+	xassert(buf->magic == BUF_MAGIC);
+	xassert(xsize(buf->head) >= bytes);
+
+	buf->size = bytes;
+	set_buf_offset(buf, 0);
+
+	return buf;
+}
+
+extern void buffer_pool_put(buf_t *buf)
+{
+	thread_cache_t *cache = NULL;
+	int class;
+
+	if (!buf)
+		return;
+
+	xassert(buf->magic == BUF_MAGIC);
+
+	if (buf->mmaped || buf->shadow || !buf->head ||
+	    ((class = _capacity_to_class(xsize(buf->head))) < 0)) {
+		_release(buf);
+		return;
+	}
+
+	cache = _get_thread_cache();
+
+	if (cache->count[class] < THREAD_CACHE_COUNT) {
+		cache->bufs[class][cache->count[class]++] = buf;
+		STAT_INC(recycled);
+	} else if (_pool_push(class, buf)) {
+		STAT_INC(recycled);
+	} else {
+		_release(buf);
+	}
+}
+
+extern void buffer_pool_fini(void)
+{
+	thread_cache_t *cache = NULL;
+
+	(void) pthread_once(&cache_once, _create_cache_key);
+
+	/* Return calling thread's buffers to be freed with the pool */
+	if ((cache = pthread_getspecific(cache_key)))
+		_flush_thread_cache(cache);
+
+	slurm_mutex_lock(&pool.mutex);
+
+	log_flag(CONMGR, "%s: buffer pool hits=%"PRIu64" misses=%"PRIu64" recycled=%"PRIu64" released=%"PRIu64" pooled_bytes=%"PRIu64,
+		 __func__, STAT_GET(hits), STAT_GET(misses), STAT_GET(recycled),
+		 STAT_GET(released), pool.bytes);
+
+	for (int class = 0; class < CLASS_COUNT; class++) {
+		for (int i = 0; i < pool.classes[class].count; i++)
+			free_buf(pool.classes[class].bufs[i]);
+
+		xfree(pool.classes[class].bufs);
+		pool.classes[class].count = 0;
+		pool.classes[class].max = 0;
+	}
+
+	pool.bytes = 0;
+
+	slurm_mutex_unlock(&pool.mutex);
+}
+
+extern void conmgr_get_buffer_stats(conmgr_buffer_stats_t *stats_ptr)
+{
+	xassert(stats_ptr);
+
+	stats_ptr->hits = STAT_GET(hits);
+	stats_ptr->misses = STAT_GET(misses);
+	stats_ptr->recycled = STAT_GET(recycled);
+	stats_ptr->released = STAT_GET(released);
+
+	slurm_mutex_lock(&pool.mutex);
+	stats_ptr->pooled_bytes = pool.bytes;
+	slurm_mutex_unlock(&pool.mutex);
+}
@@ -0,0 +1,60 @@
+/*****************************************************************************\
+ *  buffers.h - Internal declarations for connection buffer pool
+ *****************************************************************************
+ *  Copyright (C) SchedMD LLC.
+ *
+ *  This file is part of Slurm, a resource management program.
+ *  For details, see <https://slurm.schedmd.com/>.
+ *  Please also read the included file: DISCLAIMER.
+ *
+ *  Slurm is free software; you can redistribute it and/or modify it under
+ *  the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the License, or (at your option)
+ *  any later version.
+ *
+ *  In addition, as a special exception, the copyright holders give permission
+ *  to link the code of portions of this program with the OpenSSL library under
+ *  certain conditions as described in each individual source file, and
+ *  distribute linked combinations including the two. You must obey the GNU
+ *  General Public License in all respects for all of the code used other than
+ *  OpenSSL. If you modify file(s) with this exception, you may extend this
+ *  exception to your version of the file(s), but you are not obligated to do
+ *  so. If you do not wish to do so, delete this exception statement from your
+ *  version.  If you delete this exception statement from all source files in
+ *  the program, then also delete it here.
+ *
+ *  Slurm is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with Slurm; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA.
+\*****************************************************************************/
+
+
+#ifndef _CONMGR_BUFFERS_H
+#define _CONMGR_BUFFERS_H
+
+#include "src/common/pack.h"
+
+/*
+ * Get buffer from pool or allocate a new buffer if none are available
+ * IN bytes - minimum number of bytes required
+ * RET buffer with size of bytes and offset of 0 (caller must
+ *	buffer_pool_put() or free_buf())
+ */
+extern buf_t *buffer_pool_get(uint32_t bytes);
+
+/*
+ * Return buffer to pool or free it if it can not be pooled
+ * Compatible with ListDelF for use by connection output lists.
+ * IN buf - buffer to release (may be NULL)
+ */
+extern void buffer_pool_put(buf_t *buf);
+
+/* Release all pooled buffers */
+extern void buffer_pool_fini(void);
+
+#endif /* _CONMGR_BUFFERS_H */
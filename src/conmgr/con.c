@@ -66,6 +66,7 @@
 #include "src/common/xmalloc.h"
 #include "src/common/xstring.h"
 
+#include "src/conmgr/buffers.h"
 #include "src/conmgr/conmgr.h"
 #include "src/conmgr/delayed.h"
 #include "src/conmgr/mgr.h"
@@ -530,9 +531,8 @@ extern int add_connection(conmgr_con_type_t type,
 	con_assign_flag(con, FLAG_IS_CHR, is_chr);
 
 	if (!is_listen) {
-		con->in = create_buf(xmalloc(BUFFER_START_SIZE),
-				     BUFFER_START_SIZE);
-		con->out = list_create((ListDelF) free_buf);
+		con->in = buffer_pool_get(BUFFER_START_SIZE);
+		con->out = list_create((ListDelF) buffer_pool_put);
 	}
 
 	/* listen on unix socket */
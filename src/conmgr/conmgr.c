@@ -43,6 +43,7 @@
 #include "src/common/xmalloc.h"
 #include "src/common/xstring.h"
 
+#include "src/conmgr/buffers.h"
 #include "src/conmgr/conmgr.h"
 #include "src/conmgr/delayed.h"
 #include "src/conmgr/mgr.h"
@@ -197,6 +198,8 @@ extern void conmgr_fini(void)
 
 	pollctl_fini();
 
+	buffer_pool_fini();
+
 	/*
 	 * Do not destroy the mutex or cond so that this function does not
 	 * crash when it tries to lock mgr.mutex if called more than once.
@@ -343,6 +346,14 @@ extern int conmgr_set_params(const char *params)
 		} else if (!xstrcasecmp(tok, CONMGR_PARAM_POLL_ONLY)) {
 			log_flag(CONMGR, "%s: %s activated", __func__, tok);
 			pollctl_set_mode(POLL_MODE_POLL);
+		} else if (!xstrcasecmp(tok, CONMGR_PARAM_IO_URING)) {
+#ifdef HAVE_IO_URING
+			log_flag(CONMGR, "%s: %s activated", __func__, tok);
+			pollctl_set_mode(POLL_MODE_IO_URING);
+#else
+			error("%s: %s not supported: Slurm was built without io_uring support",
+			      __func__, tok);
+#endif /* HAVE_IO_URING */
 		} else if (!xstrcasecmp(tok, CONMGR_PARAM_WAIT_WRITE_DELAY)) {
 			const unsigned long count = slurm_atoul(tok +
 				strlen(CONMGR_PARAM_WAIT_WRITE_DELAY));
@@ -363,6 +374,9 @@ extern int conmgr_set_params(const char *params)
 				strlen(CONMGR_PARAM_CONNECT_TIMEOUT));
 			log_flag(CONMGR, "%s: %s activated", __func__, tok);
 			mgr.conf_connect_timeout.tv_sec = count;
+		} else if (!xstrncasecmp(tok, CONMGR_PARAM_METRICS,
+					 strlen(CONMGR_PARAM_METRICS))) {
+			/* handled by conmgr_metrics_listen() */
 		} else {
 			log_flag(CONMGR, "%s: Ignoring parameter %s",
 				 __func__, tok);
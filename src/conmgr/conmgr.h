@@ -669,6 +669,25 @@ extern bool conmgr_get_exit_on_error(void);
  */
 extern int conmgr_get_error(void);
 
+typedef struct {
+	/* buffer requests served from the pool */
+	uint64_t hits;
+	/* buffer requests that required a new allocation */
+	uint64_t misses;
+	/* buffers returned to the pool for reuse */
+	uint64_t recycled;
+	/* buffers freed instead of being returned to the pool */
+	uint64_t released;
+	/* bytes held by the shared pool (excludes per-thread caches) */
+	uint64_t pooled_bytes;
+} conmgr_buffer_stats_t;
+
+/*
+ * Get connection buffer pool statistics
+ * IN stats_ptr - pointer to populate with current stats
+ */
+extern void conmgr_get_buffer_stats(conmgr_buffer_stats_t *stats_ptr);
+
 /*
  * Get assigned connection name - stays same for life of connection
  */
@@ -808,12 +827,14 @@ extern int conmgr_queue_extract_con_fd(conmgr_fd_t *con,
 				       void *func_arg);
 
 #define CONMGR_PARAM_POLL_ONLY "CONMGR_USE_POLL"
+#define CONMGR_PARAM_IO_URING "CONMGR_USE_IO_URING"
 #define CONMGR_PARAM_THREADS "CONMGR_THREADS="
 #define CONMGR_PARAM_MAX_CONN "CONMGR_MAX_CONNECTIONS="
 #define CONMGR_PARAM_WAIT_WRITE_DELAY "CONMGR_WAIT_WRITE_DELAY="
 #define CONMGR_PARAM_READ_TIMEOUT "CONMGR_READ_TIMEOUT="
 #define CONMGR_PARAM_WRITE_TIMEOUT "CONMGR_WRITE_TIMEOUT="
 #define CONMGR_PARAM_CONNECT_TIMEOUT "CONMGR_CONNECT_TIMEOUT="
+#define CONMGR_PARAM_METRICS "CONMGR_METRICS="
 
 /*
  * Set configuration parameters to be applied when conmgr_init() is called.
@@ -823,6 +844,18 @@ extern int conmgr_queue_extract_con_fd(conmgr_fd_t *con,
  */
 extern int conmgr_set_params(const char *params);
 
+/*
+ * Serve the metrics registry (see src/common/metrics.h) in the OpenMetrics
+ * text format to HTTP GET requests for "/metrics" when params contains
+ * CONMGR_PARAM_METRICS=<host:port>. Does nothing otherwise.
+ * NOTE: the listener has no authentication, so bind it to a trusted address.
+ * IN params - CSV string with daemon parameters, as given to
+ *	conmgr_set_params()
+ * IN prefix - prepended to all metric names, e.g. "slurmctld"
+ * RET SLURM_SUCCESS or error
+ */
+extern int conmgr_metrics_listen(const char *params, const char *prefix);
+
 /*
  * Mark connection as quiesced
  * @see CON_FLAG_QUIESCE for details
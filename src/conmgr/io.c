@@ -44,6 +44,7 @@
 #include "src/common/slurm_time.h"
 #include "src/common/xmalloc.h"
 
+#include "src/conmgr/buffers.h"
 #include "src/conmgr/conmgr.h"
 #include "src/conmgr/mgr.h"
 
@@ -409,7 +410,7 @@ extern int conmgr_queue_write_data(conmgr_fd_t *con, const void *buffer,
 
 	xassert(con->magic == MAGIC_CON_MGR_FD);
 
-	buf = init_buf(bytes);
+	buf = buffer_pool_get(bytes);
 
 	/* TODO: would be nice to avoid this copy */
 	memmove(get_buf_data(buf), buffer, bytes);
@@ -0,0 +1,1114 @@
+/*****************************************************************************\
+ *  io_uring.c - Definitions for io_uring(7) polling handlers
+ *****************************************************************************
+ *  Copyright (C) SchedMD LLC.
+ *
+ *  This file is part of Slurm, a resource management program.
+ *  For details, see <https://slurm.schedmd.com/>.
+ *  Please also read the included file: DISCLAIMER.
+ *
+ *  Slurm is free software; you can redistribute it and/or modify it under
+ *  the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the License, or (at your option)
+ *  any later version.
+ *
+ *  In addition, as a special exception, the copyright holders give permission
+ *  to link the code of portions of this program with the OpenSSL library under
+ *  certain conditions as described in each individual source file, and
+ *  distribute linked combinations including the two. You must obey the GNU
+ *  General Public License in all respects for all of the code used other than
+ *  OpenSSL. If you modify file(s) with this exception, you may extend this
+ *  exception to your version of the file(s), but you are not obligated to do
+ *  so. If you do not wish to do so, delete this exception statement from your
+ *  version.  If you delete this exception statement from all source files in
+ *  the program, then also delete it here.
+ *
+ *  Slurm is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with Slurm; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA.
+\*****************************************************************************/
+
+
+#include <endian.h>
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "slurm/slurm.h"
+#include "slurm/slurm_errno.h"
+
+#include "src/common/fd.h"
+#include "src/common/log.h"
+#include "src/common/macros.h"
+#include "src/common/read_config.h"
+#include "src/common/timers.h"
+#include "src/common/xassert.h"
+#include "src/common/xmalloc.h"
+#include "src/common/xstring.h"
+
+#include "src/conmgr/polling.h"
+#include "src/conmgr/events.h"
+
+/*
+ * Readiness is monitored with multishot IORING_OP_POLL_ADD requests which
+ * report the same EPOLL* event bits as epoll_wait(). Changes to the monitored
+ * file descriptors are queued into the submission ring and are submitted in a
+ * single io_uring_enter() along with waiting for completions, instead of one
+ * epoll_ctl() per change.
+ */
+
+/*
+ * Size event count for 1 input and 1 output per connection and
+ * interrupt pipe fd. Allocated once to avoid calling
+ * xrecalloc() every time poll() is called.
+ */
+#define MAX_POLL_EVENTS(max_connections) ((max_connections * 2) + 1)
+
+/*
+ * Every relink may queue a removal and an addition while a completion may be
+ * generated for each removal and each triggered poll.
+ */
+#define MIN_RING_ENTRIES 64
+#define SQ_ENTRIES(max_connections) ((max_connections * 2) + 2)
+#define CQ_ENTRIES(sq_entries) (sq_entries * 4)
+
+/* string used for interrupt name in logging to match style of others fds */
+#define INTERRUPT_CON_NAME "interrupt"
+
+/*
+ * Need an arbitrary sized of bytes to ensure the pipe has been cleared of all
+ * bytes in a single read() even though there should only ever be 1 byte.
+ */
+#define FLUSH_BUFFER_BYTES 100
+
+/* user_data for completions of IORING_OP_POLL_REMOVE requests */
+#define USER_DATA_REMOVE 0
+#define USER_DATA(fd, token) ((((uint64_t) token) << 32) | ((uint32_t) fd))
+#define USER_DATA_FD(user_data) ((int) ((user_data) & 0xffffffff))
+#define USER_DATA_TOKEN(user_data) ((uint32_t) ((user_data) >> 32))
+
+/* Flags to be used for each type of fd */
+#define T(type, events) { type, XSTRINGIFY(type), events, XSTRINGIFY(events) }
+static const struct {
+	pollctl_fd_type_t type;
+	const char *type_string;
+	uint32_t events;
+	const char *events_string;
+} fd_types[] = {
+	T(PCTL_TYPE_INVALID, 0),
+	T(PCTL_TYPE_UNSUPPORTED, 0),
+	T(PCTL_TYPE_NONE, 0),
+	T(PCTL_TYPE_CONNECTED, (EPOLLHUP | EPOLLERR | EPOLLET)),
+	T(PCTL_TYPE_READ_ONLY, (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR |
+				EPOLLET)),
+	T(PCTL_TYPE_READ_WRITE,
+	  (EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLHUP | EPOLLERR | EPOLLET)),
+	T(PCTL_TYPE_WRITE_ONLY, (EPOLLOUT | EPOLLHUP | EPOLLERR | EPOLLET)),
+	T(PCTL_TYPE_LISTEN, (EPOLLIN | EPOLLHUP | EPOLLERR | EPOLLET)),
+	T(PCTL_TYPE_INVALID_MAX, 0),
+};
+#undef T
+
+#define T(flag) { flag, XSTRINGIFY(flag) }
+static const struct {
+	uint32_t flag;
+	const char *string;
+} epoll_events[] = {
+	T(EPOLLIN),
+	T(EPOLLOUT),
+	T(EPOLLPRI),
+	T(EPOLLERR),
+	T(EPOLLHUP),
+	T(EPOLLRDHUP),
+	T(EPOLLET),
+};
+#undef T
+
+typedef struct {
+	/* token of active poll request or 0 if fd is not linked */
+	uint32_t token;
+	/* true if multishot poll request is still active in kernel */
+	bool armed;
+	/* requested EPOLL* events */
+	uint32_t events;
+	/* index in pctl.events for last io_uring_enter() or -1 */
+	int event_index;
+} fd_state_t;
+
+typedef struct {
+	int fd;
+	uint32_t events;
+} event_t;
+
+#define PCTL_INITIALIZER \
+{ \
+	.mutex = PTHREAD_MUTEX_INITIALIZER, \
+	.poll_return = EVENT_INITIALIZER("POLL_RETURN"), \
+	.interrupt_return = EVENT_INITIALIZER("INTERRUPT_RETURN"), \
+	.ring = { \
+		.fd = -1, \
+	}, \
+	.interrupt =  { \
+		.send = -1, \
+		.receive = 1, \
+	}, \
+}
+
+static struct pctl_s {
+	pthread_mutex_t mutex;
+
+	/* Is currently initialized */
+	bool initialized;
+
+	/* event to wait on pollctl_for_each_event() to return */
+	event_signal_t poll_return;
+	/* event to wait on pollctl_interrupt() to return */
+	event_signal_t interrupt_return;
+
+	/* True if actively polling() */
+	bool polling;
+
+	struct {
+		/* file descriptor from io_uring_setup() */
+		int fd;
+
+		/* mmap()ed submission ring */
+		void *sq_ptr;
+		size_t sq_size;
+		uint32_t *sq_head;
+		uint32_t *sq_tail;
+		uint32_t *sq_flags;
+		uint32_t sq_mask;
+		uint32_t sq_entries;
+		uint32_t *sq_array;
+		struct io_uring_sqe *sqes;
+		size_t sqes_size;
+
+		/* mmap()ed completion ring */
+		void *cq_ptr;
+		size_t cq_size;
+		uint32_t *cq_head;
+		uint32_t *cq_tail;
+		uint32_t cq_mask;
+		struct io_uring_cqe *cqes;
+	} ring;
+
+	/* last token handed out */
+	uint32_t token;
+	/* state of every file descriptor indexed by fd */
+	fd_state_t *fds;
+	/* number of elements in fds array */
+	int fds_count;
+
+	/* array holding results of io_uring_enter() */
+	event_t *events;
+	/* number of elements in events array */
+	int events_count;
+	/*
+	 * Number of elements triggred in last io_uring_enter().
+	 * Only set when polling=true.
+	 */
+	int events_triggered;
+	/* number of file descriptors currently registered */
+	int fd_count;
+
+	struct {
+		/* pipe() used to break out of io_uring_enter() */
+		int send;
+		int receive;
+
+		/* number of times interrupt requested */
+		int requested;
+
+		/* if a thread currently trying to send byte */
+		bool sending;
+	} interrupt;
+} pctl = PCTL_INITIALIZER;
+
+static int _link_fd(int fd, pollctl_fd_type_t type, const char *con_name,
+		    const char *caller);
+static void _unlink_fd(int fd, const char *con_name, const char *caller);
+static void _interrupt(const char *caller);
+
+static int _io_uring_setup(uint32_t entries, struct io_uring_params *params)
+{
+	return syscall(__NR_io_uring_setup, entries, params);
+}
+
+static int _io_uring_enter(int fd, uint32_t to_submit, uint32_t min_complete,
+			   uint32_t flags)
+{
+	return syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags,
+		       NULL, 0);
+}
+
+static const char *_type_to_string(pollctl_fd_type_t type)
+{
+	for (int i = 0; i < ARRAY_SIZE(fd_types); i++)
+		if (fd_types[i].type == type)
+			return fd_types[i].type_string;
+
+	fatal_abort("should never execute");
+}
+
+static char *_epoll_events_to_string(uint32_t events)
+{
+	char *str = NULL, *at = NULL;
+	uint32_t matched = 0;
+
+	if (!events)
+		return xstrdup_printf("0");
+
+	for (int i = 0; i < ARRAY_SIZE(epoll_events); i++) {
+		if ((epoll_events[i].flag & events) == epoll_events[i].flag) {
+			xstrfmtcatat(str, &at, "%s%s", (str ? "|" : ""),
+				     epoll_events[i].string);
+			matched |= epoll_events[i].flag;
+		}
+	}
+
+	if (events ^ matched)
+		xstrfmtcatat(str, &at, "%s0x%08"PRIx32, (str ? "|" : ""),
+			     (events ^ matched));
+
+	return str;
+}
+
+static uint32_t _fd_type_to_events(pollctl_fd_type_t type)
+{
+	for (int i = 0; i < ARRAY_SIZE(fd_types); i++)
+		if (fd_types[i].type == type)
+			return fd_types[i].events;
+
+	fatal_abort("should never happen");
+}
+
+static const char *_fd_type_to_type_string(pollctl_fd_type_t type)
+{
+	for (int i = 0; i < ARRAY_SIZE(fd_types); i++)
+		if (fd_types[i].type == type)
+			return fd_types[i].type_string;
+
+	fatal_abort("should never happen");
+}
+
+static const char *_fd_type_to_events_string(pollctl_fd_type_t type)
+{
+	for (int i = 0; i < ARRAY_SIZE(fd_types); i++)
+		if (fd_types[i].type == type)
+			return fd_types[i].events_string;
+
+	fatal_abort("should never happen");
+}
+
+static void _check_pctl_magic(void)
+{
+#ifndef NDEBUG
+	/* check file descriptors are not sane */
+	xassert(pctl.initialized);
+	xassert(pctl.ring.fd >= 0);
+	xassert(pctl.interrupt.send >= 0);
+	xassert(pctl.interrupt.receive >= 0);
+	xassert(pctl.ring.fd != pctl.interrupt.send);
+	xassert(pctl.ring.fd != pctl.interrupt.receive);
+	xassert(pctl.interrupt.send != pctl.interrupt.receive);
+	xassert(pctl.fd_count >= 0);
+	xassert(pctl.ring.sq_ptr && pctl.ring.cq_ptr && pctl.ring.sqes);
+
+	xassert(pctl.interrupt.requested >= 0);
+#endif /* !NDEBUG */
+}
+
+static void _atfork_child(void)
+{
+	/*
+	 * Force pctl to return to default state before it was initialized at
+	 * forking as all of the prior state is completely unusable.
+	 */
+	pctl = (struct pctl_s) PCTL_INITIALIZER;
+}
+
+static void _init_ring(const int max_connections)
+{
+	struct io_uring_params params = { 0 };
+	uint32_t entries = MAX(SQ_ENTRIES(max_connections), MIN_RING_ENTRIES);
+
+	params.flags = (IORING_SETUP_CQSIZE | IORING_SETUP_CLAMP);
+	params.cq_entries = CQ_ENTRIES(entries);
+
+	if ((pctl.ring.fd = _io_uring_setup(entries, &params)) < 0)
+		fatal("%s: io_uring_setup(%u) failed: %m", __func__, entries);
+
+	fd_set_close_on_exec(pctl.ring.fd);
+
+	if (!(params.features & IORING_FEAT_NODROP))
+		fatal("%s: io_uring does not support IORING_FEAT_NODROP. Kernel is too old for CONMGR_USE_IO_URING.",
+		      __func__);
+
+	pctl.ring.sq_size = params.sq_off.array +
+		(params.sq_entries * sizeof(uint32_t));
+	pctl.ring.cq_size = params.cq_off.cqes +
+		(params.cq_entries * sizeof(struct io_uring_cqe));
+
+	if (params.features & IORING_FEAT_SINGLE_MMAP) {
+		pctl.ring.sq_size = MAX(pctl.ring.sq_size, pctl.ring.cq_size);
+		pctl.ring.cq_size = 0;
+	}
+
+	if ((pctl.ring.sq_ptr = mmap(NULL, pctl.ring.sq_size,
+				     (PROT_READ | PROT_WRITE),
+				     (MAP_SHARED | MAP_POPULATE), pctl.ring.fd,
+				     IORING_OFF_SQ_RING)) == MAP_FAILED)
+		fatal("%s: mmap(IORING_OFF_SQ_RING) failed: %m", __func__);
+
+	if (!pctl.ring.cq_size)
+		pctl.ring.cq_ptr = pctl.ring.sq_ptr;
+	else if ((pctl.ring.cq_ptr = mmap(NULL, pctl.ring.cq_size,
+					  (PROT_READ | PROT_WRITE),
+					  (MAP_SHARED | MAP_POPULATE),
+					  pctl.ring.fd, IORING_OFF_CQ_RING)) ==
+		 MAP_FAILED)
+		fatal("%s: mmap(IORING_OFF_CQ_RING) failed: %m", __func__);
+
+	pctl.ring.sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+	if ((pctl.ring.sqes = mmap(NULL, pctl.ring.sqes_size,
+				   (PROT_READ | PROT_WRITE),
+				   (MAP_SHARED | MAP_POPULATE), pctl.ring.fd,
+				   IORING_OFF_SQES)) == MAP_FAILED)
+		fatal("%s: mmap(IORING_OFF_SQES) failed: %m", __func__);
+
+	pctl.ring.sq_head = pctl.ring.sq_ptr + params.sq_off.head;
+	pctl.ring.sq_tail = pctl.ring.sq_ptr + params.sq_off.tail;
+	pctl.ring.sq_flags = pctl.ring.sq_ptr + params.sq_off.flags;
+	pctl.ring.sq_mask = *(uint32_t *) (pctl.ring.sq_ptr +
+					   params.sq_off.ring_mask);
+	pctl.ring.sq_entries = params.sq_entries;
+	pctl.ring.sq_array = pctl.ring.sq_ptr + params.sq_off.array;
+
+	pctl.ring.cq_head = pctl.ring.cq_ptr + params.cq_off.head;
+	pctl.ring.cq_tail = pctl.ring.cq_ptr + params.cq_off.tail;
+	pctl.ring.cq_mask = *(uint32_t *) (pctl.ring.cq_ptr +
+					   params.cq_off.ring_mask);
+	pctl.ring.cqes = pctl.ring.cq_ptr + params.cq_off.cqes;
+
+	log_flag(CONMGR, "%s: [IO_URING] initialized ring with %u submission and %u completion entries",
+		 __func__, params.sq_entries, params.cq_entries);
+}
+
+/* caller must hold pctl.mutex lock */
+static uint32_t _sq_pending(void)
+{
+	return (*pctl.ring.sq_tail -
+		__atomic_load_n(pctl.ring.sq_head, __ATOMIC_ACQUIRE));
+}
+
+/* caller must hold pctl.mutex lock */
+static void _submit(const char *caller)
+{
+	uint32_t pending = _sq_pending();
+	int submitted;
+
+	if (!pending)
+		return;
+
+	if ((submitted = _io_uring_enter(pctl.ring.fd, pending, 0, 0)) < 0) {
+		if ((errno == EINTR) || (errno == EAGAIN) || (errno == EBUSY)) {
+			log_flag(CONMGR, "%s->%s: [IO_URING] deferring submission of %u requests: %m",
+				 caller, __func__, pending);
+			return;
+		}
+
+		fatal_abort("%s->%s: [IO_URING] io_uring_enter(%u) failed: %m",
+			    caller, __func__, pending);
+	}
+
+	log_flag(CONMGR, "%s->%s: [IO_URING] submitted %d/%u requests",
+		 caller, __func__, submitted, pending);
+}
+
+/* caller must hold pctl.mutex lock */
+static void _queue_sqe(uint8_t opcode, int fd, uint32_t events, uint64_t addr,
+		       uint32_t len, uint64_t user_data, const char *caller)
+{
+	struct io_uring_sqe *sqe = NULL;
+	uint32_t tail, index;
+
+	if (_sq_pending() >= pctl.ring.sq_entries) {
+		/* Submission ring is full so flush it to the kernel now */
+		_submit(caller);
+
+		if (_sq_pending() >= pctl.ring.sq_entries)
+			fatal_abort("%s->%s: [IO_URING] submission ring full",
+				    caller, __func__);
+	}
+
+#if __BYTE_ORDER == __BIG_ENDIAN
+	/* poll32_events is word-reversed on big endian */
+	events = ((events << 16) | (events >> 16));
+#endif
+
+	tail = *pctl.ring.sq_tail;
+	index = (tail & pctl.ring.sq_mask);
+	sqe = &pctl.ring.sqes[index];
+
+	memset(sqe, 0, sizeof(*sqe));
+	sqe->opcode = opcode;
+	sqe->fd = fd;
+	sqe->addr = addr;
+	sqe->len = len;
+	sqe->poll32_events = events;
+	sqe->user_data = user_data;
+
+	pctl.ring.sq_array[index] = index;
+	__atomic_store_n(pctl.ring.sq_tail, (tail + 1), __ATOMIC_RELEASE);
+}
+
+/* caller must hold pctl.mutex lock */
+static fd_state_t *_get_fd_state(int fd)
+{
+	xassert(fd >= 0);
+
+	if (fd >= pctl.fds_count) {
+		int count = MAX((fd + 1), (pctl.fds_count * 2));
+
+		xrecalloc(pctl.fds, count, sizeof(*pctl.fds));
+
+		for (int i = pctl.fds_count; i < count; i++)
+			pctl.fds[i].event_index = -1;
+
+		pctl.fds_count = count;
+	}
+
+	return &pctl.fds[fd];
+}
+
+/* caller must hold pctl.mutex lock */
+static void _arm_fd(int fd, fd_state_t *state, const char *caller)
+{
+	xassert(state->token);
+	xassert(!state->armed);
+
+	_queue_sqe(IORING_OP_POLL_ADD, fd, state->events, 0,
+		   IORING_POLL_ADD_MULTI, USER_DATA(fd, state->token), caller);
+	state->armed = true;
+}
+
+/* caller must hold pctl.mutex lock */
+static void _disarm_fd(int fd, fd_state_t *state, const char *caller)
+{
+	xassert(state->token);
+
+	if (!state->armed)
+		return;
+
+	_queue_sqe(IORING_OP_POLL_REMOVE, -1, 0, USER_DATA(fd, state->token),
+		   0, USER_DATA_REMOVE, caller);
+	state->armed = false;
+}
+
+/* caller must hold pctl.mutex lock */
+static uint32_t _next_token(void)
+{
+	/* token of 0 is reserved for unlinked fds */
+	if (!++pctl.token)
+		++pctl.token;
+
+	return pctl.token;
+}
+
+static void _init(const int max_connections)
+{
+	int rc;
+
+	slurm_mutex_lock(&pctl.mutex);
+
+	if (pctl.initialized) {
+		log_flag(CONMGR, "%s: Skipping. Already initialized", __func__);
+		slurm_mutex_unlock(&pctl.mutex);
+		return;
+	}
+
+	pctl.events_count = MAX_POLL_EVENTS(max_connections);
+
+	if ((rc = pthread_atfork(NULL, NULL, _atfork_child)))
+		fatal_abort("%s: pthread_atfork() failed: %s",
+			    __func__, slurm_strerror(rc));
+
+	{
+		int fd[2] = { -1, -1 };
+		if (pipe(fd))
+			fatal("%s: unable to open unnamed pipe: %m", __func__);
+
+		fd_set_nonblocking(fd[0]);
+		fd_set_close_on_exec(fd[0]);
+		pctl.interrupt.receive = fd[0];
+
+		fd_set_blocking(fd[1]);
+		fd_set_close_on_exec(fd[1]);
+		pctl.interrupt.send = fd[1];
+	}
+
+	_init_ring(max_connections);
+
+	pctl.events = xcalloc(pctl.events_count, sizeof(*pctl.events));
+	pctl.initialized = true;
+
+	_check_pctl_magic();
+
+	if (_link_fd(pctl.interrupt.receive, PCTL_TYPE_READ_ONLY,
+		     INTERRUPT_CON_NAME, __func__))
+		fatal_abort("unable to monitor interrupt");
+
+	slurm_mutex_unlock(&pctl.mutex);
+}
+
+static void _fini(void)
+{
+	slurm_mutex_lock(&pctl.mutex);
+	_check_pctl_magic();
+
+	if (!pctl.initialized) {
+		slurm_mutex_unlock(&pctl.mutex);
+		return;
+	}
+
+	while (pctl.interrupt.sending)
+		EVENT_WAIT(&pctl.interrupt_return, &pctl.mutex);
+
+	while (pctl.polling)
+		EVENT_WAIT(&pctl.poll_return, &pctl.mutex);
+
+#ifdef MEMORY_LEAK_DEBUG
+	_unlink_fd(pctl.interrupt.receive, INTERRUPT_CON_NAME, __func__);
+
+	fd_close(&pctl.interrupt.receive);
+	fd_close(&pctl.interrupt.send);
+
+	munmap(pctl.ring.sqes, pctl.ring.sqes_size);
+	if (pctl.ring.cq_size)
+		munmap(pctl.ring.cq_ptr, pctl.ring.cq_size);
+	munmap(pctl.ring.sq_ptr, pctl.ring.sq_size);
+	fd_close(&pctl.ring.fd);
+
+	xfree(pctl.events);
+	xfree(pctl.fds);
+	EVENT_FREE_MEMBERS(&pctl.poll_return);
+	EVENT_FREE_MEMBERS(&pctl.interrupt_return);
+
+	pctl.initialized = false;
+#endif /* MEMORY_LEAK_DEBUG */
+
+	slurm_mutex_unlock(&pctl.mutex);
+
+	/*
+	 * lock is never destroyed
+	 * slurm_mutex_destroy(&pctl.mutex);
+	 */
+}
+
+/* caller must hold pctl.mutex lock */
+static int _link_fd(int fd, pollctl_fd_type_t type, const char *con_name,
+		    const char *caller)
+{
+	fd_state_t *state = _get_fd_state(fd);
+
+	if (state->token) {
+		log_flag(CONMGR, "%s->%s: [IO_URING:%s] fd:%d already registered",
+			 caller, __func__, con_name, fd);
+		return EEXIST;
+	}
+
+	state->token = _next_token();
+	state->events = _fd_type_to_events(type);
+	_arm_fd(fd, state, caller);
+
+	log_flag(CONMGR, "%s->%s: [IO_URING:%s] registered fd[%s]:%d for %s events",
+		 caller, __func__, con_name, _fd_type_to_type_string(type), fd,
+		 _fd_type_to_events_string(type));
+
+	pctl.fd_count++;
+	return SLURM_SUCCESS;
+}
+
+static int _lock_link_fd(int fd, pollctl_fd_type_t type, const char *con_name,
+			 const char *caller)
+{
+	int rc;
+
+	slurm_mutex_lock(&pctl.mutex);
+	_check_pctl_magic();
+	rc = _link_fd(fd, type, con_name, caller);
+	slurm_mutex_unlock(&pctl.mutex);
+
+	/* Wake up poller to submit queued request */
+	_interrupt(caller);
+
+	return rc;
+}
+
+static void _relink_fd(int fd, pollctl_fd_type_t type,
+			    const char *con_name, const char *caller)
+{
+	fd_state_t *state = NULL;
+
+	slurm_mutex_lock(&pctl.mutex);
+	_check_pctl_magic();
+
+	state = _get_fd_state(fd);
+
+	if (!state->token)
+		fatal_abort("%s->%s: [IO_URING:%s] fd:%d not registered",
+			    caller, __func__, con_name, fd);
+
+	/*
+	 * Replace poll request with a new token to ignore any completions
+	 * still pending for the prior request.
+	 */
+	_disarm_fd(fd, state, caller);
+	state->token = _next_token();
+	state->events = _fd_type_to_events(type);
+	_arm_fd(fd, state, caller);
+
+	log_flag(CONMGR, "%s->%s: [IO_URING:%s] Modified fd[%s]:%d for %s events",
+		 caller, __func__, con_name, _fd_type_to_type_string(type), fd,
+		 _fd_type_to_events_string(type));
+
+	slurm_mutex_unlock(&pctl.mutex);
+
+	/* Wake up poller to submit queued requests */
+	_interrupt(caller);
+}
+
+/* caller must hold pctl.mutex */
+static void _unlink_fd(int fd, const char *con_name, const char *caller)
+{
+	fd_state_t *state = NULL;
+
+	_check_pctl_magic();
+
+	state = _get_fd_state(fd);
+
+	if (!state->token)
+		fatal_abort("%s->%s: [IO_URING:%s] fd:%d not registered",
+			    caller, __func__, con_name, fd);
+
+	_disarm_fd(fd, state, caller);
+	state->token = 0;
+	state->events = 0;
+
+	/*
+	 * Submit removal immediately as the poll request holds a reference to
+	 * the file which would otherwise delay the caller's close() taking
+	 * effect.
+	 */
+	_submit(caller);
+
+	log_flag(CONMGR, "%s->%s: [IO_URING:%s] deregistered fd:%d events",
+		 caller, __func__, con_name, fd);
+
+	pctl.fd_count--;
+}
+
+static void _lock_unlink_fd(int fd, const char *con_name, const char *caller)
+{
+	slurm_mutex_lock(&pctl.mutex);
+	_check_pctl_magic();
+
+	_unlink_fd(fd, con_name, caller);
+
+	slurm_mutex_unlock(&pctl.mutex);
+}
+
+static void _flush_interrupt(int intr_fd, uint32_t events, const char *caller)
+{
+	ssize_t event_read = -1;
+	char buf[FLUSH_BUFFER_BYTES]; /* buffer for event_read */
+
+	/* clear trash from the interrupt pipe */
+
+	if ((event_read = read(intr_fd, buf, sizeof(buf)) < 0) &&
+	    (errno != EWOULDBLOCK) && (errno != EAGAIN) && (errno != EINTR))
+		fatal_abort("this should never happen read(%d)=%m", intr_fd);
+
+	/* only 1 byte should ever get written to pipe at a time */
+	xassert(event_read <= 1);
+
+	slurm_mutex_lock(&pctl.mutex);
+
+	log_flag(CONMGR, "%s->%s: [IO_URING:%s] read %zd bytes representing %d pending requests while sending=%c",
+		 caller, __func__, INTERRUPT_CON_NAME, event_read,
+		 pctl.interrupt.requested,
+		 (pctl.interrupt.sending ? 'T' : 'F'));
+
+	/* reset counter */
+	pctl.interrupt.requested = 0;
+
+	slurm_mutex_unlock(&pctl.mutex);
+}
+
+/* caller must hold pctl.mutex lock */
+static void _add_event(int fd, fd_state_t *state, uint32_t events,
+		       int *nfds_ptr)
+{
+	if (state->event_index >= 0) {
+		/* Merge multiple completions for the same fd */
+		xassert(pctl.events[state->event_index].fd == fd);
+		pctl.events[state->event_index].events |= events;
+		return;
+	}
+
+	if (*nfds_ptr >= pctl.events_count) {
+		pctl.events_count *= 2;
+		xrecalloc(pctl.events, pctl.events_count,
+			  sizeof(*pctl.events));
+	}
+
+	state->event_index = *nfds_ptr;
+	pctl.events[*nfds_ptr].fd = fd;
+	pctl.events[*nfds_ptr].events = events;
+	(*nfds_ptr)++;
+}
+
+/* caller must hold pctl.mutex lock */
+static void _handle_cqe(const struct io_uring_cqe *cqe, int *nfds_ptr,
+			const char *caller)
+{
+	const int fd = USER_DATA_FD(cqe->user_data);
+	const uint32_t token = USER_DATA_TOKEN(cqe->user_data);
+	fd_state_t *state = NULL;
+	uint32_t events = 0;
+
+	if (cqe->user_data == USER_DATA_REMOVE) {
+		/* poll request may have already completed before removal */
+		if ((cqe->res < 0) && (cqe->res != -ENOENT) &&
+		    (cqe->res != -EALREADY))
+			log_flag(CONMGR, "%s->%s: [IO_URING] poll removal failed: %s",
+				 caller, __func__, slurm_strerror(-cqe->res));
+		return;
+	}
+
+	if ((fd >= pctl.fds_count) || (pctl.fds[fd].token != token)) {
+		/* Completion from request already removed or replaced */
+		return;
+	}
+
+	state = &pctl.fds[fd];
+
+	if (!(cqe->flags & IORING_CQE_F_MORE))
+		state->armed = false;
+
+	if (cqe->res == -EINVAL) {
+		fatal("%s->%s: [IO_URING] multishot poll of fd:%d rejected. Kernel is too old for CONMGR_USE_IO_URING.",
+		      caller, __func__, fd);
+	} else if (cqe->res < 0) {
+		log_flag(CONMGR, "%s->%s: [IO_URING] poll of fd:%d failed: %s",
+			 caller, __func__, fd, slurm_strerror(-cqe->res));
+
+		/* Let connection handler find the error */
+		events = EPOLLERR;
+	} else {
+		events = cqe->res;
+
+		/* Kernel may terminate multishot requests at any time */
+		if (!state->armed)
+			_arm_fd(fd, state, caller);
+	}
+
+	if (events)
+		_add_event(fd, state, events, nfds_ptr);
+}
+
+/* caller must hold pctl.mutex lock */
+static int _reap_completions(const char *caller)
+{
+	int nfds = 0;
+
+	while (true) {
+		uint32_t head = *pctl.ring.cq_head;
+		const uint32_t tail =
+			__atomic_load_n(pctl.ring.cq_tail, __ATOMIC_ACQUIRE);
+
+		for (; head != tail; head++)
+			_handle_cqe(&pctl.ring.cqes[head & pctl.ring.cq_mask],
+				    &nfds, caller);
+
+		__atomic_store_n(pctl.ring.cq_head, head, __ATOMIC_RELEASE);
+
+		if (!(__atomic_load_n(pctl.ring.sq_flags, __ATOMIC_ACQUIRE) &
+		      IORING_SQ_CQ_OVERFLOW))
+			break;
+
+		/* Have kernel move overflowed completions into the ring */
+		log_flag(CONMGR, "%s->%s: [IO_URING] flushing overflowed completions",
+			 caller, __func__);
+
+		if ((_io_uring_enter(pctl.ring.fd, 0, 0,
+				     IORING_ENTER_GETEVENTS) < 0) &&
+		    (errno != EINTR) && (errno != EAGAIN) && (errno != EBUSY))
+			fatal_abort("%s->%s: [IO_URING] io_uring_enter(IORING_ENTER_GETEVENTS) failed: %m",
+				    caller, __func__);
+	}
+
+	return nfds;
+}
+
+static int _poll(const char *caller)
+{
+	int nfds = -1, rc = SLURM_SUCCESS, ring_fd = -1, fd_count = 0;
+	uint32_t to_submit = 0;
+
+	slurm_mutex_lock(&pctl.mutex);
+	_check_pctl_magic();
+
+	/*
+	 * Using pctl.polling as way to avoid touching pctl.events while not
+	 * holding the mutex so poll can be done without the lock.
+	 */
+	xassert(!pctl.polling);
+	xassert(!pctl.events_triggered);
+	pctl.polling = true;
+	ring_fd = pctl.ring.fd;
+	fd_count = pctl.fd_count;
+	to_submit = _sq_pending();
+
+	log_flag(CONMGR, "%s->%s: [IO_URING] BEGIN: io_uring_enter() with %d file descriptors and %u queued requests",
+		 caller, __func__, pctl.fd_count, to_submit);
+
+	slurm_mutex_unlock(&pctl.mutex);
+
+	if (fd_count <= 1) {
+		/*
+		 * No point in waiting when only file descriptor is the
+		 * interrupt pipe
+		 */
+		log_flag(CONMGR, "%s->%s: [IO_URING] skipping wait in io_uring_enter() with %d file descriptors",
+			 caller, __func__, fd_count);
+
+		if (to_submit && (_io_uring_enter(ring_fd, to_submit, 0, 0) < 0))
+			rc = errno;
+	} else if (_io_uring_enter(ring_fd, to_submit, 1,
+				   IORING_ENTER_GETEVENTS) < 0) {
+		rc = errno;
+	}
+
+	slurm_mutex_lock(&pctl.mutex);
+
+	if ((rc == EINTR) || (rc == EAGAIN) || (rc == EBUSY)) {
+		/*
+		 * Treat as no events detected. Any unsubmitted requests will
+		 * be submitted in the next call.
+		 */
+		log_flag(CONMGR, "%s->%s: [IO_URING] END: io_uring_enter() interrupted: %s",
+			 caller, __func__, slurm_strerror(rc));
+		rc = SLURM_SUCCESS;
+	} else if (rc) {
+		fatal_abort("%s->%s: [IO_URING] END: io_uring_enter() failed: %s",
+			    caller, __func__, slurm_strerror(rc));
+	}
+
+	nfds = _reap_completions(caller);
+
+	log_flag(CONMGR, "%s->%s: [IO_URING] END: io_uring_enter() with events for %d/%d file descriptors",
+		 caller, __func__, nfds, pctl.fd_count);
+
+	/* wait for pollctl_for_each_event() to do anything */
+	pctl.events_triggered = nfds;
+
+	/* pctl.polling is set to false by pollctl_for_each_event() */
+	xassert(pctl.polling);
+	slurm_mutex_unlock(&pctl.mutex);
+
+	return rc;
+}
+
+static int _for_each_event(pollctl_event_func_t func, void *arg,
+			   const char *func_name, const char *caller)
+{
+	int nfds = -1, rc = SLURM_SUCCESS, intr_fd = -1;
+	event_t *events = NULL;
+	event_signal_t *poll_return = NULL;
+
+	slurm_mutex_lock(&pctl.mutex);
+	_check_pctl_magic();
+
+	xassert(pctl.polling);
+
+	events = pctl.events;
+	nfds = pctl.events_triggered;
+	intr_fd = pctl.interrupt.receive;
+	slurm_mutex_unlock(&pctl.mutex);
+
+	for (int i = 0; !rc && (i < nfds); ++i) {
+		char *events_str = NULL;
+
+		if (events[i].fd == intr_fd) {
+			_flush_interrupt(intr_fd, events[i].events, caller);
+			continue;
+		}
+
+		if (slurm_conf.debug_flags & DEBUG_FLAG_CONMGR)
+			events_str = _epoll_events_to_string(events[i].events);
+
+		log_flag(CONMGR, "%s->%s: [IO_URING] BEGIN: calling %s(fd:%d, (%s), 0x%"PRIxPTR")",
+			 caller, __func__, func_name, events[i].fd,
+			 events_str, (uintptr_t) arg);
+
+		rc = func(events[i].fd, events[i].events, arg);
+
+		log_flag(CONMGR, "%s->%s: [IO_URING] END: called %s(fd:%d, (%s), 0x%"PRIxPTR")=%s",
+			 caller, __func__, func_name, events[i].fd,
+			 events_str, (uintptr_t) arg, slurm_strerror(rc));
+
+		xfree(events_str);
+	}
+
+	slurm_mutex_lock(&pctl.mutex);
+
+	xassert(pctl.polling);
+
+	for (int i = 0; i < nfds; i++)
+		pctl.fds[events[i].fd].event_index = -1;
+
+	pctl.polling = false;
+	pctl.events_triggered = 0;
+	poll_return = &pctl.poll_return;
+
+	EVENT_BROADCAST(poll_return);
+	slurm_mutex_unlock(&pctl.mutex);
+
+	return rc;
+}
+
+/* send 1 byte without lock */
+static int _intr_send_byte(int fd, const char *caller)
+{
+	DEF_TIMERS;
+	char buf[] = "1";
+
+	if (slurm_conf.debug_flags & DEBUG_FLAG_CONMGR)
+		START_TIMER;
+
+	/* send 1 byte of trash to wake up poll() */
+	safe_write(fd, buf, 1);
+
+	if (slurm_conf.debug_flags & DEBUG_FLAG_CONMGR) {
+		END_TIMER3(NULL, 0);
+		log_flag(CONMGR, "%s->%s: [IO_URING] interrupt byte sent in %s",
+			 caller, __func__, TIME_STR);
+	}
+
+	return SLURM_SUCCESS;
+rwfail:
+	return errno;
+}
+
+static void _interrupt(const char *caller)
+{
+	event_signal_t *interrupt_return = NULL;
+	int rc, fd = -1;
+
+	slurm_mutex_lock(&pctl.mutex);
+	_check_pctl_magic();
+
+	if (!pctl.polling) {
+		log_flag(CONMGR, "%s->%s: [IO_URING] skipping sending interrupt when not actively poll()ing",
+			 caller, __func__);
+	} else {
+		pctl.interrupt.requested++;
+
+		/* Check for duplicate requests. */
+		if (pctl.interrupt.requested == 1) {
+			fd = pctl.interrupt.send;
+			xassert(!pctl.interrupt.sending);
+			pctl.interrupt.sending = true;
+			interrupt_return = &pctl.interrupt_return;
+
+			log_flag(CONMGR, "%s->%s: [IO_URING] sending interrupt requests=%d",
+				 caller, __func__,
+				 pctl.interrupt.requested);
+		} else {
+			log_flag(CONMGR, "%s->%s: [IO_URING] skipping sending another interrupt requests=%d sending=%c",
+				 caller, __func__,
+				 pctl.interrupt.requested,
+				 (pctl.interrupt.sending ? 'T' : 'F'));
+		}
+	}
+
+	slurm_mutex_unlock(&pctl.mutex);
+
+	if (fd < 0)
+		return;
+
+	if ((rc = _intr_send_byte(fd, caller))) {
+		error("%s->%s: [IO_URING] write(%d) failed: %s",
+		      caller, __func__, fd, slurm_strerror(errno));
+	}
+
+	slurm_mutex_lock(&pctl.mutex);
+	_check_pctl_magic();
+
+	log_flag(CONMGR, "%s->%s: [IO_URING] interrupt sent requests=%d polling=%c",
+		 caller, __func__, pctl.interrupt.requested,
+		 (pctl.polling ? 'T' : 'F'));
+
+	xassert(fd == pctl.interrupt.send);
+	xassert(pctl.interrupt.sending);
+	pctl.interrupt.sending = false;
+
+	EVENT_BROADCAST(interrupt_return);
+	slurm_mutex_unlock(&pctl.mutex);
+}
+
+static bool _events_can_read(pollctl_events_t events)
+{
+	/*
+	 * Allow read()/write() to catch EPOLLRDHUP AND EPOLLHUP as there may
+	 * still be more bytes the fd's buffers and we don't want to close() the
+	 * connection yet either to drop those buffers on the floor.
+	 */
+	return (events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP));
+}
+
+static bool _events_can_write(pollctl_events_t events)
+{
+	return (events & (EPOLLOUT | EPOLLRDHUP | EPOLLHUP));
+}
+
+static bool _events_has_error(pollctl_events_t events)
+{
+	return (events & EPOLLERR);
+}
+
+static bool _events_has_hangup(pollctl_events_t events)
+{
+	return (events & (EPOLLRDHUP | EPOLLHUP));
+}
+
+const poll_funcs_t io_uring_funcs = {
+	.mode = POLL_MODE_IO_URING,
+	.init = _init,
+	.fini = _fini,
+	.type_to_string = _type_to_string,
+	.link_fd = _lock_link_fd,
+	.relink_fd = _relink_fd,
+	.unlink_fd = _lock_unlink_fd,
+	.poll = _poll,
+	.for_each_event = _for_each_event,
+	.interrupt = _interrupt,
+	.events_can_read = _events_can_read,
+	.events_can_write = _events_can_write,
+	.events_has_error = _events_has_error,
+	.events_has_hangup = _events_has_hangup,
+};
@@ -0,0 +1,141 @@
+/*****************************************************************************\
+ *  metrics.c - OpenMetrics listener for connection manager
+ *****************************************************************************
+ *  Copyright (C) SchedMD LLC.
+ *
+ *  This file is part of Slurm, a resource management program.
+ *  For details, see <https://slurm.schedmd.com/>.
+ *  Please also read the included file: DISCLAIMER.
+ *
+ *  Slurm is free software; you can redistribute it and/or modify it under
+ *  the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the License, or (at your option)
+ *  any later version.
+ *
+ *  In addition, as a special exception, the copyright holders give permission
+ *  to link the code of portions of this program with the OpenSSL library under
+ *  certain conditions as described in each individual source file, and
+ *  distribute linked combinations including the two. You must obey the GNU
+ *  General Public License in all respects for all of the code used other than
+ *  OpenSSL. If you modify file(s) with this exception, you may extend this
+ *  exception to your version of the file(s), but you are not obligated to do
+ *  so. If you do not wish to do so, delete this exception statement from your
+ *  version.  If you delete this exception statement from all source files in
+ *  the program, then also delete it here.
+ *
+ *  Slurm is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with Slurm; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA.
+\*****************************************************************************/
+
+#include <string.h>
+
+#include "src/common/log.h"
+#include "src/common/metrics.h"
+#include "src/common/read_config.h"
+#include "src/common/xmalloc.h"
+#include "src/common/xstring.h"
+
+#include "src/conmgr/conmgr.h"
+
+/* Requests larger than this are not metrics scrapes */
+#define METRICS_MAX_REQUEST 8192
+
+#define HTTP_RESPONSE_FMT \
+	"HTTP/1.1 %s\r\n" \
+	"Content-Type: %s\r\n" \
+	"Content-Length: %zu\r\n" \
+	"Connection: close\r\n" \
+	"\r\n"
+
+static char *metrics_prefix = NULL;
+
+static void _send_response(conmgr_fd_t *con, const char *status,
+			   const char *type, const char *body)
+{
+	char *resp = NULL;
+
+	xstrfmtcat(resp, HTTP_RESPONSE_FMT "%s", status, type, strlen(body),
+		   body);
+	conmgr_queue_write_data(con, resp, strlen(resp));
+	xfree(resp);
+}
+
+/*
+ * Answer one HTTP request per connection. Only the request line matters, so
+ * this only waits for the end of the headers instead of parsing them.
+ */
+static int _on_metrics_data(conmgr_fd_t *con, void *arg)
+{
+	const void *data = NULL;
+	size_t bytes = 0;
+	char *req;
+
+	conmgr_fd_get_in_buffer(con, &data, &bytes);
+	req = xstrndup(data, MIN(bytes, METRICS_MAX_REQUEST));
+
+	if (!strstr(req, "\r\n\r\n") && !strstr(req, "\n\n")) {
+		xfree(req);
+		if (bytes < METRICS_MAX_REQUEST)
+			return SLURM_SUCCESS;
+
+		log_flag(NET, "%s: [%s] rejecting oversized request",
+			 __func__, conmgr_fd_get_name(con));
+		return SLURM_ERROR;
+	}
+	conmgr_fd_mark_consumed_in_buffer(con, bytes);
+
+	if (!xstrncmp(req, "GET /metrics ", 13) ||
+	    !xstrncmp(req, "GET / ", 6)) {
+		char *body = metrics_dump(metrics_prefix);
+
+		_send_response(con, "200 OK",
+			       "application/openmetrics-text; version=1.0.0; charset=utf-8",
+			       body);
+		xfree(body);
+	} else {
+		_send_response(con, "404 Not Found", "text/plain",
+			       "Not Found\n");
+	}
+
+	xfree(req);
+	conmgr_queue_close_fd(con);
+	return SLURM_SUCCESS;
+}
+
+extern int conmgr_metrics_listen(const char *params, const char *prefix)
+{
+	static const conmgr_events_t events = {
+		.on_data = _on_metrics_data,
+	};
+	char *tmp_str, *tok, *save_ptr = NULL, *listen_on = NULL;
+	int rc = SLURM_SUCCESS;
+
+	tmp_str = xstrdup(params);
+	for (tok = strtok_r(tmp_str, ",", &save_ptr); tok;
+	     tok = strtok_r(NULL, ",", &save_ptr)) {
+		if (!xstrncasecmp(tok, CONMGR_PARAM_METRICS,
+				  strlen(CONMGR_PARAM_METRICS)))
+			listen_on = tok + strlen(CONMGR_PARAM_METRICS);
+	}
+
+	if (listen_on && listen_on[0]) {
+		xfree(metrics_prefix);
+		metrics_prefix = xstrdup(prefix);
+
+		if ((rc = conmgr_create_listen_socket(CON_TYPE_RAW, listen_on,
+						      &events, NULL)))
+			error("%s: [%s] unable to listen for metrics requests: %s",
+			      __func__, listen_on, slurm_strerror(rc));
+		else
+			verbose("Serving metrics on %s", listen_on);
+	}
+
+	xfree(tmp_str);
+	return rc;
+}
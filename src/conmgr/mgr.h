@@ -236,6 +236,8 @@ typedef struct {
 	pthread_t tid;
 	/* unique id for tracking */
 	int id;
+	/* list of work_t* queued by this worker that any worker may steal */
+	list_t *work;
 } worker_t;
 
 /*
@@ -318,7 +320,7 @@ typedef struct {
 	int error;
 	/* list of work_t */
 	list_t *delayed_work;
-	/* list of work_t* */
+	/* list of work_t* queued by threads that are not workers */
 	list_t *work;
 
 	/* functions to handle host/port parsing */
@@ -332,10 +334,24 @@ typedef struct {
 
 		/* list of worker_t */
 		list_t *workers;
+		/*
+		 * Array of every worker_t indexed by (id - 1) to allow workers
+		 * to steal work without holding mgr.mutex
+		 */
+		worker_t **array;
+		/* number of workers in array */
+		int array_count;
 
-		/* track simple stats for logging */
+		/*
+		 * Number of workers running (or looking for) work. Incremented
+		 * atomically without mgr.mutex but only decremented while
+		 * holding mgr.mutex.
+		 */
 		int active;
+		/* track simple stats for logging */
 		int total;
+		/* work queued in mgr.work or any worker->work (atomic) */
+		int queued;
 
 		/*
 		 * track shutdown of workers after other work is done or there
@@ -531,6 +547,34 @@ extern void run_quiesced_work(void);
  */
 extern void wrap_work(work_t *work);
 
+/*
+ * Run work callback and release work
+ * IN work - work to run (will be xfree()ed)
+ * RET connection of work to pass to release_work_con() or NULL
+ */
+extern conmgr_fd_t *run_work(work_t *work);
+
+/*
+ * Notify mgr that work for connection has completed
+ * NOTE: caller must hold mgr.mutex lock
+ * IN con - connection returned by run_work()
+ */
+extern void release_work_con(conmgr_fd_t *con);
+
+/*
+ * Queue work to be run by workers
+ * NOTE: caller must hold mgr.mutex lock
+ * IN work - work to queue. Takes ownership.
+ */
+extern void workers_queue_work(work_t *work);
+
+/* Get count of all work queued for workers */
+#define WORKERS_QUEUED() \
+	__atomic_load_n(&mgr.workers.queued, __ATOMIC_SEQ_CST)
+/* Get count of active workers */
+#define WORKERS_ACTIVE() \
+	__atomic_load_n(&mgr.workers.active, __ATOMIC_SEQ_CST)
+
 /*
  * Wait for all workers to finish their work
  * WARNING: caller must hold mgr.mutex
@@ -47,6 +47,10 @@ extern const poll_funcs_t epoll_funcs;
 #define DEFAULT_POLLING_MODE POLL_MODE_POLL
 #endif /* HAVE_EPOLL */
 
+#ifdef HAVE_IO_URING
+extern const poll_funcs_t io_uring_funcs;
+#endif /* HAVE_IO_URING */
+
 #define T(mode) { mode, XSTRINGIFY(mode) }
 static const struct {
 	poll_mode_t mode;
@@ -55,6 +59,7 @@ static const struct {
 	T(POLL_MODE_INVALID),
 	T(POLL_MODE_EPOLL),
 	T(POLL_MODE_POLL),
+	T(POLL_MODE_IO_URING),
 	T(POLL_MODE_INVALID_MAX),
 };
 
@@ -65,6 +70,9 @@ static const poll_funcs_t *polling_funcs[] = {
 #ifdef HAVE_EPOLL
 	&epoll_funcs,
 #endif /* HAVE_EPOLL */
+#ifdef HAVE_IO_URING
+	&io_uring_funcs,
+#endif /* HAVE_IO_URING */
 	&poll_funcs,
 };
 
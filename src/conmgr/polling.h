@@ -46,6 +46,7 @@ typedef enum {
 	POLL_MODE_INVALID = 0,
 	POLL_MODE_EPOLL,
 	POLL_MODE_POLL,
+	POLL_MODE_IO_URING,
 	POLL_MODE_INVALID_MAX,
 } poll_mode_t;
 
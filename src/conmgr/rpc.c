@@ -103,7 +103,20 @@ extern int on_rpc_connection_data(conmgr_fd_t *con, void *arg)
 	log_flag_hex(NET_RAW, get_buf_data(rpc), size_buf(rpc),
 		     "%s: [%s] unpacking RPC", __func__, con->name);
 
-	if ((rc = slurm_unpack_received_msg(msg, con->input_fd, rpc))) {
+	if (con_flag(con, FLAG_RPC_KEEP_BUFFER)) {
+		/*
+		 * Unpack from the kept copy instead of con->in so strings that
+		 * unpack_msg() leaves in the buffer stay valid for the life of
+		 * the message.
+		 */
+		msg->buffer = init_buf(size_buf(rpc));
+		memcpy(get_buf_data(msg->buffer), get_buf_data(rpc),
+		       size_buf(rpc));
+	}
+
+	if ((rc = slurm_unpack_received_msg(msg, con->input_fd,
+					    (msg->buffer ? msg->buffer :
+					     rpc)))) {
 		rc = errno;
 		error("%s: [%s] slurm_unpack_received_msg() failed: %s",
 		      __func__, con->name, slurm_strerror(rc));
@@ -114,13 +127,8 @@ extern int on_rpc_connection_data(conmgr_fd_t *con, void *arg)
 			 __func__, con->name, need,
 			 rpc_num2string(msg->msg_type));
 
-		if (con_flag(con, FLAG_RPC_KEEP_BUFFER)) {
-			xassert(!msg->buffer);
-			msg->buffer = init_buf(size_buf(rpc));
-			memcpy(get_buf_data(msg->buffer), get_buf_data(rpc),
-			       size_buf(rpc));
+		if (msg->buffer)
 			msg->flags |= SLURM_MSG_KEEP_BUFFER;
-		}
 	}
 
 	/* notify conmgr we processed some data */
@@ -51,6 +51,7 @@
 #include "src/common/timers.h"
 #include "src/common/xmalloc.h"
 
+#include "src/conmgr/buffers.h"
 #include "src/conmgr/conmgr.h"
 #include "src/conmgr/delayed.h"
 #include "src/conmgr/events.h"
@@ -1073,7 +1074,7 @@ static int _handle_poll_event(int fd, pollctl_events_t events, void *arg)
 static bool _is_poll_interrupt(void)
 {
 	return (mgr.quiesced || mgr.shutdown_requested ||
-		(mgr.waiting_on_work && (mgr.workers.active == 1)));
+		(mgr.waiting_on_work && (WORKERS_ACTIVE() == 1)));
 }
 
 /* Poll all connections */
@@ -1137,7 +1138,8 @@ static void _connection_fd_delete(conmgr_callback_args_t conmgr_args, void *arg)
 	log_flag(CONMGR, "%s: [%s] free connection input_fd=%d output_fd=%d",
 		 __func__, con->name, con->input_fd, con->output_fd);
 
-	FREE_NULL_BUFFER(con->in);
+	buffer_pool_put(con->in);
+	con->in = NULL;
 	FREE_NULL_LIST(con->out);
 	FREE_NULL_LIST(con->work);
 	FREE_NULL_LIST(con->write_complete_work);
@@ -1212,16 +1214,21 @@ static bool _watch_loop(void)
 	}
 
 	if (!mgr.quiesced && !list_is_empty(mgr.quiesced_work)) {
-		mgr.quiesced = true;
+		/*
+		 * Workers check mgr.quiesced without mgr.mutex after marking
+		 * themselves active so this must be visible before checking
+		 * for active workers
+		 */
+		__atomic_store_n(&mgr.quiesced, true, __ATOMIC_SEQ_CST);
 		log_flag(CONMGR, "%s: BEGIN: quiesced state", __func__);
 	}
 
 	if (mgr.quiesced) {
 		xassert(!list_is_empty(mgr.quiesced_work));
 
-		if (mgr.workers.active) {
+		if (WORKERS_ACTIVE()) {
 			log_flag(CONMGR, "%s: quiesced state waiting on workers:%d quiesced_work:%u",
-				 __func__, mgr.workers.active,
+				 __func__, WORKERS_ACTIVE(),
 				 list_count(mgr.quiesced_work));
 			mgr.waiting_on_work = true;
 			return true;
@@ -1230,6 +1237,10 @@ static bool _watch_loop(void)
 		run_quiesced_work();
 		mgr.quiesced = false;
 		log_flag(CONMGR, "%s: END: quiesced state", __func__);
+
+		/* Wake workers for any work queued while quiesced */
+		if (WORKERS_QUEUED())
+			EVENT_BROADCAST(&mgr.worker_sleep);
 		return true;
 	}
 
@@ -1243,12 +1254,12 @@ static bool _watch_loop(void)
 	 * any queued work.
 	 */
 
-	if (mgr.workers.active || !list_is_empty(mgr.work) ||
+	if (WORKERS_ACTIVE() || WORKERS_QUEUED() ||
 	    !list_is_empty(mgr.delayed_work)) {
 		/* Need to wait for all work/workers to complete */
 		log_flag(CONMGR, "%s: waiting on workers:%d work:%d delayed_work:%d",
-			 __func__, mgr.workers.active,
-			 list_count(mgr.delayed_work), list_count(mgr.work));
+			 __func__, WORKERS_ACTIVE(),
+			 WORKERS_QUEUED(), list_count(mgr.delayed_work));
 		mgr.waiting_on_work = true;
 		return true;
 	}
@@ -1283,8 +1294,8 @@ extern void *watch(void *arg)
 		}
 
 		log_flag(CONMGR, "%s: waiting for new events: workers:%d/%d work:%d delayed_work:%d connections:%d listeners:%d complete:%d polling:%c inspecting:%c shutdown_requested:%c quiesced:%c[%u] waiting_on_work:%c",
-				 __func__, mgr.workers.active,
-				 mgr.workers.total, list_count(mgr.work),
+				 __func__, WORKERS_ACTIVE(),
+				 mgr.workers.total, WORKERS_QUEUED(),
 				 list_count(mgr.delayed_work),
 				 list_count(mgr.connections),
 				 list_count(mgr.listen_conns),
@@ -171,7 +171,7 @@ static void _log_work(work_t *work, const char *caller, const char *fmt, ...)
 	xfree(fmtstr);
 }
 
-extern void wrap_work(work_t *work)
+extern conmgr_fd_t *run_work(work_t *work)
 {
 	conmgr_fd_t *con = work->con;
 
@@ -186,23 +186,35 @@ extern void wrap_work(work_t *work)
 
 	_log_work(work, __func__, "END");
 
+	work->magic = ~MAGIC_WORK;
+	xfree(work);
+
+	return con;
+}
+
+extern void release_work_con(conmgr_fd_t *con)
+{
+	con_unset_flag(con, FLAG_WORK_ACTIVE);
+	/* con may be xfree()ed any time once lock is released */
+
+	EVENT_SIGNAL(&mgr.watch_sleep);
+}
+
+extern void wrap_work(work_t *work)
+{
+	conmgr_fd_t *con = run_work(work);
+
 	if (con) {
 		slurm_mutex_lock(&mgr.mutex);
-		con_unset_flag(con, FLAG_WORK_ACTIVE);
-		/* con may be xfree()ed any time once lock is released */
-
-		EVENT_SIGNAL(&mgr.watch_sleep);
+		release_work_con(con);
 		slurm_mutex_unlock(&mgr.mutex);
 	}
-
-	work->magic = ~MAGIC_WORK;
-	xfree(work);
 }
 
 /*
- * Add work to mgr.work
+ * Add work to be run by workers
  * Single point to enqueue internal function callbacks
- * NOTE: _handle_work_run() can add new entries to mgr.work
+ * NOTE: _handle_work_run() can add new entries to work queues
  *
  * IN work - pointer to work to run
  * NOTE: never add a thread that will never return or conmgr_fini() will never
@@ -214,10 +226,10 @@ static void _handle_work_run(work_t *work)
 	xassert(work->magic == MAGIC_WORK);
 
 	_log_work(work, __func__, "Enqueueing work. work:%u",
-		  list_count(mgr.work));
+		  WORKERS_QUEUED());
 
-	/* add to work list and signal a thread if watch is active */
-	list_append(mgr.work, work);
+	/* add to work queue and signal a thread if watch is active */
+	workers_queue_work(work);
 
 	if (!mgr.quiesced)
 		EVENT_SIGNAL(&mgr.worker_sleep);
@@ -44,12 +44,30 @@
 #include "src/conmgr/events.h"
 #include "src/conmgr/mgr.h"
 
+/*
+ * Work queued by a worker is added to that worker's own queue while work from
+ * any other thread is added to mgr.work. Workers look for work in their own
+ * queue, then mgr.work and then steal from the other workers' queues. None of
+ * that requires holding mgr.mutex which is only taken to sleep when there is
+ * no work and once after running work to update the connection state.
+ *
+ * Connection serialization is unchanged as watch() only queues work for a
+ * connection when no other work is active for that connection.
+ */
+
+/* Worker of the current thread or NULL if not a worker */
+static __thread worker_t *current_worker = NULL;
+/* Rotating offset for where workers start looking for work to steal */
+static int next_steal = 0;
+
 static void *_worker(void *arg);
 
 static void _check_magic_workers(void)
 {
 	xassert(mgr.workers.workers);
+	xassert(mgr.workers.array);
 	xassert(mgr.workers.active >= 0);
+	xassert(mgr.workers.queued >= 0);
 }
 
 static void _check_magic_worker(worker_t *worker)
@@ -57,12 +75,9 @@ static void _check_magic_worker(worker_t *worker)
 	xassert(worker);
 	xassert(worker->magic == MAGIC_WORKER);
 	xassert(worker->id > 0);
+	xassert(worker->work);
 }
 
-static int _find_worker(void *x, void *arg)
-{
-	return (x == arg);
-}
 static void _worker_free(void *x)
 {
 	worker_t *worker = x;
@@ -74,29 +89,25 @@ static void _worker_free(void *x)
 
 	log_flag(CONMGR, "%s: [%u] free worker", __func__, worker->id);
 
+	xassert(list_is_empty(worker->work));
+	FREE_NULL_LIST(worker->work);
 	worker->magic = ~MAGIC_WORKER;
 	xfree(worker);
 }
 
-/* caller must own mgr.mutex lock */
-static void _worker_delete(void *x)
-{
-	worker_t *worker = x;
-
-	if (!worker)
-		return;
-
-	/* list_delete_first calls _worker_free() */
-	list_delete_first(mgr.workers.workers, _find_worker, worker);
-	mgr.workers.total--;
-}
-
 static void _increase_thread_count(int count)
 {
 	for (int i = 0; i < count; i++) {
 		worker_t *worker = xmalloc(sizeof(*worker));
 		worker->magic = MAGIC_WORKER;
-		worker->id = i + 1;
+		worker->id = mgr.workers.array_count + 1;
+		worker->work = list_create(NULL);
+
+		/* Worker must be visible before other workers look for it */
+		mgr.workers.array[mgr.workers.array_count] = worker;
+		__atomic_store_n(&mgr.workers.array_count,
+				 (mgr.workers.array_count + 1),
+				 __ATOMIC_RELEASE);
 
 		slurm_thread_create(&worker->tid, _worker, worker);
 		_check_magic_worker(worker);
@@ -139,6 +150,10 @@ extern void workers_init(int count)
 	log_flag(CONMGR, "%s: Initializing with %d workers", __func__, count);
 	xassert(!mgr.workers.workers);
 	mgr.workers.workers = list_create(_worker_free);
+	/* Array is never resized to avoid locking while stealing work */
+	mgr.workers.array = xcalloc(CONMGR_THREAD_COUNT_MAX,
+				    sizeof(*mgr.workers.array));
+	mgr.workers.array_count = 0;
 	mgr.workers.threads = count;
 
 	_check_magic_workers();
@@ -153,49 +168,138 @@ extern void workers_fini(void)
 	xassert(mgr.workers.shutdown_requested);
 	xassert(!mgr.workers.active);
 	xassert(!mgr.workers.total);
+	xassert(!mgr.workers.queued);
 
 	FREE_NULL_LIST(mgr.workers.workers);
+	xfree(mgr.workers.array);
+	mgr.workers.array_count = 0;
 
 	mgr.workers.threads = 0;
 }
 
+extern void workers_queue_work(work_t *work)
+{
+	worker_t *worker = current_worker;
+
+	xassert(work->magic == MAGIC_WORK);
+
+	/* Keep work queued by a worker local to it unless stolen */
+	if (worker && (worker->magic == MAGIC_WORKER))
+		list_append(worker->work, work);
+	else
+		list_append(mgr.work, work);
+
+	__atomic_add_fetch(&mgr.workers.queued, 1, __ATOMIC_SEQ_CST);
+}
+
+/* Pop next work from own queue, mgr.work or steal from other workers */
+static work_t *_pop_work(worker_t *worker)
+{
+	const int count =
+		__atomic_load_n(&mgr.workers.array_count, __ATOMIC_ACQUIRE);
+	work_t *work = NULL;
+	int start;
+
+	if ((work = list_pop(worker->work)) || (work = list_pop(mgr.work)))
+		goto found;
+
+	/* Spread out thieves to avoid all contending on the same queue */
+	start = __atomic_add_fetch(&next_steal, 1, __ATOMIC_RELAXED);
+
+	for (int i = 0; i < count; i++) {
+		worker_t *victim = mgr.workers.array[(start + i) % count];
+
+		if ((victim == worker) || !(work = list_pop(victim->work)))
+			continue;
+
+		log_flag(CONMGR, "%s: [%u] stole %s() from worker %u",
+			 __func__, worker->id, work->callback.func_name,
+			 victim->id);
+		goto found;
+	}
+
+	return NULL;
+
+found:
+	xassert(work->magic == MAGIC_WORK);
+	__atomic_sub_fetch(&mgr.workers.queued, 1, __ATOMIC_SEQ_CST);
+	return work;
+}
+
+/*
+ * Release active worker status
+ * NOTE: caller must hold mgr.mutex lock
+ */
+static void _release_active(void)
+{
+	xassert(mgr.workers.active > 0);
+	__atomic_sub_fetch(&mgr.workers.active, 1, __ATOMIC_SEQ_CST);
+
+	/* wake up watch for all ending work on shutdown */
+	if (mgr.shutdown_requested || mgr.waiting_on_work)
+		EVENT_SIGNAL(&mgr.watch_sleep);
+}
+
 static void *_worker(void *arg)
 {
 	worker_t *worker = arg;
 	_check_magic_worker(worker);
 
+	current_worker = worker;
+
+	/* Wait for conmgr_init() to release lock to ensure mgr.work exists */
 	slurm_mutex_lock(&mgr.mutex);
 	mgr.workers.total++;
+	slurm_mutex_unlock(&mgr.mutex);
+
 	/*
-	 * mgr.mutex should be locked at the beginning of this loop. It should
-	 * also be locked when exiting the loop. It may be unlocked and
-	 * relocked during the loop.
+	 * mgr.mutex is not locked at the beginning of this loop. It is only
+	 * locked when there is no work to run or after work has been run.
 	 */
 	while (true) {
+		conmgr_fd_t *con = NULL;
 		work_t *work = NULL;
 
-		if (!mgr.quiesced)
-			work = list_pop(mgr.work);
+		/*
+		 * Mark worker active before checking quiesced to ensure
+		 * watch() will either see this worker as active or this worker
+		 * will see mgr.quiesced set.
+		 */
+		__atomic_add_fetch(&mgr.workers.active, 1, __ATOMIC_SEQ_CST);
+
+		if (!__atomic_load_n(&mgr.quiesced, __ATOMIC_SEQ_CST))
+			work = _pop_work(worker);
 
 		/* wait for work if nothing to do */
 		if (!work) {
+			slurm_mutex_lock(&mgr.mutex);
+			_release_active();
+
+			if (!mgr.quiesced && WORKERS_QUEUED()) {
+				/* work was queued while looking */
+				slurm_mutex_unlock(&mgr.mutex);
+				continue;
+			}
+
 			if (mgr.workers.shutdown_requested) {
 				log_flag(CONMGR, "%s: [%u] shutting down",
 					 __func__, worker->id);
-				_worker_delete(worker);
+				mgr.workers.total--;
 				break;
 			}
 
 			log_flag(CONMGR, "%s: [%u] waiting for work. Current active workers %u/%u",
-				 __func__, worker->id, mgr.workers.active,
+				 __func__, worker->id, WORKERS_ACTIVE(),
 				 mgr.workers.total);
 			EVENT_WAIT(&mgr.worker_sleep, &mgr.mutex);
+			slurm_mutex_unlock(&mgr.mutex);
 			continue;
 		}
 
 		xassert(work->magic == MAGIC_WORK);
 
-		if (mgr.shutdown_requested) {
+		if (__atomic_load_n(&mgr.shutdown_requested,
+				    __ATOMIC_RELAXED)) {
 			log_flag(CONMGR, "%s: [%u->%s] setting work status as cancelled after shutdown requested",
 				 __func__, worker->id,
 				 work->callback.func_name);
@@ -203,34 +307,30 @@ static void *_worker(void *arg)
 		}
 
 		/* got work, run it! */
-		mgr.workers.active++;
-
 		log_flag(CONMGR, "%s: [%u] %s() running active_workers=%u/%u queue=%u",
 			 __func__, worker->id, work->callback.func_name,
-			 mgr.workers.active, mgr.workers.total,
-			 list_count(mgr.work));
-
-		/* Unlock mutex before running work */
-		slurm_mutex_unlock(&mgr.mutex);
+			 WORKERS_ACTIVE(), mgr.workers.total, WORKERS_QUEUED());
 
-		/* run work via wrap_work() which will xfree(work) */
-		wrap_work(work);
+		/* run work via run_work() which will xfree(work) */
+		con = run_work(work);
 		work = NULL;
 
 		/* Lock mutex after running work */
 		slurm_mutex_lock(&mgr.mutex);
 
-		mgr.workers.active--;
+		if (con)
+			release_work_con(con);
+
+		_release_active();
 
 		log_flag(CONMGR, "%s: [%u] finished active_workers=%u/%u queue=%u",
-			 __func__, worker->id, mgr.workers.active,
-			 mgr.workers.total, list_count(mgr.work));
+			 __func__, worker->id, WORKERS_ACTIVE(),
+			 mgr.workers.total, WORKERS_QUEUED());
 
-		/* wake up watch for all ending work on shutdown */
-		if (mgr.shutdown_requested || mgr.waiting_on_work)
-			EVENT_SIGNAL(&mgr.watch_sleep);
+		slurm_mutex_unlock(&mgr.mutex);
 	}
 
+	current_worker = NULL;
 	EVENT_SIGNAL(&mgr.worker_return);
 	slurm_mutex_unlock(&mgr.mutex);
 	return NULL;
@@ -238,9 +338,9 @@ static void *_worker(void *arg)
 
 extern void wait_for_workers_idle(const char *caller)
 {
-	while (mgr.workers.active > 0) {
+	while (WORKERS_ACTIVE() > 0) {
 		log_flag(CONMGR, "%s->%s: waiting for workers=%u/%u",
-			 caller, __func__, mgr.workers.active,
+			 caller, __func__, WORKERS_ACTIVE(),
 			 mgr.workers.total);
 
 		EVENT_WAIT(&mgr.worker_return, &mgr.mutex);
@@ -253,7 +353,7 @@ extern void workers_shutdown(void)
 
 	do {
 		log_flag(CONMGR, "%s: waiting for work=%u workers=%u/%u",
-			 __func__, list_count(mgr.work), mgr.workers.active,
+			 __func__, WORKERS_QUEUED(), WORKERS_ACTIVE(),
 			 mgr.workers.total);
 
 		if (mgr.workers.total > 0) {
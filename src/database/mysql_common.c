@@ -49,6 +49,7 @@
 #include "src/common/read_config.h"
 
 #define MAX_DEADLOCK_ATTEMPTS 10
+#define DEFAULT_REPLICA_MAX_LAG 30
 
 static char *table_defs_table = "table_defs_table";
 
@@ -69,6 +70,32 @@ static void _destroy_db_key(void *arg)
 	}
 }
 
+typedef struct {
+	char *query;
+	MYSQL_STMT *stmt;
+} db_stmt_t;
+
+static void _destroy_db_stmt(void *arg)
+{
+	db_stmt_t *db_stmt = arg;
+
+	if (db_stmt) {
+		if (db_stmt->stmt)
+			mysql_stmt_close(db_stmt->stmt);
+		xfree(db_stmt->query);
+		xfree(db_stmt);
+	}
+}
+
+static int _find_db_stmt(void *x, void *key)
+{
+	db_stmt_t *db_stmt = x;
+
+	if (xstrcmp(db_stmt->query, key))
+		return 0;
+	return 1;
+}
+
 static int _find_db_key(void *x, void *key)
 {
 	db_key_t * db_key = (db_key_t *) x;
@@ -718,6 +745,9 @@ void _set_mysql_ssl_opts(MYSQL *db_conn, const char *options)
 			key = val_str;
 		else if (!xstrcasecmp(opt_str, "SSL_CIPHER"))
 			cipher = val_str;
+		else if (!xstrcasecmp(opt_str, "REPLICA_HOST") ||
+			 !xstrcasecmp(opt_str, "REPLICA_MAX_LAG"))
+			; /* handled by _set_mysql_replica_opts() */
 		else {
 			error("Invalid storage option '%s'", opt_str);
 			goto next;
@@ -731,6 +761,35 @@ next:
 	xfree(tmp_opts);
 }
 
+static void _set_mysql_replica_opts(mysql_db_info_t *db_info)
+{
+	char *tmp_opts, *token, *save_ptr = NULL;
+
+	db_info->replica_max_lag = DEFAULT_REPLICA_MAX_LAG;
+
+	if (!db_info->params)
+		return;
+
+	tmp_opts = xstrdup(db_info->params);
+	token = strtok_r(tmp_opts, ",", &save_ptr);
+	while (token) {
+		char *opt_str, *val_str = NULL;
+
+		opt_str = strtok_r(token, "=", &val_str);
+
+		if (!opt_str || !val_str)
+			; /* reported by _set_mysql_ssl_opts() */
+		else if (!xstrcasecmp(opt_str, "REPLICA_HOST"))
+			db_info->replica = xstrdup(val_str);
+		else if (!xstrcasecmp(opt_str, "REPLICA_MAX_LAG"))
+			db_info->replica_max_lag = slurm_atoul(val_str);
+
+		token = strtok_r(NULL, ",", &save_ptr);
+	}
+
+	xfree(tmp_opts);
+}
+
 /* NOTE: Ensure that mysql_conn->lock is set on function entry */
 static int _create_db(char *db_name, mysql_db_info_t *db_info)
 {
@@ -805,6 +864,7 @@ extern mysql_conn_t *create_mysql_conn(int conn_num, bool rollback,
 	mysql_conn->wsrep_trx_fragment_size_orig = NO_VAL64;
 	slurm_mutex_init(&mysql_conn->lock);
 	mysql_conn->update_list = list_create(slurmdb_destroy_update_object);
+	mysql_conn->stmt_list = list_create(_destroy_db_stmt);
 
 	return mysql_conn;
 }
@@ -817,6 +877,7 @@ extern int destroy_mysql_conn(mysql_conn_t *mysql_conn)
 		xfree(mysql_conn->cluster_name);
 		slurm_mutex_destroy(&mysql_conn->lock);
 		FREE_NULL_LIST(mysql_conn->update_list);
+		FREE_NULL_LIST(mysql_conn->stmt_list);
 		xfree(mysql_conn->wsrep_trx_fragment_unit_orig);
 		xfree(mysql_conn);
 	}
@@ -837,6 +898,7 @@ extern mysql_db_info_t *create_mysql_db_info(slurm_mysql_plugin_type_t type)
 		db_info->user = xstrdup(slurm_conf.accounting_storage_user);
 		db_info->pass = xstrdup(slurm_conf.accounting_storage_pass);
 		db_info->params = xstrdup(slurm_conf.accounting_storage_params);
+		_set_mysql_replica_opts(db_info);
 		break;
 	case SLURM_MYSQL_PLUGIN_JC:
 		if (!slurm_conf.job_comp_port)
@@ -861,6 +923,7 @@ extern int destroy_mysql_db_info(mysql_db_info_t *db_info)
 		xfree(db_info->host);
 		xfree(db_info->user);
 		xfree(db_info->pass);
+		xfree(db_info->replica);
 		xfree(db_info);
 	}
 	return SLURM_SUCCESS;
@@ -878,6 +941,9 @@ extern int mysql_db_get_db_connection(mysql_conn_t *mysql_conn, char *db_name,
 
 	slurm_mutex_lock(&mysql_conn->lock);
 
+	/* Statements prepared on an old connection are no longer valid */
+	list_flush(mysql_conn->stmt_list);
+
 	if (!(mysql_conn->db_conn = mysql_init(mysql_conn->db_conn))) {
 		slurm_mutex_unlock(&mysql_conn->lock);
 		fatal("mysql_init failed: %s",
@@ -953,6 +1019,8 @@ extern int mysql_db_close_db_connection(mysql_conn_t *mysql_conn)
 {
 	slurm_mutex_lock(&mysql_conn->lock);
 	if (mysql_conn && mysql_conn->db_conn) {
+		/* statements must be closed before their connection */
+		list_flush(mysql_conn->stmt_list);
 		if (mysql_thread_safe())
 			mysql_thread_end();
 		mysql_close(mysql_conn->db_conn);
@@ -1248,6 +1316,113 @@ extern int mysql_db_get_var_u64(mysql_conn_t *mysql_conn,
 	return SLURM_SUCCESS;
 }
 
+extern int mysql_db_get_replica_lag(mysql_conn_t *mysql_conn, uint64_t *lag)
+{
+	/* MySQL 8.4 dropped the old syntax, MariaDB < 10.5 lacks the new one */
+	static bool use_slave_syntax = false;
+	char *query;
+	MYSQL_RES *result;
+	MYSQL_FIELD *fields;
+	MYSQL_ROW row;
+	unsigned int i, num_fields;
+	int rc = SLURM_ERROR;
+
+	query = xstrdup(use_slave_syntax ?
+			"show slave status" : "show replica status");
+	if (!(result = mysql_db_query_ret(mysql_conn, query, 0)) &&
+	    !use_slave_syntax) {
+		use_slave_syntax = true;
+		xfree(query);
+		query = xstrdup("show slave status");
+		result = mysql_db_query_ret(mysql_conn, query, 0);
+	}
+	xfree(query);
+
+	if (!result)
+		return SLURM_ERROR;
+
+	if (!(row = mysql_fetch_row(result))) {
+		debug("%s: server is not replicating", __func__);
+		goto end_it;
+	}
+
+	num_fields = mysql_num_fields(result);
+	fields = mysql_fetch_fields(result);
+	for (i = 0; i < num_fields; i++) {
+		if (xstrcasecmp(fields[i].name, "Seconds_Behind_Source") &&
+		    xstrcasecmp(fields[i].name, "Seconds_Behind_Master"))
+			continue;
+		/* NULL means the replication threads are not running */
+		if (row[i]) {
+			*lag = slurm_atoull(row[i]);
+			rc = SLURM_SUCCESS;
+		}
+		break;
+	}
+
+end_it:
+	mysql_free_result(result);
+	return rc;
+}
+
+extern MYSQL_STMT *mysql_db_stmt_query(mysql_conn_t *mysql_conn,
+				       const char *query, MYSQL_BIND *params)
+{
+	db_stmt_t *db_stmt;
+	MYSQL_STMT *stmt = NULL;
+
+	if (!mysql_conn || !mysql_conn->db_conn) {
+		fatal("You haven't inited this storage yet.");
+		return NULL;	/* For CLANG false positive */
+	}
+
+	slurm_mutex_lock(&mysql_conn->lock);
+
+	/* clear out the old results so we don't get a 2014 error */
+	_clear_results(mysql_conn->db_conn);
+
+	if (!(db_stmt = list_find_first(mysql_conn->stmt_list, _find_db_stmt,
+					(void *) query))) {
+		db_stmt = xmalloc(sizeof(*db_stmt));
+		db_stmt->query = xstrdup(query);
+		if (!(db_stmt->stmt = mysql_stmt_init(mysql_conn->db_conn))) {
+			errno = mysql_errno(mysql_conn->db_conn);
+			error("mysql_stmt_init failed: %d %s",
+			      errno, mysql_error(mysql_conn->db_conn));
+			_destroy_db_stmt(db_stmt);
+			goto end_it;
+		}
+		if (mysql_stmt_prepare(db_stmt->stmt, query, strlen(query))) {
+			errno = mysql_stmt_errno(db_stmt->stmt);
+			error("mysql_stmt_prepare failed: %d %s\n%s",
+			      errno, mysql_stmt_error(db_stmt->stmt), query);
+			_destroy_db_stmt(db_stmt);
+			goto end_it;
+		}
+		list_append(mysql_conn->stmt_list, db_stmt);
+	}
+
+	if ((params && mysql_stmt_bind_param(db_stmt->stmt, params)) ||
+	    mysql_stmt_execute(db_stmt->stmt) ||
+	    mysql_stmt_store_result(db_stmt->stmt)) {
+		errno = mysql_stmt_errno(db_stmt->stmt);
+		error("mysql_stmt_execute failed: %d %s\n%s",
+		      errno, mysql_stmt_error(db_stmt->stmt), query);
+		/*
+		 * Drop the statement so the next call prepares it again,
+		 * e.g. after the table it refers to has been altered.
+		 */
+		list_delete_ptr(mysql_conn->stmt_list, db_stmt);
+		goto end_it;
+	}
+
+	stmt = db_stmt->stmt;
+	errno = 0;
+end_it:
+	slurm_mutex_unlock(&mysql_conn->lock);
+	return stmt;
+}
+
 extern void mysql_db_enable_streaming_replication(mysql_conn_t *mysql_conn)
 {
 	int rc = SLURM_SUCCESS;
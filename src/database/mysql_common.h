@@ -66,6 +66,7 @@ typedef struct {
 	pthread_mutex_t lock;
 	char *pre_commit_query;
 	list_t *update_list;
+	list_t *stmt_list; /* cached prepared statements, see mysql_db_stmt_* */
 	int conn;
 	uint64_t wsrep_trx_fragment_size_orig;
 	char *wsrep_trx_fragment_unit_orig;
@@ -78,6 +79,8 @@ typedef struct {
 	char *user;
 	char *params;
 	char *pass;
+	char *replica; /* read-only replica host, from StorageParameters */
+	uint32_t replica_max_lag; /* seconds a replica may fall behind */
 } mysql_db_info_t;
 
 typedef struct {
@@ -115,6 +118,30 @@ extern int mysql_db_get_var_str(mysql_conn_t *mysql_conn,
 extern int mysql_db_get_var_u64(mysql_conn_t *mysql_conn,
 	    			 const char *variable_name,
 			    	 uint64_t *value);
+
+/*
+ * Get how many seconds the server behind mysql_conn is behind its primary.
+ * RET SLURM_SUCCESS, or SLURM_ERROR if the server is not replicating.
+ */
+extern int mysql_db_get_replica_lag(mysql_conn_t *mysql_conn, uint64_t *lag);
+
+/*
+ * Execute a prepared statement for query, binding params as its input.
+ * Statements are prepared once per connection and cached by query string,
+ * so query should be built only from values that rarely change (cluster and
+ * table names) and use '?' placeholders for everything else.
+ *
+ * IN mysql_conn - connection to execute on
+ * IN query - statement text with '?' placeholders
+ * IN params - array of bindings, one per placeholder (may be NULL if none)
+ * RET executed statement with its result set buffered, or NULL on error.
+ *     The caller binds the result columns, fetches the rows and then must
+ *     call mysql_stmt_free_result() on it. The statement itself is owned by
+ *     the connection and must not be closed by the caller.
+ */
+extern MYSQL_STMT *mysql_db_stmt_query(mysql_conn_t *mysql_conn,
+				       const char *query, MYSQL_BIND *params);
+
 extern void mysql_db_enable_streaming_replication(mysql_conn_t *mysql_conn);
 extern void mysql_db_restore_streaming_replication(mysql_conn_t *mysql_conn);
 #endif
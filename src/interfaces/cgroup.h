@@ -299,6 +299,14 @@ extern int cgroup_g_step_suspend(void);
  */
 extern int cgroup_g_step_resume(void);
 
+/*
+ * SIGKILL every user process of the step at once, without walking its pids.
+ *
+ * RET SLURM_SUCCESS if operation was successful, ESLURM_NOT_SUPPORTED if the
+ *     plugin or kernel can't do it, SLURM_ERROR otherwise.
+ */
+extern int cgroup_g_step_kill(void);
+
 /*
  * If the caller (typically from a plugin) is the only one using this step
  * object, rmdir the controller's step directories and destroy the associated
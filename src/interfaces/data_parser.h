@@ -341,6 +341,12 @@ typedef enum {
 	DATA_PARSER_STATS_MSG_RPC_DUMP, /* STATS_MSG_RPC_DUMP_t */
 	DATA_PARSER_STATS_MSG_RPC_DUMP_PTR, /* STATS_MSG_RPC_DUMP_t* */
 	DATA_PARSER_STATS_MSG_RPCS_DUMP, /* stats_info_response_msg_t-> computed */
+	DATA_PARSER_STATS_MSG_SCHED_PHASE, /* STATS_MSG_SCHED_PHASE_t */
+	DATA_PARSER_STATS_MSG_SCHED_PHASE_PTR, /* STATS_MSG_SCHED_PHASE_t* */
+	DATA_PARSER_STATS_MSG_SCHED_PHASES, /* stats_info_response_msg_t-> computed */
+	DATA_PARSER_STATS_HISTORY, /* stats_history_t */
+	DATA_PARSER_STATS_HISTORY_PTR, /* stats_history_t* */
+	DATA_PARSER_STATS_MSG_HISTORY, /* stats_info_response_msg_t-> computed */
 	DATA_PARSER_BF_EXIT_FIELDS, /* bf_exit_fields_t */
 	DATA_PARSER_BF_EXIT_FIELDS_PTR, /* bf_exit_fields_t* */
 	DATA_PARSER_SCHEDULE_EXIT_FIELDS, /* schedule_exit_fields_t */
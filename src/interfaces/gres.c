@@ -5002,12 +5002,16 @@ static void *_node_state_dup(gres_node_state_t *gres_ns)
 							sizeof(bitstr_t *));
 		new_gres_ns->topo_res_core_bitmap = xcalloc(gres_ns->topo_cnt,
 							    sizeof(bitstr_t *));
-		new_gres_ns->topo_gres_cnt_alloc = xcalloc(gres_ns->topo_cnt,
-							   sizeof(uint64_t));
-		new_gres_ns->topo_gres_cnt_avail = xcalloc(gres_ns->topo_cnt,
-							   sizeof(uint64_t));
-		new_gres_ns->topo_type_id = xcalloc(gres_ns->topo_cnt,
-						    sizeof(uint32_t));
+		i = sizeof(uint64_t) * gres_ns->topo_cnt;
+		new_gres_ns->topo_gres_cnt_alloc = xmalloc(i);
+		memcpy(new_gres_ns->topo_gres_cnt_alloc,
+		       gres_ns->topo_gres_cnt_alloc, i);
+		new_gres_ns->topo_gres_cnt_avail = xmalloc(i);
+		memcpy(new_gres_ns->topo_gres_cnt_avail,
+		       gres_ns->topo_gres_cnt_avail, i);
+		i = sizeof(uint32_t) * gres_ns->topo_cnt;
+		new_gres_ns->topo_type_id = xmalloc(i);
+		memcpy(new_gres_ns->topo_type_id, gres_ns->topo_type_id, i);
 		new_gres_ns->topo_type_name = xcalloc(gres_ns->topo_cnt,
 						      sizeof(char *));
 		for (i = 0; i < gres_ns->topo_cnt; i++) {
@@ -5022,11 +5026,6 @@ static void *_node_state_dup(gres_node_state_t *gres_ns)
 			}
 			new_gres_ns->topo_gres_bitmap[i] =
 				bit_copy(gres_ns->topo_gres_bitmap[i]);
-			new_gres_ns->topo_gres_cnt_alloc[i] =
-				gres_ns->topo_gres_cnt_alloc[i];
-			new_gres_ns->topo_gres_cnt_avail[i] =
-				gres_ns->topo_gres_cnt_avail[i];
-			new_gres_ns->topo_type_id[i] = gres_ns->topo_type_id[i];
 			new_gres_ns->topo_type_name[i] =
 				xstrdup(gres_ns->topo_type_name[i]);
 		}
@@ -5034,20 +5033,17 @@ static void *_node_state_dup(gres_node_state_t *gres_ns)
 
 	if (gres_ns->type_cnt) {
 		new_gres_ns->type_cnt       = gres_ns->type_cnt;
-		new_gres_ns->type_cnt_alloc = xcalloc(gres_ns->type_cnt,
-						      sizeof(uint64_t));
-		new_gres_ns->type_cnt_avail = xcalloc(gres_ns->type_cnt,
-						      sizeof(uint64_t));
-		new_gres_ns->type_id = xcalloc(gres_ns->type_cnt,
-					       sizeof(uint32_t));
+		i = sizeof(uint64_t) * gres_ns->type_cnt;
+		new_gres_ns->type_cnt_alloc = xmalloc(i);
+		memcpy(new_gres_ns->type_cnt_alloc, gres_ns->type_cnt_alloc, i);
+		new_gres_ns->type_cnt_avail = xmalloc(i);
+		memcpy(new_gres_ns->type_cnt_avail, gres_ns->type_cnt_avail, i);
+		i = sizeof(uint32_t) * gres_ns->type_cnt;
+		new_gres_ns->type_id = xmalloc(i);
+		memcpy(new_gres_ns->type_id, gres_ns->type_id, i);
 		new_gres_ns->type_name = xcalloc(gres_ns->type_cnt,
 						 sizeof(char *));
 		for (i = 0; i < gres_ns->type_cnt; i++) {
-			new_gres_ns->type_cnt_alloc[i] =
-				gres_ns->type_cnt_alloc[i];
-			new_gres_ns->type_cnt_avail[i] =
-				gres_ns->type_cnt_avail[i];
-			new_gres_ns->type_id[i] = gres_ns->type_id[i];
 			new_gres_ns->type_name[i] =
 				xstrdup(gres_ns->type_name[i]);
 		}
@@ -5994,7 +5990,7 @@ static gres_state_t *_get_next_job_gres(char *in_val, uint64_t *cnt,
 		gres_js = gres_state_job->gres_data;
 	} else {
 		gres_js = xmalloc(sizeof(gres_job_state_t));
-		gres_js->type_id = gres_build_id(type);
+		gres_js->type_id = job_search_key.type_id;
 		gres_js->type_name = type;
 		type = NULL;	/* String moved above */
 
@@ -8675,7 +8671,7 @@ static gres_state_t *_get_next_step_gres(char *in_val, uint64_t *cnt,
 		gres_ss = gres_state_step->gres_data;
 	} else {
 		gres_ss = xmalloc(sizeof(gres_step_state_t));
-		gres_ss->type_id = gres_build_id(type);
+		gres_ss->type_id = step_search_key.type_id;
 		gres_ss->type_name = type;
 		type = NULL;	/* String moved above */
 		gres_state_step = gres_create_state(
@@ -52,6 +52,8 @@ typedef struct slurm_ops {
 	char		(*plugin_type);
 	int (*compute)	(char *input, int len, char *custom_str, int cs_len,
 			 slurm_hash_t *hash);
+	int (*compute_iov) (const struct iovec *iov, int iovcnt,
+			    char *custom_str, int cs_len, slurm_hash_t *hash);
 } slurm_ops_t;
 
 /*
@@ -62,6 +64,7 @@ static const char *syms[] = {
 	"plugin_id",
 	"plugin_type",
 	"hash_p_compute",
+	"hash_p_compute_iov",
 };
 
 /* Local variables */
@@ -182,3 +185,21 @@ extern int hash_g_compute(char *input, int len, char *custom_str, int cs_len,
 
 	return (*(ops[index].compute))(input, len, custom_str, cs_len, hash);
 }
+
+extern int hash_g_compute_iov(const struct iovec *iov, int iovcnt,
+			      char *custom_str, int cs_len, slurm_hash_t *hash)
+{
+	int index;
+
+	xassert(g_context);
+
+	if ((hash->type >= sizeof(hash_id_to_inx)) ||
+	    ((index = hash_id_to_inx[hash->type]) == 0xff)) {
+		error("%s: hash plugin with id:%u not exist or is not loaded",
+		      __func__, hash->type);
+		return -1;
+	}
+
+	return (*(ops[index].compute_iov))(iov, iovcnt, custom_str, cs_len,
+					   hash);
+}
@@ -36,6 +36,8 @@
 #ifndef _INTERFACES_HASH_H
 #define _INTERFACES_HASH_H
 
+#include <sys/uio.h>
+
 #include "slurm/slurm.h"
 
 extern int hash_g_init(void);
@@ -50,4 +52,11 @@ extern int hash_g_fini(void);
 extern int hash_g_compute(char *input, int len, char *custom_str, int cs_len,
 			  slurm_hash_t *hash);
 
+/*
+ * Compute the same hash as hash_g_compute() over the concatenation of iovcnt
+ * segments described by iov.
+ */
+extern int hash_g_compute_iov(const struct iovec *iov, int iovcnt,
+			      char *custom_str, int cs_len, slurm_hash_t *hash);
+
 #endif
@@ -198,6 +198,9 @@ extern int job_submit_g_submit(job_desc_msg_t *job_desc, uint32_t submit_uid,
 
 	slurm_rwlock_rdlock(&context_lock);
 	xassert(g_context_cnt >= 0);
+	/* Plugins may rewrite the script and environment in place */
+	if (g_context_cnt)
+		slurm_own_job_desc_strings(job_desc);
 	/*
 	 * NOTE: On function entry read locks are set on config, job, node and
 	 * partition structures. Do not attempt to unlock them and then
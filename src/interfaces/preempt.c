@@ -166,16 +166,26 @@ static int _add_preemptable_job(void *x, void *arg)
 	if (candidate->het_job_id && !candidate->het_job_list)
 		return 0;
 
-	if (_is_job_preempt_exempt(candidate, preemptor))
+	/*
+	 * Most of job_list is pending or finished, so drop anything that is
+	 * not running before asking the plugin or acct_policy about it.
+	 */
+	if (!candidate->het_job_list &&
+	    !IS_JOB_RUNNING(candidate) && !IS_JOB_SUSPENDED(candidate))
 		return 0;
+
 	/*
 	 * We have to check the entire bitmap space here before we can check
-	 * each part of a hetjob in _is_job_preempt_exempt()
+	 * each part of a hetjob in _is_job_preempt_exempt(). This is also far
+	 * cheaper than the exempt check, which takes the assoc_mgr QOS lock.
 	 */
 	if (!job_overlap_and_running(preemptor->part_ptr->node_bitmap,
 				     preemptor->license_list, candidate))
 		return 0;
 
+	if (_is_job_preempt_exempt(candidate, preemptor))
+		return 0;
+
 	/* This job is a preemption candidate */
 	if (!candidates->preemptee_job_list)
 		candidates->preemptee_job_list = list_create(NULL);
@@ -64,6 +64,10 @@ extern void priority_g_set_assoc_usage(slurmdb_assoc_rec_t *assoc);
 extern double priority_g_calc_fs_factor(long double usage_efctv,
 					long double shares_norm);
 
+/*
+ * Return a list of priority_factors_object_t the user may see, owned by the
+ * caller. Takes any locks needed itself, do not call with slurmctld locks held.
+ */
 extern list_t *priority_g_get_priority_factors_list(uid_t uid);
 
 /* Call at end of job to remove decayable limits at the end of the job
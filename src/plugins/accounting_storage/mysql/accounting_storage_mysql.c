@@ -120,6 +120,14 @@ const uint32_t plugin_version = SLURM_VERSION_NUMBER;
 static mysql_db_info_t *mysql_db_info = NULL;
 static char *mysql_db_name = NULL;
 
+/*
+ * Read-only replica used for heavy queries (REPLICA_HOST in
+ * StorageParameters). Idle connections to it are kept in replica_pool.
+ */
+static mysql_db_info_t *mysql_replica_info = NULL;
+static list_t *replica_pool = NULL;
+static pthread_mutex_t replica_pool_lock = PTHREAD_MUTEX_INITIALIZER;
+
 #define DELETE_SEC_BACK 86400
 
 char *acct_coord_table = "acct_coord_table";
@@ -1150,10 +1158,14 @@ extern int check_connection(mysql_conn_t *mysql_conn)
 		errno = ESLURM_DB_CONNECTION;
 		return ESLURM_DB_CONNECTION;
 	} else if (mysql_db_ping(mysql_conn) != 0) {
+		mysql_db_info_t *db_info =
+			(mysql_conn->flags & DB_CONN_FLAG_REPLICA) ?
+			mysql_replica_info : mysql_db_info;
+
 		/* avoid memory leak and end thread */
 		mysql_db_close_db_connection(mysql_conn);
 		if (mysql_db_get_db_connection(
-			    mysql_conn, mysql_db_name, mysql_db_info)
+			    mysql_conn, mysql_db_name, db_info)
 		    != SLURM_SUCCESS) {
 			error("unable to re-connect to as_mysql database");
 			errno = ESLURM_DB_CONNECTION;
@@ -1169,6 +1181,63 @@ extern int check_connection(mysql_conn_t *mysql_conn)
 	return SLURM_SUCCESS;
 }
 
+static void _replica_conn_put(mysql_conn_t *replica_conn)
+{
+	if (!replica_conn)
+		return;
+
+	slurm_mutex_lock(&replica_pool_lock);
+	list_push(replica_pool, replica_conn);
+	slurm_mutex_unlock(&replica_pool_lock);
+}
+
+/*
+ * Get a connection to the read replica to run a read-only query for
+ * mysql_conn on. Returns NULL if no replica is configured, it can not be
+ * reached, or it is further behind than REPLICA_MAX_LAG; the caller should
+ * then use mysql_conn itself.
+ */
+static mysql_conn_t *_replica_conn_get(mysql_conn_t *mysql_conn)
+{
+	mysql_conn_t *replica_conn;
+	uint64_t lag = 0;
+
+	if (!mysql_replica_info)
+		return NULL;
+
+	slurm_mutex_lock(&replica_pool_lock);
+	replica_conn = list_pop(replica_pool);
+	slurm_mutex_unlock(&replica_pool_lock);
+
+	if (!replica_conn) {
+		replica_conn = create_mysql_conn(mysql_conn->conn, false,
+						 mysql_conn->cluster_name);
+		replica_conn->flags |= DB_CONN_FLAG_REPLICA;
+		if (mysql_db_get_db_connection(replica_conn, mysql_db_name,
+					       mysql_replica_info)) {
+			destroy_mysql_conn(replica_conn);
+			return NULL;
+		}
+	} else if (check_connection(replica_conn) != SLURM_SUCCESS) {
+		destroy_mysql_conn(replica_conn);
+		return NULL;
+	} else {
+		replica_conn->conn = mysql_conn->conn;
+		xfree(replica_conn->cluster_name);
+		replica_conn->cluster_name = xstrdup(mysql_conn->cluster_name);
+	}
+
+	if (mysql_db_get_replica_lag(replica_conn, &lag) ||
+	    (lag > mysql_replica_info->replica_max_lag)) {
+		debug("%d replica %s is not usable (%"PRIu64" seconds behind), using primary",
+		      mysql_conn->conn, mysql_replica_info->host, lag);
+		_replica_conn_put(replica_conn);
+		return NULL;
+	}
+
+	return replica_conn;
+}
+
 /* Let me know if the last statement had rows that were affected.
  * This only gets called by a non-threaded connection, so there is no
  * need to worry about locks.
@@ -1257,7 +1326,8 @@ extern int create_cluster_assoc_table(
 				  ", primary key (id_assoc), "
 				  "unique index udex (user(42), acct(42), "
 				  "`partition`(42)), "
-				  "key lft (lft), key account (acct(42)))")
+				  "key lft (lft), key account (acct(42)), "
+				  "key lineage (lineage(191)))")
 	    == SLURM_ERROR)
 		return SLURM_ERROR;
 
@@ -2921,6 +2991,17 @@ extern int init(void)
 		sleep(5);
 	}
 
+	if (mysql_db_info->replica) {
+		mysql_replica_info = create_mysql_db_info(SLURM_MYSQL_PLUGIN_AS);
+		xfree(mysql_replica_info->host);
+		xfree(mysql_replica_info->backup);
+		mysql_replica_info->host = xstrdup(mysql_db_info->replica);
+		replica_pool = list_create((ListDelF) destroy_mysql_conn);
+		verbose("%s: sending read-only queries to replica %s when it is no more than %u seconds behind",
+			plugin_type, mysql_replica_info->host,
+			mysql_replica_info->replica_max_lag);
+	}
+
 	_check_mysql_concat_is_sane(mysql_conn);
 	_check_database_variables(mysql_conn);
 
@@ -2953,6 +3034,8 @@ extern int fini ( void )
 	FREE_NULL_LIST(as_mysql_total_cluster_list);
 	slurm_rwlock_unlock(&as_mysql_cluster_list_lock);
 	slurm_rwlock_destroy(&as_mysql_cluster_list_lock);
+	FREE_NULL_LIST(replica_pool);
+	destroy_mysql_db_info(mysql_replica_info);
 	destroy_mysql_db_info(mysql_db_info);
 	xfree(mysql_db_name);
 	xfree(default_qos_str);
@@ -3542,7 +3625,14 @@ extern int acct_storage_p_get_usage(mysql_conn_t *mysql_conn, uid_t uid,
 				    void *in, slurmdbd_msg_type_t type,
 				    time_t start, time_t end)
 {
-	return as_mysql_get_usage(mysql_conn, uid, in, type, start, end);
+	mysql_conn_t *replica_conn = _replica_conn_get(mysql_conn);
+	int rc;
+
+	rc = as_mysql_get_usage(replica_conn ? replica_conn : mysql_conn,
+				uid, in, type, start, end);
+	_replica_conn_put(replica_conn);
+
+	return rc;
 }
 
 extern int acct_storage_p_roll_usage(mysql_conn_t *mysql_conn,
@@ -3743,11 +3833,15 @@ extern list_t *jobacct_storage_p_get_jobs_cond(mysql_conn_t *mysql_conn,
 					       slurmdb_job_cond_t *job_cond)
 {
 	list_t *job_list = NULL;
+	mysql_conn_t *replica_conn;
 
 	if (check_connection(mysql_conn) != SLURM_SUCCESS) {
 		return NULL;
 	}
-	job_list = as_mysql_jobacct_process_get_jobs(mysql_conn, uid, job_cond);
+	replica_conn = _replica_conn_get(mysql_conn);
+	job_list = as_mysql_jobacct_process_get_jobs(
+		replica_conn ? replica_conn : mysql_conn, uid, job_cond);
+	_replica_conn_put(replica_conn);
 
 	return job_list;
 }
@@ -37,6 +37,7 @@
 \*****************************************************************************/
 
 #include <fcntl.h>
+#include <limits.h>
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <unistd.h>
@@ -5665,9 +5666,26 @@ extern int as_mysql_jobacct_process_archive_load(
 			     arch_rec->archive_file);
 			error_code = errno;
 		} else {
+			struct stat stat_buf;
+
+			/*
+			 * Size the buffer from the file up front, archive
+			 * files can be large and growing it one read at a
+			 * time means repeated reallocation of the whole file.
+			 */
 			data_allocated = BUF_SIZE + 1;
+			if (!fstat(state_fd, &stat_buf) &&
+			    (stat_buf.st_size > 0) &&
+			    (stat_buf.st_size < (INT_MAX - BUF_SIZE)))
+				data_allocated += stat_buf.st_size;
 			data = xmalloc_nz(data_allocated);
 			while (1) {
+				if ((data_size + BUF_SIZE + 1) >
+				    data_allocated) {
+					data_allocated += MAX(data_allocated,
+							      BUF_SIZE);
+					xrealloc_nz(data, data_allocated);
+				}
 				data_read = read(state_fd, &data[data_size],
 						 BUF_SIZE);
 				if (data_read < 0) {
@@ -5683,9 +5701,7 @@ extern int as_mysql_jobacct_process_archive_load(
 				data[data_size + data_read] = '\0';
 				if (data_read == 0)	/* eof */
 					break;
-				data_size      += data_read;
-				data_allocated += data_read;
-				xrealloc_nz(data, data_allocated);
+				data_size += data_read;
 			}
 			close(state_fd);
 		}
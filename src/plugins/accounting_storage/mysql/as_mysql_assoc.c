@@ -917,6 +917,77 @@ static int _set_lineage(mysql_conn_t *mysql_conn, slurmdb_assoc_rec_t *assoc,
 	return rc;
 }
 
+/*
+ * Rebase the lineage of everything below a moved account in a single
+ * statement instead of walking the subtree one association at a time. The
+ * left() comparison keeps '_' or '%' in account names from widening the like
+ * match, which is only there so the lineage index can be used.
+ *
+ * The rebased associations are sent to the assoc_mgr as well. If
+ * skip_children is set the direct children are left out as the caller already
+ * sent them.
+ */
+static int _move_sub_lineages(mysql_conn_t *mysql_conn, char *cluster,
+			      uint32_t id, char *old_lineage, char *new_lineage,
+			      bool skip_children)
+{
+	MYSQL_RES *result = NULL;
+	MYSQL_ROW row;
+	char *query = NULL, *query_pos = NULL;
+	int old_len, rc;
+
+	xassert(cluster);
+
+	if (!old_lineage || !new_lineage || !xstrcmp(old_lineage, new_lineage))
+		return SLURM_SUCCESS;
+
+	old_len = strlen(old_lineage);
+
+	query = xstrdup_printf("update \"%s_%s\" set lineage=concat('%s', substring(lineage, %d)) where id_assoc!=%u && lineage like '%s%%' && left(lineage, %d)='%s';",
+			       cluster, assoc_table, new_lineage, old_len + 1,
+			       id, old_lineage, old_len, old_lineage);
+	DB_DEBUG(DB_ASSOC, mysql_conn->conn, "query\n%s", query);
+	rc = mysql_db_query(mysql_conn, query);
+	xfree(query);
+	if (rc != SLURM_SUCCESS)
+		return rc;
+
+	old_len = strlen(new_lineage);
+	xstrfmtcatat(query, &query_pos,
+		     "select id_assoc, lineage from \"%s_%s\" where deleted=0 && id_assoc!=%u && lineage like '%s%%' && left(lineage, %d)='%s'",
+		     cluster, assoc_table, id, new_lineage, old_len,
+		     new_lineage);
+	if (skip_children)
+		xstrfmtcatat(query, &query_pos, " && id_parent!=%u", id);
+	xstrcatat(query, &query_pos, " order by lineage;");
+
+	DB_DEBUG(DB_ASSOC, mysql_conn->conn, "query\n%s", query);
+	if (!(result = mysql_db_query_ret(mysql_conn, query, 0))) {
+		xfree(query);
+		return SLURM_ERROR;
+	}
+	xfree(query);
+
+	while ((row = mysql_fetch_row(result))) {
+		slurmdb_assoc_rec_t *mod_assoc =
+			xmalloc(sizeof(slurmdb_assoc_rec_t));
+
+		slurmdb_init_assoc_rec(mod_assoc, 0);
+		mod_assoc->id = slurm_atoul(row[0]);
+		mod_assoc->cluster = xstrdup(cluster);
+		mod_assoc->lineage = xstrdup(row[1]);
+		if (addto_update_list(mysql_conn->update_list,
+				      SLURMDB_MODIFY_ASSOC,
+				      mod_assoc) != SLURM_SUCCESS) {
+			error("couldn't add to the update list");
+			slurmdb_destroy_assoc_rec(mod_assoc);
+		}
+	}
+	mysql_free_result(result);
+
+	return SLURM_SUCCESS;
+}
+
 /*
  * Used to get all the associations in a lineage.  This is just
  * to send the assoc_mgr all the associations that are being modified from
@@ -955,6 +1026,7 @@ static int _modify_child_assocs(mysql_conn_t *mysql_conn,
 		"def_qos_id",
 		"qos",
 		"delta_qos",
+		"lineage",
 	};
 
 	enum {
@@ -976,6 +1048,7 @@ static int _modify_child_assocs(mysql_conn_t *mysql_conn,
 		ASSOC_DEF_QOS,
 		ASSOC_QOS,
 		ASSOC_DELTA_QOS,
+		ASSOC_LINEAGE,
 		ASSOC_COUNT
 	};
 
@@ -1150,28 +1223,51 @@ static int _modify_child_assocs(mysql_conn_t *mysql_conn,
 			}
 		}
 
-		if (moved_parent) {
-			char *use_parent;
-
-			if (row[ASSOC_USER][0])
-				use_parent = row[ASSOC_ACCT];
-			else if (!xstrcmp(row[ASSOC_ACCT], new_parent))
-				use_parent = old_parent;
-			else
-				use_parent = row[ASSOC_PACCT];
-
+		if (moved_parent && !row[ASSOC_USER][0] &&
+		    !xstrcmp(row[ASSOC_ACCT], new_parent)) {
 			/*
-			 * Now set lineage on all of the associations related
-			 * set_lineage() sets mod_time as well.
+			 * This child is becoming the new parent so move it
+			 * (and everything below it) up to the old parent.
 			 */
-			rc = _set_lineage(mysql_conn, mod_assoc, use_parent,
-					  row[ASSOC_ACCT], row[ASSOC_USER],
-					  row[ASSOC_PART]);
+			rc = _set_lineage(mysql_conn, mod_assoc, old_parent,
+					  row[ASSOC_ACCT], NULL, NULL);
+			if (rc == SLURM_SUCCESS)
+				rc = _move_sub_lineages(mysql_conn,
+							assoc->cluster,
+							mod_assoc->id,
+							row[ASSOC_LINEAGE],
+							mod_assoc->lineage,
+							false);
 			if (rc != SLURM_SUCCESS) {
 				slurmdb_destroy_assoc_rec(mod_assoc);
 				break;
 			}
 			modified = 1;
+		} else if (moved_parent && !handle_child_parent) {
+			int lineage_len = strlen(lineage);
+
+			/*
+			 * The parent already has its new lineage, so just swap
+			 * the prefix here. The database side is rebased for the
+			 * whole subtree at once by _move_sub_lineages().
+			 */
+			if (row[ASSOC_LINEAGE] &&
+			    !xstrncmp(row[ASSOC_LINEAGE], lineage,
+				      lineage_len)) {
+				mod_assoc->parent_id = assoc->id;
+				mod_assoc->lineage = xstrdup_printf(
+					"%s%s", assoc->lineage,
+					row[ASSOC_LINEAGE] + lineage_len);
+			} else if ((rc = _set_lineage(
+					    mysql_conn, mod_assoc,
+					    row[ASSOC_USER][0] ?
+					    row[ASSOC_ACCT] : row[ASSOC_PACCT],
+					    row[ASSOC_ACCT], row[ASSOC_USER],
+					    row[ASSOC_PART])) != SLURM_SUCCESS) {
+				slurmdb_destroy_assoc_rec(mod_assoc);
+				break;
+			}
+			modified = 1;
 		}
 
 		/* We only want to add those that are modified here */
@@ -1871,6 +1967,13 @@ static int _process_modify_assoc_results(mysql_conn_t *mysql_conn,
 					     row[MASSOC_PACCT],
 					     assoc->parent_acct,
 					     false);
+			if (moved_parent)
+				rc = _move_sub_lineages(mysql_conn,
+							cluster_name,
+							mod_assoc->id,
+							row[MASSOC_LINEAGE],
+							mod_assoc->lineage,
+							true);
 		} else if ((assoc->is_def == 1) && row[MASSOC_USER][0]) {
 			/* Use fresh one here so we don't have to
 			   worry about dealing with bad values.
@@ -98,23 +98,39 @@ static char *_average_tres_usage(uint32_t *tres_ids, uint64_t *tres_cnts,
 static uint64_t _get_db_index(mysql_conn_t *mysql_conn,
 			      time_t submit, uint32_t jobid)
 {
-	MYSQL_RES *result = NULL;
-	MYSQL_ROW row;
+	MYSQL_STMT *stmt;
+	MYSQL_BIND params[2], result;
+	int32_t submit_int = (int32_t) submit;
 	uint64_t db_index = 0;
-	char *query = xstrdup_printf("select job_db_inx from \"%s_%s\" where "
-				     "time_submit=%d and id_job=%u",
-				     mysql_conn->cluster_name, job_table,
-				     (int)submit, jobid);
+	char *query;
 
-	if (!(result = mysql_db_query_ret(mysql_conn, query, 0))) {
-		xfree(query);
-		return 0;
-	}
+	/*
+	 * This lookup runs for every step and job update that arrives before
+	 * the db_index is known, so use a cached prepared statement instead
+	 * of having the server parse a new query each time.
+	 */
+	memset(params, 0, sizeof(params));
+	params[0].buffer_type = MYSQL_TYPE_LONG;
+	params[0].buffer = &submit_int;
+	params[1].buffer_type = MYSQL_TYPE_LONG;
+	params[1].buffer = &jobid;
+	params[1].is_unsigned = true;
+
+	query = xstrdup_printf("select job_db_inx from \"%s_%s\" where "
+			       "time_submit=? and id_job=?",
+			       mysql_conn->cluster_name, job_table);
+	stmt = mysql_db_stmt_query(mysql_conn, query, params);
 	xfree(query);
+	if (!stmt)
+		return 0;
 
-	row = mysql_fetch_row(result);
-	if (!row) {
-		mysql_free_result(result);
+	memset(&result, 0, sizeof(result));
+	result.buffer_type = MYSQL_TYPE_LONGLONG;
+	result.buffer = &db_index;
+	result.is_unsigned = true;
+
+	if (mysql_stmt_bind_result(stmt, &result) || mysql_stmt_fetch(stmt)) {
+		mysql_stmt_free_result(stmt);
 		debug4("We can't get a db_index for this combo, "
 		       "time_submit=%d and id_job=%u.  "
 		       "We must not have heard about the start yet, "
@@ -122,8 +138,7 @@ static uint64_t _get_db_index(mysql_conn_t *mysql_conn,
 		       (int)submit, jobid);
 		return 0;
 	}
-	db_index = slurm_atoull(row[0]);
-	mysql_free_result(result);
+	mysql_stmt_free_result(stmt);
 
 	return db_index;
 }
@@ -42,6 +42,7 @@
 #include "as_mysql_archive.h"
 #include "src/common/parse_time.h"
 #include "src/common/slurm_time.h"
+#include "src/common/xhash.h"
 
 enum {
 	TIME_ALLOC,
@@ -94,6 +95,13 @@ typedef struct {
 	double unused_wall;
 } local_resv_usage_t;
 
+typedef struct {
+	int cnt;
+	uint64_t db_inx;
+	time_t *end;
+	time_t *start;
+} local_suspend_usage_t;
+
 static void _destroy_local_tres_usage(void *object)
 {
 	local_tres_usage_t *a_usage = (local_tres_usage_t *)object;
@@ -131,6 +139,25 @@ static void _destroy_local_resv_usage(void *object)
 	}
 }
 
+static void _destroy_local_suspend_usage(void *object)
+{
+	local_suspend_usage_t *s_usage = object;
+	if (s_usage) {
+		xfree(s_usage->end);
+		xfree(s_usage->start);
+		xfree(s_usage);
+	}
+}
+
+static void _local_suspend_usage_id(void *item, const char **key,
+				    uint32_t *key_len)
+{
+	local_suspend_usage_t *s_usage = item;
+
+	*key = (const char *) &s_usage->db_inx;
+	*key_len = sizeof(s_usage->db_inx);
+}
+
 static int _find_loc_tres(void *x, void *key)
 {
 	local_tres_usage_t *loc_tres = (local_tres_usage_t *)x;
@@ -1241,6 +1268,57 @@ static int _setup_resv_usage(mysql_conn_t *mysql_conn,
 	return SLURM_SUCCESS;
 }
 
+/*
+ * Load the suspend records of every job suspended during this hour with a
+ * single query instead of one query per suspended job.
+ */
+static int _setup_suspend_usage(mysql_conn_t *mysql_conn,
+				char *cluster_name,
+				time_t curr_start,
+				time_t curr_end,
+				xhash_t *suspend_usage_hash)
+{
+	MYSQL_RES *result = NULL;
+	MYSQL_ROW row;
+	char *query;
+	local_suspend_usage_t *s_usage = NULL;
+
+	xhash_clear(suspend_usage_hash);
+
+	query = xstrdup_printf("select job_db_inx, time_start, time_end "
+			       "from \"%s_%s\" where "
+			       "(time_start < %ld && (time_end >= %ld "
+			       "|| time_end = 0)) "
+			       "order by job_db_inx, time_start",
+			       cluster_name, suspend_table,
+			       curr_end, curr_start);
+
+	DB_DEBUG(DB_USAGE, mysql_conn->conn, "query\n%s", query);
+	result = mysql_db_query_ret(mysql_conn, query, 0);
+	xfree(query);
+
+	if (!result)
+		return SLURM_ERROR;
+
+	while ((row = mysql_fetch_row(result))) {
+		uint64_t db_inx = slurm_atoull(row[0]);
+
+		if (!s_usage || (s_usage->db_inx != db_inx)) {
+			s_usage = xmalloc(sizeof(*s_usage));
+			s_usage->db_inx = db_inx;
+			xhash_add(suspend_usage_hash, s_usage);
+		}
+		xrecalloc(s_usage->start, s_usage->cnt + 1, sizeof(time_t));
+		xrecalloc(s_usage->end, s_usage->cnt + 1, sizeof(time_t));
+		s_usage->start[s_usage->cnt] = slurm_atoul(row[1]);
+		s_usage->end[s_usage->cnt] = slurm_atoul(row[2]);
+		s_usage->cnt++;
+	}
+	mysql_free_result(result);
+
+	return SLURM_SUCCESS;
+}
+
 static void _add_planned_time(local_cluster_usage_t *c_usage, time_t job_start,
 			      time_t job_eligible, uint32_t array_pending,
 			      uint32_t row_rcpu)
@@ -1306,7 +1384,7 @@ extern int as_mysql_hourly_rollup(mysql_conn_t *mysql_conn,
 	time_t now = time(NULL);
 	time_t curr_start = start;
 	time_t curr_end = curr_start + add_sec;
-	char *query = NULL;
+	char *query = NULL, *query_pos = NULL;
 	MYSQL_RES *result = NULL;
 	MYSQL_ROW row;
 	list_itr_t *a_itr = NULL;
@@ -1319,6 +1397,8 @@ extern int as_mysql_hourly_rollup(mysql_conn_t *mysql_conn,
 	list_t *qos_usage_list = list_create(_destroy_local_id_usage);
 	list_t *wckey_usage_list = list_create(_destroy_local_id_usage);
 	list_t *resv_usage_list = list_create(_destroy_local_resv_usage);
+	xhash_t *suspend_usage_hash = xhash_init(_local_suspend_usage_id,
+						 _destroy_local_suspend_usage);
 	uint16_t track_wckey = slurm_get_track_wckey();
 	local_cluster_usage_t *loc_c_usage = NULL;
 	local_cluster_usage_t *c_usage = NULL;
@@ -1361,29 +1441,12 @@ extern int as_mysql_hourly_rollup(mysql_conn_t *mysql_conn,
 		JOB_REQ_COUNT
 	};
 
-	char *suspend_req_inx[] = {
-		"time_start",
-		"time_end"
-	};
-	char *suspend_str = NULL;
-	enum {
-		SUSPEND_REQ_START,
-		SUSPEND_REQ_END,
-		SUSPEND_REQ_COUNT
-	};
-
 	i=0;
 	xstrfmtcat(job_str, "%s", job_req_inx[i]);
 	for(i=1; i<JOB_REQ_COUNT; i++) {
 		xstrfmtcat(job_str, ", %s", job_req_inx[i]);
 	}
 
-	i=0;
-	xstrfmtcat(suspend_str, "%s", suspend_req_inx[i]);
-	for(i=1; i<SUSPEND_REQ_COUNT; i++) {
-		xstrfmtcat(suspend_str, ", %s", suspend_req_inx[i]);
-	}
-
 	/* We need to figure out the dimensions of this cluster */
 	query = xstrdup_printf("select dimensions from %s where name='%s'",
 			       cluster_table, cluster_name);
@@ -1418,6 +1481,7 @@ extern int as_mysql_hourly_rollup(mysql_conn_t *mysql_conn,
 	while (curr_start < end) {
 		int last_id = -1;
 		int last_wckeyid = -1;
+		bool suspend_loaded = false;
 
 		DB_DEBUG(DB_USAGE, mysql_conn->conn,
 		         "%s curr hour is now %ld-%ld",
@@ -1496,36 +1560,31 @@ extern int as_mysql_hourly_rollup(mysql_conn_t *mysql_conn,
 			seconds = (row_end - row_start);
 
 			if (slurm_atoul(row[JOB_REQ_SUSPENDED])) {
-				MYSQL_RES *result2 = NULL;
-				MYSQL_ROW row2;
-				/* get the suspended time for this job */
-				query = xstrdup_printf(
-					"select %s from \"%s_%s\" where "
-					"(time_start < %ld && (time_end >= %ld "
-					"|| time_end = 0)) && job_db_inx=%s "
-					"order by time_start",
-					suspend_str, cluster_name,
-					suspend_table,
-					curr_end, curr_start,
-					row[JOB_REQ_DB_INX]);
-
-				debug4("%d(%s:%d) query\n%s",
-				       mysql_conn->conn, THIS_FILE,
-				       __LINE__, query);
-				if (!(result2 = mysql_db_query_ret(
-					      mysql_conn,
-					      query, 0))) {
-					rc = SLURM_ERROR;
-					mysql_free_result(result);
-					goto end_it;
+				local_suspend_usage_t *s_usage;
+				uint64_t db_inx =
+					slurm_atoull(row[JOB_REQ_DB_INX]);
+
+				if (!suspend_loaded) {
+					if ((rc = _setup_suspend_usage(
+						     mysql_conn, cluster_name,
+						     curr_start, curr_end,
+						     suspend_usage_hash))
+					    != SLURM_SUCCESS) {
+						mysql_free_result(result);
+						goto end_it;
+					}
+					suspend_loaded = true;
 				}
-				xfree(query);
-				while ((row2 = mysql_fetch_row(result2))) {
+
+				/* get the suspended time for this job */
+				s_usage = xhash_get(suspend_usage_hash,
+						    (char *) &db_inx,
+						    sizeof(db_inx));
+				for (int j = 0; s_usage && (j < s_usage->cnt);
+				     j++) {
 					int tot_time = 0;
-					time_t local_start = slurm_atoul(
-						row2[SUSPEND_REQ_START]);
-					time_t local_end = slurm_atoul(
-						row2[SUSPEND_REQ_END]);
+					time_t local_start = s_usage->start[j];
+					time_t local_end = s_usage->end[j];
 
 					if (!local_start)
 						continue;
@@ -1539,7 +1598,6 @@ extern int as_mysql_hourly_rollup(mysql_conn_t *mysql_conn,
 					if (tot_time > 0)
 						suspend_seconds += tot_time;
 				}
-				mysql_free_result(result2);
 			}
 
 			/*
@@ -1752,15 +1810,16 @@ extern int as_mysql_hourly_rollup(mysql_conn_t *mysql_conn,
 		   associations that could had run in the reservation
 		*/
 		query = NULL;
+		query_pos = NULL;
 		list_iterator_reset(r_itr);
 		while ((r_usage = list_next(r_itr))) {
 			list_itr_t *t_itr;
 			local_tres_usage_t *loc_tres;
 
-			xstrfmtcat(query, "update \"%s_%s\" set unused_wall=%f where id_resv=%u and time_start=%ld;",
-				   cluster_name, resv_table,
-				   r_usage->unused_wall, r_usage->id,
-				   r_usage->orig_start);
+			xstrfmtcatat(query, &query_pos, "update \"%s_%s\" set unused_wall=%f where id_resv=%u and time_start=%ld;",
+				     cluster_name, resv_table,
+				     r_usage->unused_wall, r_usage->id,
+				     r_usage->orig_start);
 
 			if (!r_usage->loc_tres ||
 			    !list_count(r_usage->loc_tres))
@@ -1962,7 +2021,6 @@ extern int as_mysql_hourly_rollup(mysql_conn_t *mysql_conn,
 	}
 end_it:
 	xfree(query);
-	xfree(suspend_str);
 	xfree(job_str);
 	_destroy_local_cluster_usage(c_usage);
 
@@ -1982,6 +2040,7 @@ end_it:
 	FREE_NULL_LIST(qos_usage_list);
 	FREE_NULL_LIST(wckey_usage_list);
 	FREE_NULL_LIST(resv_usage_list);
+	xhash_free(suspend_usage_hash);
 
 /* 	info("stop start %s", slurm_ctime2(&curr_start)); */
 /* 	info("stop end %s", slurm_ctime2(&curr_end)); */
@@ -40,6 +40,7 @@
 #include "src/common/slurm_xlator.h"
 
 #include "src/common/fd.h"
+#include "src/common/metrics.h"
 #include "src/common/slurmdbd_pack.h"
 #include "src/common/xstring.h"
 
@@ -47,7 +48,8 @@
 
 enum {
 	MAX_DBD_ACTION_DISCARD,
-	MAX_DBD_ACTION_EXIT
+	MAX_DBD_ACTION_EXIT,
+	MAX_DBD_ACTION_SPOOL
 };
 
 typedef struct {
@@ -77,6 +79,21 @@ static pthread_cond_t  slurmdbd_cond = PTHREAD_COND_INITIALIZER;
 
 static int max_dbd_msg_action = MAX_DBD_DEFAULT_ACTION;
 
+/*
+ * With max_dbd_msg_action=spool messages past MaxDBDMsgs are appended to
+ * DBD_SPOOL_FILE instead of being discarded. The spool always holds the
+ * newest messages, so once it is in use every new message goes there and
+ * the agent refills agent_list from it in order as the queue drains.
+ * Protected by agent_lock.
+ */
+#define DBD_SPOOL_FILE "dbd.spool"
+#define DBD_SPOOL_REFILL_MAX 10000
+static int spool_rfd = -1;
+static int spool_wfd = -1;
+static uint32_t spool_cnt = 0;
+static uint64_t *agent_queue_metric = NULL;
+static uint16_t spool_rpc_version = 0;
+
 static int _unpack_return_code(uint16_t rpc_version, buf_t *buffer)
 {
 	uint16_t msg_type = -1;
@@ -303,6 +320,59 @@ static buf_t *_load_dbd_rec(int fd)
 	return buffer;
 }
 
+/*
+ * Unpack and repack a saved message with SLURM_PROTOCOL_VERSION just so we
+ * keep things up to date. Consumes buffer, returns NULL on error.
+ */
+static buf_t *_repack_dbd_rec(buf_t *buffer, uint16_t rpc_version)
+{
+	persist_msg_t msg = {0};
+	int rc;
+
+	if (rpc_version == SLURM_PROTOCOL_VERSION)
+		return buffer;
+
+	set_buf_offset(buffer, 0);
+	rc = unpack_slurmdbd_msg(&msg, rpc_version, buffer);
+	FREE_NULL_BUFFER(buffer);
+	if (rc != SLURM_SUCCESS)
+		return NULL;
+
+	buffer = pack_slurmdbd_msg(&msg, SLURM_PROTOCOL_VERSION);
+	slurmdbd_free_msg(&msg);
+
+	return buffer;
+}
+
+/*
+ * Read the "VER%d" header record of a state or spool file.
+ * Returns the rpc_version or 0 on error.
+ */
+static uint16_t _load_dbd_ver(int fd)
+{
+	char *ver_str = NULL;
+	uint16_t rpc_version = 0;
+	buf_t *buffer;
+
+	if (!(buffer = _load_dbd_rec(fd)))
+		return 0;
+
+	/* This is set to the end of the buffer for send so we
+	   need to set it back to 0 */
+	set_buf_offset(buffer, 0);
+	safe_unpackstr(&ver_str, buffer);
+	debug3("Version string in dbd_state header is %s", ver_str);
+unpack_error:
+	FREE_NULL_BUFFER(buffer);
+	if (ver_str) {
+		/* get the version after VER */
+		rpc_version = slurm_atoul(ver_str + 3);
+		xfree(ver_str);
+	}
+
+	return rpc_version;
+}
+
 static void _load_dbd_state(void)
 {
 	char *dbd_fname = NULL;
@@ -321,61 +391,18 @@ static void _load_dbd_state(void)
 			error("Opening state save file %s: %m",
 			      dbd_fname);
 	} else {
-		char *ver_str = NULL;
+		rpc_version = _load_dbd_ver(fd);
 
-		buffer = _load_dbd_rec(fd);
-		if (buffer == NULL)
-			goto end_it;
-		/* This is set to the end of the buffer for send so we
-		   need to set it back to 0 */
-		set_buf_offset(buffer, 0);
-		safe_unpackstr(&ver_str, buffer);
-		debug3("Version string in dbd_state header is %s", ver_str);
-	unpack_error:
-		FREE_NULL_BUFFER(buffer);
-		buffer = NULL;
-		if (ver_str) {
-			/* get the version after VER */
-			rpc_version = slurm_atoul(ver_str + 3);
-			xfree(ver_str);
-		}
-
-		while (1) {
-			/* If the buffer was not the VER%d string it
-			   was an actual message so we don't want to
-			   skip it.
-			*/
-			if (!buffer)
-				buffer = _load_dbd_rec(fd);
-			if (buffer == NULL)
-				break;
-			if (rpc_version != SLURM_PROTOCOL_VERSION) {
-				/* unpack and repack with new
-				 * PROTOCOL_VERSION just so we keep
-				 * things up to date.
-				 */
-				persist_msg_t msg = {0};
-				int rc;
-				set_buf_offset(buffer, 0);
-				rc = unpack_slurmdbd_msg(
-					&msg, rpc_version, buffer);
-				FREE_NULL_BUFFER(buffer);
-				if (rc == SLURM_SUCCESS)
-					buffer = pack_slurmdbd_msg(
-						&msg, SLURM_PROTOCOL_VERSION);
-				else
-					buffer = NULL;
-			}
+		while ((buffer = _load_dbd_rec(fd))) {
+			buffer = _repack_dbd_rec(buffer, rpc_version);
 			if (!buffer) {
 				error("no buffer given");
 				continue;
 			}
 			list_enqueue(agent_list, buffer);
 			recovered++;
-			buffer = NULL;
 		}
 
-	end_it:
 		verbose("recovered %d pending RPCs", recovered);
 		(void) close(fd);
 	}
@@ -420,13 +447,187 @@ static int _save_dbd_rec(int fd, buf_t *buffer)
 	return SLURM_SUCCESS;
 }
 
+static int _write_dbd_ver(int fd)
+{
+	char curr_ver_str[10];
+	buf_t *buffer;
+	int rc;
+
+	snprintf(curr_ver_str, sizeof(curr_ver_str),
+		 "VER%d", SLURM_PROTOCOL_VERSION);
+	buffer = init_buf(strlen(curr_ver_str));
+	packstr(curr_ver_str, buffer);
+	rc = _save_dbd_rec(fd, buffer);
+	FREE_NULL_BUFFER(buffer);
+
+	return rc;
+}
+
+/*
+ * We do not want to store registration messages. If an admin puts in an
+ * incorrect cluster name we can get a deadlock unless they add the bogus
+ * cluster name to the accounting system.
+ */
+static bool _skip_save_dbd_rec(buf_t *buffer)
+{
+	uint16_t msg_type;
+	uint32_t offset = get_buf_offset(buffer);
+
+	if (offset < 2)
+		return true;
+	set_buf_offset(buffer, 0);
+	(void) unpack16(&msg_type, buffer);  /* checked by offset */
+	set_buf_offset(buffer, offset);
+
+	return (msg_type == DBD_REGISTER_CTLD);
+}
+
+static void _close_spool(bool remove)
+{
+	char *spool_fname = NULL;
+
+	if (spool_rfd >= 0)
+		(void) close(spool_rfd);
+	if (spool_wfd >= 0)
+		(void) close(spool_wfd);
+	spool_rfd = spool_wfd = -1;
+	spool_cnt = 0;
+
+	if (remove) {
+		xstrfmtcat(spool_fname, "%s/%s",
+			   slurm_conf.state_save_location, DBD_SPOOL_FILE);
+		(void) unlink(spool_fname);
+		xfree(spool_fname);
+	}
+}
+
+/*
+ * Open the spool file. If create is false only an existing spool left over
+ * from a previous slurmctld is opened.
+ */
+static int _open_spool(bool create)
+{
+	char *spool_fname = NULL;
+	buf_t *buffer = NULL;
+	int rc = SLURM_SUCCESS;
+
+	if (spool_wfd >= 0)
+		return SLURM_SUCCESS;
+
+	xstrfmtcat(spool_fname, "%s/%s", slurm_conf.state_save_location,
+		   DBD_SPOOL_FILE);
+	if (create)
+		spool_wfd = open(spool_fname,
+				 O_WRONLY | O_CREAT | O_TRUNC | O_APPEND |
+				 O_CLOEXEC, 0600);
+	else
+		spool_wfd = open(spool_fname, O_WRONLY | O_APPEND | O_CLOEXEC);
+	if (spool_wfd < 0) {
+		if (create || (errno != ENOENT))
+			error("Opening spool file %s: %m", spool_fname);
+		rc = SLURM_ERROR;
+		goto end_it;
+	}
+
+	if (create && (rc = _write_dbd_ver(spool_wfd)))
+		goto end_it;
+
+	if ((spool_rfd = open(spool_fname, O_RDONLY | O_CLOEXEC)) < 0) {
+		error("Opening spool file %s: %m", spool_fname);
+		rc = SLURM_ERROR;
+		goto end_it;
+	}
+	if (!(spool_rpc_version = _load_dbd_ver(spool_rfd))) {
+		error("Invalid header in spool file %s", spool_fname);
+		rc = SLURM_ERROR;
+		goto end_it;
+	}
+
+	if (!create) {
+		/* Count what a previous slurmctld left in the spool */
+		off_t offset = lseek(spool_rfd, 0, SEEK_CUR);
+
+		while ((buffer = _load_dbd_rec(spool_rfd))) {
+			FREE_NULL_BUFFER(buffer);
+			spool_cnt++;
+		}
+		(void) lseek(spool_rfd, offset, SEEK_SET);
+		verbose("recovered %u spooled RPCs", spool_cnt);
+	}
+
+end_it:
+	if (rc != SLURM_SUCCESS)
+		_close_spool(create);
+	xfree(spool_fname);
+	return rc;
+}
+
+/* Append a message to the spool, consumes buffer */
+static int _spool_dbd_rec(buf_t *buffer)
+{
+	int rc;
+
+	if ((rc = _open_spool(true)) == SLURM_SUCCESS) {
+		off_t size = lseek(spool_wfd, 0, SEEK_END);
+
+		if ((rc = _save_dbd_rec(spool_wfd, buffer)) == SLURM_SUCCESS)
+			spool_cnt++;
+		else if ((size >= 0) && ftruncate(spool_wfd, size))
+			error("%s: ftruncate: %m", __func__);
+	}
+	FREE_NULL_BUFFER(buffer);
+
+	return rc;
+}
+
+/* Read the next spooled message, NULL if the spool is exhausted */
+static buf_t *_unspool_dbd_rec(void)
+{
+	buf_t *buffer;
+
+	while (spool_cnt) {
+		spool_cnt--;
+		if (!(buffer = _load_dbd_rec(spool_rfd)))
+			break;
+		if ((buffer = _repack_dbd_rec(buffer, spool_rpc_version)))
+			return buffer;
+		error("no buffer given");
+	}
+
+	/* Everything has been read back, start over with an empty spool */
+	_close_spool(true);
+	return NULL;
+}
+
+/*
+ * Move spooled messages back into agent_list as room frees up. This is done
+ * with agent_lock held so only read back DBD_SPOOL_REFILL_MAX at a time.
+ */
+static void _refill_agent_list(void)
+{
+	uint32_t cnt = list_count(agent_list);
+	uint32_t max_cnt;
+	buf_t *buffer;
+
+	if ((spool_wfd < 0) || (cnt >= (slurm_conf.max_dbd_msgs / 2)))
+		return;
+
+	max_cnt = MIN(slurm_conf.max_dbd_msgs - 1, cnt + DBD_SPOOL_REFILL_MAX);
+
+	while ((cnt < max_cnt) && (buffer = _unspool_dbd_rec())) {
+		list_enqueue(agent_list, buffer);
+		cnt++;
+	}
+
+	log_flag(DBD_AGENT, "slurmdbd agent_count=%u spool_count=%u after refill",
+		 cnt, spool_cnt);
+}
+
 static void _save_dbd_state(void)
 {
 	char *dbd_fname = NULL;
 	buf_t *buffer;
 	int fd, rc, wrote = 0;
-	uint16_t msg_type;
-	uint32_t offset;
 
 	xstrfmtcat(dbd_fname, "%s/dbd.messages", slurm_conf.state_save_location);
 	(void) unlink(dbd_fname);	/* clear save state */
@@ -434,32 +635,11 @@ static void _save_dbd_state(void)
 	if (fd < 0) {
 		error("Creating state save file %s", dbd_fname);
 	} else if (list_count(agent_list)) {
-		char curr_ver_str[10];
-		snprintf(curr_ver_str, sizeof(curr_ver_str),
-			 "VER%d", SLURM_PROTOCOL_VERSION);
-		buffer = init_buf(strlen(curr_ver_str));
-		packstr(curr_ver_str, buffer);
-		rc = _save_dbd_rec(fd, buffer);
-		FREE_NULL_BUFFER(buffer);
-		if (rc != SLURM_SUCCESS)
+		if (_write_dbd_ver(fd) != SLURM_SUCCESS)
 			goto end_it;
 
 		while ((buffer = list_dequeue(agent_list))) {
-			/*
-			 * We do not want to store registration messages. If an
-			 * admin puts in an incorrect cluster name we can get a
-			 * deadlock unless they add the bogus cluster name to
-			 * the accounting system.
-			 */
-			offset = get_buf_offset(buffer);
-			if (offset < 2) {
-				FREE_NULL_BUFFER(buffer);
-				continue;
-			}
-			set_buf_offset(buffer, 0);
-			(void) unpack16(&msg_type, buffer);  /* checked by offset */
-			set_buf_offset(buffer, offset);
-			if (msg_type == DBD_REGISTER_CTLD) {
+			if (_skip_save_dbd_rec(buffer)) {
 				FREE_NULL_BUFFER(buffer);
 				continue;
 			}
@@ -528,6 +708,10 @@ static void _max_dbd_msg_action(uint32_t *msg_cnt)
 		      *msg_cnt);
 	}
 
+	/* Messages past MaxDBDMsgs are spooled in slurmdbd_agent_send() */
+	if (max_dbd_msg_action == MAX_DBD_ACTION_SPOOL)
+		return;
+
 	/* MAX_DBD_ACTION_DISCARD */
 	if (*msg_cnt >= (slurm_conf.max_dbd_msgs - 1)) {
 		uint16_t purge_type = DBD_STEP_START;
@@ -651,7 +835,10 @@ static void *_agent(void *x)
 		}
 
 		slurm_mutex_lock(&agent_lock);
+		if (slurmdbd_conn->fd >= 0)
+			_refill_agent_list();
 		cnt = list_count(agent_list);
+		metric_set(agent_queue_metric, cnt);
 		if ((cnt == 0) || (slurmdbd_conn->fd < 0) ||
 		    (fail_time && (difftime(time(NULL), fail_time) < 10))) {
 			slurm_mutex_unlock(&slurmdbd_lock);
@@ -776,6 +963,8 @@ static void *_agent(void *x)
 
 	slurm_mutex_lock(&agent_lock);
 	_save_dbd_state();
+	/* Anything still spooled is picked up again by the next agent */
+	_close_spool(false);
 
 	log_flag(AGENT, "slurmdbd agent ending with agent_count=%d",
 		 list_count(agent_list));
@@ -795,9 +984,20 @@ static void _create_agent(void)
 	   nothing if the connection was closed and then opened again */
 	slurmdbd_shutdown = 0;
 
+	if (!agent_queue_metric) {
+		agent_queue_metric = metric_register(
+			"dbd_agent_queue", NULL, METRIC_GAUGE,
+			"RPCs queued in memory for slurmdbd");
+		metric_register_src("dbd_agent_spool", NULL, METRIC_GAUGE,
+				    "RPCs spooled to disk for slurmdbd",
+				    &spool_cnt, sizeof(spool_cnt));
+	}
+
 	if (agent_list == NULL) {
 		agent_list = list_create(slurmdbd_free_buffer);
 		_load_dbd_state();
+		/* Spooled messages are newer than those in dbd.messages */
+		(void) _open_spool(false);
 	}
 
 	if (agent_tid == 0) {
@@ -941,8 +1141,28 @@ extern int slurmdbd_agent_send(uint16_t rpc_version, persist_msg_t *req)
 	/* Handle action */
 	_max_dbd_msg_action(&cnt);
 
-	if (cnt < slurm_conf.max_dbd_msgs) {
+	if (((spool_wfd >= 0) ||
+	     ((max_dbd_msg_action == MAX_DBD_ACTION_SPOOL) &&
+	      (cnt >= slurm_conf.max_dbd_msgs))) &&
+	    (req->msg_type != DBD_REGISTER_CTLD)) {
+		/*
+		 * Once spooling has started everything new goes to the spool
+		 * so messages are still sent in order.
+		 */
+		if (spool_wfd < 0)
+			error("agent queue is full (%u), spooling to %s/%s",
+			      cnt, slurm_conf.state_save_location,
+			      DBD_SPOOL_FILE);
+		if ((rc = _spool_dbd_rec(buffer)) != SLURM_SUCCESS) {
+			error("unable to spool %s:%u request",
+			      slurmdbd_msg_type_2_str(req->msg_type, 1),
+			      req->msg_type);
+			(slurmdbd_conn->trigger_callbacks.acct_full)();
+		}
+	} else if ((cnt < slurm_conf.max_dbd_msgs) ||
+		   (max_dbd_msg_action == MAX_DBD_ACTION_SPOOL)) {
 		list_enqueue(agent_list, buffer);
+		metric_set(agent_queue_metric, (cnt + 1));
 	} else {
 		error("agent queue is full (%u), discarding %s:%u request",
 		      cnt,
@@ -969,7 +1189,7 @@ extern bool slurmdbd_conn_active(void)
 
 extern int slurmdbd_agent_queue_count(void)
 {
-	return list_count(agent_list);
+	return list_count(agent_list) + spool_cnt;
 }
 
 extern void slurmdbd_agent_config_setup(void)
@@ -996,6 +1216,8 @@ extern void slurmdbd_agent_config_setup(void)
 			max_dbd_msg_action = MAX_DBD_ACTION_DISCARD;
 		else if (!xstrcasecmp(type, "exit"))
 			max_dbd_msg_action = MAX_DBD_ACTION_EXIT;
+		else if (!xstrcasecmp(type, "spool"))
+			max_dbd_msg_action = MAX_DBD_ACTION_SPOOL;
 		else
 			fatal("Unknown SlurmctldParameters option for max_dbd_msg_action '%s'",
 			      type);
@@ -772,18 +772,20 @@ static void *_thread_ipmi_run(void *no_data)
 
 	slurm_cond_signal(&launch_cond);
 
-	/* setup timer */
-	gettimeofday(&tvnow, NULL);
-	abs.tv_sec = tvnow.tv_sec;
-	abs.tv_nsec = tvnow.tv_usec * 1000;
-
 	//loop until slurm stop
 	slurm_mutex_lock(&ipmi_mutex);
 	while (!flag_energy_accounting_shutdown) {
 		_thread_update_node_energy(&ipmi_ctx);
 
-		/* Sleep until the next time. */
-		abs.tv_sec += slurm_ipmi_conf.freq;
+		/*
+		 * Sleep until the next time. The deadline is taken from the
+		 * poll that just finished, so a poll forced by a step's
+		 * request both replaces the next timed one and does not push
+		 * the schedule further into the future for every wakeup.
+		 */
+		gettimeofday(&tvnow, NULL);
+		abs.tv_sec = tvnow.tv_sec + slurm_ipmi_conf.freq;
+		abs.tv_nsec = tvnow.tv_usec * 1000;
 		slurm_cond_timedwait(&ipmi_cond, &ipmi_mutex, &abs);
 	}
 	slurm_mutex_unlock(&ipmi_mutex);
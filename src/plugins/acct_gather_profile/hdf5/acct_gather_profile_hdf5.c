@@ -111,6 +111,8 @@ typedef struct {
 typedef struct {
 	hid_t  table_id;
 	size_t type_size;
+	uint8_t *pending;	/* records not yet appended to the table */
+	int pending_cnt;
 } table_t;
 
 // Global HDF5 Variables
@@ -414,6 +416,21 @@ extern int acct_gather_profile_p_child_forked(void)
 	return SLURM_SUCCESS;
 }
 
+/* Append the records kept in memory to the HDF5 table */
+static int _flush_table(table_t *ds)
+{
+	int cnt = ds->pending_cnt;
+
+	if (!cnt)
+		return SLURM_SUCCESS;
+
+	ds->pending_cnt = 0;
+	if (H5PTappend(ds->table_id, cnt, ds->pending) < 0)
+		return SLURM_ERROR;
+
+	return SLURM_SUCCESS;
+}
+
 extern int acct_gather_profile_p_node_step_end(void)
 {
 	int rc = SLURM_SUCCESS;
@@ -434,6 +451,8 @@ extern int acct_gather_profile_p_node_step_end(void)
 
 	/* close tables */
 	for (i = 0; i < tables_cur_len; ++i) {
+		_flush_table(&tables[i]);
+		xfree(tables[i].pending);
 		H5PTclose(tables[i].table_id);
 	}
 	/* close groups */
@@ -590,6 +609,8 @@ extern int acct_gather_profile_p_create_dataset(
 	/* reserve a new table */
 	tables[tables_cur_len].table_id  = table_id;
 	tables[tables_cur_len].type_size = type_size;
+	tables[tables_cur_len].pending = xmalloc(type_size * HDF5_CHUNK_SIZE);
+	tables[tables_cur_len].pending_cnt = 0;
 	++tables_cur_len;
 
 	return tables_cur_len - 1;
@@ -599,7 +620,7 @@ extern int acct_gather_profile_p_add_sample_data(int table_id, void *data,
 						 time_t sample_time)
 {
 	table_t *ds = &tables[table_id];
-	uint8_t send_data[ds->type_size];
+	uint8_t *send_data;
 	int header_size = 0;
 	debug("acct_gather_profile_p_add_sample_data %d", table_id);
 
@@ -622,6 +643,13 @@ extern int acct_gather_profile_p_add_sample_data(int table_id, void *data,
 	if (g_profile_running <= ACCT_GATHER_PROFILE_NONE)
 		return SLURM_ERROR;
 
+	/*
+	 * Records are kept in memory and appended a chunk at a time, so the
+	 * sampling threads only go through HDF5 once per HDF5_CHUNK_SIZE
+	 * samples of the table.
+	 */
+	send_data = ds->pending + (ds->pending_cnt * ds->type_size);
+
 	/* prepend timestampe and relative time */
 	((uint64_t *)send_data)[0] = difftime(sample_time, step_start_time);
 	header_size += sizeof(uint64_t);
@@ -630,8 +658,11 @@ extern int acct_gather_profile_p_add_sample_data(int table_id, void *data,
 
 	memcpy(send_data + header_size, data, ds->type_size - header_size);
 
-	/* append the record to the table */
-	if (H5PTappend(ds->table_id, 1, send_data) < 0) {
+	if (++ds->pending_cnt < HDF5_CHUNK_SIZE)
+		return SLURM_SUCCESS;
+
+	/* append the records to the table */
+	if (_flush_table(ds) != SLURM_SUCCESS) {
 		error("PROFILE: Impossible to add data to the table %d; "
 		      "maybe the table has not been created?", table_id);
 		return SLURM_ERROR;
@@ -133,6 +133,8 @@ static stepd_step_rec_t *g_job = NULL;
 
 static char *datastr = NULL;
 static int datastrlen = 0;
+/* Kept across sends so the connection to the server is reused */
+static CURL *curl_handle = NULL;
 
 static table_t *tables = NULL;
 static size_t tables_max_len = 0;
@@ -194,9 +196,17 @@ static size_t _write_callback(void *contents, size_t size, size_t nmemb,
 }
 
 /* Try to send data to influxdb */
+/* Append data to the 'datastr' buffer, growing it if needed */
+static void _append_data(const char *data, size_t length)
+{
+	if ((datastrlen + length + 1) > xsize(datastr))
+		xrealloc(datastr, datastrlen + length + 1);
+	memcpy(datastr + datastrlen, data, length + 1);
+	datastrlen += length;
+}
+
 static int _send_data(const char *data)
 {
-	CURL *curl_handle = NULL;
 	CURLcode res;
 	struct http_response chunk;
 	int rc = SLURM_SUCCESS;
@@ -215,19 +225,27 @@ static int _send_data(const char *data)
 	 * try to open the connection and send this buffer, instead of opening
 	 * one per sample.
 	 */
-	if (data && ((datastrlen + strlen(data)) <= BUF_SIZE)) {
-		xstrcat(datastr, data);
-		length = strlen(data);
-		datastrlen += length;
+	length = data ? strlen(data) : 0;
+	if (data && ((datastrlen + length) <= BUF_SIZE)) {
+		_append_data(data, length);
 		log_flag(PROFILE, "%s %s: %zu bytes of data added to buffer. New buffer size: %d",
 			 plugin_type, __func__, length, datastrlen);
 		return rc;
 	}
 
+	/* Nothing buffered to flush */
+	if (!datastrlen)
+		goto cleanup_easy_init;
+
 	DEF_TIMERS;
 	START_TIMER;
 
-	if ((curl_handle = curl_easy_init()) == NULL) {
+	/*
+	 * Reuse the handle, and with it the connection to the server, instead
+	 * of connecting again on every flush. All the options are set again
+	 * below so nothing depends on what the previous send left behind.
+	 */
+	if (!curl_handle && !(curl_handle = curl_easy_init())) {
 		error("%s %s: curl_easy_init: %m", plugin_type, __func__);
 		rc = SLURM_ERROR;
 		goto cleanup_easy_init;
@@ -245,7 +263,7 @@ static int _send_data(const char *data)
 				 influxdb_conf.password);
 	curl_easy_setopt(curl_handle, CURLOPT_POST, 1);
 	curl_easy_setopt(curl_handle, CURLOPT_POSTFIELDS, datastr);
-	curl_easy_setopt(curl_handle, CURLOPT_POSTFIELDSIZE, strlen(datastr));
+	curl_easy_setopt(curl_handle, CURLOPT_POSTFIELDSIZE, (long) datastrlen);
 	if (influxdb_conf.username)
 		curl_easy_setopt(curl_handle, CURLOPT_USERNAME,
 				 influxdb_conf.username);
@@ -295,20 +313,16 @@ static int _send_data(const char *data)
 cleanup:
 	xfree(chunk.message);
 	xfree(url);
-cleanup_easy_init:
-	curl_easy_cleanup(curl_handle);
 
 	END_TIMER;
 	log_flag(PROFILE, "%s %s: took %s to send data",
 		 plugin_type, __func__, TIME_STR);
 
-	if (data) {
-		datastr = xstrdup(data);
-		datastrlen = strlen(data);
-	} else {
-		datastr[0] = '\0';
-		datastrlen = 0;
-	}
+cleanup_easy_init:
+	datastr[0] = '\0';
+	datastrlen = 0;
+	if (data)
+		_append_data(data, length);
 
 	return rc;
 }
@@ -337,6 +351,8 @@ extern int fini(void)
 {
 	debug3("%s %s called", plugin_type, __func__);
 
+	if (curl_handle)
+		curl_easy_cleanup(curl_handle);
 	curl_global_cleanup();
 
 	_free_tables();
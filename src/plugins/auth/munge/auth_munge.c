@@ -41,6 +41,7 @@
 
 #include <inttypes.h>
 #include <munge.h>
+#include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -57,6 +58,7 @@
 #include "src/common/slurm_time.h"
 #include "src/common/uid.h"
 #include "src/common/util-net.h"
+#include "src/common/xhash.h"
 #include "src/common/xmalloc.h"
 #include "src/common/xsignal.h"
 #include "src/common/xstring.h"
@@ -64,6 +66,9 @@
 #define RETRY_COUNT		20
 #define RETRY_USEC		100000
 
+#define MUNGE_DEFAULT_TTL	300
+#define SESSION_CACHE_MAX	1024
+
 /*
  * These variables are required by the generic plugin interface.  If they
  * are not found in the plugin, the plugin loader will ignore it.
@@ -114,6 +119,25 @@ typedef struct {
 	int dlen;          /* payload data length */
 } auth_credential_t;
 
+/*
+ * Session cache entry. Credentials without a payload are reused by the
+ * sender and their decoded identity remembered by the receiver until
+ * "expires", so munged is only consulted once per session.
+ */
+typedef struct {
+	char *key;	/* sender: opts/uid/gid/r_uid, receiver: m_str */
+	char *m_str;	/* sender only: munged string to reuse */
+	struct in_addr addr;
+	uid_t uid;
+	gid_t gid;
+	time_t expires;
+} session_t;
+
+static pthread_mutex_t session_lock = PTHREAD_MUTEX_INITIALIZER;
+static int session_lifetime = 0;
+static xhash_t *session_sent = NULL;
+static xhash_t *session_verified = NULL;
+
 extern auth_credential_t *auth_p_create(char *opts, uid_t r_uid, void *data,
 					int dlen);
 extern void auth_p_destroy(auth_credential_t *cred);
@@ -123,6 +147,168 @@ extern void auth_p_destroy(auth_credential_t *cred);
 static int _decode_cred(auth_credential_t *c, char *socket, bool test);
 static void _print_cred(munge_ctx_t ctx);
 
+static void _session_id(void *item, const char **key, uint32_t *key_len)
+{
+	session_t *session = item;
+
+	*key = session->key;
+	*key_len = strlen(session->key);
+}
+
+static void _session_free(void *item)
+{
+	session_t *session = item;
+
+	xfree(session->key);
+	xfree(session->m_str);
+	xfree(session);
+}
+
+static void _session_find_expired(void *item, void *arg)
+{
+	session_t *session = item;
+	list_t *expired = arg;
+
+	if (session->expires <= time(NULL))
+		list_append(expired, session->key);
+}
+
+/* Make room for one more entry in a session table. Caller holds lock. */
+static void _session_purge(xhash_t *table)
+{
+	list_t *expired;
+	char *key;
+
+	if (xhash_count(table) < SESSION_CACHE_MAX)
+		return;
+
+	expired = list_create(NULL);
+	xhash_walk(table, _session_find_expired, expired);
+	while ((key = list_pop(expired)))
+		xhash_delete_str(table, key);
+	FREE_NULL_LIST(expired);
+
+	if (xhash_count(table) >= SESSION_CACHE_MAX)
+		xhash_clear(table);
+}
+
+static char *_session_sent_key(char *opts, uid_t r_uid)
+{
+	return xstrdup_printf("%s:%u:%u:%u", (opts ? opts : ""), geteuid(),
+			      getegid(), r_uid);
+}
+
+/* Return a copy of a still valid credential previously sent to r_uid */
+static auth_credential_t *_session_sent_get(char *opts, uid_t r_uid)
+{
+	auth_credential_t *cred = NULL;
+	char *key = _session_sent_key(opts, r_uid);
+	session_t *session;
+
+	slurm_mutex_lock(&session_lock);
+	if (session_sent && (session = xhash_get_str(session_sent, key))) {
+		if (session->expires > time(NULL)) {
+			cred = xmalloc(sizeof(*cred));
+			cred->magic = MUNGE_MAGIC;
+			cred->m_str = xstrdup(session->m_str);
+			cred->m_xstr = true;
+		} else {
+			xhash_delete_str(session_sent, key);
+		}
+	}
+	slurm_mutex_unlock(&session_lock);
+
+	xfree(key);
+	return cred;
+}
+
+static void _session_sent_put(char *opts, uid_t r_uid, char *m_str)
+{
+	session_t *session = xmalloc(sizeof(*session));
+
+	session->key = _session_sent_key(opts, r_uid);
+	session->m_str = xstrdup(m_str);
+	/*
+	 * Stop handing out the credential halfway through the session so the
+	 * last receiver still sees it inside its own session window.
+	 */
+	session->expires = time(NULL) + (session_lifetime / 2);
+
+	slurm_mutex_lock(&session_lock);
+	if (!session_sent)
+		session_sent = xhash_init(_session_id, _session_free);
+	xhash_delete_str(session_sent, session->key);
+	_session_purge(session_sent);
+	xhash_add(session_sent, session);
+	slurm_mutex_unlock(&session_lock);
+}
+
+/* Fill in a credential that was already decoded during its session */
+static bool _session_verified_get(auth_credential_t *c)
+{
+	session_t *session;
+	bool found = false;
+
+	slurm_mutex_lock(&session_lock);
+	if (session_verified &&
+	    (session = xhash_get_str(session_verified, c->m_str))) {
+		if (session->expires > time(NULL)) {
+			c->uid = session->uid;
+			c->gid = session->gid;
+			c->addr = session->addr;
+			c->verified = true;
+			found = true;
+		} else {
+			xhash_delete_str(session_verified, c->m_str);
+		}
+	}
+	slurm_mutex_unlock(&session_lock);
+
+	return found;
+}
+
+static void _session_verified_put(auth_credential_t *c, time_t encoded)
+{
+	session_t *session;
+
+	if (encoded + session_lifetime <= time(NULL))
+		return;
+
+	session = xmalloc(sizeof(*session));
+	session->key = xstrdup(c->m_str);
+	session->uid = c->uid;
+	session->gid = c->gid;
+	session->addr = c->addr;
+	session->expires = encoded + session_lifetime;
+
+	slurm_mutex_lock(&session_lock);
+	if (!session_verified)
+		session_verified = xhash_init(_session_id, _session_free);
+	xhash_delete_str(session_verified, session->key);
+	_session_purge(session_verified);
+	xhash_add(session_verified, session);
+	slurm_mutex_unlock(&session_lock);
+}
+
+/*
+ * MUNGE rejects a credential decoded more than once. Within a session it
+ * is legitimately reused, so accept the replay while it is still young
+ * enough; MUNGE has already validated everything else about it.
+ */
+static bool _session_replay_allowed(munge_ctx_t ctx)
+{
+	time_t encoded;
+
+	if (!session_lifetime)
+		return false;
+
+	if (munge_ctx_get(ctx, MUNGE_OPT_ENCODE_TIME, &encoded) !=
+	    EMUNGE_SUCCESS)
+		return false;
+
+	return (encoded + session_lifetime > time(NULL));
+}
+
 /*
  *  Munge plugin initialization
  */
@@ -135,6 +321,18 @@ int init(void)
 	else
 		bad_cred_test = 0;
 
+	if ((session_lifetime = slurm_get_auth_session_lifetime())) {
+		int auth_ttl = slurm_get_auth_ttl();
+
+		if (!auth_ttl)
+			auth_ttl = MUNGE_DEFAULT_TTL;
+		if (session_lifetime >= auth_ttl) {
+			session_lifetime = auth_ttl / 2;
+			info("AuthInfo session_lifetime reduced to %d seconds to stay within credential ttl",
+			     session_lifetime);
+		}
+	}
+
 	/*
 	 * MUNGE has a compile-time option that permits root to decode any
 	 * credential regardless of the MUNGE_OPT_UID_RESTRICTION setting.
@@ -163,6 +361,11 @@ int init(void)
 
 extern int fini(void)
 {
+	slurm_mutex_lock(&session_lock);
+	xhash_free(session_sent);
+	xhash_free(session_verified);
+	slurm_mutex_unlock(&session_lock);
+
 	return SLURM_SUCCESS;
 }
 
@@ -185,6 +388,12 @@ auth_credential_t *auth_p_create(char *opts, uid_t r_uid, void *data, int dlen)
 		return NULL;
 	}
 
+	if (session_lifetime && !dlen &&
+	    (cred = _session_sent_get(opts, r_uid))) {
+		munge_ctx_destroy(ctx);
+		return cred;
+	}
+
 	if (opts) {
 		socket = slurm_auth_opts_to_socket(opts);
 		rc = munge_ctx_set(ctx, MUNGE_OPT_SOCKET, socket);
@@ -255,6 +464,8 @@ again:
 		 */
 		int i = ((int) time(NULL)) % (strlen(cred->m_str) - 4);
 		cred->m_str[i]++;	/* random position in credential */
+	} else if (session_lifetime && !dlen) {
+		_session_sent_put(opts, r_uid, cred->m_str);
 	}
 
 	xsignal(SIGALRM, ohandler);
@@ -513,6 +724,9 @@ static int _decode_cred(auth_credential_t *c, char *socket, bool test)
 	if (c->verified)
 		return SLURM_SUCCESS;
 
+	if (session_lifetime && !test && _session_verified_get(c))
+		return SLURM_SUCCESS;
+
 	if ((ctx = munge_ctx_create()) == NULL) {
 		error("munge_ctx_create failure");
 		return SLURM_ERROR;
@@ -526,6 +740,11 @@ static int _decode_cred(auth_credential_t *c, char *socket, bool test)
 
 again:
 	err = munge_decode(c->m_str, ctx, &c->data, &c->dlen, &c->uid, &c->gid);
+	if ((err == EMUNGE_CRED_REPLAYED) && !test && !c->dlen &&
+	    _session_replay_allowed(ctx)) {
+		debug2("Munge credential replayed within session lifetime");
+		err = EMUNGE_SUCCESS;
+	}
 	if (err != EMUNGE_SUCCESS) {
 		if (test)
 			goto done;
@@ -577,6 +796,14 @@ again:
 	else
 		c->verified = true;
 
+	if (c->verified && session_lifetime && !test && !c->dlen) {
+		time_t encoded;
+
+		if (munge_ctx_get(ctx, MUNGE_OPT_ENCODE_TIME, &encoded) ==
+		    EMUNGE_SUCCESS)
+			_session_verified_put(c, encoded);
+	}
+
 done:
 	munge_ctx_destroy(ctx);
 	return err ? SLURM_ERROR : SLURM_SUCCESS;
@@ -129,6 +129,8 @@ extern int init(void)
 	if (xstrstr(slurm_conf.authinfo, "use_client_ids"))
 		use_client_ids = true;
 
+	init_session();
+
 	debug("loaded: internal=%s, use_client_ids=%s",
 	      internal ? "true" : "false",
 	      use_client_ids ? "true" : "false");
@@ -154,20 +156,36 @@ extern int fini(void)
 		fini_internal();
 	}
 
+	fini_session();
+
 	return SLURM_SUCCESS;
 }
 
 extern auth_cred_t *auth_p_create(char *auth_info, uid_t r_uid, void *data,
 				  int dlen)
 {
+	auth_cred_t *cred = NULL;
+	bool session = (session_lifetime && !dlen);
+	char *token;
+
+	if (session && (token = session_sent_get(r_uid))) {
+		cred = new_cred();
+		cred->token = token;
+		return cred;
+	}
+
 	if (internal) {
-		auth_cred_t *cred = new_cred();
+		cred = new_cred();
 		cred->token = create_internal("auth", getuid(), getgid(), r_uid,
 					      data, dlen, NULL);
-		return cred;
+	} else {
+		cred = create_external(r_uid, data, dlen);
 	}
 
-	return create_external(r_uid, data, dlen);
+	if (session && cred && cred->token)
+		session_sent_put(r_uid, cred->token);
+
+	return cred;
 }
 
 extern void auth_p_destroy(auth_cred_t *cred)
@@ -177,15 +195,25 @@ extern void auth_p_destroy(auth_cred_t *cred)
 
 extern int auth_p_verify(auth_cred_t *cred, char *auth_info)
 {
+	int rc;
+
 	if (!cred) {
 		errno = ESLURM_AUTH_BADARG;
 		return SLURM_ERROR;
 	}
 
+	if (session_lifetime && cred->token && session_verified_get(cred))
+		return SLURM_SUCCESS;
+
 	if (internal)
-		return verify_internal(cred, getuid());
+		rc = verify_internal(cred, getuid());
+	else
+		rc = verify_external(cred);
 
-	return verify_external(cred);
+	if (!rc && session_lifetime)
+		session_verified_put(cred);
+
+	return rc;
 }
 
 extern void auth_p_get_ids(auth_cred_t *cred, uid_t *uid, gid_t *gid)
@@ -70,6 +70,7 @@ typedef struct {
 
 extern bool internal;
 extern bool use_client_ids;
+extern int session_lifetime;
 
 /* Borrow these from libjwt despite them not being public. */
 extern int jwt_Base64encode(char *encoded, const char *string, int len);
@@ -87,6 +88,15 @@ extern int verify_external(auth_cred_t *cred);
 
 extern void init_sack_conmgr(void);
 
+extern void init_session(void);
+extern void fini_session(void);
+/* Return a still valid token previously created for r_uid, or NULL */
+extern char *session_sent_get(uid_t r_uid);
+extern void session_sent_put(uid_t r_uid, char *token);
+/* Fill in a cred whose token was verified earlier in its session */
+extern bool session_verified_get(auth_cred_t *cred);
+extern void session_verified_put(auth_cred_t *cred);
+
 extern auth_cred_t *new_cred(void);
 extern void destroy_cred(auth_cred_t *cred);
 #define FREE_NULL_CRED(_X)		\
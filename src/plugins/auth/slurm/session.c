@@ -0,0 +1,259 @@
+/*****************************************************************************\
+ *  session.c
+ *****************************************************************************
+ *  Copyright (C) SchedMD LLC.
+ *
+ *  This file is part of Slurm, a resource management program.
+ *  For details, see <https://slurm.schedmd.com/>.
+ *  Please also read the included file: DISCLAIMER.
+ *
+ *  Slurm is free software; you can redistribute it and/or modify it under
+ *  the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the License, or (at your option)
+ *  any later version.
+ *
+ *  In addition, as a special exception, the copyright holders give permission
+ *  to link the code of portions of this program with the OpenSSL library under
+ *  certain conditions as described in each individual source file, and
+ *  distribute linked combinations including the two. You must obey the GNU
+ *  General Public License in all respects for all of the code used other than
+ *  OpenSSL. If you modify file(s) with this exception, you may extend this
+ *  exception to your version of the file(s), but you are not obligated to do
+ *  so. If you do not wish to do so, delete this exception statement from your
+ *  version.  If you delete this exception statement from all source files in
+ *  the program, then also delete it here.
+ *
+ *  Slurm is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with Slurm; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA.
+\*****************************************************************************/
+
+#include <pthread.h>
+#include <string.h>
+#include <sys/types.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "slurm/slurm.h"
+#include "slurm/slurm_errno.h"
+#include "src/common/slurm_xlator.h"
+
+#include "src/common/list.h"
+#include "src/common/log.h"
+#include "src/common/slurm_protocol_api.h"
+#include "src/common/xhash.h"
+#include "src/common/xmalloc.h"
+#include "src/common/xstring.h"
+#include "src/plugins/auth/slurm/auth_slurm.h"
+
+#define SESSION_CACHE_MAX 1024
+
+/*
+ * Session cache entry. Tokens without a payload are reused by the sender and
+ * their decoded identity remembered by the receiver until "expires", so the
+ * token is only signed (or sent through sack) and verified once per session.
+ */
+typedef struct {
+	char *key;	/* sender: uid/gid/r_uid, receiver: token/decoder uid */
+	char *token;	/* sender only */
+	auth_cred_t *cred; /* receiver only */
+	time_t expires;
+} session_t;
+
+int session_lifetime = 0;
+
+static pthread_mutex_t session_lock = PTHREAD_MUTEX_INITIALIZER;
+static xhash_t *session_sent = NULL;
+static xhash_t *session_verified = NULL;
+
+static void _session_id(void *item, const char **key, uint32_t *key_len)
+{
+	session_t *session = item;
+
+	*key = session->key;
+	*key_len = strlen(session->key);
+}
+
+static void _session_free(void *item)
+{
+	session_t *session = item;
+
+	xfree(session->key);
+	xfree(session->token);
+	FREE_NULL_CRED(session->cred);
+	xfree(session);
+}
+
+static void _session_find_expired(void *item, void *arg)
+{
+	session_t *session = item;
+	list_t *expired = arg;
+
+	if (session->expires <= time(NULL))
+		list_append(expired, session->key);
+}
+
+/* Make room for one more entry in a session table. Caller holds lock. */
+static void _session_purge(xhash_t *table)
+{
+	list_t *expired;
+	char *key;
+
+	if (xhash_count(table) < SESSION_CACHE_MAX)
+		return;
+
+	expired = list_create(NULL);
+	xhash_walk(table, _session_find_expired, expired);
+	while ((key = list_pop(expired)))
+		xhash_delete_str(table, key);
+	FREE_NULL_LIST(expired);
+
+	if (xhash_count(table) >= SESSION_CACHE_MAX)
+		xhash_clear(table);
+}
+
+static void _session_add(xhash_t **table, session_t *session)
+{
+	slurm_mutex_lock(&session_lock);
+	if (!*table)
+		*table = xhash_init(_session_id, _session_free);
+	xhash_delete_str(*table, session->key);
+	_session_purge(*table);
+	xhash_add(*table, session);
+	slurm_mutex_unlock(&session_lock);
+}
+
+static char *_sent_key(uid_t r_uid)
+{
+	if (internal)
+		return xstrdup_printf("%u:%u:%u", getuid(), getgid(), r_uid);
+	return xstrdup_printf("%u:%u:%u", geteuid(), getegid(), r_uid);
+}
+
+static char *_verified_key(auth_cred_t *cred)
+{
+	return xstrdup_printf("%s:%u", cred->token, getuid());
+}
+
+extern void init_session(void)
+{
+	int ttl;
+
+	if (!(session_lifetime = slurm_get_auth_session_lifetime()))
+		return;
+
+	if (!(ttl = slurm_get_auth_ttl()))
+		ttl = DEFAULT_TTL;
+
+	if (session_lifetime >= ttl) {
+		session_lifetime = ttl / 2;
+		info("AuthInfo session_lifetime reduced to %d seconds to stay within credential ttl",
+		     session_lifetime);
+	}
+}
+
+extern void fini_session(void)
+{
+	slurm_mutex_lock(&session_lock);
+	xhash_free(session_sent);
+	xhash_free(session_verified);
+	slurm_mutex_unlock(&session_lock);
+}
+
+extern char *session_sent_get(uid_t r_uid)
+{
+	char *key = _sent_key(r_uid), *token = NULL;
+	session_t *session;
+
+	slurm_mutex_lock(&session_lock);
+	if (session_sent && (session = xhash_get_str(session_sent, key))) {
+		if (session->expires > time(NULL))
+			token = xstrdup(session->token);
+		else
+			xhash_delete_str(session_sent, key);
+	}
+	slurm_mutex_unlock(&session_lock);
+
+	xfree(key);
+	return token;
+}
+
+extern void session_sent_put(uid_t r_uid, char *token)
+{
+	session_t *session = xmalloc(sizeof(*session));
+
+	session->key = _sent_key(r_uid);
+	session->token = xstrdup(token);
+	/*
+	 * Stop handing out the token halfway through the session so the last
+	 * receiver still sees it inside its own session window.
+	 */
+	session->expires = time(NULL) + (session_lifetime / 2);
+
+	_session_add(&session_sent, session);
+}
+
+extern bool session_verified_get(auth_cred_t *cred)
+{
+	char *key = _verified_key(cred);
+	session_t *session;
+	bool found = false;
+
+	slurm_mutex_lock(&session_lock);
+	if (session_verified &&
+	    (session = xhash_get_str(session_verified, key))) {
+		if (session->expires > time(NULL)) {
+			cred->verified = true;
+			cred->ctime = session->cred->ctime;
+			cred->uid = session->cred->uid;
+			cred->gid = session->cred->gid;
+			cred->hostname = xstrdup(session->cred->hostname);
+			cred->cluster = xstrdup(session->cred->cluster);
+			cred->context = xstrdup(session->cred->context);
+			if (session->cred->id)
+				cred->id = copy_identity(session->cred->id);
+			found = true;
+		} else {
+			xhash_delete_str(session_verified, key);
+		}
+	}
+	slurm_mutex_unlock(&session_lock);
+
+	xfree(key);
+	return found;
+}
+
+extern void session_verified_put(auth_cred_t *cred)
+{
+	session_t *session;
+	auth_cred_t *copy;
+
+	if (cred->data || cred->dlen || !cred->token)
+		return;
+
+	if (cred->ctime + session_lifetime <= time(NULL))
+		return;
+
+	copy = new_cred();
+	copy->verified = true;
+	copy->ctime = cred->ctime;
+	copy->uid = cred->uid;
+	copy->gid = cred->gid;
+	copy->hostname = xstrdup(cred->hostname);
+	copy->cluster = xstrdup(cred->cluster);
+	copy->context = xstrdup(cred->context);
+	if (cred->id)
+		copy->id = copy_identity(cred->id);
+
+	session = xmalloc(sizeof(*session));
+	session->key = _verified_key(cred);
+	session->cred = copy;
+	session->expires = cred->ctime + session_lifetime;
+
+	_session_add(&session_verified, session);
+}
@@ -3640,6 +3640,62 @@ static void _kill_job(job_record_t *job_ptr, bool hold_job)
 	deallocate_nodes(job_ptr, false, false, false);
 }
 
+/*
+ * Run the "paths" function and add the variables it wrote to the job's path
+ * file to the job's supplemental environment. Called from the pre_run thread,
+ * before the job is allowed to launch.
+ */
+static int _run_paths(stage_args_t *pre_run_args, char **resp_msg)
+{
+	char *path_file = NULL;
+	char **argv;
+	uint32_t argc;
+	int rc;
+	job_record_t *job_ptr;
+	/* Locks: write job */
+	slurmctld_lock_t job_write_lock = {
+		NO_LOCK, WRITE_LOCK, NO_LOCK, NO_LOCK, READ_LOCK };
+	run_lua_args_t run_lua_args;
+
+	/* Create an empty "path" file which can be used by lua. */
+	xstrfmtcat(path_file, "%s/hash.%d/job.%u/path",
+		   slurm_conf.state_save_location, pre_run_args->job_id % 10,
+		   pre_run_args->job_id);
+	bb_write_file(path_file, "");
+
+	argc = 5;
+	argv = xcalloc(argc + 1, sizeof (char *)); /* NULL-terminated */
+	argv[0] = xstrdup_printf("%u", pre_run_args->job_id);
+	argv[1] = xstrdup_printf("%s", pre_run_args->job_script);
+	argv[2] = xstrdup_printf("%s", path_file);
+	argv[3] = xstrdup_printf("%u", pre_run_args->uid);
+	argv[4] = xstrdup_printf("%u", pre_run_args->gid);
+
+	memset(&run_lua_args, 0, sizeof run_lua_args);
+	run_lua_args.argc = argc;
+	run_lua_args.argv = argv;
+	run_lua_args.get_job_ptr = true;
+	run_lua_args.job_id = pre_run_args->job_id;
+	run_lua_args.lua_func = req_fxns[SLURM_BB_PATHS];
+	run_lua_args.resp_msg = resp_msg;
+	run_lua_args.timeout = 0;
+
+	rc = _run_lua_script_wrapper(&run_lua_args);
+	xfree_array(argv);
+
+	if (rc != SLURM_SUCCESS) {
+		error("paths for JobId=%u failed", pre_run_args->job_id);
+	} else {
+		lock_slurmctld(job_write_lock);
+		if ((job_ptr = find_job_record(pre_run_args->job_id)))
+			_update_job_env(job_ptr, path_file);
+		unlock_slurmctld(job_write_lock);
+	}
+	xfree(path_file);
+
+	return rc;
+}
+
 static void *_start_pre_run(void *x)
 {
 	int rc;
@@ -3647,7 +3703,7 @@ static void *_start_pre_run(void *x)
 	bool nodes_ready = false, run_kill_job = false, hold_job = false;
 	bool track_script_signal = false;
 	char *resp_msg = NULL;
-	const char *op;
+	const char *op, *comment_op = "pre_run";
 	char **argv;
 	bb_job_t *bb_job = NULL;
 	job_record_t *job_ptr;
@@ -3667,6 +3723,16 @@ static void *_start_pre_run(void *x)
 	argv[2] = xstrdup_printf("%u", pre_run_args->uid);
 	argv[3] = xstrdup_printf("%u", pre_run_args->gid);
 
+	/* The job's environment must be complete before it can launch. */
+	if ((rc = _run_paths(pre_run_args, &resp_msg)) != SLURM_SUCCESS) {
+		op = req_fxns[SLURM_BB_PATHS];
+		comment_op = "paths";
+		/* Leave the job held, as a failed paths did before */
+		hold_job = true;
+		goto end_op;
+	}
+	xfree(resp_msg);
+
 	/* Wait for node boot to complete. */
 	while (!nodes_ready) {
 		lock_slurmctld(job_read_lock);
@@ -3705,6 +3771,7 @@ static void *_start_pre_run(void *x)
 		goto fini;
 	}
 
+end_op:
 	lock_slurmctld(job_write_lock);
 	slurm_mutex_lock(&bb_state.bb_mutex);
 	job_ptr = find_job_record(pre_run_args->job_id);
@@ -3715,8 +3782,8 @@ static void *_start_pre_run(void *x)
 		trigger_burst_buffer();
 		error("%s failed for JobId=%u", op, pre_run_args->job_id);
 		if (job_ptr) {
-			bb_update_system_comment(job_ptr, "pre_run", resp_msg,
-						 0);
+			bb_update_system_comment(job_ptr, (char *) comment_op,
+						 resp_msg, 0);
 			if (IS_JOB_RUNNING(job_ptr))
 				run_kill_job = true;
 			if (bb_job) {
@@ -3765,15 +3832,10 @@ fini:
  */
 extern int bb_p_job_begin(job_record_t *job_ptr)
 {
-	char *path_file = NULL;
-	char *job_dir = NULL, *resp_msg = NULL, *job_script = NULL;
+	char *job_dir = NULL, *job_script = NULL;
 	int hash_inx = job_ptr->job_id % 10;
-	int rc = SLURM_SUCCESS;
-	uint32_t argc;
-	char **argv;
 	bb_job_t *bb_job;
 	stage_args_t *pre_run_args;
-	run_lua_args_t run_lua_args;
 
 	if ((job_ptr->burst_buffer == NULL) ||
 	    (job_ptr->burst_buffer[0] == '\0'))
@@ -3814,44 +3876,11 @@ extern int bb_p_job_begin(job_record_t *job_ptr)
 
 	xstrfmtcat(job_script, "%s/script", job_dir);
 
-	/* Create an empty "path" file which can be used by lua. */
-	xstrfmtcat(path_file, "%s/path", job_dir);
-	bb_write_file(path_file, "");
-	/* Initialize args and run the "paths" function. */
-	argc = 5;
-	argv = xcalloc(argc + 1, sizeof (char *)); /* NULL-terminated */
-	argv[0] = xstrdup_printf("%u", job_ptr->job_id);
-	argv[1] = xstrdup_printf("%s", job_script);
-	argv[2] = xstrdup_printf("%s", path_file);
-	argv[3] = xstrdup_printf("%u", job_ptr->user_id);
-	argv[4] = xstrdup_printf("%u", job_ptr->group_id);
-
-	memset(&run_lua_args, 0, sizeof run_lua_args);
-	run_lua_args.argc = argc;
-	run_lua_args.argv = argv;
-	run_lua_args.get_job_ptr = true;
-	run_lua_args.have_job_lock = true;
-	run_lua_args.job_id = job_ptr->job_id;
-	run_lua_args.job_ptr = job_ptr;
-	run_lua_args.lua_func = req_fxns[SLURM_BB_PATHS];
-	run_lua_args.resp_msg = &resp_msg;
-	run_lua_args.timeout = 0;
-
-	rc = _run_lua_script_wrapper(&run_lua_args);
-
-	/* resp_msg already logged by _run_lua_script. */
-	xfree(resp_msg);
-	xfree_array(argv);
-
-	if (rc != SLURM_SUCCESS) {
-		error("paths for %pJ failed", job_ptr);
-		rc = ESLURM_INVALID_BURST_BUFFER_REQUEST;
-		goto fini;
-	} else {
-		_update_job_env(job_ptr, path_file);
-	}
-
-	/* Setup for the "pre_run" function. */
+	/*
+	 * Setup for the "paths" and "pre_run" functions. Both run from the
+	 * pre_run thread so the scheduler, which holds the job write lock
+	 * here, does not wait on the Lua script.
+	 */
 	pre_run_args = xmalloc(sizeof *pre_run_args);
 	pre_run_args->job_id = job_ptr->job_id;
 	pre_run_args->job_script = job_script; /* Point at malloc'd string */
@@ -3865,12 +3894,9 @@ extern int bb_p_job_begin(job_record_t *job_ptr)
 
 	slurm_thread_create_detached(_start_pre_run, pre_run_args);
 
-fini:
-	xfree(job_script);
-	xfree(path_file);
 	xfree(job_dir);
 
-	return rc;
+	return SLURM_SUCCESS;
 }
 
 /* Revoke allocation, but do not release resources.
@@ -350,6 +350,46 @@ extern int common_file_read_content(char *file_path, char **content,
 	return SLURM_SUCCESS;
 }
 
+extern int common_fd_read_content(int fd, char **content, size_t *csize)
+{
+	int nr_reads = 0;
+	size_t count = CGROUP_READ_COUNT;
+	ssize_t rc, read_bytes = 0;
+	char *buf;
+
+	/* check input pointers */
+	if (content == NULL || csize == NULL)
+		return SLURM_ERROR;
+
+	/*
+	 * Always read from offset 0 so the kernel regenerates the content and
+	 * the same fd can be read again on the next call.
+	 */
+	buf = xmalloc(count);
+	while ((rc = pread(fd, buf + read_bytes, count, read_bytes))) {
+		if (rc < 0) {
+			if (errno == EINTR)
+				continue;
+			log_flag(CGROUP, "unable to read fd %d: %m", fd);
+			xfree(buf);
+			return SLURM_ERROR;
+		}
+		read_bytes += rc;
+		xrealloc(buf, (read_bytes + count));
+		nr_reads++;
+	}
+
+	if (nr_reads > 1)
+		log_flag(CGROUP, "fd %d: Read %zd bytes after %d pread() syscalls. File may have changed between syscalls.",
+			 fd, read_bytes, nr_reads);
+
+	/* set output values */
+	*content = buf;
+	*csize = read_bytes;
+
+	return SLURM_SUCCESS;
+}
+
 extern int common_cgroup_instantiate(xcgroup_t *cg)
 {
 	int fstatus = SLURM_ERROR;
@@ -88,6 +88,15 @@ extern int common_file_write_content(char *file_path, char *content,
 extern int common_file_read_content(char *file_path, char **content,
 				    size_t *csize);
 
+/*
+ * Read the whole content of an already opened cgroup interface file. The
+ * content is read from offset 0 without moving the file offset, so the fd can
+ * be kept open and read again to get updated values.
+ *
+ * on success, content must be free using xfree
+ */
+extern int common_fd_read_content(int fd, char **content, size_t *csize);
+
 /*
  * instantiate a cgroup in a cgroup namespace (mkdir)
  *
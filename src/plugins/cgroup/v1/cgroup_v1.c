@@ -792,6 +792,12 @@ extern int cgroup_p_step_resume(void)
 				       "freezer.state", "THAWED");
 }
 
+extern int cgroup_p_step_kill(void)
+{
+	/* The freezer of cgroup v1 has no way to kill a whole cgroup */
+	return ESLURM_NOT_SUPPORTED;
+}
+
 static int _step_destroy_internal(cgroup_ctl_type_t sub, bool root_locked)
 {
 	int rc = SLURM_SUCCESS;
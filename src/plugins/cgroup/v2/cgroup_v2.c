@@ -87,12 +87,34 @@ static char *ctl_names[] = {
 	[CG_DEVICES] = "devices",
 };
 
+/* Interfaces read on every accounting poll of a task */
+typedef enum {
+	TASK_ACCT_CPU_STAT,
+	TASK_ACCT_MEMORY_CURRENT,
+	TASK_ACCT_MEMORY_STAT,
+	TASK_ACCT_MEMORY_PEAK,
+	TASK_ACCT_CNT
+} task_acct_file_t;
+
+static char *task_acct_files[] = {
+	[TASK_ACCT_CPU_STAT] = "cpu.stat",
+	[TASK_ACCT_MEMORY_CURRENT] = "memory.current",
+	[TASK_ACCT_MEMORY_STAT] = "memory.stat",
+	[TASK_ACCT_MEMORY_PEAK] = "memory.peak",
+};
+
 typedef struct {
 	xcgroup_t task_cg;
 	uint32_t taskid;
 	bpf_program_t p;
+	int dir_fd;			/* task_cg directory, -1 if not open */
+	int acct_fd[TASK_ACCT_CNT];	/* task_acct_files, -1 if not open,
+					 * ACCT_FD_MISSING if not provided */
 } task_cg_info_t;
 
+/* The interface doesn't exist in the task cgroup, don't try to open it */
+#define ACCT_FD_MISSING -2
+
 typedef struct {
 	int npids;
 	pid_t *pids;
@@ -440,10 +462,68 @@ static int _setup_controllers()
 				int_cg_ns.avail_controllers);
 }
 
+static void _close_task_acct_fds(task_cg_info_t *t)
+{
+	for (int i = 0; i < TASK_ACCT_CNT; i++) {
+		if (t->acct_fd[i] >= 0)
+			close(t->acct_fd[i]);
+		t->acct_fd[i] = -1;
+	}
+	if (t->dir_fd >= 0)
+		close(t->dir_fd);
+	t->dir_fd = -1;
+}
+
+/*
+ * Read an accounting interface of a task through fds kept open for the life
+ * of the task, so each poll only costs a pread() instead of a path lookup,
+ * open() and close().
+ */
+static int _read_task_acct_file(task_cg_info_t *t, task_acct_file_t file,
+				char **content)
+{
+	size_t tmp_sz = 0;
+
+	if ((t->dir_fd < 0) &&
+	    ((t->dir_fd = open(t->task_cg.path,
+			       (O_RDONLY | O_DIRECTORY | O_CLOEXEC))) < 0)) {
+		log_flag(CGROUP, "unable to open '%s': %m", t->task_cg.path);
+		return SLURM_ERROR;
+	}
+
+	if (t->acct_fd[file] == ACCT_FD_MISSING)
+		return SLURM_ERROR;
+
+	if ((t->acct_fd[file] < 0) &&
+	    ((t->acct_fd[file] = openat(t->dir_fd, task_acct_files[file],
+					(O_RDONLY | O_CLOEXEC))) < 0)) {
+		/*
+		 * A controller not enabled for the task cgroup won't show up
+		 * later, so stop looking for its interfaces on every poll.
+		 */
+		if (errno == ENOENT)
+			t->acct_fd[file] = ACCT_FD_MISSING;
+		log_flag(CGROUP, "unable to open '%s/%s': %m",
+			 t->task_cg.path, task_acct_files[file]);
+		return SLURM_ERROR;
+	}
+
+	if (common_fd_read_content(t->acct_fd[file], content, &tmp_sz) !=
+	    SLURM_SUCCESS) {
+		/* Open the interface again on the next poll */
+		close(t->acct_fd[file]);
+		t->acct_fd[file] = -1;
+		return SLURM_ERROR;
+	}
+
+	return SLURM_SUCCESS;
+}
+
 static int _rmdir_task(void *x, void *arg)
 {
 	task_cg_info_t *t = (task_cg_info_t *) x;
 
+	_close_task_acct_fds(t);
 	if (common_cgroup_delete(&t->task_cg) != SLURM_SUCCESS)
 		log_flag(CGROUP, "Failed to delete %s: %m", t->task_cg.path);
 
@@ -464,6 +544,7 @@ static int _find_task_cg_info(void *x, void *key)
 static int _find_purge_task_special(task_cg_info_t *task_ptr, uint32_t *id)
 {
 	if (task_ptr->taskid == *id) {
+		_close_task_acct_fds(task_ptr);
 		if (common_cgroup_delete(&task_ptr->task_cg) != SLURM_SUCCESS)
 			log_flag(CGROUP, "Failed to cleanup %s: %m",
 				 task_ptr->task_cg.path);
@@ -478,6 +559,7 @@ static void _free_task_cg_info(void *x)
 	task_cg_info_t *task_cg = (task_cg_info_t *)x;
 
 	if (task_cg) {
+		_close_task_acct_fds(task_cg);
 		common_cgroup_destroy(&task_cg->task_cg);
 		free_ebpf_prog(&task_cg->p);
 		xfree(task_cg);
@@ -1513,6 +1595,32 @@ extern int cgroup_p_step_resume(void)
 				       "cgroup.freeze", "0");
 }
 
+/* Kill the user processes of this step through cgroup.kill */
+extern int cgroup_p_step_kill(void)
+{
+	static int has_kill = -1;
+	char file_path[PATH_MAX];
+
+	/* This plugin is unloaded. */
+	if (!int_cg[CG_LEVEL_STEP_USER].path)
+		return SLURM_ERROR;
+
+	/* cgroup.kill was added in kernel 5.14 */
+	if (has_kill < 0) {
+		if (snprintf(file_path, PATH_MAX, "%s/cgroup.kill",
+			     int_cg[CG_LEVEL_STEP_USER].path) >= PATH_MAX)
+			return SLURM_ERROR;
+		has_kill = !access(file_path, F_OK);
+		log_flag(CGROUP, "cgroup.kill is %savailable",
+			 has_kill ? "" : "not ");
+	}
+	if (!has_kill)
+		return ESLURM_NOT_SUPPORTED;
+
+	return common_cgroup_set_param(&int_cg[CG_LEVEL_STEP_USER],
+				       "cgroup.kill", "1");
+}
+
 /*
  * Destroy the step cgroup. We need to move out ourselves to the root of
  * the cgroup filesystem first.
@@ -2084,6 +2192,9 @@ extern int cgroup_p_task_addto(cgroup_ctl_type_t ctl, stepd_step_rec_t *step,
 					     &task_id))) {
 		task_cg_info = xmalloc(sizeof(*task_cg_info));
 		task_cg_info->taskid = task_id;
+		task_cg_info->dir_fd = -1;
+		for (int i = 0; i < TASK_ACCT_CNT; i++)
+			task_cg_info->acct_fd[i] = -1;
 		need_to_add = true;
 	}
 
@@ -2153,7 +2264,6 @@ extern cgroup_acct_t *cgroup_p_task_get_acct_data(uint32_t task_id)
 	char *cpu_stat = NULL, *memory_stat = NULL, *memory_current = NULL;
 	char *memory_peak = NULL;
 	char *ptr;
-	size_t tmp_sz = 0;
 	cgroup_acct_t *stats = NULL;
 	task_cg_info_t *task_cg_info;
 	static bool interfaces_checked = false, memory_peak_interface = false;
@@ -2183,10 +2293,8 @@ extern cgroup_acct_t *cgroup_p_task_get_acct_data(uint32_t task_id)
 		interfaces_checked = true;
 	}
 
-	if (common_cgroup_get_param(&task_cg_info->task_cg,
-				    "cpu.stat",
-				    &cpu_stat,
-				    &tmp_sz) != SLURM_SUCCESS) {
+	if (_read_task_acct_file(task_cg_info, TASK_ACCT_CPU_STAT, &cpu_stat) !=
+	    SLURM_SUCCESS) {
 		if (task_id == task_special_id)
 			log_flag(CGROUP, "Cannot read task_special cpu.stat file");
 		else
@@ -2194,10 +2302,8 @@ extern cgroup_acct_t *cgroup_p_task_get_acct_data(uint32_t task_id)
 				 task_id);
 	}
 
-	if (common_cgroup_get_param(&task_cg_info->task_cg,
-				    "memory.current",
-				    &memory_current,
-				    &tmp_sz) != SLURM_SUCCESS) {
+	if (_read_task_acct_file(task_cg_info, TASK_ACCT_MEMORY_CURRENT, &memory_current) !=
+	    SLURM_SUCCESS) {
 		if (task_id == task_special_id)
 			log_flag(CGROUP, "Cannot read task_special memory.current file");
 		else
@@ -2205,10 +2311,8 @@ extern cgroup_acct_t *cgroup_p_task_get_acct_data(uint32_t task_id)
 				 task_id);
 	}
 
-	if (common_cgroup_get_param(&task_cg_info->task_cg,
-				    "memory.stat",
-				    &memory_stat,
-				    &tmp_sz) != SLURM_SUCCESS) {
+	if (_read_task_acct_file(task_cg_info, TASK_ACCT_MEMORY_STAT, &memory_stat) !=
+	    SLURM_SUCCESS) {
 		if (task_id == task_special_id)
 			log_flag(CGROUP, "Cannot read task_special memory.stat file");
 		else
@@ -2217,10 +2321,8 @@ extern cgroup_acct_t *cgroup_p_task_get_acct_data(uint32_t task_id)
 	}
 
 	if (memory_peak_interface) {
-		if (common_cgroup_get_param(&task_cg_info->task_cg,
-					    "memory.peak",
-					    &memory_peak,
-					    &tmp_sz) != SLURM_SUCCESS) {
+		if (_read_task_acct_file(task_cg_info, TASK_ACCT_MEMORY_PEAK,
+					 &memory_peak) != SLURM_SUCCESS) {
 			if (task_id == task_special_id)
 				log_flag(CGROUP, "Cannot read task_special memory.peak interface, does your OS support it?");
 			else
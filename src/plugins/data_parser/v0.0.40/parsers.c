@@ -35,6 +35,7 @@
 
 #include <limits.h>
 #include <math.h>
+#include <pthread.h>
 #include <signal.h>
 #include <stdint.h>
 #include <unistd.h>
@@ -7483,6 +7484,30 @@ static const parser_t PARSER_ARRAY(STATS_MSG)[] = {
 	add_skip(rpc_dump_count), /* TODO: implement */
 	add_skip(rpc_dump_types), /* TODO: implement */
 	add_skip(rpc_dump_hostlist), /* TODO: implement */
+	add_skip(lock_stats_hist_cnt),
+	add_skip(lock_stats_type_cnt),
+	add_skip(lock_stats_cnt),
+	add_skip(lock_stats_name),
+	add_skip(lock_stats_count),
+	add_skip(lock_stats_wait_time),
+	add_skip(lock_stats_wait_max),
+	add_skip(lock_stats_hold_time),
+	add_skip(lock_stats_hold_max),
+	add_skip(lock_stats_wait_hist),
+	add_skip(lock_stats_hold_hist),
+	add_skip(sched_phase_hist_cnt),
+	add_skip(sched_phase_cnt),
+	add_skip(sched_phase_name),
+	add_skip(sched_phase_count),
+	add_skip(sched_phase_time),
+	add_skip(sched_phase_max),
+	add_skip(sched_phase_hist),
+	add_skip(rpc_type_hist_cnt),
+	add_skip(rpc_type_time_hist),
+	add_skip(rpc_type_wait_hist),
+	add_skip(history_interval),
+	add_skip(history_cnt),
+	add_skip(history),
 };
 #undef add_parse
 #undef add_cparse
@@ -8373,6 +8398,7 @@ static const parser_t PARSER_ARRAY(JOB_DESC_MSG)[] = {
 	add_parse(STRING, script, "script", "Job batch script; only the first component in a HetJob is populated or honored"),
 	add_skip(script_buf),
 	add_skip(script_hash),
+	add_skip(script_stage_dir),
 	add_parse_overload(JOB_SHARED, shared, 2, "shared", "How the job can share resources with other jobs, if at all"),
 	add_parse_deprec(JOB_EXCLUSIVE, shared, 2, "exclusive", NULL, SLURM_23_11_PROTOCOL_VERSION),
 	add_parse_deprec(BOOL16, shared, 2, "oversubscribe", NULL, SLURM_23_11_PROTOCOL_VERSION),
@@ -10019,8 +10045,32 @@ extern void get_parsers(const parser_t **parsers_ptr, int *count_ptr)
 	*parsers_ptr = parsers;
 }
 
+/* parsers[] indexed by type, populated by parsers_init() */
+static const parser_t *parsers_by_type[DATA_PARSER_TYPE_MAX];
+static pthread_once_t parsers_by_type_once = PTHREAD_ONCE_INIT;
+
+static void _init_parsers_by_type(void)
+{
+	for (int i = 0; i < ARRAY_SIZE(parsers); i++) {
+		xassert(parsers[i].type > DATA_PARSER_TYPE_INVALID);
+		xassert(parsers[i].type < DATA_PARSER_TYPE_MAX);
+
+		/* keep first match like the linear search would */
+		if (!parsers_by_type[parsers[i].type])
+			parsers_by_type[parsers[i].type] = &parsers[i];
+	}
+}
+
 extern const parser_t *const find_parser_by_type(type_t type)
 {
+	/*
+	 * This is called for every field of every object parsed or dumped,
+	 * so avoid walking all of parsers[] each time.
+	 */
+	if ((type > DATA_PARSER_TYPE_INVALID) && (type < DATA_PARSER_TYPE_MAX)
+	    && parsers_by_type[type])
+		return parsers_by_type[type];
+
 	for (int i = 0; i < ARRAY_SIZE(parsers); i++)
 		if (parsers[i].type == type)
 			return &parsers[i];
@@ -10045,6 +10095,8 @@ extern const parser_t *unalias_parser(const parser_t *parser)
 
 extern void parsers_init(void)
 {
+	(void) pthread_once(&parsers_by_type_once, _init_parsers_by_type);
+
 #ifndef NDEBUG
 	/* sanity check the parsers */
 	for (int i = 0; i < ARRAY_SIZE(parsers); i++)
@@ -35,6 +35,7 @@
 
 #include <limits.h>
 #include <math.h>
+#include <pthread.h>
 #include <signal.h>
 #include <stdint.h>
 #include <unistd.h>
@@ -54,6 +55,7 @@
 #include "src/common/slurm_protocol_api.h"
 #include "src/common/slurm_protocol_defs.h"
 #include "src/common/slurmdbd_defs.h"
+#include "src/common/timers.h"
 #include "src/common/uid.h"
 #include "src/common/xassert.h"
 #include "src/common/xmalloc.h"
@@ -413,6 +415,12 @@ typedef struct {
 	uint16_t cycle_max;
 	uint64_t time;
 	uint64_t average_time;
+	uint64_t time_p50;
+	uint64_t time_p99;
+	uint64_t time_p999;
+	uint64_t wait_p50;
+	uint64_t wait_p99;
+	uint64_t wait_p999;
 } STATS_MSG_RPC_TYPE_t;
 
 typedef struct {
@@ -432,6 +440,14 @@ typedef struct {
 	const char *hostlist;
 } STATS_MSG_RPC_DUMP_t;
 
+typedef struct {
+	char *name;
+	uint64_t count;
+	uint64_t time;
+	uint64_t average_time;
+	uint64_t max_time;
+} STATS_MSG_SCHED_PHASE_t;
+
 #define KILL_JOBS_ARGS_MAGIC 0x08900abb
 typedef struct {
 	int magic; /* KILL_JOBS_ARGS_MAGIC */
@@ -3347,8 +3363,33 @@ static int DUMP_FUNC(STATS_MSG_RPCS_BY_TYPE)(const parser_t *const parser,
 			.count = stats->rpc_type_cnt[i],
 			.time = stats->rpc_type_time[i],
 			.average_time = NO_VAL64,
+			.time_p50 = NO_VAL64,
+			.time_p99 = NO_VAL64,
+			.time_p999 = NO_VAL64,
+			.wait_p50 = NO_VAL64,
+			.wait_p99 = NO_VAL64,
+			.wait_p999 = NO_VAL64,
 		};
 
+		if (stats->rpc_type_hist_cnt) {
+			uint32_t cnt = stats->rpc_type_hist_cnt;
+			uint32_t *time_hist = stats->rpc_type_time_hist + (i * cnt);
+			uint32_t *wait_hist = stats->rpc_type_wait_hist + (i * cnt);
+
+			rpc.time_p50 = latency_hist_percentile(time_hist, cnt,
+							       50);
+			rpc.time_p99 = latency_hist_percentile(time_hist, cnt,
+							       99);
+			rpc.time_p999 = latency_hist_percentile(time_hist, cnt,
+								99.9);
+			rpc.wait_p50 = latency_hist_percentile(wait_hist, cnt,
+							       50);
+			rpc.wait_p99 = latency_hist_percentile(wait_hist, cnt,
+							       99);
+			rpc.wait_p999 = latency_hist_percentile(wait_hist, cnt,
+								99.9);
+		}
+
 		if (stats->rpc_queue_enabled) {
 			rpc.queued = stats->rpc_type_queued[i];
 			rpc.dropped = stats->rpc_type_dropped[i];
@@ -3451,6 +3492,54 @@ static int DUMP_FUNC(STATS_MSG_RPCS_DUMP)(const parser_t *const parser,
 	return rc;
 }
 
+PARSE_DISABLED(STATS_MSG_SCHED_PHASES)
+
+static int DUMP_FUNC(STATS_MSG_SCHED_PHASES)(const parser_t *const parser,
+					     void *obj, data_t *dst,
+					     args_t *args)
+{
+	stats_info_response_msg_t *stats = obj;
+	int rc = SLURM_SUCCESS;
+
+	data_set_list(dst);
+
+	for (int i = 0; !rc && (i < stats->sched_phase_cnt); i++) {
+		STATS_MSG_SCHED_PHASE_t phase = {
+			.name = stats->sched_phase_name[i],
+			.count = stats->sched_phase_count[i],
+			.time = stats->sched_phase_time[i],
+			.average_time = NO_VAL64,
+			.max_time = stats->sched_phase_max[i],
+		};
+
+		if (stats->sched_phase_count[i] > 0)
+			phase.average_time = stats->sched_phase_time[i] /
+				stats->sched_phase_count[i];
+
+		rc = DUMP(STATS_MSG_SCHED_PHASE, phase, data_list_append(dst),
+			  args);
+	}
+
+	return rc;
+}
+
+PARSE_DISABLED(STATS_MSG_HISTORY)
+
+static int DUMP_FUNC(STATS_MSG_HISTORY)(const parser_t *const parser,
+					void *obj, data_t *dst, args_t *args)
+{
+	stats_info_response_msg_t *stats = obj;
+	int rc = SLURM_SUCCESS;
+
+	data_set_list(dst);
+
+	for (int i = 0; !rc && (i < stats->history_cnt); i++)
+		rc = DUMP(STATS_HISTORY, stats->history[i],
+			  data_list_append(dst), args);
+
+	return rc;
+}
+
 static data_for_each_cmd_t _parse_foreach_CSV_STRING_list(data_t *data,
 							  void *arg)
 {
@@ -7475,6 +7564,32 @@ static const parser_t PARSER_ARRAY(STATS_MSG)[] = {
 	add_skip(rpc_dump_count), /* handled by STATS_MSG_RPCS_DUMP */
 	add_skip(rpc_dump_types), /* handled by STATS_MSG_RPCS_DUMP */
 	add_skip(rpc_dump_hostlist), /* handled by STATS_MSG_RPCS_DUMP */
+	add_skip(lock_stats_hist_cnt),
+	add_skip(lock_stats_type_cnt),
+	add_skip(lock_stats_cnt),
+	add_skip(lock_stats_name),
+	add_skip(lock_stats_count),
+	add_skip(lock_stats_wait_time),
+	add_skip(lock_stats_wait_max),
+	add_skip(lock_stats_hold_time),
+	add_skip(lock_stats_hold_max),
+	add_skip(lock_stats_wait_hist),
+	add_skip(lock_stats_hold_hist),
+	add_cparse(STATS_MSG_SCHED_PHASES, "scheduler_phases", "Time spent in the phases of the scheduling cycles since last reset"),
+	add_skip(sched_phase_hist_cnt), /* handled by STATS_MSG_SCHED_PHASES */
+	add_skip(sched_phase_cnt), /* handled by STATS_MSG_SCHED_PHASES */
+	add_skip(sched_phase_name), /* handled by STATS_MSG_SCHED_PHASES */
+	add_skip(sched_phase_count), /* handled by STATS_MSG_SCHED_PHASES */
+	add_skip(sched_phase_time), /* handled by STATS_MSG_SCHED_PHASES */
+	add_skip(sched_phase_max), /* handled by STATS_MSG_SCHED_PHASES */
+	add_skip(sched_phase_hist), /* handled by STATS_MSG_SCHED_PHASES */
+	add_skip(rpc_type_hist_cnt), /* handled by STATS_MSG_RPCS_BY_TYPE */
+	add_skip(rpc_type_time_hist), /* handled by STATS_MSG_RPCS_BY_TYPE */
+	add_skip(rpc_type_wait_hist), /* handled by STATS_MSG_RPCS_BY_TYPE */
+	add_parse(UINT32, history_interval, "history_interval", "Seconds covered by each history sample"),
+	add_cparse(STATS_MSG_HISTORY, "history", "Statistics history samples, oldest first"),
+	add_skip(history_cnt), /* handled by STATS_MSG_HISTORY */
+	add_skip(history), /* handled by STATS_MSG_HISTORY */
 };
 #undef add_parse
 #undef add_cparse
@@ -8437,6 +8552,7 @@ static const parser_t PARSER_ARRAY(JOB_DESC_MSG)[] = {
 	add_parse(STRING, script, "script", "Job batch script; only the first component in a HetJob is populated or honored"),
 	add_skip(script_buf),
 	add_skip(script_hash),
+	add_skip(script_stage_dir),
 	add_parse(JOB_SHARED, shared, "shared", "How the job can share resources with other jobs, if at all"),
 	add_parse(UINT32, site_factor, "site_factor", "Site-specific priority factor"),
 	add_cparse(JOB_DESC_MSG_SPANK_ENV, "spank_environment", "Environment variables for job prolog/epilog scripts as set by SPANK plugins"),
@@ -9272,6 +9388,12 @@ static const parser_t PARSER_ARRAY(STATS_MSG_RPC_TYPE)[] = {
 	add_parse_req(UINT16, cycle_max, "cycle_max", "Maximum number of RPCs processed within a RPC queue cycle since start"),
 	add_parse_req(UINT64, time, "total_time", "Total time spent processing RPC in seconds"),
 	add_parse_req(UINT64_NO_VAL, average_time, "average_time", "Average time spent processing RPC in seconds"),
+	add_parse_req(UINT64_NO_VAL, time_p50, "processing_time/p50", "Median time spent processing RPC in microseconds"),
+	add_parse_req(UINT64_NO_VAL, time_p99, "processing_time/p99", "99th percentile of time spent processing RPC in microseconds"),
+	add_parse_req(UINT64_NO_VAL, time_p999, "processing_time/p999", "99.9th percentile of time spent processing RPC in microseconds"),
+	add_parse_req(UINT64_NO_VAL, wait_p50, "queue_wait/p50", "Median time RPC waited before processing in microseconds"),
+	add_parse_req(UINT64_NO_VAL, wait_p99, "queue_wait/p99", "99th percentile of time RPC waited before processing in microseconds"),
+	add_parse_req(UINT64_NO_VAL, wait_p999, "queue_wait/p999", "99.9th percentile of time RPC waited before processing in microseconds"),
 };
 #undef add_parse_req
 #undef add_parse_req_overload
@@ -9314,6 +9436,45 @@ static const parser_t PARSER_ARRAY(STATS_MSG_RPC_DUMP)[] = {
 #undef add_parse_req
 #undef add_parse_req_overload
 
+#define add_parse_req(mtype, field, path, desc) \
+	add_parser(STATS_MSG_SCHED_PHASE_t, mtype, true, field, 0, path, desc)
+static const parser_t PARSER_ARRAY(STATS_MSG_SCHED_PHASE)[] = {
+	add_parse_req(STRING, name, "phase", "Scheduling phase"),
+	add_parse_req(UINT64, count, "count", "Number of times the phase ran"),
+	add_parse_req(UINT64, time, "total_time", "Total time spent in the phase in microseconds"),
+	add_parse_req(UINT64_NO_VAL, average_time, "average_time", "Average time spent in the phase in microseconds"),
+	add_parse_req(UINT64, max_time, "max_time", "Longest time spent in the phase in microseconds"),
+};
+#undef add_parse_req
+
+#define add_parse_req(mtype, field, path, desc) \
+	add_parser(stats_history_t, mtype, true, field, 0, path, desc)
+static const parser_t PARSER_ARRAY(STATS_HISTORY)[] = {
+	add_parse_req(TIMESTAMP, sample_time, "time", "End of the sample interval (UNIX timestamp)"),
+	add_parse_req(UINT32, schedule_cycles, "schedule/cycles", "Main scheduler cycles in the interval"),
+	add_parse_req(UINT64, schedule_cycle_sum, "schedule/total_time", "Time spent in main scheduler cycles in microseconds"),
+	add_parse_req(UINT32, schedule_cycle_last, "schedule/last_time", "Time of the last main scheduler cycle in microseconds"),
+	add_parse_req(UINT32, schedule_depth_sum, "schedule/total_depth", "Jobs tested by main scheduler cycles in the interval"),
+	add_parse_req(UINT32, schedule_queue_len, "schedule/queue_length", "Main scheduler queue length at the end of the interval"),
+	add_parse_req(UINT32, bf_cycles, "backfill/cycles", "Backfill cycles in the interval"),
+	add_parse_req(UINT64, bf_cycle_sum, "backfill/total_time", "Time spent in backfill cycles in microseconds"),
+	add_parse_req(UINT32, bf_cycle_last, "backfill/last_time", "Time of the last backfill cycle in microseconds"),
+	add_parse_req(UINT32, bf_depth_sum, "backfill/total_depth", "Jobs tested by backfill cycles in the interval"),
+	add_parse_req(UINT32, bf_backfilled_jobs, "backfill/jobs", "Jobs started by backfill in the interval"),
+	add_parse_req(UINT32, jobs_submitted, "jobs/submitted", "Jobs submitted in the interval"),
+	add_parse_req(UINT32, jobs_started, "jobs/started", "Jobs started in the interval"),
+	add_parse_req(UINT32, jobs_completed, "jobs/completed", "Jobs completed in the interval"),
+	add_parse_req(UINT32, jobs_canceled, "jobs/canceled", "Jobs canceled in the interval"),
+	add_parse_req(UINT32, jobs_failed, "jobs/failed", "Jobs failed in the interval"),
+	add_parse_req(UINT32, jobs_pending, "jobs/pending", "Pending jobs at the end of the interval"),
+	add_parse_req(UINT32, jobs_running, "jobs/running", "Running jobs at the end of the interval"),
+	add_parse_req(UINT64, rpc_count, "rpcs/count", "RPCs processed in the interval"),
+	add_parse_req(UINT64, rpc_time, "rpcs/total_time", "Time spent processing RPCs in microseconds"),
+	add_parse_req(UINT32, server_thread_count, "server_thread_count", "Server threads at the end of the interval"),
+	add_parse_req(UINT32, agent_queue_size, "agent_queue_size", "Agent queue size at the end of the interval"),
+};
+#undef add_parse_req
+
 #define add_parse_req(mtype, field, path, desc) \
 	add_parser(job_state_response_job_t, mtype, true, field, 0, path, desc)
 #define add_cparse_req(mtype, path, desc) \
@@ -9953,6 +10114,8 @@ static const parser_t parsers[] = {
 	addpca(STATS_MSG_RPCS_BY_USER, STATS_MSG_RPC_USER, stats_info_response_msg_t, NEED_NONE, "RPCs by user"),
 	addpca(STATS_MSG_RPCS_QUEUE, STATS_MSG_RPC_QUEUE, stats_info_response_msg_t, NEED_NONE, "Pending RPCs"),
 	addpca(STATS_MSG_RPCS_DUMP, STATS_MSG_RPC_DUMP, stats_info_response_msg_t, NEED_NONE, "Pending RPCs by hostlist"),
+	addpca(STATS_MSG_SCHED_PHASES, STATS_MSG_SCHED_PHASE, stats_info_response_msg_t, NEED_NONE, "Scheduling cycle phases"),
+	addpca(STATS_MSG_HISTORY, STATS_HISTORY, stats_info_response_msg_t, NEED_NONE, "Statistics history samples"),
 	addpc(NODE_SELECT_ALLOC_MEMORY, node_info_t, NEED_NONE, INT64, NULL),
 	addpc(NODE_SELECT_ALLOC_CPUS, node_info_t, NEED_NONE, INT32, NULL),
 	addpc(NODE_SELECT_ALLOC_IDLE_CPUS, node_info_t, NEED_NONE, INT32, NULL),
@@ -10128,6 +10291,8 @@ static const parser_t parsers[] = {
 	addpap(STATS_MSG_RPC_USER, STATS_MSG_RPC_USER_t, NULL, NULL),
 	addpap(STATS_MSG_RPC_QUEUE, STATS_MSG_RPC_QUEUE_t, NULL, NULL),
 	addpap(STATS_MSG_RPC_DUMP, STATS_MSG_RPC_DUMP_t, NULL, NULL),
+	addpap(STATS_MSG_SCHED_PHASE, STATS_MSG_SCHED_PHASE_t, NULL, NULL),
+	addpap(STATS_HISTORY, stats_history_t, NULL, NULL),
 	addpap(PART_PRIO, PART_PRIO_t, NULL, NULL),
 	addpap(JOB_STATE_RESP_JOB, job_state_response_job_t, NULL, NULL),
 	addpap(OPENAPI_JOB_STATE_QUERY, openapi_job_state_query_t, NULL, NULL),
@@ -10264,8 +10429,32 @@ extern void get_parsers(const parser_t **parsers_ptr, int *count_ptr)
 	*parsers_ptr = parsers;
 }
 
+/* parsers[] indexed by type, populated by parsers_init() */
+static const parser_t *parsers_by_type[DATA_PARSER_TYPE_MAX];
+static pthread_once_t parsers_by_type_once = PTHREAD_ONCE_INIT;
+
+static void _init_parsers_by_type(void)
+{
+	for (int i = 0; i < ARRAY_SIZE(parsers); i++) {
+		xassert(parsers[i].type > DATA_PARSER_TYPE_INVALID);
+		xassert(parsers[i].type < DATA_PARSER_TYPE_MAX);
+
+		/* keep first match like the linear search would */
+		if (!parsers_by_type[parsers[i].type])
+			parsers_by_type[parsers[i].type] = &parsers[i];
+	}
+}
+
 extern const parser_t *const find_parser_by_type(type_t type)
 {
+	/*
+	 * This is called for every field of every object parsed or dumped,
+	 * so avoid walking all of parsers[] each time.
+	 */
+	if ((type > DATA_PARSER_TYPE_INVALID) && (type < DATA_PARSER_TYPE_MAX)
+	    && parsers_by_type[type])
+		return parsers_by_type[type];
+
 	for (int i = 0; i < ARRAY_SIZE(parsers); i++)
 		if (parsers[i].type == type)
 			return &parsers[i];
@@ -10290,6 +10479,8 @@ extern const parser_t *unalias_parser(const parser_t *parser)
 
 extern void parsers_init(void)
 {
+	(void) pthread_once(&parsers_by_type_once, _init_parsers_by_type);
+
 #ifndef NDEBUG
 	/* sanity check the parsers */
 	for (int i = 0; i < ARRAY_SIZE(parsers); i++)
@@ -107,6 +107,12 @@ static int gpumem_pos = -1;
 static int gpuutil_pos = -1;
 static pid_t init_pid = 0;
 
+/* Device handles used by gpu_p_usage_read(), looked up once per nvmlInit() */
+static nvmlDevice_t *usage_devices = NULL;
+static unsigned int usage_device_cnt = 0;
+static pid_t usage_devices_pid = 0;
+static pthread_mutex_t usage_devices_lock = PTHREAD_MUTEX_INITIALIZER;
+
 /*
  * Converts a cpu_set returned from the NVML API into a Slurm bitstr_t
  *
@@ -204,6 +210,11 @@ static void _nvml_shutdown(void)
 	START_TIMER;
 	nvml_rc = nvmlShutdown();
 	init_pid = 0;
+	slurm_mutex_lock(&usage_devices_lock);
+	xfree(usage_devices);
+	usage_device_cnt = 0;
+	usage_devices_pid = 0;
+	slurm_mutex_unlock(&usage_devices_lock);
 	END_TIMER;
 	debug3("nvmlShutdown() took %ld microseconds", DELTA_TIMER);
 	if (nvml_rc != NVML_SUCCESS)
@@ -547,31 +558,36 @@ static unsigned int _nvml_get_mem_freq(nvmlDevice_t *device)
  */
 static void _reset_freq(bitstr_t *gpus)
 {
-	int gpu_len = bit_size(gpus);
 	int i = -1, count = 0, count_set = 0;
 	bool freq_reset = false;
+	bool log_freqs = (get_log_level() >= LOG_LEVEL_DEBUG2);
+	DEF_TIMERS;
 
+	START_TIMER;
 	/*
 	 * Reset the frequency of each device allocated to the step
 	 */
-	for (i = 0; i < gpu_len; i++) {
+	for (i = 0; (i = bit_ffs_from_bit(gpus, i)) >= 0; i++) {
 		nvmlDevice_t device;
-		if (!bit_test(gpus, i))
-			continue;
 		count++;
 
 		if (!_nvml_get_handle(i, &device))
 			continue;
 
-		debug2("Memory frequency before reset: %u",
-		       _nvml_get_mem_freq(&device));
-		debug2("Graphics frequency before reset: %u",
-		       _nvml_get_gfx_freq(&device));
+		/* Only query the clocks when they will be logged */
+		if (log_freqs) {
+			debug2("Memory frequency before reset: %u",
+			       _nvml_get_mem_freq(&device));
+			debug2("Graphics frequency before reset: %u",
+			       _nvml_get_gfx_freq(&device));
+		}
 		freq_reset =_nvml_reset_freqs(&device);
-		debug2("Memory frequency after reset: %u",
-		       _nvml_get_mem_freq(&device));
-		debug2("Graphics frequency after reset: %u",
-		       _nvml_get_gfx_freq(&device));
+		if (log_freqs) {
+			debug2("Memory frequency after reset: %u",
+			       _nvml_get_mem_freq(&device));
+			debug2("Graphics frequency after reset: %u",
+			       _nvml_get_gfx_freq(&device));
+		}
 
 		if (freq_reset) {
 			log_flag(GRES, "Successfully reset GPU[%d]", i);
@@ -587,6 +603,9 @@ static void _reset_freq(bitstr_t *gpus)
 		fprintf(stderr, "Could not reset frequencies for all GPUs. "
 			"Set %d/%d total GPUs\n", count_set, count);
 	}
+	END_TIMER;
+	log_flag(GRES, "%s: reset %d/%d GPUs in %ld microseconds",
+		 __func__, count_set, count, DELTA_TIMER);
 }
 
 /*
@@ -610,6 +629,8 @@ static void _set_freq(bitstr_t *gpus, char *gpu_freq)
 	bool task_cgroup = false;
 	bool constrained_devices = false;
 	bool cgroups_active = false;
+	bool log_freqs = (get_log_level() >= LOG_LEVEL_DEBUG2);
+	DEF_TIMERS;
 
 	/*
 	 * Parse frequency information
@@ -653,6 +674,7 @@ static void _set_freq(bitstr_t *gpus, char *gpu_freq)
 		       __func__);
 	}
 
+	START_TIMER;
 	/*
 	 * Set the frequency of each device allocated to the step
 	 */
@@ -660,6 +682,7 @@ static void _set_freq(bitstr_t *gpus, char *gpu_freq)
 		char *sep = "";
 		nvmlDevice_t device;
 		unsigned int gpu_freq = gpu_freq_num, mem_freq = mem_freq_num;
+		unsigned int cur_gfx_freq, cur_mem_freq;
 
 		// Only check the global GPU bitstring if not using cgroups
 		if (!cgroups_active && !bit_test(gpus, i)) {
@@ -673,15 +696,26 @@ static void _set_freq(bitstr_t *gpus, char *gpu_freq)
 		debug2("Setting frequency of NVML device %u", i);
 		_nvml_get_nearest_freqs(&device, &mem_freq, &gpu_freq);
 
-		debug2("Memory frequency before set: %u",
-		       _nvml_get_mem_freq(&device));
-		debug2("Graphics frequency before set: %u",
-		       _nvml_get_gfx_freq(&device));
-		freq_set = _nvml_set_freqs(&device, mem_freq, gpu_freq);
-		debug2("Memory frequency after set: %u",
-		       _nvml_get_mem_freq(&device));
-		debug2("Graphics frequency after set: %u",
-		       _nvml_get_gfx_freq(&device));
+		cur_mem_freq = _nvml_get_mem_freq(&device);
+		cur_gfx_freq = _nvml_get_gfx_freq(&device);
+		debug2("Memory frequency before set: %u", cur_mem_freq);
+		debug2("Graphics frequency before set: %u", cur_gfx_freq);
+		if (cur_mem_freq && (cur_mem_freq == mem_freq) &&
+		    cur_gfx_freq && (cur_gfx_freq == gpu_freq)) {
+			/* Already at the requested clocks, nothing to do */
+			debug2("NVML device %u already at requested frequencies",
+			       i);
+			freq_set = true;
+		} else {
+			freq_set = _nvml_set_freqs(&device, mem_freq,
+						   gpu_freq);
+			if (log_freqs) {
+				debug2("Memory frequency after set: %u",
+				       _nvml_get_mem_freq(&device));
+				debug2("Graphics frequency after set: %u",
+				       _nvml_get_gfx_freq(&device));
+			}
+		}
 
 		if (mem_freq) {
 			xstrfmtcat(tmp, "%smemory_freq:%u", sep, mem_freq);
@@ -711,6 +745,9 @@ static void _set_freq(bitstr_t *gpus, char *gpu_freq)
 		fprintf(stderr, "Could not set frequencies for all GPUs. "
 			"Set %d/%d total GPUs\n", count_set, count);
 	}
+	END_TIMER;
+	log_flag(GRES, "%s: set %d/%d GPUs in %ld microseconds",
+		 __func__, count_set, count, DELTA_TIMER);
 }
 
 
@@ -1833,9 +1870,32 @@ extern int gpu_p_energy_read(uint32_t dv_ind, gpu_status_t *gpu)
 	return SLURM_SUCCESS;
 }
 
-extern int gpu_p_usage_read(pid_t pid, acct_gather_data_t *data)
+/*
+ * Fill usage_devices with the handles of all GPUs, unless that was already
+ * done since the last nvmlInit(). Caller must hold usage_devices_lock.
+ */
+static void _load_usage_devices(void)
 {
 	unsigned int device_count = 0;
+
+	if (usage_devices_pid && (usage_devices_pid == init_pid))
+		return;
+
+	xfree(usage_devices);
+	usage_device_cnt = 0;
+
+	gpu_p_get_device_count(&device_count);
+	if (device_count)
+		usage_devices = xcalloc(device_count, sizeof(nvmlDevice_t));
+	for (int i = 0; i < device_count; i++) {
+		if (_nvml_get_handle(i, &usage_devices[usage_device_cnt]))
+			usage_device_cnt++;
+	}
+	usage_devices_pid = init_pid;
+}
+
+extern int gpu_p_usage_read(pid_t pid, acct_gather_data_t *data)
+{
 	bool track_gpumem, track_gpuutil;
 
 	track_gpumem = (gpumem_pos != -1);
@@ -1847,16 +1907,14 @@ extern int gpu_p_usage_read(pid_t pid, acct_gather_data_t *data)
 	}
 
 	_nvml_init();
-	gpu_p_get_device_count(&device_count);
 
 	data[gpumem_pos].size_read = 0;
 	data[gpuutil_pos].size_read = 0;
 
-	for (int i = 0; i < device_count; i++) {
-		nvmlDevice_t device;
-
-		if (!_nvml_get_handle(i, &device))
-			continue;
+	slurm_mutex_lock(&usage_devices_lock);
+	_load_usage_devices();
+	for (int i = 0; i < usage_device_cnt; i++) {
+		nvmlDevice_t device = usage_devices[i];
 
 		if (track_gpumem)
 			_get_gpumem(device, pid, data);
@@ -1868,6 +1926,7 @@ extern int gpu_p_usage_read(pid_t pid, acct_gather_data_t *data)
 			 data[gpuutil_pos].size_read,
 			 data[gpumem_pos].size_read / 1048576);
 	}
+	slurm_mutex_unlock(&usage_devices_lock);
 
 	return SLURM_SUCCESS;
 }
@@ -98,3 +98,25 @@ extern int hash_p_compute(char *input, int len, char *custom_str, int cs_len,
 
 	return (sizeof(hash->hash));
 }
+
+extern int hash_p_compute_iov(const struct iovec *iov, int iovcnt,
+			      char *custom_str, int cs_len, slurm_hash_t *hash)
+{
+	KangarooTwelve_Instance kt;
+
+	if (KangarooTwelve_Initialize(&kt, sizeof(hash->hash)))
+		return -1;
+
+	for (int i = 0; i < iovcnt; i++)
+		if (KangarooTwelve_Update(&kt, iov[i].iov_base,
+					  iov[i].iov_len))
+			return -1;
+
+	if (KangarooTwelve_Final(&kt, hash->hash, (unsigned char *) custom_str,
+				 cs_len))
+		return -1;
+
+	hash->type = HASH_PLUGIN_K12;
+
+	return (sizeof(hash->hash));
+}
@@ -112,3 +112,29 @@ extern int hash_p_compute(char *input, int len, char *custom_str, int cs_len,
 
 	return (sizeof(hash->hash));
 }
+
+extern int hash_p_compute_iov(const struct iovec *iov, int iovcnt,
+			      char *custom_str, int cs_len, slurm_hash_t *hash)
+{
+	Keccak_HashInstance hi;
+
+	if (Keccak_HashInitialize_SHA3_256(&hi))
+		return SLURM_ERROR;
+
+	for (int i = 0; i < iovcnt; i++)
+		if (Keccak_HashUpdate(&hi, (BitSequence *) iov[i].iov_base,
+				      (iov[i].iov_len * 8)))
+			return SLURM_ERROR;
+
+	/* Append the customization string the same as hash_p_compute() */
+	if (cs_len)
+		if (Keccak_HashUpdate(&hi, (BitSequence *) custom_str, (cs_len * 8)))
+			return SLURM_ERROR;
+
+	if (Keccak_HashFinal(&hi, (BitSequence*) hash->hash))
+		return SLURM_ERROR;
+
+	hash->type = HASH_PLUGIN_SHA3;
+
+	return (sizeof(hash->hash));
+}
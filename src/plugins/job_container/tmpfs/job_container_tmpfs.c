@@ -570,15 +570,15 @@ static int _create_ns(uint32_t job_id, stepd_step_rec_t *step)
 		}
 
 		/*
-		 * This umount is to remove the basepath mount from being
+		 * This umount is to remove the basepath mounts from being
 		 * visible inside the namespace. So if a user looks up the
 		 * mounts inside the job, they will only see their job mount
-		 * but not the basepath mount.
+		 * but not the basepath mount. The mounts of the other jobs on
+		 * the node are removed too, otherwise every namespace would
+		 * keep a copy of them, growing with the number of jobs and
+		 * holding the other jobs' namespaces alive after they end.
 		 */
-		if (jc_conf->shared)
-			rc = _clean_job_basepath(job_id);
-		else
-			rc = umount2(job_mount, MNT_DETACH);
+		rc = _clean_job_basepath(job_id);
 		if (rc) {
 			error("%s: failed to clean job mount(s): %m", __func__);
 			goto child_exit;
@@ -112,6 +112,10 @@ static const char *req_fxns[] = {
  */
 static pthread_mutex_t lua_lock = PTHREAD_MUTEX_INITIALIZER;
 
+/* Registry keys for the tables shared by all job record tables */
+#define JOB_REC_MT "job_submit_lua_job_rec_mt"
+#define JOB_REC_MAP "job_submit_lua_job_rec_map"
+
 typedef struct {
 	uint32_t submit_uid;
 	uint32_t user_id;
@@ -210,39 +214,71 @@ static int _job_rec_field_index(lua_State *L)
 	const char *name = luaL_checkstring(L, 2);
 	job_record_t *job_ptr;
 
-	lua_getmetatable(L, -2);
-	lua_getfield(L, -1, "_job_rec_ptr");
+	lua_getfield(L, LUA_REGISTRYINDEX, JOB_REC_MAP);
+	lua_pushvalue(L, 1);
+	lua_rawget(L, -2);
 	job_ptr = lua_touserdata(L, -1);
 
 	return slurm_lua_job_record_field(L, job_ptr, name);
 }
 
+/*
+ * Push the metatable shared by every job record table, followed by the
+ * weak-keyed table mapping each job record table to its job_record_t.
+ * Both are created on first use and kept in the registry, so building
+ * slurm.jobs only costs one empty table per job.
+ */
+static void _push_job_rec_meta(lua_State *st)
+{
+	lua_getfield(st, LUA_REGISTRYINDEX, JOB_REC_MT);
+	if (lua_isnil(st, -1)) {
+		lua_pop(st, 1);
+		lua_newtable(st);
+		lua_pushcfunction(st, _job_rec_field_index);
+		lua_setfield(st, -2, "__index");
+		lua_pushvalue(st, -1);
+		lua_setfield(st, LUA_REGISTRYINDEX, JOB_REC_MT);
+	}
+
+	lua_getfield(st, LUA_REGISTRYINDEX, JOB_REC_MAP);
+	if (lua_isnil(st, -1)) {
+		lua_pop(st, 1);
+		lua_newtable(st);
+		lua_newtable(st);
+		lua_pushstring(st, "k");
+		lua_setfield(st, -2, "__mode");
+		lua_setmetatable(st, -2);
+		lua_pushvalue(st, -1);
+		lua_setfield(st, LUA_REGISTRYINDEX, JOB_REC_MAP);
+	}
+}
+
+/*
+ * Create an empty table that looks up the data for job_ptr through the
+ * shared metatable. Expects _push_job_rec_meta() output on top of the stack.
+ */
+static void _push_job_rec_table(lua_State *st, job_record_t *job_ptr)
+{
+	lua_newtable(st);
+	lua_pushvalue(st, -3);
+	lua_setmetatable(st, -2);
+
+	lua_pushvalue(st, -1);
+	lua_pushlightuserdata(st, job_ptr);
+	lua_rawset(st, -4);
+}
+
 static int _foreach_update_jobs_global(void *x, void *arg)
 {
 	char job_id_buf[11]; /* Big enough for a uint32_t */
 	job_record_t *job_ptr = x;
 	lua_State *st = arg;
 
-	/*
-	 * Create an empty table, with a metatable that looks up the
-	 * data for the individual job.
-	 */
-	lua_newtable(st);
-
-	lua_newtable(st);
-	lua_pushcfunction(st, _job_rec_field_index);
-	lua_setfield(st, -2, "__index");
-	/*
-	 * Store the job_record in the metatable, so the index
-	 * function knows which job it's getting data for.
-	 */
-	lua_pushlightuserdata(st, job_ptr);
-	lua_setfield(st, -2, "_job_rec_ptr");
-	lua_setmetatable(st, -2);
+	_push_job_rec_table(st, job_ptr);
 
 	/* Lua copies passed strings, so we can reuse the buffer. */
 	snprintf(job_id_buf, sizeof(job_id_buf), "%d", job_ptr->job_id);
-	lua_setfield(st, -2, job_id_buf);
+	lua_setfield(st, -4, job_id_buf);
 
 	return 0;
 }
@@ -256,10 +292,12 @@ static void _update_jobs_global(lua_State *st)
 
 	lua_getglobal(st, "slurm");
 	lua_newtable(st);
+	_push_job_rec_meta(st);
 
 	list_for_each(job_list, _foreach_update_jobs_global, st);
 	last_lua_jobs_update = last_job_update;
 
+	lua_pop(st, 2);
 	lua_setfield(st, -2, "jobs");
 	lua_pop(st, 1);
 }
@@ -769,6 +807,25 @@ static int _get_job_req_field_index(lua_State *L)
 	lua_getfield(L, -1, "_job_desc");
 	job_desc = lua_touserdata(L, -1);
 
+	/*
+	 * The environment proxy table and the batch script string are only
+	 * built on first access and then kept in the metatable, so scripts
+	 * reading them repeatedly don't pay for a new table or a copy of the
+	 * whole script each time. _set_job_req_field() drops the cached
+	 * script when it is replaced.
+	 */
+	if (!xstrcmp(name, "environment") || !xstrcmp(name, "script")) {
+		lua_getfield(L, 3, name);
+		if (!lua_isnil(L, -1))
+			return 1;
+		lua_pop(L, 1);
+
+		_get_job_req_field(job_desc, name);
+		lua_pushvalue(L, -1);
+		lua_setfield(L, 3, name);
+		return 1;
+	}
+
 	return _get_job_req_field(job_desc, name);
 }
 
@@ -983,6 +1040,9 @@ static int _set_job_req_field(lua_State *L)
 		xfree(job_desc->script);
 		if (strlen(value_str))
 			job_desc->script = xstrdup(value_str);
+		/* Drop the copy cached by _get_job_req_field_index() */
+		lua_pushnil(L);
+		lua_setfield(L, 4, "script");
 	} else if (!xstrcmp(name, "selinux_context")) {
 		value_str = luaL_checkstring(L, 3);
 		xfree(job_desc->selinux_context);
@@ -1087,17 +1147,11 @@ static void _push_job_desc(job_desc_msg_t *job_desc)
 
 static void _push_job_rec(job_record_t *job_ptr)
 {
-	lua_newtable(L);
-
-	lua_newtable(L);
-	lua_pushcfunction(L, _job_rec_field_index);
-	lua_setfield(L, -2, "__index");
-	/* Store the job_ptr in the metatable, so the index
-	 * function knows which struct it's getting data for.
-	 */
-	lua_pushlightuserdata(L, job_ptr);
-	lua_setfield(L, -2, "_job_rec_ptr");
-	lua_setmetatable(L, -2);
+	_push_job_rec_meta(L);
+	_push_job_rec_table(L, job_ptr);
+	/* Leave only the job record table on the stack */
+	lua_replace(L, -3);
+	lua_pop(L, 1);
 }
 
 /* Get fields in an existing slurmctld partition record
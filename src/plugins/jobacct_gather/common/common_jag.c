@@ -52,6 +52,7 @@
 #include "src/interfaces/acct_gather_energy.h"
 #include "src/interfaces/acct_gather_filesystem.h"
 #include "src/interfaces/acct_gather_interconnect.h"
+#include "src/common/xhash.h"
 #include "src/common/xstring.h"
 #include "src/interfaces/proctrack.h"
 
@@ -73,19 +74,22 @@ char **assoc_mgr_tres_name_array;
 static int cpunfo_frequency = 0;
 static long conv_units = 0;
 list_t *prec_list = NULL;
+static xhash_t *prec_hash = NULL; /* precs in prec_list by pid */
 
 static int my_pagesize = 0;
 static int energy_profile = ENERGY_DATA_NODE_ENERGY_UP;
 
-static int _find_prec(void *x, void *key)
+static void _prec_hash_id(void *item, const char **key, uint32_t *key_len)
 {
-	jag_prec_t *prec = (jag_prec_t *) x;
-	pid_t pid = *(pid_t *) key;
+	jag_prec_t *prec = item;
 
-	if (prec->pid == pid)
-		return 1;
+	*key = (const char *) &prec->pid;
+	*key_len = sizeof(prec->pid);
+}
 
-	return 0;
+static jag_prec_t *_find_prec(pid_t pid)
+{
+	return xhash_get(prec_hash, (const char *) &pid, sizeof(pid));
 }
 
 /* return weighted frequency in mhz */
@@ -526,7 +530,7 @@ static void _handle_stats(pid_t pid, jag_callbacks_t *callbacks, int tres_count)
 	FILE *stat_fp = NULL;
 	FILE *io_fp = NULL;
 	int fd, fd2;
-	jag_prec_t *prec = NULL;
+	jag_prec_t *prec = NULL, *old_prec;
 
 	/* UsePSS and NoShare are only compatible with the linux plugin. */
 	if ((no_share_data == -1) &&
@@ -627,8 +631,15 @@ static void _handle_stats(pid_t pid, jag_callbacks_t *callbacks, int tres_count)
 		fclose(io_fp);
 	}
 
-	destroy_jag_prec(list_remove_first(prec_list, _find_prec, &prec->pid));
-	list_append(prec_list, prec);
+	if ((old_prec = _find_prec(prec->pid))) {
+		/* Update the existing record in place */
+		xfree(old_prec->tres_data);
+		*old_prec = *prec;
+		xfree(prec);
+	} else {
+		list_append(prec_list, prec);
+		xhash_add(prec_hash, prec);
+	}
 	xfree(proc_file);
 	return;
 
@@ -834,6 +845,7 @@ extern void jag_common_init(long plugin_units)
 	uint32_t profile_opt;
 
 	prec_list = list_create(destroy_jag_prec);
+	prec_hash = xhash_init(_prec_hash_id, NULL);
 
 	acct_gather_profile_g_get(ACCT_GATHER_PROFILE_RUNNING,
 				  &profile_opt);
@@ -854,6 +866,7 @@ extern void jag_common_init(long plugin_units)
 
 extern void jag_common_fini(void)
 {
+	xhash_free(prec_hash);
 	FREE_NULL_LIST(prec_list);
 }
 
@@ -897,24 +910,36 @@ static void _print_jag_prec(jag_prec_t *prec)
 	log_flag(JAG, "usec \t%f", prec->usec);
 }
 
-static int _list_find_prec_by_pid(void *x, void *key)
+static int _reset_links(void *x, void *arg)
 {
-        jag_prec_t *j = (jag_prec_t *) x;
-        pid_t pid = *(pid_t *) key;
+	jag_prec_t *prec = x;
 
-        if (!j->visited && (j->pid == pid))
-                return 1;
-        return 0;
+	prec->first_child = NULL;
+	prec->next_sibling = NULL;
+
+	return SLURM_SUCCESS;
 }
 
-static int _list_find_prec_by_ppid(void *x, void *key)
+static int _link_to_parent(void *x, void *arg)
 {
-        jag_prec_t *j = (jag_prec_t *) x;
-        pid_t pid = *(pid_t *) key;
+	jag_prec_t *prec = x, *parent;
 
-        if (!j->visited && (j->ppid == pid))
-                return 1;
-        return 0;
+	if ((prec->ppid != prec->pid) && (parent = _find_prec(prec->ppid))) {
+		prec->next_sibling = parent->first_child;
+		parent->first_child = prec;
+	}
+
+	return SLURM_SUCCESS;
+}
+
+/*
+ * Link every prec to its parent, so _get_offspring_data() can walk the
+ * process tree without searching prec_list for each generation.
+ */
+static void _link_precs(list_t *prec_list)
+{
+	(void) list_for_each(prec_list, _reset_links, NULL);
+	(void) list_for_each(prec_list, _link_to_parent, NULL);
 }
 
 static int _reset_visited(jag_prec_t *prec, void *empty)
@@ -924,6 +949,18 @@ static int _reset_visited(jag_prec_t *prec, void *empty)
 	return SLURM_SUCCESS;
 }
 
+static int _remove_aggregated(void *x, void *arg)
+{
+	jag_prec_t *prec = x;
+
+	if (!prec->removed)
+		return 0;
+
+	log_flag(JAG, "Removing completed process %d", prec->pid);
+	xhash_pop(prec_hash, (const char *) &prec->pid, sizeof(prec->pid));
+	return 1;
+}
+
 static void _aggregate_prec(jag_prec_t *prec, jag_prec_t *ancestor)
 {
 	int i;
@@ -982,7 +1019,7 @@ static void _aggregate_prec(jag_prec_t *prec, jag_prec_t *ancestor)
  * usage data to the ancestor's <prec> record. Recurse to gather data
  * for *all* subsequent generations.
  *
- * IN:	prec_list       list of prec's
+ * IN:	prec_list       list of prec's, linked by _link_precs()
  *      ancestor	The entry in precTable[] to which the data
  *			should be added. Even as we recurse, this will
  *			always be the prec for the base of the family
@@ -1003,42 +1040,45 @@ static void _get_offspring_data(list_t *prec_list, jag_prec_t *ancestor,
 {
 	jag_prec_t *prec = NULL;
 	jag_prec_t *prec_tmp = NULL;
-	list_t *tmp_list = NULL;
-
-	/* reset all precs to be not visited */
-	(void)list_for_each(prec_list, (ListForF)_reset_visited, NULL);
+	list_t *tmp_list = NULL, *visited_list = NULL;
 
 	/* See if we can find a prec from the given pid */
-	if (!(prec = list_find_first(prec_list, _list_find_prec_by_pid, &pid)))
+	if (!(prec = _find_prec(pid)) || prec->visited || prec->removed)
 		return;
 
 	prec->visited = true;
 
 	tmp_list = list_create(NULL);
+	visited_list = list_create(NULL);
 	list_append(tmp_list, prec);
+	list_append(visited_list, prec);
 
 	while ((prec_tmp = list_dequeue(tmp_list))) {
-		while ((prec = list_find_first(prec_list,
-					      _list_find_prec_by_ppid,
-					       &(prec_tmp->pid)))) {
+		for (prec = prec_tmp->first_child; prec;
+		     prec = prec->next_sibling) {
+			if (prec->visited || prec->removed)
+				continue;
 			_aggregate_prec(prec, ancestor);
 			/*
 			 * If the prec disappeared (pid is dead) aggregate its
-			 * statistics and remove it from the prec_list to avoid
-			 * having to agreggate it on every iteration.
+			 * statistics and remove it from the prec_list at the
+			 * end of the poll to avoid having to agreggate it on
+			 * every iteration.
 			 */
 			if (prec->completed) {
 				_aggregate_prec(prec, permanent_anc);
-				log_flag(JAG, "Removing completed process %d",
-					 prec->pid);
-				list_remove_first(prec_list, _find_prec,
-						  &prec->pid);
+				prec->removed = true;
 			}
 			list_append(tmp_list, prec);
+			list_append(visited_list, prec);
 		}
 	}
 	FREE_NULL_LIST(tmp_list);
 
+	/* reset the precs visited by this walk */
+	(void) list_for_each(visited_list, (ListForF) _reset_visited, NULL);
+	FREE_NULL_LIST(visited_list);
+
 	return;
 }
 
@@ -1084,13 +1124,14 @@ extern void jag_common_poll_data(list_t *task_list, uint64_t cont_id,
 	if (!list_count(prec_list) || !task_list || !list_count(task_list))
 		goto finished;	/* We have no business being here! */
 
+	_link_precs(prec_list);
+
 	itr = list_iterator_create(task_list);
 	while ((jobacct = list_next(itr))) {
 		double cpu_calc;
 		double last_total_cputime;
 		jag_prec_t *permanent_anc;
-		if (!(prec = list_find_first(prec_list, _find_prec,
-					     &jobacct->pid)))
+		if (!(prec = _find_prec(jobacct->pid)))
 			continue;
 		/*
 		 * We can't use the prec from the list as we need to keep it in
@@ -1297,6 +1338,9 @@ extern void jag_common_poll_data(list_t *task_list, uint64_t cont_id,
 	}
 	list_iterator_destroy(itr);
 
+	/* Free completed processes aggregated into their ancestors */
+	(void) list_delete_all(prec_list, _remove_aggregated, NULL);
+
 	if (slurm_conf.job_acct_oom_kill)
 		jobacct_gather_handle_mem_limit(total_job_mem,
 						total_job_vsize);
@@ -42,6 +42,9 @@
 #include "src/common/list.h"
 
 typedef struct jag_prec {	/* process record */
+	struct jag_prec *first_child; /* child processes, rebuilt each poll */
+	struct jag_prec *next_sibling; /* next child of the same parent */
+	bool	removed;	/* aggregated into its ancestor after completion */
 	bool	visited;
 	int	act_cpufreq;	/* actual average cpu frequency */
 	bool    completed;       /* the process no longer exists */
@@ -101,6 +101,12 @@ const char plugin_type[] = "jobcomp/elasticsearch";
 const uint32_t plugin_version = SLURM_VERSION_NUMBER;
 
 #define INDEX_RETRY_INTERVAL 30
+#define DEFAULT_BULK_MAX_DOCS 500
+#define DEFAULT_BULK_MAX_BYTES (5 * 1024 * 1024)	/* 5 MB */
+#define DEFAULT_BULK_FLUSH_INTERVAL 1
+#define BULK_ACTION "{\"index\":{}}\n"
+#define BULK_FILTER_PATH "filter_path=errors,items.*.status,items.*.error.reason"
+#define MIME_TYPE_NDJSON "application/x-ndjson"
 
 /* These are defined here so when we link with something other than
  * the slurmctld we will have these symbols defined. They will get
@@ -121,17 +127,45 @@ struct http_response {
 };
 
 struct job_node {
+	time_t enqueued;
 	time_t last_index_retry;
+	bool indexed;
 	char * serialized_job;
 };
 
+/* Jobs selected for the next _bulk request */
+typedef struct {
+	struct job_node **jobs;
+	int cnt;
+	int max_docs;
+	size_t bytes;
+	size_t max_bytes;
+	time_t now;
+	time_t oldest;
+	int wait_retry_cnt;
+} bulk_batch_t;
+
+/* Used to match the items of a _bulk response to the batch in order */
+typedef struct {
+	bulk_batch_t *batch;
+	int inx;
+	int fail_cnt;
+} bulk_resp_args_t;
+
 char *save_state_file = "elasticsearch_state";
 char *log_url = NULL;
+static char *bulk_url = NULL;
+static int bulk_max_docs = DEFAULT_BULK_MAX_DOCS;
+static size_t bulk_max_bytes = DEFAULT_BULK_MAX_BYTES;
+static int bulk_flush_interval = DEFAULT_BULK_FLUSH_INTERVAL;
+static CURL *curl_handle = NULL;
 
 static pthread_cond_t location_cond = PTHREAD_COND_INITIALIZER;
 static pthread_mutex_t location_mutex = PTHREAD_MUTEX_INITIALIZER;
 static pthread_mutex_t save_lock = PTHREAD_MUTEX_INITIALIZER;
 static pthread_mutex_t pend_jobs_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t process_cond = PTHREAD_COND_INITIALIZER;
+static pthread_mutex_t process_mutex = PTHREAD_MUTEX_INITIALIZER;
 static pthread_t job_handler_thread;
 static list_t *jobslist = NULL;
 static bool thread_shutdown = false;
@@ -156,6 +190,7 @@ static int _load_pending_jobs(void)
 	for (i = 0; i < job_cnt; i++) {
 		safe_unpackstr(&job_data, buffer);
 		jnode = xmalloc(sizeof(struct job_node));
+		jnode->enqueued = time(NULL);
 		jnode->serialized_job = job_data;
 		list_enqueue(jobslist, jnode);
 	}
@@ -188,101 +223,174 @@ static size_t _write_callback(void *contents, size_t size, size_t nmemb,
 	return realsize;
 }
 
-/* Try to index job into elasticsearch */
-static int _index_job(const char *jobcomp)
+/* Match each _bulk response item to the job sent at the same position */
+static data_for_each_cmd_t _foreach_bulk_item(const data_t *data, void *arg)
+{
+	bulk_resp_args_t *args = arg;
+	const data_t *action, *status = NULL, *reason = NULL;
+	int64_t code = 0;
+
+	if (args->inx >= args->batch->cnt)
+		return DATA_FOR_EACH_STOP;
+
+	if ((data_get_type(data) == DATA_TYPE_DICT) &&
+	    (action = data_key_get_const(data, "index")) &&
+	    (data_get_type(action) == DATA_TYPE_DICT)) {
+		status = data_key_get_const(action, "status");
+		reason = data_resolve_dict_path_const(action, "/error/reason");
+	}
+	if (status && (data_get_type(status) == DATA_TYPE_INT_64))
+		code = data_get_int(status);
+
+	/*
+	 * HTTP 200 (OK)	- request succeed.
+	 * HTTP 201 (Created)	- request succeed and resource created.
+	 */
+	if ((code == 200) || (code == 201)) {
+		args->batch->jobs[args->inx]->indexed = true;
+	} else {
+		log_flag(JOBCOMP, "Bulk item %d rejected with status %"PRId64": %s",
+			 args->inx, code,
+			 ((reason && (data_get_type(reason) == DATA_TYPE_STRING)) ?
+			  data_get_string(reason) : "unknown"));
+		args->fail_cnt++;
+	}
+
+	args->inx++;
+	return DATA_FOR_EACH_CONT;
+}
+
+/*
+ * Parse the (filtered) _bulk response body and flag the indexed jobs.
+ * RET number of jobs in batch that failed to be indexed
+ */
+static int _parse_bulk_response(bulk_batch_t *batch,
+				struct http_response *chunk)
+{
+	data_t *resp = NULL;
+	const data_t *errors, *items;
+	bulk_resp_args_t args = { .batch = batch };
+
+	if (serialize_g_string_to_data(&resp, chunk->message, chunk->size,
+				       MIME_TYPE_JSON) || !resp ||
+	    (data_get_type(resp) != DATA_TYPE_DICT)) {
+		log_flag(JOBCOMP, "Unable to parse bulk response from %s",
+			 bulk_url);
+		FREE_NULL_DATA(resp);
+		return batch->cnt;
+	}
+
+	errors = data_key_get_const(resp, "errors");
+	if (errors && (data_get_type(errors) == DATA_TYPE_BOOL) &&
+	    !data_get_bool(errors)) {
+		/* Fast path: every item in the request was indexed */
+		for (int i = 0; i < batch->cnt; i++)
+			batch->jobs[i]->indexed = true;
+	} else if ((items = data_key_get_const(resp, "items")) &&
+		   (data_get_type(items) == DATA_TYPE_LIST)) {
+		(void) data_list_for_each_const(items, _foreach_bulk_item,
+						&args);
+		/* Anything without a matching item has to be retried */
+		args.fail_cnt += batch->cnt - args.inx;
+	} else {
+		log_flag(JOBCOMP, "Unexpected bulk response from %s:\n%s",
+			 bulk_url, chunk->message);
+		args.fail_cnt = batch->cnt;
+	}
+
+	FREE_NULL_DATA(resp);
+	return args.fail_cnt;
+}
+
+/*
+ * Send the batch of jobs to elasticsearch in a single _bulk request.
+ * The same curl handle is reused between calls to keep the connection alive.
+ * RET number of jobs in batch that failed to be indexed
+ */
+static int _index_jobs(bulk_batch_t *batch)
 {
-	CURL *curl_handle = NULL;
 	CURLcode res;
-	struct http_response chunk;
+	struct http_response chunk = { 0 };
 	struct curl_slist *slist = NULL;
-	int rc = SLURM_SUCCESS;
-	char *token = NULL;
+	char *body = NULL, *pos = NULL;
+	long http_code = 0;
+	int fail_cnt = batch->cnt;
+
+	for (int i = 0; i < batch->cnt; i++) {
+		xstrcatat(body, &pos, BULK_ACTION);
+		xstrcatat(body, &pos, batch->jobs[i]->serialized_job);
+		xstrcatat(body, &pos, "\n");
+	}
 
 	slurm_mutex_lock(&location_mutex);
-	if (log_url == NULL) {
+	if (bulk_url == NULL) {
 		error("%s: JobCompLoc parameter not configured", plugin_type);
-		slurm_mutex_unlock(&location_mutex);
-		return SLURM_ERROR;
+		goto cleanup;
 	}
 
-	if ((curl_handle = curl_easy_init()) == NULL) {
+	if (!curl_handle && !(curl_handle = curl_easy_init())) {
 		error("%s: curl_easy_init: %m", plugin_type);
-		rc = SLURM_ERROR;
-		goto cleanup_easy_init;
+		goto cleanup;
 	}
 
-	slist = curl_slist_append(slist, "Content-Type: " MIME_TYPE_JSON);
+	slist = curl_slist_append(slist, "Content-Type: " MIME_TYPE_NDJSON);
 
 	if (slist == NULL) {
 		error("%s: curl_slist_append: %m", plugin_type);
-		rc = SLURM_ERROR;
-		goto cleanup_easy_init;
+		goto cleanup;
 	}
 
 	chunk.message = xmalloc(1);
 	chunk.size = 0;
 
-	if (curl_easy_setopt(curl_handle, CURLOPT_URL, log_url) ||
+	if (curl_easy_setopt(curl_handle, CURLOPT_URL, bulk_url) ||
 	    curl_easy_setopt(curl_handle, CURLOPT_POST, 1) ||
-	    curl_easy_setopt(curl_handle, CURLOPT_POSTFIELDS, jobcomp) ||
+	    curl_easy_setopt(curl_handle, CURLOPT_POSTFIELDS, body) ||
 	    curl_easy_setopt(curl_handle, CURLOPT_POSTFIELDSIZE,
-			     strlen(jobcomp)) ||
+			     (long) (pos - body)) ||
 	    curl_easy_setopt(curl_handle, CURLOPT_HTTPHEADER, slist) ||
-	    curl_easy_setopt(curl_handle, CURLOPT_HEADER, 1) ||
+	    curl_easy_setopt(curl_handle, CURLOPT_ACCEPT_ENCODING, "") ||
+	    curl_easy_setopt(curl_handle, CURLOPT_TCP_KEEPALIVE, 1L) ||
 	    curl_easy_setopt(curl_handle, CURLOPT_WRITEFUNCTION,
 			     _write_callback) ||
 	    curl_easy_setopt(curl_handle, CURLOPT_WRITEDATA, (void *) &chunk)) {
 		error("%s: curl_easy_setopt() failed", plugin_type);
-		rc = SLURM_ERROR;
 		goto cleanup;
 	}
 
 	if ((res = curl_easy_perform(curl_handle)) != CURLE_OK) {
 		log_flag(JOBCOMP, "Could not connect to: %s , reason: %s",
-			 log_url, curl_easy_strerror(res));
-		rc = SLURM_ERROR;
+			 bulk_url, curl_easy_strerror(res));
 		goto cleanup;
 	}
 
-	token = strtok(chunk.message, " ");
-	if (token == NULL) {
+	if (curl_easy_getinfo(curl_handle, CURLINFO_RESPONSE_CODE, &http_code) ||
+	    !http_code) {
 		error("%s: Could not receive the HTTP response status code from %s",
-		      plugin_type, log_url);
-		rc = SLURM_ERROR;
+		      plugin_type, bulk_url);
 		goto cleanup;
 	}
-	token = strtok(NULL, " ");
-
-	/* HTTP 100 (Continue). */
-	if ((xstrcmp(token, "100") == 0)) {
-		(void)  strtok(NULL, " ");
-		token = strtok(NULL, " ");
-	}
 
-	/*
-	 * HTTP 200 (OK)	- request succeed.
-	 * HTTP 201 (Created)	- request succeed and resource created.
-	 */
-	if ((xstrcmp(token, "200") != 0) && (xstrcmp(token, "201") != 0)) {
-		log_flag(JOBCOMP, "HTTP status code %s received from %s",
-			 token, log_url);
+	if (http_code != 200) {
+		log_flag(JOBCOMP, "HTTP status code %ld received from %s",
+			 http_code, bulk_url);
 		log_flag(JOBCOMP, "HTTP response:\n%s", chunk.message);
-		rc = SLURM_ERROR;
-	} else {
-		token = strtok((char *)jobcomp, ",");
-		(void)  strtok(token, ":");
-		token = strtok(NULL, ":");
-		log_flag(JOBCOMP, "Job with jobid %s indexed into elasticsearch",
-			 token);
+		goto cleanup;
 	}
 
+	fail_cnt = _parse_bulk_response(batch, &chunk);
+	log_flag(JOBCOMP, "%d of %d jobs indexed into elasticsearch",
+		 (batch->cnt - fail_cnt), batch->cnt);
+
 cleanup:
+	/* Drop the POSTFIELDS reference before body is released */
+	if (curl_handle)
+		(void) curl_easy_setopt(curl_handle, CURLOPT_POSTFIELDS, NULL);
 	curl_slist_free_all(slist);
 	xfree(chunk.message);
-cleanup_easy_init:
-	curl_easy_cleanup(curl_handle);
 	slurm_mutex_unlock(&location_mutex);
-	return rc;
+	xfree(body);
+	return fail_cnt;
 }
 
 /* Saves the state of all jobcomp data for further indexing retries */
@@ -326,6 +434,7 @@ extern int jobcomp_p_log_record(job_record_t *job_ptr)
 
 	record = jobcomp_common_job_record_to_data(job_ptr);
 	jnode = xmalloc(sizeof(struct job_node));
+	jnode->enqueued = time(NULL);
 	if ((rc = serialize_g_data_to_string(&jnode->serialized_job, NULL,
 					     record, MIME_TYPE_JSON,
 					     SER_FLAGS_COMPACT))) {
@@ -334,18 +443,72 @@ extern int jobcomp_p_log_record(job_record_t *job_ptr)
 			 job_ptr, slurm_strerror(rc));
 	} else {
 		list_enqueue(jobslist, jnode);
+		/* Wake the indexing thread as soon as a batch is full */
+		if (list_count(jobslist) >= bulk_max_docs) {
+			slurm_mutex_lock(&process_mutex);
+			slurm_cond_signal(&process_cond);
+			slurm_mutex_unlock(&process_mutex);
+		}
 	}
 
 	FREE_NULL_DATA(record);
 	return rc;
 }
 
+static int _foreach_batch_job(void *x, void *arg)
+{
+	struct job_node *jnode = x;
+	bulk_batch_t *batch = arg;
+	size_t len;
+
+	if (jnode->last_index_retry &&
+	    (difftime(batch->now, jnode->last_index_retry) <
+	     INDEX_RETRY_INTERVAL)) {
+		batch->wait_retry_cnt++;
+		return 0;
+	}
+
+	len = strlen(jnode->serialized_job) + strlen(BULK_ACTION) + 1;
+	if (batch->cnt && ((batch->bytes + len) > batch->max_bytes))
+		return -1;
+
+	batch->jobs[batch->cnt++] = jnode;
+	batch->bytes += len;
+	if (!batch->oldest || (jnode->enqueued < batch->oldest))
+		batch->oldest = jnode->enqueued;
+
+	if (batch->cnt >= batch->max_docs)
+		return -1;
+
+	return 0;
+}
+
+static int _find_indexed(void *x, void *key)
+{
+	struct job_node *jnode = x;
+
+	return jnode->indexed;
+}
+
+/*
+ * Flush the batch when it is full or when its oldest job has waited for
+ * bulk_flush_interval. Nothing is sent on shutdown, pending jobs are saved to
+ * the state file instead.
+ */
+static bool _batch_ready(bulk_batch_t *batch)
+{
+	if (!batch->cnt || thread_shutdown)
+		return false;
+
+	return ((batch->cnt >= batch->max_docs) ||
+		(batch->bytes >= batch->max_bytes) ||
+		(difftime(batch->now, batch->oldest) >= bulk_flush_interval));
+}
+
 extern void *_process_jobs(void *x)
 {
-	list_itr_t *iter;
-	struct job_node *jnode = NULL;
 	struct timespec ts = {0, 0};
-	time_t now;
+	bulk_batch_t batch = { 0 };
 
 	/* Wait for jobcomp_p_set_location log_url setup. */
 	slurm_mutex_lock(&location_mutex);
@@ -354,32 +517,61 @@ extern void *_process_jobs(void *x)
 	slurm_mutex_unlock(&location_mutex);
 
 	while (!thread_shutdown) {
-		int success_cnt = 0, fail_cnt = 0, wait_retry_cnt = 0;
-		sleep(1);
-		iter = list_iterator_create(jobslist);
-		while ((jnode = (struct job_node *)list_next(iter)) &&
-		       !thread_shutdown) {
-			now = time(NULL);
-			if ((jnode->last_index_retry == 0) ||
-			    (difftime(now, jnode->last_index_retry) >=
-					INDEX_RETRY_INTERVAL)) {
-				if ((_index_job(jnode->serialized_job) ==
-				     SLURM_SUCCESS)) {
-					list_delete_item(iter);
-					success_cnt++;
-				} else {
-					jnode->last_index_retry = now;
+		int success_cnt = 0, fail_cnt = 0;
+
+		slurm_mutex_lock(&process_mutex);
+		if (!thread_shutdown) {
+			ts.tv_sec = time(NULL) + MAX(bulk_flush_interval, 1);
+			ts.tv_nsec = 0;
+			slurm_cond_timedwait(&process_cond, &process_mutex,
+					     &ts);
+		}
+		slurm_mutex_unlock(&process_mutex);
+
+		/*
+		 * Only this thread removes jobs from jobslist, so the
+		 * collected job_node pointers remain valid outside of the
+		 * list lock.
+		 */
+		do {
+			slurm_mutex_lock(&location_mutex);
+			batch.max_docs = bulk_max_docs;
+			batch.max_bytes = bulk_max_bytes;
+			slurm_mutex_unlock(&location_mutex);
+
+			xrecalloc(batch.jobs, batch.max_docs,
+				  sizeof(*batch.jobs));
+			batch.cnt = 0;
+			batch.bytes = 0;
+			batch.oldest = 0;
+			batch.wait_retry_cnt = 0;
+			batch.now = time(NULL);
+			(void) list_for_each(jobslist, _foreach_batch_job,
+					     &batch);
+
+			if (!_batch_ready(&batch))
+				break;
+
+			if (_index_jobs(&batch)) {
+				for (int i = 0; i < batch.cnt; i++) {
+					if (batch.jobs[i]->indexed)
+						continue;
+					batch.jobs[i]->last_index_retry =
+						batch.now;
 					fail_cnt++;
 				}
-			} else
-				wait_retry_cnt++;
-		}
-		list_iterator_destroy(iter);
+			}
+			success_cnt += list_delete_all(jobslist, _find_indexed,
+						       NULL);
+		} while ((batch.cnt >= batch.max_docs) && !fail_cnt);
+
 		if ((success_cnt || fail_cnt))
 			log_flag(JOBCOMP, "index success:%d fail:%d wait_retry:%d",
 				 success_cnt, fail_cnt,
-				 wait_retry_cnt);
+				 batch.wait_retry_cnt);
 	}
+
+	xfree(batch.jobs);
 	return NULL;
 }
 
@@ -420,18 +612,78 @@ extern int init(void)
 
 extern int fini(void)
 {
+	slurm_mutex_lock(&process_mutex);
 	thread_shutdown = true;
+	slurm_cond_signal(&process_cond);
+	slurm_mutex_unlock(&process_mutex);
 	slurm_thread_join(job_handler_thread);
 
 	_save_state();
 	FREE_NULL_LIST(jobslist);
 	xfree(log_url);
+	xfree(bulk_url);
+	if (curl_handle) {
+		curl_easy_cleanup(curl_handle);
+		curl_handle = NULL;
+	}
 
 	curl_global_cleanup();
 
 	return SLURM_SUCCESS;
 }
 
+/*
+ * Derive the _bulk endpoint from JobCompLoc, which is documented as
+ * <host>:<port>/<target>/_doc. A trailing /_doc (or /_bulk) is replaced so
+ * existing configurations keep working unmodified.
+ */
+static char *_get_bulk_url(const char *location)
+{
+	char *url = xstrdup(location);
+	int len = strlen(url);
+
+	while ((len > 0) && (url[len - 1] == '/'))
+		url[--len] = '\0';
+
+	if ((len >= 5) && !xstrcmp(url + len - 5, "/_doc"))
+		url[len - 5] = '\0';
+	else if ((len >= 6) && !xstrcmp(url + len - 6, "/_bulk"))
+		url[len - 6] = '\0';
+
+	xstrfmtcat(url, "/_bulk?%s", BULK_FILTER_PATH);
+
+	return url;
+}
+
+static int _parse_param_int(const char *key, int def, int min)
+{
+	char *begin;
+	int value;
+
+	if (!(begin = xstrstr(slurm_conf.job_comp_params, key)))
+		return def;
+
+	value = atoi(begin + strlen(key));
+	if (value < min) {
+		error("%s: invalid JobCompParams %s%d, using %d",
+		      plugin_type, key, value, def);
+		return def;
+	}
+
+	return value;
+}
+
+/* Read the _bulk batching parameters from JobCompParams */
+static void _parse_params(void)
+{
+	bulk_max_docs = _parse_param_int("bulk_max_docs=",
+					 DEFAULT_BULK_MAX_DOCS, 1);
+	bulk_max_bytes = _parse_param_int("bulk_max_bytes=",
+					  DEFAULT_BULK_MAX_BYTES, 1);
+	bulk_flush_interval = _parse_param_int("bulk_flush_interval=",
+					       DEFAULT_BULK_FLUSH_INTERVAL, 0);
+}
+
 /*
  * The remainder of this file implements the standard Slurm job completion
  * logging API.
@@ -450,6 +702,9 @@ extern int jobcomp_p_set_location(void)
 	if (log_url)
 		xfree(log_url);
 	log_url = xstrdup(location);
+	xfree(bulk_url);
+	bulk_url = _get_bulk_url(location);
+	_parse_params();
 	slurm_cond_broadcast(&location_cond);
 	slurm_mutex_unlock(&location_mutex);
 
@@ -48,6 +48,19 @@
 #define DEFAULT_FLUSH_TIMEOUT 500
 #define DEFAULT_POLL_INTERVAL 2
 
+/*
+ * librdkafka producer properties favoring batched delivery. Applied only when
+ * not set in the JobCompLoc file.
+ */
+static const struct {
+	char *name;
+	char *value;
+} batch_defaults[] = {
+	{ "linger.ms", "100" },
+	{ "compression.codec", "lz4" },
+	{ NULL, NULL }
+};
+
 kafka_conf_t *kafka_conf = NULL;
 pthread_rwlock_t kafka_conf_rwlock = PTHREAD_RWLOCK_INITIALIZER;
 list_t *rd_kafka_conf_list = NULL;
@@ -117,6 +130,25 @@ static bool _parse_key_value_line(char *line, char **key, char **value)
 	return true;
 }
 
+static int _find_key_pair(void *x, void *key)
+{
+	config_key_pair_t *key_pair = x;
+
+	return !xstrcmp(key_pair->name, key);
+}
+
+static void _add_batch_defaults(void)
+{
+	for (int i = 0; batch_defaults[i].name; i++) {
+		if (list_find_first(rd_kafka_conf_list, _find_key_pair,
+				    batch_defaults[i].name))
+			continue;
+
+		add_key_pair(rd_kafka_conf_list, batch_defaults[i].name, "%s",
+			     batch_defaults[i].value);
+	}
+}
+
 static int _parse_uint32(uint32_t *result, char *key, const char *nptr)
 {
 	char *endptr = NULL;
@@ -173,6 +205,8 @@ extern int jobcomp_kafka_conf_parse_location(char *location)
 	free(line);
 	fclose(fp);
 
+	_add_batch_defaults();
+
 	return SLURM_SUCCESS;
 }
 
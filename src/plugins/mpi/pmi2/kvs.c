@@ -64,9 +64,7 @@ typedef struct kvs_bucket {
 static kvs_bucket_t *kvs_hash = NULL;
 static uint32_t hash_size = 0;
 
-static char *temp_kvs_buf = NULL;
-static int temp_kvs_cnt = 0;
-static int temp_kvs_size = 0;
+static buf_t *temp_kvs_buf = NULL;
 
 static int no_dup_keys = 0;
 
@@ -96,13 +94,14 @@ extern int
 temp_kvs_init(void)
 {
 	uint16_t cmd;
-	uint32_t nodeid, num_children, size;
-	buf_t *buf = NULL;
+	uint32_t nodeid, num_children;
 
-	xfree(temp_kvs_buf);
-	temp_kvs_cnt = 0;
-	temp_kvs_size = TEMP_KVS_SIZE_INC;
-	temp_kvs_buf = xmalloc(temp_kvs_size);
+	/*
+	 * Pack pairs straight into one growing buffer, the header is at the
+	 * front so the whole buffer is the message to send.
+	 */
+	FREE_NULL_BUFFER(temp_kvs_buf);
+	temp_kvs_buf = init_buf(TEMP_KVS_SIZE_INC);
 
 	/* put the tree cmd here to simplify message sending */
 	if (in_stepd()) {
@@ -111,28 +110,19 @@ temp_kvs_init(void)
 		cmd = TREE_CMD_KVS_FENCE_RESP;
 	}
 
-	buf = init_buf(1024);
-	pack16(cmd, buf);
+	pack16(cmd, temp_kvs_buf);
 	if (in_stepd()) {
 		nodeid = job_info.nodeid;
 		/* XXX: TBC */
 		num_children = tree_info.num_children + 1;
 
-		pack32(nodeid, buf); /* from_nodeid */
-		packstr(tree_info.this_node, buf); /* from_node */
-		pack32(num_children, buf); /* num_children */
-		pack32(kvs_seq, buf);
+		pack32(nodeid, temp_kvs_buf); /* from_nodeid */
+		packstr(tree_info.this_node, temp_kvs_buf); /* from_node */
+		pack32(num_children, temp_kvs_buf); /* num_children */
+		pack32(kvs_seq, temp_kvs_buf);
 	} else {
-		pack32(kvs_seq, buf);
+		pack32(kvs_seq, temp_kvs_buf);
 	}
-	size = get_buf_offset(buf);
-	if (temp_kvs_cnt + size > temp_kvs_size) {
-		temp_kvs_size += TEMP_KVS_SIZE_INC;
-		xrealloc(temp_kvs_buf, temp_kvs_size);
-	}
-	memcpy(&temp_kvs_buf[temp_kvs_cnt], get_buf_data(buf), size);
-	temp_kvs_cnt += size;
-	FREE_NULL_BUFFER(buf);
 
 	tasks_to_wait = 0;
 	children_to_wait = 0;
@@ -143,45 +133,30 @@ temp_kvs_init(void)
 extern int
 temp_kvs_add(char *key, char *val)
 {
-	buf_t *buf;
-	uint32_t size;
-
 	if ( key == NULL || val == NULL )
 		return SLURM_SUCCESS;
 
-	buf = init_buf(PMI2_MAX_KEYLEN + PMI2_MAX_VALLEN + 2 * sizeof(uint32_t));
-	packstr(key, buf);
-	packstr(val, buf);
-	size = get_buf_offset(buf);
-	if (temp_kvs_cnt + size > temp_kvs_size) {
-		temp_kvs_size += TEMP_KVS_SIZE_INC;
-		xrealloc(temp_kvs_buf, temp_kvs_size);
-	}
-	memcpy(&temp_kvs_buf[temp_kvs_cnt], get_buf_data(buf), size);
-	temp_kvs_cnt += size;
-	FREE_NULL_BUFFER(buf);
+	packstr(key, temp_kvs_buf);
+	packstr(val, temp_kvs_buf);
 
 	return SLURM_SUCCESS;
 }
 
 extern int temp_kvs_merge(buf_t *buf)
 {
-	char *data;
 	uint32_t offset, size;
 
 	size = remaining_buf(buf);
 	if (size == 0) {
 		return SLURM_SUCCESS;
 	}
-	data = get_buf_data(buf);
-	offset = get_buf_offset(buf);
 
-	if (temp_kvs_cnt + size > temp_kvs_size) {
-		temp_kvs_size += size;
-		xrealloc(temp_kvs_buf, temp_kvs_size);
-	}
-	memcpy(&temp_kvs_buf[temp_kvs_cnt], &data[offset], size);
-	temp_kvs_cnt += size;
+	if (try_grow_buf_remaining(temp_kvs_buf, size))
+		return SLURM_ERROR;
+	offset = get_buf_offset(temp_kvs_buf);
+	memcpy(get_buf_data(temp_kvs_buf) + offset,
+	       get_buf_data(buf) + get_buf_offset(buf), size);
+	set_buf_offset(temp_kvs_buf, offset + size);
 
 	return SLURM_SUCCESS;
 }
@@ -209,10 +184,11 @@ temp_kvs_send(void)
 			/* srun or non-first-level stepds */
 			rc = slurm_forward_data(&nodelist,
 						tree_sock_addr,
-						temp_kvs_cnt,
-						temp_kvs_buf);
+						get_buf_offset(temp_kvs_buf),
+						get_buf_data(temp_kvs_buf));
 		else		/* first level stepds */
-			rc = tree_msg_to_srun(temp_kvs_cnt, temp_kvs_buf);
+			rc = tree_msg_to_srun(get_buf_offset(temp_kvs_buf),
+					      get_buf_data(temp_kvs_buf));
 
 		if (rc == SLURM_SUCCESS)
 			break;
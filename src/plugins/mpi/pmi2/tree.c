@@ -174,7 +174,7 @@ static int _handle_kvs_fence_resp(int fd, buf_t *buf)
 {
 	char *key, *val, *errmsg = NULL;
 	int rc = SLURM_SUCCESS;
-	uint32_t temp32, seq;
+	uint32_t temp32, seq, len;
 
 	debug3("mpi/pmi2: in _handle_kvs_fence_resp");
 
@@ -199,14 +199,11 @@ static int _handle_kvs_fence_resp(int fd, buf_t *buf)
 
 	temp32 = remaining_buf(buf);
 	debug3("mpi/pmi2: buf length: %u", temp32);
-	/* put kvs into local hash */
+	/* put kvs into local hash, kvs_put() copies the strings */
 	while (remaining_buf(buf) > 0) {
-		safe_unpackstr(&key, buf);
-		safe_unpackstr(&val, buf);
+		safe_unpackstr_ptr(&key, &len, buf);
+		safe_unpackstr_ptr(&val, &len, buf);
 		kvs_put(key, val);
-		//temp32 = remaining_buf(buf);
-		xfree(key);
-		xfree(val);
 	}
 
 resp:
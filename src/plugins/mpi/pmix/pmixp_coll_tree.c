@@ -525,6 +525,21 @@ static int _progress_collect(pmixp_coll_t *coll)
 		tree->ufwd_status = PMIXP_COLL_TREE_SND_ACTIVE;
 		PMIXP_DEBUG("%p: send data to %s:%d",
 			    coll, tree->prnt_host, tree->prnt_peerid);
+	} else if ((tree->ufwd_offset == tree->dfwd_offset) &&
+		   (get_buf_offset(tree->dfwd_buf) == tree->dfwd_offset)) {
+		/*
+		 * Both buffers carry the same header, so hand the aggregated
+		 * input buffer over as the output one instead of copying the
+		 * whole payload. The upward buffer is reset for the next
+		 * collective before it is used again.
+		 */
+		buf_t *tmp = tree->dfwd_buf;
+		tree->dfwd_buf = tree->ufwd_buf;
+		tree->ufwd_buf = tmp;
+		/* no need to send */
+		tree->ufwd_status = PMIXP_COLL_TREE_SND_DONE;
+		/* this is root */
+		tree->contrib_prnt = true;
 	} else {
 		/* move data from input buffer to the output */
 		char *dst, *src = get_buf_data(tree->ufwd_buf) +
@@ -35,6 +35,8 @@
  *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA.
  \*****************************************************************************/
 
+#include "src/common/xhash.h"
+
 #include "pmixp_common.h"
 #include "pmixp_dmdx.h"
 #include "pmixp_server.h"
@@ -80,22 +82,38 @@ void _dmdx_free_caddy(dmdx_caddy_t *caddy)
 	xfree(caddy);
 }
 
-static list_t *_dmdx_requests;
+/*
+ * Outstanding requests tracked by sequence number. Responses from
+ * different nodes arrive out of order, so a lookup shouldn't walk all of
+ * the outstanding requests.
+ */
+static xhash_t *_dmdx_requests;
+static pthread_mutex_t _dmdx_mutex = PTHREAD_MUTEX_INITIALIZER;
 static uint32_t _dmdx_seq_num = 1;
 
 static void _respond_with_error(int seq_num, int nodeid,
 				char *sender_ns, int status);
 
+static void _dmdx_req_id(void *item, const char **key, uint32_t *key_len)
+{
+	dmdx_req_info_t *req = item;
+
+	*key = (const char *) &req->seq_num;
+	*key_len = sizeof(req->seq_num);
+}
+
 int pmixp_dmdx_init(void)
 {
-	_dmdx_requests = list_create(xfree_ptr);
+	_dmdx_requests = xhash_init(_dmdx_req_id, xfree_ptr);
 	_dmdx_seq_num = 1;
 	return SLURM_SUCCESS;
 }
 
 int pmixp_dmdx_finalize(void)
 {
-	FREE_NULL_LIST(_dmdx_requests);
+	slurm_mutex_lock(&_dmdx_mutex);
+	xhash_free_ptr(&_dmdx_requests);
+	slurm_mutex_unlock(&_dmdx_mutex);
 	return 0;
 }
 
@@ -260,7 +278,9 @@ int pmixp_dmdx_get(const pmix_nspace_t nspace, int rank,
 	strlcpy(req->nspace, nspace, sizeof(req->nspace));
 	req->rank = rank;
 #endif
-	list_append(_dmdx_requests, req);
+	slurm_mutex_lock(&_dmdx_mutex);
+	xhash_add(_dmdx_requests, req);
+	slurm_mutex_unlock(&_dmdx_mutex);
 
 	/* send the request */
 	rc = pmixp_server_send_nb(&ep, PMIXP_MSG_DMDX, seq, buf,
@@ -357,13 +377,6 @@ exit:
 	 * anyway. We've notified libpmix, that's enough */
 }
 
-static int _dmdx_req_cmp(void *x, void *key)
-{
-	dmdx_req_info_t *req = (dmdx_req_info_t *)x;
-	uint32_t seq_num = *((uint32_t *)key);
-	return (req->seq_num == seq_num);
-}
-
 static void _dmdx_resp(buf_t *buf, int nodeid, uint32_t seq_num)
 {
 	dmdx_req_info_t *req;
@@ -373,15 +386,16 @@ static void _dmdx_resp(buf_t *buf, int nodeid, uint32_t seq_num)
 	char *data = NULL;
 	uint32_t size = 0;
 
-	/* find the request tracker */
-	list_itr_t *it = list_iterator_create(_dmdx_requests);
-	req = (dmdx_req_info_t *)list_find(it, _dmdx_req_cmp, &seq_num);
+	/* find and release the request tracker */
+	slurm_mutex_lock(&_dmdx_mutex);
+	req = xhash_pop(_dmdx_requests, (const char *) &seq_num,
+			sizeof(seq_num));
+	slurm_mutex_unlock(&_dmdx_mutex);
 	if (NULL == req) {
 		char *nodename = pmixp_info_job_host(nodeid);
 		/* We haven't sent this request! */
 		PMIXP_ERROR("Received DMDX response with bad seq_num=%d from %s!",
 			    seq_num, nodename);
-		list_iterator_destroy(it);
 		rc = SLURM_ERROR;
 		xfree(nodename);
 		goto exit;
@@ -407,12 +421,8 @@ static void _dmdx_resp(buf_t *buf, int nodeid, uint32_t seq_num)
 	/* call back to libpmix-server */
 	pmixp_lib_modex_invoke(req->cbfunc, status, data, size,
 			       req->cbdata, pmixp_free_buf, (void *)buf);
-
-	/* release tracker & list iterator */
-	req = NULL;
-	list_delete_item(it);
-	list_iterator_destroy(it);
 exit:
+	xfree(req);
 	if (SLURM_SUCCESS != rc) {
 		/* we are not expect libpmix to call the callback
 		 * to cleanup this buffer */
@@ -443,35 +453,58 @@ void pmixp_dmdx_process(buf_t *buf, int nodeid, uint32_t seq)
 	}
 }
 
+typedef struct {
+	list_t *expired;
+	time_t ts;
+} dmdx_timeout_args_t;
+
+static void _dmdx_find_expired(void *item, void *arg)
+{
+	dmdx_req_info_t *req = item;
+	dmdx_timeout_args_t *args = arg;
+
+	if ((args->ts - req->ts) > pmixp_info_timeout())
+		list_append(args->expired, req);
+}
+
 void pmixp_dmdx_timeout_cleanup(void)
 {
-	list_itr_t *it = list_iterator_create(_dmdx_requests);
+	dmdx_timeout_args_t args = {
+		.expired = list_create(xfree_ptr),
+		.ts = time(NULL),
+	};
+	list_itr_t *it;
 	dmdx_req_info_t *req = NULL;
-	time_t ts = time(NULL);
+	time_t ts = args.ts;
+
+	/* collect and untrack stale requests */
+	slurm_mutex_lock(&_dmdx_mutex);
+	xhash_walk(_dmdx_requests, _dmdx_find_expired, &args);
+	it = list_iterator_create(args.expired);
+	while ((req = list_next(it)))
+		xhash_pop(_dmdx_requests, (const char *) &req->seq_num,
+			  sizeof(req->seq_num));
+	list_iterator_destroy(it);
+	slurm_mutex_unlock(&_dmdx_mutex);
 
-	/* run through all requests and discard stale one's */
-	while ((req = list_next(it))) {
-		if ((ts - req->ts) > pmixp_info_timeout()) {
+	/* run through all stale requests and discard them */
+	while ((req = list_pop(args.expired))) {
 #ifndef NDEBUG
-			/* respond with the timeout to libpmix */
-			int nodeid = pmixp_nspace_resolve(req->nspace,
-							  req->rank);
-			char *nodename = pmixp_info_job_host(nodeid);
-			xassert(NULL != nodename);
-			PMIXP_ERROR("timeout: ns=%s, rank=%d, host=%s, ts=%lu",
-				    req->nspace, req->rank,
-				    (NULL != nodename) ? nodename : "unknown",
-				    ts);
-			if (NULL != nodename) {
-				xfree(nodename);
-			}
-#endif
-			/* PMIX_ERR_TIMEOUT */
-			pmixp_lib_modex_invoke(req->cbfunc, SLURM_ERROR, NULL, 0,
-					       req->cbdata, NULL, NULL);
-			/* release tracker & list iterator */
-			list_delete_item(it);
+		/* respond with the timeout to libpmix */
+		int nodeid = pmixp_nspace_resolve(req->nspace, req->rank);
+		char *nodename = pmixp_info_job_host(nodeid);
+		xassert(NULL != nodename);
+		PMIXP_ERROR("timeout: ns=%s, rank=%d, host=%s, ts=%lu",
+			    req->nspace, req->rank,
+			    (NULL != nodename) ? nodename : "unknown", ts);
+		if (NULL != nodename) {
+			xfree(nodename);
 		}
+#endif
+		/* PMIX_ERR_TIMEOUT */
+		pmixp_lib_modex_invoke(req->cbfunc, SLURM_ERROR, NULL, 0,
+				       req->cbdata, NULL, NULL);
+		xfree(req);
 	}
-	list_iterator_destroy(it);
+	FREE_NULL_LIST(args.expired);
 }
@@ -1732,6 +1732,37 @@ bool pmixp_server_want_pp(void)
 	return _pmixp_pp_on;
 }
 
+/*
+ * Log one line per collective type with the latency statistics and the
+ * resulting bandwidth for the given payload size. The "key=value" format
+ * is meant to be grepped out of slurmd.log and fed to plotting tools.
+ */
+static void _pmixp_cperf_summary(pmixp_coll_type_t type, int size,
+				 double *times, pmixp_coll_type_t *types,
+				 int iters)
+{
+	double min = 0, max = 0, sum = 0;
+	int j, cnt = 0;
+
+	for (j = 0; j < iters; j++) {
+		if (types[j] != type)
+			continue;
+		if (!cnt || (times[j] < min))
+			min = times[j];
+		if (!cnt || (times[j] > max))
+			max = times[j];
+		sum += times[j];
+		cnt++;
+	}
+	if (!cnt)
+		return;
+
+	PMIXP_ERROR("coll perf summary: coll=%s nodes=%u size=%d iters=%d min=%.9lf avg=%.9lf max=%.9lf bw_MBps=%.3lf",
+		    pmixp_coll_type2str(type), pmixp_info_nodes(), size, cnt,
+		    min, (sum / cnt), max,
+		    (sum > 0) ? ((double) size * cnt / sum / 1E6) : 0);
+}
+
 /*
  * For this to work the following conditions supposed to be
  * satisfied:
@@ -2042,12 +2073,13 @@ void pmixp_server_run_cperf(void)
 
 	PMIXP_ERROR("coll perf mode=%s", pmixp_coll_cperf_mode2str(mode));
 	for (size = start; size <= end; size *= 2) {
-		int j, iters = _pmixp_cperf_siter;
+		int j, done, iters = _pmixp_cperf_siter;
 		struct timeval tv1, tv2;
 		if (size >= bound) {
 			iters = _pmixp_cperf_liter;
 		}
 		double times[iters];
+		pmixp_coll_type_t iter_types[iters];
 		char *data = xmalloc(size);
 
 		PMIXP_ERROR("coll perf %d", size);
@@ -2068,17 +2100,22 @@ void pmixp_server_run_cperf(void)
 				type = PMIXP_COLL_TYPE_FENCE_RING;
 				break;
 			}
+			iter_types[j] = type;
 			gettimeofday(&tv1, NULL);
 			rc = _pmixp_server_cperf_iter(type, data, size);
 			gettimeofday(&tv2, NULL);
 			times[j] = tv2.tv_sec + 1E-6 * tv2.tv_usec -
 					(tv1.tv_sec + 1E-6 * tv1.tv_usec);
 		}
+		done = j;
 
 		for(j=0; j<iters; j++){
 			/* Output measurements to the slurmd.log */
 			PMIXP_ERROR("\t%d %d: %.9lf", j, size, times[j]);
 		}
+		for (j = 0; j < (sizeof(types) / sizeof(types[0])); j++)
+			_pmixp_cperf_summary(types[j], size, times, iter_types,
+					     done);
 		xfree(data);
 		if (is_barrier) {
 			break;
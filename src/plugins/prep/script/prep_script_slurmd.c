@@ -46,6 +46,7 @@
 #include "src/interfaces/prep.h"
 #include "src/common/run_command.h"
 #include "src/common/spank.h"
+#include "src/common/timers.h"
 #include "src/common/track_script.h"
 #include "src/common/uid.h"
 #include "src/common/xmalloc.h"
@@ -62,6 +63,13 @@ extern slurmd_conf_t *conf __attribute__((weak_import));
 slurmd_conf_t *conf = NULL;
 #endif
 
+typedef struct {
+	run_command_args_t args;
+	char *argv[2];
+	int status;
+	pthread_t tid;
+} script_run_t;
+
 static char **_build_env(job_env_t *job_env, slurm_cred_t *cred,
 			 bool is_epilog);
 static int _run_spank_job_script(const char *mode, char **env, uint32_t job_id);
@@ -111,13 +119,19 @@ static int _run_subpath_command(void *x, void *arg)
 	run_command_args_t *run_command_args = arg;
 	char *resp;
 	int rc = 0;
+	DEF_TIMERS;
 
 	xassert(run_command_args->script_argv);
 
 	run_command_args->script_path = x;
 	run_command_args->script_argv[0] = x;
 
+	START_TIMER;
 	resp = run_command(run_command_args);
+	END_TIMER;
+	log_flag(SCRIPT, "%s %s for JobId=%u ran for %s",
+		 run_command_args->script_type, (char *) x,
+		 run_command_args->job_id, TIME_STR);
 
 	if (*run_command_args->status) {
 		if (WIFEXITED(*run_command_args->status))
@@ -146,6 +160,73 @@ static int _run_subpath_command(void *x, void *arg)
 	return rc;
 }
 
+static void *_run_script_thread(void *arg)
+{
+	script_run_t *run = arg;
+
+	(void) _run_subpath_command((void *) run->args.script_path,
+				    &run->args);
+
+	return NULL;
+}
+
+/*
+ * Run all the scripts in path_list concurrently and wait for them to finish.
+ * RET the status of the first script in the list that failed, or 0
+ */
+static int _run_parallel_scripts(list_t *path_list,
+				 run_command_args_t *run_command_args)
+{
+	int cnt = list_count(path_list), status = 0;
+	script_run_t *runs = xcalloc(cnt, sizeof(*runs));
+	list_itr_t *itr = list_iterator_create(path_list);
+	char *path;
+
+	for (int i = 0; (path = list_next(itr)); i++) {
+		runs[i].args = *run_command_args;
+		runs[i].args.script_argv = runs[i].argv;
+		runs[i].args.script_path = path;
+		runs[i].args.status = &runs[i].status;
+		slurm_thread_create(&runs[i].tid, _run_script_thread, &runs[i]);
+	}
+	list_iterator_destroy(itr);
+
+	for (int i = 0; i < cnt; i++) {
+		slurm_thread_join(runs[i].tid);
+		if (runs[i].status && !status)
+			status = runs[i].status;
+	}
+	xfree(runs);
+
+	return status;
+}
+
+/*
+ * With PrologFlags=ParallelScripts each Prolog/Epilog entry is run in turn,
+ * and the scripts matched by one entry are run concurrently. A failure stops
+ * the entries after it from running.
+ */
+static int _run_script_entries(char **scripts, uint32_t script_cnt,
+			       run_command_args_t *run_command_args)
+{
+	int status = 0;
+
+	for (int i = 0; !status && (i < script_cnt); i++) {
+		list_t *path_list = _script_list_create(scripts[i]);
+
+		if (!path_list) {
+			error("%s: Unable to create list of paths [%s]",
+			      run_command_args->script_type, scripts[i]);
+			return SLURM_ERROR;
+		}
+
+		status = _run_parallel_scripts(path_list, run_command_args);
+		FREE_NULL_LIST(path_list);
+	}
+
+	return status;
+}
+
 extern int slurmd_script(job_env_t *job_env, slurm_cred_t *cred,
 			 bool is_epilog)
 {
@@ -191,6 +272,16 @@ extern int slurmd_script(job_env_t *job_env, slurm_cred_t *cred,
 
 		run_command_args.env = env;
 		run_command_args.max_wait = timeout;
+
+		if (slurm_conf.prolog_flags & PROLOG_FLAG_PARALLEL_SCRIPTS) {
+			status = _run_script_entries(scripts, script_cnt,
+						     &run_command_args);
+			if (status)
+				rc = status;
+			env_array_free(env);
+			return rc;
+		}
+
 		for (int i = 0; i < script_cnt; i++) {
 			list_t *tmp_list = _script_list_create(scripts[i]);
 
@@ -44,6 +44,17 @@
 
 #include "fair_tree.h"
 
+/*
+ * Sibling entry used while ranking one level of the tree. The sort key is
+ * copied out of the association so qsort() compares contiguous memory instead
+ * of chasing assoc->usage for every comparison.
+ */
+typedef struct {
+	long double level_fs;
+	bool user;
+	slurmdb_assoc_rec_t *assoc;
+} ft_sibling_t;
+
 static int  _ft_decay_apply_new_usage(job_record_t *job, time_t *start);
 static void _apply_priority_fs(void);
 
@@ -68,7 +79,7 @@ extern void fair_tree_decay(list_t *jobs, time_t start)
 
 	/* assign job priorities */
 	lock_slurmctld(job_write_lock);
-	list_for_each(jobs, (ListForF) decay_apply_weighted_factors, &start);
+	decay_apply_weighted_factors_all(jobs, start);
 	unlock_slurmctld(job_write_lock);
 }
 
@@ -132,7 +143,7 @@ static void _ft_debug(slurmdb_assoc_rec_t *assoc,
 }
 
 
-/* Sort so that higher level_fs values are first in the list */
+/* Sort so that higher level_fs values are first in the array */
 static int _cmp_level_fs(const void *x,
 			 const void *y)
 {
@@ -141,21 +152,21 @@ static int _cmp_level_fs(const void *x,
 	 *  2. Prioritize users over accounts (required for tie breakers when
 	 *     comparing users and accounts)
 	 */
-	slurmdb_assoc_rec_t **a = (slurmdb_assoc_rec_t **)x;
-	slurmdb_assoc_rec_t **b = (slurmdb_assoc_rec_t **)y;
+	const ft_sibling_t *a = x;
+	const ft_sibling_t *b = y;
 
 	/* 1. level_fs value */
-	if ((*a)->usage->level_fs != (*b)->usage->level_fs)
-		return (*a)->usage->level_fs < (*b)->usage->level_fs ? 1 : -1;
+	if (a->level_fs != b->level_fs)
+		return a->level_fs < b->level_fs ? 1 : -1;
 
 	/* 2. Prioritize users over accounts */
 
 	/* a and b are both users or both accounts */
-	if (!(*a)->user == !(*b)->user)
+	if (a->user == b->user)
 		return 0;
 
 	/* -1 if a is user, 1 if b is user */
-	return (*a)->user ? -1 : 1;
+	return a->user ? -1 : 1;
 }
 
 
@@ -205,19 +216,18 @@ static void _calc_assoc_fs(slurmdb_assoc_rec_t *assoc)
 		assoc->usage->level_fs = S / U;
 }
 
-/* Append list of associations to array
+/* Append list of associations to a sibling array
  * IN list - list of associations
- * IN merged - array of associations to append to
- * IN/OUT merged_size - number of associations in merged array
+ * IN merged - array of siblings to append to
+ * IN/OUT merged_size - number of siblings in merged array
  * RET - New array. Must be freed.
  */
-static slurmdb_assoc_rec_t** _append_list_to_array(
-	list_t *list, slurmdb_assoc_rec_t** merged,
-	size_t *merged_size)
+static ft_sibling_t *_append_list_to_array(list_t *list,
+					   ft_sibling_t *merged,
+					   size_t *merged_size)
 {
 	list_itr_t *itr;
 	slurmdb_assoc_rec_t *next;
-	size_t bytes;
 	size_t i = *merged_size;
 
 	if (!list) {
@@ -228,39 +238,35 @@ static slurmdb_assoc_rec_t** _append_list_to_array(
 	}
 
 	*merged_size += list_count(list);
-
-	/* must be null-terminated, so add one extra slot */
-	bytes = sizeof(slurmdb_assoc_rec_t*) * (*merged_size + 1);
-	merged = xrealloc(merged, bytes);
+	/* keep one spare slot so an empty level still gets an array */
+	xrecalloc(merged, *merged_size + 1, sizeof(*merged));
 
 	itr = list_iterator_create(list);
 	while ((next = list_next(itr)))
-		merged[i++] = next;
+		merged[i++].assoc = next;
 	list_iterator_destroy(itr);
 
-	/* null terminate the array */
-	merged[*merged_size] = NULL;
 	return merged;
 }
 
 /* Returns number of tied sibling accounts.
- * IN assocs - array of siblings, sorted by level_fs
+ * IN siblings - array of siblings, sorted by level_fs
+ * IN count - number of siblings
  * IN begin_ndx - begin looking for ties at this index
  * RET - number of sibling accounts with equal level_fs values
  */
-static size_t _count_tied_accounts(slurmdb_assoc_rec_t** assocs,
+static size_t _count_tied_accounts(ft_sibling_t *siblings, size_t count,
 				   size_t begin_ndx)
 {
-	slurmdb_assoc_rec_t* next_assoc;
-	slurmdb_assoc_rec_t* assoc = assocs[begin_ndx];
-	size_t i = begin_ndx;
+	size_t i;
 	size_t tied_accounts = 0;
-	while ((next_assoc = assocs[++i])) {
+
+	for (i = begin_ndx + 1; i < count; i++) {
 		/* Users are sorted to the left of accounts, so no user we
 		 * encounter here will be equal to this account */
-		if (!next_assoc->user)
+		if (!siblings[i].user)
 			break;
-		if (assoc->usage->level_fs != next_assoc->usage->level_fs)
+		if (siblings[begin_ndx].level_fs != siblings[i].level_fs)
 			break;
 		tied_accounts++;
 	}
@@ -273,32 +279,43 @@ static size_t _count_tied_accounts(slurmdb_assoc_rec_t** assocs,
  * IN begin - index of first account to merge
  * IN end - index of last account to merge
  * IN assoc_level - depth in the tree (root is 0)
+ * OUT merged_size - number of children in the returned array
  * RET - Array of the children. Must be freed.
  */
-static slurmdb_assoc_rec_t** _merge_accounts(
-	slurmdb_assoc_rec_t** siblings,
-	size_t begin, size_t end, uint16_t assoc_level)
+static ft_sibling_t *_merge_accounts(ft_sibling_t *siblings,
+				     size_t begin, size_t end,
+				     uint16_t assoc_level, size_t *merged_size)
 {
-	size_t i;
-	/* number of associations in merged array */
-	size_t merged_size = 0;
-	/* merged is a null terminated array */
-	slurmdb_assoc_rec_t** merged = (slurmdb_assoc_rec_t **)
-		xmalloc(sizeof(slurmdb_assoc_rec_t *));
-	merged[0] = NULL;
+	size_t i, total = 0;
+	ft_sibling_t *merged;
 
+	/* Size the array once instead of growing it per account */
 	for (i = begin; i <= end; i++) {
-		list_t *children = siblings[i]->usage->children_list;
+		list_t *children = siblings[i].assoc->usage->children_list;
+
+		if (children)
+			total += list_count(children);
+	}
+	merged = xcalloc(total ? total : 1, sizeof(*merged));
+	*merged_size = 0;
+
+	for (i = begin; i <= end; i++) {
+		list_t *children = siblings[i].assoc->usage->children_list;
+		list_itr_t *itr;
+		slurmdb_assoc_rec_t *child;
 
 		/* the first account's debug was already printed */
 		if ((slurm_conf.debug_flags & DEBUG_FLAG_PRIO) && i > begin)
-			_ft_debug(siblings[i], assoc_level, true);
+			_ft_debug(siblings[i].assoc, assoc_level, true);
 
 		if (!children || list_is_empty(children)) {
 			continue;
 		}
 
-		merged = _append_list_to_array(children, merged, &merged_size);
+		itr = list_iterator_create(children);
+		while ((child = list_next(itr)))
+			merged[(*merged_size)++].assoc = child;
+		list_iterator_destroy(itr);
 	}
 	return merged;
 }
@@ -319,12 +336,13 @@ static slurmdb_assoc_rec_t** _merge_accounts(
  *	   the same rank as the account's highest ranked user
  *
  * IN siblings - array of siblings
+ * IN count - number of siblings
  * IN assoc_level - depth in the tree (root is 0)
  * IN/OUT rank - current user ranking, starting at g_user_assoc_count
  * IN/OUT rnt - rank, no ties (what rank would be if no tie exists)
  * IN account_tied - is this account tied with the previous user
  */
-static void _calc_tree_fs(slurmdb_assoc_rec_t** siblings,
+static void _calc_tree_fs(ft_sibling_t *siblings, size_t count,
 			  uint16_t assoc_level, uint32_t *rank,
 			  uint32_t *rnt, bool account_tied)
 {
@@ -340,15 +358,21 @@ static void _calc_tree_fs(slurmdb_assoc_rec_t** siblings,
 	}
 
 	/* Calculate level_fs for each child */
-	for (i = 0; (assoc = siblings[i]); i++)
+	for (i = 0; i < count; i++) {
+		assoc = siblings[i].assoc;
 		_calc_assoc_fs(assoc);
+		siblings[i].level_fs = assoc->usage->level_fs;
+		siblings[i].user = (assoc->user != NULL);
+	}
 
 	/* Sort children by level_fs */
-	qsort(siblings, i, sizeof(slurmdb_assoc_rec_t *), _cmp_level_fs);
+	qsort(siblings, count, sizeof(*siblings), _cmp_level_fs);
 
 	/* Iterate through children in sorted order. If it's a user, calculate
 	 * fs_factor, otherwise recurse. */
-	for (i = 0; (assoc = siblings[i]); i++) {
+	for (i = 0; i < count; i++) {
+		assoc = siblings[i].assoc;
+
 		/* tied is used while iterating across siblings.
 		 * account_tied preserves ties while recursing */
 		if (i == 0 && account_tied) {
@@ -374,17 +398,19 @@ static void _calc_tree_fs(slurmdb_assoc_rec_t** siblings,
 
 			(*rnt)--;
 		} else {
-			slurmdb_assoc_rec_t** children;
-			size_t merge_count = _count_tied_accounts(siblings, i);
+			ft_sibling_t *children;
+			size_t child_count = 0;
+			size_t merge_count = _count_tied_accounts(siblings,
+								  count, i);
 
 			/* Merging does not affect child level_fs calculations
 			 * since the necessary information is stored on each
 			 * assoc's usage struct */
 			children = _merge_accounts(siblings, i,
 						   i + merge_count,
-						   assoc_level);
+						   assoc_level, &child_count);
 
-			_calc_tree_fs(children, assoc_level+1,
+			_calc_tree_fs(children, child_count, assoc_level+1,
 				      rank, rnt, tied);
 
 			/* Skip over any merged accounts */
@@ -401,7 +427,7 @@ static void _calc_tree_fs(slurmdb_assoc_rec_t** siblings,
 /* Start fairshare calculations at root. Call assoc_mgr_lock before this. */
 static void _apply_priority_fs(void)
 {
-	slurmdb_assoc_rec_t** children = NULL;
+	ft_sibling_t *children = NULL;
 	uint32_t rank = g_user_assoc_count;
 	uint32_t rnt = rank;
 	size_t child_count = 0;
@@ -419,7 +445,7 @@ static void _apply_priority_fs(void)
 		children,
 		&child_count);
 
-	_calc_tree_fs(children, 0, &rank, &rnt, false);
+	_calc_tree_fs(children, child_count, 0, &rank, &rnt, false);
 
 	xfree(children);
 }
@@ -151,20 +151,55 @@ static time_t g_last_ran = 0; /* when the last poll ran */
 static time_t g_last_reset = 0; /* when the last reset was done */
 static double decay_factor = 1; /* The decay factor when decaying time. */
 
+typedef struct {
+	priority_factors_object_t *obj;
+	char *mcs_label;
+} prio_snapshot_rec_t;
+
+typedef struct {
+	time_t built;		/* when the snapshot was taken */
+	time_t job_update;	/* last_job_update the snapshot reflects */
+	time_t part_update;	/* last_part_update the snapshot reflects */
+	time_t next_begin;	/* earliest begin time of a job left out */
+	list_t *recs;		/* list of prio_snapshot_rec_t */
+} prio_snapshot_t;
+
+/*
+ * Priority factors of all eligible jobs as of the last decay cycle or job
+ * change. sprio requests are answered from here without the job locks.
+ * Never modified once published, only replaced.
+ */
+static pthread_rwlock_t snapshot_lock = PTHREAD_RWLOCK_INITIALIZER;
+static pthread_mutex_t snapshot_build_mutex = PTHREAD_MUTEX_INITIALIZER;
+static prio_snapshot_t *prio_snapshot = NULL;
+
 /* variables defined in priority_multifactor.h */
 
 static void _priority_p_set_assoc_usage_debug(slurmdb_assoc_rec_t *assoc);
 static void _set_assoc_usage_efctv(slurmdb_assoc_rec_t *assoc);
+static void _set_priority_factors(time_t start_time, job_record_t *job_ptr,
+				  bool locked);
+static void _publish_snapshot(bool force);
 
-static void _destroy_priority_factors_obj_light(void *object)
+static void _destroy_snapshot_rec(void *object)
 {
-	priority_factors_object_t *obj_ptr = object;
+	prio_snapshot_rec_t *rec = object;
+
+	if (!rec)
+		return;
+
+	slurm_destroy_priority_factors_object(rec->obj);
+	xfree(rec->mcs_label);
+	xfree(rec);
+}
 
-	if (!obj_ptr)
+static void _destroy_snapshot(prio_snapshot_t *snapshot)
+{
+	if (!snapshot)
 		return;
 
-	slurm_destroy_priority_factors(obj_ptr->prio_factors);
-	xfree(obj_ptr);
+	FREE_NULL_LIST(snapshot->recs);
+	xfree(snapshot);
 }
 
 /*
@@ -180,8 +215,14 @@ static int _apply_decay(double real_decay)
 	list_itr_t *itr = NULL;
 	slurmdb_assoc_rec_t *assoc = NULL;
 	slurmdb_qos_rec_t *qos = NULL;
-	assoc_mgr_lock_t locks = { WRITE_LOCK, NO_LOCK, WRITE_LOCK, NO_LOCK,
-				   NO_LOCK, NO_LOCK, NO_LOCK };
+	/*
+	 * Association and QOS usage decay independently of each other, so
+	 * take each write lock only for its own pass instead of holding both
+	 * for the whole decay. This keeps QOS readers (e.g. job scheduling)
+	 * from waiting on the association walk and vice versa.
+	 */
+	assoc_mgr_lock_t assoc_locks = { .assoc = WRITE_LOCK };
+	assoc_mgr_lock_t qos_locks = { .qos = WRITE_LOCK };
 
 	/* continue if real_decay is 0 or 1 since that doesn't help
 	   us at all. 1 means no decay and 0 will just zero
@@ -191,10 +232,9 @@ static int _apply_decay(double real_decay)
 	else if (!calc_fairshare || (real_decay == 1))
 		return SLURM_SUCCESS;
 
-	assoc_mgr_lock(&locks);
+	assoc_mgr_lock(&assoc_locks);
 
 	xassert(assoc_mgr_assoc_list);
-	xassert(assoc_mgr_qos_list);
 
 	itr = list_iterator_create(assoc_mgr_assoc_list);
 	/* We want to do this to all associations including root.
@@ -215,6 +255,11 @@ static int _apply_decay(double real_decay)
 		}
 	}
 	list_iterator_destroy(itr);
+	assoc_mgr_unlock(&assoc_locks);
+
+	assoc_mgr_lock(&qos_locks);
+
+	xassert(assoc_mgr_qos_list);
 
 	itr = list_iterator_create(assoc_mgr_qos_list);
 	while ((qos = list_next(itr))) {
@@ -226,7 +271,7 @@ static int _apply_decay(double real_decay)
 		qos->usage->grp_used_wall *= real_decay;
 	}
 	list_iterator_destroy(itr);
-	assoc_mgr_unlock(&locks);
+	assoc_mgr_unlock(&qos_locks);
 
 	return SLURM_SUCCESS;
 }
@@ -296,16 +341,16 @@ static void _read_last_decay_ran(time_t *last_ran, time_t *last_reset)
 	/* read the file */
 	state_file = xstrdup(slurm_conf.state_save_location);
 	xstrcat(state_file, "/priority_last_decay_ran");
-	lock_state_files();
+	lock_state_file(STATE_FILE_PRIORITY);
 
 	if (!(buffer = create_mmap_buf(state_file))) {
 		info("No last decay (%s) to recover", state_file);
 		xfree(state_file);
-		unlock_state_files();
+		unlock_state_file(STATE_FILE_PRIORITY);
 		return;
 	}
 	xfree(state_file);
-	unlock_state_files();
+	unlock_state_file(STATE_FILE_PRIORITY);
 
 	safe_unpack_time(last_ran, buffer);
 	safe_unpack_time(last_reset, buffer);
@@ -350,7 +395,7 @@ static int _write_last_decay_ran(time_t last_ran, time_t last_reset)
 	new_file = xstrdup(slurm_conf.state_save_location);
 	xstrcat(new_file, "/priority_last_decay_ran.new");
 
-	lock_state_files();
+	lock_state_file(STATE_FILE_PRIORITY);
 	state_fd = creat(new_file, 0600);
 	if (state_fd < 0) {
 		error("Can't save decay state, create file %s error %m",
@@ -391,7 +436,7 @@ static int _write_last_decay_ran(time_t last_ran, time_t last_reset)
 	xfree(state_file);
 	xfree(new_file);
 
-	unlock_state_files();
+	unlock_state_file(STATE_FILE_PRIORITY);
 	debug4("done writing time %ld", (long)last_ran);
 	FREE_NULL_BUFFER(buffer);
 
@@ -433,7 +478,7 @@ static int _set_children_usage_efctv(list_t *children_list)
 /* job_ptr should already have the partition priority and such added here
  * before had we will be adding to it
  */
-static double _get_fairshare_priority(job_record_t *job_ptr)
+static double _get_fairshare_priority(job_record_t *job_ptr, bool locked)
 {
 	slurmdb_assoc_rec_t *job_assoc;
 	slurmdb_assoc_rec_t *fs_assoc = NULL;
@@ -444,12 +489,14 @@ static double _get_fairshare_priority(job_record_t *job_ptr)
 	if (!calc_fairshare)
 		return 0;
 
-	assoc_mgr_lock(&locks);
+	if (!locked)
+		assoc_mgr_lock(&locks);
 
 	job_assoc = job_ptr->assoc_ptr;
 
 	if (!job_assoc) {
-		assoc_mgr_unlock(&locks);
+		if (!locked)
+			assoc_mgr_unlock(&locks);
 		error("Job %u has no association.  Unable to "
 		      "compute fairshare.", job_ptr->job_id);
 		return 0;
@@ -479,7 +526,8 @@ static double _get_fairshare_priority(job_record_t *job_ptr)
 			 fs_assoc->usage->usage_efctv,
 			 fs_assoc->usage->shares_norm, priority_fs);
 	}
-	assoc_mgr_unlock(&locks);
+	if (!locked)
+		assoc_mgr_unlock(&locks);
 
 	return priority_fs;
 }
@@ -488,27 +536,33 @@ static void _get_tres_factors(job_record_t *job_ptr, part_record_t *part_ptr,
 			      double *tres_factors)
 {
 	int i;
+	uint64_t *alloc_cnt = job_ptr->tres_alloc_cnt;
+	uint64_t *req_cnt = job_ptr->tres_req_cnt;
+	uint64_t *part_cnt = NULL;
+	bool normalize = !(flags & PRIORITY_FLAGS_NO_NORMAL_TRES);
 
 	xassert(tres_factors);
 
+	if (normalize) {
+		/* Nothing to normalize against, leave all factors at 0 */
+		if (!part_ptr || !part_ptr->tres_cnt)
+			return;
+		part_cnt = part_ptr->tres_cnt;
+	}
+
 	/* can't memcpy because of different types
 	 * uint64_t vs. double */
 	for (i = 0; i < slurmctld_tres_cnt; i++) {
 		uint64_t value = 0;
-		if (job_ptr->tres_alloc_cnt &&
-		    (job_ptr->tres_alloc_cnt[i] != NO_CONSUME_VAL64))
-			value = job_ptr->tres_alloc_cnt[i];
-		else if (job_ptr->tres_req_cnt)
-			value = job_ptr->tres_req_cnt[i];
+		if (alloc_cnt && (alloc_cnt[i] != NO_CONSUME_VAL64))
+			value = alloc_cnt[i];
+		else if (req_cnt)
+			value = req_cnt[i];
 
-		if (flags & PRIORITY_FLAGS_NO_NORMAL_TRES)
+		if (!normalize)
 			tres_factors[i] = value;
-		else if (value &&
-			 part_ptr &&
-			 part_ptr->tres_cnt &&
-			 part_ptr->tres_cnt[i])
-			tres_factors[i] = value /
-				(double)part_ptr->tres_cnt[i];
+		else if (value && part_cnt[i])
+			tres_factors[i] = value / (double) part_cnt[i];
 	}
 }
 
@@ -600,9 +654,13 @@ static int _priority_each_partition(void *object, void *arg)
 }
 
 
-/* Returns the priority after applying the weight factors */
+/*
+ * Returns the priority after applying the weight factors.
+ * IN locked - true if the caller already holds at least the assoc_mgr
+ *	       association, QOS and TRES read locks
+ */
 static uint32_t _get_priority_internal(time_t start_time,
-				       job_record_t *job_ptr)
+				       job_record_t *job_ptr, bool locked)
 {
 	double priority	= 0.0;
 	priority_factors_t pre_factors;
@@ -633,7 +691,7 @@ static uint32_t _get_priority_internal(time_t start_time,
 		return 0;
 	}
 
-	set_priority_factors(start_time, job_ptr);
+	_set_priority_factors(start_time, job_ptr, locked);
 
 	if (slurm_conf.debug_flags & DEBUG_FLAG_PRIO) {
 		memcpy(&pre_factors, job_ptr->prio_factors,
@@ -761,7 +819,8 @@ static uint32_t _get_priority_internal(time_t start_time,
 		info("Site priority is %"PRId64, priority_site);
 
 		if (weight_tres && pre_tres_factors && post_tres_factors) {
-			assoc_mgr_lock(&locks);
+			if (!locked)
+				assoc_mgr_lock(&locks);
 			for(i = 0; i < slurmctld_tres_cnt; i++) {
 				if (!post_tres_factors[i])
 					continue;
@@ -770,7 +829,8 @@ static uint32_t _get_priority_internal(time_t start_time,
 				     pre_tres_factors[i], weight_tres[i],
 				     post_tres_factors[i]);
 			}
-			assoc_mgr_unlock(&locks);
+			if (!locked)
+				assoc_mgr_unlock(&locks);
 		}
 
 		info("Job %u priority: %"PRId64" + %2.f + %.2f + %.2f + %.2f + %.2f + %.2f + %2.f - %"PRId64" = %.2f",
@@ -1298,6 +1358,16 @@ static int _decay_apply_new_usage_and_weighted_factors(job_record_t *job_ptr,
 	return SLURM_SUCCESS;
 }
 
+static int _decay_apply_new_usage(job_record_t *job_ptr,
+				  time_t *start_time_ptr)
+{
+	/* Always return SUCCESS so that list_for_each will
+	 * continue processing list of jobs. */
+	(void) decay_apply_new_usage(job_ptr, start_time_ptr);
+
+	return SLURM_SUCCESS;
+}
+
 
 static void *_decay_thread(void *no_data)
 {
@@ -1426,12 +1496,18 @@ static void *_decay_thread(void *no_data)
 		 */
 		site_factor_g_update();
 
+		/*
+		 * Charge all new usage before computing any priority so every
+		 * pending job sees the same effective usage regardless of its
+		 * place in job_list, then weigh the factors with the
+		 * association, QOS and TRES read locks taken once for the walk
+		 * instead of several times per job.
+		 */
 		if (!(flags & PRIORITY_FLAGS_FAIR_TREE)) {
-			list_for_each(
-				job_list,
-				(ListForF) _decay_apply_new_usage_and_weighted_factors,
-				&start_time
-				);
+			list_for_each(job_list,
+				      (ListForF) _decay_apply_new_usage,
+				      &start_time);
+			decay_apply_weighted_factors_all(job_list, start_time);
 		}
 
 		unlock_slurmctld(job_write_lock);
@@ -1440,6 +1516,8 @@ static void *_decay_thread(void *no_data)
 		if (flags & PRIORITY_FLAGS_FAIR_TREE)
 			fair_tree_decay(job_list, start_time);
 
+		_publish_snapshot(true);
+
 		g_last_ran = start_time;
 
 		_write_last_decay_ran(g_last_ran, g_last_reset);
@@ -1463,15 +1541,11 @@ static priority_factors_object_t *_create_prio_factors_obj(
 	priority_factors_object_t *obj =
 		xmalloc(sizeof(priority_factors_object_t));
 
-	/*
-	 * Don't xstrdup dup anything here, the list is freed
-	 * with _destroy_priority_factors_obj_light.
-	 */
-	obj->account = job_ptr->account;
+	obj->account = xstrdup(job_ptr->account);
 	obj->job_id = job_ptr->job_id;
-	obj->partition = job_part_ptr ?
-		job_part_ptr->name : job_ptr->part_ptr->name;
-	obj->qos = job_ptr->qos_ptr ? job_ptr->qos_ptr->name : NULL;
+	obj->partition = xstrdup(job_part_ptr ?
+				 job_part_ptr->name : job_ptr->part_ptr->name);
+	obj->qos = xstrdup(job_ptr->qos_ptr ? job_ptr->qos_ptr->name : NULL);
 	obj->user_id = job_ptr->user_id;
 
 	if (job_ptr->direct_set_prio) {
@@ -1785,6 +1859,11 @@ int fini ( void )
 	/* Now join outside the lock */
 	slurm_thread_join(decay_handler_thread);
 
+	slurm_rwlock_wrlock(&snapshot_lock);
+	_destroy_snapshot(prio_snapshot);
+	prio_snapshot = NULL;
+	slurm_rwlock_unlock(&snapshot_lock);
+
 	site_factor_g_fini();
 
 	return SLURM_SUCCESS;
@@ -1807,7 +1886,7 @@ extern uint32_t priority_p_set(uint32_t last_prio, job_record_t *job_ptr)
 	 */
 	site_factor_g_set(job_ptr);
 
-	priority = _get_priority_internal(time(NULL), job_ptr);
+	priority = _get_priority_internal(time(NULL), job_ptr, false);
 
 	debug2("initial priority for job %u is %u", job_ptr->job_id, priority);
 
@@ -1843,6 +1922,12 @@ extern void priority_p_reconfig(bool assoc_clear)
 	if (assoc_clear)
 		_init_grp_used_tres_run_secs(g_last_ran);
 
+	/* Weights may have changed, build the next snapshot from scratch */
+	slurm_rwlock_wrlock(&snapshot_lock);
+	_destroy_snapshot(prio_snapshot);
+	prio_snapshot = NULL;
+	slurm_rwlock_unlock(&snapshot_lock);
+
 	debug2("%s reconfigured", plugin_name);
 
 	return;
@@ -1900,92 +1985,233 @@ extern double priority_p_calc_fs_factor(long double usage_efctv,
 	return priority_fs;
 }
 
-extern list_t *priority_p_get_priority_factors_list(uid_t uid)
+/*
+ * Build a snapshot of the priority factors of every job sprio could show.
+ * Private data is not filtered here, that is done per request.
+ * Caller must hold job and partition read locks and the QOS read lock.
+ */
+static prio_snapshot_t *_build_snapshot(void)
 {
-	list_t *ret_list = NULL;
+	prio_snapshot_t *snapshot = xmalloc(sizeof(*snapshot));
 	list_itr_t *itr, *job_iter;
 	job_record_t *job_ptr = NULL;
 	part_record_t *job_part_ptr = NULL;
 	time_t start_time = time(NULL);
 
 	xassert(verify_lock(JOB_LOCK, READ_LOCK));
-	xassert(verify_lock(NODE_LOCK, READ_LOCK));
 	xassert(verify_lock(PART_LOCK, READ_LOCK));
 
-	if (job_list && list_count(job_list)) {
+	snapshot->built = start_time;
+	snapshot->job_update = last_job_update;
+	snapshot->part_update = last_part_update;
+	snapshot->recs = list_create(_destroy_snapshot_rec);
+
+	if (!job_list)
+		return snapshot;
+
+	itr = list_iterator_create(job_list);
+	while ((job_ptr = list_next(itr))) {
 		time_t use_time;
 
-		ret_list = list_create(_destroy_priority_factors_obj_light);
-		itr = list_iterator_create(job_list);
-		while ((job_ptr = list_next(itr))) {
-			if (!(flags & PRIORITY_FLAGS_CALCULATE_RUNNING) &&
-			    !IS_JOB_PENDING(job_ptr))
-				continue;
+		if (!(flags & PRIORITY_FLAGS_CALCULATE_RUNNING) &&
+		    !IS_JOB_PENDING(job_ptr))
+			continue;
 
-			/* Job is not active on this cluster. */
-			if (IS_JOB_REVOKED(job_ptr))
-				continue;
+		/* Job is not active on this cluster. */
+		if (IS_JOB_REVOKED(job_ptr))
+			continue;
 
-			/*
-			 * This means the job is not eligible yet
-			 */
-			if (flags & PRIORITY_FLAGS_ACCRUE_ALWAYS)
-				use_time = job_ptr->details->submit_time;
-			else
-				use_time = job_ptr->details->begin_time;
+		/*
+		 * This means the job is not eligible yet
+		 */
+		if (flags & PRIORITY_FLAGS_ACCRUE_ALWAYS)
+			use_time = job_ptr->details->submit_time;
+		else
+			use_time = job_ptr->details->begin_time;
 
-			if (!use_time || (use_time > start_time))
-				continue;
+		if (!use_time)
+			continue;
+		if (use_time > start_time) {
+			/* Snapshot is stale once this job becomes eligible */
+			if (!snapshot->next_begin ||
+			    (use_time < snapshot->next_begin))
+				snapshot->next_begin = use_time;
+			continue;
+		}
 
-			/*
-			 * 0 means the job is held
-			 */
-			if (job_ptr->priority == 0)
-				continue;
+		/*
+		 * 0 means the job is held
+		 */
+		if (job_ptr->priority == 0)
+			continue;
 
-			if ((slurm_conf.private_data & PRIVATE_DATA_JOBS) &&
-			    (job_ptr->user_id != uid) &&
-			    !validate_operator(uid) &&
-			    (((slurm_mcs_get_privatedata() == 0) &&
-			      !assoc_mgr_is_user_acct_coord(acct_db_conn, uid,
-			                                    job_ptr->account,
-							    false)) ||
-			     ((slurm_mcs_get_privatedata() == 1) &&
-			      (mcs_g_check_mcs_label(uid, job_ptr->mcs_label,
-						     false) != 0))))
-				continue;
+		/*
+		 * Job is not in any partition, so there is nothing to
+		 * return. This can happen if the Partition was deleted,
+		 * CALCULATE_RUNNING is enabled, and this job is still
+		 * waiting out MinJobAge before being removed from the
+		 * system.
+		 */
+		if (!job_ptr->part_ptr && !job_ptr->part_ptr_list)
+			continue;
 
-			/*
-			 * Job is not in any partition, so there is nothing to
-			 * return. This can happen if the Partition was deleted,
-			 * CALCULATE_RUNNING is enabled, and this job is still
-			 * waiting out MinJobAge before being removed from the
-			 * system.
-			 */
-			if (!job_ptr->part_ptr && !job_ptr->part_ptr_list)
-				continue;
+		/* Job in one partition */
+		if (!job_ptr->part_ptr_list) {
+			prio_snapshot_rec_t *rec = xmalloc(sizeof(*rec));
 
-			/* Job in one partition */
-			if (!job_ptr->part_ptr_list) {
-				list_append(ret_list,
-					    _create_prio_factors_obj(
-						    job_ptr, NULL));
+			rec->obj = _create_prio_factors_obj(job_ptr, NULL);
+			rec->mcs_label = xstrdup(job_ptr->mcs_label);
+			list_append(snapshot->recs, rec);
+			continue;
+		}
+
+		/* Job in multiple partitions */
+		job_iter = list_iterator_create(job_ptr->part_ptr_list);
+		while ((job_part_ptr = list_next(job_iter))) {
+			prio_snapshot_rec_t *rec = xmalloc(sizeof(*rec));
+
+			rec->obj = _create_prio_factors_obj(job_ptr,
+							    job_part_ptr);
+			rec->mcs_label = xstrdup(job_ptr->mcs_label);
+			list_append(snapshot->recs, rec);
+		}
+		list_iterator_destroy(job_iter);
+	}
+	list_iterator_destroy(itr);
+
+	return snapshot;
+}
+
+/*
+ * A snapshot stays valid until a job or partition changes or a job it left
+ * out becomes eligible. A snapshot built in the same second as the last job
+ * update can not tell whether it missed a later update in that second, so it
+ * is treated as stale.
+ */
+static bool _snapshot_valid(prio_snapshot_t *snapshot, time_t now)
+{
+	if (!snapshot)
+		return false;
+	if ((snapshot->job_update != last_job_update) ||
+	    (snapshot->part_update != last_part_update))
+		return false;
+	if (snapshot->built <= snapshot->job_update)
+		return false;
+	if (snapshot->next_begin && (now >= snapshot->next_begin))
+		return false;
+
+	return true;
+}
+
+/*
+ * Build and publish a new snapshot. Unless force is set, nothing is done if
+ * another thread already published a valid one while we waited.
+ */
+static void _publish_snapshot(bool force)
+{
+	prio_snapshot_t *snapshot, *old;
+	slurmctld_lock_t job_read_lock = {
+		.job = READ_LOCK,
+		.part = READ_LOCK,
+	};
+	assoc_mgr_lock_t qos_read_locks = {
+		.qos = READ_LOCK,
+	};
+
+	slurm_mutex_lock(&snapshot_build_mutex);
+	if (!force) {
+		bool valid;
+
+		slurm_rwlock_rdlock(&snapshot_lock);
+		valid = _snapshot_valid(prio_snapshot, time(NULL));
+		slurm_rwlock_unlock(&snapshot_lock);
+		if (valid) {
+			slurm_mutex_unlock(&snapshot_build_mutex);
+			return;
+		}
+	}
+
+	lock_slurmctld(job_read_lock);
+	assoc_mgr_lock(&qos_read_locks);
+	snapshot = _build_snapshot();
+	assoc_mgr_unlock(&qos_read_locks);
+	unlock_slurmctld(job_read_lock);
+
+	/* Swap outside of the other locks to keep snapshot_lock a leaf */
+	slurm_rwlock_wrlock(&snapshot_lock);
+	old = prio_snapshot;
+	prio_snapshot = snapshot;
+	slurm_rwlock_unlock(&snapshot_lock);
+	slurm_mutex_unlock(&snapshot_build_mutex);
+
+	_destroy_snapshot(old);
+}
+
+/* Return true if uid is not allowed to see the job behind rec */
+static bool _hide_snapshot_rec(prio_snapshot_rec_t *rec, uid_t uid)
+{
+	if (rec->obj->user_id == uid)
+		return false;
+
+	if (slurm_mcs_get_privatedata() == 0)
+		return !assoc_mgr_is_user_acct_coord(acct_db_conn, uid,
+						     rec->obj->account, false);
+	if (slurm_mcs_get_privatedata() == 1)
+		return (mcs_g_check_mcs_label(uid, rec->mcs_label, false) != 0);
+
+	return false;
+}
+
+/*
+ * Copy the factors uid may see out of the current snapshot, building a new
+ * one first if jobs changed since. No slurmctld locks are needed.
+ */
+extern list_t *priority_p_get_priority_factors_list(uid_t uid)
+{
+	list_t *ret_list = NULL;
+	list_itr_t *itr;
+	prio_snapshot_rec_t *rec;
+	bool filter = ((slurm_conf.private_data & PRIVATE_DATA_JOBS) &&
+		       !validate_operator(uid));
+
+	slurm_rwlock_rdlock(&snapshot_lock);
+	if (!_snapshot_valid(prio_snapshot, time(NULL))) {
+		slurm_rwlock_unlock(&snapshot_lock);
+		_publish_snapshot(false);
+		slurm_rwlock_rdlock(&snapshot_lock);
+	}
+
+	if (prio_snapshot && list_count(prio_snapshot->recs)) {
+		ret_list = list_create(slurm_destroy_priority_factors_object);
+		itr = list_iterator_create(prio_snapshot->recs);
+		while ((rec = list_next(itr))) {
+			priority_factors_object_t *obj;
+
+			if (filter && _hide_snapshot_rec(rec, uid))
 				continue;
-			}
 
-			/* Job in multiple partitions */
-			job_iter = list_iterator_create(job_ptr->part_ptr_list);
-			while ((job_part_ptr = list_next(job_iter))) {
-				list_append(ret_list,
-					    _create_prio_factors_obj(
-						    job_ptr, job_part_ptr));
+			obj = xmalloc(sizeof(*obj));
+			obj->account = xstrdup(rec->obj->account);
+			obj->direct_prio = rec->obj->direct_prio;
+			obj->job_id = rec->obj->job_id;
+			obj->partition = xstrdup(rec->obj->partition);
+			obj->qos = xstrdup(rec->obj->qos);
+			obj->user_id = rec->obj->user_id;
+			if (rec->obj->prio_factors) {
+				obj->prio_factors =
+					xmalloc(sizeof(priority_factors_t));
+				slurm_copy_priority_factors(
+					obj->prio_factors,
+					rec->obj->prio_factors);
 			}
-			list_iterator_destroy(job_iter);
+			list_append(ret_list, obj);
 		}
 		list_iterator_destroy(itr);
-		if (!list_count(ret_list))
-			FREE_NULL_LIST(ret_list);
 	}
+	slurm_rwlock_unlock(&snapshot_lock);
+
+	if (ret_list && !list_count(ret_list))
+		FREE_NULL_LIST(ret_list);
 
 	return ret_list;
 }
@@ -2019,8 +2245,8 @@ extern bool decay_apply_new_usage(job_record_t *job_ptr,
 }
 
 
-extern int decay_apply_weighted_factors(job_record_t *job_ptr,
-					time_t *start_time_ptr)
+static int _apply_weighted_factors(job_record_t *job_ptr, time_t start_time,
+				   bool locked)
 {
 	uint32_t new_prio;
 
@@ -2037,7 +2263,7 @@ extern int decay_apply_weighted_factors(job_record_t *job_ptr,
 	     !(flags & PRIORITY_FLAGS_CALCULATE_RUNNING)))
 		return SLURM_SUCCESS;
 
-	new_prio = _get_priority_internal(*start_time_ptr, job_ptr);
+	new_prio = _get_priority_internal(start_time, job_ptr, locked);
 	if (((flags & PRIORITY_FLAGS_INCR_ONLY) == 0) ||
 	    (job_ptr->priority < new_prio)) {
 		job_ptr->priority = new_prio;
@@ -2050,6 +2276,27 @@ extern int decay_apply_weighted_factors(job_record_t *job_ptr,
 	return SLURM_SUCCESS;
 }
 
+static int _apply_weighted_factors_locked(void *x, void *arg)
+{
+	return _apply_weighted_factors(x, *(time_t *) arg, true);
+}
+
+extern int decay_apply_weighted_factors(job_record_t *job_ptr,
+					time_t *start_time_ptr)
+{
+	return _apply_weighted_factors(job_ptr, *start_time_ptr, false);
+}
+
+extern void decay_apply_weighted_factors_all(list_t *jobs, time_t start_time)
+{
+	assoc_mgr_lock_t locks = { .assoc = READ_LOCK, .qos = READ_LOCK,
+				   .tres = READ_LOCK };
+
+	assoc_mgr_lock(&locks);
+	list_for_each(jobs, _apply_weighted_factors_locked, &start_time);
+	assoc_mgr_unlock(&locks);
+}
+
 extern uint32_t priority_p_recover(uint32_t prio_boost)
 {
 	time_t start_time;
@@ -2074,6 +2321,12 @@ extern uint32_t priority_p_recover(uint32_t prio_boost)
 }
 
 extern void set_priority_factors(time_t start_time, job_record_t *job_ptr)
+{
+	_set_priority_factors(start_time, job_ptr, false);
+}
+
+static void _set_priority_factors(time_t start_time, job_record_t *job_ptr,
+				  bool locked)
 {
 	assoc_mgr_lock_t locks = { .assoc = READ_LOCK, .qos = READ_LOCK };
 
@@ -2107,7 +2360,7 @@ extern void set_priority_factors(time_t start_time, job_record_t *job_ptr)
 
 	if (job_ptr->assoc_ptr && weight_fs) {
 		job_ptr->prio_factors->priority_fs =
-			_get_fairshare_priority(job_ptr);
+			_get_fairshare_priority(job_ptr, locked);
 	}
 
 	/* FIXME: this should work off the product of TRESBillingWeights */
@@ -2191,7 +2444,8 @@ extern void set_priority_factors(time_t start_time, job_record_t *job_ptr)
 
 	job_ptr->prio_factors->priority_site = job_ptr->site_factor;
 
-	assoc_mgr_lock(&locks);
+	if (!locked)
+		assoc_mgr_lock(&locks);
 	if (job_ptr->assoc_ptr && weight_assoc)
 		job_ptr->prio_factors->priority_assoc =
 			(flags & PRIORITY_FLAGS_NO_NORMAL_ASSOC) ?
@@ -2204,7 +2458,8 @@ extern void set_priority_factors(time_t start_time, job_record_t *job_ptr)
 			job_ptr->qos_ptr->priority :
 			job_ptr->qos_ptr->usage->norm_priority;
 	}
-	assoc_mgr_unlock(&locks);
+	if (!locked)
+		assoc_mgr_unlock(&locks);
 
 	if (job_ptr->details)
 		job_ptr->prio_factors->nice = job_ptr->details->nice;
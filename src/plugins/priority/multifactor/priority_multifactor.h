@@ -56,6 +56,12 @@ extern bool decay_apply_new_usage(job_record_t *job_ptr,
 				  time_t *start_time_ptr);
 extern int decay_apply_weighted_factors(job_record_t *job_ptr,
 					time_t *start_time_ptr);
+/*
+ * Apply weighted factors to every job in the list while holding the
+ * association, QOS and TRES read locks once for the whole walk.
+ * Caller must hold the slurmctld job write lock.
+ */
+extern void decay_apply_weighted_factors_all(list_t *jobs, time_t start_time);
 extern void set_assoc_usage_norm(slurmdb_assoc_rec_t *assoc);
 extern void set_priority_factors(time_t start_time, job_record_t *job_ptr);
 
@@ -180,6 +180,18 @@ extern int proctrack_p_signal (uint64_t id, int signal)
 	int i;
 	int slurm_task;
 
+	/*
+	 * Start by resuming in case of SIGKILL. Then let the cgroup plugin
+	 * kill all the user processes at once when it can, so processes
+	 * forking while we walk the pids below can't escape and make
+	 * proctrack_p_wait() retry. The walk below still covers processes
+	 * outside of the user cgroup.
+	 */
+	if (signal == SIGKILL) {
+		cgroup_g_step_resume();
+		(void) cgroup_g_step_kill();
+	}
+
 	/* get all the pids associated with the step */
 	if (cgroup_g_step_get_pids(&pids, &npids) != SLURM_SUCCESS) {
 		debug3("unable to get pids list for cont_id=%"PRIu64"", id);
@@ -194,11 +206,6 @@ extern int proctrack_p_signal (uint64_t id, int signal)
 		return cgroup_g_step_suspend();
 	}
 
-	/* start by resuming in case of SIGKILL */
-	if (signal == SIGKILL) {
-		cgroup_g_step_resume();
-	}
-
 	for (i = 0 ; i<npids ; i++) {
 		/*
 		 * Be on the safe side and do not kill slurmstepd (ourselves),
@@ -209,13 +216,18 @@ extern int proctrack_p_signal (uint64_t id, int signal)
 		if (pids[i] == (pid_t)id)
 			continue;
 
-		slurm_task = _slurm_cgroup_is_pid_a_slurm_task(id, pids[i]);
+		/* Only look the process up in /proc when it matters */
 		if (slurm_cgroup_conf.signal_children_processes ||
-		    (slurm_task == 1) || (signal == SIGKILL)) {
-			debug2("sending process %d (%s) signal %d",
-			       pids[i],
-			       (slurm_task==1)?"slurm_task":"inherited_task",
-			       signal);
+		    (signal == SIGKILL)) {
+			debug2("sending process %d signal %d", pids[i], signal);
+			kill(pids[i], signal);
+			continue;
+		}
+
+		slurm_task = _slurm_cgroup_is_pid_a_slurm_task(id, pids[i]);
+		if (slurm_task == 1) {
+			debug2("sending process %d (slurm_task) signal %d",
+			       pids[i], signal);
 			kill(pids[i], signal);
 		}
 	}
@@ -139,9 +139,19 @@ typedef struct {
 	int next;	/* next record, by time, zero termination */
 } node_space_map_t;
 
+typedef struct {
+	time_t end_time;
+	job_record_t *job_ptr;
+} bf_running_t;
+
 typedef struct {
 	node_space_map_t *node_space;
 	int *node_space_recs;
+	bool collect_running;	/* defer node reservations to bulk build */
+	bool licenses_only;	/* only reserve jobs with licenses */
+	bf_running_t *running;	/* node reservations collected */
+	int running_cnt;
+	int running_size;
 } node_space_handler_t;
 
 /*
@@ -219,10 +229,18 @@ static int max_rpc_cnt = 0;
 static int yield_interval = YIELD_INTERVAL;
 static int yield_sleep   = YIELD_SLEEP;
 static list_t *het_job_list = NULL;
-static xhash_t *user_usage_map = NULL; /* look up user usage when no assoc */
+static xahash_table_t *user_usage_map = NULL; /* look up user usage when no assoc */
 static bitstr_t *planned_bitmap = NULL;
 static bool soft_time_limit = false;
 
+/*
+ * node_space record indexes in time order, so the record covering a given
+ * time can be found with a binary search rather than by walking the "next"
+ * chain from the start of the table.
+ */
+static int *node_space_order = NULL;
+static int node_space_order_cnt = 0;
+
 /*********************** local functions *********************/
 static void _add_reservation(uint32_t start_time, uint32_t end_reserve,
 			     bitstr_t *res_bitmap, job_record_t *job_ptr,
@@ -230,6 +248,7 @@ static void _add_reservation(uint32_t start_time, uint32_t end_reserve,
 			     int *node_space_recs);
 static void _adjust_hetjob_prio(uint32_t *prio, uint32_t val);
 static void _attempt_backfill(void);
+static void _bf_build_running(node_space_handler_t *ns_h);
 static int  _clear_job_estimates(void *x, void *arg);
 static int  _clear_qos_blocked_times(void *x, void *arg);
 static void _do_diag_stats(struct timeval *tv1, struct timeval *tv2,
@@ -246,6 +265,12 @@ static void _load_config(void);
 static bool _many_pending_rpcs(void);
 static bool _more_work(time_t last_backfill_time);
 static uint32_t _my_sleep(int64_t usec);
+static int  _node_space_first(node_space_map_t *node_space, time_t end_time);
+static int  _node_space_order_find(node_space_map_t *node_space,
+				   time_t end_time);
+static void _node_space_order_init(void);
+static void _node_space_order_insert(int pos, int inx);
+static void _node_space_order_remove(int pos);
 static int  _num_feature_count(job_record_t *job_ptr, bool *has_xand,
 			       bool *has_mor);
 static int  _het_job_find_map(void *x, void *key);
@@ -271,8 +296,7 @@ static int  _try_sched(job_record_t *job_ptr, bitstr_t **avail_bitmap,
 		       uint32_t min_nodes, uint32_t max_nodes,
 		       uint32_t req_nodes, resv_exc_t *resv_exc_ptr);
 static int  _yield_locks(int64_t usec);
-static void _bf_map_key_id(void *item, const char **key, uint32_t *key_len);
-static void _bf_map_free(void *item);
+static xahash_table_t *_bf_map_new(void);
 
 /* Log resources to be allocated to a pending job */
 static void _dump_job_sched(job_record_t *job_ptr, time_t end_time,
@@ -417,7 +441,9 @@ static int  _try_sched(job_record_t *job_ptr, bitstr_t **avail_bitmap,
 	list_itr_t *feat_iter;
 	job_feature_t *feat_ptr;
 	job_feature_t *feature_base;
+	DEF_PHASE_TIMER(try_sched);
 
+	START_PHASE_TIMER(try_sched);
 	if (has_xand || feat_cnt) {
 		/*
 		 * Cache the feature information and test the individual
@@ -644,6 +670,7 @@ static int  _try_sched(job_record_t *job_ptr, bitstr_t **avail_bitmap,
 	}
 
 	FREE_NULL_LIST(preemptee_candidates);
+	END_PHASE_TIMER(try_sched, &sched_phase_stats[SCHED_PHASE_BF_TEST]);
 	return rc;
 }
 
@@ -1125,7 +1152,7 @@ extern void *backfill_agent(void *args)
 		short_sleep = false;
 	}
 	FREE_NULL_LIST(het_job_list);
-	xhash_free(user_usage_map); /* May have been init'ed if used */
+	FREE_NULL_XAHASH_TABLE(user_usage_map); /* May have been init'ed if used */
 	FREE_NULL_BITMAP(planned_bitmap);
 
 	return NULL;
@@ -1468,6 +1495,10 @@ static int _bf_reserve_running(void *x, void *arg)
 	if (preemptable && !licenses)
 		return SLURM_SUCCESS;
 
+	if ((ns_h->collect_running || ns_h->licenses_only) &&
+	    (ns_h->licenses_only != (bf_licenses && licenses)))
+		return SLURM_SUCCESS;
+
 	if (*ns_recs_ptr >= bf_node_space_size)
 		return SLURM_ERROR;
 
@@ -1485,6 +1516,20 @@ static int _bf_reserve_running(void *x, void *arg)
 
 	end_time = (end_time / backfill_resolution) * backfill_resolution;
 
+	if (ns_h->collect_running) {
+		if (preemptable || !whole || !job_ptr->node_bitmap)
+			return SLURM_SUCCESS;
+		if (ns_h->running_cnt >= ns_h->running_size) {
+			ns_h->running_size = MAX(1024, ns_h->running_size * 2);
+			xrecalloc(ns_h->running, ns_h->running_size,
+				  sizeof(bf_running_t));
+		}
+		ns_h->running[ns_h->running_cnt].end_time = end_time;
+		ns_h->running[ns_h->running_cnt].job_ptr = job_ptr;
+		ns_h->running_cnt++;
+		return SLURM_SUCCESS;
+	}
+
 	if (preemptable || !whole) {
 		/* Reservation only needed for licenses. */
 		tmp_bitmap = bit_alloc(node_record_count);
@@ -1509,6 +1554,93 @@ static int _bf_reserve_running(void *x, void *arg)
 	return SLURM_SUCCESS;
 }
 
+static int _cmp_bf_running(const void *x, const void *y)
+{
+	const bf_running_t *r1 = x, *r2 = y;
+
+	if (r1->end_time < r2->end_time)
+		return -1;
+	if (r1->end_time > r2->end_time)
+		return 1;
+	return 0;
+}
+
+/*
+ * Build the node space map from the running job node reservations collected
+ * by _bf_reserve_running(). The map must still hold only its initial record.
+ * Each reservation starts at the beginning of the map, so the nodes
+ * unavailable in a slot are those of every job ending after the slot begins.
+ * Slots are produced from the distinct job end times, limited by
+ * bf_node_space_size. Jobs ending after the last slot boundary reserve their
+ * nodes through the end of the map.
+ */
+static void _bf_build_running(node_space_handler_t *ns_h)
+{
+	node_space_map_t *node_space = ns_h->node_space;
+	bf_running_t *running = ns_h->running;
+	time_t begin_time = node_space[0].begin_time;
+	time_t window_end = node_space[0].end_time;
+	bitstr_t *base_bitmap, *used_bitmap;
+	int i, k, recs = 1;
+
+	xassert(*ns_h->node_space_recs == 1);
+
+	if (!ns_h->running_cnt)
+		goto fini;
+
+	for (i = 0; i < ns_h->running_cnt; i++) {
+		/* Same minimum length as _add_reservation() uses */
+		if (running[i].end_time < (begin_time + backfill_resolution))
+			running[i].end_time = begin_time + backfill_resolution;
+	}
+	qsort(running, ns_h->running_cnt, sizeof(bf_running_t),
+	      _cmp_bf_running);
+
+	/* Split the map at each distinct end time inside it */
+	for (i = 0; i < ns_h->running_cnt; i++) {
+		if (running[i].end_time >= window_end)
+			break;
+		if (recs >= bf_node_space_size)
+			break;
+		if (running[i].end_time == node_space[recs - 1].begin_time)
+			continue;
+		node_space[recs - 1].end_time = running[i].end_time;
+		node_space[recs - 1].next = recs;
+		node_space[recs].begin_time = running[i].end_time;
+		node_space[recs].end_time = window_end;
+		node_space[recs].avail_bitmap =
+			bit_alloc(bit_size(node_space[0].avail_bitmap));
+		node_space[recs].licenses =
+			bf_licenses_copy(node_space[0].licenses);
+		node_space[recs].next = 0;
+		node_space_order[recs] = recs;
+		recs++;
+	}
+	node_space_order_cnt = recs;
+	*ns_h->node_space_recs = recs;
+
+	/* Accumulate nodes of jobs ending after each slot begins */
+	base_bitmap = bit_copy(node_space[0].avail_bitmap);
+	used_bitmap = bit_alloc(bit_size(base_bitmap));
+	i = ns_h->running_cnt - 1;
+	for (k = recs - 1; k >= 0; k--) {
+		while ((i >= 0) &&
+		       (running[i].end_time > node_space[k].begin_time)) {
+			bit_or(used_bitmap, running[i].job_ptr->node_bitmap);
+			i--;
+		}
+		bit_copybits(node_space[k].avail_bitmap, base_bitmap);
+		bit_and_not(node_space[k].avail_bitmap, used_bitmap);
+	}
+	FREE_NULL_BITMAP(base_bitmap);
+	FREE_NULL_BITMAP(used_bitmap);
+
+fini:
+	xfree(ns_h->running);
+	ns_h->running_cnt = 0;
+	ns_h->running_size = 0;
+}
+
 static int _set_hetjob_details(void *x, void *arg)
 {
 	job_record_t *job_ptr = (job_record_t *) x;
@@ -1537,46 +1669,57 @@ static int _set_hetjob_details(void *x, void *arg)
 	return SLURM_SUCCESS;
 }
 
-/* Fetch key from xhash_t item. Called from function ptr */
-static void _bf_map_key_id(void *item, const char **key, uint32_t *key_len)
+static xahash_hash_t _bf_map_hash(const void *key, const size_t key_bytes,
+				  void *state)
 {
-	bf_user_usage_t *user = (bf_user_usage_t *)item;
+	xassert(key_bytes == sizeof(uid_t));
+
+	return *(const uid_t *) key;
+}
 
-	xassert(user);
+static bool _bf_map_match(void *entry, const void *key,
+			  const size_t key_bytes, void *state)
+{
+	bf_user_usage_t *user = entry;
 
-	*key = (char *)&user->uid;
-	*key_len = sizeof(uid_t);
+	return (user->uid == *(const uid_t *) key);
 }
 
-/* Free item from xhash_t. Called from function ptr */
-static void _bf_map_free(void *item)
+static void _bf_map_on_insert(void *entry, const void *key,
+			      const size_t key_bytes, void *state)
 {
-	bf_user_usage_t *user = (bf_user_usage_t *)item;
+	bf_user_usage_t *user = entry;
 
-	if (!user)
-		return;
+	*user = (bf_user_usage_t) {
+		.uid = *(const uid_t *) key,
+	};
+}
+
+static void _bf_map_free(void *entry, void *state)
+{
+	bf_user_usage_t *user = entry;
 
 	slurmdb_destroy_bf_usage_members(&user->bf_usage);
-	xfree(user);
 }
 
-/* Allocate new user and add to xhash_t map */
-static bf_user_usage_t *_bf_map_add_user(xhash_t *map, uid_t uid)
+/* User usage records are stored inside the table, no xmalloc() per user */
+static xahash_table_t *_bf_map_new(void)
 {
-	bf_user_usage_t *user = xmalloc(sizeof(bf_user_usage_t));
-	user->uid = uid;
-	xhash_add(map, user);
-	return user;
+	return xahash_new_table(_bf_map_hash, _bf_map_match,
+				_bf_map_on_insert, _bf_map_free, 0,
+				sizeof(bf_user_usage_t), 0);
 }
 
-/* Find user usage from uid. Add new empty entry to map if not found */
-static slurmdb_bf_usage_t *_bf_map_find_add(xhash_t* map, uid_t uid)
+/*
+ * Find user usage from uid. Add new empty entry to map if not found
+ * WARNING: pointer is only valid until the next insert into map
+ */
+static slurmdb_bf_usage_t *_bf_map_find_add(xahash_table_t *map, uid_t uid)
 {
 	bf_user_usage_t *user;
 	xassert(map != NULL);
 
-	if (!(user = xhash_get(map, (char *)&uid, sizeof(uid_t))))
-		user = _bf_map_add_user(map, uid);
+	user = xahash_insert_entry(map, &uid, sizeof(uid));
 	return &user->bf_usage;
 }
 
@@ -1669,8 +1812,7 @@ static bool _job_exceeds_max_bf_param(job_record_t *job_ptr,
 		} else {
 			/* No database, or user rec missing from assoc */
 			if (!user_usage_map)
-				user_usage_map = xhash_init(_bf_map_key_id,
-							    _bf_map_free);
+				user_usage_map = _bf_map_new();
 			user_usage = _bf_map_find_add(user_usage_map,
 						      job_ptr->user_id);
 		}
@@ -1775,6 +1917,8 @@ static void _attempt_backfill(void)
 	bool reject_array_use_prefer = false;
 	uint32_t start_time, array_start_time = 0;
 	struct timeval start_tv;
+	DEF_PHASE_TIMER(bf_queue);
+	long queue_usec;
 	uint32_t test_array_job_id = 0;
 	uint32_t test_array_count = 0;
 	uint32_t job_no_reserve;
@@ -1786,6 +1930,7 @@ static void _attempt_backfill(void)
 	time_t tmp_preempt_start_time = 0;
 	bool tmp_preempt_in_progress = false;
 	bitstr_t *tmp_bitmap = NULL;
+	bitstr_t *next_bitmap = NULL, *current_bitmap = NULL;
 	bool state_changed_break = false;
 	resv_exc_t resv_exc = { 0 };
 	/* QOS Read lock */
@@ -1814,7 +1959,9 @@ static void _attempt_backfill(void)
 
 	_handle_planned(false);
 
+	START_PHASE_TIMER(bf_queue);
 	job_queue = build_job_queue(true, true);
+	queue_usec = slurm_delta_tv(&bf_queue_phase_tv);
 	job_test_count = list_count(job_queue);
 	if (job_test_count == 0) {
 		if (slurm_conf.debug_flags & DEBUG_FLAG_BACKFILL)
@@ -1860,18 +2007,33 @@ static void _attempt_backfill(void)
 
 	node_space[0].next = 0;
 	node_space_recs = 1;
+	_node_space_order_init();
 
 	if (bf_running_job_reserve) {
-		node_space_handler_t node_space_handler;
-		node_space_handler.node_space = node_space;
-		node_space_handler.node_space_recs = &node_space_recs;
-
-		if (bf_licenses)
-			list_for_each(resv_list, _bf_reserve_resv_licenses,
-				      &node_space_handler);
+		node_space_handler_t node_space_handler = {
+			.node_space = node_space,
+			.node_space_recs = &node_space_recs,
+			.collect_running = true,
+		};
 
+		/*
+		 * Node reservations of running jobs all start at the
+		 * beginning of the map, so build them in one pass over the
+		 * jobs sorted by end time rather than one _add_reservation()
+		 * per job. License reservations are added to the result.
+		 */
 		list_for_each(job_list, _bf_reserve_running,
 			      &node_space_handler);
+		_bf_build_running(&node_space_handler);
+
+		if (bf_licenses) {
+			node_space_handler.collect_running = false;
+			node_space_handler.licenses_only = true;
+			list_for_each(resv_list, _bf_reserve_resv_licenses,
+				      &node_space_handler);
+			list_for_each(job_list, _bf_reserve_running,
+				      &node_space_handler);
+		}
 	}
 
 	if (slurm_conf.debug_flags & DEBUG_FLAG_BACKFILL_MAP)
@@ -1884,7 +2046,11 @@ static void _attempt_backfill(void)
 		assoc_mgr_unlock(&qos_read_lock);
 	}
 
+	START_PHASE_TIMER(bf_queue);
 	sort_job_queue(job_queue);
+	queue_usec += slurm_delta_tv(&bf_queue_phase_tv);
+	timer_phase_add(&sched_phase_stats[SCHED_PHASE_BF_BUILD_QUEUE],
+			queue_usec);
 
 	/* Ignore nodes that have been set as available during this cycle. */
 	bit_clear_all(bf_ignore_node_bitmap);
@@ -2137,8 +2303,7 @@ static void _attempt_backfill(void)
 				xmalloc(sizeof(slurmdb_bf_usage_t));
 			part_data->resv_usage =
 				xmalloc(sizeof(slurmdb_bf_usage_t));
-			part_data->user_usage = xhash_init(_bf_map_key_id,
-							   _bf_map_free);
+			part_data->user_usage = _bf_map_new();
 			job_ptr->part_ptr->bf_data = part_data;
 		}
 
@@ -2467,14 +2632,26 @@ next_task:
 		bit_and_not(avail_bitmap, bf_ignore_node_bitmap);
 		filter_by_node_owner(job_ptr, avail_bitmap);
 		filter_by_node_mcs(job_ptr, mcs_select, avail_bitmap);
-		tmp_bitmap = bit_copy(avail_bitmap);
-		for (j = 0; ; ) {
+		/*
+		 * Scratch bitmaps are reused across time slots and jobs rather
+		 * than copied for every node_space record tested.
+		 */
+		if (!tmp_bitmap ||
+		    (bit_size(tmp_bitmap) != bit_size(avail_bitmap))) {
+			FREE_NULL_BITMAP(tmp_bitmap);
+			FREE_NULL_BITMAP(next_bitmap);
+			FREE_NULL_BITMAP(current_bitmap);
+			tmp_bitmap = bit_alloc(bit_size(avail_bitmap));
+			next_bitmap = bit_alloc(bit_size(avail_bitmap));
+			current_bitmap = bit_alloc(bit_size(avail_bitmap));
+		}
+		bit_copybits(tmp_bitmap, avail_bitmap);
+		for (j = _node_space_first(node_space, start_res + 1); ; ) {
 			if ((node_space[j].end_time > start_res) &&
 			     node_space[j].next && (later_start == 0)) {
 				int tmp = node_space[j].next;
-				bitstr_t *next_bitmap = bit_copy(tmp_bitmap);
-				bitstr_t *current_bitmap =
-					bit_copy(avail_bitmap);
+				bit_copybits(next_bitmap, tmp_bitmap);
+				bit_copybits(current_bitmap, avail_bitmap);
 				bit_and(next_bitmap,
 					node_space[tmp].avail_bitmap);
 				bit_and(current_bitmap,
@@ -2492,8 +2669,6 @@ next_task:
 				 */
 				if (!bit_super_set(next_bitmap, current_bitmap))
 					later_start = node_space[j].end_time;
-				FREE_NULL_BITMAP(next_bitmap);
-				FREE_NULL_BITMAP(current_bitmap);
 			}
 			if (node_space[j].end_time <= start_res)
 				;
@@ -2512,7 +2687,6 @@ next_task:
 			if ((j = node_space[j].next) == 0)
 				break;
 		}
-		FREE_NULL_BITMAP(tmp_bitmap);
 		if (resv_end && (++resv_end < window_end) &&
 		    ((later_start == 0) || (resv_end < later_start))) {
 			later_start = resv_end;
@@ -2638,7 +2812,8 @@ next_task:
 			orig_end_time = end_time;
 			end_time += boot_time;
 
-			for (j = 0; ; ) {
+			for (j = _node_space_first(node_space, start_res + 1);
+			     ; ) {
 				if (node_space[j].end_time <= start_res)
 					;
 				else if (node_space[j].begin_time <= end_time) {
@@ -3208,6 +3383,11 @@ skip_start:
 	FREE_NULL_BITMAP(avail_bitmap);
 	reservation_delete_resv_exc_parts(&resv_exc);
 	FREE_NULL_BITMAP(resv_bitmap);
+	FREE_NULL_BITMAP(tmp_bitmap);
+	FREE_NULL_BITMAP(next_bitmap);
+	FREE_NULL_BITMAP(current_bitmap);
+	xfree(node_space_order);
+	node_space_order_cnt = 0;
 
 	for (i = 0; ; ) {
 		FREE_NULL_BITMAP(node_space[i].avail_bitmap);
@@ -3401,6 +3581,77 @@ static bool _more_work(time_t last_backfill_time)
 	return rc;
 }
 
+/* Reset node_space_order to hold only the initial node_space record */
+static void _node_space_order_init(void)
+{
+	xfree(node_space_order);
+	node_space_order = xcalloc(bf_node_space_size + 2, sizeof(int));
+	node_space_order[0] = 0;
+	node_space_order_cnt = 1;
+}
+
+/* Record node_space record inx at position pos of node_space_order */
+static void _node_space_order_insert(int pos, int inx)
+{
+	xassert(node_space_order_cnt < (bf_node_space_size + 2));
+
+	memmove(&node_space_order[pos + 1], &node_space_order[pos],
+		sizeof(int) * (node_space_order_cnt - pos));
+	node_space_order[pos] = inx;
+	node_space_order_cnt++;
+}
+
+/* Drop the merged node_space record at position pos of node_space_order */
+static void _node_space_order_remove(int pos)
+{
+	xassert(pos < node_space_order_cnt);
+
+	node_space_order_cnt--;
+	memmove(&node_space_order[pos], &node_space_order[pos + 1],
+		sizeof(int) * (node_space_order_cnt - pos));
+}
+
+/*
+ * Return position in node_space_order of the first record with an end_time
+ * at or after end_time, or node_space_order_cnt if there is none. This is the
+ * same record a walk of the "next" chain from record zero would stop at.
+ */
+static int _node_space_order_find(node_space_map_t *node_space,
+				  time_t end_time)
+{
+	int lo = 0, hi = node_space_order_cnt;
+
+	while (lo < hi) {
+		int mid = lo + ((hi - lo) / 2);
+
+		if (node_space[node_space_order[mid]].end_time < end_time)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	return lo;
+}
+
+/*
+ * Return node_space record to start a walk of the "next" chain from, skipping
+ * records that end before end_time. If every record ends before end_time,
+ * return the last record so the walk visits it and terminates.
+ */
+static int _node_space_first(node_space_map_t *node_space, time_t end_time)
+{
+	int pos;
+
+	if (!node_space_order_cnt)
+		return 0;
+
+	pos = _node_space_order_find(node_space, end_time);
+	if (pos >= node_space_order_cnt)
+		pos = node_space_order_cnt - 1;
+
+	return node_space_order[pos];
+}
+
 /* Create a reservation for a job in the future */
 static void _add_reservation(uint32_t start_time, uint32_t end_reserve,
 			     bitstr_t *res_bitmap, job_record_t *job_ptr,
@@ -3408,7 +3659,7 @@ static void _add_reservation(uint32_t start_time, uint32_t end_reserve,
 			     int *node_space_recs)
 {
 	bool placed = false;
-	int i, j, one_before = 0, one_after = -1;
+	int i, j, pos, before_pos = 0, one_before = 0, one_after = -1;
 
 #if 0
 	info("add job start:%u end:%u", start_time, end_reserve);
@@ -3430,7 +3681,16 @@ static void _add_reservation(uint32_t start_time, uint32_t end_reserve,
 	 */
 	if (end_reserve < (start_time + backfill_resolution))
 		end_reserve = start_time + backfill_resolution;
-	for (j = 0; ; ) {
+
+	/* Skip records ending before start_time */
+	pos = _node_space_order_find(node_space, start_time);
+	if (pos >= node_space_order_cnt)
+		return;
+	if (pos) {
+		before_pos = pos - 1;
+		one_before = node_space_order[before_pos];
+	}
+	for (j = node_space_order[pos]; ; ) {
 		if (node_space[j].end_time > start_time) {
 			/* insert start entry record */
 			i = *node_space_recs;
@@ -3443,6 +3703,7 @@ static void _add_reservation(uint32_t start_time, uint32_t end_reserve,
 				bf_licenses_copy(node_space[j].licenses);
 			node_space[i].next = node_space[j].next;
 			node_space[j].next = i;
+			_node_space_order_insert(pos + 1, i);
 			(*node_space_recs)++;
 			placed = true;
 			break;
@@ -3453,11 +3714,14 @@ static void _add_reservation(uint32_t start_time, uint32_t end_reserve,
 			break;
 		}
 		one_before = j;
+		before_pos = pos;
 		if ((j = node_space[j].next) == 0)
 			break;
+		pos++;
 	}
 
 	while (placed && (j = node_space[j].next)) {
+		pos++;
 		if (end_reserve < node_space[j].end_time) {
 			/* insert end entry record */
 			i = *node_space_recs;
@@ -3470,6 +3734,7 @@ static void _add_reservation(uint32_t start_time, uint32_t end_reserve,
 				bf_licenses_copy(node_space[j].licenses);
 			node_space[i].next = node_space[j].next;
 			node_space[j].next = i;
+			_node_space_order_insert(pos + 1, i);
 			(*node_space_recs)++;
 		}
 
@@ -3491,7 +3756,7 @@ static void _add_reservation(uint32_t start_time, uint32_t end_reserve,
 
 	/* Drop records with identical bitmaps (up to one record).
 	 * This can significantly improve performance of the backfill tests. */
-	for (i = one_before; i != one_after; ) {
+	for (i = one_before, pos = before_pos; i != one_after; pos++) {
 		if ((j = node_space[i].next) == 0)
 			break;
 		if (!bf_licenses_equal(node_space[i].licenses,
@@ -3504,6 +3769,7 @@ static void _add_reservation(uint32_t start_time, uint32_t end_reserve,
 			i = j;
 			continue;
 		}
+		_node_space_order_remove(pos + 1);
 		node_space[i].end_time = node_space[j].end_time;
 		node_space[i].next = node_space[j].next;
 		FREE_NULL_BITMAP(node_space[j].avail_bitmap);
@@ -3526,7 +3792,7 @@ static bool _test_resv_overlap(node_space_map_t *node_space,
 			       uint32_t start_time, uint32_t end_reserve)
 {
 	bool overlap = false;
-	int j = 0;
+	int j = _node_space_first(node_space, start_time + 1);
 	bitstr_t *use_bitmap_efctv = NULL;
 
 	if (IS_JOB_WHOLE_TOPO(job_ptr)) {
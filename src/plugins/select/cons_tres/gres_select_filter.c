@@ -72,22 +72,18 @@ static bool *_build_avail_cores_by_sock(bitstr_t *core_bitmap,
 					uint16_t cores_per_sock)
 {
 	bool *avail_cores_by_sock = xcalloc(sockets, sizeof(bool));
-	int s, c, i, lim = 0;
+	int s, i, lim = 0;
 
 	lim = bit_size(core_bitmap);
 	for (s = 0; s < sockets; s++) {
-		for (c = 0; c < cores_per_sock; c++) {
-			i = (s * cores_per_sock) + c;
-			if (i >= lim)
-				goto fini;	/* should never happen */
-			if (bit_test(core_bitmap, i)) {
-				avail_cores_by_sock[s] = true;
-				break;
-			}
-		}
+		i = s * cores_per_sock;
+		if (i >= lim)
+			break;	/* should never happen */
+		if (bit_set_count_range(core_bitmap, i, i + cores_per_sock))
+			avail_cores_by_sock[s] = true;
 	}
 
-fini:	return avail_cores_by_sock;
+	return avail_cores_by_sock;
 }
 
 /* Set max_node_gres if it is unset or greater than val */
@@ -149,6 +149,16 @@ static void _handle_gres_exc_basic(resv_exc_t *resv_exc_ptr,
 	return;
 }
 
+/* Return true if any core of socket "sock" is set in the per-node bitmap */
+static bool _sock_has_core(bitstr_t *core_bitmap, int sock,
+			   uint16_t cores_per_sock)
+{
+	int first_core = sock * cores_per_sock;
+
+	return bit_set_count_range(core_bitmap, first_core,
+				   first_core + cores_per_sock) > 0;
+}
+
 /*
  * Determine how many GRES of a given type can be used by this job on a
  * given node and return a structure with the details. Note that multiple
@@ -169,7 +179,7 @@ static sock_gres_t *_build_sock_gres_by_topo(
 	gres_job_state_t *gres_js = gres_state_job->gres_data;
 	gres_node_state_t *gres_ns = gres_state_node->gres_data;
 	gres_node_state_t *alt_gres_ns = NULL;
-	int i, j, s, c;
+	int i, s, c;
 	uint32_t tot_cores;
 	sock_gres_t *sock_gres;
 	int64_t add_gres;
@@ -270,16 +280,8 @@ static sock_gres_t *_build_sock_gres_by_topo(
 		    !res_cores_per_gpu) {
 			use_all_sockets = true;
 			for (s = 0; s < sockets; s++) {
-				bool use_this_socket = false;
-				for (c = 0; c < cores_per_sock; c++) {
-					j = (s * cores_per_sock) + c;
-					if (bit_test(gres_ns->
-						     topo_core_bitmap[i], j)) {
-						use_this_socket = true;
-						break;
-					}
-				}
-				if (!use_this_socket) {
+				if (!_sock_has_core(gres_ns->topo_core_bitmap[i],
+						    s, cores_per_sock)) {
 					use_all_sockets = false;
 					break;
 				}
@@ -309,42 +311,30 @@ static sock_gres_t *_build_sock_gres_by_topo(
 
 		/* Constrained by core */
 		for (s = 0; ((s < sockets) && avail_gres); s++) {
-			if (enforce_binding && core_bitmap) {
-				for (c = 0; c < cores_per_sock; c++) {
-					j = (s * cores_per_sock) + c;
-					if (bit_test(core_bitmap, j))
-						break;
-				}
-				if (c >= cores_per_sock) {
-					/* No available cores on this socket */
-					continue;
-				}
+			if (enforce_binding && core_bitmap &&
+			    !_sock_has_core(core_bitmap, s, cores_per_sock)) {
+				/* No available cores on this socket */
+				continue;
 			}
-			for (c = 0; c < cores_per_sock; c++) {
-				j = (s * cores_per_sock) + c;
-				if (gres_ns->topo_core_bitmap[i] &&
-				    !bit_test(gres_ns->topo_core_bitmap[i],
-					      j))
-					continue;
-				if (!gres_ns->topo_gres_bitmap[i]) {
-					error("%s: topo_gres_bitmap NULL on node %s",
-					      __func__, node_name);
-					continue;
-				}
-				if (!sock_gres->bits_by_sock[s]) {
-					sock_gres->bits_by_sock[s] =
-						bit_copy(gres_ns->
-							 topo_gres_bitmap[i]);
-				} else {
-					bit_or(sock_gres->bits_by_sock[s],
-					       gres_ns->topo_gres_bitmap[i]);
-				}
-				sock_gres->cnt_by_sock[s] += avail_gres;
-				sock_gres->total_cnt += avail_gres;
-				avail_gres = 0;
-				match = true;
-				break;
+			if (!_sock_has_core(gres_ns->topo_core_bitmap[i], s,
+					    cores_per_sock))
+				continue;
+			if (!gres_ns->topo_gres_bitmap[i]) {
+				error("%s: topo_gres_bitmap NULL on node %s",
+				      __func__, node_name);
+				continue;
 			}
+			if (!sock_gres->bits_by_sock[s]) {
+				sock_gres->bits_by_sock[s] =
+					bit_copy(gres_ns->topo_gres_bitmap[i]);
+			} else {
+				bit_or(sock_gres->bits_by_sock[s],
+				       gres_ns->topo_gres_bitmap[i]);
+			}
+			sock_gres->cnt_by_sock[s] += avail_gres;
+			sock_gres->total_cnt += avail_gres;
+			avail_gres = 0;
+			match = true;
 		}
 	}
 
@@ -390,14 +380,10 @@ static sock_gres_t *_build_sock_gres_by_topo(
 		for (s = 0; s < sockets; s++) {
 			if (sock_gres->cnt_by_sock[s] == 0)
 				continue;
-			for (c = 0; c < cores_per_sock; c++) {
-				i = (s * cores_per_sock) + c;
-				if (!bit_test(core_bitmap, i))
-					continue;
-				avail_sock++;
-				avail_sock_flag[s] = true;
-				break;
-			}
+			if (!_sock_has_core(core_bitmap, s, cores_per_sock))
+				continue;
+			avail_sock++;
+			avail_sock_flag[s] = true;
 		}
 		while (avail_sock > s_p_n) {
 			int low_gres_sock_inx = -1;
@@ -444,17 +430,13 @@ static sock_gres_t *_build_sock_gres_by_topo(
 		for (s = 0; s < sockets; s++) {
 			if (sock_gres->cnt_by_sock[s] == 0)
 				continue;
-			for (c = 0; c < cores_per_sock; c++) {
-				i = (s * cores_per_sock) + c;
-				if (!bit_test(core_bitmap, i))
-					continue;
-				avail_sock_flag[s] = true;
-				if ((best_sock_inx == -1) ||
-				    (sock_gres->cnt_by_sock[s] >
-				     sock_gres->cnt_by_sock[best_sock_inx])) {
-					best_sock_inx = s;
-				}
-				break;
+			if (!_sock_has_core(core_bitmap, s, cores_per_sock))
+				continue;
+			avail_sock_flag[s] = true;
+			if ((best_sock_inx == -1) ||
+			    (sock_gres->cnt_by_sock[s] >
+			     sock_gres->cnt_by_sock[best_sock_inx])) {
+				best_sock_inx = s;
 			}
 		}
 		while ((best_sock_inx != -1) && (add_gres > 0)) {
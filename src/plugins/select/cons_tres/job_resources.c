@@ -66,6 +66,8 @@ static bitstr_t *_create_core_bitmap(int node_inx)
  * IN r_ptr - row we are trying to fit
  *            IN/OUT r_ptr->row_bitmap - bitmap array (one per node) of
  *                                       available cores, allocated as needed
+ *                                       (a NULL node entry means no cores
+ *                                       of that node are in use in the row)
  * IN type - add/rem/test
  * RET 1 on success, 0 otherwise
  */
@@ -88,8 +90,6 @@ static int _handle_job_res(job_resources_t *job_resrcs_ptr,
 		core_array = build_core_array();
 		r_ptr->row_bitmap = core_array;
 		r_ptr->row_set_count = 0;
-		for (int i = 0; i < node_record_count; i++)
-			core_array[i] = _create_core_bitmap(i);
 	} else
 		core_array = r_ptr->row_bitmap;
 
@@ -98,6 +98,14 @@ static int _handle_job_res(job_resources_t *job_resrcs_ptr,
 	     i++) {
 		cores_per_node = node_ptr->tot_cores;
 
+		/*
+		 * Per-node core bitmaps are only created once a job is added
+		 * to this row on the node, so rows of large clusters with few
+		 * jobs stay sparse.
+		 */
+		if (!core_array[i] && (type == HANDLE_JOB_RES_ADD))
+			core_array[i] = _create_core_bitmap(i);
+
 		/*
 		 * This segment properly handles the core counts when whole
 		 * nodes are allocated, including when explicitly requesting
@@ -209,6 +217,8 @@ extern char *job_res_job_action_string(job_res_job_action_t action)
  * IN r_ptr - row we are trying to fit
  *            IN/OUT r_ptr->row_bitmap - bitmap array (one per node) of
  *                                       available cores, allocated as needed
+ *                                       (a NULL node entry means no cores
+ *                                       of that node are in use in the row)
  * NOTE: Patterned after add_job_to_cores() in src/common/job_resources.c
  */
 extern void job_res_add_cores(job_resources_t *job_resrcs_ptr,
@@ -225,6 +235,8 @@ extern void job_res_add_cores(job_resources_t *job_resrcs_ptr,
  * IN r_ptr - row we are trying to fit
  *            IN/OUT r_ptr->row_bitmap - bitmap array (one per node) of
  *                                       available cores, allocated as needed
+ *                                       (a NULL node entry means no cores
+ *                                       of that node are in use in the row)
  */
 extern void job_res_rm_cores(job_resources_t *job_resrcs_ptr,
 			     part_row_data_t *r_ptr)
@@ -274,6 +286,8 @@ extern int job_res_add_job(job_record_t *job_ptr, job_res_job_action_t action)
 	bitstr_t *core_bitmap;
 	bool new_alloc = true;
 
+	job_test_running_cache_clear();
+
 	if (!job || !job->core_bitmap) {
 		error("%pJ has no job_resrcs info",
 		      job_ptr);
@@ -435,6 +449,9 @@ extern int job_res_rm_job(part_res_record_t *part_record_ptr,
 	int i, n;
 	bool old_job = false;
 
+	if (part_record_ptr == select_part_record)
+		job_test_running_cache_clear();
+
 	if (select_state_initializing) {
 		/*
 		 * Ignore job removal until select/cons_tres data structures
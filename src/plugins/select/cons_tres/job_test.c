@@ -70,12 +70,36 @@ typedef struct {
 	uint32_t *sum_cpus;
 } gres_cpus_foreach_args_t;
 
+typedef struct {
+	avail_res_t **avail_res_array;
+	bitstr_t **core_map;
+	uint16_t cr_type;
+	int i_first;
+	int i_last;
+	job_record_t *job_ptr;
+	bitstr_t *node_map;
+	node_use_record_t *node_usage;
+	bitstr_t **part_core_map;
+	resv_exc_t *resv_exc_ptr;
+	uint32_t s_p_n;
+	bool test_only;
+	bool will_run;
+} res_avail_args_t;
+
 uint64_t def_cpu_per_gpu = 0;
 uint64_t def_mem_per_gpu = 0;
 bool preempt_strict_order = false;
 bool preempt_for_licenses = false;
 int preempt_reorder_cnt	= 1;
 
+/*
+ * Running and suspended jobs sorted by end time, reused by _will_run_test()
+ * until the set of jobs allocated by this plugin changes.
+ */
+static list_t *running_job_cache = NULL;
+static bool running_job_cache_valid = false;
+static pthread_mutex_t running_job_cache_mutex = PTHREAD_MUTEX_INITIALIZER;
+
 /* Local functions */
 static avail_res_t *_allocate(job_record_t *job_ptr,
 			      bitstr_t *core_map,
@@ -511,6 +535,31 @@ static avail_res_t *_can_job_run_on_node(job_record_t *job_ptr,
 		return NULL;
 	}
 
+	/*
+	 * A node without free cores or without the memory of a per-node memory
+	 * request fails regardless of its GRES, so test that before building
+	 * the socket GRES list and allocating cores.
+	 */
+	if (core_map[node_i] && (bit_ffs(core_map[node_i]) == -1)) {
+		log_flag(SELECT_TYPE, "Test fail on node %d: no available cores",
+			 node_i);
+		return NULL;
+	}
+	if ((cr_type & CR_MEMORY) &&
+	    !(job_ptr->details->pn_min_memory & MEM_PER_CPU)) {
+		avail_mem = node_ptr->real_memory - node_ptr->mem_spec_limit;
+		if (!test_only)
+			avail_mem -= node_usage[node_i].alloc_memory;
+		if (job_ptr->details->pn_min_memory > avail_mem) {
+			log_flag(SELECT_TYPE, "Test fail on node %d: insufficient memory (%"PRIu64" < %"PRIu64")",
+				 node_i, avail_mem,
+				 job_ptr->details->pn_min_memory);
+			if (core_map[node_i])
+				bit_clear_all(core_map[node_i]);
+			return NULL;
+		}
+	}
+
 	if (part_core_map)
 		part_core_map_ptr = part_core_map[node_i];
 	if (node_usage[node_i].gres_list)
@@ -687,6 +736,95 @@ static avail_res_t *_can_job_run_on_node(job_record_t *job_ptr,
 	return avail_res;
 }
 
+static int _alloc_res_gpu_cores(void *x, void *arg)
+{
+	gres_state_t *gres_state_job = x;
+	gres_job_state_t *gres_js = gres_state_job->gres_data;
+
+	if (!gres_js->res_gpu_cores) {
+		gres_js->res_array_size = node_record_count;
+		gres_js->res_gpu_cores = xcalloc(gres_js->res_array_size,
+						 sizeof(bitstr_t *));
+	}
+
+	return 0;
+}
+
+/*
+ * Test if _can_job_run_on_node() can be called for different nodes of this
+ * job concurrently. Per-node results are kept in per-node slots of the job's
+ * GRES state, so make sure those arrays exist before any thread starts.
+ * Reservation GRES filtering records the matched GRES in resv_exc_ptr, which
+ * is shared by all nodes, so those jobs are evaluated serially.
+ */
+static bool _can_eval_parallel(job_record_t *job_ptr, resv_exc_t *resv_exc_ptr)
+{
+	if (resv_exc_ptr &&
+	    (resv_exc_ptr->gres_list_exc || resv_exc_ptr->gres_list_inc))
+		return false;
+
+	if (job_ptr->gres_list_req)
+		(void) list_for_each(job_ptr->gres_list_req,
+				     _alloc_res_gpu_cores, NULL);
+
+	return true;
+}
+
+static void *_get_res_avail_thread(void *arg)
+{
+	res_avail_args_t *args = arg;
+
+	for (int i = args->i_first; i <= args->i_last; i++) {
+		if (!bit_test(args->node_map, i))
+			continue;
+		args->avail_res_array[i] =
+			_can_job_run_on_node(
+				args->job_ptr, args->core_map, i,
+				args->s_p_n, args->node_usage,
+				args->cr_type, args->test_only,
+				args->will_run, args->part_core_map,
+				args->resv_exc_ptr);
+	}
+
+	return NULL;
+}
+
+/*
+ * Split the [i_first, i_last] node index range into select_eval_threads
+ * consecutive pieces and evaluate each one in its own thread. Every thread
+ * only writes the avail_res_array and core_map entries of its own nodes.
+ */
+static void _get_res_avail_parallel(res_avail_args_t *args, int i_first,
+				    int i_last)
+{
+	int thread_cnt = select_eval_threads;
+	int range = i_last - i_first + 1, chunk;
+	pthread_t *tids;
+	res_avail_args_t *thread_args;
+
+	thread_cnt = MIN(thread_cnt, range);
+	chunk = (range + thread_cnt - 1) / thread_cnt;
+	tids = xcalloc(thread_cnt, sizeof(pthread_t));
+	thread_args = xcalloc(thread_cnt, sizeof(res_avail_args_t));
+
+	for (int t = 0; t < thread_cnt; t++) {
+		thread_args[t] = *args;
+		thread_args[t].i_first = i_first + (t * chunk);
+		thread_args[t].i_last = MIN(thread_args[t].i_first + chunk - 1,
+					    i_last);
+		/* The calling thread evaluates the first piece itself */
+		if (t)
+			slurm_thread_create(&tids[t], _get_res_avail_thread,
+					    &thread_args[t]);
+	}
+	_get_res_avail_thread(&thread_args[0]);
+	for (int t = 1; t < thread_cnt; t++)
+		slurm_thread_join(tids[t]);
+
+	xfree(tids);
+	xfree(thread_args);
+}
+
 /*
  * Determine resource availability for pending job
  *
@@ -714,13 +852,34 @@ static avail_res_t **_get_res_avail(job_record_t *job_ptr,
 	int i, i_first, i_last;
 	avail_res_t **avail_res_array = NULL;
 	uint32_t s_p_n = _socks_per_node(job_ptr);
+	res_avail_args_t args = {
+		.core_map = core_map,
+		.cr_type = cr_type,
+		.job_ptr = job_ptr,
+		.node_map = node_map,
+		.node_usage = node_usage,
+		.part_core_map = part_core_map,
+		.resv_exc_ptr = resv_exc_ptr,
+		.s_p_n = s_p_n,
+		.test_only = test_only,
+		.will_run = will_run,
+	};
 
 	avail_res_array = xcalloc(node_record_count, sizeof(avail_res_t *));
+	args.avail_res_array = avail_res_array;
 	i_first = bit_ffs(node_map);
 	if (i_first != -1)
 		i_last = bit_fls(node_map);
 	else
 		i_last = -2;
+
+	if ((select_eval_threads > 1) && _can_eval_parallel(job_ptr,
+							     resv_exc_ptr) &&
+	    (bit_set_count(node_map) >= select_eval_min_nodes)) {
+		_get_res_avail_parallel(&args, i_first, i_last);
+		return avail_res_array;
+	}
+
 	for (i = i_first; i <= i_last; i++) {
 		if (bit_test(node_map, i))
 			avail_res_array[i] =
@@ -1407,6 +1566,19 @@ try_next_nodes_cnt:
 			}
 		}
 	}
+	if (part_core_map) {
+		/*
+		 * Row bitmaps only hold entries for nodes with cores in use,
+		 * give candidate nodes without one an empty map so they are
+		 * counted as unused by this partition.
+		 */
+		node_record_t *node_ptr;
+		for (int n = 0; (node_ptr = next_node_bitmap(node_bitmap, &n));
+		     n++) {
+			if (!part_core_map[n])
+				part_core_map[n] = bit_alloc(node_ptr->tot_cores);
+		}
+	}
 	if (job_ptr->details->whole_node & WHOLE_NODE_REQUIRED)
 		_block_whole_nodes(node_bitmap, avail_cores, free_cores);
 
@@ -1951,8 +2123,13 @@ alloc_job:
 	error_code = dist_tasks(job_ptr, cr_type, preempt_mode,
 				avail_cores, gres_task_limit);
 	if (job_ptr->gres_list_req && (error_code == SLURM_SUCCESS)) {
+		DEF_PHASE_TIMER(gres);
+
+		START_PHASE_TIMER(gres);
 		error_code = gres_select_filter_select_and_set(
 			sock_gres_list, job_ptr, tres_mc_ptr);
+		END_PHASE_TIMER(gres,
+				&sched_phase_stats[SCHED_PHASE_GRES_SELECT]);
 	}
 	xfree(gres_task_limit);
 	xfree(node_gres_list);
@@ -2253,6 +2430,82 @@ static int _build_cr_job_list(void *x, void *arg)
 	return 0;
 }
 
+static int _add_running_job(void *x, void *arg)
+{
+	job_record_t *job_ptr = x;
+	list_t *running_list = arg;
+
+	if (!IS_JOB_RUNNING(job_ptr) && !IS_JOB_SUSPENDED(job_ptr))
+		return 0;
+	if (!job_ptr->end_time || !job_ptr->node_bitmap)
+		return 0;	/* Logged by _build_cr_job_list() */
+	list_append(running_list, job_ptr);
+
+	return 0;
+}
+
+static int _running_job_stale(void *x, void *arg)
+{
+	job_record_t *job_ptr = x;
+	time_t *last_end_time = arg;
+
+	xassert(job_ptr->magic == JOB_MAGIC);
+
+	if (!IS_JOB_RUNNING(job_ptr) && !IS_JOB_SUSPENDED(job_ptr))
+		return 1;
+	if (!job_ptr->end_time || !job_ptr->node_bitmap)
+		return 1;
+	/* Time limit changes can reorder the jobs */
+	if (job_ptr->end_time < *last_end_time)
+		return 1;
+	*last_end_time = job_ptr->end_time;
+
+	return 0;
+}
+
+/*
+ * Build cr_job_list from the cached list of running jobs sorted by end time,
+ * rebuilding the cache if jobs were started or ended since it was built or
+ * if a job of the cache is no longer running or has moved out of order.
+ * The resulting cr_job_list is sorted by end time.
+ */
+static void _build_cr_job_list_cached(cr_job_list_args_t *args)
+{
+	time_t last_end_time = 0;
+
+	slurm_mutex_lock(&running_job_cache_mutex);
+	if (running_job_cache_valid &&
+	    list_find_first(running_job_cache, _running_job_stale,
+			    &last_end_time))
+		running_job_cache_valid = false;
+	if (!running_job_cache_valid) {
+		if (!running_job_cache)
+			running_job_cache = list_create(NULL);
+		else
+			list_flush(running_job_cache);
+		list_for_each(job_list, _add_running_job, running_job_cache);
+		list_sort(running_job_cache, _cr_job_list_sort);
+		running_job_cache_valid = true;
+	}
+	list_for_each(running_job_cache, _build_cr_job_list, args);
+	slurm_mutex_unlock(&running_job_cache_mutex);
+}
+
+extern void job_test_running_cache_clear(void)
+{
+	slurm_mutex_lock(&running_job_cache_mutex);
+	running_job_cache_valid = false;
+	slurm_mutex_unlock(&running_job_cache_mutex);
+}
+
+extern void job_test_fini(void)
+{
+	slurm_mutex_lock(&running_job_cache_mutex);
+	FREE_NULL_LIST(running_job_cache);
+	running_job_cache_valid = false;
+	slurm_mutex_unlock(&running_job_cache_mutex);
+}
+
 /*
  * Set scheduling weight for node bitmaps -- pre-nodeset scheduling.
  *
@@ -2382,7 +2635,7 @@ static int _will_run_test(job_record_t *job_ptr, bitstr_t *node_bitmap,
 		.orig_map = orig_map,
 		.qos_preemptor = &qos_preemptor,
 	};
-	list_for_each(job_list, _build_cr_job_list, &args);
+	_build_cr_job_list_cached(&args);
 
 	/* Test with all preemptable jobs gone */
 	if (preemptee_candidates) {
@@ -2413,7 +2666,6 @@ static int _will_run_test(job_record_t *job_ptr, bitstr_t *node_bitmap,
 		bool more_jobs = true;
 		bitstr_t *efctv_bitmap_ptr, *efctv_bitmap = NULL;
 		DEF_TIMERS;
-		list_sort(cr_job_list, _cr_job_list_sort);
 		START_TIMER;
 		job_iterator = list_iterator_create(cr_job_list);
 		while (more_jobs) {
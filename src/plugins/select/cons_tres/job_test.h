@@ -82,4 +82,13 @@ extern int job_test(job_record_t *job_ptr, bitstr_t *bitmap,
 		    list_t **preemptee_job_list,
 		    resv_exc_t *resv_exc_ptr);
 
+/*
+ * Invalidate the sorted list of running jobs used for will-run tests. Call
+ * whenever jobs are added to or removed from the plugin's data structures.
+ */
+extern void job_test_running_cache_clear(void);
+
+/* Release the cached list of running jobs */
+extern void job_test_fini(void);
+
 #endif /* !_CONS_TRES_JOB_TEST_H */
@@ -91,6 +91,8 @@ int      bf_window_scale      = 0;
 bool     gang_mode            = false;
 bool     preempt_by_part      = false;
 bool     preempt_by_qos       = false;
+int      select_eval_min_nodes = 0;
+int      select_eval_threads  = 0;
 bool     spec_cores_first     = false;
 
 struct select_nodeinfo {
@@ -223,6 +225,7 @@ extern int fini(void)
 	part_data_destroy_res(select_part_record);
 	select_part_record = NULL;
 	cr_fini_global_core_data();
+	job_test_fini();
 
 	return SLURM_SUCCESS;
 }
@@ -311,6 +314,28 @@ extern int select_p_node_init(void)
 	} else
 		bf_window_scale = 0;
 
+	select_eval_threads = 0;
+	if ((tmp_ptr = xstrcasestr(slurm_conf.sched_params,
+				   "select_eval_threads="))) {
+		select_eval_threads = atoi(tmp_ptr + 20);
+		if (select_eval_threads < 0) {
+			error("Invalid SchedulerParameters select_eval_threads: %d",
+			      select_eval_threads);
+			select_eval_threads = 0;	/* Use default value */
+		}
+	}
+	select_eval_min_nodes = DEFAULT_SELECT_EVAL_MIN_NODES;
+	if ((tmp_ptr = xstrcasestr(slurm_conf.sched_params,
+				   "select_eval_min_nodes="))) {
+		select_eval_min_nodes = atoi(tmp_ptr + 22);
+		if (select_eval_min_nodes < 1) {
+			error("Invalid SchedulerParameters select_eval_min_nodes: %d",
+			      select_eval_min_nodes);
+			/* Use default value */
+			select_eval_min_nodes = DEFAULT_SELECT_EVAL_MIN_NODES;
+		}
+	}
+
 	if (xstrcasestr(slurm_conf.sched_params, "spec_cores_first"))
 		spec_cores_first = true;
 	else
@@ -794,6 +819,8 @@ extern int select_p_job_fini(job_record_t *job_ptr)
 
 	log_flag(SELECT_TYPE, "%pJ", job_ptr);
 
+	/* Jobs without job_resrcs are cached too, forget them here */
+	job_test_running_cache_clear();
 	job_res_rm_job(select_part_record, select_node_usage, NULL,
 		       job_ptr, JOB_RES_ACTION_NORMAL, NULL);
 
@@ -68,6 +68,12 @@
 #include "job_resources.h"
 #include "job_test.h"
 
+/*
+ * Minimum count of candidate nodes for a job before their evaluation is spread
+ * over select_eval_threads threads
+ */
+#define DEFAULT_SELECT_EVAL_MIN_NODES 1024
+
 /* Global variables */
 extern bool     backfill_busy_nodes;
 extern int      bf_window_scale;
@@ -76,6 +82,8 @@ extern bool     have_dragonfly;
 extern bool     pack_serial_at_end;
 extern bool     preempt_by_part;
 extern bool     preempt_by_qos;
+extern int      select_eval_min_nodes;
+extern int      select_eval_threads;
 extern bool     spec_cores_first;
 extern bool     topo_optional;
 
@@ -35,11 +35,9 @@
 
 #include "config.h"
 
-#if HAVE_JSON_C_INC
-#include <json-c/json.h>
-#else
-#include <json/json.h>
-#endif
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
 
 #include "slurm/slurm.h"
 #include "src/common/slurm_xlator.h"
@@ -48,6 +46,7 @@
 #include "src/common/log.h"
 #include "src/common/read_config.h"
 #include "src/common/xassert.h"
+#include "src/common/xmalloc.h"
 #include "src/common/xstring.h"
 #include "src/interfaces/serializer.h"
 
@@ -85,8 +84,6 @@ const char *mime_types[] = {
 	NULL
 };
 
-static json_object *_data_to_json(const data_t *d);
-
 extern int serializer_p_init(void)
 {
 	log_flag(DATA, "loaded");
@@ -102,129 +99,582 @@ extern int serializer_p_fini(void)
 }
 
 
-static json_object *_try_parse(const char *src, size_t stringlen,
-			       struct json_tokener *tok)
+/*
+ * Parse JSON text straight into data_t instead of having json-c build an
+ * object tree that then gets copied. This accepts the same input as
+ * json-c's default (non-strict) tokener: comments, single quoted strings,
+ * trailing commas, case-insensitive literals and NaN/Infinity.
+ */
+#define JSON_MAX_DEPTH 32 /* same as JSON_TOKENER_DEFAULT_DEPTH */
+
+typedef struct {
+	const char *pos;
+	const char *end;
+	int depth;
+	const char *err; /* description of first error */
+	char *buf; /* decoded string */
+	size_t buf_size;
+} json_parser_t;
+
+static bool _parse_value(json_parser_t *p, data_t *d);
+
+static bool _parse_fail(json_parser_t *p, const char *err)
 {
-	json_object *jobj = json_tokener_parse_ex(tok, src, stringlen);
+	if (!p->err)
+		p->err = err;
+	return false;
+}
 
-	if (jobj == NULL) {
-		enum json_tokener_error jerr = json_tokener_get_error(tok);
-		error("%s: JSON parsing error %zu bytes: %s",
-		      __func__, stringlen, json_tokener_error_desc(jerr));
-		return NULL;
+/* Skip whitespace and comments. Returns false on unterminated comment. */
+static bool _skip_ws(json_parser_t *p)
+{
+	while (p->pos < p->end) {
+		const char c = *p->pos;
+
+		if ((c == ' ') || (c == '\t') || (c == '\n') || (c == '\r')) {
+			p->pos++;
+		} else if ((c == '/') && ((p->end - p->pos) > 1) &&
+			   (p->pos[1] == '*')) {
+			const char *close = NULL;
+
+			for (const char *i = p->pos + 2; (i + 1) < p->end; i++) {
+				if ((i[0] == '*') && (i[1] == '/')) {
+					close = i;
+					break;
+				}
+			}
+			if (!close)
+				return _parse_fail(p, "unterminated comment");
+			p->pos = close + 2;
+		} else if ((c == '/') && ((p->end - p->pos) > 1) &&
+			   (p->pos[1] == '/')) {
+			while ((p->pos < p->end) && (*p->pos != '\n'))
+				p->pos++;
+		} else {
+			break;
+		}
 	}
-	if (tok->char_offset < stringlen)
-		log_flag(DATA, "%s: Extra %zu characters after JSON string detected",
-		     __func__, (stringlen - tok->char_offset));
 
-	return jobj;
+	return true;
 }
 
-static data_t *_json_to_data(json_object *jobj, data_t *d)
+/* Match literal (case insensitive) at current position */
+static bool _match_literal(json_parser_t *p, const char *literal)
 {
-	size_t arraylen = 0;
+	size_t len = strlen(literal);
 
-	if (!d)
-		d = data_new();
+	if (((p->end - p->pos) < len) || xstrncasecmp(p->pos, literal, len))
+		return false;
 
-	switch (json_object_get_type(jobj)) {
-	case json_type_null:
-		data_set_null(d);
-		break;
-	case json_type_boolean:
-		data_set_bool(d, json_object_get_boolean(jobj));
-		break;
-	case json_type_double:
-		data_set_float(d, json_object_get_double(jobj));
-		break;
-	case json_type_int:
-		data_set_int(d, json_object_get_int64(jobj));
-		break;
-	case json_type_object:
-		data_set_dict(d);
-		/* warning: json_object_object_foreach is an evil macro */
-		json_object_object_foreach(jobj, key, val) {
-			_json_to_data(val, data_key_set(d, key));
+	p->pos += len;
+	return true;
+}
+
+static void _buf_append(json_parser_t *p, size_t *len, const char *src,
+			size_t src_len)
+{
+	if ((*len + src_len + 1) > p->buf_size) {
+		p->buf_size = MAX((p->buf_size * 2), (*len + src_len + 1));
+		xrealloc(p->buf, p->buf_size);
+	}
+
+	memcpy(p->buf + *len, src, src_len);
+	*len += src_len;
+	p->buf[*len] = '\0';
+}
+
+static int _parse_hex4(const char *src)
+{
+	int value = 0;
+
+	for (int i = 0; i < 4; i++) {
+		const char c = src[i];
+
+		value <<= 4;
+		if ((c >= '0') && (c <= '9'))
+			value |= c - '0';
+		else if ((c >= 'a') && (c <= 'f'))
+			value |= c - 'a' + 10;
+		else if ((c >= 'A') && (c <= 'F'))
+			value |= c - 'A' + 10;
+		else
+			return -1;
+	}
+
+	return value;
+}
+
+/* Append unicode code point encoded as UTF-8 */
+static void _buf_append_utf8(json_parser_t *p, size_t *len, uint32_t cp)
+{
+	char utf8[4];
+	size_t bytes;
+
+	if (cp < 0x80) {
+		utf8[0] = cp;
+		bytes = 1;
+	} else if (cp < 0x800) {
+		utf8[0] = 0xc0 | (cp >> 6);
+		utf8[1] = 0x80 | (cp & 0x3f);
+		bytes = 2;
+	} else if (cp < 0x10000) {
+		utf8[0] = 0xe0 | (cp >> 12);
+		utf8[1] = 0x80 | ((cp >> 6) & 0x3f);
+		utf8[2] = 0x80 | (cp & 0x3f);
+		bytes = 3;
+	} else {
+		utf8[0] = 0xf0 | (cp >> 18);
+		utf8[1] = 0x80 | ((cp >> 12) & 0x3f);
+		utf8[2] = 0x80 | ((cp >> 6) & 0x3f);
+		utf8[3] = 0x80 | (cp & 0x3f);
+		bytes = 4;
+	}
+
+	_buf_append(p, len, utf8, bytes);
+}
+
+/* Parse quoted string at current position into p->buf */
+static bool _parse_string(json_parser_t *p)
+{
+	const char quote = *p->pos;
+	const char *run;
+	size_t len = 0;
+
+	_buf_append(p, &len, "", 0);
+	run = ++p->pos;
+
+	while (p->pos < p->end) {
+		const char c = *p->pos;
+		int cp;
+
+		if (c == quote) {
+			_buf_append(p, &len, run, (p->pos - run));
+			p->pos++;
+			return true;
+		} else if (c != '\\') {
+			p->pos++;
+			continue;
 		}
-		break;
-	case json_type_array:
-		arraylen = json_object_array_length(jobj);
-		data_set_list(d);
-		for (size_t i = 0; i < arraylen; i++)
-			_json_to_data(json_object_array_get_idx(jobj, i),
-				      data_list_append(d));
-		break;
-	case json_type_string:
-		data_set_string(d, json_object_get_string(jobj));
-		break;
+
+		_buf_append(p, &len, run, (p->pos - run));
+		if ((p->end - p->pos) < 2)
+			break;
+		p->pos += 2;
+
+		switch (p->pos[-1]) {
+		case '"':
+		case '\'':
+		case '\\':
+		case '/':
+			_buf_append(p, &len, (p->pos - 1), 1);
+			break;
+		case 'b':
+			_buf_append(p, &len, "\b", 1);
+			break;
+		case 'f':
+			_buf_append(p, &len, "\f", 1);
+			break;
+		case 'n':
+			_buf_append(p, &len, "\n", 1);
+			break;
+		case 'r':
+			_buf_append(p, &len, "\r", 1);
+			break;
+		case 't':
+			_buf_append(p, &len, "\t", 1);
+			break;
+		case 'u':
+			if (((p->end - p->pos) < 4) ||
+			    ((cp = _parse_hex4(p->pos)) < 0))
+				return _parse_fail(p, "invalid unicode escape");
+			p->pos += 4;
+
+			if ((cp >= 0xd800) && (cp <= 0xdbff)) {
+				int low;
+
+				/* high surrogate must be followed by low */
+				if (((p->end - p->pos) >= 6) &&
+				    (p->pos[0] == '\\') && (p->pos[1] == 'u') &&
+				    ((low = _parse_hex4(p->pos + 2)) >= 0xdc00) &&
+				    (low <= 0xdfff)) {
+					cp = 0x10000 + ((cp - 0xd800) << 10) +
+					     (low - 0xdc00);
+					p->pos += 6;
+				} else {
+					cp = 0xfffd;
+				}
+			} else if ((cp >= 0xdc00) && (cp <= 0xdfff)) {
+				cp = 0xfffd;
+			}
+
+			_buf_append_utf8(p, &len, cp);
+			break;
+		default:
+			return _parse_fail(p, "invalid string escape");
+		}
+
+		run = p->pos;
+	}
+
+	return _parse_fail(p, "unterminated string");
+}
+
+static bool _parse_number(json_parser_t *p, data_t *d)
+{
+	const char *start = p->pos;
+	bool is_float = false;
+	char *num, *endptr = NULL;
+
+	while ((p->pos < p->end) && strchr("0123456789.+-eE", *p->pos)) {
+		if ((*p->pos == '.') || (*p->pos == 'e') || (*p->pos == 'E'))
+			is_float = true;
+		p->pos++;
+	}
+
+	if (p->pos == start)
+		return _parse_fail(p, "unexpected character");
+
+	num = xstrndup(start, (p->pos - start));
+
+	errno = 0;
+	if (is_float) {
+		double value = strtod(num, &endptr);
+		if (!*endptr)
+			data_set_float(d, value);
+	} else {
+		/* out of range values are clamped, as json-c does */
+		int64_t value = strtoll(num, &endptr, 10);
+		if (!*endptr)
+			data_set_int(d, value);
+	}
+
+	if (*endptr) {
+		xfree(num);
+		return _parse_fail(p, "invalid number");
+	}
+
+	xfree(num);
+	return true;
+}
+
+static bool _parse_dict(json_parser_t *p, data_t *d)
+{
+	data_set_dict(d);
+	p->pos++;
+
+	while (true) {
+		data_t *child;
+
+		if (!_skip_ws(p))
+			return false;
+		if (p->pos >= p->end)
+			break;
+		if (*p->pos == '}') {
+			/* empty dictionary or trailing comma */
+			p->pos++;
+			return true;
+		}
+		if ((*p->pos != '"') && (*p->pos != '\''))
+			return _parse_fail(p, "expected object key");
+		if (!_parse_string(p))
+			return false;
+
+		child = data_key_set(d, p->buf);
+
+		if (!_skip_ws(p))
+			return false;
+		if ((p->pos >= p->end) || (*p->pos != ':'))
+			return _parse_fail(p, "expected ':' after object key");
+		p->pos++;
+
+		if (!_parse_value(p, child))
+			return false;
+
+		if (!_skip_ws(p))
+			return false;
+		if (p->pos >= p->end)
+			break;
+		if (*p->pos == ',') {
+			p->pos++;
+		} else if (*p->pos == '}') {
+			p->pos++;
+			return true;
+		} else {
+			return _parse_fail(p, "expected ',' or '}' in object");
+		}
+	}
+
+	return _parse_fail(p, "unterminated object");
+}
+
+static bool _parse_list(json_parser_t *p, data_t *d)
+{
+	data_set_list(d);
+	p->pos++;
+
+	while (true) {
+		if (!_skip_ws(p))
+			return false;
+		if (p->pos >= p->end)
+			break;
+		if (*p->pos == ']') {
+			/* empty list or trailing comma */
+			p->pos++;
+			return true;
+		}
+
+		if (!_parse_value(p, data_list_append(d)))
+			return false;
+
+		if (!_skip_ws(p))
+			return false;
+		if (p->pos >= p->end)
+			break;
+		if (*p->pos == ',') {
+			p->pos++;
+		} else if (*p->pos == ']') {
+			p->pos++;
+			return true;
+		} else {
+			return _parse_fail(p, "expected ',' or ']' in array");
+		}
+	}
+
+	return _parse_fail(p, "unterminated array");
+}
+
+static bool _parse_value(json_parser_t *p, data_t *d)
+{
+	bool rc;
+
+	if (!_skip_ws(p))
+		return false;
+	if (p->pos >= p->end)
+		return _parse_fail(p, "unexpected end of data");
+
+	switch (*p->pos) {
+	case '{':
+	case '[':
+		if (++p->depth > JSON_MAX_DEPTH)
+			return _parse_fail(p, "nesting too deep");
+		if (*p->pos == '{')
+			rc = _parse_dict(p, d);
+		else
+			rc = _parse_list(p, d);
+		p->depth--;
+		return rc;
+	case '"':
+	case '\'':
+		if (!_parse_string(p))
+			return false;
+		data_set_string(d, p->buf);
+		return true;
 	default:
-		fatal_abort("%s: unknown JSON type", __func__);
-	};
+		break;
+	}
 
-	return d;
+	if (_match_literal(p, "null")) {
+		data_set_null(d);
+	} else if (_match_literal(p, "true")) {
+		data_set_bool(d, true);
+	} else if (_match_literal(p, "false")) {
+		data_set_bool(d, false);
+	} else if (_match_literal(p, "NaN")) {
+		data_set_float(d, NAN);
+	} else if (_match_literal(p, "Infinity")) {
+		data_set_float(d, INFINITY);
+	} else if (_match_literal(p, "-Infinity")) {
+		data_set_float(d, -INFINITY);
+	} else {
+		return _parse_number(p, d);
+	}
+
+	return true;
+}
+
+/*
+ * Serialize data_t straight into JSON text instead of first building a
+ * json-c object tree out of it. The output matches what json-c generates
+ * for JSON_C_TO_STRING_PLAIN and JSON_C_TO_STRING_SPACED |
+ * JSON_C_TO_STRING_PRETTY.
+ */
+typedef struct {
+	char *str;
+	char *pos;
+	bool pretty;
+	int depth;
+} json_writer_t;
+
+static void _write_json(json_writer_t *w, const data_t *d);
+
+static void _write_indent(json_writer_t *w)
+{
+	if (!w->pretty)
+		return;
+
+	xstrcatat(w->str, &w->pos, "\n");
+	for (int i = 0; i < w->depth; i++)
+		xstrcatat(w->str, &w->pos, "  ");
 }
 
-static data_for_each_cmd_t _convert_dict_json(const char *key,
-					      const data_t *data,
-					      void *arg)
+static void _write_json_string(json_writer_t *w, const char *str)
 {
-	json_object *jobj = arg;
-	json_object *jobject = _data_to_json(data);
+	static const char hex[] = "0123456789abcdef";
+	const char *run = str;
+
+	xstrcatat(w->str, &w->pos, "\"");
+
+	for (; *str; str++) {
+		unsigned char c = *str;
+		const char *esc = NULL;
+		char uesc[7];
+
+		switch (c) {
+		case '\b':
+			esc = "\\b";
+			break;
+		case '\n':
+			esc = "\\n";
+			break;
+		case '\r':
+			esc = "\\r";
+			break;
+		case '\t':
+			esc = "\\t";
+			break;
+		case '\f':
+			esc = "\\f";
+			break;
+		case '"':
+			esc = "\\\"";
+			break;
+		case '\\':
+			esc = "\\\\";
+			break;
+		case '/':
+			esc = "\\/";
+			break;
+		default:
+			if (c < ' ') {
+				uesc[0] = '\\';
+				uesc[1] = 'u';
+				uesc[2] = '0';
+				uesc[3] = '0';
+				uesc[4] = hex[c >> 4];
+				uesc[5] = hex[c & 0xf];
+				uesc[6] = '\0';
+				esc = uesc;
+			}
+		}
+
+		if (!esc)
+			continue;
+
+		if (str > run)
+			xstrncatat(w->str, &w->pos, run, (str - run));
+		xstrcatat(w->str, &w->pos, esc);
+		run = str + 1;
+	}
+
+	if (str > run)
+		xstrncatat(w->str, &w->pos, run, (str - run));
+	xstrcatat(w->str, &w->pos, "\"");
+}
+
+static void _write_json_float(json_writer_t *w, double value)
+{
+	if (isnan(value)) {
+		xstrcatat(w->str, &w->pos, "NaN");
+	} else if (isinf(value)) {
+		xstrcatat(w->str, &w->pos,
+			  ((value < 0) ? "-Infinity" : "Infinity"));
+	} else {
+		char buf[64];
+
+		snprintf(buf, sizeof(buf), "%.17g", value);
+		xstrcatat(w->str, &w->pos, buf);
+
+		/* Keep it looking like a float, as json-c does */
+		if (!strpbrk(buf, ".eE"))
+			xstrcatat(w->str, &w->pos, ".0");
+	}
+}
+
+static data_for_each_cmd_t _write_dict_json(const char *key,
+					    const data_t *data,
+					    void *arg)
+{
+	json_writer_t *w = arg;
+
+	if (w->pos[-1] != '{')
+		xstrcatat(w->str, &w->pos, ",");
+	_write_indent(w);
+	_write_json_string(w, key);
+	xstrcatat(w->str, &w->pos, (w->pretty ? ": " : ":"));
+	_write_json(w, data);
 
-	json_object_object_add(jobj, key, jobject);
 	return DATA_FOR_EACH_CONT;
 }
 
-static data_for_each_cmd_t _convert_list_json(const data_t *data, void *arg)
+static data_for_each_cmd_t _write_list_json(const data_t *data, void *arg)
 {
-	json_object *jobj = arg;
-	json_object *jarray = _data_to_json(data);
+	json_writer_t *w = arg;
+
+	if (w->pos[-1] != '[')
+		xstrcatat(w->str, &w->pos, ",");
+	_write_indent(w);
+	_write_json(w, data);
 
-	json_object_array_add(jobj, jarray);
 	return DATA_FOR_EACH_CONT;
 }
 
-static json_object *_data_to_json(const data_t *d)
+static void _write_json(json_writer_t *w, const data_t *d)
 {
-	if (!d)
-		return NULL;
+	if (!d) {
+		xstrcatat(w->str, &w->pos, "null");
+		return;
+	}
 
 	switch (data_get_type(d)) {
 	case DATA_TYPE_NULL:
-		return NULL;
+		xstrcatat(w->str, &w->pos, "null");
 		break;
 	case DATA_TYPE_BOOL:
-		return json_object_new_boolean(data_get_bool(d));
+		xstrcatat(w->str, &w->pos,
+			  (data_get_bool(d) ? "true" : "false"));
 		break;
 	case DATA_TYPE_FLOAT:
-		return json_object_new_double(data_get_float(d));
+		_write_json_float(w, data_get_float(d));
 		break;
 	case DATA_TYPE_INT_64:
-		return json_object_new_int64(data_get_int(d));
+		xstrfmtcatat(w->str, &w->pos, "%"PRId64, data_get_int(d));
 		break;
 	case DATA_TYPE_DICT:
-	{
-		json_object *jobj = json_object_new_object();
-		if (data_dict_for_each_const(d, _convert_dict_json, jobj) < 0)
-			error("%s: unexpected error calling _convert_dict_json()",
+		xstrcatat(w->str, &w->pos, "{");
+		w->depth++;
+		if (data_dict_for_each_const(d, _write_dict_json, w) < 0)
+			error("%s: unexpected error calling _write_dict_json()",
 			      __func__);
-		return jobj;
-	}
+		w->depth--;
+		if (w->pos[-1] != '{')
+			_write_indent(w);
+		xstrcatat(w->str, &w->pos, "}");
+		break;
 	case DATA_TYPE_LIST:
-	{
-		json_object *jobj = json_object_new_array();
-		if (data_list_for_each_const(d, _convert_list_json, jobj) < 0)
-			error("%s: unexpected error calling _convert_list_json()",
+		xstrcatat(w->str, &w->pos, "[");
+		w->depth++;
+		if (data_list_for_each_const(d, _write_list_json, w) < 0)
+			error("%s: unexpected error calling _write_list_json()",
 			      __func__);
-		return jobj;
-	}
+		w->depth--;
+		if (w->pos[-1] != '[')
+			_write_indent(w);
+		xstrcatat(w->str, &w->pos, "]");
+		break;
 	case DATA_TYPE_STRING:
 	{
 		const char *str = data_get_string(d);
-		if (str)
-			return json_object_new_string(str);
-		else
-			return json_object_new_string("");
+		_write_json_string(w, (str ? str : ""));
 		break;
 	}
 	default:
@@ -236,66 +686,55 @@ extern int serialize_p_data_to_string(char **dest, size_t *length,
 				      const data_t *src,
 				      serializer_flags_t flags)
 {
-	struct json_object *jobj = _data_to_json(src);
-	int jflags = 0;
+	json_writer_t w = { 0 };
 
 	/* can't be pretty and compact at the same time! */
 	xassert((flags & (SER_FLAGS_PRETTY | SER_FLAGS_COMPACT)) !=
 		(SER_FLAGS_PRETTY | SER_FLAGS_COMPACT));
 
-	switch (flags) {
-	case SER_FLAGS_PRETTY:
-		jflags = JSON_C_TO_STRING_SPACED | JSON_C_TO_STRING_PRETTY;
-		break;
-	case SER_FLAGS_COMPACT: /* fallthrough */
-	default:
-		jflags = JSON_C_TO_STRING_PLAIN;
-	}
+	w.pretty = (flags == SER_FLAGS_PRETTY);
+
+	_write_json(&w, src);
 
-	/* string will die with jobj */
-	*dest = xstrdup(json_object_to_json_string_ext(jobj, jflags));
+	*dest = w.str;
 	if (length) {
 		/* add 1 for \0 */
-		*length = strlen(*dest) + 1;
+		*length = (w.pos - w.str) + 1;
 	}
 
-	/* put is equiv to free() */
-	json_object_put(jobj);
-
 	return SLURM_SUCCESS;
 }
 
 extern int serialize_p_string_to_data(data_t **dest, const char *src,
 				      size_t length)
 {
-	json_object *jobj = NULL;
+	json_parser_t p = { 0 };
 	data_t *data = NULL;
-	struct json_tokener *tok = json_tokener_new();
-	int rc;
-
-	if (!tok)
-		return ENOMEM;
+	size_t len;
 
 	if (!src)
 		return ESLURM_DATA_PTR_NULL;
 
-	/* json-c has hard limit of 32 bits */
-	if (length >= INT32_MAX) {
-		error("%s: unable to parse JSON: too large",
-		      __func__);
-		return ESLURM_DATA_TOO_LARGE;
+	/* length may or may not count a terminating \0 */
+	len = strnlen(src, length);
+	p.pos = src;
+	p.end = src + len;
+
+	data = data_new();
+	if (!_parse_value(&p, data)) {
+		error("%s: JSON parsing error %zu bytes: %s at byte %zu",
+		      __func__, len, p.err, (size_t) (p.pos - src));
+		FREE_NULL_DATA(data);
+		xfree(p.buf);
+		*dest = NULL;
+		return ESLURM_REST_FAIL_PARSING;
 	}
 
-	jobj = _try_parse(src, length, tok);
-	if (jobj) {
-		data = _json_to_data(jobj, NULL);
-		json_object_put(jobj);
-		rc = SLURM_SUCCESS;
-	} else
-		rc = ESLURM_REST_FAIL_PARSING;
-
-	json_tokener_free(tok);
+	if (_skip_ws(&p) && (p.pos < p.end))
+		log_flag(DATA, "%s: Extra %zu characters after JSON string detected",
+			 __func__, (size_t) (p.end - p.pos));
 
+	xfree(p.buf);
 	*dest = data;
-	return rc;
+	return SLURM_SUCCESS;
 }
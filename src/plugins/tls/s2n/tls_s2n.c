@@ -33,6 +33,8 @@
  *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA.
 \*****************************************************************************/
 
+#include "config.h"
+
 #include <s2n.h>
 #include <sys/poll.h>
 #include <sys/stat.h>
@@ -57,6 +59,9 @@
 
 #define DEFAULT_S2N_PSK_IDENTITY "slurm_s2n_psk"
 
+/* Max number of wiped s2n connections kept for reuse per mode */
+#define S2N_CONN_POOL_SIZE 64
+
 const char plugin_name[] = "s2n tls plugin";
 const char plugin_type[] = "tls/s2n";
 const uint32_t plugin_id = TLS_PLUGIN_S2N;
@@ -64,14 +69,145 @@ const uint32_t plugin_version = SLURM_VERSION_NUMBER;
 
 static struct s2n_psk *psk = NULL;
 static struct s2n_config *config = NULL;
+static bool use_ktls = false;
+
+/*
+ * Wiped s2n connections ready to be reused. s2n_connection_new() allocates
+ * the connection and its record buffers, which s2n_connection_wipe() keeps.
+ */
+static pthread_mutex_t pool_lock = PTHREAD_MUTEX_INITIALIZER;
+static struct s2n_connection *client_pool[S2N_CONN_POOL_SIZE];
+static struct s2n_connection *server_pool[S2N_CONN_POOL_SIZE];
+static int client_pool_cnt = 0;
+static int server_pool_cnt = 0;
 
 typedef struct {
 	int index; /* MUST ALWAYS BE FIRST. DO NOT PACK. */
 	pthread_mutex_t lock;
 	int fd;
+	s2n_mode mode;
+	bool ktls;
 	struct s2n_connection *s2n_conn;
 } tls_conn_t;
 
+static struct s2n_connection *_conn_get(s2n_mode mode)
+{
+	struct s2n_connection *s2n_conn = NULL;
+
+	slurm_mutex_lock(&pool_lock);
+	if ((mode == S2N_CLIENT) && client_pool_cnt)
+		s2n_conn = client_pool[--client_pool_cnt];
+	else if ((mode == S2N_SERVER) && server_pool_cnt)
+		s2n_conn = server_pool[--server_pool_cnt];
+	slurm_mutex_unlock(&pool_lock);
+
+	if (s2n_conn)
+		return s2n_conn;
+
+	if (!(s2n_conn = s2n_connection_new(mode)))
+		error("%s: s2n_connection_new: %s",
+		      __func__, s2n_strerror(s2n_errno, NULL));
+
+	return s2n_conn;
+}
+
+/* Wipe and keep connection for reuse, or free it if the pool is full */
+static void _conn_put(struct s2n_connection *s2n_conn, s2n_mode mode,
+		      bool reuse)
+{
+	if (reuse && (s2n_connection_wipe(s2n_conn) < 0)) {
+		error("%s: s2n_connection_wipe: %s",
+		      __func__, s2n_strerror(s2n_errno, NULL));
+		reuse = false;
+	}
+
+	if (reuse) {
+		slurm_mutex_lock(&pool_lock);
+		if ((mode == S2N_CLIENT) &&
+		    (client_pool_cnt < S2N_CONN_POOL_SIZE)) {
+			client_pool[client_pool_cnt++] = s2n_conn;
+			s2n_conn = NULL;
+		} else if ((mode == S2N_SERVER) &&
+			   (server_pool_cnt < S2N_CONN_POOL_SIZE)) {
+			server_pool[server_pool_cnt++] = s2n_conn;
+			s2n_conn = NULL;
+		}
+		slurm_mutex_unlock(&pool_lock);
+	}
+
+	if (s2n_conn && (s2n_connection_free(s2n_conn) < 0))
+		error("%s: s2n_connection_free: %s",
+		      __func__, s2n_strerror(s2n_errno, NULL));
+}
+
+static void _pool_free(struct s2n_connection **pool, int *cnt)
+{
+	for (int i = 0; i < *cnt; i++)
+		if (s2n_connection_free(pool[i]) < 0)
+			error("%s: s2n_connection_free: %s",
+			      __func__, s2n_strerror(s2n_errno, NULL));
+	*cnt = 0;
+}
+
+/*
+ * Wait for the fd to be ready for the direction s2n is blocked on.
+ * RET 0 when ready or -1 on error or timeout
+ */
+static int _wait_blocked(int fd, s2n_blocked_status blocked)
+{
+	struct pollfd ufd = {
+		.fd = fd,
+		.events = POLLIN,
+	};
+	int rc;
+
+	if (blocked == S2N_BLOCKED_ON_WRITE)
+		ufd.events = POLLOUT;
+	else if (blocked != S2N_BLOCKED_ON_READ)
+		return wait_fd_readable(fd, slurm_conf.msg_timeout);
+
+	while ((rc = poll(&ufd, 1, (slurm_conf.msg_timeout * 1000))) < 0) {
+		if (errno != EINTR) {
+			error("%s: poll(): %m", __func__);
+			return -1;
+		}
+	}
+
+	if (!rc) {
+		error("%s: Timeout waiting for socket", __func__);
+		return -1;
+	}
+
+	if (!(ufd.revents & ufd.events))
+		return -1;
+
+	return 0;
+}
+
+/*
+ * Hand the record layer to the kernel once the handshake is done. Failure is
+ * not fatal as s2n keeps doing the encryption in userspace.
+ */
+static void _enable_ktls(tls_conn_t *conn)
+{
+#ifdef HAVE_S2N_CONNECTION_KTLS_ENABLE_SEND
+	if (s2n_connection_ktls_enable_send(conn->s2n_conn) < 0) {
+		log_flag(TLS, "%s: kTLS send unavailable. fd:%d: %s",
+			 plugin_type, conn->fd,
+			 s2n_strerror(s2n_errno, NULL));
+		return;
+	}
+	conn->ktls = true;
+
+	if (s2n_connection_ktls_enable_recv(conn->s2n_conn) < 0)
+		log_flag(TLS, "%s: kTLS recv unavailable. fd:%d: %s",
+			 plugin_type, conn->fd,
+			 s2n_strerror(s2n_errno, NULL));
+
+	log_flag(TLS, "%s: kTLS enabled. fd:%d", plugin_type, conn->fd);
+#endif
+}
+
 static void _check_key_permissions(const char *path, int bad_perms)
 {
 	struct stat statbuf;
@@ -219,11 +355,25 @@ extern int init(void)
 		return SLURM_ERROR;
 	}
 
+	if (xstrcasestr(slurm_conf.tls_params, "ktls")) {
+#ifdef HAVE_S2N_CONNECTION_KTLS_ENABLE_SEND
+		use_ktls = true;
+#else
+		warning("%s: TLSParameters=ktls requested but s2n was built without kTLS support",
+			plugin_type);
+#endif
+	}
+
 	return SLURM_SUCCESS;
 }
 
 extern int fini(void)
 {
+	slurm_mutex_lock(&pool_lock);
+	_pool_free(client_pool, &client_pool_cnt);
+	_pool_free(server_pool, &server_pool_cnt);
+	slurm_mutex_unlock(&pool_lock);
+
 	s2n_psk_free(&psk);
 	s2n_config_free(config);
 
@@ -253,11 +403,10 @@ extern void *tls_p_create_conn(int fd, tls_conn_mode_t tls_mode)
 
 	conn = xmalloc(sizeof(*conn));
 	conn->fd = fd;
+	conn->mode = s2n_conn_mode;
 	slurm_mutex_init(&conn->lock);
 
-	if (!(conn->s2n_conn = s2n_connection_new(s2n_conn_mode))) {
-		error("%s: s2n_connection_new: %s",
-		      __func__, s2n_strerror(s2n_errno, NULL));
+	if (!(conn->s2n_conn = _conn_get(s2n_conn_mode))) {
 		slurm_mutex_destroy(&conn->lock);
 		xfree(conn);
 		return NULL;
@@ -297,18 +446,19 @@ extern void *tls_p_create_conn(int fd, tls_conn_mode_t tls_mode)
 			goto fail;
 		}
 
-		if (wait_fd_readable(conn->fd, slurm_conf.msg_timeout) == -1) {
+		if (_wait_blocked(conn->fd, blocked) == -1) {
 			error("Problem reading socket, couldn't do s2n negotiation");
 			goto fail;
 		}
 	}
 
+	if (use_ktls)
+		_enable_ktls(conn);
+
 	return conn;
 
 fail:
-	if (s2n_connection_free(conn->s2n_conn) < 0)
-		error("%s: s2n_connection_free: %s",
-		      __func__, s2n_strerror(s2n_errno, NULL));
+	_conn_put(conn->s2n_conn, conn->mode, false);
 	slurm_mutex_destroy(&conn->lock);
 	xfree(conn);
 
@@ -347,16 +497,14 @@ extern void tls_p_destroy_conn(tls_conn_t *conn)
 			break;
 		}
 
-		if (wait_fd_readable(conn->fd, slurm_conf.msg_timeout) == -1) {
+		if (_wait_blocked(conn->fd, blocked) == -1) {
 			error("Problem reading socket, couldn't do graceful s2n shutdown");
 			break;
 		}
 	}
 
-	if (s2n_connection_free(conn->s2n_conn) < 0) {
-		error("%s: s2n_connection_free: %s",
-		      __func__, s2n_strerror(s2n_errno, NULL));
-	}
+	/* kTLS connections hold kernel state for the fd, do not reuse them */
+	_conn_put(conn->s2n_conn, conn->mode, !conn->ktls);
 
 	slurm_mutex_unlock(&conn->lock);
 	slurm_mutex_destroy(&conn->lock);
@@ -400,8 +548,11 @@ extern ssize_t tls_p_recv(tls_conn_t *conn, void *buf, size_t n)
 			/* connection closed */
 			break;
 		} else if (s2n_error_get_type(s2n_errno) == S2N_ERR_T_BLOCKED) {
-			/* busy wait until we get further data */
-			continue;
+			/* wait for further data instead of spinning on s2n_recv */
+			if (_wait_blocked(conn->fd, blocked) == -1) {
+				slurm_mutex_unlock(&conn->lock);
+				return SLURM_ERROR;
+			}
 		} else {
 			error("%s: s2n_recv: %s",
 			      __func__, s2n_strerror(s2n_errno, NULL));
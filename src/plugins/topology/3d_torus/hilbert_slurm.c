@@ -52,8 +52,7 @@
 extern void nodes_to_hilbert_curve(void)
 {
 	static bool first_run = true;
-	int coord_inx, i, j, k, max_coord = 0;
-	int *coords;
+	int i, j, k;
 	node_record_t *node_ptr;
 	coord_t hilbert[3];
 	int dims = 3;
@@ -66,54 +65,38 @@ extern void nodes_to_hilbert_curve(void)
 	 * index of each node name in the array. */
 	if (!first_run)
 		return;
+	first_run = false;
 
-	/* Get the coordinates for each node based upon its numeric suffix */
-	coords = xmalloc(sizeof(int) * node_record_count * dims);
-	for (i = 0, coord_inx = 0; (node_ptr = next_node(&i)); i++) {
+	/* Get the coordinates for each node based upon its numeric suffix
+	 * and generate its Hilbert integer in a single pass */
+	for (i = 0; (node_ptr = next_node(&i)); i++) {
 		j = strlen(node_ptr->name);
 		if (j < dims) {
 			fatal("hostname %s lacks numeric %d dimension suffix",
 			      node_ptr->name, dims);
 		}
-		for (k=dims; k; k--) {
-			coords[coord_inx] = select_char2coord(
-				node_ptr->name[j-k]);
-			if (coords[coord_inx] < 0) {
+		for (k = 0; k < dims; k++) {
+			int coord = select_char2coord(
+				node_ptr->name[j - dims + k]);
+			if (coord < 0) {
 				fatal("hostname %s lacks valid numeric suffix",
 				      node_ptr->name);
 			}
-			max_coord = MAX(max_coord, coords[coord_inx]);
-			coord_inx++;	/* Don't put into MAX macro */
+			if (coord > 31) {
+				fatal("maximum node coordinate exceeds system limit (%d>32)",
+				      coord);
+			}
+			hilbert[k] = coord;
 		}
-	}
-	if (max_coord > 31) {
-		fatal("maximum node coordinate exceeds system limit (%d>32)",
-		      max_coord);
-	}
-
-	/* Generate each node's Hilbert integer */
-	for (i = 0, coord_inx = 0; (node_ptr = next_node(&i)); i++) {
-		for (j=0; j<dims; j++)
-			hilbert[j] = coords[coord_inx++];
 		AxestoTranspose(hilbert, 5, dims);
 
-		/* A variation on the below calculation would be required here
-		 * for other dimension counts */
-		node_ptr->node_rank =
-			((hilbert[0]>>4 & 1) << 14) +
-			((hilbert[1]>>4 & 1) << 13) +
-			((hilbert[2]>>4 & 1) << 12) +
-			((hilbert[0]>>3 & 1) << 11) +
-			((hilbert[1]>>3 & 1) << 10) +
-			((hilbert[2]>>3 & 1) <<  9) +
-			((hilbert[0]>>2 & 1) <<  8) +
-			((hilbert[1]>>2 & 1) <<  7) +
-			((hilbert[2]>>2 & 1) <<  6) +
-			((hilbert[0]>>1 & 1) <<  5) +
-			((hilbert[1]>>1 & 1) <<  4) +
-			((hilbert[2]>>1 & 1) <<  3) +
-			((hilbert[0]>>0 & 1) <<  2) +
-			((hilbert[1]>>0 & 1) <<  1) +
-			((hilbert[2]>>0 & 1) <<  0);
+		/* Interleave the transposed bits, most significant first */
+		node_ptr->node_rank = 0;
+		for (k = 4; k >= 0; k--) {
+			for (j = 0; j < dims; j++) {
+				node_ptr->node_rank <<= 1;
+				node_ptr->node_rank |= (hilbert[j] >> k) & 1;
+			}
+		}
 	}
 }
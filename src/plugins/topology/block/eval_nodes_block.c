@@ -40,17 +40,36 @@
 #include "../common/eval_nodes.h"
 #include "../common/gres_sched.h"
 
-static int _cmp_bblock(const void *a, const void *b)
+/*
+ * Sum the node counts of the max_llblock most populated llblocks.
+ * Partially reorders llblock_cnt in place (largest counts first).
+ */
+static uint32_t _sum_top_llblock(uint32_t *llblock_cnt, int llblock_len,
+				 int max_llblock)
 {
-	int ca = *((int *) a);
-	int cb = *((int *) b);
+	uint32_t sum = 0;
 
-	if (ca < cb)
-		return 1;
-	else if (ca > cb)
-		return -1;
+	if (max_llblock >= llblock_len) {
+		for (int i = 0; i < llblock_len; i++)
+			sum += llblock_cnt[i];
+		return sum;
+	}
+
+	for (int i = 0; i < max_llblock; i++) {
+		int max_inx = i;
+		uint32_t tmp;
 
-	return 0;
+		for (int j = i + 1; j < llblock_len; j++) {
+			if (llblock_cnt[j] > llblock_cnt[max_inx])
+				max_inx = j;
+		}
+		tmp = llblock_cnt[i];
+		llblock_cnt[i] = llblock_cnt[max_inx];
+		llblock_cnt[max_inx] = tmp;
+		sum += llblock_cnt[i];
+	}
+
+	return sum;
 }
 
 static bool _bblocks_in_same_block(int block_inx1, int block_inx2,
@@ -448,23 +467,12 @@ next_segment:
 			int llblock_per_block = (bblock_per_block /
 						 bblock_per_llblock);
 			int offset = i * llblock_per_block;
-			int tmp_max_llblock;
 			llblock_per_block = MIN(llblock_per_block,
 						llblock_cnt - offset);
-			qsort(&nodes_on_llblock[offset], llblock_per_block,
-			      sizeof(int), _cmp_bblock);
-			tmp_max_llblock = MIN(max_llblock, llblock_per_block);
-			for (j = 0; j < tmp_max_llblock; j++)
-				avail_bnc += nodes_on_llblock[offset + j];
+			avail_bnc = _sum_top_llblock(&nodes_on_llblock[offset],
+						     llblock_per_block,
+						     max_llblock);
 		}
-		/*
-		 * Count total CPUs of the intersection of topo_eval->node_map
-		 * and block_node_bitmap.
-		 */
-		for (j = 0; (node_ptr = next_node_bitmap(block_node_bitmap[i],
-							 &j));
-		     j++)
-			block_cpus += avail_res_array[j]->avail_cpus;
 		if (req_nodes_bitmap &&
 		    bit_overlap_any(req_nodes_bitmap, block_node_bitmap[i])) {
 			if (block_inx == -1) {
@@ -473,9 +481,21 @@ next_segment:
 			}
 		}
 		if (!eval_nodes_enough_nodes(avail_bnc, rem_nodes, min_nodes,
-					     req_nodes) ||
-		    (rem_cpus > block_cpus))
+					     req_nodes))
 			continue;
+		/*
+		 * Count total CPUs of the intersection of topo_eval->node_map
+		 * and block_node_bitmap, only for blocks with enough nodes.
+		 */
+		if (rem_cpus > 0) {
+			for (j = 0;
+			     (node_ptr = next_node_bitmap(block_node_bitmap[i],
+							  &j));
+			     j++)
+				block_cpus += avail_res_array[j]->avail_cpus;
+			if (rem_cpus > block_cpus)
+				continue;
+		}
 		/*
 		 * Select the block:
 		 * 	1) with lowest weight nodes
@@ -82,13 +82,19 @@ static list_t *_build_node_weight_list(bitstr_t *node_bitmap)
 {
 	list_t *node_list;
 	node_record_t *node_ptr;
-	node_weight_type *nwt;
+	node_weight_type *nwt = NULL;
 
 	xassert(node_bitmap);
 	/* Build list of node_weight_type records, one per node weight */
 	node_list = list_create(_node_weight_free);
 	for (int i = 0; (node_ptr = next_node_bitmap(node_bitmap, &i)); i++) {
-		nwt = list_find_first(node_list, _node_weight_find, node_ptr);
+		/*
+		 * Nodes sharing a configuration are usually adjacent in the
+		 * node table, so try the previous node's weight first.
+		 */
+		if (!nwt || (nwt->weight != node_ptr->sched_weight))
+			nwt = list_find_first(node_list, _node_weight_find,
+					      node_ptr);
 		if (!nwt) {
 			nwt = xmalloc(sizeof(node_weight_type));
 			nwt->node_bitmap = bit_alloc(node_record_count);
@@ -763,6 +763,47 @@ static void _decrement_node_cnt(int num_nodes_taken, int switch_index,
 	}
 }
 
+/*
+ * Count the available CPUs on each switch's nodes in switch_node_bitmap.
+ * Switches are visited from the leaves up so that a switch whose children
+ * do not share any of those nodes can add up its children's counts instead
+ * of walking all of its nodes again.
+ */
+static void _set_switch_cpu_cnt(bitstr_t **switch_node_bitmap,
+				int *switch_node_cnt,
+				avail_res_t **avail_res_array,
+				uint32_t *switch_cpu_cnt)
+{
+	for (int level = 0; level <= switch_levels; level++) {
+		for (int i = 0; i < switch_record_cnt; i++) {
+			switch_record_t *switch_ptr = &switch_record_table[i];
+			int child_node_cnt = 0;
+			uint32_t child_cpu_cnt = 0;
+
+			if (switch_ptr->level != level)
+				continue;
+
+			for (int k = 0; k < switch_ptr->num_switches; k++) {
+				int child = switch_ptr->switch_index[k];
+
+				child_node_cnt += switch_node_cnt[child];
+				child_cpu_cnt += switch_cpu_cnt[child];
+			}
+			if (switch_ptr->num_switches &&
+			    (child_node_cnt == switch_node_cnt[i])) {
+				switch_cpu_cnt[i] = child_cpu_cnt;
+				continue;
+			}
+
+			switch_cpu_cnt[i] = 0;
+			for (int j = 0;
+			     next_node_bitmap(switch_node_bitmap[i], &j); j++)
+				switch_cpu_cnt[i] +=
+					avail_res_array[j]->avail_cpus;
+		}
+	}
+}
+
 /* Allocate resources to job using a minimal leaf switch count */
 static int _eval_nodes_topo(topology_eval_t *topo_eval)
 {
@@ -919,19 +960,19 @@ static int _eval_nodes_topo(topology_eval_t *topo_eval)
 
 	for (i = 0, switch_ptr = switch_record_table; i < switch_record_cnt;
 	     i++, switch_ptr++) {
-		uint32_t switch_cpus = 0;
 		switch_node_bitmap[i] = bit_copy(switch_ptr->node_bitmap);
 		bit_and(switch_node_bitmap[i], topo_eval->node_map);
 		switch_node_cnt[i] = bit_set_count(switch_node_bitmap[i]);
-		/*
-		 * Count total CPUs of the intersection of node_map and
-		 * switch_node_bitmap.
-		 */
-		for (j = 0; (node_ptr = next_node_bitmap(switch_node_bitmap[i],
-							 &j));
-		     j++)
-			switch_cpus += avail_res_array[j]->avail_cpus;
-		switch_cpu_cnt[i] = switch_cpus;
+	}
+	/*
+	 * Count total CPUs of the intersection of node_map and
+	 * switch_node_bitmap.
+	 */
+	_set_switch_cpu_cnt(switch_node_bitmap, switch_node_cnt,
+			    avail_res_array, switch_cpu_cnt);
+
+	for (i = 0, switch_ptr = switch_record_table; i < switch_record_cnt;
+	     i++, switch_ptr++) {
 		if (req_nodes_bitmap &&
 		    bit_overlap_any(req_nodes_bitmap, switch_node_bitmap[i])) {
 			switch_required[i] = 1;
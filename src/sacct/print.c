@@ -944,10 +944,10 @@ extern void print_fields(type_t type, void *object)
 			tmp_char = NULL;
 			switch(type) {
 			case JOB:
-				tmp_char = gid_to_string(job->gid);
+				tmp_char = gid_to_string_cached(job->gid);
 				break;
 			case JOBCOMP:
-				tmp_char = gid_to_string(job_comp->gid);
+				tmp_char = gid_to_string_cached(job_comp->gid);
 				break;
 			default:
 				break;
@@ -955,7 +955,6 @@ extern void print_fields(type_t type, void *object)
 			field->print_routine(field,
 					     tmp_char,
 					     (curr_inx == field_count));
-			xfree(tmp_char);
 			break;
 		case PRINT_JOBID:
 			if (type == JOBSTEP)
@@ -2113,16 +2112,13 @@ extern void print_fields(type_t type, void *object)
 					     (curr_inx == field_count));
 			break;
 		case PRINT_USER:
-		{
-			char *user = NULL;
 			switch(type) {
 			case JOB:
 				if (job->user)
 					tmp_char = job->user;
-				else {
-					user = uid_to_string(job->uid);
-					tmp_char = user;
-				}
+				else
+					tmp_char = uid_to_string_cached(
+						job->uid);
 				break;
 			case JOBCOMP:
 				tmp_char = job_comp->uid_name;
@@ -2134,9 +2130,7 @@ extern void print_fields(type_t type, void *object)
 			field->print_routine(field,
 					     tmp_char,
 					     (curr_inx == field_count));
-			xfree(user);
 			break;
-		}
 		case PRINT_USERCPU:
 			switch(type) {
 			case JOB:
@@ -691,7 +691,8 @@ static bool _opt_verify(void)
 
 	if ((opt.resv_port_cnt != NO_VAL) &&
 	    !(opt.job_flags & STEPMGR_ENABLED) &&
-	    !xstrstr(slurm_conf.slurmctld_params, "enable_stepmgr")) {
+	    !xstrstr(slurm_conf.slurmctld_params, "enable_stepmgr") &&
+	    !xstrstr(slurm_conf.slurmctld_params, "stepmgr_min_nodes=")) {
 		error("Slurmstepd step management must be enabled to use --resv-ports for job allocations");
 		verified = false;
 	}
@@ -52,6 +52,8 @@
 #define OPT_LONG_JSON 0x102
 #define OPT_LONG_YAML 0x103
 #define OPT_LONG_AUTOCOMP 0x104
+#define OPT_LONG_TRACE_RING 0x105
+#define OPT_LONG_HISTORY 0x106
 
 static void  _help( void );
 static void  _usage( void );
@@ -77,12 +79,14 @@ extern void parse_command_line(int argc, char **argv)
 		{"autocomplete", required_argument, 0, OPT_LONG_AUTOCOMP},
 		{"all",		no_argument,	0,	'a'},
 		{"help",	no_argument,	0,	'h'},
+		{"history",	no_argument,	0,	OPT_LONG_HISTORY},
 		{"reset",	no_argument,	0,	'r'},
 		{"sort-by-id",	no_argument,	0,	'i'},
 		{"cluster",     required_argument, 0,   'M'},
 		{"clusters",    required_argument, 0,   'M'},
 		{"sort-by-time",no_argument,	0,	't'},
 		{"sort-by-time2",no_argument,	0,	'T'},
+		{"trace-ring", optional_argument, 0, OPT_LONG_TRACE_RING},
 		{"usage",	no_argument,	0,	OPT_LONG_USAGE},
 		{"version",     no_argument,	0,	'V'},
 		{"json", optional_argument, 0, OPT_LONG_JSON},
@@ -150,6 +154,14 @@ extern void parse_command_line(int argc, char **argv)
 						      NULL))
 					fatal("YAML plugin load failure");
 				break;
+			case OPT_LONG_HISTORY:
+				params.mode = STAT_COMMAND_HISTORY;
+				break;
+			case OPT_LONG_TRACE_RING:
+				params.trace_ring = true;
+				xfree(params.trace_ring_file);
+				params.trace_ring_file = xstrdup(optarg);
+				break;
 			case OPT_LONG_AUTOCOMP:
 				suggest_completion(long_options, optarg);
 				exit(0);
@@ -193,6 +205,8 @@ Usage: sdiag [OPTIONS]\n\
   -t, --sort-by-time  sort RPCs by total run time\n\
   -T, --sort-by-time2 sort RPCs by average run time\n\
   -V, --version       display current version number\n\
+  --history           also print per minute statistics of the last day\n\
+  --trace-ring[=file] print the slurmctld trace ring, run on the controller\n\
   --json[=data_parser] Produce JSON output\n\
   --yaml[=data_parser] Produce YAML output\n\
 \nHelp options:\n\
@@ -41,9 +41,12 @@
 
 #include <slurm/slurm.h>
 #include "src/common/macros.h"
+#include "src/common/parse_time.h"
 #include "src/common/read_config.h"
 #include "src/common/slurm_protocol_defs.h"
 #include "src/common/slurm_time.h"
+#include "src/common/timers.h"
+#include "src/common/trace_ring.h"
 #include "src/common/uid.h"
 #include "src/common/xmalloc.h"
 #include "src/common/xstring.h"
@@ -69,6 +72,8 @@ typedef struct {
 	uint64_t dropped;
 	uint16_t cycle_last;
 	uint16_t cycle_max;
+	uint32_t *time_hist;
+	uint32_t *wait_hist;
 } rpc_stat_t;
 
 static rpc_stat_t *types = NULL, *users = NULL;
@@ -77,6 +82,10 @@ struct sdiag_parameters params = {0};
 
 stats_info_response_msg_t *buf;
 
+static void _print_lock_stats(void);
+static void _print_rpc_latency(void);
+static void _print_sched_phase_stats(void);
+static void _print_stats_history(void);
 static int  _print_stats(void);
 static void _sort_rpc(void);
 
@@ -91,6 +100,24 @@ int main(int argc, char **argv)
 	slurm_init(NULL);
 	parse_command_line(argc, argv);
 
+	if (params.trace_ring) {
+		char *path = params.trace_ring_file;
+		char host[HOST_NAME_MAX];
+
+		if (!path) {
+			if (gethostname_short(host, sizeof(host)))
+				fatal("gethostname_short: %m");
+			xstrfmtcat(path, "%s/trace_ring.%s",
+				   slurm_conf.state_save_location, host);
+		}
+		if ((rc = trace_ring_print(path)))
+			error("Unable to read trace ring %s: %s",
+			      path, slurm_strerror(rc));
+		if (path != params.trace_ring_file)
+			xfree(path);
+		exit(rc);
+	}
+
 	if (params.mode == STAT_COMMAND_RESET) {
 		req.command_id = STAT_COMMAND_RESET;
 		rc = slurm_reset_statistics((stats_info_request_msg_t *)&req);
@@ -99,7 +126,7 @@ int main(int argc, char **argv)
 		else
 			slurm_perror("slurm_reset_statistics");
 	} else {
-		req.command_id = STAT_COMMAND_GET;
+		req.command_id = params.mode;
 		rc = slurm_get_statistics(&buf, &req);
 		if (rc == SLURM_SUCCESS) {
 			_sort_rpc();
@@ -250,6 +277,8 @@ static int _print_stats(void)
 			       types[i].dropped);
 	}
 
+	_print_rpc_latency();
+
 	printf("\nRemote Procedure Call statistics by user\n");
 	for (i = 0; i < buf->rpc_user_size; i++) {
 		char *user = uid_to_string(users[i].id);
@@ -282,9 +311,177 @@ static int _print_stats(void)
 		       buf->rpc_dump_hostlist[i]);
 	}
 
+	_print_lock_stats();
+	_print_sched_phase_stats();
+	_print_stats_history();
+
+	return 0;
+}
+
+/* highest to lowest total wait time */
+static int _sort_lock_wait(const void *p1, const void *p2)
+{
+	uint64_t w1 = buf->lock_stats_wait_time[*(const int *) p1];
+	uint64_t w2 = buf->lock_stats_wait_time[*(const int *) p2];
+
+	if (w1 < w2)
+		return 1;
+	else if (w1 > w2)
+		return -1;
 	return 0;
 }
 
+static void _print_hist(const char *label, uint32_t *hist, uint32_t hist_cnt)
+{
+	static const char *bucket_names[] = {
+		"<10us", "<100us", "<1ms", "<10ms", "<100ms", "<1s", ">=1s"
+	};
+
+	printf("\t\t%s", label);
+	for (int i = 0; i < hist_cnt; i++) {
+		if (i < ARRAY_SIZE(bucket_names))
+			printf(" %s:%u", bucket_names[i], hist[i]);
+		else
+			printf(" %d:%u", i, hist[i]);
+	}
+	printf("\n");
+}
+
+static void _print_lock_stat(int inx, int width)
+{
+	uint64_t count = buf->lock_stats_count[inx];
+
+	printf("\t%-*s count:%-8"PRIu64" ave_wait:%-6"PRIu64" max_wait:%-8"PRIu64" ave_hold:%-6"PRIu64" max_hold:%"PRIu64"\n",
+	       width, buf->lock_stats_name[inx], count,
+	       (count ? (buf->lock_stats_wait_time[inx] / count) : 0),
+	       buf->lock_stats_wait_max[inx],
+	       (count ? (buf->lock_stats_hold_time[inx] / count) : 0),
+	       buf->lock_stats_hold_max[inx]);
+}
+
+static void _print_lock_stats(void)
+{
+	int caller_cnt, *callers;
+
+	if (!buf->lock_stats_cnt)
+		return;
+
+	printf("\nLock statistics by type (microseconds)\n");
+	for (int i = 0; i < buf->lock_stats_type_cnt; i++) {
+		uint32_t off = i * buf->lock_stats_hist_cnt;
+
+		_print_lock_stat(i, 12);
+		if (!buf->lock_stats_count[i])
+			continue;
+		_print_hist("wait", &buf->lock_stats_wait_hist[off],
+			    buf->lock_stats_hist_cnt);
+		_print_hist("hold", &buf->lock_stats_hold_hist[off],
+			    buf->lock_stats_hist_cnt);
+	}
+
+	caller_cnt = buf->lock_stats_cnt - buf->lock_stats_type_cnt;
+	if (caller_cnt <= 0)
+		return;
+
+	callers = xcalloc(caller_cnt, sizeof(*callers));
+	for (int i = 0; i < caller_cnt; i++)
+		callers[i] = buf->lock_stats_type_cnt + i;
+	qsort(callers, caller_cnt, sizeof(*callers), _sort_lock_wait);
+
+	printf("\nLock statistics by caller (microseconds)\n");
+	for (int i = 0; i < caller_cnt; i++)
+		_print_lock_stat(callers[i], 40);
+	xfree(callers);
+}
+
+static void _print_percentiles(const char *label, uint32_t *hist)
+{
+	static const double percentiles[] = { 50, 99, 99.9 };
+	static const char *names[] = { "p50", "p99", "p999" };
+
+	printf(" %s", label);
+	for (int i = 0; i < ARRAY_SIZE(percentiles); i++) {
+		uint64_t usec = latency_hist_percentile(hist,
+							buf->rpc_type_hist_cnt,
+							percentiles[i]);
+
+		if (usec == NO_VAL64)
+			printf(" %s:%-8s", names[i], "N/A");
+		else
+			printf(" %s:%-8"PRIu64, names[i], usec);
+	}
+}
+
+static void _print_rpc_latency(void)
+{
+	if (!buf->rpc_type_hist_cnt || !buf->rpc_type_size)
+		return;
+
+	printf("\nRemote Procedure Call latency percentiles by message type (microseconds)\n");
+	for (int i = 0; i < buf->rpc_type_size; i++) {
+		printf("\t%-40s(%5u)", rpc_num2string(types[i].id),
+		       types[i].id);
+		_print_percentiles("time", types[i].time_hist);
+		_print_percentiles(" wait", types[i].wait_hist);
+		printf("\n");
+	}
+}
+
+static void _print_sched_phase_stats(void)
+{
+	if (!buf->sched_phase_cnt)
+		return;
+
+	printf("\nScheduler phase statistics (microseconds)\n");
+	for (int i = 0; i < buf->sched_phase_cnt; i++) {
+		uint64_t count = buf->sched_phase_count[i];
+		uint32_t off = i * buf->sched_phase_hist_cnt;
+
+		printf("\t%-24s count:%-8"PRIu64" total:%-10"PRIu64" ave:%-8"PRIu64" max:%"PRIu64"\n",
+		       buf->sched_phase_name[i], count,
+		       buf->sched_phase_time[i],
+		       (count ? (buf->sched_phase_time[i] / count) : 0),
+		       buf->sched_phase_max[i]);
+		if (!count)
+			continue;
+		_print_hist("time", &buf->sched_phase_hist[off],
+			    buf->sched_phase_hist_cnt);
+	}
+}
+
+static void _print_stats_history(void)
+{
+	if (!buf->history_cnt)
+		return;
+
+	printf("\nStatistics history (%u second samples, microseconds)\n",
+	       buf->history_interval);
+	printf("%-19s %6s %9s %6s %6s %6s %9s %6s %6s %6s %6s %7s %7s %8s %8s %7s\n",
+	       "Time", "Cycles", "MeanCycle", "Depth", "Queue", "BfCyc",
+	       "BfMean", "Backf", "Submit", "Start", "Done", "Pending",
+	       "Running", "RPCs", "RPCMean", "Threads");
+	for (int i = 0; i < buf->history_cnt; i++) {
+		stats_history_t *h = &buf->history[i];
+		char time_str[32];
+
+		slurm_make_time_str(&h->sample_time, time_str,
+				    sizeof(time_str));
+		printf("%-19s %6u %9"PRIu64" %6u %6u %6u %9"PRIu64" %6u %6u %6u %6u %7u %7u %8"PRIu64" %8"PRIu64" %7u\n",
+		       time_str, h->schedule_cycles,
+		       (h->schedule_cycles ?
+			(h->schedule_cycle_sum / h->schedule_cycles) : 0),
+		       (h->schedule_cycles ?
+			(h->schedule_depth_sum / h->schedule_cycles) : 0),
+		       h->schedule_queue_len, h->bf_cycles,
+		       (h->bf_cycles ? (h->bf_cycle_sum / h->bf_cycles) : 0),
+		       h->bf_backfilled_jobs, h->jobs_submitted,
+		       h->jobs_started, h->jobs_completed, h->jobs_pending,
+		       h->jobs_running, h->rpc_count,
+		       (h->rpc_count ? (h->rpc_time / h->rpc_count) : 0),
+		       h->server_thread_count);
+	}
+}
+
 /* lowest to highest */
 static int _sort_id(const void *p1, const void *p2)
 {
@@ -351,6 +548,12 @@ static void _sort_rpc(void)
 			types[i].cycle_last = buf->rpc_type_cycle_last[i];
 			types[i].cycle_max = buf->rpc_type_cycle_max[i];
 		}
+		if (buf->rpc_type_hist_cnt) {
+			uint32_t off = i * buf->rpc_type_hist_cnt;
+
+			types[i].time_hist = &buf->rpc_type_time_hist[off];
+			types[i].wait_hist = &buf->rpc_type_wait_hist[off];
+		}
 	}
 
 	users = xcalloc(buf->rpc_user_size, sizeof(rpc_stat_t));
@@ -45,6 +45,8 @@ struct sdiag_parameters {
 	char *cluster_names;
 	char *mimetype; /* --yaml or --json */
 	char *data_parser; /* data_parser args */
+	bool trace_ring;
+	char *trace_ring_file;
 };
 
 typedef enum {
@@ -90,7 +90,8 @@ static int _get_info(bool clear_old, slurmdb_federation_rec_t *fed,
 		     char *cluster_name, int argc, char **argv);
 static int _insert_node_ptr(list_t *sinfo_list, uint16_t part_num,
 			    partition_info_t *part_ptr,
-			    node_info_t *node_ptr);
+			    node_info_t *node_ptr,
+			    sinfo_data_t **last_sinfo);
 static int  _load_resv(reserve_info_msg_t ** reserv_pptr, bool clear_old);
 static bool _match_node_data(sinfo_data_t *sinfo_ptr, node_info_t *node_ptr);
 static bool _match_part_data(sinfo_data_t *sinfo_ptr,
@@ -518,6 +519,7 @@ void *_build_part_info(void *args)
 	partition_info_t *part_ptr;
 	node_info_msg_t *node_msg;
 	node_info_t *node_ptr = NULL;
+	sinfo_data_t *last_sinfo = NULL;
 	uint16_t part_num;
 	int j = 0;
 
@@ -542,7 +544,7 @@ void *_build_part_info(void *args)
 				continue;
 
 			_insert_node_ptr(sinfo_list, part_num,
-					 part_ptr, node_ptr);
+					 part_ptr, node_ptr, &last_sinfo);
 		}
 		j += 2;
 	}
@@ -625,7 +627,7 @@ static int _build_sinfo_data(list_t *sinfo_list,
 			if (pos < 0)
 				continue;
 			_insert_node_ptr(sinfo_list, (uint16_t) j,
-					 part_ptr, node_ptr);
+					 part_ptr, node_ptr, NULL);
 			continue;
 		}
 
@@ -1119,14 +1121,28 @@ static void _update_sinfo(sinfo_data_t *sinfo_ptr, node_info_t *node_ptr)
 		sinfo_ptr->cpus_idle += total_cpus;
 }
 
+/*
+ * last_sinfo IN/OUT - if not NULL, the record the previous node of this
+ *	partition was added to. It is tried first since adjacent nodes
+ *	usually share the same configuration and state.
+ */
 static int _insert_node_ptr(list_t *sinfo_list, uint16_t part_num,
 			    partition_info_t *part_ptr,
-			    node_info_t *node_ptr)
+			    node_info_t *node_ptr,
+			    sinfo_data_t **last_sinfo)
 {
 	int rc = SLURM_SUCCESS;
 	sinfo_data_t *sinfo_ptr = NULL;
 	list_itr_t *itr = NULL;
 
+	if (last_sinfo && (sinfo_ptr = *last_sinfo) &&
+	    _match_part_data(sinfo_ptr, part_ptr) &&
+	    (!sinfo_ptr->nodes_total ||
+	     _match_node_data(sinfo_ptr, node_ptr))) {
+		_update_sinfo(sinfo_ptr, node_ptr);
+		return rc;
+	}
+
 	itr = list_iterator_create(sinfo_list);
 	while ((sinfo_ptr = list_next(itr))) {
 		if (!_match_part_data(sinfo_ptr, part_ptr))
@@ -1141,9 +1157,11 @@ static int _insert_node_ptr(list_t *sinfo_list, uint16_t part_num,
 
 	/* if no match, create new sinfo_data entry */
 	if (!sinfo_ptr) {
-		list_append(sinfo_list,
-			    _create_sinfo(part_ptr, part_num, node_ptr));
+		sinfo_ptr = _create_sinfo(part_ptr, part_num, node_ptr);
+		list_append(sinfo_list, sinfo_ptr);
 	}
+	if (last_sinfo)
+		*last_sinfo = sinfo_ptr;
 
 	return rc;
 }
@@ -3653,8 +3653,8 @@ extern bool acct_policy_validate_het_job(list_t *submit_job_list)
  *	association limits prevent the job from ever running (lowered
  *	limits since job submission), then cancel the job.
  */
-extern bool acct_policy_job_runnable_pre_select(job_record_t *job_ptr,
-						bool assoc_mgr_locked)
+static bool _job_runnable_pre_select(job_record_t *job_ptr,
+				     bool assoc_mgr_locked)
 {
 	slurmdb_qos_rec_t *qos_ptr_1, *qos_ptr_2;
 	slurmdb_qos_rec_t qos_rec;
@@ -3879,13 +3879,56 @@ end_it:
 	return rc;
 }
 
+extern bool acct_policy_job_runnable_pre_select(job_record_t *job_ptr,
+						bool assoc_mgr_locked)
+{
+	bool rc;
+	DEF_PHASE_TIMER(pre_select);
+
+	START_PHASE_TIMER(pre_select);
+	rc = _job_runnable_pre_select(job_ptr, assoc_mgr_locked);
+	END_PHASE_TIMER(pre_select,
+			&sched_phase_stats[SCHED_PHASE_ACCT_PRE_SELECT]);
+
+	return rc;
+}
+/* Return true if no position of a TRES limit array has a limit set */
+static bool _tres_limits_unset(uint64_t *tres_limit_array)
+{
+	for (int i = 0; i < g_tres_count; i++)
+		if (tres_limit_array[i] != INFINITE64)
+			return false;
+	return true;
+}
+
+/*
+ * Return true if the association has none of the TRES limits checked after
+ * selection. Parents are only checked for their Grp limits since the Max
+ * limits were pre-propagated to the child.
+ */
+static bool _assoc_post_select_unlimited(slurmdb_assoc_rec_t *assoc_ptr,
+					 bool parent)
+{
+	if (!_tres_limits_unset(assoc_ptr->grp_tres_ctld) ||
+	    !_tres_limits_unset(assoc_ptr->grp_tres_mins_ctld) ||
+	    !_tres_limits_unset(assoc_ptr->grp_tres_run_mins_ctld))
+		return false;
+
+	if (parent)
+		return true;
+
+	return (_tres_limits_unset(assoc_ptr->max_tres_ctld) &&
+		_tres_limits_unset(assoc_ptr->max_tres_mins_ctld) &&
+		_tres_limits_unset(assoc_ptr->max_tres_pn_ctld));
+}
+
 /*
  * acct_policy_job_runnable_post_select - After nodes have been
  *	selected for the job verify the counts don't exceed aggregated limits.
  */
-extern bool acct_policy_job_runnable_post_select(job_record_t *job_ptr,
-						 uint64_t *tres_req_cnt,
-						 bool assoc_mgr_locked)
+static bool _job_runnable_post_select(job_record_t *job_ptr,
+				      uint64_t *tres_req_cnt,
+				      bool assoc_mgr_locked)
 {
 	slurmdb_qos_rec_t *qos_ptr_1, *qos_ptr_2;
 	slurmdb_qos_rec_t qos_rec;
@@ -3993,6 +4036,17 @@ extern bool acct_policy_job_runnable_post_select(job_record_t *job_ptr,
 
 	assoc_ptr = job_ptr->assoc_ptr;
 	while (assoc_ptr) {
+		/*
+		 * Most associations in a chain carry no TRES limits of their
+		 * own. Every check below would pass for them, so skip
+		 * building the per-TRES usage arrays.
+		 */
+		if (_assoc_post_select_unlimited(assoc_ptr, parent)) {
+			assoc_ptr = assoc_ptr->usage->parent_assoc_ptr;
+			parent = 1;
+			continue;
+		}
+
 		for (i = 0; i < slurmctld_tres_cnt; i++) {
 			tres_usage_mins[i] =
 				(uint64_t)(assoc_ptr->usage->usage_tres_raw[i]
@@ -4265,6 +4319,20 @@ end_it:
 	return rc;
 }
 
+extern bool acct_policy_job_runnable_post_select(job_record_t *job_ptr,
+						 uint64_t *tres_req_cnt,
+						 bool assoc_mgr_locked)
+{
+	bool rc;
+	DEF_PHASE_TIMER(post_select);
+
+	START_PHASE_TIMER(post_select);
+	rc = _job_runnable_post_select(job_ptr, tres_req_cnt, assoc_mgr_locked);
+	END_PHASE_TIMER(post_select,
+			&sched_phase_stats[SCHED_PHASE_ACCT_POST_SELECT]);
+
+	return rc;
+}
 extern uint32_t acct_policy_get_max_nodes(job_record_t *job_ptr,
 					  uint32_t *wait_reason)
 {
@@ -84,10 +84,13 @@
 #include "src/common/list.h"
 #include "src/common/log.h"
 #include "src/common/macros.h"
+#include "src/common/metrics.h"
+#include "src/common/probes.h"
 #include "src/common/parse_time.h"
 #include "src/common/run_command.h"
 #include "src/common/slurm_protocol_api.h"
 #include "src/common/slurm_protocol_socket.h"
+#include "src/common/trace_ring.h"
 #include "src/common/uid.h"
 #include "src/common/xassert.h"
 #include "src/common/xmalloc.h"
@@ -461,8 +464,6 @@ static agent_info_t *_make_agent_info(agent_arg_t *agent_arg_ptr)
 	agent_info_ptr->thread_count   = agent_arg_ptr->node_count;
 	agent_info_ptr->retry          = agent_arg_ptr->retry;
 	agent_info_ptr->threads_active = 0;
-	thread_ptr = xcalloc(agent_info_ptr->thread_count, sizeof(thd_t));
-	agent_info_ptr->thread_struct  = thread_ptr;
 	agent_info_ptr->r_uid = agent_arg_ptr->r_uid;
 	agent_info_ptr->msg_type       = agent_arg_ptr->msg_type;
 	agent_info_ptr->msg_args_pptr  = &agent_arg_ptr->msg_args;
@@ -503,6 +504,18 @@ static agent_info_t *_make_agent_info(agent_arg_t *agent_arg_ptr)
 		 * Send the message directly to each node. */
 		split = true;
 	}
+
+	/*
+	 * A forwarded message needs a single thread no matter how many nodes
+	 * it targets, so avoid allocating a record for every node.
+	 */
+	if (agent_arg_ptr->addr || !split)
+		thread_ptr = xcalloc(1, sizeof(thd_t));
+	else
+		thread_ptr = xcalloc(agent_info_ptr->thread_count,
+				     sizeof(thd_t));
+	agent_info_ptr->thread_struct = thread_ptr;
+
 	if (agent_arg_ptr->addr || !split) {
 		thread_ptr[0].state = DSH_NEW;
 		if (agent_arg_ptr->addr) {
@@ -1009,6 +1022,16 @@ static void *_thread_per_group_rpc(void *args)
 	slurm_msg_set_r_uid(&msg, task_ptr->r_uid);
 	msg.flags |= task_ptr->msg_flags;
 
+	/* Reuse connections to slurmd for periodic RPCs, if configured */
+	if (forward_keep_alive_type(msg_type) &&
+	    xstrcasestr(slurm_conf.slurmctld_params, "agent_keep_alive"))
+		msg.flags |= SLURM_MSG_KEEP_ALIVE;
+
+	trace_ring_record(TRACE_EVENT_AGENT_SEND, msg_type,
+			  (thread_ptr->nodelist ?
+			   hostlist_count(thread_ptr->nodelist) : 1), 0);
+	SLURM_PROBE2(agent__send, msg_type, thread_ptr->nodename);
+
 	if (thread_ptr->nodename)
 		log_flag(AGENT, "%s: sending %s to %s", __func__,
 			 rpc_num2string(msg_type), thread_ptr->nodename);
@@ -1090,6 +1113,8 @@ static void *_thread_per_group_rpc(void *args)
 	while ((ret_data_info = list_next(itr))) {
 		rc = slurm_get_return_code(ret_data_info->type,
 					   ret_data_info->data);
+		SLURM_PROBE3(agent__recv, msg_type, ret_data_info->node_name,
+			     rc);
 		/* SPECIAL CASE: Record node's CPU load */
 		if (ret_data_info->type == RESPONSE_PING_SLURMD) {
 			ping_slurmd_resp_msg_t *ping_resp;
@@ -2478,6 +2503,18 @@ extern int retry_list_size(void)
 	return list_count(retry_list);
 }
 
+extern void agent_register_metrics(void)
+{
+	metric_register_src("agents", NULL, METRIC_GAUGE,
+			    "Active agents", &agent_cnt, sizeof(agent_cnt));
+	metric_register_src("agent_threads", NULL, METRIC_GAUGE,
+			    "Threads used by active agents",
+			    &agent_thread_cnt, sizeof(agent_thread_cnt));
+	metric_register_src("mail_threads", NULL, METRIC_GAUGE,
+			    "Active mail threads", &mail_thread_cnt,
+			    sizeof(mail_thread_cnt));
+}
+
 static void _reboot_from_ctld(agent_arg_t *agent_arg_ptr)
 {
 	char *argv[4], *pname;
@@ -103,4 +103,7 @@ extern void mail_job_info(job_record_t *job_ptr, uint16_t mail_type);
 /* Return length of agent's retry_list */
 extern int retry_list_size(void);
 
+/* Export agent thread counts through the metrics registry */
+extern void agent_register_metrics(void);
+
 #endif /* !_AGENT_H */
@@ -70,6 +70,7 @@
 #include "src/slurmctld/proc_req.h"
 #include "src/slurmctld/read_config.h"
 #include "src/slurmctld/slurmctld.h"
+#include "src/slurmctld/state_save.h"
 #include "src/slurmctld/trigger_mgr.h"
 
 #define _DEBUG		0
@@ -172,9 +173,11 @@ void run_backup(void)
 			continue;
 
 		last_ping = time(NULL);
-		if (ping_controllers(false) == SLURM_SUCCESS)
+		if (ping_controllers(false) == SLURM_SUCCESS) {
 			last_controller_response = time(NULL);
-		else if (takeover) {
+			/* Keep the state files warm for a takeover */
+			state_file_prefetch();
+		} else if (takeover) {
 			/*
 			 * in takeover mode, take control as soon as
 			 * primary no longer respond
@@ -255,6 +258,7 @@ void run_backup(void)
 			verbose("Unable to remove pidfile '%s': %m",
 			        slurm_conf.slurmctld_pidfile);
 
+		state_file_prefetch_fini();
 		info("BackupController terminating");
 		log_fini();
 		if (dump_core)
@@ -326,6 +330,7 @@ void run_backup(void)
 		error("Unable to recover slurm state");
 		abort();
 	}
+	state_file_prefetch_fini();
 	configless_update();
 	if (conf_includes_list) {
 		/*
@@ -68,6 +68,7 @@
 #include "src/common/hostlist.h"
 #include "src/common/log.h"
 #include "src/common/macros.h"
+#include "src/common/metrics.h"
 #include "src/common/pack.h"
 #include "src/common/port_mgr.h"
 #include "src/common/proc_args.h"
@@ -78,6 +79,7 @@
 #include "src/common/slurm_protocol_socket.h"
 #include "src/common/slurm_rlimits_info.h"
 #include "src/common/timers.h"
+#include "src/common/trace_ring.h"
 #include "src/common/track_script.h"
 #include "src/common/uid.h"
 #include "src/common/util-net.h"
@@ -125,11 +127,13 @@
 #include "src/slurmctld/rate_limit.h"
 #include "src/slurmctld/read_config.h"
 #include "src/slurmctld/reservation.h"
+#include "src/slurmctld/rpc_coalesce.h"
 #include "src/slurmctld/rpc_queue.h"
 #include "src/slurmctld/sackd_mgr.h"
 #include "src/slurmctld/slurmctld.h"
 #include "src/slurmctld/slurmscriptd.h"
 #include "src/slurmctld/state_save.h"
+#include "src/slurmctld/state_snapshot.h"
 #include "src/slurmctld/trigger_mgr.h"
 
 #include "src/stepmgr/srun_comm.h"
@@ -144,6 +148,7 @@ decl_static_data(usage_txt);
 #define SHUTDOWN_WAIT     2	/* Time to wait for backup server shutdown */
 #define JOB_COUNT_INTERVAL 30   /* Time to update running job count */
 
+#define DEFAULT_TRACE_RING_SIZE 65536 /* 2MB of trace records */
 #define DEV_TTY_PATH "/dev/tty"
 #define DEV_NULL_PATH "/dev/null"
 
@@ -270,6 +275,7 @@ static void _flush_rpcs(void);
 static void         _get_fed_updates();
 static void         _init_config(void);
 static void         _init_pidfile(void);
+static void _init_trace_ring(void);
 static int          _init_tres(void);
 static void         _kill_old_slurmctld(void);
 static void _open_ports(void);
@@ -407,6 +413,65 @@ static void _on_sigabrt(conmgr_callback_args_t conmgr_args, void *arg)
 	dump_core = true;
 }
 
+/*
+ * Export the sdiag counters through the metrics registry. They are read
+ * without any locks, see src/common/metrics.h.
+ */
+static void _register_metrics(void)
+{
+#define _REG(name, type, help, field) \
+	metric_register_src(name, NULL, type, help, \
+			    &slurmctld_diag_stats.field, \
+			    sizeof(slurmctld_diag_stats.field))
+
+	metric_register_src("server_threads", NULL, METRIC_GAUGE,
+			    "Active RPC processing threads",
+			    &slurmctld_config.server_thread_count,
+			    sizeof(slurmctld_config.server_thread_count));
+
+	_REG("schedule_cycles", METRIC_COUNTER,
+	     "Main scheduler cycles run", schedule_cycle_counter);
+	_REG("schedule_cycle_last_usec", METRIC_GAUGE,
+	     "Duration of the last main scheduler cycle",
+	     schedule_cycle_last);
+	_REG("schedule_cycle_max_usec", METRIC_GAUGE,
+	     "Longest main scheduler cycle", schedule_cycle_max);
+	_REG("schedule_queue_len", METRIC_GAUGE,
+	     "Jobs queued in the last main scheduler cycle",
+	     schedule_queue_len);
+
+	_REG("backfill_active", METRIC_GAUGE,
+	     "Whether a backfill cycle is running", bf_active);
+	_REG("backfill_cycles", METRIC_COUNTER,
+	     "Backfill scheduler cycles run", bf_cycle_counter);
+	_REG("backfill_cycle_last_usec", METRIC_GAUGE,
+	     "Duration of the last backfill cycle", bf_cycle_last);
+	_REG("backfill_cycle_max_usec", METRIC_GAUGE,
+	     "Longest backfill cycle", bf_cycle_max);
+	_REG("backfill_queue_len", METRIC_GAUGE,
+	     "Jobs queued in the last backfill cycle", bf_queue_len);
+	_REG("backfilled_jobs", METRIC_COUNTER,
+	     "Jobs started by the backfill scheduler", backfilled_jobs);
+
+	_REG("jobs_submitted", METRIC_COUNTER, "Jobs submitted",
+	     jobs_submitted);
+	_REG("jobs_started", METRIC_COUNTER, "Jobs started", jobs_started);
+	_REG("jobs_completed", METRIC_COUNTER, "Jobs completed",
+	     jobs_completed);
+	_REG("jobs_canceled", METRIC_COUNTER, "Jobs canceled",
+	     jobs_canceled);
+	_REG("jobs_failed", METRIC_COUNTER, "Jobs failed", jobs_failed);
+	_REG("jobs_pending", METRIC_GAUGE,
+	     "Pending jobs as of the last job state count", jobs_pending);
+	_REG("jobs_running", METRIC_GAUGE,
+	     "Running jobs as of the last job state count", jobs_running);
+#undef _REG
+
+	agent_register_metrics();
+	lock_register_metrics();
+	rpc_queue_register_metrics();
+}
+
 static void _register_signal_handlers(conmgr_callback_args_t conmgr_args,
 				      void *arg)
 {
@@ -599,6 +664,13 @@ int main(int argc, char **argv)
 
 	rate_limit_init();
 	rpc_queue_init();
+	rpc_coalesce_init();
+	state_snapshot_init();
+
+	_register_metrics();
+	if (slurm_conf.slurmctld_params)
+		(void) conmgr_metrics_listen(slurm_conf.slurmctld_params,
+					     "slurmctld");
 
 	/* open ports must happen after become_slurm_user() */
 	 _open_ports();
@@ -673,6 +745,7 @@ int main(int argc, char **argv)
 	if ((error_code = gethostname(slurmctld_config.node_name_long,
 				      HOST_NAME_MAX)))
 		fatal("getnodename error %s", slurm_strerror(error_code));
+	_init_trace_ring();
 
 	/* init job credential stuff */
 	if (cred_g_init() != SLURM_SUCCESS)
@@ -1037,6 +1110,7 @@ int main(int argc, char **argv)
 	/* purge remaining data structures */
 	group_cache_purge();
 	getnameinfo_cache_purge();
+	getaddrinfo_cache_purge();
 	license_free();
 	FREE_NULL_LIST(slurmctld_config.acct_update_list);
 	cred_g_fini();
@@ -1055,6 +1129,9 @@ int main(int argc, char **argv)
 
 	rate_limit_shutdown();
 	rpc_queue_shutdown();
+	rpc_coalesce_shutdown();
+	state_snapshot_fini();
+	trace_ring_fini();
 	log_fini();
 	sched_log_fini();
 
@@ -1187,16 +1264,10 @@ static void  _init_config(void)
 static int _try_to_reconfig(void)
 {
 	extern char **environ;
-	struct rlimit rlim;
 	char **child_env;
 	pid_t pid;
 	int to_parent[2] = {-1, -1};
 
-	if (getrlimit(RLIMIT_NOFILE, &rlim) < 0) {
-		error("getrlimit(RLIMIT_NOFILE): %m");
-		rlim.rlim_cur = 4096;
-	}
-
 	child_env = env_array_copy((const char **) environ);
 	setenvf(&child_env, "SLURMCTLD_RECONF", "1");
 	if (pidfd != -1) {
@@ -1273,27 +1344,21 @@ rwfail:
 	}
 
 start_child:
-	for (int fd = 3; fd < rlim.rlim_cur; fd++) {
-		bool match = false;
-		if (fd == to_parent[1])
-			continue;
-		if (fd == pidfd)
-			continue;
-		slurm_mutex_lock(&listeners.mutex);
-		for (int i = 0; i < listeners.count; i++) {
-			if (fd == listeners.fd[i]) {
-				match = true;
-				break;
-			}
-		}
-		slurm_mutex_unlock(&listeners.mutex);
-		if (!match) {
-			struct stat st;
-
-			if (!fstat(fd, &st))
-				fd_set_close_on_exec(fd);
-		}
-	}
+	/*
+	 * Only the listening sockets, pidfd and the pipe to the parent are
+	 * inherited. Mark everything else at once and then clear the flag on
+	 * those instead of probing every possible descriptor up to
+	 * RLIMIT_NOFILE.
+	 */
+	closeall_on_exec(3);
+	if (to_parent[1] != -1)
+		fd_set_noclose_on_exec(to_parent[1]);
+	if (pidfd != -1)
+		fd_set_noclose_on_exec(pidfd);
+	slurm_mutex_lock(&listeners.mutex);
+	for (int i = 0; i < listeners.count; i++)
+		fd_set_noclose_on_exec(listeners.fd[i]);
+	slurm_mutex_unlock(&listeners.mutex);
 
 	/*
 	 * This second fork() ensures that the new grandchild's parent is init,
@@ -1447,6 +1512,8 @@ static int _on_primary_msg(conmgr_fd_t *con, slurm_msg_t *msg, void *arg)
 {
 	int rc = SLURM_SUCCESS;
 
+	msg->recv_time = timespec_now();
+
 	if (!msg->auth_ids_set)
 		return ESLURM_AUTH_CRED_INVALID;
 
@@ -2195,6 +2262,7 @@ static void *_slurmctld_background(void *no_data)
 	static time_t last_node_acct;
 	static time_t last_ctld_bu_ping;
 	static time_t last_uid_update;
+	static time_t last_xmalloc_log;
 	time_t now;
 	int no_resp_msg_interval, ping_interval, purge_job_interval;
 	DEF_TIMERS;
@@ -2240,7 +2308,7 @@ static void *_slurmctld_background(void *no_data)
 	last_purge_job_time = last_trigger = last_health_check_time = now;
 	last_timelimit_time = last_assert_primary_time = now;
 	last_no_resp_msg_time = last_resv_time = last_ctld_bu_ping = now;
-	last_uid_update = now;
+	last_uid_update = last_xmalloc_log = now;
 	last_acct_gather_node_time = now;
 	last_config_list_update_time = now;
 
@@ -2327,6 +2395,13 @@ static void *_slurmctld_background(void *no_data)
 
 		validate_all_reservations(true);
 
+		xmalloc_site_stats(slurm_conf.debug_flags & DEBUG_FLAG_XMALLOC);
+		if ((slurm_conf.debug_flags & DEBUG_FLAG_XMALLOC) &&
+		    (difftime(now, last_xmalloc_log) >= 300)) {
+			last_xmalloc_log = now;
+			xmalloc_site_stats_log(20);
+		}
+
 		if (difftime(now, last_timelimit_time) >= PERIODIC_TIMEOUT) {
 			lock_slurmctld(job_write_lock);
 			now = time(NULL);
@@ -2512,6 +2587,7 @@ static void *_slurmctld_background(void *no_data)
 			next_stats_reset = now - (now % 86400) + 86400;
 			reset_stats(0);
 		}
+		stats_history_sample(now);
 
 		/*
 		 * Reassert this machine as the primary controller.
@@ -3283,6 +3359,25 @@ static bool _verify_clustername(void)
 	return create_file;
 }
 
+/*
+ * Record trace events in StateSaveLocation/trace_ring.<host> so they survive
+ * a crash. Each controller gets its own file as StateSaveLocation is shared.
+ */
+static void _init_trace_ring(void)
+{
+	uint32_t rec_cnt = DEFAULT_TRACE_RING_SIZE;
+	char *tmp_ptr, *path = NULL;
+
+	if ((tmp_ptr = xstrcasestr(slurm_conf.slurmctld_params,
+				   "trace_ring_size=")))
+		rec_cnt = strtoul(tmp_ptr + 16, NULL, 10);
+
+	xstrfmtcat(path, "%s/trace_ring.%s", slurm_conf.state_save_location,
+		   slurmctld_config.node_name_short);
+	trace_ring_init(path, rec_cnt);
+	xfree(path);
+}
+
 static void _create_clustername_file(void)
 {
 	FILE *fp;
@@ -48,6 +48,7 @@
 #include "src/common/slurm_protocol_api.h"
 #include "src/common/slurm_protocol_pack.h"
 #include "src/common/slurmdbd_defs.h"
+#include "src/common/xhash.h"
 #include "src/common/xmalloc.h"
 #include "src/common/xstring.h"
 #include "src/slurmctld/fed_mgr.h"
@@ -162,6 +163,7 @@ typedef struct {
 /* Local Structs */
 typedef struct {
 	job_info_msg_t *job_info_msg;
+	xhash_t        *remote_jobs;	/* job_info_msg records by job_id */
 	uint32_t        sibling_id;
 	char           *sibling_name;
 	time_t          sync_time;
@@ -3429,7 +3431,7 @@ static slurmdb_federation_rec_t *_state_load(char *state_save_location)
 
 	state_file = xstrdup_printf("%s/%s", state_save_location,
 				    FED_MGR_STATE_FILE);
-	if (!(buffer = create_mmap_buf(state_file))) {
+	if (!(buffer = state_file_open(state_file))) {
 		error("No fed_mgr state file (%s) to recover", state_file);
 		xfree(state_file);
 		return NULL;
@@ -5464,9 +5466,7 @@ extern int fed_mgr_update_job_cluster_features(job_record_t *job_ptr,
 
 static int _reconcile_fed_job(job_record_t *job_ptr, reconcile_sib_t *rec_sib)
 {
-	int i;
 	bool found_job = false;
-	job_info_msg_t *remote_jobs_ptr = rec_sib->job_info_msg;
 	uint32_t origin_id    = fed_mgr_get_cluster_id(job_ptr->job_id);
 	uint32_t sibling_id   = rec_sib->sibling_id;
 	uint64_t sibling_bit  = FED_SIBLING_BIT(sibling_id);
@@ -5475,7 +5475,7 @@ static int _reconcile_fed_job(job_record_t *job_ptr, reconcile_sib_t *rec_sib)
 	fed_job_info_t *job_info;
 
 	xassert(job_ptr);
-	xassert(remote_jobs_ptr);
+	xassert(rec_sib->remote_jobs);
 
 	/*
 	 * Only look at jobs that:
@@ -5493,13 +5493,10 @@ static int _reconcile_fed_job(job_record_t *job_ptr, reconcile_sib_t *rec_sib)
 		return SLURM_SUCCESS;
 	}
 
-	for (i = 0; i < remote_jobs_ptr->record_count; i++) {
-		remote_job = &remote_jobs_ptr->job_array[i];
-		if (job_ptr->job_id == remote_job->job_id) {
-			found_job = true;
-			break;
-		}
-	}
+	if ((remote_job = xhash_get(rec_sib->remote_jobs,
+				    (char *) &job_ptr->job_id,
+				    sizeof(job_ptr->job_id))))
+		found_job = true;
 
 	/* Jobs that originated on the remote sibling */
 	if (origin_id == sibling_id) {
@@ -5734,6 +5731,14 @@ static int _reconcile_fed_job(job_record_t *job_ptr, reconcile_sib_t *rec_sib)
  *
  * IN sib_name - name of the sibling to sync with.
  */
+static void _remote_job_id(void *item, const char **key, uint32_t *key_len)
+{
+	slurm_job_info_t *job_info = item;
+
+	*key = (char *) &job_info->job_id;
+	*key_len = sizeof(job_info->job_id);
+}
+
 static int _sync_jobs(const char *sib_name, job_info_msg_t *job_info_msg,
 		      time_t sync_time)
 {
@@ -5752,11 +5757,27 @@ static int _sync_jobs(const char *sib_name, job_info_msg_t *job_info_msg,
 	rec_sib.job_info_msg = job_info_msg;
 	rec_sib.sync_time    = sync_time;
 
+	/*
+	 * Index the sibling's jobs so each local job is matched with a lookup
+	 * instead of a scan of the whole remote job array.
+	 */
+	rec_sib.remote_jobs = xhash_init(_remote_job_id, NULL);
+	for (int i = 0; i < job_info_msg->record_count; i++) {
+		slurm_job_info_t *remote_job = &job_info_msg->job_array[i];
+
+		/* Keep the first record, as the linear search did */
+		if (!xhash_get(rec_sib.remote_jobs, (char *) &remote_job->job_id,
+			       sizeof(remote_job->job_id)))
+			xhash_add(rec_sib.remote_jobs, remote_job);
+	}
+
 	itr = list_iterator_create(job_list);
 	while ((job_ptr = list_next(itr)))
 		_reconcile_fed_job(job_ptr, &rec_sib);
 	list_iterator_destroy(itr);
 
+	xhash_free(rec_sib.remote_jobs);
+
 	sib->fed.sync_recvd = true;
 
 	return SLURM_SUCCESS;
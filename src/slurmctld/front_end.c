@@ -96,7 +96,7 @@ static buf_t *_open_front_end_state_file(char **state_file)
 	*state_file = xstrdup(slurm_conf.state_save_location);
 	xstrcat(*state_file, "/front_end_state");
 
-	if (!(buf = create_mmap_buf(*state_file)))
+	if (!(buf = state_file_open(*state_file)))
 		error("Could not open front_end state file %s: %m",
 		      *state_file);
 	else
@@ -105,7 +105,7 @@ static buf_t *_open_front_end_state_file(char **state_file)
 	error("NOTE: Trying backup front_end_state save file. Information may "
 	      "be lost!");
 	xstrcat(*state_file, ".old");
-	return create_mmap_buf(*state_file);
+	return state_file_open(*state_file);
 }
 
 /*
@@ -687,7 +687,7 @@ extern int dump_all_front_end_state(void)
 	unlock_slurmctld (node_read_lock);
 
 	/* write the buffer to file */
-	lock_state_files();
+	lock_state_file(STATE_FILE_FRONT_END);
 	log_fd = creat (new_file, 0600);
 	if (log_fd < 0) {
 		error ("Can't save state, error creating file %s %m", new_file);
@@ -727,7 +727,7 @@ extern int dump_all_front_end_state(void)
 	xfree (old_file);
 	xfree (reg_file);
 	xfree (new_file);
-	unlock_state_files ();
+	unlock_state_file(STATE_FILE_FRONT_END);
 
 	FREE_NULL_BUFFER(buffer);
 	END_TIMER2(__func__);
@@ -761,15 +761,15 @@ extern int load_all_front_end_state(bool state_only)
 	uint16_t protocol_version = NO_VAL16;
 
 	/* read the file */
-	lock_state_files();
+	lock_state_file(STATE_FILE_FRONT_END);
 	if (!(buffer = _open_front_end_state_file(&state_file))) {
 		info("No node state file (%s) to recover", state_file);
 		xfree(state_file);
-		unlock_state_files();
+		unlock_state_file(STATE_FILE_FRONT_END);
 		return ENOENT;
 	}
 	xfree(state_file);
-	unlock_state_files();
+	unlock_state_file(STATE_FILE_FRONT_END);
 
 	safe_unpackstr(&ver_str, buffer);
 	debug3("Version string in front_end_state header is %s", ver_str);
@@ -0,0 +1,292 @@
+/*****************************************************************************\
+ *  job_index.c - open addressing index of job records
+ *****************************************************************************
+ *  Copyright (C) SchedMD LLC.
+ *
+ *  This file is part of Slurm, a resource management program.
+ *  For details, see <https://slurm.schedmd.com/>.
+ *  Please also read the included file: DISCLAIMER.
+ *
+ *  Slurm is free software; you can redistribute it and/or modify it under
+ *  the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the License, or (at your option)
+ *  any later version.
+ *
+ *  In addition, as a special exception, the copyright holders give permission
+ *  to link the code of portions of this program with the OpenSSL library under
+ *  certain conditions as described in each individual source file, and
+ *  distribute linked combinations including the two. You must obey the GNU
+ *  General Public License in all respects for all of the code used other than
+ *  OpenSSL. If you modify file(s) with this exception, you may extend this
+ *  exception to your version of the file(s), but you are not obligated to do
+ *  so. If you do not wish to do so, delete this exception statement from your
+ *  version.  If you delete this exception statement from all source files in
+ *  the program, then also delete it here.
+ *
+ *  Slurm is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with Slurm; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA.
+\*****************************************************************************/
+
+#include "src/common/xassert.h"
+#include "src/common/xmalloc.h"
+
+#include "src/slurmctld/job_index.h"
+
+#define MAGIC_JOB_INDEX 0x8a3b21f0
+
+/* Minimum number of slots in a table */
+#define JOB_INDEX_MIN_SIZE 64
+
+/* Number of old table slots moved to the new table on every update */
+#define JOB_INDEX_MIGRATE_CNT 16
+
+typedef struct {
+	uint64_t key;
+	job_record_t *job_ptr;	/* NULL if slot is empty */
+} slot_t;
+
+typedef struct {
+	slot_t *slots;
+	uint32_t mask;		/* table size - 1, size is a power of 2 */
+	uint32_t count;		/* slots holding a job record */
+} table_t;
+
+struct job_index {
+	int magic; /* MAGIC_JOB_INDEX */
+	table_t table;
+	/*
+	 * Table being drained into table after a resize. Its slots are only
+	 * ever replaced with tombstones so probe sequences stay intact.
+	 */
+	table_t old;
+	uint32_t migrate_pos;	/* next slot of old to move */
+};
+
+/* Marks a slot of the old table whose record was moved or removed */
+static char tombstone;
+#define TOMBSTONE ((job_record_t *) &tombstone)
+
+static uint32_t _home(const table_t *table, uint64_t key)
+{
+	/* Fibonacci hashing spreads sequential job IDs across the table */
+	return ((key * 0x9e3779b97f4a7c15ULL) >> 32) & table->mask;
+}
+
+static void _table_init(table_t *table, uint32_t size)
+{
+	table->slots = xcalloc(size, sizeof(*table->slots));
+	table->mask = size - 1;
+	table->count = 0;
+}
+
+static void _table_fini(table_t *table)
+{
+	xfree(table->slots);
+	table->mask = 0;
+	table->count = 0;
+}
+
+/* RET slot holding key or the empty slot ending its probe sequence */
+static slot_t *_table_probe(const table_t *table, uint64_t key)
+{
+	uint32_t inx = _home(table, key);
+
+	while (true) {
+		slot_t *slot = &table->slots[inx];
+
+		if (!slot->job_ptr || (slot->key == key))
+			return slot;
+		inx = (inx + 1) & table->mask;
+	}
+}
+
+/* Remove slot without tombstones by shifting back any displaced entries */
+static void _table_delete(table_t *table, slot_t *slot)
+{
+	uint32_t hole = slot - table->slots;
+	uint32_t inx = hole;
+
+	while (true) {
+		uint32_t home;
+
+		inx = (inx + 1) & table->mask;
+		if (!table->slots[inx].job_ptr)
+			break;
+
+		/* Move entry if the hole lies between its home and itself */
+		home = _home(table, table->slots[inx].key);
+		if (((inx - home) & table->mask) >=
+		    ((inx - hole) & table->mask)) {
+			table->slots[hole] = table->slots[inx];
+			hole = inx;
+		}
+	}
+
+	table->slots[hole].job_ptr = NULL;
+	table->count--;
+}
+
+static void _table_insert(table_t *table, uint64_t key, job_record_t *job_ptr)
+{
+	slot_t *slot = _table_probe(table, key);
+
+	if (!slot->job_ptr)
+		table->count++;
+	slot->key = key;
+	slot->job_ptr = job_ptr;
+}
+
+/* Find live entry for key in the old table */
+static slot_t *_old_find(job_index_t *index, uint64_t key)
+{
+	uint32_t inx;
+
+	if (!index->old.slots)
+		return NULL;
+
+	inx = _home(&index->old, key);
+	while (true) {
+		slot_t *slot = &index->old.slots[inx];
+
+		if (!slot->job_ptr)
+			return NULL;
+		if ((slot->key == key) && (slot->job_ptr != TOMBSTONE))
+			return slot;
+		inx = (inx + 1) & index->old.mask;
+	}
+}
+
+static void _old_delete(job_index_t *index, slot_t *slot)
+{
+	slot->job_ptr = TOMBSTONE;
+	index->old.count--;
+}
+
+static void _migrate(job_index_t *index, uint32_t cnt)
+{
+	if (!index->old.slots)
+		return;
+
+	while (cnt-- && index->old.count) {
+		slot_t *slot = &index->old.slots[index->migrate_pos++];
+
+		if (!slot->job_ptr || (slot->job_ptr == TOMBSTONE))
+			continue;
+
+		_table_insert(&index->table, slot->key, slot->job_ptr);
+		_old_delete(index, slot);
+	}
+
+	if (!index->old.count) {
+		_table_fini(&index->old);
+		index->migrate_pos = 0;
+	}
+}
+
+static void _grow(job_index_t *index)
+{
+	uint32_t size = index->table.mask + 1;
+
+	if (((index->table.count + 1) * 4) <= (size * 3))
+		return;
+
+	/* Finish any resize in progress before starting another */
+	if (index->old.slots)
+		_migrate(index, UINT32_MAX);
+
+	index->old = index->table;
+	index->migrate_pos = 0;
+	_table_init(&index->table, (size * 2));
+}
+
+extern job_index_t *job_index_create(uint32_t size_hint)
+{
+	job_index_t *index = xmalloc(sizeof(*index));
+	uint32_t size = JOB_INDEX_MIN_SIZE;
+
+	/* Keep the expected number of entries under the growth threshold */
+	while ((size < (1U << 31)) && ((((uint64_t) size) * 3) <
+				       (((uint64_t) size_hint) * 4)))
+		size <<= 1;
+
+	index->magic = MAGIC_JOB_INDEX;
+	_table_init(&index->table, size);
+
+	return index;
+}
+
+extern void job_index_destroy(job_index_t *index)
+{
+	xassert(index->magic == MAGIC_JOB_INDEX);
+
+	_table_fini(&index->table);
+	_table_fini(&index->old);
+	index->magic = ~MAGIC_JOB_INDEX;
+	xfree(index);
+}
+
+extern job_record_t *job_index_find(job_index_t *index, uint64_t key)
+{
+	slot_t *slot;
+
+	xassert(index->magic == MAGIC_JOB_INDEX);
+
+	slot = _table_probe(&index->table, key);
+	if (slot->job_ptr)
+		return slot->job_ptr;
+
+	if ((slot = _old_find(index, key)))
+		return slot->job_ptr;
+
+	return NULL;
+}
+
+extern void job_index_insert(job_index_t *index, uint64_t key,
+			     job_record_t *job_ptr)
+{
+	slot_t *slot;
+
+	xassert(index->magic == MAGIC_JOB_INDEX);
+	xassert(job_ptr);
+
+	_migrate(index, JOB_INDEX_MIGRATE_CNT);
+
+	/* Only the new table may hold key once it is replaced */
+	if ((slot = _old_find(index, key)))
+		_old_delete(index, slot);
+
+	_grow(index);
+	_table_insert(&index->table, key, job_ptr);
+}
+
+extern bool job_index_remove(job_index_t *index, uint64_t key,
+			     job_record_t *job_ptr)
+{
+	slot_t *slot;
+
+	xassert(index->magic == MAGIC_JOB_INDEX);
+
+	_migrate(index, JOB_INDEX_MIGRATE_CNT);
+
+	slot = _table_probe(&index->table, key);
+	if (slot->job_ptr) {
+		if (slot->job_ptr != job_ptr)
+			return false;
+		_table_delete(&index->table, slot);
+		return true;
+	}
+
+	if ((slot = _old_find(index, key)) && (slot->job_ptr == job_ptr)) {
+		_old_delete(index, slot);
+		_migrate(index, 0);
+		return true;
+	}
+
+	return false;
+}
@@ -0,0 +1,94 @@
+/*****************************************************************************\
+ *  job_index.h - open addressing index of job records
+ *****************************************************************************
+ *  Copyright (C) SchedMD LLC.
+ *
+ *  This file is part of Slurm, a resource management program.
+ *  For details, see <https://slurm.schedmd.com/>.
+ *  Please also read the included file: DISCLAIMER.
+ *
+ *  Slurm is free software; you can redistribute it and/or modify it under
+ *  the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the License, or (at your option)
+ *  any later version.
+ *
+ *  In addition, as a special exception, the copyright holders give permission
+ *  to link the code of portions of this program with the OpenSSL library under
+ *  certain conditions as described in each individual source file, and
+ *  distribute linked combinations including the two. You must obey the GNU
+ *  General Public License in all respects for all of the code used other than
+ *  OpenSSL. If you modify file(s) with this exception, you may extend this
+ *  exception to your version of the file(s), but you are not obligated to do
+ *  so. If you do not wish to do so, delete this exception statement from your
+ *  version.  If you delete this exception statement from all source files in
+ *  the program, then also delete it here.
+ *
+ *  Slurm is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with Slurm; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA.
+\*****************************************************************************/
+
+#ifndef _JOB_INDEX_H
+#define _JOB_INDEX_H
+
+#include <inttypes.h>
+#include <stdbool.h>
+
+#include "src/common/job_record.h"
+
+/*
+ * Map of 64 bit keys to job records.
+ *
+ * Open addressing with linear probing keeps lookups to a few adjacent cache
+ * lines. The table doubles once it is 3/4 full, but entries are moved to the
+ * new table a few slots at a time on each insert or remove so no single
+ * operation has to rehash every job.
+ *
+ * NOTE: Lookups never modify the table, so they only need the job read lock.
+ * Inserts and removes need the job write lock.
+ */
+typedef struct job_index job_index_t;
+
+/* Key for the index of job array tasks */
+#define JOB_ARRAY_TASK_KEY(_job_id, _task_id) \
+	((((uint64_t) (_job_id)) << 32) | ((uint32_t) (_task_id)))
+
+/*
+ * Create an empty index
+ * IN size_hint - number of entries expected, table grows past it as needed
+ * RET index, release with FREE_NULL_JOB_INDEX()
+ */
+extern job_index_t *job_index_create(uint32_t size_hint);
+
+extern void job_index_destroy(job_index_t *index);
+
+#define FREE_NULL_JOB_INDEX(_X)			\
+	do {					\
+		if (_X)				\
+			job_index_destroy(_X);	\
+		_X = NULL;			\
+	} while (0)
+
+/* RET job record stored with key or NULL if not found */
+extern job_record_t *job_index_find(job_index_t *index, uint64_t key);
+
+/*
+ * Store job record under key, replacing any record already stored with it
+ * IN job_ptr - must not be NULL
+ */
+extern void job_index_insert(job_index_t *index, uint64_t key,
+			     job_record_t *job_ptr);
+
+/*
+ * Remove key from index if it is stored with job_ptr
+ * RET true if removed, false if key is absent or stored with another record
+ */
+extern bool job_index_remove(job_index_t *index, uint64_t key,
+			     job_record_t *job_ptr);
+
+#endif /* _JOB_INDEX_H */
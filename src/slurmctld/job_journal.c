@@ -0,0 +1,489 @@
+/*****************************************************************************\
+ *  job_journal.c - append-only journal of job state changes
+ *****************************************************************************
+ *  Copyright (C) SchedMD LLC.
+ *
+ *  This file is part of Slurm, a resource management program.
+ *  For details, see <https://slurm.schedmd.com/>.
+ *  Please also read the included file: DISCLAIMER.
+ *
+ *  Slurm is free software; you can redistribute it and/or modify it under
+ *  the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the License, or (at your option)
+ *  any later version.
+ *
+ *  In addition, as a special exception, the copyright holders give permission
+ *  to link the code of portions of this program with the OpenSSL library under
+ *  certain conditions as described in each individual source file, and
+ *  distribute linked combinations including the two. You must obey the GNU
+ *  General Public License in all respects for all of the code used other than
+ *  OpenSSL. If you modify file(s) with this exception, you may extend this
+ *  exception to your version of the file(s), but you are not obligated to do
+ *  so. If you do not wish to do so, delete this exception statement from your
+ *  version.  If you delete this exception statement from all source files in
+ *  the program, then also delete it here.
+ *
+ *  Slurm is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with Slurm; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA.
+\*****************************************************************************/
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "src/common/fd.h"
+#include "src/common/xmalloc.h"
+#include "src/common/xstring.h"
+
+#include "src/slurmctld/job_journal.h"
+#include "src/slurmctld/slurmctld.h"
+#include "src/slurmctld/state_save.h"
+
+#define JOB_JOURNAL_VERSION "PROTOCOL_VERSION"
+
+#define JOURNAL_REC_JOB 1	/* followed by a packed job record */
+#define JOURNAL_REC_PURGE 2	/* job was purged */
+
+typedef struct {
+	uint32_t job_id;
+	uint32_t seq;		/* position in journal */
+	uint16_t type;		/* JOURNAL_REC_* */
+	uint32_t offset;	/* offset of job record in journal buffer */
+	uint32_t len;		/* bytes of job record */
+} journal_rec_t;
+
+struct job_journal {
+	buf_t *buffer;
+	uint16_t protocol_version;
+	bool have_batch;	/* a complete batch was read */
+	uint32_t job_id_sequence;
+	time_t bf_when_last_cycle;
+	journal_rec_t *recs;	/* newest record per job sorted by job_id */
+	uint32_t rec_cnt;
+};
+
+/* Only touched by the thread saving job state */
+static uint64_t journal_size = UINT64_MAX;
+static uint32_t batch_offset = 0;
+
+static char *_journal_file(const char *suffix)
+{
+	return xstrdup_printf("%s/job_state.journal%s",
+			      slurm_conf.state_save_location, suffix);
+}
+
+/* 64-bit FNV-1a */
+extern uint64_t job_journal_hash(const char *data, uint32_t len)
+{
+	uint64_t hash = 0xcbf29ce484222325ULL;
+
+	for (uint32_t i = 0; i < len; i++) {
+		hash ^= (uint8_t) data[i];
+		hash *= 0x100000001b3ULL;
+	}
+
+	/* zero is reserved for jobs never saved */
+	return hash ? hash : 1;
+}
+
+static int _write_all(int fd, const char *data, uint32_t len,
+		      const char *file)
+{
+	while (len > 0) {
+		ssize_t amount = write(fd, data, len);
+
+		if (amount < 0) {
+			if (errno == EINTR)
+				continue;
+			error("Error writing file %s, %m", file);
+			return errno;
+		}
+		data += amount;
+		len -= amount;
+	}
+
+	return SLURM_SUCCESS;
+}
+
+extern void job_journal_batch_init(buf_t *buffer, uint32_t job_id_sequence,
+				   time_t bf_when_last_cycle)
+{
+	batch_offset = get_buf_offset(buffer);
+
+	pack32(0, buffer); /* batch length, filled in by batch_fini */
+	pack32(job_id_sequence, buffer);
+	pack_time(bf_when_last_cycle, buffer);
+	pack32(0, buffer); /* record count, filled in by batch_fini */
+}
+
+extern bool job_journal_batch_add_job(buf_t *buffer, job_record_t *job_ptr)
+{
+	uint32_t rec_offset = get_buf_offset(buffer), start, end;
+	uint64_t hash;
+
+	/* Don't pack "unlinked" job. */
+	if (job_ptr->job_id == NO_VAL)
+		return false;
+
+	pack16(JOURNAL_REC_JOB, buffer);
+	pack32(job_ptr->job_id, buffer);
+	pack32(0, buffer);
+	start = get_buf_offset(buffer);
+	job_mgr_dump_job_state(job_ptr, buffer);
+	end = get_buf_offset(buffer);
+
+	hash = job_journal_hash(&get_buf_data(buffer)[start], (end - start));
+	if (hash == job_ptr->state_hash) {
+		set_buf_offset(buffer, rec_offset);
+		return false;
+	}
+	job_ptr->state_hash = hash;
+
+	set_buf_offset(buffer, (start - sizeof(uint32_t)));
+	pack32((end - start), buffer);
+	set_buf_offset(buffer, end);
+
+	return true;
+}
+
+extern void job_journal_batch_add_purge(buf_t *buffer, uint32_t job_id)
+{
+	pack16(JOURNAL_REC_PURGE, buffer);
+	pack32(job_id, buffer);
+}
+
+extern void job_journal_batch_fini(buf_t *buffer, uint32_t rec_cnt)
+{
+	uint32_t end = get_buf_offset(buffer);
+
+	set_buf_offset(buffer, batch_offset);
+	pack32((end - batch_offset - sizeof(uint32_t)), buffer);
+	set_buf_offset(buffer, (batch_offset + (2 * sizeof(uint32_t)) +
+				sizeof(uint64_t)));
+	pack32(rec_cnt, buffer);
+	set_buf_offset(buffer, end);
+}
+
+extern void job_journal_snapshot_job(buf_t *buffer, uint32_t offset,
+				     job_record_t *job_ptr)
+{
+	job_ptr->state_hash = job_journal_hash(&get_buf_data(buffer)[offset],
+				    (get_buf_offset(buffer) - offset));
+}
+
+extern int job_journal_append(buf_t *buffer)
+{
+	char *file = _journal_file("");
+	int fd, rc;
+
+	if (journal_size == UINT64_MAX) {
+		xfree(file);
+		return SLURM_ERROR;
+	}
+
+	if ((fd = open(file, O_WRONLY | O_APPEND | O_CLOEXEC)) < 0) {
+		error("Can't save state, open file %s error %m", file);
+		rc = errno;
+	} else {
+		rc = _write_all(fd, get_buf_data(buffer),
+				get_buf_offset(buffer), file);
+		if ((fsync_and_close(fd, "job journal")) && !rc)
+			rc = SLURM_ERROR;
+	}
+
+	/* Any change may have been lost so write a snapshot next time */
+	if (rc)
+		journal_size = UINT64_MAX;
+	else
+		journal_size += get_buf_offset(buffer);
+
+	xfree(file);
+	return rc;
+}
+
+extern int job_journal_reset(time_t snapshot_time)
+{
+	char *file = _journal_file(""), *new_file = _journal_file(".new");
+	buf_t *buffer = init_buf(BUF_SIZE);
+	int fd, rc;
+
+	packstr(JOB_JOURNAL_VERSION, buffer);
+	pack16(SLURM_PROTOCOL_VERSION, buffer);
+	pack_time(snapshot_time, buffer);
+
+	fd = open(new_file, O_CREAT | O_WRONLY | O_TRUNC | O_CLOEXEC, 0600);
+	if (fd < 0) {
+		error("Can't save state, create file %s error %m", new_file);
+		rc = errno;
+	} else {
+		rc = _write_all(fd, get_buf_data(buffer),
+				get_buf_offset(buffer), new_file);
+		if ((fsync_and_close(fd, "job journal")) && !rc)
+			rc = SLURM_ERROR;
+	}
+
+	if (!rc && rename(new_file, file)) {
+		error("Can't save state, rename %s to %s error %m",
+		      new_file, file);
+		rc = errno;
+	}
+
+	if (rc) {
+		(void) unlink(new_file);
+		journal_size = UINT64_MAX;
+	} else {
+		journal_size = get_buf_offset(buffer);
+	}
+
+	FREE_NULL_BUFFER(buffer);
+	xfree(new_file);
+	xfree(file);
+	return rc;
+}
+
+extern void job_journal_invalidate(void)
+{
+	journal_size = UINT64_MAX;
+}
+
+extern void job_journal_remove(void)
+{
+	char *file = _journal_file("");
+
+	if (unlink(file) && (errno != ENOENT))
+		error("Can't remove file %s: %m", file);
+	journal_size = UINT64_MAX;
+
+	xfree(file);
+}
+
+extern uint64_t job_journal_size(void)
+{
+	return journal_size;
+}
+
+static int _cmp_rec_job_id(const void *x, const void *y)
+{
+	const journal_rec_t *r1 = x, *r2 = y;
+
+	if (r1->job_id != r2->job_id)
+		return (r1->job_id < r2->job_id) ? -1 : 1;
+	if (r1->seq != r2->seq)
+		return (r1->seq < r2->seq) ? -1 : 1;
+	return 0;
+}
+
+static int _cmp_rec_seq(const void *x, const void *y)
+{
+	const journal_rec_t *r1 = x, *r2 = y;
+
+	if (r1->seq != r2->seq)
+		return (r1->seq < r2->seq) ? -1 : 1;
+	return 0;
+}
+
+/* Sort records by job ID keeping only the newest record of each job */
+static void _dedup_recs(job_journal_t *journal)
+{
+	uint32_t cnt = 0;
+
+	qsort(journal->recs, journal->rec_cnt, sizeof(*journal->recs),
+	      _cmp_rec_job_id);
+
+	for (uint32_t i = 0; i < journal->rec_cnt; i++) {
+		if (cnt && (journal->recs[cnt - 1].job_id ==
+			    journal->recs[i].job_id))
+			cnt--;
+		journal->recs[cnt++] = journal->recs[i];
+	}
+
+	journal->rec_cnt = cnt;
+}
+
+extern job_journal_t *job_journal_load(time_t snapshot_time)
+{
+	char *file = _journal_file(""), *ver_str = NULL;
+	job_journal_t *journal;
+	buf_t *buffer;
+	time_t journal_time;
+	uint32_t rec_alloc = 0, committed = 0, seq = 0;
+
+	if (!(buffer = state_file_open(file))) {
+		debug("No job state journal (%s) to recover", file);
+		xfree(file);
+		return NULL;
+	}
+
+	journal = xmalloc(sizeof(*journal));
+	journal->buffer = buffer;
+	journal->protocol_version = NO_VAL16;
+
+	safe_unpackstr(&ver_str, buffer);
+	if (ver_str && !xstrcmp(ver_str, JOB_JOURNAL_VERSION))
+		safe_unpack16(&journal->protocol_version, buffer);
+	xfree(ver_str);
+	if (journal->protocol_version == NO_VAL16) {
+		error("Ignoring job state journal %s, incompatible version",
+		      file);
+		goto fail;
+	}
+
+	safe_unpack_time(&journal_time, buffer);
+	if (journal_time != snapshot_time) {
+		info("Ignoring job state journal %s, it does not match the job_state file",
+		     file);
+		goto fail;
+	}
+
+	while (remaining_buf(buffer) > 0) {
+		uint32_t batch_len, batch_end, job_id_sequence, cnt;
+		time_t bf_when_last_cycle;
+
+		safe_unpack32(&batch_len, buffer);
+		if (batch_len > remaining_buf(buffer)) {
+			info("Ignoring incomplete batch at end of job state journal %s",
+			     file);
+			break;
+		}
+		batch_end = get_buf_offset(buffer) + batch_len;
+
+		safe_unpack32(&job_id_sequence, buffer);
+		safe_unpack_time(&bf_when_last_cycle, buffer);
+		safe_unpack32(&cnt, buffer);
+
+		journal->rec_cnt = committed;
+		for (uint32_t i = 0; i < cnt; i++) {
+			journal_rec_t *rec;
+
+			if (journal->rec_cnt >= rec_alloc) {
+				rec_alloc = MAX(1024, (rec_alloc * 2));
+				xrecalloc(journal->recs, rec_alloc,
+					  sizeof(*journal->recs));
+			}
+			rec = &journal->recs[journal->rec_cnt++];
+			rec->seq = seq++;
+
+			safe_unpack16(&rec->type, buffer);
+			safe_unpack32(&rec->job_id, buffer);
+			if (rec->type == JOURNAL_REC_PURGE)
+				continue;
+			if (rec->type != JOURNAL_REC_JOB)
+				goto unpack_error;
+
+			safe_unpack32(&rec->len, buffer);
+			if (rec->len > remaining_buf(buffer))
+				goto unpack_error;
+			rec->offset = get_buf_offset(buffer);
+			set_buf_offset(buffer, (rec->offset + rec->len));
+		}
+		if (get_buf_offset(buffer) != batch_end)
+			goto unpack_error;
+
+		committed = journal->rec_cnt;
+		journal->have_batch = true;
+		journal->job_id_sequence = job_id_sequence;
+		journal->bf_when_last_cycle = bf_when_last_cycle;
+	}
+
+	journal->rec_cnt = committed;
+	_dedup_recs(journal);
+	info("Recovered %u job state changes from journal", journal->rec_cnt);
+
+	xfree(file);
+	return journal;
+
+unpack_error:
+	if (!ignore_state_errors)
+		fatal("Incomplete job state journal %s, start with '-i' to ignore this. Warning: using -i will lose the data that can't be recovered.",
+		      file);
+	error("Incomplete job state journal %s", file);
+	journal->rec_cnt = committed;
+	_dedup_recs(journal);
+	xfree(file);
+	return journal;
+
+fail:
+	job_journal_free(journal);
+	xfree(file);
+	return NULL;
+}
+
+extern void job_journal_free(job_journal_t *journal)
+{
+	if (!journal)
+		return;
+
+	FREE_NULL_BUFFER(journal->buffer);
+	xfree(journal->recs);
+	xfree(journal);
+}
+
+extern void job_journal_get_header(job_journal_t *journal,
+				   uint32_t *job_id_sequence,
+				   time_t *bf_when_last_cycle)
+{
+	/* No complete batch leaves the snapshot header values as they are */
+	if (!journal->have_batch)
+		return;
+
+	*job_id_sequence = journal->job_id_sequence;
+	*bf_when_last_cycle = journal->bf_when_last_cycle;
+}
+
+extern bool job_journal_supersedes(job_journal_t *journal, uint32_t job_id)
+{
+	uint32_t lo = 0, hi = journal->rec_cnt;
+
+	while (lo < hi) {
+		uint32_t mid = lo + ((hi - lo) / 2);
+
+		if (journal->recs[mid].job_id < job_id)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	return ((lo < journal->rec_cnt) &&
+		(journal->recs[lo].job_id == job_id));
+}
+
+extern int job_journal_replay(job_journal_t *journal,
+			      int (*load_func)(buf_t *buffer,
+					       uint16_t protocol_version))
+{
+	journal_rec_t *recs;
+	int job_cnt = 0;
+
+	/* Load jobs in the order they were saved */
+	recs = xcalloc(journal->rec_cnt, sizeof(*recs));
+	memcpy(recs, journal->recs, (journal->rec_cnt * sizeof(*recs)));
+	qsort(recs, journal->rec_cnt, sizeof(*recs), _cmp_rec_seq);
+
+	for (uint32_t i = 0; i < journal->rec_cnt; i++) {
+		buf_t *buffer;
+		int rc;
+
+		if (recs[i].type != JOURNAL_REC_JOB)
+			continue;
+
+		buffer = create_shadow_buf(
+			&get_buf_data(journal->buffer)[recs[i].offset],
+			recs[i].len);
+		rc = load_func(buffer, journal->protocol_version);
+		FREE_NULL_BUFFER(buffer);
+		if (rc != SLURM_SUCCESS) {
+			job_cnt = -1;
+			break;
+		}
+		job_cnt++;
+	}
+
+	xfree(recs);
+	return job_cnt;
+}
@@ -0,0 +1,146 @@
+/*****************************************************************************\
+ *  job_journal.h - append-only journal of job state changes
+ *****************************************************************************
+ *  Copyright (C) SchedMD LLC.
+ *
+ *  This file is part of Slurm, a resource management program.
+ *  For details, see <https://slurm.schedmd.com/>.
+ *  Please also read the included file: DISCLAIMER.
+ *
+ *  Slurm is free software; you can redistribute it and/or modify it under
+ *  the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the License, or (at your option)
+ *  any later version.
+ *
+ *  In addition, as a special exception, the copyright holders give permission
+ *  to link the code of portions of this program with the OpenSSL library under
+ *  certain conditions as described in each individual source file, and
+ *  distribute linked combinations including the two. You must obey the GNU
+ *  General Public License in all respects for all of the code used other than
+ *  OpenSSL. If you modify file(s) with this exception, you may extend this
+ *  exception to your version of the file(s), but you are not obligated to do
+ *  so. If you do not wish to do so, delete this exception statement from your
+ *  version.  If you delete this exception statement from all source files in
+ *  the program, then also delete it here.
+ *
+ *  Slurm is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with Slurm; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA.
+\*****************************************************************************/
+
+#ifndef _JOB_JOURNAL_H
+#define _JOB_JOURNAL_H
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <time.h>
+
+#include "src/common/job_record.h"
+#include "src/common/pack.h"
+
+/*
+ * With SlurmctldParameters=enable_job_state_journal the job_state file is a
+ * periodically compacted snapshot and "job_state.journal" holds every job
+ * record that changed since that snapshot was written. Each call to
+ * dump_all_job_state() between compactions appends one batch holding the
+ * job records whose packed state changed and the IDs of purged jobs.
+ *
+ * The journal header records the time stamp of the snapshot it extends, so a
+ * journal left behind by an interrupted compaction is never replayed over the
+ * wrong snapshot. A batch cut short by a crash is ignored on recovery.
+ */
+
+typedef struct job_journal job_journal_t;
+
+/* 64-bit FNV-1a hash of packed job state, never 0 */
+extern uint64_t job_journal_hash(const char *data, uint32_t len);
+
+/* Start a batch in buffer, must be followed by job_journal_batch_fini() */
+extern void job_journal_batch_init(buf_t *buffer, uint32_t job_id_sequence,
+				   time_t bf_when_last_cycle);
+
+/*
+ * Append job state to the batch if it changed since the last time it was
+ * saved to the snapshot or journal
+ * RET true if the job was added to the batch
+ */
+extern bool job_journal_batch_add_job(buf_t *buffer, job_record_t *job_ptr);
+
+/* Append a purged job to the batch */
+extern void job_journal_batch_add_purge(buf_t *buffer, uint32_t job_id);
+
+/* Complete batch started by job_journal_batch_init() */
+extern void job_journal_batch_fini(buf_t *buffer, uint32_t rec_cnt);
+
+/*
+ * Remember the state of a job just packed into a full job_state snapshot
+ * IN buffer - buffer holding the job state
+ * IN offset - offset in buffer where the job's state starts
+ */
+extern void job_journal_snapshot_job(buf_t *buffer, uint32_t offset,
+				     job_record_t *job_ptr);
+
+/*
+ * Append batches in buffer to the journal
+ * NOTE: Caller must hold lock_state_file(STATE_FILE_JOB)
+ */
+extern int job_journal_append(buf_t *buffer);
+
+/*
+ * Start an empty journal for a newly written job_state snapshot
+ * NOTE: Caller must hold lock_state_file(STATE_FILE_JOB)
+ */
+extern int job_journal_reset(time_t snapshot_time);
+
+/*
+ * Write a snapshot on the next save but keep the journal for recovery, used
+ * when writing a snapshot failed
+ */
+extern void job_journal_invalidate(void);
+
+/*
+ * Remove the journal after writing a snapshot without one
+ * NOTE: Caller must hold lock_state_file(STATE_FILE_JOB)
+ */
+extern void job_journal_remove(void);
+
+/*
+ * RET bytes written to the journal since the last snapshot or UINT64_MAX if
+ * there is no usable journal and the next save must write a snapshot
+ */
+extern uint64_t job_journal_size(void);
+
+/*
+ * Read the journal extending the snapshot written at snapshot_time
+ * RET journal or NULL if there is none, release with job_journal_free()
+ */
+extern job_journal_t *job_journal_load(time_t snapshot_time);
+
+extern void job_journal_free(job_journal_t *journal);
+
+/* Get job_state header values as of the last batch in the journal */
+extern void job_journal_get_header(job_journal_t *journal,
+				   uint32_t *job_id_sequence,
+				   time_t *bf_when_last_cycle);
+
+/*
+ * RET true if the journal holds newer state for the job (or its purge), so
+ * its record in the snapshot must be skipped
+ */
+extern bool job_journal_supersedes(job_journal_t *journal, uint32_t job_id);
+
+/*
+ * Load the latest state of every job in the journal
+ * IN load_func - function to load one job record from a buffer
+ * RET number of jobs loaded or -1 on error
+ */
+extern int job_journal_replay(job_journal_t *journal,
+			      int (*load_func)(buf_t *buffer,
+					       uint16_t protocol_version));
+
+#endif /* _JOB_JOURNAL_H */
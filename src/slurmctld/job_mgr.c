@@ -100,6 +100,8 @@
 #include "src/slurmctld/fed_mgr.h"
 #include "src/slurmctld/front_end.h"
 #include "src/slurmctld/gang.h"
+#include "src/slurmctld/job_index.h"
+#include "src/slurmctld/job_journal.h"
 #include "src/slurmctld/job_scheduler.h"
 #include "src/slurmctld/licenses.h"
 #include "src/slurmctld/locks.h"
@@ -122,13 +124,16 @@
 #define TOP_PRIORITY 0xffff0000	/* large, but leave headroom for higher */
 #define PURGE_OLD_JOB_IN_SEC 2592000 /* 30 days in seconds */
 
-#define JOB_HASH_INX(_job_id)	(_job_id % hash_table_size)
-#define JOB_ARRAY_HASH_INX(_job_id, _task_id)		\
-	((_job_id + _task_id) % hash_table_size)
-
 /* No need to change we always pack SLURM_PROTOCOL_VERSION */
 #define JOB_STATE_VERSION     "PROTOCOL_VERSION"
 
+/* Seconds purged job IDs are reported by pack_delta_jobs() */
+#define JOB_TOMBSTONE_AGE 600
+
+/* Parallel unpack of job_state records in load_all_job_state() */
+#define MAX_JOB_UNPACK_THREADS 16
+#define JOB_UNPACK_THREAD_MIN_RECS 256
+
 typedef enum {
 	JOB_HASH_JOB,
 	JOB_HASH_ARRAY_JOB,
@@ -154,8 +159,15 @@ typedef struct {
 	slurmdb_user_rec_t user_rec;
 	bool privileged;
 	part_record_t **visible_parts;
+	uint64_t min_info_gen;	/* skip jobs unchanged since, 0 to pack all */
 } _foreach_pack_job_info_t;
 
+typedef struct {
+	uint32_t job_id;
+	uint64_t info_gen;	/* first job info generation without job */
+	time_t purge_time;
+} job_tombstone_t;
+
 typedef struct {
 	bitstr_t *node_map;
 	list_t *license_list;
@@ -199,25 +211,63 @@ typedef struct {
 	const slurm_selected_step_t *filter;
 } for_each_by_job_id_args_t;
 
+typedef struct {
+	buf_t *buffer;
+	bool journal;
+	uint32_t rec_cnt;
+} journal_args_t;
+
+typedef struct {
+	char *data;			/* job_state file contents */
+	job_record_t **job;		/* unpacked records, NULL on error */
+	uint32_t *length;		/* packed record lengths */
+	uint32_t *offset;		/* packed record offsets in data */
+	uint16_t protocol_version;
+	uint32_t rec_cnt;
+	int thread_cnt;
+} job_unpack_args_t;
+
+typedef struct {
+	job_unpack_args_t *args;
+	int thread_inx;
+} job_unpack_thread_t;
+
 /* Global variables */
 list_t *job_list = NULL;	/* job_record list */
 time_t last_job_update;		/* time of last update to job records */
 
 list_t *purge_jobs_list = NULL;	/* job_record_t entries to free */
+static list_t *journal_purge_list = NULL; /* job IDs to journal as purged */
+
+/*
+ * Job info generations for pack_delta_jobs(). The generation advances at most
+ * once per second, each advance hashing the packed info of every job to find
+ * those changed since the previous one. Generations start from the time of
+ * the first scan shifted into the upper 32 bits so that values handed out
+ * before a restart or takeover are always older than job_info_min_gen.
+ * All of these, and the info_gen and info_hash job_record_t fields, are
+ * protected by job_info_gen_mutex and the job read lock.
+ */
+static pthread_mutex_t job_info_gen_mutex = PTHREAD_MUTEX_INITIALIZER;
+static uint64_t job_info_gen = 0;	/* current generation, 0 if none */
+static uint64_t job_info_min_gen = 0;	/* oldest generation with deltas */
+static time_t job_info_scan_time = 0;	/* time of last generation advance */
+static list_t *job_tombstone_list = NULL; /* job_tombstone_t, by info_gen */
+static uint64_t job_tombstone_gen = 0;	/* info_gen of newest tombstone */
 
 /* Local variables */
 static int      bf_min_age_reserve = 0;
 static uint32_t delay_boot = 0;
 static uint32_t highest_prio = 0;
 static uint32_t lowest_prio  = TOP_PRIORITY;
-static int      hash_table_size = 0;
 static int      job_count = 0;		/* job's in the system */
 static uint32_t job_id_sequence = 0;	/* first job_id to assign new job */
-static struct   job_record **job_hash = NULL;
-static struct   job_record **job_array_hash_j = NULL;
-static struct   job_record **job_array_hash_t = NULL;
+static job_index_t *job_hash = NULL;		/* by job_id */
+static job_index_t *job_array_hash_j = NULL;	/* first task by array_job_id */
+static job_index_t *job_array_hash_t = NULL;	/* by array job and task id */
 static bool     kill_invalid_dep;
 static time_t   last_file_write_time = (time_t) 0;
+static uint32_t last_job_state_size = 0;	/* size of job_state snapshot */
 static uint32_t max_array_size = NO_VAL;
 static bitstr_t *requeue_exit = NULL;
 static bitstr_t *requeue_exit_hold = NULL;
@@ -233,6 +283,8 @@ static void _add_job_array_hash(job_record_t *job_ptr);
 static void _handle_requeue_limit(job_record_t *job_ptr, const char *caller);
 static int  _copy_job_desc_to_file(job_desc_msg_t * job_desc,
 				   uint32_t job_id);
+static void _delete_job_desc_dir(char *dir_name);
+static int _write_job_desc_files(job_desc_msg_t *job_desc, char *dir_name);
 static int  _copy_job_desc_to_job_record(job_desc_msg_t * job_desc,
 					 job_record_t **job_ptr,
 					 bitstr_t ** exc_bitmap,
@@ -254,6 +306,9 @@ static int  _job_create(job_desc_msg_t *job_desc, int allocate, int will_run,
 			char **err_msg, uint16_t protocol_version);
 static void _job_timed_out(job_record_t *job_ptr, bool preempted);
 static void _kill_dependent(job_record_t *job_ptr);
+static int  _load_job_record(job_record_t *job_ptr, job_journal_t *superseded);
+static int  _load_job_state(buf_t *buffer, uint16_t protocol_version,
+			    job_journal_t *superseded);
 static int  _list_find_job_old(void *job_entry, void *key);
 static bitstr_t *_make_requeue_array(char *conf_buf);
 static uint32_t _max_switch_wait(uint32_t input_wait);
@@ -687,6 +742,119 @@ static job_record_t *_create_job_record(uint32_t num_jobs, bool list_add)
 	return job_ptr;
 }
 
+/*
+ * Batch scripts and environments with identical content are stored once in
+ * BATCH_FILE_DIR, named after the hash of their content, and hard linked into
+ * each job's directory. The link count of the shared file tracks the jobs
+ * still using it.
+ */
+#define BATCH_FILE_DIR "batch_files"
+
+static char *_batch_file_path(const char *name, slurm_hash_t *hash)
+{
+	char *hex, *path;
+
+	hex = xstring_bytes2hex(hash->hash, sizeof(hash->hash), NULL);
+	path = xstrdup_printf("%s/%s/%s.%s", slurm_conf.state_save_location,
+			      BATCH_FILE_DIR, name, hex);
+	xfree(hex);
+
+	return path;
+}
+
+/* Hash the contents of a batch environment file before it is written */
+static bool _hash_env_file(char **env, uint32_t env_size, slurm_hash_t *hash)
+{
+	struct iovec *iov;
+	int rc;
+
+	iov = xcalloc(env_size + 1, sizeof(*iov));
+	iov[0].iov_base = &env_size;
+	iov[0].iov_len = sizeof(env_size);
+	for (int i = 0; i < env_size; i++) {
+		iov[i + 1].iov_base = env[i];
+		iov[i + 1].iov_len = strlen(env[i]) + 1;
+	}
+	hash->type = HASH_PLUGIN_K12;
+	rc = hash_g_compute_iov(iov, env_size + 1, NULL, 0, hash);
+	xfree(iov);
+
+	return (rc >= 0);
+}
+
+/* Hash the contents of a batch script file before it is written */
+static bool _hash_script_file(char *script, slurm_hash_t *hash)
+{
+	hash->type = HASH_PLUGIN_K12;
+	return (hash_g_compute(script, strlen(script) + 1, NULL, 0, hash) >= 0);
+}
+
+/*
+ * Link file_name to the shared copy of a batch file with the same contents
+ * RET true if file_name was created, false if it must be written instead
+ */
+static bool _link_batch_file(char *file_name, const char *name,
+			     slurm_hash_t *hash)
+{
+	char *shared = _batch_file_path(name, hash);
+	int rc;
+
+	/* Never truncate a stale file which may still be linked elsewhere */
+	(void) unlink(file_name);
+	rc = link(shared, file_name);
+
+	xfree(shared);
+	return !rc;
+}
+
+/* Make a newly written batch file available for other jobs to link to */
+static void _share_batch_file(char *file_name, const char *name,
+			      slurm_hash_t *hash)
+{
+	char *shared = xstrdup_printf("%s/%s", slurm_conf.state_save_location,
+				      BATCH_FILE_DIR);
+
+	(void) mkdir(shared, 0700);
+	xfree(shared);
+
+	/* Not supported by the file system or already shared is fine */
+	shared = _batch_file_path(name, hash);
+	(void) link(file_name, shared);
+	xfree(shared);
+}
+
+/*
+ * Remove the shared copy of a batch file once file_name is the last job file
+ * linked to it
+ */
+static void _release_batch_file(char *file_name, const char *name)
+{
+	struct stat job_stat, shared_stat;
+	slurm_hash_t hash = { .type = HASH_PLUGIN_K12 };
+	char *shared;
+	buf_t *buf;
+
+	if (xstrcmp(name, "environment") && xstrcmp(name, "script"))
+		return;
+	if (stat(file_name, &job_stat) || (job_stat.st_nlink != 2))
+		return;
+	if (!(buf = create_mmap_buf(file_name)))
+		return;
+	if (hash_g_compute(get_buf_data(buf), size_buf(buf), NULL, 0,
+			   &hash) < 0) {
+		FREE_NULL_BUFFER(buf);
+		return;
+	}
+	FREE_NULL_BUFFER(buf);
+
+	shared = _batch_file_path(name, &hash);
+	if (!stat(shared, &shared_stat) &&
+	    (shared_stat.st_dev == job_stat.st_dev) &&
+	    (shared_stat.st_ino == job_stat.st_ino))
+		(void) unlink(shared);
+	xfree(shared);
+}
+
 /*
  * delete_job_desc_files - delete job descriptor related files
  *
@@ -695,14 +863,22 @@ static job_record_t *_create_job_record(uint32_t num_jobs, bool list_add)
  */
 extern void delete_job_desc_files(uint32_t job_id)
 {
-	char *dir_name = NULL, *file_name = NULL;
+	char *dir_name = NULL;
 	int hash = job_id % 10;
-	DIR *f_dir;
-	struct dirent *dir_ent;
 
 	dir_name = xstrdup_printf("%s/hash.%d/job.%u",
 	                          slurm_conf.state_save_location,
 	                          hash, job_id);
+	_delete_job_desc_dir(dir_name);
+	xfree(dir_name);
+}
+
+/* Remove a job's batch file directory, releasing any shared batch files */
+static void _delete_job_desc_dir(char *dir_name)
+{
+	char *file_name = NULL;
+	DIR *f_dir;
+	struct dirent *dir_ent;
 
 	f_dir = opendir(dir_name);
 	if (f_dir) {
@@ -712,19 +888,18 @@ extern void delete_job_desc_files(uint32_t job_id)
 				continue;
 			xstrfmtcat(file_name, "%s/%s", dir_name,
 				   dir_ent->d_name);
+			_release_batch_file(file_name, dir_ent->d_name);
 			(void) unlink(file_name);
 			xfree(file_name);
 		}
 		closedir(f_dir);
 	} else if (errno == ENOENT) {
-		xfree(dir_name);
 		return;
 	} else {
 		error("opendir(%s): %m", dir_name);
 	}
 
 	(void) rmdir(dir_name);
-	xfree(dir_name);
 }
 
 static uint32_t _max_switch_wait(uint32_t input_wait)
@@ -809,6 +984,92 @@ static slurmdb_qos_rec_t *_determine_and_validate_qos(
 	return qos_ptr;
 }
 
+static int _foreach_journal_job(void *x, void *arg)
+{
+	job_record_t *job_ptr = x;
+	journal_args_t *args = arg;
+
+	if (job_journal_batch_add_job(args->buffer, job_ptr))
+		args->rec_cnt++;
+
+	return 0;
+}
+
+static int _foreach_snapshot_job(void *x, void *arg)
+{
+	job_record_t *job_ptr = x;
+	journal_args_t *args = arg;
+	uint32_t len_offset = get_buf_offset(args->buffer), offset, end;
+
+	/* Length prefix lets load_all_job_state() unpack jobs in parallel */
+	pack32(0, args->buffer);
+	offset = get_buf_offset(args->buffer);
+	job_mgr_dump_job_state(job_ptr, args->buffer);
+	end = get_buf_offset(args->buffer);
+	if (end == offset) {
+		set_buf_offset(args->buffer, len_offset);
+		return 0;
+	}
+
+	if (args->journal)
+		job_journal_snapshot_job(args->buffer, offset, job_ptr);
+
+	set_buf_offset(args->buffer, len_offset);
+	pack32(end - offset, args->buffer);
+	set_buf_offset(args->buffer, end);
+	args->rec_cnt++;
+
+	return 0;
+}
+
+/*
+ * Append the jobs which changed since the last save to the job state journal
+ * instead of writing the whole job_state file
+ * IN/OUT error_code - set if the journal was written
+ * RET false if a new job_state snapshot must be written instead
+ */
+static bool _dump_job_state_journal(int *error_code)
+{
+	slurmctld_lock_t job_read_lock =
+		{ READ_LOCK, READ_LOCK, NO_LOCK, NO_LOCK, NO_LOCK };
+	journal_args_t args = { 0 };
+	uint32_t *job_id;
+
+	lock_slurmctld(job_read_lock);
+	/* Compact the journal once it reaches half the snapshot size */
+	if (!xstrcasestr(slurm_conf.slurmctld_params,
+			 "enable_job_state_journal") ||
+	    !last_file_write_time ||
+	    (job_journal_size() > (last_job_state_size / 2))) {
+		unlock_slurmctld(job_read_lock);
+		return false;
+	}
+
+	verify_job_state_cache_synced();
+
+	args.buffer = init_buf(BUF_SIZE);
+	job_journal_batch_init(args.buffer, job_id_sequence,
+			       slurmctld_diag_stats.bf_when_last_cycle);
+	list_for_each_ro(job_list, _foreach_journal_job, &args);
+	while ((job_id = list_dequeue(journal_purge_list))) {
+		job_journal_batch_add_purge(args.buffer, *job_id);
+		args.rec_cnt++;
+		xfree(job_id);
+	}
+	unlock_slurmctld(job_read_lock);
+
+	if (args.rec_cnt) {
+		job_journal_batch_fini(args.buffer, args.rec_cnt);
+		lock_state_file(STATE_FILE_JOB);
+		*error_code = job_journal_append(args.buffer);
+		unlock_state_file(STATE_FILE_JOB);
+	}
+	debug3("%s: journaled %u job state changes", __func__, args.rec_cnt);
+
+	FREE_NULL_BUFFER(args.buffer);
+	return true;
+}
+
 /*
  * dump_all_job_state - save the state of all jobs to file for checkpoint
  *	Changes here should be reflected in load_last_job_id() and
@@ -830,6 +1091,7 @@ int dump_all_job_state(void)
 	time_t last_state_file_time;
 	static time_t last_job_state_size_check = 0;
 	uint32_t jobs_start, jobs_end, jobs_count;
+	journal_args_t args = { 0 };
 	DEF_TIMERS;
 
 	START_TIMER;
@@ -852,6 +1114,12 @@ int dump_all_job_state(void)
 		}
 	}
 
+	if (_dump_job_state_journal(&error_code)) {
+		FREE_NULL_BUFFER(buffer);
+		END_TIMER2(__func__);
+		return error_code;
+	}
+
 	/* write header: version, time */
 	packstr(JOB_STATE_VERSION, buffer);
 	pack16(SLURM_PROTOCOL_VERSION, buffer);
@@ -874,8 +1142,14 @@ int dump_all_job_state(void)
 
 	pack_time(slurmctld_diag_stats.bf_when_last_cycle, buffer);
 
+	/* The new snapshot already covers all purged jobs */
+	args.buffer = buffer;
+	args.journal = xstrcasestr(slurm_conf.slurmctld_params,
+				   "enable_job_state_journal");
+	list_flush(journal_purge_list);
+
 	jobs_start = get_buf_offset(buffer);
-	list_for_each_ro(job_list, job_mgr_dump_job_state, buffer);
+	list_for_each_ro(job_list, _foreach_snapshot_job, &args);
 	jobs_end = get_buf_offset(buffer);
 	if ((difftime(now, last_job_state_size_check) > 60) &&
 	    (jobs_count = list_count(job_list))) {
@@ -922,7 +1196,7 @@ int dump_all_job_state(void)
 		last_mtime = time(NULL);
 	}
 
-	lock_state_files();
+	lock_state_file(STATE_FILE_JOB);
 	log_fd = open(new_file, O_CREAT|O_WRONLY|O_TRUNC|O_CLOEXEC, 0600);
 	if (log_fd < 0) {
 		error("Can't save state, create file %s error %m",
@@ -963,11 +1237,20 @@ int dump_all_job_state(void)
 			       new_file, reg_file);
 		(void) unlink(new_file);
 		last_file_write_time = now;
+		last_job_state_size = get_buf_offset(buffer);
 	}
+
+	/* Start a journal relative to the new snapshot */
+	if (error_code)
+		job_journal_invalidate();
+	else if (!args.journal)
+		job_journal_remove();
+	else if (job_journal_reset(now))
+		error("Unable to create job state journal, every save will write the job_state file");
 	xfree(old_file);
 	xfree(reg_file);
 	xfree(new_file);
-	unlock_state_files();
+	unlock_state_file(STATE_FILE_JOB);
 
 	FREE_NULL_BUFFER(buffer);
 	END_TIMER2(__func__);
@@ -1031,14 +1314,14 @@ static buf_t *_open_job_state_file(char **state_file)
 	*state_file = xstrdup_printf("%s/job_state",
 	                             slurm_conf.state_save_location);
 
-	if (!(buf = create_mmap_buf(*state_file)))
+	if (!(buf = state_file_open(*state_file)))
 		error("Could not open job state file %s: %m", *state_file);
 	else
 		return buf;
 
 	error("NOTE: Trying backup state save file. Jobs may be lost!");
 	xstrcat(*state_file, ".old");
-	return create_mmap_buf(*state_file);
+	return state_file_open(*state_file);
 }
 
 extern void set_job_failed_assoc_qos_ptr(job_record_t *job_ptr)
@@ -1158,6 +1441,125 @@ unpack_error:
 	return buf_time;
 }
 
+static void *_unpack_jobs_thread(void *arg)
+{
+	job_unpack_thread_t *thread = arg;
+	job_unpack_args_t *args = thread->args;
+
+	for (uint32_t i = thread->thread_inx; i < args->rec_cnt;
+	     i += args->thread_cnt) {
+		buf_t *buffer = create_shadow_buf(&args->data[args->offset[i]],
+						  args->length[i]);
+
+		if (job_record_unpack(&args->job[i], slurmctld_tres_cnt,
+				      buffer, args->protocol_version))
+			args->job[i] = NULL;
+		else if (remaining_buf(buffer))
+			error("%s: %pJ state record has %u trailing bytes",
+			      __func__, args->job[i], remaining_buf(buffer));
+		FREE_NULL_BUFFER(buffer);
+	}
+
+	return NULL;
+}
+
+/*
+ * Unpack the length prefixed job records remaining in the job_state file
+ * across a set of threads then add them to the job list in file order.
+ * Resolving partitions, associations, QOS, dependencies, job arrays and
+ * heterogeneous jobs needs the job list and is left to this thread.
+ * IN superseded - skip jobs with newer state in this journal, may be NULL
+ * OUT job_cnt - incremented by the number of records loaded
+ * RET SLURM_SUCCESS or SLURM_ERROR if any record is incomplete
+ */
+static int _load_job_states(buf_t *buffer, uint16_t protocol_version,
+			    job_journal_t *superseded, int *job_cnt)
+{
+	job_unpack_args_t args = {
+		.data = get_buf_data(buffer),
+		.protocol_version = protocol_version,
+	};
+	job_unpack_thread_t *threads;
+	pthread_t *thread_ids;
+	uint32_t alloc_cnt = 0, length, i;
+	int cpu_cnt, rc = SLURM_SUCCESS, scan_rc = SLURM_SUCCESS;
+	DEF_TIMERS;
+
+	START_TIMER;
+	/* Build the record offset table */
+	while (remaining_buf(buffer) > 0) {
+		safe_unpack32(&length, buffer);
+		if (length > remaining_buf(buffer))
+			goto unpack_error;
+		if (args.rec_cnt == alloc_cnt) {
+			alloc_cnt = MAX(1024, (alloc_cnt * 2));
+			xrecalloc(args.offset, alloc_cnt, sizeof(*args.offset));
+			xrecalloc(args.length, alloc_cnt, sizeof(*args.length));
+		}
+		args.offset[args.rec_cnt] = get_buf_offset(buffer);
+		args.length[args.rec_cnt] = length;
+		args.rec_cnt++;
+		set_buf_offset(buffer, (get_buf_offset(buffer) + length));
+	}
+	goto unpack;
+
+unpack_error:
+	scan_rc = SLURM_ERROR;
+
+unpack:
+	if ((cpu_cnt = sysconf(_SC_NPROCESSORS_ONLN)) < 1)
+		cpu_cnt = 1;
+	args.thread_cnt = MIN(cpu_cnt, MAX_JOB_UNPACK_THREADS);
+	args.thread_cnt = MIN(args.thread_cnt,
+			      ROUNDUP(args.rec_cnt, JOB_UNPACK_THREAD_MIN_RECS));
+	args.thread_cnt = MAX(args.thread_cnt, 1);
+	args.job = xcalloc(MAX(args.rec_cnt, 1), sizeof(*args.job));
+	threads = xcalloc(args.thread_cnt, sizeof(*threads));
+	thread_ids = xcalloc(args.thread_cnt, sizeof(*thread_ids));
+
+	for (i = 0; i < args.thread_cnt; i++) {
+		threads[i].args = &args;
+		threads[i].thread_inx = i;
+		if (i)
+			slurm_thread_create(&thread_ids[i],
+					    _unpack_jobs_thread, &threads[i]);
+	}
+	_unpack_jobs_thread(&threads[0]);
+	for (i = 1; i < args.thread_cnt; i++)
+		slurm_thread_join(thread_ids[i]);
+	END_TIMER2(__func__);
+	debug("%s: unpacked %u job records with %d threads %s",
+	      __func__, args.rec_cnt, args.thread_cnt, TIME_STR);
+
+	/* Stop at the first bad record as the serial load does */
+	for (i = 0; (i < args.rec_cnt) && !rc; i++) {
+		job_record_t *job_ptr = args.job[i];
+
+		args.job[i] = NULL;
+		if (!job_ptr) {
+			error("failed to load job from state");
+			rc = SLURM_ERROR;
+		} else if (_load_job_record(job_ptr, superseded)) {
+			rc = SLURM_ERROR;
+		} else {
+			(*job_cnt)++;
+		}
+	}
+	for (; i < args.rec_cnt; i++)
+		job_record_delete(args.job[i]);
+	if (!rc && scan_rc) {
+		error("Incomplete job record");
+		rc = scan_rc;
+	}
+
+	xfree(args.job);
+	xfree(args.length);
+	xfree(args.offset);
+	xfree(threads);
+	xfree(thread_ids);
+	return rc;
+}
+
 /*
  * load_all_job_state - load the job state from file, recover from last
  *	checkpoint. Execute this after loading the configuration file data.
@@ -1167,24 +1569,25 @@ unpack_error:
 extern int load_all_job_state(void)
 {
 	int error_code = SLURM_SUCCESS;
-	int job_cnt = 0;
+	int job_cnt = 0, journal_cnt;
 	char *state_file = NULL;
 	buf_t *buffer;
-	time_t buf_time;
+	time_t buf_time, snapshot_time;
 	uint32_t saved_job_id;
 	char *ver_str = NULL;
 	uint16_t protocol_version = NO_VAL16;
+	job_journal_t *journal = NULL;
 
 	/* read the file */
-	lock_state_files();
+	lock_state_file(STATE_FILE_JOB);
 	if (!(buffer = _open_job_state_file(&state_file))) {
 		info("No job state file (%s) to recover", state_file);
 		xfree(state_file);
-		unlock_state_files();
+		unlock_state_file(STATE_FILE_JOB);
 		return ENOENT;
 	}
 	xfree(state_file);
-	unlock_state_files();
+	unlock_state_file(STATE_FILE_JOB);
 
 	job_id_sequence = MAX(job_id_sequence, slurm_conf.first_job_id);
 
@@ -1204,13 +1607,21 @@ extern int load_all_job_state(void)
 		return EFAULT;
 	}
 
-	safe_unpack_time(&buf_time, buffer);
+	safe_unpack_time(&snapshot_time, buffer);
 	safe_unpack32(&saved_job_id, buffer);
-	if (saved_job_id <= slurm_conf.max_job_id)
-		job_id_sequence = MAX(saved_job_id, job_id_sequence);
 	debug3("Job id in job_state header is %u", saved_job_id);
 
 	safe_unpack_time(&buf_time, buffer); /* bf_when_last_cycle */
+
+	/* Changes saved after the snapshot override its header and jobs */
+	lock_state_file(STATE_FILE_JOB);
+	journal = job_journal_load(snapshot_time);
+	unlock_state_file(STATE_FILE_JOB);
+	if (journal)
+		job_journal_get_header(journal, &saved_job_id, &buf_time);
+
+	if (saved_job_id <= slurm_conf.max_job_id)
+		job_id_sequence = MAX(saved_job_id, job_id_sequence);
 	if (!slurmctld_diag_stats.bf_when_last_cycle)
 		slurmctld_diag_stats.bf_when_last_cycle = buf_time;
 
@@ -1221,11 +1632,28 @@ extern int load_all_job_state(void)
 	 * It ended up being much easier to move the locks for the assoc_mgr
 	 * into the job_mgr_load_job_state function than any other option.
 	 */
-	while (remaining_buf(buffer) > 0) {
-		error_code = job_mgr_load_job_state(buffer, protocol_version);
+	if (protocol_version >= SLURM_24_11_PROTOCOL_VERSION) {
+		error_code = _load_job_states(buffer, protocol_version,
+					      journal, &job_cnt);
 		if (error_code != SLURM_SUCCESS)
 			goto unpack_error;
-		job_cnt++;
+	} else {
+		while (remaining_buf(buffer) > 0) {
+			error_code = _load_job_state(buffer, protocol_version,
+						     journal);
+			if (error_code != SLURM_SUCCESS)
+				goto unpack_error;
+			job_cnt++;
+		}
+	}
+
+	if (journal) {
+		journal_cnt = job_journal_replay(journal,
+						 job_mgr_load_job_state);
+		if (journal_cnt < 0)
+			goto unpack_error;
+		job_cnt += journal_cnt;
+		job_journal_free(journal);
 	}
 	debug3("Set job_id_sequence to %u", job_id_sequence);
 
@@ -1238,6 +1666,7 @@ unpack_error:
 		fatal("Incomplete job state save file, start with '-i' to ignore this. Warning: using -i will lose the data that can't be recovered.");
 	error("Incomplete job state save file");
 	info("Recovered information about %d jobs", job_cnt);
+	job_journal_free(journal);
 	FREE_NULL_BUFFER(buffer);
 	return SLURM_ERROR;
 }
@@ -1251,20 +1680,21 @@ extern int load_last_job_id( void )
 {
 	char *state_file = NULL;
 	buf_t *buffer;
+	job_journal_t *journal;
 	time_t buf_time;
 	char *ver_str = NULL;
 	uint16_t protocol_version = NO_VAL16;
 
 	/* read the file */
-	lock_state_files();
+	lock_state_file(STATE_FILE_JOB);
 	if (!(buffer = _open_job_state_file(&state_file))) {
 		debug("No job state file (%s) to recover", state_file);
 		xfree(state_file);
-		unlock_state_files();
+		unlock_state_file(STATE_FILE_JOB);
 		return ENOENT;
 	}
 	xfree(state_file);
-	unlock_state_files();
+	unlock_state_file(STATE_FILE_JOB);
 
 	safe_unpackstr(&ver_str, buffer);
 	debug3("Version string in job_state header is %s", ver_str);
@@ -1286,6 +1716,16 @@ extern int load_last_job_id( void )
 	safe_unpack32( &job_id_sequence, buffer);
 	debug3("Job ID in job_state header is %u", job_id_sequence);
 
+	lock_state_file(STATE_FILE_JOB);
+	if ((journal = job_journal_load(buf_time))) {
+		time_t bf_when_last_cycle;
+
+		job_journal_get_header(journal, &job_id_sequence,
+				       &bf_when_last_cycle);
+		job_journal_free(journal);
+	}
+	unlock_state_file(STATE_FILE_JOB);
+
 	/* Ignore the state for individual jobs stored here */
 
 	xfree(ver_str);
@@ -1321,12 +1761,16 @@ extern int job_mgr_dump_job_state(void *object, void *arg)
 	return 0;
 }
 
-extern int job_mgr_load_job_state(buf_t *buffer,
-				  uint16_t protocol_version)
+/*
+ * Add a job record unpacked from the state file to the job list and validate
+ * it against the current configuration
+ * IN job_ptr - unpacked record, consumed
+ * IN superseded - skip jobs with newer state in this journal, may be NULL
+ */
+static int _load_job_record(job_record_t *job_ptr, job_journal_t *superseded)
 {
 	time_t now = time(NULL);
 	list_t *part_ptr_list = NULL;
-	job_record_t *job_ptr = NULL;
 	part_record_t *part_ptr;
 	int qos_error, rc;
 	slurmdb_assoc_rec_t assoc_rec;
@@ -1339,10 +1783,11 @@ extern int job_mgr_load_job_state(buf_t *buffer,
 		.user = READ_LOCK
 	};
 
-	if (job_record_unpack(&job_ptr, slurmctld_tres_cnt, buffer,
-			      protocol_version)) {
-		error("failed to load job from state");
-		goto unpack_error;
+	if (superseded &&
+	    job_journal_supersedes(superseded, job_ptr->job_id)) {
+		debug2("%pJ state recovered from journal", job_ptr);
+		job_record_delete(job_ptr);
+		return SLURM_SUCCESS;
 	}
 
 	if (find_job_record(job_ptr->job_id)) {
@@ -1558,6 +2003,30 @@ free_it:
 	return rc;
 }
 
+/*
+ * IN superseded - skip jobs with newer state in this journal, may be NULL
+ */
+static int _load_job_state(buf_t *buffer, uint16_t protocol_version,
+			   job_journal_t *superseded)
+{
+	job_record_t *job_ptr = NULL;
+
+	if (job_record_unpack(&job_ptr, slurmctld_tres_cnt, buffer,
+			      protocol_version)) {
+		error("failed to load job from state");
+		error("Incomplete job record");
+		return SLURM_ERROR;
+	}
+
+	return _load_job_record(job_ptr, superseded);
+}
+
+extern int job_mgr_load_job_state(buf_t *buffer,
+				  uint16_t protocol_version)
+{
+	return _load_job_state(buffer, protocol_version, NULL);
+}
+
 /* _add_job_hash - add a job hash entry for given job record, job_id must
  *	already be set
  * IN job_ptr - pointer to job record
@@ -1565,11 +2034,41 @@ free_it:
  */
 static void _add_job_hash(job_record_t *job_ptr)
 {
-	int inx;
+	job_index_insert(job_hash, job_ptr->job_id, job_ptr);
+}
 
-	inx = JOB_HASH_INX(job_ptr->job_id);
-	job_ptr->job_next = job_hash[inx];
-	job_hash[inx] = job_ptr;
+/*
+ * Unlink job_entry from the job_array_next_j list of its job array
+ * RET true if found
+ */
+static bool _remove_job_array_list(job_record_t *job_entry)
+{
+	job_record_t *job_ptr, **job_pptr;
+
+	job_ptr = job_index_find(job_array_hash_j, job_entry->array_job_id);
+	if (job_ptr == job_entry) {
+		if (job_entry->job_array_next_j)
+			job_index_insert(job_array_hash_j,
+					 job_entry->array_job_id,
+					 job_entry->job_array_next_j);
+		else
+			job_index_remove(job_array_hash_j,
+					 job_entry->array_job_id, job_entry);
+		job_entry->job_array_next_j = NULL;
+		return true;
+	}
+
+	for (job_pptr = (job_ptr ? &job_ptr->job_array_next_j : NULL);
+	     job_pptr && *job_pptr; job_pptr = &(*job_pptr)->job_array_next_j) {
+		xassert((*job_pptr)->magic == JOB_MAGIC);
+		if (*job_pptr == job_entry) {
+			*job_pptr = job_entry->job_array_next_j;
+			job_entry->job_array_next_j = NULL;
+			return true;
+		}
+	}
+
+	return false;
 }
 
 /* _remove_job_hash - remove a job hash entry for given job record, job_id must
@@ -1580,82 +2079,40 @@ static void _add_job_hash(job_record_t *job_ptr)
  */
 static void _remove_job_hash(job_record_t *job_entry, job_hash_type_t type)
 {
-	job_record_t *job_ptr, **job_pptr;
-
 	xassert(job_entry);
 
 	on_job_state_change(job_entry, NO_VAL);
 
 	switch (type) {
 	case JOB_HASH_JOB:
-		job_pptr = &job_hash[JOB_HASH_INX(job_entry->job_id)];
+		if (job_index_remove(job_hash, job_entry->job_id, job_entry) ||
+		    (job_entry->job_id == NO_VAL))
+			return;
+		error("%s: Could not find hash entry for JobId=%u",
+		      __func__, job_entry->job_id);
 		break;
 	case JOB_HASH_ARRAY_JOB:
-		job_pptr = &job_array_hash_j[
-			JOB_HASH_INX(job_entry->array_job_id)];
+		if (_remove_job_array_list(job_entry) ||
+		    (job_entry->job_id == NO_VAL))
+			return;
+		error("%s: job array hash error %u", __func__,
+		      job_entry->array_job_id);
 		break;
 	case JOB_HASH_ARRAY_TASK:
-		job_pptr = &job_array_hash_t[
-			JOB_ARRAY_HASH_INX(job_entry->array_job_id,
-					   job_entry->array_task_id)];
+		if (job_index_remove(job_array_hash_t,
+				     JOB_ARRAY_TASK_KEY(
+					     job_entry->array_job_id,
+					     job_entry->array_task_id),
+				     job_entry) ||
+		    (job_entry->job_id == NO_VAL))
+			return;
+		error("%s: job array, task ID hash error %u_%u",
+		      __func__,
+		      job_entry->array_job_id,
+		      job_entry->array_task_id);
 		break;
 	default:
 		fatal("%s: unknown job_hash_type_t %d", __func__, type);
-		return;
-	}
-
-	while ((job_pptr != NULL) && (*job_pptr != NULL) &&
-	       ((job_ptr = *job_pptr) != job_entry)) {
-		xassert(job_ptr->magic == JOB_MAGIC);
-		switch (type) {
-		case JOB_HASH_JOB:
-			job_pptr = &job_ptr->job_next;
-			break;
-		case JOB_HASH_ARRAY_JOB:
-			job_pptr = &job_ptr->job_array_next_j;
-			break;
-		case JOB_HASH_ARRAY_TASK:
-			job_pptr = &job_ptr->job_array_next_t;
-			break;
-		}
-	}
-
-	if (job_pptr == NULL || *job_pptr == NULL) {
-		if (job_entry->job_id == NO_VAL)
-			return;
-
-		switch (type) {
-		case JOB_HASH_JOB:
-			error("%s: Could not find hash entry for JobId=%u",
-			      __func__, job_entry->job_id);
-			break;
-		case JOB_HASH_ARRAY_JOB:
-			error("%s: job array hash error %u", __func__,
-			      job_entry->array_job_id);
-			break;
-		case JOB_HASH_ARRAY_TASK:
-			error("%s: job array, task ID hash error %u_%u",
-			      __func__,
-			      job_entry->array_job_id,
-			      job_entry->array_task_id);
-			break;
-		}
-		return;
-	}
-
-	switch (type) {
-	case JOB_HASH_JOB:
-		*job_pptr = job_entry->job_next;
-		job_entry->job_next = NULL;
-		break;
-	case JOB_HASH_ARRAY_JOB:
-		*job_pptr = job_entry->job_array_next_j;
-		job_entry->job_array_next_j = NULL;
-		break;
-	case JOB_HASH_ARRAY_TASK:
-		*job_pptr = job_entry->job_array_next_t;
-		job_entry->job_array_next_t = NULL;
-		break;
 	}
 }
 
@@ -1666,20 +2123,19 @@ static void _remove_job_hash(job_record_t *job_entry, job_hash_type_t type)
  */
 void _add_job_array_hash(job_record_t *job_ptr)
 {
-	int inx;
-
 	if (job_ptr->array_task_id == NO_VAL)
 		return;	/* Not a job array */
 
 	xassert(verify_lock(JOB_LOCK, WRITE_LOCK));
 
-	inx = JOB_HASH_INX(job_ptr->array_job_id);
-	job_ptr->job_array_next_j = job_array_hash_j[inx];
-	job_array_hash_j[inx] = job_ptr;
+	job_ptr->job_array_next_j = job_index_find(job_array_hash_j,
+						   job_ptr->array_job_id);
+	job_index_insert(job_array_hash_j, job_ptr->array_job_id, job_ptr);
 
-	inx = JOB_ARRAY_HASH_INX(job_ptr->array_job_id,job_ptr->array_task_id);
-	job_ptr->job_array_next_t = job_array_hash_t[inx];
-	job_array_hash_t[inx] = job_ptr;
+	job_index_insert(job_array_hash_t,
+			 JOB_ARRAY_TASK_KEY(job_ptr->array_job_id,
+					    job_ptr->array_task_id),
+			 job_ptr);
 }
 
 /* For the job array data structure, build the string representation of the
@@ -1723,7 +2179,6 @@ extern void build_array_str(job_record_t *job_ptr)
 extern bool test_job_array_complete(uint32_t array_job_id)
 {
 	job_record_t *job_ptr;
-	int inx;
 
 	job_ptr = find_job_record(array_job_id);
 	if (job_ptr) {
@@ -1734,8 +2189,7 @@ extern bool test_job_array_complete(uint32_t array_job_id)
 	}
 
 	/* Need to test individual job array records */
-	inx = JOB_HASH_INX(array_job_id);
-	job_ptr = job_array_hash_j[inx];
+	job_ptr = job_index_find(job_array_hash_j, array_job_id);
 	while (job_ptr) {
 		if (job_ptr->array_job_id == array_job_id) {
 			if (!IS_JOB_COMPLETE(job_ptr))
@@ -1750,7 +2204,6 @@ extern bool test_job_array_complete(uint32_t array_job_id)
 extern bool test_job_array_completed(uint32_t array_job_id)
 {
 	job_record_t *job_ptr;
-	int inx;
 
 	job_ptr = find_job_record(array_job_id);
 	if (job_ptr) {
@@ -1759,8 +2212,7 @@ extern bool test_job_array_completed(uint32_t array_job_id)
 	}
 
 	/* Need to test individual job array records */
-	inx = JOB_HASH_INX(array_job_id);
-	job_ptr = job_array_hash_j[inx];
+	job_ptr = job_index_find(job_array_hash_j, array_job_id);
 	while (job_ptr) {
 		if (job_ptr->array_job_id == array_job_id) {
 			if (!IS_JOB_COMPLETED(job_ptr))
@@ -1778,7 +2230,6 @@ extern bool test_job_array_completed(uint32_t array_job_id)
 static bool _test_job_array_purged(uint32_t array_job_id)
 {
 	job_record_t *job_ptr, *head_job_ptr;
-	int inx;
 
 	head_job_ptr = find_job_record(array_job_id);
 	if (head_job_ptr) {
@@ -1787,8 +2238,7 @@ static bool _test_job_array_purged(uint32_t array_job_id)
 	}
 
 	/* Need to test individual job array records */
-	inx = JOB_HASH_INX(array_job_id);
-	job_ptr = job_array_hash_j[inx];
+	job_ptr = job_index_find(job_array_hash_j, array_job_id);
 	while (job_ptr) {
 		if ((job_ptr->array_job_id == array_job_id) &&
 		    (job_ptr != head_job_ptr)) {
@@ -1803,7 +2253,6 @@ static bool _test_job_array_purged(uint32_t array_job_id)
 extern bool test_job_array_finished(uint32_t array_job_id)
 {
 	job_record_t *job_ptr;
-	int inx;
 
 	job_ptr = find_job_record(array_job_id);
 	if (job_ptr) {
@@ -1812,8 +2261,7 @@ extern bool test_job_array_finished(uint32_t array_job_id)
 	}
 
 	/* Need to test individual job array records */
-	inx = JOB_HASH_INX(array_job_id);
-	job_ptr = job_array_hash_j[inx];
+	job_ptr = job_index_find(job_array_hash_j, array_job_id);
 	while (job_ptr) {
 		if (job_ptr->array_job_id == array_job_id) {
 			if (!IS_JOB_FINISHED(job_ptr))
@@ -1829,7 +2277,6 @@ extern bool test_job_array_finished(uint32_t array_job_id)
 extern bool test_job_array_pending(uint32_t array_job_id)
 {
 	job_record_t *job_ptr;
-	int inx;
 
 	job_ptr = find_job_record(array_job_id);
 	if (job_ptr) {
@@ -1840,8 +2287,7 @@ extern bool test_job_array_pending(uint32_t array_job_id)
 	}
 
 	/* Need to test individual job array records */
-	inx = JOB_HASH_INX(array_job_id);
-	job_ptr = job_array_hash_j[inx];
+	job_ptr = job_index_find(job_array_hash_j, array_job_id);
 	while (job_ptr) {
 		if (job_ptr->array_job_id == array_job_id) {
 			if (IS_JOB_PENDING(job_ptr))
@@ -1852,15 +2298,53 @@ extern bool test_job_array_pending(uint32_t array_job_id)
 	return false;
 }
 
+/*
+ * Test test_job_array_complete(), test_job_array_completed() and
+ * test_job_array_pending() in a single walk of the array's task records.
+ */
+extern void test_job_array_state(uint32_t array_job_id, bool *complete,
+				 bool *completed, bool *pending)
+{
+	job_record_t *job_ptr;
+
+	*complete = *completed = true;
+	*pending = false;
+
+	job_ptr = find_job_record(array_job_id);
+	if (job_ptr) {
+		if (!IS_JOB_COMPLETE(job_ptr) ||
+		    (job_ptr->array_recs && job_ptr->array_recs->max_exit_code))
+			*complete = false;
+		if (!IS_JOB_COMPLETED(job_ptr))
+			*completed = false;
+		if (IS_JOB_PENDING(job_ptr) ||
+		    (job_ptr->array_recs && job_ptr->array_recs->task_cnt))
+			*pending = true;
+	}
+
+	/* Need to test individual job array records */
+	job_ptr = job_index_find(job_array_hash_j, array_job_id);
+	while (job_ptr && (*complete || *completed || !*pending)) {
+		if (job_ptr->array_job_id == array_job_id) {
+			if (!IS_JOB_COMPLETE(job_ptr))
+				*complete = false;
+			if (!IS_JOB_COMPLETED(job_ptr))
+				*completed = false;
+			if (IS_JOB_PENDING(job_ptr))
+				*pending = true;
+		}
+		job_ptr = job_ptr->job_array_next_j;
+	}
+}
+
 /* For a given job ID return the number of PENDING tasks which have their
  * own separate job_record (do not count tasks in pending META job record) */
 extern int num_pending_job_array_tasks(uint32_t array_job_id)
 {
 	job_record_t *job_ptr;
-	int count = 0, inx;
+	int count = 0;
 
-	inx = JOB_HASH_INX(array_job_id);
-	job_ptr = job_array_hash_j[inx];
+	job_ptr = job_index_find(job_array_hash_j, array_job_id);
 	while (job_ptr) {
 		if ((job_ptr->array_job_id == array_job_id) &&
 		    IS_JOB_PENDING(job_ptr))
@@ -1940,10 +2424,8 @@ static int _foreach_by_het_job(void *x, void *arg)
 static job_record_t *_find_first_job_array_rec(uint32_t array_job_id)
 {
 	job_record_t *job_ptr;
-	int inx;
 
-	inx = JOB_HASH_INX(array_job_id);
-	job_ptr = job_array_hash_j[inx];
+	job_ptr = job_index_find(job_array_hash_j, array_job_id);
 	while (job_ptr) {
 		if (job_ptr->array_job_id == array_job_id)
 			return job_ptr;
@@ -2256,8 +2738,7 @@ extern job_record_t *find_job_array_rec(uint32_t array_job_id,
 		    (job_ptr->array_job_id == array_job_id))
 			return job_ptr;
 
-		inx = JOB_HASH_INX(array_job_id);
-		job_ptr = job_array_hash_j[inx];
+		job_ptr = job_index_find(job_array_hash_j, array_job_id);
 		while (job_ptr) {
 			if (job_ptr->array_job_id == array_job_id) {
 				match_job_ptr = job_ptr;
@@ -2269,15 +2750,11 @@ extern job_record_t *find_job_array_rec(uint32_t array_job_id,
 		}
 		return match_job_ptr;
 	} else {		/* Find specific task ID */
-		inx = JOB_ARRAY_HASH_INX(array_job_id, array_task_id);
-		job_ptr = job_array_hash_t[inx];
-		while (job_ptr) {
-			if ((job_ptr->array_job_id == array_job_id) &&
-			    (job_ptr->array_task_id == array_task_id)) {
-				return job_ptr;
-			}
-			job_ptr = job_ptr->job_array_next_t;
-		}
+		job_ptr = job_index_find(job_array_hash_t,
+					 JOB_ARRAY_TASK_KEY(array_job_id,
+							    array_task_id));
+		if (job_ptr)
+			return job_ptr;
 		/* Look for job record with all of the pending tasks */
 		job_ptr = find_job_record(array_job_id);
 		if (job_ptr && job_ptr->array_recs &&
@@ -2305,13 +2782,7 @@ extern job_record_t *find_het_job_record(uint32_t job_id,
 	job_record_t *het_job_leader, *het_job;
 	list_itr_t *iter;
 
-	het_job_leader = job_hash[JOB_HASH_INX(job_id)];
-	while (het_job_leader) {
-		if (het_job_leader->job_id == job_id)
-			break;
-		het_job_leader = het_job_leader->job_next;
-	}
-	if (!het_job_leader)
+	if (!(het_job_leader = job_index_find(job_hash, job_id)))
 		return NULL;
 	if (het_job_leader->het_job_offset == het_job_offset)
 		return het_job_leader;
@@ -2340,16 +2811,7 @@ extern job_record_t *find_het_job_record(uint32_t job_id,
  */
 extern job_record_t *find_job_record(uint32_t job_id)
 {
-	job_record_t *job_ptr;
-
-	job_ptr = job_hash[JOB_HASH_INX(job_id)];
-	while (job_ptr) {
-		if (job_ptr->job_id == job_id)
-			return job_ptr;
-		job_ptr = job_ptr->job_next;
-	}
-
-	return NULL;
+	return job_index_find(job_hash, job_id);
 }
 
 /*
@@ -3281,6 +3743,12 @@ void init_job_conf(void)
 
 	if (!purge_jobs_list)
 		purge_jobs_list = list_create(job_record_delete);
+
+	if (!journal_purge_list)
+		journal_purge_list = list_create(xfree_ptr);
+
+	if (!job_tombstone_list)
+		job_tombstone_list = list_create(xfree_ptr);
 }
 
 /*
@@ -3291,23 +3759,14 @@ extern void rehash_jobs(void)
 	xassert(verify_lock(CONF_LOCK, READ_LOCK));
 	xassert(verify_lock(JOB_LOCK, WRITE_LOCK));
 
+	/* The indexes grow as needed, so MaxJobCount is only a size hint */
 	if (job_hash == NULL) {
-		hash_table_size = slurm_conf.max_job_cnt;
-		job_hash = xcalloc(hash_table_size, sizeof(job_record_t *));
-		job_array_hash_j = xcalloc(hash_table_size,
-					   sizeof(job_record_t *));
-		job_array_hash_t = xcalloc(hash_table_size,
-					   sizeof(job_record_t *));
+		job_hash = job_index_create(slurm_conf.max_job_cnt);
+		job_array_hash_j = job_index_create(0);
+		job_array_hash_t = job_index_create(0);
 		if (xstrcasestr(slurm_conf.sched_params,
 				"enable_job_state_cache"))
-			setup_job_state_hash(hash_table_size);
-	} else if (hash_table_size < (slurm_conf.max_job_cnt / 2)) {
-		/* If the MaxJobCount grows by too much, the hash table will
-		 * be ineffective without rebuilding. We don't presently bother
-		 * to rebuild the hash table, but cut MaxJobCount back as
-		 * needed. */
-		error ("MaxJobCount reset too high, restart slurmctld");
-		slurm_conf.max_job_cnt = hash_table_size;
+			setup_job_state_hash(slurm_conf.max_job_cnt);
 	}
 }
 
@@ -3428,8 +3887,8 @@ extern job_record_t *job_array_split(job_record_t *job_ptr, bool list_add)
 	memcpy(job_ptr_pend->limit_set.tres, job_ptr->limit_set.tres,
 	       sizeof(uint16_t) * slurmctld_tres_cnt);
 
-	_add_job_hash(job_ptr);		/* Sets job_next */
-	_add_job_hash(job_ptr_pend);	/* Sets job_next */
+	_add_job_hash(job_ptr);
+	_add_job_hash(job_ptr_pend);
 	_add_job_array_hash(job_ptr);
 	job_ptr_pend->job_resrcs = NULL;
 
@@ -5284,7 +5743,7 @@ static job_record_t *_find_meta_job_record(uint32_t job_id)
 
 	job_ptr = find_job_record(job_id);
 	if (job_ptr == NULL) {
-		job_ptr = job_array_hash_j[JOB_HASH_INX(job_id)];
+		job_ptr = job_index_find(job_array_hash_j, job_id);
 		while (job_ptr) {
 			if (job_ptr->array_job_id == job_id)
 				break;
@@ -5547,7 +6006,7 @@ extern int job_str_signal(char *job_id_str, uint16_t signal, uint16_t flags,
 		}
 
 		/* Signal all tasks of this job array */
-		job_ptr = job_array_hash_j[JOB_HASH_INX(job_id)];
+		job_ptr = job_index_find(job_array_hash_j, job_id);
 		if (!job_ptr && !job_ptr_done) {
 			info("%s(3): invalid JobId=%u", __func__, job_id);
 			return ESLURM_INVALID_JOB_ID;
@@ -6915,14 +7374,32 @@ static void _enable_stepmgr(job_record_t *job_ptr, job_desc_msg_t *job_desc)
 #ifndef HAVE_FRONT_END
 	static bool first_time = true;
 	static bool stepmgr_enabled = false;
+	static uint32_t stepmgr_min_nodes = 0;
+	bool large_alloc = false;
 
 	if (first_time) {
+		char *tmp_ptr;
+
 		first_time = false;
 		stepmgr_enabled = xstrstr(slurm_conf.slurmctld_params,
 					  "enable_stepmgr");
+		if ((tmp_ptr = xstrcasestr(slurm_conf.slurmctld_params,
+					   "stepmgr_min_nodes=")))
+			stepmgr_min_nodes =
+				strtoul(tmp_ptr + strlen("stepmgr_min_nodes="),
+					NULL, 10);
 	}
 
-	if ((stepmgr_enabled || (job_desc->bitflags & STEPMGR_ENABLED)) &&
+	/*
+	 * Allocations this large launch their steps from many nodes at once,
+	 * so hand their step management to the extern slurmstepd by default.
+	 */
+	if (stepmgr_min_nodes && (job_desc->min_nodes != NO_VAL) &&
+	    (job_desc->min_nodes >= stepmgr_min_nodes))
+		large_alloc = true;
+
+	if ((stepmgr_enabled || large_alloc ||
+	     (job_desc->bitflags & STEPMGR_ENABLED)) &&
 	    (job_desc->het_job_offset == NO_VAL) &&
 	    (job_ptr->start_protocol_ver >= SLURM_24_05_PROTOCOL_VERSION)) {
 		job_ptr->bit_flags |= STEPMGR_ENABLED;
@@ -7779,7 +8256,7 @@ static int
 _copy_job_desc_to_file(job_desc_msg_t * job_desc, uint32_t job_id)
 {
 	int error_code = 0, hash;
-	char *dir_name, *file_name;
+	char *dir_name;
 	DEF_TIMERS;
 
 	START_TIMER;
@@ -7801,6 +8278,24 @@ _copy_job_desc_to_file(job_desc_msg_t * job_desc, uint32_t job_id)
 
 	/* Create job_id specific directory */
 	xstrfmtcat(dir_name, "/job.%u", job_id);
+	if (job_desc->script_stage_dir) {
+		/* Files were written by stage_job_desc_files(), just move them */
+		if (rename(job_desc->script_stage_dir, dir_name)) {
+			if (!slurmctld_primary &&
+			    ((errno == EEXIST) || (errno == ENOTEMPTY))) {
+				error("Apparent duplicate JobId=%u. Two primary slurmctld daemons might currently be active",
+				      job_id);
+			}
+			error("rename(%s, %s) error %m",
+			      job_desc->script_stage_dir, dir_name);
+			error_code = ESLURM_WRITING_TO_FILE;
+		} else {
+			xfree(job_desc->script_stage_dir);
+		}
+		xfree(dir_name);
+		END_TIMER2(__func__);
+		return error_code;
+	}
 	if (mkdir(dir_name, 0700)) {
 		if (!slurmctld_primary && (errno == EEXIST)) {
 			error("Apparent duplicate JobId=%u. Two primary slurmctld daemons might currently be active",
@@ -7811,25 +8306,150 @@ _copy_job_desc_to_file(job_desc_msg_t * job_desc, uint32_t job_id)
 		return ESLURM_WRITING_TO_FILE;
 	}
 
-	/* Create environment file, and write data to it */
+	error_code = _write_job_desc_files(job_desc, dir_name);
+
+	xfree(dir_name);
+	END_TIMER2(__func__);
+	return error_code;
+}
+
+/* Write the environment and script files of a batch job into dir_name */
+static int _write_job_desc_files(job_desc_msg_t *job_desc, char *dir_name)
+{
+	int error_code = 0;
+	char *file_name;
+	slurm_hash_t file_hash;
+	bool shared = false;
+
+	/*
+	 * Create environment file, and write data to it unless another job
+	 * already stored the same environment
+	 */
 	file_name = xstrdup_printf("%s/environment", dir_name);
-	error_code = _write_data_array_to_file(file_name,
-					       job_desc->environment,
-					       job_desc->env_size);
+	if (job_desc->environment &&
+	    _hash_env_file(job_desc->environment, job_desc->env_size,
+			   &file_hash)) {
+		shared = _link_batch_file(file_name, "environment", &file_hash);
+		if (!shared &&
+		    !(error_code = _write_data_array_to_file(
+			      file_name, job_desc->environment,
+			      job_desc->env_size)))
+			_share_batch_file(file_name, "environment", &file_hash);
+	} else {
+		error_code = _write_data_array_to_file(file_name,
+						       job_desc->environment,
+						       job_desc->env_size);
+	}
 	xfree(file_name);
 
 	if (error_code == 0) {
 		/* Create script file */
 		file_name = xstrdup_printf("%s/script", dir_name);
-		error_code = write_data_to_file(file_name, job_desc->script);
+		if (job_desc->script &&
+		    _hash_script_file(job_desc->script, &file_hash)) {
+			shared = _link_batch_file(file_name, "script",
+						  &file_hash);
+			if (!shared &&
+			    !(error_code = write_data_to_file(
+				      file_name, job_desc->script)))
+				_share_batch_file(file_name, "script",
+						  &file_hash);
+		} else {
+			error_code = write_data_to_file(file_name,
+							job_desc->script);
+		}
 		xfree(file_name);
 	}
 
-	xfree(dir_name);
-	END_TIMER2(__func__);
 	return error_code;
 }
 
+#define BATCH_STAGE_DIR "batch_stage"
+
+static char *_batch_stage_path(void)
+{
+	return xstrdup_printf("%s/%s", slurm_conf.state_save_location,
+			      BATCH_STAGE_DIR);
+}
+
+/* Remove directories left by submissions interrupted by a restart */
+static void _purge_batch_stage(void)
+{
+	char *stage_dir = _batch_stage_path(), *dir_name = NULL;
+	DIR *f_dir;
+	struct dirent *dir_ent;
+
+	if (!(f_dir = opendir(stage_dir))) {
+		(void) mkdir(stage_dir, 0700);
+		xfree(stage_dir);
+		return;
+	}
+	while ((dir_ent = readdir(f_dir))) {
+		if (!xstrcmp(dir_ent->d_name, ".") ||
+		    !xstrcmp(dir_ent->d_name, ".."))
+			continue;
+		xstrfmtcat(dir_name, "%s/%s", stage_dir, dir_ent->d_name);
+		_delete_job_desc_dir(dir_name);
+		xfree(dir_name);
+	}
+	closedir(f_dir);
+	xfree(stage_dir);
+}
+
+extern int stage_job_desc_files(job_desc_msg_t *job_desc)
+{
+	static pthread_mutex_t stage_mutex = PTHREAD_MUTEX_INITIALIZER;
+	static bool purged = false;
+	static uint32_t stage_seq = 0;
+	char *dir_name;
+	uint32_t seq;
+	int rc;
+	DEF_TIMERS;
+
+	xassert(!job_desc->script_stage_dir);
+
+	/* Leave errors and unusual jobs to _copy_job_desc_to_file() */
+	if (!job_desc->script || job_desc->container ||
+	    !job_desc->environment || !job_desc->env_size)
+		return SLURM_SUCCESS;
+
+	START_TIMER;
+	slurm_mutex_lock(&stage_mutex);
+	if (!purged) {
+		_purge_batch_stage();
+		purged = true;
+	}
+	seq = stage_seq++;
+	slurm_mutex_unlock(&stage_mutex);
+
+	dir_name = _batch_stage_path();
+	xstrfmtcat(dir_name, "/job_desc.%u", seq);
+	if (mkdir(dir_name, 0700)) {
+		error("mkdir(%s) error %m", dir_name);
+		xfree(dir_name);
+		return ESLURM_WRITING_TO_FILE;
+	}
+
+	if ((rc = _write_job_desc_files(job_desc, dir_name))) {
+		_delete_job_desc_dir(dir_name);
+		xfree(dir_name);
+	} else {
+		job_desc->script_stage_dir = dir_name;
+	}
+
+	END_TIMER2(__func__);
+	return rc;
+}
+
+extern void unstage_job_desc_files(job_desc_msg_t *job_desc)
+{
+	if (!job_desc->script_stage_dir)
+		return;
+
+	_delete_job_desc_dir(job_desc->script_stage_dir);
+	xfree(job_desc->script_stage_dir);
+}
+
 /* Return true of the specified job ID already has a batch directory so
  * that a different job ID can be created. This is to help limit damage from
  * split-brain, where two slurmctld daemons are running as primary. */
@@ -9011,17 +9631,19 @@ void job_time_limit(void)
 			last_job_update = now;
 		}
 
-		/* Don't enforce time limits for configuring hetjobs */
-		if (_het_job_configuring_test(job_ptr))
-			continue;
-
 		/*
 		 * Only running jobs can be killed due to timeout. Do not kill
-		 * suspended jobs due to timeout.
+		 * suspended jobs due to timeout. Test this before the hetjob
+		 * configuring check, which looks up the hetjob leader, since
+		 * most of job_list is normally pending or finished.
 		 */
 		if (!IS_JOB_RUNNING(job_ptr))
 			continue;
 
+		/* Don't enforce time limits for configuring hetjobs */
+		if (_het_job_configuring_test(job_ptr))
+			continue;
+
 		/*
 		 * everything above here is considered "quick", and skips the
 		 * timeout at the bottom of the loop by using a continue.
@@ -9586,6 +10208,23 @@ static void _delete_job_common(job_record_t *job_ptr)
 	if (!job_ptr->job_id)
 		return;
 
+	/* Only jobs saved since the last snapshot need a purge record */
+	if (job_ptr->state_hash && (job_ptr->job_id != NO_VAL)) {
+		uint32_t *job_id = xmalloc(sizeof(*job_id));
+		*job_id = job_ptr->job_id;
+		list_enqueue(journal_purge_list, job_id);
+	}
+
+	/* Only jobs already reported by pack_delta_jobs() need a tombstone */
+	if (job_ptr->info_gen && (job_ptr->job_id != NO_VAL)) {
+		job_tombstone_t *tombstone = xmalloc(sizeof(*tombstone));
+		tombstone->job_id = job_ptr->job_id;
+		tombstone->info_gen = job_info_gen + 1;
+		tombstone->purge_time = time(NULL);
+		job_tombstone_gen = tombstone->info_gen;
+		list_append(job_tombstone_list, tombstone);
+	}
+
 	/* Remove record from fed_job_list */
 	fed_mgr_remove_fed_job_info(job_ptr->job_id);
 
@@ -9806,6 +10445,10 @@ static int _pack_job(void *object, void *arg)
 	if (!(pack_info->show_flags & SHOW_ALL) && IS_JOB_REVOKED(job_ptr))
 		return SLURM_SUCCESS;
 
+	if (pack_info->min_info_gen &&
+	    (job_ptr->info_gen <= pack_info->min_info_gen))
+		return SLURM_SUCCESS;
+
 	if (!pack_info->privileged) {
 		if (((pack_info->show_flags & SHOW_ALL) == 0) &&
 		    _all_parts_hidden(job_ptr, pack_info->visible_parts))
@@ -9843,10 +10486,8 @@ static int _foreach_pack_jobid(void *object, void *arg)
  * NOTE: change _unpack_job_info_msg() in common/slurm_protocol_pack.c
  *	whenever the data format changes
  */
-static buf_t *_pack_init_job_info(uint16_t protocol_version)
+static void _pack_job_info_header(buf_t *buffer, uint16_t protocol_version)
 {
-	buf_t *buffer = init_buf(BUF_SIZE);
-
 	/* write message body header : size and time */
 	/* put in a place holder job record count of 0 for now */
 	if (protocol_version >= SLURM_MIN_PROTOCOL_VERSION) {
@@ -9854,6 +10495,13 @@ static buf_t *_pack_init_job_info(uint16_t protocol_version)
 		pack_time(time(NULL), buffer);
 		pack_time(slurmctld_diag_stats.bf_when_last_cycle, buffer);
 	}
+}
+
+static buf_t *_pack_init_job_info(uint16_t protocol_version)
+{
+	buf_t *buffer = init_buf(BUF_SIZE);
+
+	_pack_job_info_header(buffer, protocol_version);
 
 	return buffer;
 }
@@ -9955,6 +10603,150 @@ extern buf_t *pack_spec_jobs(list_t *job_ids, uint16_t show_flags, uid_t uid,
 	return pack_info.buffer;
 }
 
+static int _foreach_hash_job_info(void *x, void *arg)
+{
+	job_record_t *job_ptr = x;
+	buf_t *buffer = arg;
+	uint64_t hash;
+
+	set_buf_offset(buffer, 0);
+	pack_job(job_ptr, (SHOW_ALL | SHOW_DETAIL), buffer,
+		 SLURM_PROTOCOL_VERSION, slurm_conf.slurm_user_id, true);
+	hash = job_journal_hash(get_buf_data(buffer), get_buf_offset(buffer));
+	if (hash != job_ptr->info_hash) {
+		job_ptr->info_hash = hash;
+		job_ptr->info_gen = job_info_gen;
+	}
+
+	return 0;
+}
+
+static int _foreach_expire_tombstone(void *x, void *arg)
+{
+	job_tombstone_t *tombstone = x;
+	time_t *min_time = arg;
+
+	if (tombstone->purge_time >= *min_time)
+		return 0;
+
+	/* Older generations can no longer be told about this purge */
+	job_info_min_gen = MAX(job_info_min_gen, tombstone->info_gen);
+	return 1;
+}
+
+/*
+ * Advance the job info generation, noting the generation in which the packed
+ * info of every job last changed.
+ * Caller must hold job_info_gen_mutex, the job read lock and the QOS read lock
+ */
+static void _advance_job_info_gen(void)
+{
+	time_t now = time(NULL), min_time = now - JOB_TOMBSTONE_AGE;
+	buf_t *buffer;
+
+	if (job_info_gen && (job_info_scan_time == now) &&
+	    (job_tombstone_gen <= job_info_gen))
+		return;
+
+	if (!job_info_gen)
+		job_info_gen = job_info_min_gen = ((uint64_t) now) << 32;
+	job_info_gen++;
+	job_info_scan_time = now;
+
+	buffer = init_buf(BUF_SIZE);
+	list_for_each_ro(job_list, _foreach_hash_job_info, buffer);
+	FREE_NULL_BUFFER(buffer);
+
+	list_delete_all(job_tombstone_list, _foreach_expire_tombstone,
+			&min_time);
+}
+
+/*
+ * pack_delta_jobs - dump job information for jobs changed since a job info
+ *	generation in machine independent form (for network transmission)
+ * IN generation - generation returned by an earlier call, 0 for all jobs
+ * IN show_flags - job filtering options
+ * IN uid - uid of user making request (for partition filtering)
+ * OUT buffer
+ * global: job_list - global list of job records
+ * NOTE: the buffer at *buffer_ptr must be xfreed by the caller
+ * NOTE: change _unpack_job_info_delta_msg() in common/slurm_protocol_pack.c
+ *	whenever the data format changes
+ */
+extern buf_t *pack_delta_jobs(uint64_t generation, uint16_t show_flags,
+			      uid_t uid, uint16_t protocol_version)
+{
+	uint32_t tmp_offset, count_offset, jobs_offset, purged_cnt = 0;
+	list_itr_t *iter;
+	job_tombstone_t *tombstone;
+	bool full;
+	_foreach_pack_job_info_t pack_info = {
+		.buffer = init_buf(BUF_SIZE),
+		.filter_uid = NO_VAL,
+		.jobs_packed = 0,
+		.protocol_version = protocol_version,
+		.show_flags = show_flags,
+		.uid = uid,
+		.has_qos_lock = true,
+		.user_rec.uid = uid,
+	};
+	assoc_mgr_lock_t locks = { .assoc = READ_LOCK, .user = READ_LOCK,
+				   .qos = READ_LOCK };
+
+	assoc_mgr_lock(&locks);
+	slurm_mutex_lock(&job_info_gen_mutex);
+	_advance_job_info_gen();
+
+	full = ((generation < job_info_min_gen) ||
+		(generation > job_info_gen));
+	if (!full)
+		pack_info.min_info_gen = generation;
+
+	pack64(job_info_gen, pack_info.buffer);
+	packbool(full, pack_info.buffer);
+
+	/* jobs purged since generation */
+	count_offset = get_buf_offset(pack_info.buffer);
+	pack32(0, pack_info.buffer);
+	if (!full) {
+		iter = list_iterator_create(job_tombstone_list);
+		while ((tombstone = list_next(iter))) {
+			if (tombstone->info_gen <= generation)
+				continue;
+			pack32(tombstone->job_id, pack_info.buffer);
+			purged_cnt++;
+		}
+		list_iterator_destroy(iter);
+	}
+	tmp_offset = get_buf_offset(pack_info.buffer);
+	set_buf_offset(pack_info.buffer, count_offset);
+	pack32(purged_cnt, pack_info.buffer);
+	set_buf_offset(pack_info.buffer, tmp_offset);
+
+	/* jobs created or changed since generation */
+	jobs_offset = get_buf_offset(pack_info.buffer);
+	_pack_job_info_header(pack_info.buffer, protocol_version);
+
+	assoc_mgr_fill_in_user(acct_db_conn, &pack_info.user_rec,
+			       accounting_enforce, NULL, true);
+	pack_info.privileged = validate_operator_user_rec(&pack_info.user_rec);
+	pack_info.visible_parts = build_visible_parts(
+		uid, (pack_info.privileged || (show_flags & SHOW_ALL)));
+	list_for_each_ro(job_list, _pack_job, &pack_info);
+	slurm_mutex_unlock(&job_info_gen_mutex);
+	assoc_mgr_unlock(&locks);
+
+	/* put the real record count in the message body header */
+	tmp_offset = get_buf_offset(pack_info.buffer);
+	set_buf_offset(pack_info.buffer, jobs_offset);
+	pack32(pack_info.jobs_packed, pack_info.buffer);
+	set_buf_offset(pack_info.buffer, tmp_offset);
+
+	xfree(pack_info.visible_parts);
+
+	return pack_info.buffer;
+}
+
 static int _pack_het_job(job_record_t *job_ptr, uint16_t show_flags,
 			 buf_t *buffer, uint16_t protocol_version, uid_t uid)
 {
@@ -10042,7 +10834,7 @@ extern buf_t *pack_one_job(uint32_t job_id, uint16_t show_flags, uid_t uid,
 			}
 		}
 
-		job_ptr = job_array_hash_j[JOB_HASH_INX(job_id)];
+		job_ptr = job_index_find(job_array_hash_j, job_id);
 		while (job_ptr) {
 			if ((job_ptr->job_id == job_id) && packed_head) {
 				;	/* Already packed */
@@ -14696,7 +15488,7 @@ extern int update_job_str(slurm_msg_t *msg, uid_t uid)
 		}
 
 		/* Update all tasks of this job array */
-		job_ptr = job_array_hash_j[JOB_HASH_INX(job_id)];
+		job_ptr = job_index_find(job_array_hash_j, job_id);
 		if (!job_ptr && !job_ptr_done) {
 			info("%s: invalid JobId=%u", __func__, job_id);
 			rc = ESLURM_INVALID_JOB_ID;
@@ -15667,7 +16459,7 @@ static void _validate_job_files(list_t *batch_dirs)
 		}
 		if (job_ptr && job_ptr->array_recs) { /* Update all tasks */
 			array_job_id = job_ptr->array_job_id;
-			job_ptr = job_array_hash_j[JOB_HASH_INX(array_job_id)];
+			job_ptr = job_index_find(job_array_hash_j, array_job_id);
 			while (job_ptr) {
 				if (job_ptr->array_job_id == array_job_id)
 					job_ptr->bit_flags |= HAS_STATE_DIR;
@@ -16081,11 +16873,15 @@ void batch_requeue_fini(job_record_t *job_ptr)
 void job_fini (void)
 {
 	FREE_NULL_LIST(job_list);
-	xfree(job_hash);
-	xfree(job_array_hash_j);
-	xfree(job_array_hash_t);
+	FREE_NULL_JOB_INDEX(job_hash);
+	FREE_NULL_JOB_INDEX(job_array_hash_j);
+	FREE_NULL_JOB_INDEX(job_array_hash_t);
 	FREE_NULL_LIST(purge_jobs_list);
 	FREE_NULL_LIST(purge_files_list);
+	FREE_NULL_LIST(journal_purge_list);
+	FREE_NULL_LIST(job_tombstone_list);
+	/* Start a new generation epoch with the new job records */
+	job_info_gen = 0;
 	FREE_NULL_BITMAP(requeue_exit);
 	FREE_NULL_BITMAP(requeue_exit_hold);
 }
@@ -16936,7 +17732,7 @@ extern int job_suspend2(slurm_msg_t *msg, suspend_msg_t *sus_ptr, uid_t uid,
 		}
 
 		/* Suspend all tasks of this job array */
-		job_ptr = job_array_hash_j[JOB_HASH_INX(job_id)];
+		job_ptr = job_index_find(job_array_hash_j, job_id);
 		if (!job_ptr && !job_ptr_done) {
 			rc = ESLURM_INVALID_JOB_ID;
 			goto reply;
@@ -17389,7 +18185,7 @@ extern int job_requeue2(uid_t uid, requeue_msg_t *req_ptr, slurm_msg_t *msg,
 		}
 
 		/* Requeue all tasks of this job array */
-		job_ptr = job_array_hash_j[JOB_HASH_INX(job_id)];
+		job_ptr = job_index_find(job_array_hash_j, job_id);
 		if (!job_ptr && !job_ptr_done) {
 			rc = ESLURM_INVALID_JOB_ID;
 			goto reply;
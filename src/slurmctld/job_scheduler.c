@@ -67,6 +67,7 @@
 #include "src/common/track_script.h"
 #include "src/common/uid.h"
 #include "src/common/xassert.h"
+#include "src/common/xhash.h"
 #include "src/common/xstring.h"
 
 #include "src/interfaces/accounting_storage.h"
@@ -724,7 +725,8 @@ extern list_t *build_job_queue(bool clear_start, bool backfill)
 	split_job_t split_job = { 0 };
 	/* init the timer */
 	(void) slurm_delta_tv(&start_tv);
-	job_queue = list_create(xfree_ptr);
+	/* job_queue is only ever used by the calling scheduler thread */
+	job_queue = list_create_unlocked(xfree_ptr);
 
 	(void) list_for_each(job_list, _split_job_on_schedule, &split_job);
 
@@ -1147,6 +1149,79 @@ static void _set_features(job_record_t *job_ptr, bool use_prefer)
 	}
 }
 
+/* Jobs with a scheduling class which failed to start this cycle */
+typedef struct {
+	char *key;
+	job_record_t *job_ptr;	/* first job of the class tested */
+} sched_class_t;
+
+static void _sched_class_id(void *item, const char **key, uint32_t *key_len)
+{
+	sched_class_t *class = item;
+
+	*key = class->key;
+	*key_len = strlen(class->key);
+}
+
+static void _sched_class_free(void *item)
+{
+	sched_class_t *class = item;
+
+	xfree(class->key);
+	xfree(class);
+}
+
+/*
+ * Build a key from everything in a job's request that select_nodes() uses to
+ * pick resources. Jobs with the same key in the same partition and
+ * reservation are interchangeable to the scheduler. Resources only become
+ * less available during a _schedule() cycle, so once one of them fails for
+ * lack of resources the rest would too.
+ * RET xstring key or NULL if job is not eligible
+ */
+static char *_sched_class_key(job_record_t *job_ptr, bool use_prefer)
+{
+	job_details_t *details = job_ptr->details;
+	multi_core_data_t *mc_ptr;
+	char *key = NULL;
+
+	if (!details || details->job_size_bitmap || job_ptr->het_job_id ||
+	    job_ptr->deadline || details->expanding_jobid)
+		return NULL;
+
+	xstrfmtcat(key, "%p|%p|%u|%u|%u|%u|%d|%"PRIu64"|%u|%u",
+		   job_ptr->part_ptr, job_ptr->resv_ptr, job_ptr->qos_id,
+		   job_ptr->assoc_id, job_ptr->user_id, job_ptr->group_id,
+		   use_prefer, job_ptr->bit_flags, job_ptr->time_limit,
+		   job_ptr->time_min);
+	xstrfmtcat(key, "|%u|%u|%u|%u|%u|%u|%u|%"PRIu64"|%u|%u|%u|%u|%u|%u|%u|%u|%u",
+		   details->min_nodes, details->max_nodes, details->num_tasks,
+		   details->min_cpus, details->max_cpus, details->pn_min_cpus,
+		   details->cpus_per_task, details->pn_min_memory,
+		   details->pn_min_tmp_disk, details->ntasks_per_node,
+		   details->ntasks_per_tres, details->contiguous,
+		   details->share_res, details->whole_node,
+		   details->core_spec, details->task_dist,
+		   details->overcommit);
+	if ((mc_ptr = details->mc_ptr))
+		xstrfmtcat(key, "|%u|%u|%u|%u|%u|%u|%u|%u|%u",
+			   mc_ptr->boards_per_node, mc_ptr->sockets_per_board,
+			   mc_ptr->sockets_per_node, mc_ptr->cores_per_socket,
+			   mc_ptr->threads_per_core, mc_ptr->ntasks_per_board,
+			   mc_ptr->ntasks_per_socket, mc_ptr->ntasks_per_core,
+			   mc_ptr->plane_size);
+	xstrfmtcat(key, "|%s|%s|%s|%s|%s|%s|%s|%s|%s|%s|%s|%s|%s|%s",
+		   details->features_use, details->req_nodes,
+		   details->exc_nodes, job_ptr->tres_per_job,
+		   job_ptr->tres_per_node, job_ptr->tres_per_socket,
+		   job_ptr->tres_per_task, job_ptr->cpus_per_tres,
+		   job_ptr->mem_per_tres, job_ptr->licenses,
+		   job_ptr->network, job_ptr->mcs_label,
+		   job_ptr->burst_buffer, job_ptr->account);
+
+	return key;
+}
+
 static void _set_schedule_exit(schedule_exit_t code)
 {
 	xassert(code < SCHEDULE_EXIT_COUNT);
@@ -1182,6 +1257,7 @@ static int _schedule(bool full_queue)
 	static int max_jobs_per_part = 0;
 	static int defer_rpc_cnt = 0;
 	static bool reduce_completing_frag = false;
+	static bool sched_class_skip = false;
 	time_t now, last_job_sched_start, sched_start;
 	job_record_t *reject_array_job = NULL;
 	part_record_t *reject_array_part = NULL;
@@ -1191,6 +1267,9 @@ static int _schedule(bool full_queue)
 	bool fail_by_part, wait_on_resv;
 	uint32_t deadline_time_limit, save_time_limit = 0;
 	uint32_t prio_reserve;
+	xhash_t *sched_class_map = NULL;
+	sched_class_t *sched_class;
+	char *class_key = NULL;
 	DEF_TIMERS;
 
 	if (slurmctld_config.shutdown_time)
@@ -1338,6 +1417,11 @@ static int _schedule(bool full_queue)
 		else
 			reduce_completing_frag = false;
 
+		if (xstrcasestr(slurm_conf.sched_params, "sched_class_skip"))
+			sched_class_skip = true;
+		else
+			sched_class_skip = false;
+
 		if ((tmp_ptr = xstrcasestr(slurm_conf.sched_params,
 		                           "max_rpc_cnt=")))
 			defer_rpc_cnt = atoi(tmp_ptr + 12);
@@ -1490,11 +1574,20 @@ static int _schedule(bool full_queue)
 		slurmctld_diag_stats.schedule_queue_len = list_count(job_list);
 		job_iterator = list_iterator_create(job_list);
 	} else {
+		DEF_PHASE_TIMER(queue);
+
+		START_PHASE_TIMER(queue);
 		job_queue = build_job_queue(false, false);
 		slurmctld_diag_stats.schedule_queue_len = list_count(job_queue);
 		sort_job_queue(job_queue);
+		END_PHASE_TIMER(queue,
+				&sched_phase_stats[SCHED_PHASE_BUILD_QUEUE]);
 	}
 
+	if (sched_class_skip)
+		sched_class_map = xhash_init(_sched_class_id,
+					     _sched_class_free);
+
 	job_ptr = NULL;
 	wait_on_resv = false;
 	while (1) {
@@ -1855,6 +1948,31 @@ next_task:
 			continue;
 		}
 
+		xfree(class_key);
+		if (sched_class_map && !deadline_time_limit &&
+		    (class_key = _sched_class_key(job_ptr, use_prefer)) &&
+		    (sched_class = xhash_get_str(sched_class_map, class_key))) {
+			job_record_t *class_job_ptr = sched_class->job_ptr;
+
+			if ((job_ptr->state_reason !=
+			     class_job_ptr->state_reason) ||
+			    xstrcmp(job_ptr->state_desc,
+				    class_job_ptr->state_desc)) {
+				job_ptr->state_reason =
+					class_job_ptr->state_reason;
+				xfree(job_ptr->state_desc);
+				job_ptr->state_desc =
+					xstrdup(class_job_ptr->state_desc);
+				last_job_update = now;
+			}
+			sched_debug3("%pJ has same request as %pJ which could not start. Reason=%s. Priority=%u. Partition=%s.",
+				     job_ptr, class_job_ptr,
+				     job_state_reason_string(
+					     job_ptr->state_reason),
+				     job_ptr->priority, job_ptr->partition);
+			continue;
+		}
+
 		last_job_sched_start = MAX(last_job_sched_start,
 					   job_ptr->start_time);
 		if (deadline_time_limit) {
@@ -1888,6 +2006,13 @@ skip_start:
 		fail_by_part = false;
 		if ((error_code != SLURM_SUCCESS) && deadline_time_limit)
 			job_ptr->time_limit = save_time_limit;
+		if ((error_code == ESLURM_NODES_BUSY) && class_key) {
+			sched_class = xmalloc(sizeof(*sched_class));
+			sched_class->key = class_key;
+			sched_class->job_ptr = job_ptr;
+			class_key = NULL;
+			xhash_add(sched_class_map, sched_class);
+		}
 		if (error_code == ESLURM_NODES_BUSY) {
 			sched_debug3("%pJ. State=%s. Reason=%s. Priority=%u. Partition=%s.",
 				     job_ptr,
@@ -2120,6 +2245,8 @@ fail_this_part:	if (fail_by_part) {
 
 	if (job_ptr)
 		job_resv_clear_magnetic_flag(job_ptr);
+	xfree(class_key);
+	xhash_free(sched_class_map);
 	FREE_NULL_BITMAP(avail_node_bitmap);
 	avail_node_bitmap = save_avail_node_bitmap;
 	if (fifo_sched) {
@@ -2977,7 +3104,7 @@ static void _depend_list2str(job_record_t *job_ptr, bool set_or_flag)
 {
 	list_itr_t *depend_iter;
 	depend_spec_t *dep_ptr;
-	char *dep_str, *sep = "";
+	char *dep_str, *sep = "", *pos = NULL;
 
 	if (job_ptr->details == NULL)
 		return;
@@ -2997,28 +3124,31 @@ static void _depend_list2str(job_record_t *job_ptr, bool set_or_flag)
 		if (dep_ptr->depend_state == DEPEND_FULFILLED)
 			continue;
 		if      (dep_ptr->depend_type == SLURM_DEPEND_SINGLETON) {
-			xstrfmtcat(job_ptr->details->dependency,
-				   "%ssingleton(%s)",
-				   sep, _depend_state2str(dep_ptr));
+			xstrfmtcatat(job_ptr->details->dependency, &pos,
+				     "%ssingleton(%s)",
+				     sep, _depend_state2str(dep_ptr));
 		} else {
 			dep_str = _depend_type2str(dep_ptr);
 
 			if (dep_ptr->array_task_id == INFINITE)
-				xstrfmtcat(job_ptr->details->dependency, "%s%s:%u_*",
-					   sep, dep_str, dep_ptr->job_id);
+				xstrfmtcatat(job_ptr->details->dependency, &pos,
+					     "%s%s:%u_*",
+					     sep, dep_str, dep_ptr->job_id);
 			else if (dep_ptr->array_task_id == NO_VAL)
-				xstrfmtcat(job_ptr->details->dependency, "%s%s:%u",
-					   sep, dep_str, dep_ptr->job_id);
+				xstrfmtcatat(job_ptr->details->dependency, &pos,
+					     "%s%s:%u",
+					     sep, dep_str, dep_ptr->job_id);
 			else
-				xstrfmtcat(job_ptr->details->dependency, "%s%s:%u_%u",
-					   sep, dep_str, dep_ptr->job_id,
-					   dep_ptr->array_task_id);
+				xstrfmtcatat(job_ptr->details->dependency, &pos,
+					     "%s%s:%u_%u",
+					     sep, dep_str, dep_ptr->job_id,
+					     dep_ptr->array_task_id);
 
 			if (dep_ptr->depend_time)
-				xstrfmtcat(job_ptr->details->dependency,
-					   "+%u", dep_ptr->depend_time / 60);
-			xstrfmtcat(job_ptr->details->dependency, "(%s)",
-				   _depend_state2str(dep_ptr));
+				xstrfmtcatat(job_ptr->details->dependency, &pos,
+					     "+%u", dep_ptr->depend_time / 60);
+			xstrfmtcatat(job_ptr->details->dependency, &pos,
+				     "(%s)", _depend_state2str(dep_ptr));
 		}
 		if (set_or_flag)
 			dep_ptr->depend_flags |= SLURM_FLAGS_OR;
@@ -3253,12 +3383,10 @@ extern int test_job_dependency(job_record_t *job_ptr, bool *was_changed)
 		} else {
 			/* Special case, apply test to job array as a whole */
 			if (dep_ptr->array_task_id == INFINITE) {
-				is_complete = test_job_array_complete(
-					dep_ptr->job_id);
-				is_completed = test_job_array_completed(
-					dep_ptr->job_id);
-				is_pending = test_job_array_pending(
-					dep_ptr->job_id);
+				test_job_array_state(dep_ptr->job_id,
+						     &is_complete,
+						     &is_completed,
+						     &is_pending);
 			} else {
 				/* Normal job */
 				is_complete = IS_JOB_COMPLETE(djob_ptr);
@@ -5348,23 +5476,12 @@ static int _valid_feature_list(job_record_t *job_ptr, list_t *feature_list,
 /* Validate that job's feature is available on some node(s) */
 static int _valid_node_feature(char *feature, bool can_reboot)
 {
-	int rc = ESLURM_INVALID_FEATURE;
-	node_feature_t *feature_ptr;
-	list_itr_t *feature_iter;
+	list_t *feature_list = can_reboot ? avail_feature_list :
+					    active_feature_list;
 
-	if (can_reboot)
-		feature_iter = list_iterator_create(avail_feature_list);
-	else
-		feature_iter = list_iterator_create(active_feature_list);
-	while ((feature_ptr = list_next(feature_iter))) {
-		if (xstrcmp(feature_ptr->name, feature))
-			continue;
-		rc = SLURM_SUCCESS;
-		break;
-	}
-	list_iterator_destroy(feature_iter);
-
-	return rc;
+	if (find_node_feature(feature_list, feature))
+		return SLURM_SUCCESS;
+	return ESLURM_INVALID_FEATURE;
 }
 
 #define REBUILD_PENDING SLURM_BIT(0)
@@ -34,6 +34,7 @@
 \*****************************************************************************/
 
 #include "src/common/macros.h"
+#include "src/common/trace_ring.h"
 #include "src/common/xahash.h"
 #include "src/common/xstring.h"
 
@@ -299,6 +300,8 @@ extern void job_state_set(job_record_t *job_ptr, uint32_t state)
 	_log_job_state_change(job_ptr, state);
 
 	on_job_state_change(job_ptr, state);
+	trace_ring_record(TRACE_EVENT_JOB_STATE, job_ptr->job_id,
+			  job_ptr->job_state, state);
 
 	job_ptr->job_state = state;
 }
@@ -776,6 +779,25 @@ static void _sync_job_task_id_bitmap(const job_record_t *job_ptr,
 		return;
 	}
 
+	if (bit_ffs(job_ptr->array_recs->task_id_bitmap) == -1) {
+		/*
+		 * Every task has been split into its own job record. Only
+		 * track the (possibly huge) bitmap while tasks remain in the
+		 * meta job to match _job_state_array_bitmap().
+		 */
+		if (_is_debug() && js->task_id_bitmap) {
+			char *before = bit_fmt_full(js->task_id_bitmap);
+			LOG("[%pJ] no tasks left in meta job: releasing array task_id_bitmap[%lu]: %s",
+			    JOB_STATE_MIMIC_RECORD(js),
+			    bit_size(js->task_id_bitmap), before);
+			xfree(before);
+		}
+
+		FREE_NULL_BITMAP(js->task_id_bitmap);
+
+		return;
+	}
+
 	if (js->task_id_bitmap &&
 	    (bit_size(js->task_id_bitmap) ==
 	     bit_size(job_ptr->array_recs->task_id_bitmap))) {
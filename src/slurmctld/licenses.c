@@ -63,10 +63,15 @@ static pthread_mutex_t license_mutex = PTHREAD_MUTEX_INITIALIZER;
 static void _pack_license(licenses_t *lic, buf_t *buffer,
 			  uint16_t protocol_version);
 
-typedef struct {
-	char *name;
-	slurmctld_resv_t *resv_ptr;
-} bf_licenses_find_resv_t;
+/*
+ * Interned license names, indexed by license id - 1. Configured and remote
+ * licenses get an id when they are added to cluster_license_list, and job and
+ * reservation license records pick the id up when validated against it. The
+ * strings are only freed by license_free() so backfill records can point at
+ * them. Protected by license_mutex.
+ */
+static char **license_names = NULL;
+static uint32_t license_name_cnt = 0;
 
 /* Print all licenses on a list */
 static void _licenses_print(char *header, list_t *licenses,
@@ -119,6 +124,20 @@ static int _license_find_rec(void *x, void *key)
 	return 1;
 }
 
+/*
+ * Find a license_t record matching another license_t record, by id when both
+ * are resolved and otherwise by name (for use by list_find_first)
+ */
+static int _license_find_entry(void *x, void *key)
+{
+	licenses_t *license_entry = x;
+	licenses_t *target = key;
+
+	if (license_entry->id && target->id)
+		return (license_entry->id == target->id);
+	return _license_find_rec(x, target->name);
+}
+
 /* Find a license_t record by license name (for use by list_find_first) */
 static int _license_find_remote_rec(void *x, void *key)
 {
@@ -129,6 +148,31 @@ static int _license_find_remote_rec(void *x, void *key)
 	return _license_find_rec(x, key);
 }
 
+/*
+ * Return the id of a license name, adding it to the interned names if needed.
+ * license_mutex should be locked before calling this.
+ */
+static uint32_t _license_name_id(char *name)
+{
+	for (uint32_t i = 0; i < license_name_cnt; i++) {
+		if (!xstrcmp(license_names[i], name))
+			return i + 1;
+	}
+
+	xrecalloc(license_names, license_name_cnt + 1, sizeof(char *));
+	license_names[license_name_cnt++] = xstrdup(name);
+	return license_name_cnt;
+}
+
+/* license_mutex should be locked before calling this. */
+static int _foreach_license_set_id(void *x, void *arg)
+{
+	licenses_t *license_entry = x;
+
+	license_entry->id = _license_name_id(license_entry->name);
+	return SLURM_SUCCESS;
+}
+
 /* Given a license string, return a list of license_t records */
 static list_t *_build_license_list(char *licenses, bool *valid)
 {
@@ -261,6 +305,7 @@ static void _add_res_rec_2_lic_list(slurmdb_res_rec_t *rec, bool sync)
 	licenses_t *license_entry = xmalloc(sizeof(licenses_t));
 
 	license_entry->name = xstrdup_printf("%s@%s", rec->name, rec->server);
+	license_entry->id = _license_name_id(license_entry->name);
 	license_entry->remote = sync ? 2 : 1;
 	_handle_consumed(license_entry, rec);
 
@@ -282,6 +327,9 @@ extern int license_init(char *licenses)
 	cluster_license_list = _build_license_list(licenses, &valid);
 	if (!valid)
 		fatal("Invalid configured licenses: %s", licenses);
+	if (cluster_license_list)
+		list_for_each(cluster_license_list, _foreach_license_set_id,
+			      NULL);
 
 	_licenses_print("init_license", cluster_license_list, NULL);
 	slurm_mutex_unlock(&license_mutex);
@@ -302,6 +350,8 @@ extern int license_update(char *licenses)
                 fatal("Invalid configured licenses: %s", licenses);
 
         slurm_mutex_lock(&license_mutex);
+	if (new_list)
+		list_for_each(new_list, _foreach_license_set_id, NULL);
         if (!cluster_license_list) {        /* no licenses before now */
                 cluster_license_list = new_list;
                 slurm_mutex_unlock(&license_mutex);
@@ -521,6 +571,10 @@ extern void license_free(void)
 {
 	slurm_mutex_lock(&license_mutex);
 	FREE_NULL_LIST(cluster_license_list);
+	for (uint32_t i = 0; i < license_name_cnt; i++)
+		xfree(license_names[i]);
+	xfree(license_names);
+	license_name_cnt = 0;
 	slurm_mutex_unlock(&license_mutex);
 }
 
@@ -609,6 +663,8 @@ extern list_t *license_validate(char *licenses, bool validate_configured,
 			break;
 		}
 
+		license_entry->id = match->id;
+
 		if (tres_req_cnt) {
 			tres_req.name = license_entry->name;
 			if ((tres_pos = assoc_mgr_find_tres_pos(
@@ -663,8 +719,8 @@ extern int license_job_test_with_list(job_record_t *job_ptr, time_t when,
 	slurm_mutex_lock(&license_mutex);
 	iter = list_iterator_create(job_ptr->license_list);
 	while ((license_entry = list_next(iter))) {
-		match = list_find_first(license_list, _license_find_rec,
-					license_entry->name);
+		match = list_find_first(license_list, _license_find_entry,
+					license_entry);
 		if (!match) {
 			error("could not find license %s for job %u",
 			      license_entry->name, job_ptr->job_id);
@@ -730,6 +786,7 @@ extern list_t *license_copy(list_t *license_list_src)
 	while ((license_entry_src = list_next(iter))) {
 		license_entry_dest = xmalloc(sizeof(licenses_t));
 		license_entry_dest->name = xstrdup(license_entry_src->name);
+		license_entry_dest->id = license_entry_src->id;
 		license_entry_dest->total = license_entry_src->total;
 		license_entry_dest->used = license_entry_src->used;
 		license_entry_dest->last_deficit =
@@ -759,8 +816,8 @@ extern int license_job_get(job_record_t *job_ptr, bool restore)
 	slurm_mutex_lock(&license_mutex);
 	iter = list_iterator_create(job_ptr->license_list);
 	while ((license_entry = list_next(iter))) {
-		match = list_find_first(cluster_license_list, _license_find_rec,
-			license_entry->name);
+		match = list_find_first(cluster_license_list,
+					_license_find_entry, license_entry);
 		if (match) {
 			match->used += license_entry->total;
 			license_entry->used += license_entry->total;
@@ -803,8 +860,8 @@ extern int license_job_return_to_list(job_record_t *job_ptr, list_t *license_lis
 	slurm_mutex_lock(&license_mutex);
 	iter = list_iterator_create(job_ptr->license_list);
 	while ((license_entry = list_next(iter))) {
-		match = list_find_first(license_list, _license_find_rec,
-			license_entry->name);
+		match = list_find_first(license_list, _license_find_entry,
+					license_entry);
 		if (match) {
 			if (match->used >= license_entry->total)
 				match->used -= license_entry->total;
@@ -856,8 +913,8 @@ extern bool license_list_overlap(list_t *list_1, list_t *list_2)
 
 	iter = list_iterator_create(list_1);
 	while ((license_entry = list_next(iter))) {
-		if (list_find_first(list_2, _license_find_rec,
-				    license_entry->name)) {
+		if (list_find_first(list_2, _license_find_entry,
+				    license_entry)) {
 			match = true;
 			break;
 		}
@@ -1037,54 +1094,61 @@ static void _pack_license(licenses_t *lic, buf_t *buffer,
 	}
 }
 
-static void _bf_license_free_rec(void *x)
+/* Does a backfill license record hold the license of a job license record */
+static bool _bf_license_match(bf_license_t *entry, licenses_t *license)
 {
-	bf_license_t *entry = x;
-
-	if (!entry)
-		return;
-
-	xfree(entry->name);
-	xfree(entry);
+	if (license->id)
+		return (entry->id == license->id);
+	return !xstrcmp(entry->name, license->name);
 }
 
 /*
- * Will never match on a reserved license.
+ * Find the global record for a license. Will never match on a reserved
+ * license. Search from the end, later records take precedence.
  */
-static int _bf_licenses_find_rec(void *x, void *key)
+static bf_license_t *_bf_licenses_find(bf_licenses_t *licenses,
+				       licenses_t *license)
 {
-	bf_license_t *license_entry = x;
-	char *name = key;
-
-	xassert(license_entry->name);
-	xassert(name);
-
-	if (license_entry->resv_ptr)
-		return 0;
+	for (int i = licenses->count - 1; i >= 0; i--) {
+		bf_license_t *entry = &licenses->entries[i];
 
-	if (!xstrcmp(license_entry->name, name))
-		return 1;
+		if (!entry->resv_ptr && _bf_license_match(entry, license))
+			return entry;
+	}
 
-	return 0;
+	return NULL;
 }
 
-static int _bf_licenses_find_resv(void *x, void *key)
+/* Find the record for a license locked to a reservation */
+static bf_license_t *_bf_licenses_find_resv(bf_licenses_t *licenses,
+					    licenses_t *license,
+					    slurmctld_resv_t *resv_ptr)
 {
-	bf_license_t *license_entry = x;
-	bf_licenses_find_resv_t *target = key;
+	for (int i = licenses->count - 1; i >= 0; i--) {
+		bf_license_t *entry = &licenses->entries[i];
 
-	if (license_entry->resv_ptr != target->resv_ptr)
-		return 0;
+		if ((entry->resv_ptr == resv_ptr) &&
+		    _bf_license_match(entry, license))
+			return entry;
+	}
 
-	if (xstrcmp(license_entry->name, target->name))
-		return 0;
+	return NULL;
+}
 
-	return 1;
+static bf_license_t *_bf_licenses_add(bf_licenses_t *licenses)
+{
+	if (licenses->count == licenses->size) {
+		licenses->size = licenses->size ? (licenses->size * 2) : 4;
+		xrecalloc(licenses->entries, licenses->size,
+			  sizeof(*licenses->entries));
+	}
+
+	return &licenses->entries[licenses->count++];
 }
 
-extern list_t *bf_licenses_initial(bool bf_running_job_reserve)
+extern bf_licenses_t *bf_licenses_initial(bool bf_running_job_reserve)
 {
-	list_t *bf_list;
+	bf_licenses_t *bf_list;
 	list_itr_t *iter;
 	licenses_t *license_entry;
 	bf_license_t *bf_entry;
@@ -1092,20 +1156,25 @@ extern list_t *bf_licenses_initial(bool bf_running_job_reserve)
 	if (!cluster_license_list || !list_count(cluster_license_list))
 		return NULL;
 
-	bf_list = list_create(_bf_license_free_rec);
+	bf_list = xmalloc(sizeof(*bf_list));
 
+	slurm_mutex_lock(&license_mutex);
 	iter = list_iterator_create(cluster_license_list);
 	while ((license_entry = list_next(iter))) {
-		bf_entry = xmalloc(sizeof(*bf_entry));
-		bf_entry->name = xstrdup(license_entry->name);
+		if (!license_entry->id)
+			license_entry->id =
+				_license_name_id(license_entry->name);
+
+		bf_entry = _bf_licenses_add(bf_list);
+		bf_entry->id = license_entry->id;
+		bf_entry->name = license_names[license_entry->id - 1];
 		bf_entry->remaining = license_entry->total;
 
 		if (!bf_running_job_reserve)
 			bf_entry->remaining -= license_entry->used;
-
-		list_push(bf_list, bf_entry);
 	}
 	list_iterator_destroy(iter);
+	slurm_mutex_unlock(&license_mutex);
 
 	return bf_list;
 }
@@ -1114,14 +1183,13 @@ extern char *bf_licenses_to_string(bf_licenses_t *licenses_list)
 {
 	char *sep = "";
 	char *licenses = NULL;
-	list_itr_t *iter;
-	bf_license_t *entry;
 
 	if (!licenses_list)
 		return NULL;
 
-	iter = list_iterator_create(licenses_list);
-	while ((entry = list_next(iter))) {
+	for (int i = licenses_list->count - 1; i >= 0; i--) {
+		bf_license_t *entry = &licenses_list->entries[i];
+
 		xstrfmtcat(licenses, "%s%s%s%s%s:%u",
 			   (entry->resv_ptr ? "resv=" : ""),
 			   (entry->resv_ptr ? entry->resv_ptr->name : ""),
@@ -1129,35 +1197,38 @@ extern char *bf_licenses_to_string(bf_licenses_t *licenses_list)
 			   sep, entry->name, entry->remaining);
 		sep = ",";
 	}
-	list_iterator_destroy(iter);
 
 	return licenses;
 }
 
 extern bf_licenses_t *slurm_bf_licenses_copy(bf_licenses_t *licenses_src)
 {
-	bf_license_t *entry_src, *entry_dest;
-	list_itr_t *iter;
 	bf_licenses_t *licenses_dest = NULL;
 
 	if (!licenses_src)
 		return NULL;
 
-	licenses_dest = list_create(_bf_license_free_rec);
-
-	iter = list_iterator_create(licenses_src);
-	while ((entry_src = list_next(iter))) {
-		entry_dest = xmalloc(sizeof(*entry_dest));
-		entry_dest->name = xstrdup(entry_src->name);
-		entry_dest->remaining = entry_src->remaining;
-		entry_dest->resv_ptr = entry_src->resv_ptr;
-		list_append(licenses_dest, entry_dest);
+	licenses_dest = xmalloc(sizeof(*licenses_dest));
+	licenses_dest->count = licenses_dest->size = licenses_src->count;
+	if (licenses_src->count) {
+		licenses_dest->entries = xcalloc(licenses_src->count,
+						 sizeof(bf_license_t));
+		memcpy(licenses_dest->entries, licenses_src->entries,
+		       licenses_src->count * sizeof(bf_license_t));
 	}
-	list_iterator_destroy(iter);
 
 	return licenses_dest;
 }
 
+extern void slurm_bf_licenses_free(bf_licenses_t *licenses)
+{
+	if (!licenses)
+		return;
+
+	xfree(licenses->entries);
+	xfree(licenses);
+}
+
 extern void slurm_bf_licenses_deduct(bf_licenses_t *licenses,
 				     job_record_t *job_ptr)
 {
@@ -1180,14 +1251,8 @@ extern void slurm_bf_licenses_deduct(bf_licenses_t *licenses,
 		 * reservation first, then global as needed.
 		 */
 		if (job_ptr->resv_ptr) {
-			bf_licenses_find_resv_t target_record = {
-				.name = job_entry->name,
-				.resv_ptr = job_ptr->resv_ptr,
-			};
-
-			resv_entry = list_find_first(licenses,
-						     _bf_licenses_find_resv,
-						     &target_record);
+			resv_entry = _bf_licenses_find_resv(licenses, job_entry,
+							    job_ptr->resv_ptr);
 			if (resv_entry && (needed <= resv_entry->remaining)) {
 				resv_entry->remaining -= needed;
 				continue;
@@ -1197,8 +1262,7 @@ extern void slurm_bf_licenses_deduct(bf_licenses_t *licenses,
 			}
 		}
 
-		bf_entry = list_find_first(licenses, _bf_licenses_find_rec,
-					   job_entry->name);
+		bf_entry = _bf_licenses_find(licenses, job_entry);
 
 		if (!bf_entry) {
 			error("%s: missing license %s",
@@ -1234,13 +1298,16 @@ extern void slurm_bf_licenses_transfer(bf_licenses_t *licenses,
 		bf_license_t *bf_entry, *new_entry;
 		int needed = resv_entry->total;
 		int reservable = resv_entry->total;
+		char *name;
+		uint32_t id;
 
-		bf_entry = list_find_first(licenses, _bf_licenses_find_rec,
-					   resv_entry->name);
+		bf_entry = _bf_licenses_find(licenses, resv_entry);
 
 		if (!bf_entry) {
+			/* No interned name to refer to, nothing to lock */
 			error("%s: missing license %s",
 			      __func__, resv_entry->name);
+			continue;
 		} else if (bf_entry->remaining < needed) {
 			error("%s: underflow on %s", __func__, bf_entry->name);
 			reservable = bf_entry->remaining;
@@ -1250,12 +1317,15 @@ extern void slurm_bf_licenses_transfer(bf_licenses_t *licenses,
 			reservable = needed;
 		}
 
-		new_entry = xmalloc(sizeof(*new_entry));
-		new_entry->name = xstrdup(resv_entry->name);
+		/* Adding may move the array, copy what we need first */
+		name = bf_entry->name;
+		id = bf_entry->id;
+
+		new_entry = _bf_licenses_add(licenses);
+		new_entry->name = name;
+		new_entry->id = id;
 		new_entry->remaining = reservable;
 		new_entry->resv_ptr = job_ptr->resv_ptr;
-
-		list_push(licenses, new_entry);
 	}
 	list_iterator_destroy(iter);
 }
@@ -1281,14 +1351,8 @@ extern bool slurm_bf_licenses_avail(bf_licenses_t *licenses,
 		 * reservation first, then global as needed.
 		 */
 		if (job_ptr->resv_ptr) {
-			bf_licenses_find_resv_t target_record = {
-				.name = need->name,
-				.resv_ptr = job_ptr->resv_ptr,
-			};
-
-			resv_entry = list_find_first(licenses,
-						     _bf_licenses_find_resv,
-						     &target_record);
+			resv_entry = _bf_licenses_find_resv(licenses, need,
+							    job_ptr->resv_ptr);
 
 			if (resv_entry && (needed <= resv_entry->remaining))
 				continue;
@@ -1296,8 +1360,7 @@ extern bool slurm_bf_licenses_avail(bf_licenses_t *licenses,
 				needed -= resv_entry->remaining;
 		}
 
-		bf_entry = list_find_first(licenses, _bf_licenses_find_rec,
-					   need->name);
+		bf_entry = _bf_licenses_find(licenses, need);
 
 		if (!bf_entry || (bf_entry->remaining < needed)) {
 			avail = false;
@@ -1311,22 +1374,22 @@ extern bool slurm_bf_licenses_avail(bf_licenses_t *licenses,
 
 extern bool slurm_bf_licenses_equal(bf_licenses_t *a, bf_licenses_t *b)
 {
-	bf_license_t *entry_a, *entry_b;
-	list_itr_t *iter;
-	bool equivalent = true;
-
-	iter = list_iterator_create(a);
-	while ((entry_a = list_next(iter))) {
-		entry_b = list_find_first(b, _bf_licenses_find_rec,
-					  entry_a->name);
+	for (int i = a->count - 1; i >= 0; i--) {
+		bf_license_t *entry_a = &a->entries[i];
+		bf_license_t *entry_b = NULL;
+
+		for (int j = b->count - 1; j >= 0; j--) {
+			if (!b->entries[j].resv_ptr &&
+			    (b->entries[j].id == entry_a->id)) {
+				entry_b = &b->entries[j];
+				break;
+			}
+		}
 
 		if (!entry_b || (entry_a->remaining != entry_b->remaining) ||
-		    (entry_a->resv_ptr != entry_b->resv_ptr)) {
-			equivalent = false;
-			break;
-		}
+		    (entry_a->resv_ptr != entry_b->resv_ptr))
+			return false;
 	}
-	list_iterator_destroy(iter);
 
-	return equivalent;
+	return true;
 }
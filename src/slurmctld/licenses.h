@@ -44,6 +44,7 @@
 
 typedef struct {
 	char *		name;		/* name associated with a license */
+	uint32_t	id;		/* license name id, 0 if not resolved */
 	uint32_t	total;		/* total license configued */
 	uint32_t	used;		/* used licenses */
 	uint32_t	reserved;	/* currently reserved licenses */
@@ -53,17 +54,24 @@ typedef struct {
 	time_t last_update;		/* last updated timestamp (for remote) */
 } licenses_t;
 
-/*
- * In the future this should change to a more performant data structure.
- */
-typedef struct xlist bf_licenses_t;
-
 typedef struct {
-	char *name;
+	char *name;		/* interned license name, do not free */
+	uint32_t id;		/* license name id */
 	uint32_t remaining;
 	slurmctld_resv_t *resv_ptr;
 } bf_license_t;
 
+/*
+ * Dense array of backfill license records. Backfill copies one of these for
+ * every node space split, so entries refer to interned names and match job
+ * licenses by id rather than duplicating and comparing strings.
+ */
+typedef struct {
+	uint32_t count;		/* entries in use */
+	uint32_t size;		/* entries allocated */
+	bf_license_t *entries;
+} bf_licenses_t;
+
 extern list_t *cluster_license_list;
 extern time_t last_license_update;
 
@@ -236,6 +244,13 @@ extern bool slurm_bf_licenses_avail(bf_licenses_t *licenses,
 #define bf_licenses_equal(_x, _y) (_x ? slurm_bf_licenses_equal(_x, _y) : true)
 extern bool slurm_bf_licenses_equal(bf_licenses_t *a, bf_licenses_t *b);
 
-#define FREE_NULL_BF_LICENSES(_x) FREE_NULL_LIST(_x)
+extern void slurm_bf_licenses_free(bf_licenses_t *licenses);
+
+#define FREE_NULL_BF_LICENSES(_x)		\
+do {						\
+	if (_x)					\
+		slurm_bf_licenses_free(_x);	\
+	_x = NULL;				\
+} while (0)
 
 #endif /* !_LICENSES_H */
@@ -41,11 +41,19 @@
 #include <pthread.h>
 #include <string.h>
 #include <sys/types.h>
+#include <time.h>
 
+#include "src/common/metrics.h"
+#include "src/common/probes.h"
+#include "src/common/slurm_time.h"
+#include "src/common/trace_ring.h"
+#include "src/common/xmalloc.h"
 #include "src/slurmctld/locks.h"
 #include "src/slurmctld/slurmctld.h"
 
-static pthread_mutex_t state_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t state_mutex[STATE_FILE_CNT] = {
+	[0 ... (STATE_FILE_CNT - 1)] = PTHREAD_MUTEX_INITIALIZER,
+};
 
 static pthread_rwlock_t slurmctld_locks[5] = {
 	PTHREAD_RWLOCK_INITIALIZER,
@@ -55,6 +63,37 @@ static pthread_rwlock_t slurmctld_locks[5] = {
 	PTHREAD_RWLOCK_INITIALIZER,
 };
 
+/* Lock contention statistics for one lock type and level or one caller */
+typedef struct {
+	const char *name;
+	uint64_t count;
+	uint64_t wait_time;	/* usec */
+	uint64_t wait_max;	/* usec */
+	uint64_t hold_time;	/* usec */
+	uint64_t hold_max;	/* usec */
+	uint32_t wait_hist[LOCK_STATS_HIST_CNT];
+	uint32_t hold_hist[LOCK_STATS_HIST_CNT];
+} lock_stat_t;
+
+/* Callers past this many distinct functions are reported together */
+#define LOCK_STATS_CALLER_CNT 512
+
+static pthread_mutex_t lock_stats_mutex = PTHREAD_MUTEX_INITIALIZER;
+static lock_stat_t lock_type_stats[LOCK_DATATYPE_CNT][2] = {
+	{ { .name = "conf read" }, { .name = "conf write" } },
+	{ { .name = "job read" }, { .name = "job write" } },
+	{ { .name = "node read" }, { .name = "node write" } },
+	{ { .name = "part read" }, { .name = "part write" } },
+	{ { .name = "fed read" }, { .name = "fed write" } },
+};
+static lock_stat_t lock_caller_stats[LOCK_STATS_CALLER_CNT];
+static lock_stat_t lock_caller_other = { .name = "(other)" };
+
+/* When this thread acquired each lock, and who asked for them */
+static __thread uint64_t lock_acquired[LOCK_DATATYPE_CNT];
+static __thread const char *lock_caller = NULL;
+static __thread uint64_t lock_caller_acquired = 0;
+
 #ifndef NDEBUG
 /*
  * Used to protect against double-locking within a single thread. Calling
@@ -75,10 +114,19 @@ static __thread bool slurmctld_locked = false;
 
 static __thread slurmctld_lock_t thread_locks;
 
+/*
+ * Bitmap of the state file locks held by this thread, used to enforce the
+ * documented lock ordering.
+ */
+static __thread uint32_t thread_state_files = 0;
+
 static bool _store_locks(slurmctld_lock_t lock_levels)
 {
 	if (slurmctld_locked)
 		return false;
+	/* slurmctld locks must never be requested under a state file lock */
+	if (thread_state_files)
+		return false;
 	slurmctld_locked = true;
 
 	memcpy((void *) &thread_locks, (void *) &lock_levels,
@@ -106,59 +154,169 @@ extern bool verify_lock(lock_datatype_t datatype, lock_level_t level)
 {
 	return (((lock_level_t *) &thread_locks)[datatype] >= level);
 }
+
+static bool _store_state_file(state_file_t file)
+{
+	/* lock must not be held already nor any lock ordered after it */
+	if (thread_state_files >> file)
+		return false;
+	thread_state_files |= (1 << file);
+
+	return true;
+}
+
+static bool _clear_state_file(state_file_t file)
+{
+	if (!(thread_state_files & (1 << file)))
+		return false;
+	thread_state_files &= ~(1 << file);
+
+	return true;
+}
 #endif
 
-/* lock_slurmctld - Issue the required lock requests in a well defined order */
-extern void lock_slurmctld(slurmctld_lock_t lock_levels)
+static uint64_t _now_usec(void)
 {
-	xassert(_store_locks(lock_levels));
+	struct timespec ts;
 
-	if (lock_levels.conf == READ_LOCK)
-		slurm_rwlock_rdlock(&slurmctld_locks[CONF_LOCK]);
-	else if (lock_levels.conf == WRITE_LOCK)
-		slurm_rwlock_wrlock(&slurmctld_locks[CONF_LOCK]);
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (((uint64_t) ts.tv_sec) * USEC_IN_SEC) +
+	       (ts.tv_nsec / NSEC_IN_USEC);
+}
+
+static int _lock_stat_bucket(uint64_t usec)
+{
+	uint64_t limit = 10;
+	int bucket = 0;
 
-	if (lock_levels.job == READ_LOCK)
-		slurm_rwlock_rdlock(&slurmctld_locks[JOB_LOCK]);
-	else if (lock_levels.job == WRITE_LOCK)
-		slurm_rwlock_wrlock(&slurmctld_locks[JOB_LOCK]);
+	while ((bucket < (LOCK_STATS_HIST_CNT - 1)) && (usec >= limit)) {
+		limit *= 10;
+		bucket++;
+	}
 
-	if (lock_levels.node == READ_LOCK)
-		slurm_rwlock_rdlock(&slurmctld_locks[NODE_LOCK]);
-	else if (lock_levels.node == WRITE_LOCK)
-		slurm_rwlock_wrlock(&slurmctld_locks[NODE_LOCK]);
+	return bucket;
+}
 
-	if (lock_levels.part == READ_LOCK)
-		slurm_rwlock_rdlock(&slurmctld_locks[PART_LOCK]);
-	else if (lock_levels.part == WRITE_LOCK)
-		slurm_rwlock_wrlock(&slurmctld_locks[PART_LOCK]);
+static lock_stat_t *_find_caller_stat(const char *caller)
+{
+	uint32_t inx = (((uintptr_t) caller) >> 3) % LOCK_STATS_CALLER_CNT;
+
+	/*
+	 * __func__ yields one string per function, so the pointer identifies
+	 * the caller without any string comparisons.
+	 */
+	for (int i = 0; i < LOCK_STATS_CALLER_CNT; i++) {
+		lock_stat_t *stat = &lock_caller_stats[inx];
+
+		if (stat->name == caller)
+			return stat;
+		if (!stat->name) {
+			stat->name = caller;
+			return stat;
+		}
+		inx = (inx + 1) % LOCK_STATS_CALLER_CNT;
+	}
 
-	if (lock_levels.fed == READ_LOCK)
-		slurm_rwlock_rdlock(&slurmctld_locks[FED_LOCK]);
-	else if (lock_levels.fed == WRITE_LOCK)
-		slurm_rwlock_wrlock(&slurmctld_locks[FED_LOCK]);
+	return &lock_caller_other;
+}
+
+static void _record_wait(lock_stat_t *stat, uint64_t usec)
+{
+	stat->count++;
+	stat->wait_time += usec;
+	if (usec > stat->wait_max)
+		stat->wait_max = usec;
+	stat->wait_hist[_lock_stat_bucket(usec)]++;
+}
+
+static void _record_hold(lock_stat_t *stat, uint64_t usec)
+{
+	stat->hold_time += usec;
+	if (usec > stat->hold_max)
+		stat->hold_max = usec;
+	stat->hold_hist[_lock_stat_bucket(usec)]++;
+}
+
+/* Pack lock levels two bits per lock for trace_ring_record() */
+static uint32_t _trace_levels(lock_level_t *levels)
+{
+	uint32_t packed = 0;
+
+	for (int i = 0; i < LOCK_DATATYPE_CNT; i++)
+		packed |= (levels[i] & 0x3) << (i * 2);
+
+	return packed;
+}
+
+/* lock_slurmctld - Issue the required lock requests in a well defined order */
+extern void lock_slurmctld_caller(slurmctld_lock_t lock_levels,
+				  const char *caller)
+{
+	lock_level_t *levels = (lock_level_t *) &lock_levels;
+	uint64_t wait[LOCK_DATATYPE_CNT] = { 0 };
+	uint64_t begin, start;
+
+	xassert(_store_locks(lock_levels));
+
+	begin = start = _now_usec();
+	for (int i = 0; i < LOCK_DATATYPE_CNT; i++) {
+		if (levels[i] == READ_LOCK)
+			slurm_rwlock_rdlock(&slurmctld_locks[i]);
+		else if (levels[i] == WRITE_LOCK)
+			slurm_rwlock_wrlock(&slurmctld_locks[i]);
+		else
+			continue;
+
+		lock_acquired[i] = _now_usec();
+		wait[i] = lock_acquired[i] - start;
+		start = lock_acquired[i];
+	}
+	lock_caller = caller;
+	lock_caller_acquired = start;
+	trace_ring_record(TRACE_EVENT_LOCK, _trace_levels(levels), 0,
+			  (start - begin));
+	SLURM_PROBE3(lock__acquired, caller, _trace_levels(levels),
+		     (start - begin));
+
+	slurm_mutex_lock(&lock_stats_mutex);
+	for (int i = 0; i < LOCK_DATATYPE_CNT; i++) {
+		if (levels[i])
+			_record_wait(&lock_type_stats[i][levels[i] - 1],
+				     wait[i]);
+	}
+	_record_wait(_find_caller_stat(caller), (start - begin));
+	slurm_mutex_unlock(&lock_stats_mutex);
 }
 
 /* unlock_slurmctld - Issue the required unlock requests in a well
  *	defined order */
 extern void unlock_slurmctld(slurmctld_lock_t lock_levels)
 {
-	xassert(_clear_locks(lock_levels));
-
-	if (lock_levels.fed)
-		slurm_rwlock_unlock(&slurmctld_locks[FED_LOCK]);
-
-	if (lock_levels.part)
-		slurm_rwlock_unlock(&slurmctld_locks[PART_LOCK]);
+	lock_level_t *levels = (lock_level_t *) &lock_levels;
+	uint64_t now = _now_usec();
 
-	if (lock_levels.node)
-		slurm_rwlock_unlock(&slurmctld_locks[NODE_LOCK]);
+	xassert(_clear_locks(lock_levels));
 
-	if (lock_levels.job)
-		slurm_rwlock_unlock(&slurmctld_locks[JOB_LOCK]);
+	for (int i = (LOCK_DATATYPE_CNT - 1); i >= 0; i--) {
+		if (levels[i])
+			slurm_rwlock_unlock(&slurmctld_locks[i]);
+	}
 
-	if (lock_levels.conf)
-		slurm_rwlock_unlock(&slurmctld_locks[CONF_LOCK]);
+	slurm_mutex_lock(&lock_stats_mutex);
+	for (int i = 0; i < LOCK_DATATYPE_CNT; i++) {
+		if (levels[i])
+			_record_hold(&lock_type_stats[i][levels[i] - 1],
+				     (now - lock_acquired[i]));
+	}
+	if (lock_caller)
+		_record_hold(_find_caller_stat(lock_caller),
+			     (now - lock_caller_acquired));
+	trace_ring_record(TRACE_EVENT_UNLOCK, _trace_levels(levels), 0,
+			  (lock_caller ? (now - lock_caller_acquired) : 0));
+	SLURM_PROBE3(lock__released, lock_caller, _trace_levels(levels),
+		     (now - lock_caller_acquired));
+	lock_caller = NULL;
+	slurm_mutex_unlock(&lock_stats_mutex);
 }
 
 /*
@@ -206,12 +364,142 @@ int report_locks_set(void)
 
 
 /* un/lock semaphore used for saving state of slurmctld */
-extern void lock_state_files(void)
+extern void lock_state_file(state_file_t file)
+{
+	xassert(file < STATE_FILE_CNT);
+	xassert(_store_state_file(file));
+
+	slurm_mutex_lock(&state_mutex[file]);
+}
+
+extern void unlock_state_file(state_file_t file)
+{
+	xassert(file < STATE_FILE_CNT);
+	xassert(_clear_state_file(file));
+
+	slurm_mutex_unlock(&state_mutex[file]);
+}
+
+static void _pack_lock_stat(lock_stat_t *stat, int inx, char **name,
+			    uint64_t *count, uint64_t *wait_time,
+			    uint64_t *wait_max, uint64_t *hold_time,
+			    uint64_t *hold_max, uint32_t *wait_hist,
+			    uint32_t *hold_hist)
 {
-	slurm_mutex_lock(&state_mutex);
+	name[inx] = (char *) stat->name;
+	count[inx] = stat->count;
+	wait_time[inx] = stat->wait_time;
+	wait_max[inx] = stat->wait_max;
+	hold_time[inx] = stat->hold_time;
+	hold_max[inx] = stat->hold_max;
+	memcpy(&wait_hist[inx * LOCK_STATS_HIST_CNT], stat->wait_hist,
+	       sizeof(stat->wait_hist));
+	memcpy(&hold_hist[inx * LOCK_STATS_HIST_CNT], stat->hold_hist,
+	       sizeof(stat->hold_hist));
 }
 
-extern void unlock_state_files(void)
+extern void pack_lock_stats(buf_t *buffer, uint16_t protocol_version)
 {
-	slurm_mutex_unlock(&state_mutex);
+	uint32_t type_cnt = LOCK_DATATYPE_CNT * 2, cnt = 0;
+	uint32_t max_cnt = type_cnt + LOCK_STATS_CALLER_CNT + 1;
+	char **name = xcalloc(max_cnt, sizeof(*name));
+	uint64_t *count = xcalloc(max_cnt, sizeof(*count));
+	uint64_t *wait_time = xcalloc(max_cnt, sizeof(*wait_time));
+	uint64_t *wait_max = xcalloc(max_cnt, sizeof(*wait_max));
+	uint64_t *hold_time = xcalloc(max_cnt, sizeof(*hold_time));
+	uint64_t *hold_max = xcalloc(max_cnt, sizeof(*hold_max));
+	uint32_t *wait_hist = xcalloc((max_cnt * LOCK_STATS_HIST_CNT),
+				      sizeof(*wait_hist));
+	uint32_t *hold_hist = xcalloc((max_cnt * LOCK_STATS_HIST_CNT),
+				      sizeof(*hold_hist));
+
+	slurm_mutex_lock(&lock_stats_mutex);
+	for (int i = 0; i < LOCK_DATATYPE_CNT; i++) {
+		for (int j = 0; j < 2; j++)
+			_pack_lock_stat(&lock_type_stats[i][j], cnt++, name,
+					count, wait_time, wait_max, hold_time,
+					hold_max, wait_hist, hold_hist);
+	}
+	for (int i = 0; i < LOCK_STATS_CALLER_CNT; i++) {
+		if (lock_caller_stats[i].name)
+			_pack_lock_stat(&lock_caller_stats[i], cnt++, name,
+					count, wait_time, wait_max, hold_time,
+					hold_max, wait_hist, hold_hist);
+	}
+	if (lock_caller_other.count)
+		_pack_lock_stat(&lock_caller_other, cnt++, name, count,
+				wait_time, wait_max, hold_time, hold_max,
+				wait_hist, hold_hist);
+	slurm_mutex_unlock(&lock_stats_mutex);
+
+	if (protocol_version >= SLURM_24_11_PROTOCOL_VERSION) {
+		pack32(LOCK_STATS_HIST_CNT, buffer);
+		pack32(type_cnt, buffer);
+		packstr_array(name, cnt, buffer);
+		pack64_array(count, cnt, buffer);
+		pack64_array(wait_time, cnt, buffer);
+		pack64_array(wait_max, cnt, buffer);
+		pack64_array(hold_time, cnt, buffer);
+		pack64_array(hold_max, cnt, buffer);
+		pack32_array(wait_hist, (cnt * LOCK_STATS_HIST_CNT), buffer);
+		pack32_array(hold_hist, (cnt * LOCK_STATS_HIST_CNT), buffer);
+	}
+
+	xfree(name);
+	xfree(count);
+	xfree(wait_time);
+	xfree(wait_max);
+	xfree(hold_time);
+	xfree(hold_max);
+	xfree(wait_hist);
+	xfree(hold_hist);
+}
+
+extern void reset_lock_stats(void)
+{
+	slurm_mutex_lock(&lock_stats_mutex);
+	for (int i = 0; i < LOCK_DATATYPE_CNT; i++) {
+		for (int j = 0; j < 2; j++) {
+			const char *name = lock_type_stats[i][j].name;
+
+			memset(&lock_type_stats[i][j], 0, sizeof(lock_stat_t));
+			lock_type_stats[i][j].name = name;
+		}
+	}
+	memset(lock_caller_stats, 0, sizeof(lock_caller_stats));
+	memset(&lock_caller_other, 0, sizeof(lock_caller_other));
+	lock_caller_other.name = "(other)";
+	slurm_mutex_unlock(&lock_stats_mutex);
+}
+
+extern void lock_register_metrics(void)
+{
+	static const char *labels[LOCK_DATATYPE_CNT][2] = {
+		{ "lock=\"conf\",level=\"read\"",
+		  "lock=\"conf\",level=\"write\"" },
+		{ "lock=\"job\",level=\"read\"",
+		  "lock=\"job\",level=\"write\"" },
+		{ "lock=\"node\",level=\"read\"",
+		  "lock=\"node\",level=\"write\"" },
+		{ "lock=\"part\",level=\"read\"",
+		  "lock=\"part\",level=\"write\"" },
+		{ "lock=\"fed\",level=\"read\"",
+		  "lock=\"fed\",level=\"write\"" },
+	};
+
+	for (int i = 0; i < LOCK_DATATYPE_CNT; i++) {
+		for (int j = 0; j < 2; j++) {
+			lock_stat_t *stat = &lock_type_stats[i][j];
+
+			metric_register_src("lock_acquisitions", labels[i][j],
+					    METRIC_COUNTER,
+					    "slurmctld lock acquisitions",
+					    &stat->count, sizeof(stat->count));
+			metric_register_src("lock_wait_usec", labels[i][j],
+					    METRIC_COUNTER,
+					    "Time spent waiting for slurmctld locks",
+					    &stat->wait_time,
+					    sizeof(stat->wait_time));
+		}
+	}
 }
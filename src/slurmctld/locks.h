@@ -93,6 +93,8 @@
 
 #include <stdbool.h>
 
+#include "src/common/pack.h"
+
 /* levels of locking required for each data structure */
 typedef enum {
 	NO_LOCK,
@@ -115,23 +117,69 @@ typedef enum {
 	NODE_LOCK,
 	PART_LOCK,
 	FED_LOCK,
+	LOCK_DATATYPE_CNT
 }	lock_datatype_t;
 
 #ifndef NDEBUG
 extern bool verify_lock(lock_datatype_t datatype, lock_level_t level);
 #endif
 
-/* lock_slurmctld - Issue the required lock requests in a well defined order */
-extern void lock_slurmctld (slurmctld_lock_t lock_levels);
+/*
+ * lock_slurmctld - Issue the required lock requests in a well defined order
+ *
+ * The calling function is recorded to report lock wait and hold times per
+ * caller (see pack_lock_stats()).
+ */
+#define lock_slurmctld(lock_levels) \
+	lock_slurmctld_caller(lock_levels, __func__)
+extern void lock_slurmctld_caller(slurmctld_lock_t lock_levels,
+				  const char *caller);
 
 /* unlock_slurmctld - Issue the required unlock requests in a well
  *	defined order */
-extern void unlock_slurmctld (slurmctld_lock_t lock_levels);
+extern void unlock_slurmctld(slurmctld_lock_t lock_levels);
 
 extern int report_locks_set(void);
 
-/* un/lock semaphore used for saving state of slurmctld */
-extern void lock_state_files ( void );
-extern void unlock_state_files ( void );
+/*
+ * Lock wait and hold time histogram buckets, in microseconds:
+ * <10, <100, <1000, <10000, <100000, <1000000, and anything longer.
+ */
+#define LOCK_STATS_HIST_CNT 7
+
+/*
+ * Pack lock contention statistics for REQUEST_STATS_INFO, one entry per
+ * lock type and level followed by one entry per calling function.
+ */
+extern void pack_lock_stats(buf_t *buffer, uint16_t protocol_version);
+
+/* Reset all lock contention statistics */
+extern void reset_lock_stats(void);
+
+/* Export lock wait counts and times through the metrics registry */
+extern void lock_register_metrics(void);
+
+/* StateSaveLocation files, each protected by its own lock */
+typedef enum {
+	STATE_FILE_FRONT_END,
+	STATE_FILE_JOB,
+	STATE_FILE_NODE,
+	STATE_FILE_PART,
+	STATE_FILE_PRIORITY,
+	STATE_FILE_RESV,
+	STATE_FILE_TRIGGER,
+	STATE_FILE_CNT
+}	state_file_t;
+
+/*
+ * un/lock semaphore used for saving state of slurmctld
+ *
+ * Each state file has an independent lock so that saving one file does not
+ * wait for another to be written out. If more than one lock is needed they
+ * must be taken in increasing state_file_t order, and always after any
+ * lock_slurmctld() locks. Development builds abort() on ordering violations.
+ */
+extern void lock_state_file(state_file_t file);
+extern void unlock_state_file(state_file_t file);
 
 #endif
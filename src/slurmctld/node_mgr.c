@@ -226,7 +226,7 @@ int dump_all_node_state ( void )
 	unlock_slurmctld (node_read_lock);
 
 	/* write the buffer to file */
-	lock_state_files();
+	lock_state_file(STATE_FILE_NODE);
 	log_fd = creat (new_file, 0600);
 	if (log_fd < 0) {
 		error ("Can't save state, error creating file %s %m", new_file);
@@ -266,7 +266,7 @@ int dump_all_node_state ( void )
 	xfree (old_file);
 	xfree (reg_file);
 	xfree (new_file);
-	unlock_state_files ();
+	unlock_state_file(STATE_FILE_NODE);
 
 	FREE_NULL_BUFFER(buffer);
 	END_TIMER2(__func__);
@@ -302,14 +302,14 @@ static buf_t *_open_node_state_file(char **state_file)
 	*state_file = xstrdup(slurm_conf.state_save_location);
 	xstrcat(*state_file, "/node_state");
 
-	if (!(buf = create_mmap_buf(*state_file)))
+	if (!(buf = state_file_open(*state_file)))
 		error("Could not open node state file %s: %m", *state_file);
 	else
 		return buf;
 
 	error("NOTE: Trying backup state save file. Information may be lost!");
 	xstrcat(*state_file, ".old");
-	return create_mmap_buf(*state_file);
+	return state_file_open(*state_file);
 }
 
 /*
@@ -340,16 +340,16 @@ extern int load_all_node_state ( bool state_only )
 		power_save_mode = true;
 
 	/* read the file */
-	lock_state_files ();
+	lock_state_file(STATE_FILE_NODE);
 	buffer = _open_node_state_file(&state_file);
 	if (!buffer) {
 		info("No node state file (%s) to recover", state_file);
 		xfree(state_file);
-		unlock_state_files();
+		unlock_state_file(STATE_FILE_NODE);
 		return ENOENT;
 	}
 	xfree(state_file);
-	unlock_state_files();
+	unlock_state_file(STATE_FILE_NODE);
 
 	safe_unpackstr(&ver_str, buffer);
 	debug3("Version string in node_state header is %s", ver_str);
@@ -3162,9 +3162,24 @@ extern int validate_node_specs(slurm_msg_t *slurm_msg, bool *newly_up,
 					node_ptr->index);
 			xfree(node_ptr->features_act);
 			node_ptr->features_act = tmp_feature;
-			(void) update_node_active_features(
-				node_ptr->name, node_ptr->features_act,
-				FEATURE_MODE_IND);
+			/*
+			 * Only rebuild the active feature bitmaps if there was
+			 * a change, this is O(features * nodes) and every node
+			 * reports its active features on each registration.
+			 */
+			if (xstrcmp(node_ptr->features_act,
+				    orig_features_act)) {
+				(void) update_node_active_features(
+					node_ptr->name, node_ptr->features_act,
+					FEATURE_MODE_IND);
+			} else {
+				bitstr_t *node_bitmap =
+					bit_alloc(node_record_count);
+				bit_set(node_bitmap, node_ptr->index);
+				(void) node_features_g_node_update(
+					node_ptr->features_act, node_bitmap);
+				FREE_NULL_BITMAP(node_bitmap);
+			}
 		}
 	}
 	xfree(orig_features);
@@ -4415,6 +4430,7 @@ extern void push_reconfig_to_slurmd(void)
 {
 #ifndef HAVE_FRONT_END
 	agent_arg_t *ver_args[RELEVANT_VER] = { 0 }, *curr_args;
+	config_response_msg_t *config = NULL;
 	node_record_t *node_ptr;
 	int ver;
 
@@ -4452,7 +4468,14 @@ extern void push_reconfig_to_slurmd(void)
 				continue;
 			if (!curr_args->hostlist) {
 				curr_args->hostlist = hostlist_create(NULL);
-				curr_args->msg_args = new_config_response(true);
+				/* Only read the configs once */
+				if (!config) {
+					config = new_config_response(true);
+					curr_args->msg_args = config;
+				} else {
+					curr_args->msg_args =
+						copy_config_response(config);
+				}
 			}
 			hostlist_push_host(curr_args->hostlist, node_ptr->name);
 			curr_args->node_count++;
@@ -4894,8 +4917,7 @@ extern int send_nodes_to_accounting(time_t event_time)
 /* node_fini - free all memory associated with node records */
 extern void node_fini (void)
 {
-	FREE_NULL_LIST(active_feature_list);
-	FREE_NULL_LIST(avail_feature_list);
+	free_feature_lists();
 	FREE_NULL_BITMAP(avail_node_bitmap);
 	FREE_NULL_BITMAP(bf_ignore_node_bitmap);
 	FREE_NULL_BITMAP(booting_node_bitmap);
@@ -5416,7 +5438,7 @@ static int _delete_node_ptr(node_record_t *node_ptr)
 	_remove_node_from_features(node_ptr);
 	gres_node_remove(node_ptr);
 
-	xhash_pop_str(node_hash_table, node_ptr->name);
+	node_hash_remove(node_ptr);
 	slurm_conf_remove_node(node_ptr->name);
 	delete_node_record(node_ptr);
 
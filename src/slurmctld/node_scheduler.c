@@ -551,9 +551,8 @@ extern void find_feature_nodes(list_t *feature_list, bool can_reboot)
 	while ((job_feat_ptr = list_next(feat_iter))) {
 		FREE_NULL_BITMAP(job_feat_ptr->node_bitmap_active);
 		FREE_NULL_BITMAP(job_feat_ptr->node_bitmap_avail);
-		node_feat_ptr = list_find_first(active_feature_list,
-						list_find_feature,
-						job_feat_ptr->name);
+		node_feat_ptr = find_node_feature(active_feature_list,
+						  job_feat_ptr->name);
 		if (node_feat_ptr && node_feat_ptr->node_bitmap) {
 			job_feat_ptr->node_bitmap_active =
 				bit_copy(node_feat_ptr->node_bitmap);
@@ -562,9 +561,8 @@ extern void find_feature_nodes(list_t *feature_list, bool can_reboot)
 				bit_alloc(node_record_count);
 		}
 		if (can_reboot && job_feat_ptr->changeable) {
-			node_feat_ptr = list_find_first(avail_feature_list,
-							list_find_feature,
-							job_feat_ptr->name);
+			node_feat_ptr = find_node_feature(avail_feature_list,
+							  job_feat_ptr->name);
 			if (node_feat_ptr && node_feat_ptr->node_bitmap) {
 				job_feat_ptr->node_bitmap_avail =
 					bit_copy(node_feat_ptr->node_bitmap);
@@ -721,8 +719,7 @@ extern bitstr_t *build_active_feature_bitmap2(char *reboot_features)
 	tok = strtok_r(tmp, delim, &save_ptr);
 
 	while (tok) {
-		node_feat_ptr = list_find_first(active_feature_list,
-						list_find_feature, tok);
+		node_feat_ptr = find_node_feature(active_feature_list, tok);
 		if (node_feat_ptr && node_feat_ptr->node_bitmap) {
 			/*
 			 * Found feature, add nodes with this feature and
@@ -1537,6 +1534,42 @@ static void _bit_or_cond(job_record_t *job_ptr, bitstr_t *bitmap)
 				      _bit_or_cond_internal, bitmap);
 }
 
+/*
+ * Run select_g_job_test() in SELECT_MODE_TEST_ONLY unless the same node
+ * selection already failed for this job in the current _pick_best_nodes().
+ * In TEST_ONLY mode the result only depends on the nodes offered, so the
+ * failure can be reused.
+ * IN/OUT failed_bitmap - copy of the last rejected node bitmap
+ * IN/OUT failed_rc - return code of the last rejected node bitmap
+ */
+static int _job_test_only(job_record_t *job_ptr, bitstr_t *bitmap,
+			  uint32_t min_nodes, uint32_t max_nodes,
+			  uint32_t req_nodes, list_t *preemptee_candidates,
+			  resv_exc_t *resv_exc_ptr, bitstr_t **failed_bitmap,
+			  int *failed_rc)
+{
+	bitstr_t *test_bitmap;
+	int rc;
+
+	if (*failed_bitmap && bit_equal(*failed_bitmap, bitmap))
+		return *failed_rc;
+
+	/* select_g_job_test() is destructive of the bitmap */
+	test_bitmap = bit_copy(bitmap);
+	rc = select_g_job_test(job_ptr, bitmap, min_nodes, max_nodes,
+			       req_nodes, SELECT_MODE_TEST_ONLY,
+			       preemptee_candidates, NULL, resv_exc_ptr);
+	if (rc == SLURM_SUCCESS) {
+		FREE_NULL_BITMAP(test_bitmap);
+	} else {
+		FREE_NULL_BITMAP(*failed_bitmap);
+		*failed_bitmap = test_bitmap;
+		*failed_rc = rc;
+	}
+
+	return rc;
+}
+
 /*
  * _pick_best_nodes - from a weight order list of all nodes satisfying a
  *	job's specifications, select the "best" for use
@@ -1592,8 +1625,9 @@ static int _pick_best_nodes(struct node_set *node_set_ptr, int node_set_size,
 	bitstr_t *avail_bitmap = NULL, *total_bitmap = NULL;
 	bitstr_t *backup_bitmap = NULL;
 	bitstr_t *possible_bitmap = NULL;
+	bitstr_t *failed_bitmap = NULL;	/* Last node set never runnable */
 	bitstr_t *node_set_map;
-	int max_feature, min_feature;
+	int max_feature, min_feature, failed_rc = SLURM_SUCCESS;
 	bool runable_ever  = false;	/* Job can ever run */
 	bool runable_avail = false;	/* Job can run with available nodes */
 	bool tried_sched = false;	/* Tried to schedule with avail nodes */
@@ -1960,6 +1994,7 @@ try_sched:
 				}
 				FREE_NULL_BITMAP(total_bitmap);
 				FREE_NULL_BITMAP(possible_bitmap);
+				FREE_NULL_BITMAP(failed_bitmap);
 				*select_bitmap = avail_bitmap;
 				return SLURM_SUCCESS;
 			} else {
@@ -1999,6 +2034,7 @@ try_sched:
 			     (bit_set_count(avail_bitmap) <= max_nodes)) {
 				FREE_NULL_BITMAP(total_bitmap);
 				FREE_NULL_BITMAP(possible_bitmap);
+				FREE_NULL_BITMAP(failed_bitmap);
 				*select_bitmap = avail_bitmap;
 				return SLURM_SUCCESS;
 			}
@@ -2023,14 +2059,15 @@ try_sched:
 				avail_bitmap = bit_copy(total_bitmap);
 				bit_and(avail_bitmap, avail_node_bitmap);
 				job_ptr->details->pn_min_memory = orig_req_mem;
-				pick_code = select_g_job_test(job_ptr,
-						avail_bitmap,
-						min_nodes,
-						max_nodes,
-						req_nodes,
-						SELECT_MODE_TEST_ONLY,
-						preemptee_candidates, NULL,
-						resv_exc_ptr);
+				pick_code = _job_test_only(job_ptr,
+							   avail_bitmap,
+							   min_nodes,
+							   max_nodes,
+							   req_nodes,
+							   preemptee_candidates,
+							   resv_exc_ptr,
+							   &failed_bitmap,
+							   &failed_rc);
 
 				if (job_ptr->details->pn_min_memory) {
 					if (job_ptr->details->pn_min_memory <
@@ -2056,14 +2093,15 @@ try_sched:
 			}
 			if (!runable_ever) {
 				job_ptr->details->pn_min_memory = orig_req_mem;
-				pick_code = select_g_job_test(job_ptr,
-						total_bitmap,
-						min_nodes,
-						max_nodes,
-						req_nodes,
-						SELECT_MODE_TEST_ONLY,
-						preemptee_candidates, NULL,
-						resv_exc_ptr);
+				pick_code = _job_test_only(job_ptr,
+							   total_bitmap,
+							   min_nodes,
+							   max_nodes,
+							   req_nodes,
+							   preemptee_candidates,
+							   resv_exc_ptr,
+							   &failed_bitmap,
+							   &failed_rc);
 
 				if (job_ptr->details->pn_min_memory) {
 					if (job_ptr->details->pn_min_memory <
@@ -2092,6 +2130,7 @@ try_sched:
 	}
 	FREE_NULL_BITMAP(avail_bitmap);
 	FREE_NULL_BITMAP(total_bitmap);
+	FREE_NULL_BITMAP(failed_bitmap);
 
 	/* The job is not able to start right now, return a
 	 * value indicating when the job can start */
@@ -2520,9 +2559,9 @@ static int _get_resv_mpi_ports(job_record_t *job_ptr,
  *	   the request, (e.g. best-fit or other criterion)
  *	3) Call allocate_nodes() to perform the actual allocation
  */
-extern int select_nodes(job_record_t *job_ptr, bool test_only,
-			bitstr_t **select_node_bitmap, char **err_msg,
-			bool submission, uint32_t scheduler_type)
+static int _select_nodes(job_record_t *job_ptr, bool test_only,
+			 bitstr_t **select_node_bitmap, char **err_msg,
+			 bool submission, uint32_t scheduler_type)
 {
 	int bb, error_code = SLURM_SUCCESS, i, node_set_size = 0;
 	bitstr_t *select_bitmap = NULL;
@@ -3066,6 +3105,7 @@ extern int select_nodes(job_record_t *job_ptr, bool test_only,
 			uint32_t *tmp = xmalloc(sizeof(uint32_t));
 			*tmp = job_ptr->job_id;
 			list_append(resume_job_list, tmp);
+			power_save_wake();
 		}
 	}
 	if (configuring || IS_JOB_POWER_UP_NODE(job_ptr) ||
@@ -3151,6 +3191,20 @@ cleanup:
 	return error_code;
 }
 
+extern int select_nodes(job_record_t *job_ptr, bool test_only,
+			bitstr_t **select_node_bitmap, char **err_msg,
+			bool submission, uint32_t scheduler_type)
+{
+	int rc;
+	DEF_PHASE_TIMER(select);
+
+	START_PHASE_TIMER(select);
+	rc = _select_nodes(job_ptr, test_only, select_node_bitmap, err_msg,
+			   submission, scheduler_type);
+	END_PHASE_TIMER(select, &sched_phase_stats[SCHED_PHASE_SELECT_NODES]);
+
+	return rc;
+}
 /*
  * get_node_cnts - determine the number of nodes for the requested job.
  * IN job_ptr - pointer to the job record.
@@ -386,7 +386,7 @@ int dump_all_part_state(void)
 	unlock_slurmctld(part_read_lock);
 
 	/* write the buffer to file */
-	lock_state_files();
+	lock_state_file(STATE_FILE_PART);
 	log_fd = creat(new_file, 0600);
 	if (log_fd < 0) {
 		error("Can't save state, error creating file %s, %m",
@@ -429,7 +429,7 @@ int dump_all_part_state(void)
 	xfree(old_file);
 	xfree(reg_file);
 	xfree(new_file);
-	unlock_state_files();
+	unlock_state_file(STATE_FILE_PART);
 
 	FREE_NULL_BUFFER(buffer);
 	END_TIMER2(__func__);
@@ -472,7 +472,7 @@ static buf_t *_open_part_state_file(char **state_file)
 
 	*state_file = xstrdup(slurm_conf.state_save_location);
 	xstrcat(*state_file, "/part_state");
-	buf = create_mmap_buf(*state_file);
+	buf = state_file_open(*state_file);
 	if (!buf) {
 		error("Could not open partition state file %s: %m",
 		      *state_file);
@@ -481,7 +481,7 @@ static buf_t *_open_part_state_file(char **state_file)
 
 	error("NOTE: Trying backup partition state save file. Information may be lost!");
 	xstrcat(*state_file, ".old");
-	buf = create_mmap_buf(*state_file);
+	buf = state_file_open(*state_file);
 	return buf;
 }
 
@@ -511,17 +511,17 @@ extern int load_all_part_state(uint16_t reconfig_flags)
 	}
 
 	/* read the file */
-	lock_state_files();
+	lock_state_file(STATE_FILE_PART);
 	buffer = _open_part_state_file(&state_file);
 	if (!buffer) {
 		info("No partition state file (%s) to recover",
 		     state_file);
 		xfree(state_file);
-		unlock_state_files();
+		unlock_state_file(STATE_FILE_PART);
 		return ENOENT;
 	}
 	xfree(state_file);
-	unlock_state_files();
+	unlock_state_file(STATE_FILE_PART);
 
 	safe_unpackstr(&ver_str, buffer);
 	debug3("Version string in part_state header is %s", ver_str);
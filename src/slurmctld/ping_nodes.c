@@ -346,10 +346,12 @@ void ping_nodes (void)
 		xfree (ping_agent_args);
 	} else {
 		hostlist_uniq(ping_agent_args->hostlist);
-		host_str = hostlist_ranged_string_xmalloc(
-				ping_agent_args->hostlist);
-		debug("Spawning ping agent for %s", host_str);
-		xfree(host_str);
+		if (get_log_level() >= LOG_LEVEL_DEBUG) {
+			host_str = hostlist_ranged_string_xmalloc(
+					ping_agent_args->hostlist);
+			debug("Spawning ping agent for %s", host_str);
+			xfree(host_str);
+		}
 		ping_begin();
 		set_agent_arg_r_uid(ping_agent_args, SLURM_AUTH_UID_ANY);
 		agent_queue_request(ping_agent_args);
@@ -360,11 +362,13 @@ void ping_nodes (void)
 		xfree (reg_agent_args);
 	} else {
 		hostlist_uniq(reg_agent_args->hostlist);
-		host_str = hostlist_ranged_string_xmalloc(
-				reg_agent_args->hostlist);
-		debug("Spawning registration agent for %s %d hosts",
-		      host_str, reg_agent_args->node_count);
-		xfree(host_str);
+		if (get_log_level() >= LOG_LEVEL_DEBUG) {
+			host_str = hostlist_ranged_string_xmalloc(
+					reg_agent_args->hostlist);
+			debug("Spawning registration agent for %s %d hosts",
+			      host_str, reg_agent_args->node_count);
+			xfree(host_str);
+		}
 		ping_begin();
 		set_agent_arg_r_uid(reg_agent_args, SLURM_AUTH_UID_ANY);
 		agent_queue_request(reg_agent_args);
@@ -511,10 +515,12 @@ extern void run_health_check(void)
 		xfree (check_agent_args);
 	} else {
 		hostlist_uniq(check_agent_args->hostlist);
-		host_str = hostlist_ranged_string_xmalloc(
-				check_agent_args->hostlist);
-		debug("Spawning health check agent for %s", host_str);
-		xfree(host_str);
+		if (get_log_level() >= LOG_LEVEL_DEBUG) {
+			host_str = hostlist_ranged_string_xmalloc(
+					check_agent_args->hostlist);
+			debug("Spawning health check agent for %s", host_str);
+			xfree(host_str);
+		}
 		ping_begin();
 		set_agent_arg_r_uid(check_agent_args, SLURM_AUTH_UID_ANY);
 		agent_queue_request(check_agent_args);
@@ -577,9 +583,13 @@ extern void update_nodes_acct_gather_data(void)
 		xfree (agent_args);
 	} else {
 		hostlist_uniq(agent_args->hostlist);
-		host_str = hostlist_ranged_string_xmalloc(agent_args->hostlist);
-		log_flag(ENERGY, "Updating acct_gather data for %s", host_str);
-		xfree(host_str);
+		if (slurm_conf.debug_flags & DEBUG_FLAG_ENERGY) {
+			host_str = hostlist_ranged_string_xmalloc(
+					agent_args->hostlist);
+			log_flag(ENERGY, "Updating acct_gather data for %s",
+				 host_str);
+			xfree(host_str);
+		}
 		ping_begin();
 		set_agent_arg_r_uid(agent_args, SLURM_AUTH_UID_ANY);
 		agent_queue_request(agent_args);
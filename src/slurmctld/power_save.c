@@ -100,6 +100,7 @@ uint16_t slurmd_timeout;
 static bool idle_on_node_suspend = false;
 static uint16_t power_save_interval = 10;
 static uint16_t power_save_min_interval = 0;
+static bool power_save_wake_pending = false;
 
 list_t *resume_job_list = NULL;
 
@@ -126,7 +127,7 @@ static uint32_t suspend_exc_state_flags;
 
 static void  _clear_power_config(void);
 static void  _do_failed_nodes(char *hosts);
-static void  _do_power_work(time_t now);
+static time_t _do_power_work(time_t now);
 static void  _do_resume(char *host, char *json);
 static void  _do_suspend(char *host);
 static int   _init_power_config(void);
@@ -411,7 +412,26 @@ static int _pick_exc_nodes(void *x, void *arg)
 }
 
 /* Perform any power change work to nodes */
-static void _do_power_work(time_t now)
+/*
+ * Record the earliest time at which a node's power state is due a change.
+ * Times already past are left to the periodic scan so that nodes which can't
+ * be acted upon (excluded, rate limited) don't force a scan every second.
+ */
+static void _next_power_event(time_t *next_event, time_t event_time,
+			      time_t now)
+{
+	if (event_time <= now)
+		return;
+	if (!*next_event || (event_time < *next_event))
+		*next_event = event_time;
+}
+
+/*
+ * Resume and suspend nodes as needed.
+ * RET the earliest time a SuspendTime, SuspendTimeout or ResumeTimeout of a
+ *     node not acted upon here expires, or 0 if there is none.
+ */
+static time_t _do_power_work(time_t now)
 {
 	int i, susp_total = 0;
 	uint32_t susp_state;
@@ -424,6 +444,7 @@ static void _do_power_work(time_t now)
 	bitstr_t *job_power_node_bitmap;
 	uint32_t *job_id_ptr;
 	bool nodes_updated = false;
+	time_t next_event = 0;
 
 	/* Identify nodes to avoid considering for suspend */
 	if (partial_node_list) {
@@ -636,6 +657,12 @@ static void _do_power_work(time_t now)
 				node_ptr->node_state &= (~NODE_STATE_FAIL);
 			}
 			nodes_updated = true;
+		} else if (_node_state_suspendable(node_ptr) &&
+			   (node_ptr->last_busy != 0) &&
+			   (node_ptr->suspend_time < NO_VAL)) {
+			_next_power_event(&next_event,
+					  (node_ptr->last_busy +
+					   node_ptr->suspend_time + 1), now);
 		}
 
 		if (IS_NODE_POWERING_DOWN(node_ptr) &&
@@ -668,6 +695,10 @@ static void _do_power_work(time_t now)
 				"Powered down after SuspendTimeout",
 				node_ptr->reason_uid);
 			nodes_updated = true;
+		} else if (IS_NODE_POWERING_DOWN(node_ptr)) {
+			_next_power_event(&next_event,
+					  (node_ptr->power_save_req_time +
+					   node_ptr->suspend_timeout + 1), now);
 		}
 
 		/*
@@ -715,6 +746,12 @@ static void _do_power_work(time_t now)
 				bit_set(failed_node_bitmap, node_ptr->index);
 			}
 			nodes_updated = true;
+		} else if (bit_test(booting_node_bitmap, node_ptr->index) &&
+			   IS_NODE_POWERING_UP(node_ptr) &&
+			   IS_NODE_NO_RESPOND(node_ptr)) {
+			_next_power_event(&next_event,
+					  (node_ptr->boot_req_time +
+					   node_ptr->resume_timeout + 1), now);
 		}
 	}
 	FREE_NULL_BITMAP(avoid_node_bitmap);
@@ -774,6 +811,8 @@ static void _do_power_work(time_t now)
 
 	FREE_NULL_DATA(resume_json_data);
 	FREE_NULL_BITMAP(job_power_node_bitmap);
+
+	return next_event;
 }
 
 extern int power_job_reboot(bitstr_t *node_bitmap, job_record_t *job_ptr,
@@ -1174,6 +1213,14 @@ extern bool power_save_test(void)
 	return rc;
 }
 
+extern void power_save_wake(void)
+{
+	slurm_mutex_lock(&power_mutex);
+	power_save_wake_pending = true;
+	slurm_cond_broadcast(&power_cond);
+	slurm_mutex_unlock(&power_mutex);
+}
+
 /* Free module's allocated memory */
 extern void power_save_fini(void)
 {
@@ -1209,7 +1256,8 @@ static void *_power_save_thread(void *arg)
 	/* Locks: Write jobs and nodes */
 	slurmctld_lock_t node_write_lock = {
 		NO_LOCK, WRITE_LOCK, WRITE_LOCK, NO_LOCK, NO_LOCK };
-	time_t now, last_power_scan = 0;
+	time_t now, last_power_scan = 0, next_power_event = 0;
+	bool wake;
 
 #if HAVE_SYS_PRCTL_H
 	if (prctl(PR_SET_NAME, "powersave", NULL, NULL, NULL) < 0) {
@@ -1234,6 +1282,7 @@ static void *_power_save_thread(void *arg)
 		clock_gettime(CLOCK_REALTIME, &ts);
 		ts.tv_sec += 1;
 		slurm_cond_timedwait(&power_cond, &power_mutex, &ts);
+		wake = power_save_wake_pending;
 		slurm_mutex_unlock(&power_mutex);
 
 		if (slurmctld_config.shutdown_time)
@@ -1245,11 +1294,21 @@ static void *_power_save_thread(void *arg)
 		}
 
 		now = time(NULL);
+		/*
+		 * Scan when a job is waiting on powered down nodes, when any
+		 * node changed, or when a node's power timer expired. Jobs
+		 * allocated while waiting on the locks are handled together.
+		 */
 		if ((now > (last_power_scan + power_save_min_interval)) &&
-		    ((last_node_update > last_power_scan) ||
+		    (wake || (last_node_update > last_power_scan) ||
+		     (next_power_event && (now >= next_power_event)) ||
 		     (now > (last_power_scan + power_save_interval)))) {
+			slurm_mutex_lock(&power_mutex);
+			power_save_wake_pending = false;
+			slurm_mutex_unlock(&power_mutex);
+
 			lock_slurmctld(node_write_lock);
-			_do_power_work(now);
+			next_power_event = _do_power_work(now);
 			unlock_slurmctld(node_write_lock);
 			last_power_scan = now;
 		}
@@ -58,6 +58,12 @@ extern void power_save_fini(void);
 /* Report if node power saving is enabled */
 extern bool power_save_test(void);
 
+/*
+ * Wake the power save thread to resume nodes for a newly allocated job
+ * instead of waiting for its next periodic scan.
+ */
+extern void power_save_wake(void);
+
 /*
  * Reboot compute nodes for a job from the head node using ResumeProgram.
  *
@@ -64,10 +64,12 @@
 #include "src/common/macros.h"
 #include "src/common/pack.h"
 #include "src/common/persist_conn.h"
+#include "src/common/probes.h"
 #include "src/common/read_config.h"
 #include "src/common/slurm_protocol_api.h"
 #include "src/common/slurm_protocol_pack.h"
 #include "src/common/slurm_protocol_socket.h"
+#include "src/common/trace_ring.h"
 #include "src/common/xstring.h"
 
 #include "src/interfaces/acct_gather.h"
@@ -102,11 +104,13 @@
 #include "src/slurmctld/proc_req.h"
 #include "src/slurmctld/read_config.h"
 #include "src/slurmctld/reservation.h"
+#include "src/slurmctld/rpc_coalesce.h"
 #include "src/slurmctld/rpc_queue.h"
 #include "src/slurmctld/sackd_mgr.h"
 #include "src/slurmctld/slurmctld.h"
 #include "src/slurmctld/slurmscriptd.h"
 #include "src/slurmctld/state_save.h"
+#include "src/slurmctld/state_snapshot.h"
 #include "src/slurmctld/trigger_mgr.h"
 
 #include "src/stepmgr/srun_comm.h"
@@ -121,11 +125,14 @@ static uint16_t rpc_type_queued[RPC_TYPE_SIZE] = { 0 };
 static uint64_t rpc_type_dropped[RPC_TYPE_SIZE] = { 0 };
 static uint16_t rpc_type_cycle_last[RPC_TYPE_SIZE] = { 0 };
 static uint16_t rpc_type_cycle_max[RPC_TYPE_SIZE] = { 0 };
+static uint32_t rpc_type_time_hist[RPC_TYPE_SIZE][LATENCY_HIST_CNT] = { { 0 } };
+static uint32_t rpc_type_wait_hist[RPC_TYPE_SIZE][LATENCY_HIST_CNT] = { { 0 } };
 #define RPC_USER_SIZE 200
 static uint32_t rpc_user_id[RPC_USER_SIZE] = { 0 };
 static uint32_t rpc_user_cnt[RPC_USER_SIZE] = { 0 };
 static uint64_t rpc_user_time[RPC_USER_SIZE] = { 0 };
 
+static bool do_post_rpc_epilog_complete = false;
 static bool do_post_rpc_node_registration = false;
 
 bool running_configless = false;
@@ -156,8 +163,36 @@ typedef struct {
 	list_t *step_list;
 } find_job_by_container_id_args_t;
 
+/*
+ * Microseconds msg waited between being received and being processed for
+ * delta microseconds, or -1 if its arrival was not recorded
+ */
+static int64_t _rpc_queue_wait(slurm_msg_t *msg, long delta)
+{
+	timespec_diff_ns_t since;
+	int64_t usec;
+
+	if (!msg->recv_time.tv_sec)
+		return -1;
+
+	since = timespec_diff_ns(timespec_now(), msg->recv_time);
+	if (!since.after)
+		return 0;
+
+	usec = (since.diff.tv_sec * USEC_IN_SEC) +
+	       (since.diff.tv_nsec / NSEC_IN_USEC) - delta;
+	return MAX(usec, 0);
+}
+
 extern void record_rpc_stats(slurm_msg_t *msg, long delta)
 {
+	int64_t wait = _rpc_queue_wait(msg, delta);
+	int time_bucket = latency_hist_bucket(MAX(delta, 0));
+
+	trace_ring_record(TRACE_EVENT_RPC_DONE, msg->msg_type, msg->auth_uid,
+			  delta);
+	SLURM_PROBE3(rpc__done, msg->msg_type, msg->auth_uid, delta);
+
 	slurm_mutex_lock(&rpc_mutex);
 	for (int i = 0; i < RPC_TYPE_SIZE; i++) {
 		if (rpc_type_id[i] == 0)
@@ -166,6 +201,9 @@ extern void record_rpc_stats(slurm_msg_t *msg, long delta)
 			continue;
 		rpc_type_cnt[i]++;
 		rpc_type_time[i] += delta;
+		rpc_type_time_hist[i][time_bucket]++;
+		if (wait >= 0)
+			rpc_type_wait_hist[i][latency_hist_bucket(wait)]++;
 		break;
 	}
 	for (int i = 0; i < RPC_USER_SIZE; i++) {
@@ -198,6 +236,19 @@ extern void record_rpc_queue_stats(slurmctld_rpc_t *q)
 	slurm_mutex_unlock(&rpc_mutex);
 }
 
+extern void get_rpc_stats_totals(uint64_t *count, uint64_t *time)
+{
+	*count = 0;
+	*time = 0;
+
+	slurm_mutex_lock(&rpc_mutex);
+	for (int i = 0; (i < RPC_TYPE_SIZE) && rpc_type_id[i]; i++) {
+		*count += rpc_type_cnt[i];
+		*time += rpc_type_time[i];
+	}
+	slurm_mutex_unlock(&rpc_mutex);
+}
+
 /* These functions prevent certain RPCs from keeping the slurmctld write locks
  * constantly set, which can prevent other RPCs and system functions from being
  * processed. For example, a steady stream of batch submissions can prevent
@@ -1393,17 +1444,55 @@ static void _slurm_rpc_dump_conf(slurm_msg_t *msg)
 	}
 }
 
+/*
+ * Answer a dump RPC from a published state snapshot without taking any
+ * slurmctld locks.
+ * RET true if a response was sent
+ */
+static bool _send_state_snapshot(slurm_msg_t *msg, snapshot_type_t type,
+				 uint16_t show_flags, uint32_t filter_uid,
+				 time_t last_update, slurm_msg_type_t resp_type)
+{
+	snapshot_t *snap;
+	buf_t *buffer;
+
+	if (!(snap = state_snapshot_get(type, show_flags, msg->auth_uid,
+					filter_uid, msg->protocol_version)))
+		return false;
+
+	if ((last_update - 1) >= state_snapshot_last_update(snap)) {
+		slurm_send_rc_msg(msg, SLURM_NO_CHANGE_IN_DATA);
+	} else {
+		buffer = state_snapshot_shadow_buf(snap);
+		(void) send_msg_response(msg, resp_type, buffer);
+		FREE_NULL_BUFFER(buffer);
+	}
+	state_snapshot_release(snap);
+
+	return true;
+}
+
 /* _slurm_rpc_dump_jobs - process RPC for job state information */
 static void _slurm_rpc_dump_jobs(slurm_msg_t *msg)
 {
 	DEF_TIMERS;
 	buf_t *buffer = NULL;
+	snapshot_t *snap = NULL;
 	job_info_request_msg_t *job_info_request_msg = msg->data;
 	/* Locks: Read config job part */
 	slurmctld_lock_t job_read_lock = {
 		READ_LOCK, READ_LOCK, NO_LOCK, READ_LOCK, READ_LOCK };
 
 	START_TIMER;
+	if (!job_info_request_msg->job_ids &&
+	    _send_state_snapshot(msg, SNAPSHOT_JOBS,
+				 job_info_request_msg->show_flags, NO_VAL,
+				 job_info_request_msg->last_update,
+				 RESPONSE_JOB_INFO)) {
+		END_TIMER2(__func__);
+		return;
+	}
+
 	if (!(msg->flags & CTLD_QUEUE_PROCESSING))
 		lock_slurmctld(job_read_lock);
 
@@ -1422,6 +1511,10 @@ static void _slurm_rpc_dump_jobs(slurm_msg_t *msg)
 			buffer = pack_all_jobs(job_info_request_msg->show_flags,
 					       msg->auth_uid, NO_VAL,
 					       msg->protocol_version);
+			snap = state_snapshot_publish(
+				SNAPSHOT_JOBS, job_info_request_msg->show_flags,
+				msg->auth_uid, NO_VAL, msg->protocol_version,
+				last_job_update, &buffer);
 		}
 		if (!(msg->flags & CTLD_QUEUE_PROCESSING))
 			unlock_slurmctld(job_read_lock);
@@ -1431,8 +1524,11 @@ static void _slurm_rpc_dump_jobs(slurm_msg_t *msg)
 #endif
 
 		/* send message */
+		if (snap)
+			buffer = state_snapshot_shadow_buf(snap);
 		(void) send_msg_response(msg, RESPONSE_JOB_INFO, buffer);
 		FREE_NULL_BUFFER(buffer);
+		state_snapshot_release(snap);
 	}
 }
 
@@ -1441,17 +1537,32 @@ static void _slurm_rpc_dump_jobs_user(slurm_msg_t *msg)
 {
 	DEF_TIMERS;
 	buf_t *buffer = NULL;
+	snapshot_t *snap;
 	job_user_id_msg_t *job_info_request_msg = msg->data;
 	/* Locks: Read config job part */
 	slurmctld_lock_t job_read_lock = {
 		READ_LOCK, READ_LOCK, NO_LOCK, READ_LOCK, READ_LOCK };
 
 	START_TIMER;
+	if (_send_state_snapshot(msg, SNAPSHOT_JOBS,
+				 job_info_request_msg->show_flags,
+				 job_info_request_msg->user_id, 0,
+				 RESPONSE_JOB_INFO)) {
+		END_TIMER2(__func__);
+		return;
+	}
+
 	if (!(msg->flags & CTLD_QUEUE_PROCESSING))
 		lock_slurmctld(job_read_lock);
 	buffer = pack_all_jobs(job_info_request_msg->show_flags, msg->auth_uid,
 			       job_info_request_msg->user_id,
 			       msg->protocol_version);
+	snap = state_snapshot_publish(SNAPSHOT_JOBS,
+				      job_info_request_msg->show_flags,
+				      msg->auth_uid,
+				      job_info_request_msg->user_id,
+				      msg->protocol_version, last_job_update,
+				      &buffer);
 	if (!(msg->flags & CTLD_QUEUE_PROCESSING))
 		unlock_slurmctld(job_read_lock);
 	END_TIMER2(__func__);
@@ -1460,8 +1571,34 @@ static void _slurm_rpc_dump_jobs_user(slurm_msg_t *msg)
 #endif
 
 	/* send message */
+	if (snap)
+		buffer = state_snapshot_shadow_buf(snap);
 	(void) send_msg_response(msg, RESPONSE_JOB_INFO, buffer);
 	FREE_NULL_BUFFER(buffer);
+	state_snapshot_release(snap);
+}
+
+/* _slurm_rpc_dump_jobs_delta - process RPC for changed job information */
+static void _slurm_rpc_dump_jobs_delta(slurm_msg_t *msg)
+{
+	DEF_TIMERS;
+	buf_t *buffer;
+	job_info_delta_request_msg_t *req = msg->data;
+	/* Locks: Read config job part */
+	slurmctld_lock_t job_read_lock = {
+		READ_LOCK, READ_LOCK, NO_LOCK, READ_LOCK, READ_LOCK };
+
+	START_TIMER;
+	if (!(msg->flags & CTLD_QUEUE_PROCESSING))
+		lock_slurmctld(job_read_lock);
+	buffer = pack_delta_jobs(req->generation, req->show_flags,
+				 msg->auth_uid, msg->protocol_version);
+	if (!(msg->flags & CTLD_QUEUE_PROCESSING))
+		unlock_slurmctld(job_read_lock);
+	END_TIMER2(__func__);
+
+	(void) send_msg_response(msg, RESPONSE_JOB_INFO_DELTA, buffer);
+	FREE_NULL_BUFFER(buffer);
 }
 
 static void _slurm_rpc_job_state(slurm_msg_t *msg)
@@ -1539,26 +1676,12 @@ static void _slurm_rpc_get_priority_factors(slurm_msg_t *msg)
 {
 	DEF_TIMERS;
 	priority_factors_response_msg_t resp_msg;
-	/* Read lock on jobs, nodes, and partitions */
-	slurmctld_lock_t job_read_lock = {
-		.job = READ_LOCK,
-		.node = READ_LOCK,
-		.part = READ_LOCK,
-	};
-	assoc_mgr_lock_t qos_read_locks = {
-		.qos = READ_LOCK,
-	};
-
 
 	START_TIMER;
-	lock_slurmctld(job_read_lock);
-	assoc_mgr_lock(&qos_read_locks);
-
+	/* The plugin takes any locks it needs and returns a private copy */
 	resp_msg.priority_factors_list = priority_g_get_priority_factors_list(
 		msg->auth_uid);
 	(void) send_msg_response(msg, RESPONSE_PRIORITY_FACTORS, &resp_msg);
-	assoc_mgr_unlock(&qos_read_locks);
-	unlock_slurmctld(job_read_lock);
 	FREE_NULL_LIST(resp_msg.priority_factors_list);
 	END_TIMER2(__func__);
 	debug2("%s %s", __func__, TIME_STR);
@@ -1643,6 +1766,7 @@ static void _slurm_rpc_dump_nodes(slurm_msg_t *msg)
 {
 	DEF_TIMERS;
 	buf_t *buffer;
+	snapshot_t *snap;
 	node_info_request_msg_t *node_req_msg = msg->data;
 	/* Locks: Read config, write node (reset allocated CPU count in some
 	 * select plugins), read part (for part_is_visible) */
@@ -1658,6 +1782,13 @@ static void _slurm_rpc_dump_nodes(slurm_msg_t *msg)
 		return;
 	}
 
+	if (_send_state_snapshot(msg, SNAPSHOT_NODES, node_req_msg->show_flags,
+				 NO_VAL, node_req_msg->last_update,
+				 RESPONSE_NODE_INFO)) {
+		END_TIMER2(__func__);
+		return;
+	}
+
 	if (!(msg->flags & CTLD_QUEUE_PROCESSING))
 		lock_slurmctld(node_write_lock);
 
@@ -1671,13 +1802,21 @@ static void _slurm_rpc_dump_nodes(slurm_msg_t *msg)
 	} else {
 		buffer = pack_all_nodes(node_req_msg->show_flags,
 					msg->auth_uid, msg->protocol_version);
+		snap = state_snapshot_publish(SNAPSHOT_NODES,
+					      node_req_msg->show_flags,
+					      msg->auth_uid, NO_VAL,
+					      msg->protocol_version,
+					      last_node_update, &buffer);
 		if (!(msg->flags & CTLD_QUEUE_PROCESSING))
 			unlock_slurmctld(node_write_lock);
 		END_TIMER2(__func__);
 
 		/* send message */
+		if (snap)
+			buffer = state_snapshot_shadow_buf(snap);
 		(void) send_msg_response(msg, RESPONSE_NODE_INFO, buffer);
 		FREE_NULL_BUFFER(buffer);
+		state_snapshot_release(snap);
 	}
 }
 
@@ -1722,6 +1861,7 @@ static void _slurm_rpc_dump_partitions(slurm_msg_t *msg)
 {
 	DEF_TIMERS;
 	buf_t *buffer = NULL;
+	snapshot_t *snap;
 	part_info_request_msg_t *part_req_msg = msg->data;
 
 	/* Locks: Read configuration and partition */
@@ -1737,6 +1877,13 @@ static void _slurm_rpc_dump_partitions(slurm_msg_t *msg)
 		return;
 	}
 
+	if (_send_state_snapshot(msg, SNAPSHOT_PARTS, part_req_msg->show_flags,
+				 NO_VAL, part_req_msg->last_update,
+				 RESPONSE_PARTITION_INFO)) {
+		END_TIMER2(__func__);
+		return;
+	}
+
 	if (!(msg->flags & CTLD_QUEUE_PROCESSING))
 		lock_slurmctld(part_read_lock);
 
@@ -1748,23 +1895,63 @@ static void _slurm_rpc_dump_partitions(slurm_msg_t *msg)
 	} else {
 		buffer = pack_all_part(part_req_msg->show_flags, msg->auth_uid,
 				       msg->protocol_version);
+		snap = state_snapshot_publish(SNAPSHOT_PARTS,
+					      part_req_msg->show_flags,
+					      msg->auth_uid, NO_VAL,
+					      msg->protocol_version,
+					      last_part_update, &buffer);
 		if (!(msg->flags & CTLD_QUEUE_PROCESSING))
 			unlock_slurmctld(part_read_lock);
 		END_TIMER2(__func__);
 
 		/* send message */
+		if (snap)
+			buffer = state_snapshot_shadow_buf(snap);
 		(void) send_msg_response(msg, RESPONSE_PARTITION_INFO, buffer);
 		FREE_NULL_BUFFER(buffer);
+		state_snapshot_release(snap);
 	}
 }
 
 /* _slurm_rpc_epilog_complete - process RPC noting the completion of
  * the epilog denoting the completion of a job it its entirety */
-static void _slurm_rpc_epilog_complete(slurm_msg_t *msg)
+/* Run the scheduler and save state after epilogs completed */
+static void _epilog_complete_schedule(void)
 {
-	static int active_rpc_cnt = 0;
 	static time_t config_update = 0;
 	static bool defer_sched = false;
+
+	if (config_update != slurm_conf.last_update) {
+		defer_sched = (xstrcasestr(slurm_conf.sched_params, "defer"));
+		config_update = slurm_conf.last_update;
+	}
+
+	/*
+	 * In defer mode, avoid triggering the scheduler logic
+	 * for every epilog complete message.
+	 * As one epilog message is sent from every node of each
+	 * job at termination, the number of simultaneous schedule
+	 * calls can be very high for large machine or large number
+	 * of managed jobs.
+	 */
+	if (!LOTS_OF_AGENTS && !defer_sched)
+		schedule(false);	/* Has own locking */
+	else
+		queue_job_scheduler();
+	schedule_node_save();		/* Has own locking */
+	schedule_job_save();		/* Has own locking */
+}
+
+static void _slurm_post_rpc_epilog_complete()
+{
+	if (do_post_rpc_epilog_complete)
+		_epilog_complete_schedule();
+	do_post_rpc_epilog_complete = false;
+}
+
+static void _slurm_rpc_epilog_complete(slurm_msg_t *msg)
+{
+	static int active_rpc_cnt = 0;
 	DEF_TIMERS;
 	/* Locks: Read configuration, write job, write node */
 	slurmctld_lock_t job_write_lock = {
@@ -1783,12 +1970,6 @@ static void _slurm_rpc_epilog_complete(slurm_msg_t *msg)
 	/* Only throttle on non-composite messages, the lock should
 	 * already be set earlier. */
 	if (!(msg->flags & CTLD_QUEUE_PROCESSING)) {
-		if (config_update != slurm_conf.last_update) {
-			defer_sched = (xstrcasestr(slurm_conf.sched_params,
-						   "defer"));
-			config_update = slurm_conf.last_update;
-		}
-
 		_throttle_start(&active_rpc_cnt);
 		lock_slurmctld(job_write_lock);
 	}
@@ -1818,21 +1999,11 @@ static void _slurm_rpc_epilog_complete(slurm_msg_t *msg)
 	END_TIMER2(__func__);
 
 	/* Functions below provide their own locking */
-	if (!(msg->flags & CTLD_QUEUE_PROCESSING) && run_scheduler) {
-		/*
-		 * In defer mode, avoid triggering the scheduler logic
-		 * for every epilog complete message.
-		 * As one epilog message is sent from every node of each
-		 * job at termination, the number of simultaneous schedule
-		 * calls can be very high for large machine or large number
-		 * of managed jobs.
-		 */
-		if (!LOTS_OF_AGENTS && !defer_sched)
-			schedule(false);	/* Has own locking */
+	if (run_scheduler) {
+		if (!(msg->flags & CTLD_QUEUE_PROCESSING))
+			_epilog_complete_schedule();
 		else
-			queue_job_scheduler();
-		schedule_node_save();		/* Has own locking */
-		schedule_job_save();		/* Has own locking */
+			do_post_rpc_epilog_complete = true;
 	}
 
 	/*
@@ -2476,8 +2647,7 @@ static bool _node_has_feature(node_record_t *node_ptr, char *feature)
 {
 	node_feature_t *node_feature;
 
-	if ((node_feature = list_find_first(active_feature_list,
-					    list_find_feature, feature))) {
+	if ((node_feature = find_node_feature(active_feature_list, feature))) {
 		if (bit_test(node_feature->node_bitmap, node_ptr->index))
 		    return true;
 	}
@@ -3559,6 +3729,13 @@ static void _slurm_rpc_submit_batch_job(slurm_msg_t *msg)
 	}
 
 	if (!(msg->flags & CTLD_QUEUE_PROCESSING)) {
+		/*
+		 * Write the batch files before taking the job write lock so
+		 * that job_allocate() only has to move them into place. The
+		 * RPC queue already holds the locks and gains nothing from
+		 * this. If staging fails job_allocate() writes the files.
+		 */
+		(void) stage_job_desc_files(job_desc_msg);
 		_throttle_start(&active_rpc_cnt);
 		lock_slurmctld(job_write_lock);
 	}
@@ -3595,6 +3772,8 @@ static void _slurm_rpc_submit_batch_job(slurm_msg_t *msg)
 		unlock_slurmctld(job_write_lock);
 		_throttle_fini(&active_rpc_cnt);
 	}
+	/* Files are still staged if no job took them */
+	unstage_job_desc_files(job_desc_msg);
 
 send_msg:
 	END_TIMER2(__func__);
@@ -3641,6 +3820,172 @@ send_msg:
 	xfree(job_submit_user_msg);
 }
 
+/* Append err_msg to job_submit_user_msg as the message of a rejected job */
+static void _set_submit_resp_err(submit_response_msg_t *resp, int error_code,
+				 char **err_msg)
+{
+	resp->job_id = 0;
+	resp->error_code = error_code;
+	if (*err_msg && resp->job_submit_user_msg) {
+		xstrfmtcat(resp->job_submit_user_msg, "\n%s", *err_msg);
+		xfree(*err_msg);
+	} else if (*err_msg) {
+		resp->job_submit_user_msg = *err_msg;
+		*err_msg = NULL;
+	}
+}
+
+/*
+ * _slurm_rpc_submit_batch_jobs - process RPC to submit independent batch jobs
+ *
+ * Each job is validated and has its batch files staged as in
+ * _slurm_rpc_submit_batch_job(), then all are created under one job write
+ * lock. Failures are reported per job.
+ */
+static void _slurm_rpc_submit_batch_jobs(slurm_msg_t *msg)
+{
+	static int active_rpc_cnt = 0;
+	DEF_TIMERS;
+	list_t *job_req_list = msg->data;
+	list_itr_t *iter;
+	job_desc_msg_t *job_desc_msg;
+	job_record_t *job_ptr;
+	submit_jobs_response_msg_t resp_msg = { 0 };
+	submit_response_msg_t *resp;
+	/* Locks: Read config, read job, read node, read partition */
+	slurmctld_lock_t job_read_lock = {
+		READ_LOCK, READ_LOCK, READ_LOCK, READ_LOCK, READ_LOCK };
+	/* Locks: Read config, write job, write node, read partition, read
+	 * federation */
+	slurmctld_lock_t job_write_lock = {
+		READ_LOCK, WRITE_LOCK, WRITE_LOCK, READ_LOCK, READ_LOCK };
+	char *err_msg = NULL;
+	int error_code, i, submitted = 0;
+
+	START_TIMER;
+	if (slurmctld_config.submissions_disabled) {
+		info("Submissions disabled on system");
+		slurm_send_rc_msg(msg, ESLURM_SUBMISSIONS_DISABLED);
+		return;
+	}
+	if (!job_req_list || !list_count(job_req_list)) {
+		info("REQUEST_SUBMIT_BATCH_JOBS from uid=%u with empty job list",
+		     msg->auth_uid);
+		slurm_send_rc_msg(msg, SLURM_ERROR);
+		return;
+	}
+	/* Sibling jobs are submitted by forwarding the RPC as received */
+	if (fed_mgr_fed_rec) {
+		info("REQUEST_SUBMIT_BATCH_JOBS from uid=%u rejected in a federation",
+		     msg->auth_uid);
+		slurm_send_rc_msg(msg, ESLURM_NOT_SUPPORTED);
+		return;
+	}
+
+	resp_msg.jobs_cnt = list_count(job_req_list);
+	resp_msg.job_responses = xcalloc(resp_msg.jobs_cnt,
+					 sizeof(*resp_msg.job_responses));
+
+	/* Validate each request with locks for job_submit plugin use */
+	lock_slurmctld(job_read_lock);
+	iter = list_iterator_create(job_req_list);
+	for (i = 0; (job_desc_msg = list_next(iter)); i++) {
+		resp = &resp_msg.job_responses[i];
+		resp->step_id = SLURM_BATCH_SCRIPT;
+
+		if ((error_code = _valid_id("REQUEST_SUBMIT_BATCH_JOBS",
+					    job_desc_msg, msg->auth_uid,
+					    msg->auth_gid,
+					    msg->protocol_version))) {
+			resp->error_code = error_code;
+			continue;
+		}
+
+		_set_hostname(msg, &job_desc_msg->alloc_node);
+		_set_identity(msg, &job_desc_msg->id);
+		if (!job_desc_msg->alloc_node ||
+		    !job_desc_msg->alloc_node[0]) {
+			error("REQUEST_SUBMIT_BATCH_JOBS lacks alloc_node from uid=%u",
+			      msg->auth_uid);
+			resp->error_code = ESLURM_INVALID_NODE_NAME;
+			continue;
+		}
+
+		dump_job_desc(job_desc_msg);
+		job_desc_msg->het_job_offset = NO_VAL;
+		resp->error_code = validate_job_create_req(job_desc_msg,
+							   msg->auth_uid,
+							   &err_msg);
+		/* Keep the job submit plugin message as in the single RPC */
+		resp->job_submit_user_msg = err_msg;
+		err_msg = NULL;
+	}
+	unlock_slurmctld(job_read_lock);
+
+	list_iterator_reset(iter);
+	for (i = 0; (job_desc_msg = list_next(iter)); i++) {
+		if (!resp_msg.job_responses[i].error_code)
+			(void) stage_job_desc_files(job_desc_msg);
+	}
+
+	_throttle_start(&active_rpc_cnt);
+	lock_slurmctld(job_write_lock);
+	list_iterator_reset(iter);
+	for (i = 0; (job_desc_msg = list_next(iter)); i++) {
+		uint32_t job_id = 0;
+		bool reject_job = false;
+
+		resp = &resp_msg.job_responses[i];
+		if (resp->error_code)
+			continue;
+
+		job_ptr = NULL;
+		error_code = job_allocate(job_desc_msg,
+					  job_desc_msg->immediate, false, NULL,
+					  0, msg->auth_uid, false, &job_ptr,
+					  &err_msg, msg->protocol_version);
+		if (!job_ptr || (error_code && job_ptr->job_state == JOB_FAILED))
+			reject_job = true;
+		else
+			job_id = job_ptr->job_id;
+
+		if (job_desc_msg->immediate && (error_code != SLURM_SUCCESS)) {
+			error_code = ESLURM_CAN_NOT_START_IMMEDIATELY;
+			reject_job = true;
+		}
+
+		if (reject_job) {
+			_set_submit_resp_err(resp, error_code, &err_msg);
+		} else {
+			resp->job_id = job_id;
+			resp->error_code = error_code;
+			submitted++;
+		}
+		xfree(err_msg);
+	}
+	unlock_slurmctld(job_write_lock);
+	_throttle_fini(&active_rpc_cnt);
+
+	list_iterator_reset(iter);
+	while ((job_desc_msg = list_next(iter)))
+		unstage_job_desc_files(job_desc_msg);
+	list_iterator_destroy(iter);
+	END_TIMER2(__func__);
+
+	info("%s: submitted %d of %u jobs %s",
+	     __func__, submitted, resp_msg.jobs_cnt, TIME_STR);
+	(void) send_msg_response(msg, RESPONSE_SUBMIT_BATCH_JOBS, &resp_msg);
+
+	if (submitted) {
+		schedule_job_save();	/* Has own locks */
+		schedule_node_save();	/* Has own locks */
+		queue_job_scheduler();
+	}
+	for (i = 0; i < resp_msg.jobs_cnt; i++)
+		xfree(resp_msg.job_responses[i].job_submit_user_msg);
+	xfree(resp_msg.job_responses);
+}
+
 /* _slurm_rpc_submit_batch_het_job - process RPC to submit a batch hetjob */
 static void _slurm_rpc_submit_batch_het_job(slurm_msg_t *msg)
 {
@@ -5546,18 +5891,23 @@ static void _clear_rpc_stats(void)
 	memset(rpc_type_dropped, 0, sizeof(rpc_type_dropped));
 	memset(rpc_type_cycle_last, 0, sizeof(rpc_type_cycle_last));
 	memset(rpc_type_cycle_max, 0, sizeof(rpc_type_cycle_max));
+	memset(rpc_type_time_hist, 0, sizeof(rpc_type_time_hist));
+	memset(rpc_type_wait_hist, 0, sizeof(rpc_type_wait_hist));
 	memset(rpc_user_cnt, 0, sizeof(rpc_user_cnt));
 	memset(rpc_user_id, 0, sizeof(rpc_user_id));
 	memset(rpc_user_time, 0, sizeof(rpc_user_time));
 	slurm_mutex_unlock(&rpc_mutex);
 }
 
-static void _pack_rpc_stats(buf_t *buffer, uint16_t protocol_version)
+/* RET number of RPC types packed */
+static uint32_t _pack_rpc_stats(buf_t *buffer, uint16_t protocol_version)
 {
+	uint32_t rpc_count = 0;
+
 	slurm_mutex_lock(&rpc_mutex);
 
 	if (protocol_version >= SLURM_24_05_PROTOCOL_VERSION) {
-		uint32_t rpc_count = 0, user_count = 1;
+		uint32_t user_count = 1;
 		uint8_t queue_enabled = rpc_queue_enabled();
 
 		while (rpc_type_id[rpc_count])
@@ -5585,7 +5935,7 @@ static void _pack_rpc_stats(buf_t *buffer, uint16_t protocol_version)
 
 		agent_pack_pending_rpc_stats(buffer);
 	} else if (protocol_version >= SLURM_MIN_PROTOCOL_VERSION) {
-		uint32_t rpc_count = 0, user_count = 1;
+		uint32_t user_count = 1;
 
 		while (rpc_type_id[rpc_count])
 			rpc_count++;
@@ -5606,6 +5956,27 @@ static void _pack_rpc_stats(buf_t *buffer, uint16_t protocol_version)
 	}
 
 	slurm_mutex_unlock(&rpc_mutex);
+
+	return rpc_count;
+}
+
+/*
+ * Pack the latency histograms of the first rpc_count RPC types, in the same
+ * order as _pack_rpc_stats() packed the types
+ */
+static void _pack_rpc_latency_stats(buf_t *buffer, uint32_t rpc_count,
+				    uint16_t protocol_version)
+{
+	if (protocol_version < SLURM_24_11_PROTOCOL_VERSION)
+		return;
+
+	slurm_mutex_lock(&rpc_mutex);
+	pack32(LATENCY_HIST_CNT, buffer);
+	pack32_array(&rpc_type_time_hist[0][0], rpc_count * LATENCY_HIST_CNT,
+		     buffer);
+	pack32_array(&rpc_type_wait_hist[0][0], rpc_count * LATENCY_HIST_CNT,
+		     buffer);
+	slurm_mutex_unlock(&rpc_mutex);
 }
 
 static void _slurm_rpc_burst_buffer_status(slurm_msg_t *msg)
@@ -5628,6 +5999,7 @@ static void _slurm_rpc_dump_stats(slurm_msg_t *msg)
 {
 	stats_info_request_msg_t *request_msg = msg->data;
 	buf_t *buffer = NULL;
+	uint32_t rpc_count;
 
 	if ((request_msg->command_id == STAT_COMMAND_RESET) &&
 	    !validate_operator(msg->auth_uid)) {
@@ -5643,13 +6015,19 @@ static void _slurm_rpc_dump_stats(slurm_msg_t *msg)
 	if (request_msg->command_id == STAT_COMMAND_RESET) {
 		reset_stats(1);
 		_clear_rpc_stats();
+		reset_lock_stats();
 		slurm_send_rc_msg(msg, SLURM_SUCCESS);
 		return;
 	}
 
 	buffer = pack_all_stat(msg->protocol_version);
-	_pack_rpc_stats(buffer, msg->protocol_version);
-
+	rpc_count = _pack_rpc_stats(buffer, msg->protocol_version);
+	pack_lock_stats(buffer, msg->protocol_version);
+	pack_sched_phase_stats(buffer, msg->protocol_version);
+	_pack_rpc_latency_stats(buffer, rpc_count, msg->protocol_version);
+	pack_stats_history(buffer,
+			   (request_msg->command_id == STAT_COMMAND_HISTORY),
+			   msg->protocol_version);
 
 	/* send message */
 	(void) send_msg_response(msg, RESPONSE_STATS_INFO, buffer);
@@ -6465,6 +6843,18 @@ slurmctld_rpc_t slurmctld_rpcs[] =
 		.msg_type = REQUEST_JOB_INFO,
 		.func = _slurm_rpc_dump_jobs,
 		.queue_enabled = true,
+		.lane = RPC_LANE_QUERY,
+		.locks = {
+			.conf = READ_LOCK,
+			.job = READ_LOCK,
+			.part = READ_LOCK,
+			.fed = READ_LOCK,
+		},
+	},{
+		.msg_type = REQUEST_JOB_INFO_DELTA,
+		.func = _slurm_rpc_dump_jobs_delta,
+		.queue_enabled = true,
+		.lane = RPC_LANE_QUERY,
 		.locks = {
 			.conf = READ_LOCK,
 			.job = READ_LOCK,
@@ -6478,6 +6868,7 @@ slurmctld_rpc_t slurmctld_rpcs[] =
 		.msg_type = REQUEST_JOB_USER_INFO,
 		.func = _slurm_rpc_dump_jobs_user,
 		.queue_enabled = true,
+		.lane = RPC_LANE_QUERY,
 		.locks = {
 			.conf = READ_LOCK,
 			.job = READ_LOCK,
@@ -6488,6 +6879,7 @@ slurmctld_rpc_t slurmctld_rpcs[] =
 		.msg_type = REQUEST_JOB_INFO_SINGLE,
 		.func = _slurm_rpc_dump_job_single,
 		.queue_enabled = true,
+		.lane = RPC_LANE_QUERY,
 		.locks = {
 			.conf = READ_LOCK,
 			.job = READ_LOCK,
@@ -6510,6 +6902,7 @@ slurmctld_rpc_t slurmctld_rpcs[] =
 		.msg_type = REQUEST_FED_INFO,
 		.func = _slurm_rpc_get_fed,
 		.queue_enabled = true,
+		.lane = RPC_LANE_QUERY,
 		.locks = {
 			.fed = READ_LOCK,
 		},
@@ -6520,6 +6913,7 @@ slurmctld_rpc_t slurmctld_rpcs[] =
 		.msg_type = REQUEST_NODE_INFO,
 		.func = _slurm_rpc_dump_nodes,
 		.queue_enabled = true,
+		.lane = RPC_LANE_QUERY,
 		.locks = {
 			.conf = READ_LOCK,
 			.node = WRITE_LOCK,
@@ -6532,6 +6926,7 @@ slurmctld_rpc_t slurmctld_rpcs[] =
 		.msg_type = REQUEST_PARTITION_INFO,
 		.func = _slurm_rpc_dump_partitions,
 		.queue_enabled = true,
+		.lane = RPC_LANE_QUERY,
 		.locks = {
 			.conf = READ_LOCK,
 			.part = READ_LOCK,
@@ -6540,7 +6935,10 @@ slurmctld_rpc_t slurmctld_rpcs[] =
 		.msg_type = MESSAGE_EPILOG_COMPLETE,
 		.max_per_cycle = 256,
 		.func = _slurm_rpc_epilog_complete,
+		.post_func = _slurm_post_rpc_epilog_complete,
+		.coalesce = true,
 		.queue_enabled = true,
+		.lane = RPC_LANE_COMPLETION,
 		.locks = {
 			.conf = READ_LOCK,
 			.job = WRITE_LOCK,
@@ -6556,6 +6954,7 @@ slurmctld_rpc_t slurmctld_rpcs[] =
 		.msg_type = REQUEST_COMPLETE_PROLOG,
 		.func = _slurm_rpc_complete_prolog,
 		.queue_enabled = true,
+		.lane = RPC_LANE_COMPLETION,
 		.locks = {
 			.job = WRITE_LOCK,
 		},
@@ -6564,6 +6963,7 @@ slurmctld_rpc_t slurmctld_rpcs[] =
 		.max_per_cycle = 256,
 		.func = _slurm_rpc_complete_batch_script,
 		.queue_enabled = true,
+		.lane = RPC_LANE_COMPLETION,
 		.locks = {
 			.job = WRITE_LOCK,
 			.node = WRITE_LOCK,
@@ -6597,7 +6997,9 @@ slurmctld_rpc_t slurmctld_rpcs[] =
 		.msg_type = MESSAGE_NODE_REGISTRATION_STATUS,
 		.func = _slurm_rpc_node_registration,
 		.post_func = _slurm_post_rpc_node_registration,
+		.coalesce = true,
 		.queue_enabled = true,
+		.lane = RPC_LANE_COMPLETION,
 		.locks = {
 			.conf = READ_LOCK,
 			.job = WRITE_LOCK,
@@ -6652,6 +7054,9 @@ slurmctld_rpc_t slurmctld_rpcs[] =
 	},{
 		.msg_type = REQUEST_SUBMIT_BATCH_HET_JOB,
 		.func = _slurm_rpc_submit_batch_het_job,
+	},{
+		.msg_type = REQUEST_SUBMIT_BATCH_JOBS,
+		.func = _slurm_rpc_submit_batch_jobs,
 	},{
 		.msg_type = REQUEST_UPDATE_FRONT_END,
 		.func = _slurm_rpc_update_front_end,
@@ -6717,6 +7122,7 @@ slurmctld_rpc_t slurmctld_rpcs[] =
 		.max_per_cycle = 256,
 		.func = _slurm_rpc_step_complete,
 		.queue_enabled = true,
+		.lane = RPC_LANE_COMPLETION,
 		.locks = {
 			.job = WRITE_LOCK,
 			.node = WRITE_LOCK,
@@ -6877,6 +7283,8 @@ void slurmctld_req(slurm_msg_t *msg)
 
 	debug2("Processing RPC: %s from UID=%u",
 	       rpc_num2string(msg->msg_type), msg->auth_uid);
+	trace_ring_record(TRACE_EVENT_RPC_RECV, msg->msg_type, msg->auth_uid, 0);
+	SLURM_PROBE2(rpc__start, msg->msg_type, msg->auth_uid);
 
 	for (int i = 0; slurmctld_rpcs[i].msg_type; i++) {
 		if (slurmctld_rpcs[i].msg_type != msg->msg_type)
@@ -6894,6 +7302,9 @@ void slurmctld_req(slurm_msg_t *msg)
 			/* do not record RPC stats, we didn't process this */
 			return;
 		}
+		/* stats are recorded per msg while processing the batch */
+		if (rpc_coalesce(this_rpc, msg))
+			return;
 		(*(this_rpc->func))(msg);
 		END_TIMER;
 		record_rpc_stats(msg, DELTA_TIMER);
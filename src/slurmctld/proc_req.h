@@ -45,6 +45,17 @@
 
 #include "src/slurmctld/locks.h"
 
+/*
+ * Priority lanes for queued RPCs. Queues in a lane yield to queues in any
+ * higher priority lane with a backlog. See rpc_queue.c for lane priorities.
+ */
+typedef enum {
+	RPC_LANE_DEFAULT = 0,
+	RPC_LANE_COMPLETION, /* node and job completion traffic */
+	RPC_LANE_QUERY, /* user info queries */
+	RPC_LANE_COUNT
+} rpc_lane_t;
+
 typedef struct {
 	uint16_t msg_type;
 	void (*func)(slurm_msg_t *msg);
@@ -58,6 +69,7 @@ typedef struct {
 	bool queue_enabled;
 	bool hard_drop; /* discard traffic if max_queued exceeded */
 	bool shutdown;
+	rpc_lane_t lane; /* priority lane of queue */
 
 	int yield_sleep; /* usec sleep between cycles when busy */
 	int interval; /* usec sleep after cycle if no longer busy */
@@ -77,6 +89,13 @@ typedef struct {
 	uint64_t dropped;
 	uint16_t cycle_last;
 	uint16_t cycle_max;
+
+	/* Coalescing elements, used when not queued by rpc_queue */
+	bool coalesce; /* batch concurrent msgs under one lock acquisition */
+	bool coalesce_leader; /* a thread is collecting or processing a batch */
+	pthread_cond_t coalesce_cond;
+	pthread_mutex_t coalesce_mutex;
+	list_t *coalesce_work;
 } slurmctld_rpc_t;
 
 extern slurmctld_rpc_t slurmctld_rpcs[];
@@ -97,6 +116,12 @@ extern void record_rpc_stats(slurm_msg_t *msg, long delta);
  */
 extern void record_rpc_queue_stats(slurmctld_rpc_t *q);
 
+/*
+ * Sum the count and processing time (usec) of all RPC types since the RPC
+ * statistics were last cleared.
+ */
+extern void get_rpc_stats_totals(uint64_t *count, uint64_t *time);
+
 /* Copy an array of type char **, xmalloc() the array and xstrdup() the
  * strings in the array */
 extern char **xduparray(uint32_t size, char ** array);
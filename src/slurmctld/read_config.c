@@ -60,6 +60,7 @@
 #include "src/common/read_config.h"
 #include "src/common/slurm_rlimits_info.h"
 #include "src/common/strnatcmp.h"
+#include "src/common/xhash.h"
 #include "src/common/xstring.h"
 
 #include "src/interfaces/burst_buffer.h"
@@ -99,6 +100,10 @@
 /* Global variables */
 list_t *active_feature_list;	/* list of currently active features_records */
 list_t *avail_feature_list;	/* list of available features_records */
+
+/* Name indexes of the feature_records in the lists above */
+static xhash_t *active_feature_hash = NULL;
+static xhash_t *avail_feature_hash = NULL;
 bool node_features_updated = true;
 bool slurmctld_init_db = true;
 
@@ -257,9 +262,8 @@ static void _add_nodes_with_feature(hostlist_t *hl, char *feature)
 	if (avail_feature_list) {
 		char *feature_nodes;
 		node_feature_t *node_feat_ptr;
-		if (!(node_feat_ptr = list_find_first(avail_feature_list,
-						      list_find_feature,
-						      feature))) {
+		if (!(node_feat_ptr = find_node_feature(avail_feature_list,
+							feature))) {
 			debug2("unable to find nodeset feature '%s'", feature);
 			return;
 		}
@@ -1531,7 +1535,8 @@ extern int read_slurm_conf(int recover)
 	if (topology_g_init() != SLURM_SUCCESS)
 		fatal("Failed to initialize topology plugin");
 
-	if (xstrcasestr(slurm_conf.slurmctld_params, "enable_stepmgr") &&
+	if ((xstrcasestr(slurm_conf.slurmctld_params, "enable_stepmgr") ||
+	     xstrcasestr(slurm_conf.slurmctld_params, "stepmgr_min_nodes=")) &&
 	    !(slurm_conf.prolog_flags & PROLOG_FLAG_CONTAIN))
 		fatal("STEP_MGR not supported without PrologFlags=contain");
 
@@ -1832,6 +1837,65 @@ end_it:
 
 }
 
+static void _feature_hash_id(void *item, const char **key, uint32_t *key_len)
+{
+	node_feature_t *feature_ptr = item;
+
+	*key = feature_ptr->name;
+	*key_len = strlen(feature_ptr->name);
+}
+
+/* Return the name index of active_feature_list or avail_feature_list */
+static xhash_t *_feature_hash(list_t *feature_list)
+{
+	if (!feature_list)
+		return NULL;
+	if (feature_list == active_feature_list)
+		return active_feature_hash;
+	if (feature_list == avail_feature_list)
+		return avail_feature_hash;
+	return NULL;
+}
+
+static void _append_feature(list_t *feature_list, node_feature_t *feature_ptr)
+{
+	xhash_t *feature_hash = _feature_hash(feature_list);
+
+	list_append(feature_list, feature_ptr);
+	if (feature_hash)
+		xhash_add(feature_hash, feature_ptr);
+}
+
+/* Replace active_feature_list and avail_feature_list with empty lists */
+static void _create_feature_lists(void)
+{
+	free_feature_lists();
+	active_feature_list = list_create(_list_delete_feature);
+	avail_feature_list = list_create(_list_delete_feature);
+	active_feature_hash = xhash_init(_feature_hash_id, NULL);
+	avail_feature_hash = xhash_init(_feature_hash_id, NULL);
+}
+
+extern node_feature_t *find_node_feature(list_t *feature_list,
+					 const char *name)
+{
+	xhash_t *feature_hash;
+
+	if (!feature_list || !name)
+		return NULL;
+	if ((feature_hash = _feature_hash(feature_list)))
+		return xhash_get_str(feature_hash, name);
+	return list_find_first(feature_list, list_find_feature, (void *) name);
+}
+
+extern void free_feature_lists(void)
+{
+	xhash_free_ptr(&active_feature_hash);
+	xhash_free_ptr(&avail_feature_hash);
+	FREE_NULL_LIST(active_feature_list);
+	FREE_NULL_LIST(avail_feature_list);
+}
+
 /* Add feature to list
  * feature_list IN - destination list, either active_feature_list or
  *	avail_feature_list
@@ -1841,26 +1905,16 @@ static void _add_config_feature(list_t *feature_list, char *feature,
 				bitstr_t *node_bitmap)
 {
 	node_feature_t *feature_ptr;
-	list_itr_t *feature_iter;
-	bool match = false;
 
 	/* If feature already in avail_feature_list, just update the bitmap */
-	feature_iter = list_iterator_create(feature_list);
-	while ((feature_ptr = list_next(feature_iter))) {
-		if (xstrcmp(feature, feature_ptr->name))
-			continue;
+	if ((feature_ptr = find_node_feature(feature_list, feature))) {
 		bit_or(feature_ptr->node_bitmap, node_bitmap);
-		match = true;
-		break;
-	}
-	list_iterator_destroy(feature_iter);
-
-	if (!match) {	/* Need to create new avail_feature_list record */
+	} else {	/* Need to create new avail_feature_list record */
 		feature_ptr = xmalloc(sizeof(node_feature_t));
 		feature_ptr->magic = FEATURE_MAGIC;
 		feature_ptr->name = xstrdup(feature);
 		feature_ptr->node_bitmap = bit_copy(node_bitmap);
-		list_append(feature_list, feature_ptr);
+		_append_feature(feature_list, feature_ptr);
 	}
 }
 
@@ -1873,27 +1927,17 @@ static void _add_config_feature_inx(list_t *feature_list, char *feature,
 				    int node_inx)
 {
 	node_feature_t *feature_ptr;
-	list_itr_t *feature_iter;
-	bool match = false;
 
 	/* If feature already in avail_feature_list, just update the bitmap */
-	feature_iter = list_iterator_create(feature_list);
-	while ((feature_ptr = list_next(feature_iter))) {
-		if (xstrcmp(feature, feature_ptr->name))
-			continue;
+	if ((feature_ptr = find_node_feature(feature_list, feature))) {
 		bit_set(feature_ptr->node_bitmap, node_inx);
-		match = true;
-		break;
-	}
-	list_iterator_destroy(feature_iter);
-
-	if (!match) {	/* Need to create new avail_feature_list record */
+	} else {	/* Need to create new avail_feature_list record */
 		feature_ptr = xmalloc(sizeof(node_feature_t));
 		feature_ptr->magic = FEATURE_MAGIC;
 		feature_ptr->name = xstrdup(feature);
 		feature_ptr->node_bitmap = bit_alloc(node_record_count);
 		bit_set(feature_ptr->node_bitmap, node_inx);
-		list_append(feature_list, feature_ptr);
+		_append_feature(feature_list, feature_ptr);
 	}
 }
 
@@ -1922,10 +1966,7 @@ extern void build_feature_list_eq(void)
 	list_itr_t *feature_iter;
 	char *tmp_str, *token, *last = NULL;
 
-	FREE_NULL_LIST(active_feature_list);
-	FREE_NULL_LIST(avail_feature_list);
-	active_feature_list = list_create(_list_delete_feature);
-	avail_feature_list = list_create(_list_delete_feature);
+	_create_feature_lists();
 
 	config_iterator = list_iterator_create(config_list);
 	while ((config_ptr = list_next(config_iterator))) {
@@ -1950,7 +1991,7 @@ extern void build_feature_list_eq(void)
 		active_feature_ptr->name = xstrdup(avail_feature_ptr->name);
 		active_feature_ptr->node_bitmap =
 			bit_copy(avail_feature_ptr->node_bitmap);
-		list_append(active_feature_list, active_feature_ptr);
+		_append_feature(active_feature_list, active_feature_ptr);
 	}
 	list_iterator_destroy(feature_iter);
 }
@@ -1991,10 +2032,7 @@ extern void build_feature_list_ne(void)
 	char *tmp_str, *token, *last = NULL;
 	int i;
 
-	FREE_NULL_LIST(active_feature_list);
-	FREE_NULL_LIST(avail_feature_list);
-	active_feature_list = list_create(_list_delete_feature);
-	avail_feature_list = list_create(_list_delete_feature);
+	_create_feature_lists();
 
 	for (i = 0; (node_ptr = next_node(&i)); i++) {
 		if (node_ptr->features_act) {
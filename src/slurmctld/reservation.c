@@ -424,6 +424,7 @@ static list_t *_list_dup(list_t *license_list)
 	while ((license_src = list_next(iter))) {
 		license_dest = xmalloc(sizeof(licenses_t));
 		license_dest->name = xstrdup(license_src->name);
+		license_dest->id = license_src->id;
 		license_dest->used = license_src->used;
 		list_push(lic_list, license_dest);
 	}
@@ -4182,7 +4183,7 @@ extern int dump_all_resv_state(void)
 	unlock_slurmctld(resv_read_lock);
 
 	/* write the buffer to file */
-	lock_state_files();
+	lock_state_file(STATE_FILE_RESV);
 	log_fd = creat(new_file, 0600);
 	if (log_fd < 0) {
 		error("Can't save state, error creating file %s, %m",
@@ -4222,7 +4223,7 @@ extern int dump_all_resv_state(void)
 	xfree(old_file);
 	xfree(reg_file);
 	xfree(new_file);
-	unlock_state_files();
+	unlock_state_file(STATE_FILE_RESV);
 
 	FREE_NULL_BUFFER(buffer);
 	END_TIMER2(__func__);
@@ -4791,7 +4792,7 @@ static buf_t *_open_resv_state_file(char **state_file)
 
 	*state_file = xstrdup(slurm_conf.state_save_location);
 	xstrcat(*state_file, "/resv_state");
-	if (!(buf = create_mmap_buf(*state_file)))
+	if (!(buf = state_file_open(*state_file)))
 		error("Could not open reservation state file %s: %m",
 		      *state_file);
 	else
@@ -4799,7 +4800,7 @@ static buf_t *_open_resv_state_file(char **state_file)
 
 	error("NOTE: Trying backup state save file. Reservations may be lost");
 	xstrcat(*state_file, ".old");
-	return create_mmap_buf(*state_file);
+	return state_file_open(*state_file);
 }
 
 /*
@@ -4831,16 +4832,16 @@ extern int load_all_resv_state(int recover)
 	_create_resv_lists(true);
 
 	/* read the file */
-	lock_state_files();
+	lock_state_file(STATE_FILE_RESV);
 	if (!(buffer = _open_resv_state_file(&state_file))) {
 		info("No reservation state file (%s) to recover",
 		     state_file);
 		xfree(state_file);
-		unlock_state_files();
+		unlock_state_file(STATE_FILE_RESV);
 		return ENOENT;
 	}
 	xfree(state_file);
-	unlock_state_files();
+	unlock_state_file(STATE_FILE_RESV);
 
 	safe_unpackstr(&ver_str, buffer);
 	debug3("Version string in resv_state header is %s", ver_str);
@@ -6646,6 +6647,14 @@ extern int job_test_lic_resv(job_record_t *job_ptr, char *lic_name,
 	job_end_time   = when + _get_job_duration(job_ptr, reboot);
 	iter = list_iterator_create(resv_list);
 	while ((resv_ptr = list_next(iter))) {
+		/*
+		 * Most reservations hold no licenses and can't contribute to
+		 * the count, so don't bother with their times or names.
+		 */
+		if (!resv_ptr->license_list ||
+		    list_is_empty(resv_ptr->license_list))
+			continue;
+
 		if (resv_ptr->end_time <= now)
 			(void)_advance_resv_time(resv_ptr);
 
@@ -0,0 +1,198 @@
+/*****************************************************************************\
+ *  rpc_coalesce.c
+ *****************************************************************************
+ *  Copyright (C) SchedMD LLC.
+ *
+ *  This file is part of Slurm, a resource management program.
+ *  For details, see <https://slurm.schedmd.com/>.
+ *  Please also read the included file: DISCLAIMER.
+ *
+ *  Slurm is free software; you can redistribute it and/or modify it under
+ *  the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the License, or (at your option)
+ *  any later version.
+ *
+ *  In addition, as a special exception, the copyright holders give permission
+ *  to link the code of portions of this program with the OpenSSL library under
+ *  certain conditions as described in each individual source file, and
+ *  distribute linked combinations including the two. You must obey the GNU
+ *  General Public License in all respects for all of the code used other than
+ *  OpenSSL. If you modify file(s) with this exception, you may extend this
+ *  exception to your version of the file(s), but you are not obligated to do
+ *  so. If you do not wish to do so, delete this exception statement from your
+ *  version.  If you delete this exception statement from all source files in
+ *  the program, then also delete it here.
+ *
+ *  Slurm is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with Slurm; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA.
+\*****************************************************************************/
+
+
+#include "config.h"
+
+#include <stdlib.h>
+
+#include "src/common/list.h"
+#include "src/common/macros.h"
+#include "src/common/read_config.h"
+#include "src/common/slurm_protocol_defs.h"
+#include "src/common/timers.h"
+#include "src/common/xstring.h"
+
+#include "src/slurmctld/locks.h"
+#include "src/slurmctld/proc_req.h"
+#include "src/slurmctld/rpc_coalesce.h"
+
+#define DEFAULT_COALESCE_USEC 2000
+
+typedef struct {
+	slurm_msg_t *msg;
+	bool done;
+} coalesce_work_t;
+
+/* usec to collect msgs for a batch before processing, 0 to disable */
+static int coalesce_usec = DEFAULT_COALESCE_USEC;
+
+extern void rpc_coalesce_init(void)
+{
+	char *tmp_ptr;
+
+	if ((tmp_ptr = xstrcasestr(slurm_conf.slurmctld_params,
+				   "rpc_coalesce_usec=")))
+		coalesce_usec = atoi(tmp_ptr + 18);
+
+	if (coalesce_usec <= 0) {
+		coalesce_usec = 0;
+		debug("%s: RPC coalescing disabled", __func__);
+		return;
+	}
+
+	for (slurmctld_rpc_t *rpc = slurmctld_rpcs; rpc->msg_type; rpc++) {
+		if (!rpc->coalesce)
+			continue;
+
+		rpc->coalesce_work = list_create(NULL);
+		rpc->coalesce_leader = false;
+		slurm_cond_init(&rpc->coalesce_cond, NULL);
+		slurm_mutex_init(&rpc->coalesce_mutex);
+
+		verbose("coalescing %s RPCs every %d usec",
+			rpc_num2string(rpc->msg_type), coalesce_usec);
+	}
+}
+
+extern void rpc_coalesce_shutdown(void)
+{
+	if (!coalesce_usec)
+		return;
+
+	for (slurmctld_rpc_t *rpc = slurmctld_rpcs; rpc->msg_type; rpc++) {
+		if (!rpc->coalesce)
+			continue;
+
+		slurm_mutex_lock(&rpc->coalesce_mutex);
+		/* Leave the list for any straggling batch to finish with */
+		if (!rpc->coalesce_leader && !list_count(rpc->coalesce_work))
+			FREE_NULL_LIST(rpc->coalesce_work);
+		slurm_mutex_unlock(&rpc->coalesce_mutex);
+	}
+}
+
+static int _mark_done(void *x, void *arg)
+{
+	coalesce_work_t *work = x;
+
+	work->done = true;
+	return SLURM_SUCCESS;
+}
+
+/* Collect and process a batch of msgs. Caller must hold coalesce_mutex. */
+static void _lead_batch(slurmctld_rpc_t *rpc)
+{
+	list_t *batch = list_create(NULL);
+	coalesce_work_t *work;
+	list_itr_t *itr;
+	int count;
+
+	rpc->coalesce_leader = true;
+	slurm_mutex_unlock(&rpc->coalesce_mutex);
+
+	/* Give other senders a chance to join this batch */
+	usleep(coalesce_usec);
+
+	slurm_mutex_lock(&rpc->coalesce_mutex);
+	list_transfer(batch, rpc->coalesce_work);
+	slurm_mutex_unlock(&rpc->coalesce_mutex);
+
+	count = list_count(batch);
+	log_flag(PROTOCOL, "%s: processing %d %s RPCs",
+		 __func__, count, rpc_num2string(rpc->msg_type));
+
+	lock_slurmctld(rpc->locks);
+	itr = list_iterator_create(batch);
+	while ((work = list_next(itr))) {
+		slurm_msg_t *msg = work->msg;
+		uint16_t flags = msg->flags;
+		DEF_TIMERS;
+
+		START_TIMER;
+		/* Locks are already held, as for queued rpcs */
+		msg->flags |= CTLD_QUEUE_PROCESSING;
+		rpc->func(msg);
+		msg->flags = flags;
+		END_TIMER;
+		record_rpc_stats(msg, DELTA_TIMER);
+	}
+	list_iterator_destroy(itr);
+	unlock_slurmctld(rpc->locks);
+
+	if (rpc->post_func)
+		rpc->post_func();
+
+	slurm_mutex_lock(&rpc->coalesce_mutex);
+	(void) list_for_each(batch, _mark_done, NULL);
+	rpc->coalesce_leader = false;
+	/* Wake senders of this batch and any waiting to lead the next one */
+	slurm_cond_broadcast(&rpc->coalesce_cond);
+
+	FREE_NULL_LIST(batch);
+}
+
+extern bool rpc_coalesce(slurmctld_rpc_t *rpc, slurm_msg_t *msg)
+{
+	coalesce_work_t work = {
+		.msg = msg,
+	};
+
+	if (!coalesce_usec || !rpc->coalesce ||
+	    (msg->flags & CTLD_QUEUE_PROCESSING))
+		return false;
+
+	slurm_mutex_lock(&rpc->coalesce_mutex);
+
+	if (!rpc->coalesce_work) {
+		/* rpc_coalesce_shutdown() already called */
+		slurm_mutex_unlock(&rpc->coalesce_mutex);
+		return false;
+	}
+
+	list_append(rpc->coalesce_work, &work);
+
+	while (!work.done) {
+		if (!rpc->coalesce_leader)
+			_lead_batch(rpc);
+		else
+			slurm_cond_wait(&rpc->coalesce_cond,
+					&rpc->coalesce_mutex);
+	}
+
+	slurm_mutex_unlock(&rpc->coalesce_mutex);
+
+	return true;
+}
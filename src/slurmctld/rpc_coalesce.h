@@ -0,0 +1,59 @@
+/*****************************************************************************\
+ *  rpc_coalesce.h
+ *****************************************************************************
+ *  Copyright (C) SchedMD LLC.
+ *
+ *  This file is part of Slurm, a resource management program.
+ *  For details, see <https://slurm.schedmd.com/>.
+ *  Please also read the included file: DISCLAIMER.
+ *
+ *  Slurm is free software; you can redistribute it and/or modify it under
+ *  the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the License, or (at your option)
+ *  any later version.
+ *
+ *  In addition, as a special exception, the copyright holders give permission
+ *  to link the code of portions of this program with the OpenSSL library under
+ *  certain conditions as described in each individual source file, and
+ *  distribute linked combinations including the two. You must obey the GNU
+ *  General Public License in all respects for all of the code used other than
+ *  OpenSSL. If you modify file(s) with this exception, you may extend this
+ *  exception to your version of the file(s), but you are not obligated to do
+ *  so. If you do not wish to do so, delete this exception statement from your
+ *  version.  If you delete this exception statement from all source files in
+ *  the program, then also delete it here.
+ *
+ *  Slurm is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with Slurm; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA.
+\*****************************************************************************/
+
+#ifndef _RPC_COALESCE_H_
+#define _RPC_COALESCE_H_
+
+#include "src/common/slurm_protocol_defs.h"
+
+#include "src/slurmctld/proc_req.h"
+
+extern void rpc_coalesce_init(void);
+
+extern void rpc_coalesce_shutdown(void);
+
+/*
+ * Process msg as part of a batch of concurrent msgs of the same type.
+ * All msgs in a batch are processed under a single acquisition of the rpc
+ * locks and rpc->post_func() is called once on the batch. Returns once msg
+ * has been processed and responded to.
+ * IN rpc - rpc table entry for msg->msg_type
+ * IN msg - msg to process
+ * RET true if msg was processed, false if msg was not coalesced and must be
+ *	processed by the caller
+ */
+extern bool rpc_coalesce(slurmctld_rpc_t *rpc, slurm_msg_t *msg);
+
+#endif
@@ -43,8 +43,10 @@
 
 #include "src/common/list.h"
 #include "src/common/macros.h"
+#include "src/common/metrics.h"
 #include "src/common/read_config.h"
 #include "src/common/slurm_protocol_defs.h"
+#include "src/common/timers.h"
 #include "src/common/xmalloc.h"
 #include "src/common/xstring.h"
 
@@ -55,8 +57,186 @@
 #include "src/slurmctld/proc_req.h"
 #include "src/slurmctld/state_save.h"
 
+typedef struct {
+	const char *name;
+	int priority; /* lower value is processed first */
+	uint16_t weight; /* msgs per cycle while higher lane has backlog */
+	uint16_t max_active; /* max queues holding locks at once, 0 unlimited */
+	uint32_t max_queued; /* max msgs queued in lane, 0 unlimited */
+	uint32_t shed_depth; /* shed when higher lanes have this many queued */
+	uint32_t slo_usec; /* target max queue latency, 0 to disable */
+	bool hard_drop; /* discard traffic when shedding */
+
+	/* Lane state and statistics, protected by lanes_mutex */
+	uint32_t queued;
+	uint16_t active;
+	uint64_t dropped;
+	uint64_t processed;
+	uint64_t slo_missed;
+	uint32_t wait_max_usec;
+} lane_t;
+
+typedef struct {
+	slurm_msg_t *msg;
+	struct timeval queued; /* time msg was queued */
+} rpc_work_t;
+
 bool enabled = true;
 
+static pthread_mutex_t lanes_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t lanes_cond = PTHREAD_COND_INITIALIZER;
+static bool lanes_shutdown = false;
+static lane_t lanes[RPC_LANE_COUNT] = {
+	[RPC_LANE_COMPLETION] = {
+		.name = "completion",
+		.priority = 0,
+		.slo_usec = 100000,
+	},
+	[RPC_LANE_DEFAULT] = {
+		.name = "default",
+		.priority = 1,
+		.weight = 16,
+		.slo_usec = 500000,
+	},
+	[RPC_LANE_QUERY] = {
+		.name = "query",
+		.priority = 2,
+		.max_active = 2,
+		.slo_usec = 2000000,
+	},
+};
+
+/* Count msgs queued in lanes with a higher priority than lane */
+static uint32_t _higher_queued(lane_t *lane)
+{
+	uint32_t queued = 0;
+
+	for (int i = 0; i < RPC_LANE_COUNT; i++)
+		if (lanes[i].priority < lane->priority)
+			queued += lanes[i].queued;
+
+	return queued;
+}
+
+/*
+ * Wait until the queue's lane may take the slurmctld locks: the lane must be
+ * under max_active and, for lanes with no weight, no higher priority lane may
+ * have a backlog.
+ */
+static void _lane_acquire(slurmctld_rpc_t *q)
+{
+	lane_t *lane = &lanes[q->lane];
+
+	slurm_mutex_lock(&lanes_mutex);
+	while (!lanes_shutdown &&
+	       ((lane->max_active && (lane->active >= lane->max_active)) ||
+		(!lane->weight && _higher_queued(lane)))) {
+		log_flag(PROTOCOL, "%s(%s): waiting on %s lane active=%u/%u higher_queued=%u",
+			 __func__, q->msg_name, lane->name, lane->active,
+			 lane->max_active, _higher_queued(lane));
+		slurm_cond_wait(&lanes_cond, &lanes_mutex);
+	}
+	lane->active++;
+	slurm_mutex_unlock(&lanes_mutex);
+}
+
+static void _lane_release(slurmctld_rpc_t *q)
+{
+	slurm_mutex_lock(&lanes_mutex);
+	xassert(lanes[q->lane].active > 0);
+	lanes[q->lane].active--;
+	slurm_cond_broadcast(&lanes_cond);
+	slurm_mutex_unlock(&lanes_mutex);
+}
+
+/* Check if queue should yield the locks to a higher priority lane */
+static bool _lane_preempted(slurmctld_rpc_t *q, int processed)
+{
+	lane_t *lane = &lanes[q->lane];
+	bool preempted;
+
+	if (processed < lane->weight)
+		return false;
+
+	slurm_mutex_lock(&lanes_mutex);
+	preempted = (_higher_queued(lane) > 0);
+	slurm_mutex_unlock(&lanes_mutex);
+
+	return preempted;
+}
+
+/*
+ * Admit msg into the queue's lane
+ * RET SLURM_SUCCESS or SLURMCTLD_COMMUNICATIONS_(HARD_DROP|BACKOFF) if shed
+ */
+static int _lane_admit(slurmctld_rpc_t *q)
+{
+	lane_t *lane = &lanes[q->lane];
+	int rc = SLURM_SUCCESS;
+
+	slurm_mutex_lock(&lanes_mutex);
+	if ((lane->max_queued && (lane->queued >= lane->max_queued)) ||
+	    (lane->shed_depth && (_higher_queued(lane) >= lane->shed_depth))) {
+		lane->dropped++;
+		log_flag(PROTOCOL, "%s(%s): shedding in %s lane queued=%u/%u higher_queued=%u/%u",
+			 __func__, q->msg_name, lane->name, lane->queued,
+			 lane->max_queued, _higher_queued(lane),
+			 lane->shed_depth);
+		rc = (lane->hard_drop ? SLURMCTLD_COMMUNICATIONS_HARD_DROP :
+		      SLURMCTLD_COMMUNICATIONS_BACKOFF);
+	} else {
+		lane->queued++;
+	}
+	slurm_mutex_unlock(&lanes_mutex);
+
+	return rc;
+}
+
+/* Remove msg from the queue's lane backlog */
+static void _lane_unqueue(slurmctld_rpc_t *q)
+{
+	lane_t *lane = &lanes[q->lane];
+
+	slurm_mutex_lock(&lanes_mutex);
+	xassert(lane->queued > 0);
+	/* wake lower priority lanes waiting on this backlog */
+	if (!--lane->queued)
+		slurm_cond_broadcast(&lanes_cond);
+	slurm_mutex_unlock(&lanes_mutex);
+}
+
+static slurm_msg_t *_dequeue(slurmctld_rpc_t *q)
+{
+	rpc_work_t *work = list_dequeue(q->work);
+	lane_t *lane = &lanes[q->lane];
+	slurm_msg_t *msg;
+	int wait_usec;
+
+	if (!work)
+		return NULL;
+
+	msg = work->msg;
+	wait_usec = slurm_delta_tv(&work->queued);
+	xfree(work);
+
+	slurm_mutex_lock(&lanes_mutex);
+	xassert(lane->queued > 0);
+	if (!--lane->queued)
+		slurm_cond_broadcast(&lanes_cond);
+	lane->processed++;
+	if (wait_usec > lane->wait_max_usec)
+		lane->wait_max_usec = wait_usec;
+	if (lane->slo_usec && (wait_usec > lane->slo_usec)) {
+		lane->slo_missed++;
+		log_flag(PROTOCOL, "%s(%s): %s lane queue latency %d usec exceeds %u usec objective (missed %"PRIu64"/%"PRIu64")",
+			 __func__, q->msg_name, lane->name, wait_usec,
+			 lane->slo_usec, lane->slo_missed, lane->processed);
+	}
+	slurm_mutex_unlock(&lanes_mutex);
+
+	return msg;
+}
+
 static void *_rpc_queue_worker(void *arg)
 {
 	slurmctld_rpc_t *q = (slurmctld_rpc_t *) arg;
@@ -75,6 +255,7 @@ static void *_rpc_queue_worker(void *arg)
 	 * Acquire on init to simplify the inner loop.
 	 * On rpc_queue_init() this will proceed directly to slurm_cond_wait().
 	 */
+	_lane_acquire(q);
 	lock_slurmctld(q->locks);
 
 	/*
@@ -91,11 +272,14 @@ static void *_rpc_queue_worker(void *arg)
 		    (q->max_usec_per_cycle &&
 		     (processed_usec >= q->max_usec_per_cycle)))
 			highload = true;
+		else if (_lane_preempted(q, processed))
+			highload = true;
 		else
-			msg = list_dequeue(q->work);
+			msg = _dequeue(q);
 
 		if (!msg) {
 			unlock_slurmctld(q->locks);
+			_lane_release(q);
 
 			if (processed && q->post_func)
 				q->post_func();
@@ -161,6 +345,7 @@ static void *_rpc_queue_worker(void *arg)
 			slurm_mutex_unlock(&q->mutex);
 			log_flag(PROTOCOL, "%s(%s): woke up",
 				 __func__, q->msg_name);
+			_lane_acquire(q);
 			lock_slurmctld(q->locks);
 		} else {
 			DEF_TIMERS;
@@ -269,6 +454,81 @@ static void _apply_config(data_t *conf, slurmctld_rpc_t *q)
 	if ((field = data_key_get(settings, "interval")))
 		if (!data_get_int_converted(field, &int64_tmp))
 			q->interval = int64_tmp;
+
+	if ((field = data_key_get(settings, "lane"))) {
+		char *name = NULL;
+
+		if (!data_get_string_converted(field, &name)) {
+			int i = 0;
+
+			for (; i < RPC_LANE_COUNT; i++) {
+				if (!xstrcasecmp(lanes[i].name, name)) {
+					q->lane = i;
+					break;
+				}
+			}
+
+			if (i >= RPC_LANE_COUNT)
+				fatal("Invalid rpc_queue lane %s for %s",
+				      name, q->msg_name);
+		}
+		xfree(name);
+	}
+}
+
+static bool _find_lane_name(const data_t *data, void *needle)
+{
+	const data_t *name = NULL;
+
+	if (data_get_type(data) != DATA_TYPE_DICT)
+		return false;
+
+	name = data_key_get_const(data, "name");
+
+	if (data_get_type(name) != DATA_TYPE_STRING)
+		return false;
+
+	return !xstrcasecmp(data_get_string(name), needle);
+}
+
+static void _apply_lane_config(data_t *conf, lane_t *lane)
+{
+	data_t *rpc_lanes = NULL, *settings = NULL, *field = NULL;
+	int64_t int64_tmp;
+
+	if (!conf)
+		return;
+
+	rpc_lanes = data_key_get(conf, "rpc_lanes");
+	if (data_get_type(rpc_lanes) != DATA_TYPE_LIST)
+		return;
+
+	if (!(settings = data_list_find_first(rpc_lanes, _find_lane_name,
+					      (void *) lane->name)))
+		return;
+
+	if ((field = data_key_get(settings, "hard_drop")))
+		(void) data_get_bool_converted(field, &lane->hard_drop);
+
+	if ((field = data_key_get(settings, "weight")))
+		if (!data_get_int_converted(field, &int64_tmp))
+			lane->weight = int64_tmp;
+
+	if ((field = data_key_get(settings, "max_active")))
+		if (!data_get_int_converted(field, &int64_tmp))
+			lane->max_active = int64_tmp;
+
+	if ((field = data_key_get(settings, "max_queued")))
+		if (!data_get_int_converted(field, &int64_tmp))
+			lane->max_queued = int64_tmp;
+
+	if ((field = data_key_get(settings, "shed_depth")))
+		if (!data_get_int_converted(field, &int64_tmp))
+			lane->shed_depth = int64_tmp;
+
+	if ((field = data_key_get(settings, "slo_usec")))
+		if (!data_get_int_converted(field, &int64_tmp))
+			lane->slo_usec = int64_tmp;
 }
 
 extern void rpc_queue_init(void)
@@ -284,6 +544,17 @@ extern void rpc_queue_init(void)
 
 	conf = _load_config();
 
+	for (int i = 0; i < RPC_LANE_COUNT; i++) {
+		lane_t *lane = &lanes[i];
+
+		_apply_lane_config(conf, lane);
+
+		verbose("rpc_queue lane %s: priority=%d weight=%u max_active=%u max_queued=%u shed_depth=%u slo_usec=%u hard_drop=%d",
+			lane->name, lane->priority, lane->weight,
+			lane->max_active, lane->max_queued, lane->shed_depth,
+			lane->slo_usec, lane->hard_drop);
+	}
+
 	for (slurmctld_rpc_t *q = slurmctld_rpcs; q->msg_type; q++) {
 		if (!q->queue_enabled)
 			continue;
@@ -298,15 +569,15 @@ extern void rpc_queue_init(void)
 			continue;
 		}
 
-		q->work = list_create(NULL);
+		q->work = list_create(xfree_ptr);
 		slurm_cond_init(&q->cond, NULL);
 		slurm_mutex_init(&q->mutex);
 		q->shutdown = false;
 
-		verbose("starting rpc_queue for %s: max_per_cycle=%u max_usec_per_cycle=%u max_queued=%d hard_drop=%d yield_sleep=%d interval=%d",
-			q->msg_name, q->max_per_cycle, q->max_usec_per_cycle,
-			q->max_queued, q->hard_drop, q->yield_sleep,
-			q->interval);
+		verbose("starting rpc_queue for %s: lane=%s max_per_cycle=%u max_usec_per_cycle=%u max_queued=%d hard_drop=%d yield_sleep=%d interval=%d",
+			q->msg_name, lanes[q->lane].name, q->max_per_cycle,
+			q->max_usec_per_cycle, q->max_queued, q->hard_drop,
+			q->yield_sleep, q->interval);
 		slurm_thread_create(&q->thread, _rpc_queue_worker, q);
 	}
 
@@ -320,6 +591,11 @@ extern void rpc_queue_shutdown(void)
 
 	enabled = false;
 
+	slurm_mutex_lock(&lanes_mutex);
+	lanes_shutdown = true;
+	slurm_cond_broadcast(&lanes_cond);
+	slurm_mutex_unlock(&lanes_mutex);
+
 	/* mark all as shut down */
 	for (slurmctld_rpc_t *q = slurmctld_rpcs; q->msg_type; q++) {
 		if (!q->queue_enabled)
@@ -339,6 +615,40 @@ extern void rpc_queue_shutdown(void)
 		slurm_thread_join(q->thread);
 		FREE_NULL_LIST(q->work);
 	}
+
+	for (int i = 0; i < RPC_LANE_COUNT; i++) {
+		lane_t *lane = &lanes[i];
+
+		verbose("rpc_queue lane %s: processed=%"PRIu64" dropped=%"PRIu64" slo_missed=%"PRIu64" wait_max_usec=%u",
+			lane->name, lane->processed, lane->dropped,
+			lane->slo_missed, lane->wait_max_usec);
+	}
+}
+
+extern void rpc_queue_register_metrics(void)
+{
+	static const char *labels[RPC_LANE_COUNT] = {
+		[RPC_LANE_COMPLETION] = "lane=\"completion\"",
+		[RPC_LANE_DEFAULT] = "lane=\"default\"",
+		[RPC_LANE_QUERY] = "lane=\"query\"",
+	};
+
+	if (!enabled)
+		return;
+
+	for (int i = 0; i < RPC_LANE_COUNT; i++) {
+		lane_t *lane = &lanes[i];
+
+		metric_register_src("rpc_queue_depth", labels[i], METRIC_GAUGE,
+				    "RPCs waiting in rpc_queue",
+				    &lane->queued, sizeof(lane->queued));
+		metric_register_src("rpc_queue_processed", labels[i],
+				    METRIC_COUNTER, "RPCs processed by rpc_queue",
+				    &lane->processed, sizeof(lane->processed));
+		metric_register_src("rpc_queue_dropped", labels[i],
+				    METRIC_COUNTER, "RPCs shed by rpc_queue",
+				    &lane->dropped, sizeof(lane->dropped));
+	}
 }
 
 extern bool rpc_queue_enabled(void)
@@ -353,15 +663,27 @@ extern int rpc_enqueue(slurm_msg_t *msg)
 
 	for (slurmctld_rpc_t *q = slurmctld_rpcs; q->msg_type; q++) {
 		if (q->msg_type == msg->msg_type) {
+			rpc_work_t *work = NULL;
+			int rc;
+
 			if (!q->queue_enabled)
 				break;
 
+			if ((rc = _lane_admit(q))) {
+				slurm_mutex_lock(&q->mutex);
+				q->dropped++;
+				record_rpc_queue_stats(q);
+				slurm_mutex_unlock(&q->mutex);
+				return rc;
+			}
+
 			if (q->max_queued) {
 				slurm_mutex_lock(&q->mutex);
 				if (q->queued >= q->max_queued) {
 					q->dropped++;
 					record_rpc_queue_stats(q);
 					slurm_mutex_unlock(&q->mutex);
+					_lane_unqueue(q);
 					if (q->hard_drop)
 						return SLURMCTLD_COMMUNICATIONS_HARD_DROP;
 					else
@@ -372,7 +694,10 @@ extern int rpc_enqueue(slurm_msg_t *msg)
 				slurm_mutex_unlock(&q->mutex);
 			}
 
-			list_enqueue(q->work, msg);
+			work = xmalloc(sizeof(*work));
+			work->msg = msg;
+			gettimeofday(&work->queued, NULL);
+			list_enqueue(q->work, work);
 			slurm_mutex_lock(&q->mutex);
 			slurm_cond_signal(&q->cond);
 			slurm_mutex_unlock(&q->mutex);
@@ -44,4 +44,7 @@ extern bool rpc_queue_enabled(void);
 
 extern int rpc_enqueue(slurm_msg_t *msg);
 
+/* Export rpc_queue lane depths through the metrics registry */
+extern void rpc_queue_register_metrics(void);
+
 #endif
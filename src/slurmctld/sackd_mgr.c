@@ -179,11 +179,12 @@ extern void sackd_mgr_add_node(slurm_msg_t *msg)
 static int _each_sackd_node(void *x, void *arg)
 {
 	sackd_node_t *node = x;
+	config_response_msg_t *config = arg;
 	agent_arg_t *args = xmalloc(sizeof(*args));
 
 	args->addr = xmalloc(sizeof(slurm_addr_t));
 	slurm_set_addr(args->addr, slurm_conf.slurmd_port, node->nodeaddr);
-	args->msg_args = new_config_response(false);
+	args->msg_args = copy_config_response(config);
 	args->msg_type = REQUEST_RECONFIGURE_SACKD;
 	args->hostlist = hostlist_create(node->hostname);
 	args->node_count = 1;
@@ -199,17 +200,22 @@ static int _each_sackd_node(void *x, void *arg)
 extern void sackd_mgr_push_reconfig(void)
 {
 	int count = 0;
+	config_response_msg_t *config;
 
 	slurm_mutex_lock(&sackd_lock);
 
-	if (!sackd_nodes) {
+	if (!sackd_nodes || !list_count(sackd_nodes)) {
 		slurm_mutex_unlock(&sackd_lock);
 		return;
 	}
 
-	count = list_for_each(sackd_nodes, _each_sackd_node, NULL);
+	/* Read the config files once rather than once per sackd */
+	config = new_config_response(false);
+	count = list_for_each(sackd_nodes, _each_sackd_node, config);
 	debug("%s: triggered reconfig for %d nodes", __func__, count);
 	slurm_mutex_unlock(&sackd_lock);
+
+	slurm_free_config_response_msg(config);
 }
 
 extern void sackd_mgr_remove_node(char *node)
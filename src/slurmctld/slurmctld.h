@@ -124,6 +124,15 @@
 #define PERIODIC_NODE_ACCT 300
 #endif
 
+/* Record a statistics history sample every STATS_HISTORY_INTERVAL seconds
+ * and keep STATS_HISTORY_CNT of them (one day) */
+#ifndef STATS_HISTORY_INTERVAL
+#define STATS_HISTORY_INTERVAL 60
+#endif
+#ifndef STATS_HISTORY_CNT
+#define STATS_HISTORY_CNT 1440
+#endif
+
 /* Seconds to wait for backup controller response to REQUEST_CONTROL RPC */
 #ifndef CONTROL_TIMEOUT
 #define CONTROL_TIMEOUT 30	/* seconds */
@@ -177,6 +186,18 @@ typedef enum {
 } bf_exit_t;
 
 /* Job scheduling statistics */
+/* Scheduling code phases timed for sdiag, see sched_phase_stats */
+typedef enum {
+	SCHED_PHASE_BUILD_QUEUE,	/* _schedule(): build/sort job queue */
+	SCHED_PHASE_SELECT_NODES,	/* select_nodes() */
+	SCHED_PHASE_ACCT_PRE_SELECT,	/* acct_policy_job_runnable_pre_select() */
+	SCHED_PHASE_ACCT_POST_SELECT,	/* acct_policy_job_runnable_post_select() */
+	SCHED_PHASE_BF_BUILD_QUEUE,	/* backfill: build/sort job queue */
+	SCHED_PHASE_BF_TEST,		/* backfill: test a job's start time */
+	SCHED_PHASE_GRES_SELECT,	/* select: pick GRES for an allocation */
+	SCHED_PHASE_COUNT
+} sched_phase_t;
+
 typedef struct diag_stats {
 	int proc_req_threads;
 	int proc_req_raw;
@@ -245,6 +266,7 @@ enum {
 extern bool  preempt_send_user_signal;
 extern time_t	last_proc_req_start;
 extern diag_stats_t slurmctld_diag_stats;
+extern timer_phase_t sched_phase_stats[SCHED_PHASE_COUNT];
 extern slurmctld_config_t slurmctld_config;
 extern void *acct_db_conn;
 extern uint16_t accounting_enforce;
@@ -887,6 +909,22 @@ extern int job_fail_qos(job_record_t *job_ptr, const char *func_name,
  */
 extern void delete_job_desc_files(uint32_t job_id);
 
+/*
+ * stage_job_desc_files - write the environment and script files of a batch
+ * job submission before the job write lock is taken. _job_create() then only
+ * moves them into the job's directory. Nothing is staged for submissions
+ * which would be rejected while writing the files.
+ * IN/OUT job_desc - sets script_stage_dir on success
+ * RET SLURM_SUCCESS or error code
+ */
+extern int stage_job_desc_files(job_desc_msg_t *job_desc);
+
+/*
+ * unstage_job_desc_files - remove files staged by stage_job_desc_files() which
+ * were not used by a new job
+ */
+extern void unstage_job_desc_files(job_desc_msg_t *job_desc);
+
 /*
  * job_alloc_info - get details about an existing job allocation
  * IN uid - job issuing the code
@@ -1318,6 +1356,18 @@ extern int load_all_part_state(uint16_t reconfig_flags);
  */
 extern void log_feature_lists(void);
 
+/*
+ * Find a node feature record by name
+ * feature_list IN - active_feature_list or avail_feature_list
+ * name IN - name of the feature to find
+ * RET pointer to the feature record or NULL if not found
+ */
+extern node_feature_t *find_node_feature(list_t *feature_list,
+					 const char *name);
+
+/* Free active_feature_list, avail_feature_list and their name indexes */
+extern void free_feature_lists(void);
+
 /* make_node_alloc - flag specified node as allocated to a job
  * IN node_ptr - pointer to node being allocated
  * IN job_ptr  - pointer to job that is starting
@@ -1399,6 +1449,22 @@ extern int dump_job_state(const uint32_t filter_jobs_count,
 extern buf_t *pack_all_jobs(uint16_t show_flags, uid_t uid, uint32_t filter_uid,
 			    uint16_t protocol_version);
 
+/*
+ * pack_delta_jobs - dump job information for jobs created or changed since a
+ *	job info generation in machine independent form (for network
+ *	transmission), preceded by the new generation and purged job IDs
+ * IN generation - generation returned by an earlier call, 0 for all jobs
+ * IN show_flags - job filtering options
+ * IN uid - uid of user making request (for partition filtering)
+ * OUT buffer
+ * global: job_list - global list of job records
+ * NOTE: the buffer at *buffer_ptr must be xfreed by the caller
+ * NOTE: change _unpack_job_info_delta_msg() in common/slurm_protocol_pack.c
+ *	whenever the data format changes
+ */
+extern buf_t *pack_delta_jobs(uint64_t generation, uint16_t show_flags,
+			      uid_t uid, uint16_t protocol_version);
+
 /*
  * pack_spec_jobs - dump job information for specified jobs in
  *	machine independent form (for network transmission)
@@ -1432,6 +1498,16 @@ extern buf_t *pack_all_nodes(uint16_t show_flags, uid_t uid,
 /* Pack all scheduling statistics */
 extern buf_t *pack_all_stat(uint16_t protocol_version);
 
+/* Pack the duration statistics of the timed scheduling code phases */
+extern void pack_sched_phase_stats(buf_t *buffer, uint16_t protocol_version);
+
+/*
+ * Pack the statistics history samples, oldest first
+ * IN all - pack every sample, otherwise only pack an empty history
+ */
+extern void pack_stats_history(buf_t *buffer, bool all,
+			       uint16_t protocol_version);
+
 /*
  * pack_ctld_job_step_info_response_msg - packs job step info
  * IN step_id - specific id or NO_VAL/NO_VAL for all
@@ -1668,6 +1744,13 @@ extern void reset_node_free_mem(char *node_name, uint64_t free_mem);
  * level IN - clear backfilled_jobs count if set */
 extern void reset_stats(int level);
 
+/*
+ * Record a statistics history sample if STATS_HISTORY_INTERVAL has elapsed
+ * since the previous one. Samples are kept in a fixed size ring which is not
+ * cleared by reset_stats().
+ */
+extern void stats_history_sample(time_t now);
+
 /*
  * restore_node_features - Make node and config (from slurm.conf) fields
  *	consistent for Features, Gres and Weight
@@ -1844,6 +1927,14 @@ extern bool test_job_array_finished(uint32_t array_job_id);
 /* Return true if ANY tasks of specific array job ID are pending */
 extern bool test_job_array_pending(uint32_t array_job_id);
 
+/*
+ * Set complete, completed and pending as test_job_array_complete(),
+ * test_job_array_completed() and test_job_array_pending() would, walking the
+ * array's task records only once
+ */
+extern void test_job_array_state(uint32_t array_job_id, bool *complete,
+				 bool *completed, bool *pending);
+
 /* Determine of the nodes are ready to run a job
  * RET true if ready */
 extern bool test_job_nodes_ready(job_record_t *job_ptr);
@@ -44,6 +44,7 @@
 #include <fcntl.h>
 #include <poll.h>
 #include <signal.h>
+#include <sys/uio.h>
 #include <sys/wait.h>
 #include <unistd.h>
 
@@ -59,6 +60,7 @@
 #include "src/common/setproctitle.h"
 #include "src/common/slurm_protocol_pack.h"
 #include "src/common/track_script.h"
+#include "src/common/xhash.h"
 #include "src/common/xmalloc.h"
 #include "src/common/xstring.h"
 
@@ -328,17 +330,37 @@ static bool _msg_readable(eio_obj_t *obj)
 
 static int _write_msg(int fd, int req, buf_t *buffer, bool lock)
 {
-	int len = 0;
+	/* Write 0 length so the receiver knows not to read anymore */
+	int len = buffer ? get_buf_offset(buffer) : 0;
+	struct iovec iov[3] = {
+		{ .iov_base = &req, .iov_len = sizeof(int) },
+		{ .iov_base = &len, .iov_len = sizeof(int) },
+		{ .iov_base = buffer ? get_buf_data(buffer) : NULL,
+		  .iov_len = len },
+	};
+	struct iovec *iov_ptr = iov;
+	int iovcnt = len ? 3 : 2;
+	ssize_t wrote;
 
 	if (lock)
 		slurm_mutex_lock(&write_mutex);
-	safe_write(fd, &req, sizeof(int));
-	if (buffer) {
-		len = get_buf_offset(buffer);
-		safe_write(fd, &len, sizeof(int));
-		safe_write(fd, get_buf_data(buffer), len);
-	} else /* Write 0 length so the receiver knows not to read anymore */
-		safe_write(fd, &len, sizeof(int));
+	/* Send the header and payload with as few write calls as possible */
+	while (iovcnt) {
+		if ((wrote = writev(fd, iov_ptr, iovcnt)) < 0) {
+			if ((errno == EINTR) || (errno == EAGAIN))
+				continue;
+			goto rwfail;
+		}
+		while (iovcnt && (wrote >= iov_ptr->iov_len)) {
+			wrote -= iov_ptr->iov_len;
+			iov_ptr++;
+			iovcnt--;
+		}
+		if (iovcnt) {
+			iov_ptr->iov_base = (char *) iov_ptr->iov_base + wrote;
+			iov_ptr->iov_len -= wrote;
+		}
+	}
 	if (lock)
 		slurm_mutex_unlock(&write_mutex);
 
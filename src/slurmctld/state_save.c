@@ -43,9 +43,14 @@
 #  include <sys/prctl.h>
 #endif
 
+#include <fcntl.h>
 #include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 #include "src/common/macros.h"
+#include "src/common/xstring.h"
 #include "src/slurmctld/front_end.h"
 #include "src/slurmctld/reservation.h"
 #include "src/slurmctld/slurmctld.h"
@@ -62,6 +67,28 @@ static int save_jobs = 0, save_nodes = 0, save_parts = 0;
 static int save_front_end = 0, save_triggers = 0, save_resv = 0;
 static bool run_save_thread = true;
 
+typedef struct {
+	buf_t *buffer;		/* mapped file, NULL if not mapped */
+	dev_t dev;
+	ino_t ino;
+	off_t size;
+	struct timespec mtime;
+} prefetch_file_t;
+
+/* State files read when a backup slurmctld takes control */
+static const char *prefetch_names[] = {
+	"fed_mgr_state",
+	"front_end_state",
+	"job_state",
+	"job_state.journal",
+	"node_state",
+	"part_state",
+	"resv_state",
+	"trigger_state",
+};
+static prefetch_file_t prefetch_files[ARRAY_SIZE(prefetch_names)];
+static pthread_mutex_t prefetch_lock = PTHREAD_MUTEX_INITIALIZER;
+
 
 /* Queue saving of front_end state information */
 extern void schedule_front_end_save(void)
@@ -117,6 +144,105 @@ extern void schedule_trigger_save(void)
 	slurm_mutex_unlock(&state_save_lock);
 }
 
+static bool _same_file(prefetch_file_t *file, struct stat *stat_buf)
+{
+	return (file->buffer && (file->dev == stat_buf->st_dev) &&
+		(file->ino == stat_buf->st_ino) &&
+		(file->size == stat_buf->st_size) &&
+		(file->mtime.tv_sec == stat_buf->st_mtim.tv_sec) &&
+		(file->mtime.tv_nsec == stat_buf->st_mtim.tv_nsec));
+}
+
+/* Return the prefetch_files entry for a file in StateSaveLocation or NULL */
+static prefetch_file_t *_find_prefetch_file(const char *file)
+{
+	int len = strlen(slurm_conf.state_save_location);
+
+	if (xstrncmp(file, slurm_conf.state_save_location, len) ||
+	    (file[len] != '/'))
+		return NULL;
+
+	for (int i = 0; i < ARRAY_SIZE(prefetch_names); i++) {
+		if (!xstrcmp(&file[len + 1], prefetch_names[i]))
+			return &prefetch_files[i];
+	}
+
+	return NULL;
+}
+
+extern buf_t *state_file_open(const char *file)
+{
+	prefetch_file_t *prefetch;
+	struct stat stat_buf;
+	buf_t *buffer = NULL;
+	int fd;
+
+	slurm_mutex_lock(&prefetch_lock);
+	if (!(prefetch = _find_prefetch_file(file)) || !prefetch->buffer) {
+		slurm_mutex_unlock(&prefetch_lock);
+		return create_mmap_buf(file);
+	}
+
+	/* open() revalidates cached attributes on network file systems */
+	if ((fd = open(file, O_RDONLY | O_CLOEXEC)) < 0) {
+		slurm_mutex_unlock(&prefetch_lock);
+		debug("%s: Failed to open file `%s`, %m", __func__, file);
+		return NULL;
+	}
+	if (!fstat(fd, &stat_buf) && _same_file(prefetch, &stat_buf)) {
+		buffer = create_shadow_buf(get_buf_data(prefetch->buffer),
+					   size_buf(prefetch->buffer));
+		debug3("%s: using prefetched file `%s`", __func__, file);
+	}
+	close(fd);
+	slurm_mutex_unlock(&prefetch_lock);
+
+	if (!buffer)
+		buffer = create_mmap_buf(file);
+
+	return buffer;
+}
+
+extern void state_file_prefetch(void)
+{
+	struct stat stat_buf;
+	char *file = NULL;
+
+	slurm_mutex_lock(&prefetch_lock);
+	for (int i = 0; i < ARRAY_SIZE(prefetch_names); i++) {
+		prefetch_file_t *prefetch = &prefetch_files[i];
+
+		xstrfmtcat(file, "%s/%s", slurm_conf.state_save_location,
+			   prefetch_names[i]);
+		if (stat(file, &stat_buf)) {
+			FREE_NULL_BUFFER(prefetch->buffer);
+		} else if (!_same_file(prefetch, &stat_buf)) {
+			FREE_NULL_BUFFER(prefetch->buffer);
+			prefetch->buffer = create_mmap_buf(file);
+			prefetch->dev = stat_buf.st_dev;
+			prefetch->ino = stat_buf.st_ino;
+			prefetch->size = stat_buf.st_size;
+			prefetch->mtime = stat_buf.st_mtim;
+		}
+
+		/* Pages may have been dropped since the last call */
+		if (prefetch->buffer &&
+		    madvise(get_buf_data(prefetch->buffer),
+			    size_buf(prefetch->buffer), MADV_WILLNEED))
+			debug("%s: madvise(%s): %m", __func__, file);
+		xfree(file);
+	}
+	slurm_mutex_unlock(&prefetch_lock);
+}
+
+extern void state_file_prefetch_fini(void)
+{
+	slurm_mutex_lock(&prefetch_lock);
+	for (int i = 0; i < ARRAY_SIZE(prefetch_names); i++)
+		FREE_NULL_BUFFER(prefetch_files[i].buffer);
+	slurm_mutex_unlock(&prefetch_lock);
+}
+
 /* shutdown the slurmctld_state_save thread */
 extern void shutdown_state_save(void)
 {
@@ -40,6 +40,8 @@
 #ifndef _SLURMCTLD_STATE_SAVE_H
 #define _SLURMCTLD_STATE_SAVE_H
 
+#include "src/common/pack.h"
+
 /* Queue saving of front_end state information */
 extern void schedule_front_end_save(void);
 
@@ -58,6 +60,24 @@ extern void schedule_resv_save(void);
 /* Queue saving of trigger state information */
 extern void schedule_trigger_save(void);
 
+/*
+ * Open a state file in StateSaveLocation as a read-only buffer. Returns a
+ * view of the mapping kept by state_file_prefetch() if the file is unchanged,
+ * otherwise maps the file.
+ * IN file - path of the state file
+ * RET buffer to free with FREE_NULL_BUFFER() or NULL if it can't be opened
+ */
+extern buf_t *state_file_open(const char *file);
+
+/*
+ * Map any new or changed state files and ask the kernel to read them ahead
+ * so that a backup slurmctld taking control does not read them cold.
+ */
+extern void state_file_prefetch(void);
+
+/* Release all state file mappings kept by state_file_prefetch() */
+extern void state_file_prefetch_fini(void);
+
 /* shutdown the slurmctld_state_save thread */
 extern void shutdown_state_save(void);
 
@@ -0,0 +1,358 @@
+/*****************************************************************************\
+ *  state_snapshot.c - published snapshots of slurmctld dump responses
+ *****************************************************************************
+ *  Copyright (C) SchedMD LLC.
+ *
+ *  This file is part of Slurm, a resource management program.
+ *  For details, see <https://slurm.schedmd.com/>.
+ *  Please also read the included file: DISCLAIMER.
+ *
+ *  Slurm is free software; you can redistribute it and/or modify it under
+ *  the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the License, or (at your option)
+ *  any later version.
+ *
+ *  In addition, as a special exception, the copyright holders give permission
+ *  to link the code of portions of this program with the OpenSSL library under
+ *  certain conditions as described in each individual source file, and
+ *  distribute linked combinations including the two. You must obey the GNU
+ *  General Public License in all respects for all of the code used other than
+ *  OpenSSL. If you modify file(s) with this exception, you may extend this
+ *  exception to your version of the file(s), but you are not obligated to do
+ *  so. If you do not wish to do so, delete this exception statement from your
+ *  version.  If you delete this exception statement from all source files in
+ *  the program, then also delete it here.
+ *
+ *  Slurm is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with Slurm; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA.
+\*****************************************************************************/
+
+#include <pthread.h>
+
+#include "src/common/list.h"
+#include "src/common/macros.h"
+#include "src/common/read_config.h"
+#include "src/common/xmalloc.h"
+#include "src/common/xstring.h"
+
+#include "src/slurmctld/slurmctld.h"
+#include "src/slurmctld/state_snapshot.h"
+
+#define SNAPSHOT_MAGIC 0x5a5a0e1d
+/* uid_class of views shared by all users allowed to see them */
+#define SNAPSHOT_SHARED_UID ((uid_t) NO_VAL)
+/* default state_snapshot_max_size in MB */
+#define DEFAULT_SNAPSHOT_MAX_SIZE 128
+
+struct snapshot {
+	int magic; /* SNAPSHOT_MAGIC */
+	snapshot_type_t type;
+	uint16_t show_flags;
+	uint16_t protocol_version;
+	uid_t uid_class; /* requesting uid or SNAPSHOT_SHARED_UID */
+	uint32_t filter_uid;
+	time_t last_update; /* last_*_update when packed */
+	time_t pack_time; /* when packed */
+	time_t last_used; /* protected by snapshot_mutex */
+	int refcnt; /* protected by snapshot_mutex */
+	char *data;
+	uint32_t size;
+};
+
+typedef struct {
+	snapshot_type_t type;
+	uint16_t show_flags;
+	uint16_t protocol_version;
+	uid_t uid_class;
+	uint32_t filter_uid;
+} snapshot_key_t;
+
+static bool snapshot_enabled = false;
+static uint64_t snapshot_max_size = 0;
+static pthread_mutex_t snapshot_mutex = PTHREAD_MUTEX_INITIALIZER;
+/* All published snapshots, protected by snapshot_mutex */
+static list_t *snapshot_list = NULL;
+static uint64_t snapshot_size = 0;
+
+static const char *_type_str(snapshot_type_t type)
+{
+	switch (type) {
+	case SNAPSHOT_JOBS:
+		return "jobs";
+	case SNAPSHOT_NODES:
+		return "nodes";
+	case SNAPSHOT_PARTS:
+		return "partitions";
+	case SNAPSHOT_TYPE_CNT:
+		break;
+	}
+
+	return "invalid";
+}
+
+/*
+ * Read the update time of the records in a snapshot type. This is done
+ * without any slurmctld locks, mirroring the "no change" tests done by the
+ * dump RPCs. A racing update can only make us miss the snapshot or serve the
+ * view from just before the update, as if the request had arrived earlier.
+ */
+static time_t _last_update(snapshot_type_t type)
+{
+	switch (type) {
+	case SNAPSHOT_JOBS:
+		return last_job_update;
+	case SNAPSHOT_NODES:
+		return last_node_update;
+	case SNAPSHOT_PARTS:
+		return last_part_update;
+	case SNAPSHOT_TYPE_CNT:
+		break;
+	}
+
+	fatal_abort("%s: invalid type %d", __func__, type);
+}
+
+/*
+ * Get the filter class of a request: views that are the same for any user
+ * allowed to see them are shared, all others are kept per requesting user.
+ */
+static uid_t _uid_class(snapshot_type_t type, uint16_t show_flags, uid_t uid)
+{
+	if (validate_operator(uid))
+		return SNAPSHOT_SHARED_UID;
+
+	if (!(show_flags & SHOW_ALL))
+		return uid;
+
+	if ((type == SNAPSHOT_JOBS) &&
+	    (slurm_conf.private_data & PRIVATE_DATA_JOBS))
+		return uid;
+
+	return SNAPSHOT_SHARED_UID;
+}
+
+static void _unref(snapshot_t *snap)
+{
+	xassert(snap->magic == SNAPSHOT_MAGIC);
+	xassert(snap->refcnt > 0);
+
+	if (--snap->refcnt)
+		return;
+
+	xfree(snap->data);
+	snap->magic = ~SNAPSHOT_MAGIC;
+	xfree(snap);
+}
+
+/* list_t destructor, drops the reference held by snapshot_list */
+static void _drop_snapshot(void *x)
+{
+	snapshot_t *snap = x;
+
+	snapshot_size -= snap->size;
+	_unref(snap);
+}
+
+static int _find_key(void *x, void *key)
+{
+	snapshot_t *snap = x;
+	snapshot_key_t *k = key;
+
+	return ((snap->type == k->type) &&
+		(snap->show_flags == k->show_flags) &&
+		(snap->protocol_version == k->protocol_version) &&
+		(snap->uid_class == k->uid_class) &&
+		(snap->filter_uid == k->filter_uid));
+}
+
+static int _find_lru(void *x, void *arg)
+{
+	snapshot_t *snap = x;
+	snapshot_t **lru = arg;
+
+	if (!*lru || (snap->last_used < (*lru)->last_used))
+		*lru = snap;
+
+	return SLURM_SUCCESS;
+}
+
+static void _evict(snapshot_t *keep)
+{
+	while (snapshot_size > snapshot_max_size) {
+		snapshot_t *lru = NULL;
+
+		list_for_each(snapshot_list, _find_lru, &lru);
+		if (!lru || (lru == keep))
+			break;
+
+		log_flag(PROTOCOL, "%s: evicting %s snapshot of %u bytes",
+			 __func__, _type_str(lru->type), lru->size);
+		list_delete_ptr(snapshot_list, lru);
+	}
+}
+
+extern void state_snapshot_init(void)
+{
+	char *tmp_ptr;
+	uint64_t max_size = DEFAULT_SNAPSHOT_MAX_SIZE;
+
+	if ((tmp_ptr = xstrcasestr(slurm_conf.slurmctld_params,
+				   "state_snapshot_max_size=")))
+		max_size = strtoull(tmp_ptr + 24, NULL, 10);
+
+	slurm_mutex_lock(&snapshot_mutex);
+	FREE_NULL_LIST(snapshot_list);
+	xassert(!snapshot_size);
+	snapshot_enabled = (xstrcasestr(slurm_conf.slurmctld_params,
+					"enable_state_snapshot") != NULL);
+	snapshot_max_size = max_size * 1024 * 1024;
+	if (snapshot_enabled)
+		snapshot_list = list_create(_drop_snapshot);
+	slurm_mutex_unlock(&snapshot_mutex);
+
+	if (snapshot_enabled)
+		debug("%s: publishing dump RPC state snapshots, state_snapshot_max_size=%"PRIu64"MB",
+		      __func__, max_size);
+}
+
+extern void state_snapshot_fini(void)
+{
+	slurm_mutex_lock(&snapshot_mutex);
+	snapshot_enabled = false;
+	FREE_NULL_LIST(snapshot_list);
+	slurm_mutex_unlock(&snapshot_mutex);
+}
+
+extern snapshot_t *state_snapshot_get(snapshot_type_t type,
+				      uint16_t show_flags, uid_t uid,
+				      uint32_t filter_uid,
+				      uint16_t protocol_version)
+{
+	snapshot_t *snap = NULL;
+	time_t last_update;
+	snapshot_key_t key = {
+		.type = type,
+		.show_flags = show_flags,
+		.protocol_version = protocol_version,
+		.filter_uid = filter_uid,
+	};
+
+	xassert(type < SNAPSHOT_TYPE_CNT);
+
+	if (!snapshot_enabled)
+		return NULL;
+
+	key.uid_class = _uid_class(type, show_flags, uid);
+	last_update = _last_update(type);
+
+	slurm_mutex_lock(&snapshot_mutex);
+	if (snapshot_list &&
+	    (snap = list_find_first(snapshot_list, _find_key, &key))) {
+		/*
+		 * Records changed within the second the snapshot was packed
+		 * can not be told apart from those already in it.
+		 */
+		if ((snap->last_update != last_update) ||
+		    (snap->last_update >= snap->pack_time)) {
+			snap = NULL;
+		} else {
+			snap->refcnt++;
+			snap->last_used = time(NULL);
+		}
+	}
+	slurm_mutex_unlock(&snapshot_mutex);
+
+	if (snap)
+		log_flag(PROTOCOL, "%s: serving %s snapshot packed at %ld for uid %u",
+			 __func__, _type_str(type), snap->pack_time, uid);
+
+	return snap;
+}
+
+extern snapshot_t *state_snapshot_publish(snapshot_type_t type,
+					  uint16_t show_flags, uid_t uid,
+					  uint32_t filter_uid,
+					  uint16_t protocol_version,
+					  time_t last_update, buf_t **buffer)
+{
+	snapshot_t *snap;
+	snapshot_key_t key = {
+		.type = type,
+		.show_flags = show_flags,
+		.protocol_version = protocol_version,
+		.filter_uid = filter_uid,
+	};
+
+	xassert(type < SNAPSHOT_TYPE_CNT);
+	xassert(buffer);
+
+	if (!snapshot_enabled || !*buffer ||
+	    (get_buf_offset((*buffer)) > snapshot_max_size))
+		return NULL;
+
+	key.uid_class = _uid_class(type, show_flags, uid);
+
+	snap = xmalloc(sizeof(*snap));
+	snap->magic = SNAPSHOT_MAGIC;
+	snap->type = type;
+	snap->show_flags = show_flags;
+	snap->protocol_version = protocol_version;
+	snap->uid_class = key.uid_class;
+	snap->filter_uid = filter_uid;
+	snap->last_update = last_update;
+	snap->pack_time = snap->last_used = time(NULL);
+	snap->size = get_buf_offset((*buffer));
+	snap->data = xfer_buf_data(*buffer);
+	/* one reference for snapshot_list and one for the caller */
+	snap->refcnt = 2;
+	*buffer = NULL;
+
+	slurm_mutex_lock(&snapshot_mutex);
+	if (!snapshot_list) {
+		/* raced with state_snapshot_fini() */
+		snap->refcnt--;
+	} else {
+		list_delete_first(snapshot_list, _find_key, &key);
+		list_append(snapshot_list, snap);
+		snapshot_size += snap->size;
+		_evict(snap);
+	}
+	slurm_mutex_unlock(&snapshot_mutex);
+
+	return snap;
+}
+
+extern void state_snapshot_release(snapshot_t *snap)
+{
+	if (!snap)
+		return;
+
+	slurm_mutex_lock(&snapshot_mutex);
+	_unref(snap);
+	slurm_mutex_unlock(&snapshot_mutex);
+}
+
+extern buf_t *state_snapshot_shadow_buf(snapshot_t *snap)
+{
+	buf_t *buffer;
+
+	xassert(snap->magic == SNAPSHOT_MAGIC);
+	xassert(snap->refcnt > 0);
+
+	buffer = create_shadow_buf(snap->data, snap->size);
+	set_buf_offset(buffer, snap->size);
+
+	return buffer;
+}
+
+extern time_t state_snapshot_last_update(snapshot_t *snap)
+{
+	xassert(snap->magic == SNAPSHOT_MAGIC);
+	return snap->last_update;
+}
@@ -0,0 +1,122 @@
+/*****************************************************************************\
+ *  state_snapshot.h - published snapshots of slurmctld dump responses
+ *****************************************************************************
+ *  Copyright (C) SchedMD LLC.
+ *
+ *  This file is part of Slurm, a resource management program.
+ *  For details, see <https://slurm.schedmd.com/>.
+ *  Please also read the included file: DISCLAIMER.
+ *
+ *  Slurm is free software; you can redistribute it and/or modify it under
+ *  the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the License, or (at your option)
+ *  any later version.
+ *
+ *  In addition, as a special exception, the copyright holders give permission
+ *  to link the code of portions of this program with the OpenSSL library under
+ *  certain conditions as described in each individual source file, and
+ *  distribute linked combinations including the two. You must obey the GNU
+ *  General Public License in all respects for all of the code used other than
+ *  OpenSSL. If you modify file(s) with this exception, you may extend this
+ *  exception to your version of the file(s), but you are not obligated to do
+ *  so. If you do not wish to do so, delete this exception statement from your
+ *  version.  If you delete this exception statement from all source files in
+ *  the program, then also delete it here.
+ *
+ *  Slurm is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with Slurm; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA.
+\*****************************************************************************/
+
+#ifndef _SLURMCTLD_STATE_SNAPSHOT_H
+#define _SLURMCTLD_STATE_SNAPSHOT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <sys/types.h>
+#include <time.h>
+
+#include "src/common/pack.h"
+
+/*
+ * A snapshot is an immutable, reference counted copy of a complete packed
+ * REQUEST_JOB_INFO, REQUEST_JOB_USER_INFO, REQUEST_NODE_INFO or
+ * REQUEST_PARTITION_INFO response. Once published it is never modified, so
+ * any number of RPC threads may send it concurrently, each through its own
+ * shadow buffer, without holding any slurmctld locks. A snapshot is only
+ * served while the matching last_*_update global has not moved since it was
+ * packed, which is exactly the test the SLURM_NO_CHANGE_IN_DATA logic already
+ * relies upon.
+ *
+ * Snapshots are kept per filter class. Views that do not depend on the
+ * requesting user (those of privileged users and, where PrivateData allows
+ * it, SHOW_ALL requests) are shared by everyone, all other views are kept per
+ * requesting user. The total size of all snapshots is bounded, evicting the
+ * least recently used ones first.
+ */
+
+typedef enum {
+	SNAPSHOT_JOBS,
+	SNAPSHOT_NODES,
+	SNAPSHOT_PARTS,
+	SNAPSHOT_TYPE_CNT
+} snapshot_type_t;
+
+typedef struct snapshot snapshot_t;
+
+/* Read SlurmctldParameters and drop any published snapshots */
+extern void state_snapshot_init(void);
+
+extern void state_snapshot_fini(void);
+
+/*
+ * Find a current snapshot which may be shown to uid.
+ * IN type - type of dump being requested
+ * IN show_flags - show_flags of the request
+ * IN uid - uid of user making the request
+ * IN filter_uid - only jobs of this user are packed if not NO_VAL
+ * IN protocol_version - protocol_version of the request
+ * RET snapshot reference (release with state_snapshot_release()) or NULL
+ */
+extern snapshot_t *state_snapshot_get(snapshot_type_t type,
+				      uint16_t show_flags, uid_t uid,
+				      uint32_t filter_uid,
+				      uint16_t protocol_version);
+
+/*
+ * Publish a freshly packed dump response.
+ * Must be called with the slurmctld locks used to pack the buffer still held.
+ * IN type - type of dump in buffer
+ * IN show_flags - show_flags buffer was packed with
+ * IN uid - uid buffer was packed for
+ * IN filter_uid - filter_uid buffer was packed with
+ * IN protocol_version - protocol_version buffer was packed with
+ * IN last_update - last_*_update value for type when buffer was packed
+ * IN/OUT buffer - on publication the packed data moves to the snapshot and
+ *	*buffer is set to NULL, otherwise it is left untouched
+ * RET snapshot reference (release with state_snapshot_release()) or NULL
+ */
+extern snapshot_t *state_snapshot_publish(snapshot_type_t type,
+					  uint16_t show_flags, uid_t uid,
+					  uint32_t filter_uid,
+					  uint16_t protocol_version,
+					  time_t last_update, buf_t **buffer);
+
+/* Release a reference returned by state_snapshot_get/publish(), NULL safe */
+extern void state_snapshot_release(snapshot_t *snap);
+
+/*
+ * Create a shadow buffer of the packed response held by snapshot.
+ * The buffer must be freed before the snapshot reference is released.
+ */
+extern buf_t *state_snapshot_shadow_buf(snapshot_t *snap);
+
+/* last_*_update value at the time the snapshot was packed */
+extern time_t state_snapshot_last_update(snapshot_t *snap);
+
+#endif
@@ -39,12 +39,34 @@
 #include <stdio.h>
 
 #include "src/slurmctld/agent.h"
+#include "src/slurmctld/proc_req.h"
 #include "src/slurmctld/slurmctld.h"
 #include "src/common/list.h"
 #include "src/common/pack.h"
 #include "src/common/xstring.h"
 #include "src/common/slurmdbd_defs.h"
 
+timer_phase_t sched_phase_stats[SCHED_PHASE_COUNT] = {
+	[SCHED_PHASE_BUILD_QUEUE] = { .name = "build_job_queue" },
+	[SCHED_PHASE_SELECT_NODES] = { .name = "select_nodes" },
+	[SCHED_PHASE_ACCT_PRE_SELECT] = { .name = "acct_policy_pre_select" },
+	[SCHED_PHASE_ACCT_POST_SELECT] = { .name = "acct_policy_post_select" },
+	[SCHED_PHASE_BF_BUILD_QUEUE] = { .name = "bf_build_job_queue" },
+	[SCHED_PHASE_BF_TEST] = { .name = "bf_test_job" },
+	[SCHED_PHASE_GRES_SELECT] = { .name = "gres_select_filter" },
+};
+
+/*
+ * Ring of statistics history samples. history_raw holds the counter values
+ * seen by the previous sample, which the next sample subtracts.
+ */
+static pthread_mutex_t history_mutex = PTHREAD_MUTEX_INITIALIZER;
+static stats_history_t history[STATS_HISTORY_CNT];
+static uint32_t history_next = 0;
+static uint32_t history_used = 0;
+static stats_history_t history_raw;
+static time_t history_raw_time = 0;
+
 /* Pack all scheduling statistics */
 extern buf_t *pack_all_stat(uint16_t protocol_version)
 {
@@ -185,6 +207,82 @@ extern buf_t *pack_all_stat(uint16_t protocol_version)
 	return buffer;
 }
 
+extern void pack_sched_phase_stats(buf_t *buffer, uint16_t protocol_version)
+{
+	timer_phase_t phases[SCHED_PHASE_COUNT];
+	char *name[SCHED_PHASE_COUNT];
+	uint64_t count[SCHED_PHASE_COUNT], run_time[SCHED_PHASE_COUNT];
+	uint64_t max[SCHED_PHASE_COUNT];
+	uint32_t hist[SCHED_PHASE_COUNT * TIMER_PHASE_HIST_CNT];
+
+	timer_phase_copy(sched_phase_stats, SCHED_PHASE_COUNT, phases);
+	for (int i = 0; i < SCHED_PHASE_COUNT; i++) {
+		name[i] = (char *) phases[i].name;
+		count[i] = phases[i].count;
+		run_time[i] = phases[i].time;
+		max[i] = phases[i].max;
+		memcpy(&hist[i * TIMER_PHASE_HIST_CNT], phases[i].hist,
+		       sizeof(phases[i].hist));
+	}
+
+	if (protocol_version >= SLURM_24_11_PROTOCOL_VERSION) {
+		pack32(TIMER_PHASE_HIST_CNT, buffer);
+		packstr_array(name, SCHED_PHASE_COUNT, buffer);
+		pack64_array(count, SCHED_PHASE_COUNT, buffer);
+		pack64_array(run_time, SCHED_PHASE_COUNT, buffer);
+		pack64_array(max, SCHED_PHASE_COUNT, buffer);
+		pack32_array(hist, (SCHED_PHASE_COUNT * TIMER_PHASE_HIST_CNT),
+			     buffer);
+	}
+}
+
+static void _pack_stats_history(stats_history_t *hist, buf_t *buffer)
+{
+	pack_time(hist->sample_time, buffer);
+	pack32(hist->schedule_cycles, buffer);
+	pack64(hist->schedule_cycle_sum, buffer);
+	pack32(hist->schedule_cycle_last, buffer);
+	pack32(hist->schedule_depth_sum, buffer);
+	pack32(hist->schedule_queue_len, buffer);
+	pack32(hist->bf_cycles, buffer);
+	pack64(hist->bf_cycle_sum, buffer);
+	pack32(hist->bf_cycle_last, buffer);
+	pack32(hist->bf_depth_sum, buffer);
+	pack32(hist->bf_backfilled_jobs, buffer);
+	pack32(hist->jobs_submitted, buffer);
+	pack32(hist->jobs_started, buffer);
+	pack32(hist->jobs_completed, buffer);
+	pack32(hist->jobs_canceled, buffer);
+	pack32(hist->jobs_failed, buffer);
+	pack32(hist->jobs_pending, buffer);
+	pack32(hist->jobs_running, buffer);
+	pack64(hist->rpc_count, buffer);
+	pack64(hist->rpc_time, buffer);
+	pack32(hist->server_thread_count, buffer);
+	pack32(hist->agent_queue_size, buffer);
+}
+
+extern void pack_stats_history(buf_t *buffer, bool all,
+			       uint16_t protocol_version)
+{
+	uint32_t cnt, first;
+
+	if (protocol_version < SLURM_24_11_PROTOCOL_VERSION)
+		return;
+
+	slurm_mutex_lock(&history_mutex);
+	cnt = all ? history_used : 0;
+	first = (history_next + STATS_HISTORY_CNT - history_used) %
+		STATS_HISTORY_CNT;
+
+	pack32(STATS_HISTORY_INTERVAL, buffer);
+	pack32(cnt, buffer);
+	for (int i = 0; i < cnt; i++)
+		_pack_stats_history(&history[(first + i) % STATS_HISTORY_CNT],
+				    buffer);
+	slurm_mutex_unlock(&history_mutex);
+}
+
 /* Reset all scheduling statistics
  * level IN - clear backfilled_jobs count if set */
 extern void reset_stats(int level)
@@ -225,5 +323,75 @@ extern void reset_stats(int level)
 	memset(slurmctld_diag_stats.bf_exit, 0,
 	       sizeof(slurmctld_diag_stats.bf_exit));
 
+	timer_phase_reset(sched_phase_stats, SCHED_PHASE_COUNT);
+
 	last_proc_req_start = time(NULL);
 }
+
+/* Counters are cleared by reset_stats(), so restart from 0 when they drop */
+#define HISTORY_DELTA(field)						\
+	sample.field = (raw.field >= history_raw.field) ?		\
+		       (raw.field - history_raw.field) : raw.field
+
+extern void stats_history_sample(time_t now)
+{
+	stats_history_t raw = { 0 }, sample = { 0 };
+
+	if (history_raw_time &&
+	    (difftime(now, history_raw_time) < STATS_HISTORY_INTERVAL))
+		return;
+
+	raw.schedule_cycles = slurmctld_diag_stats.schedule_cycle_counter;
+	raw.schedule_cycle_sum = slurmctld_diag_stats.schedule_cycle_sum;
+	raw.schedule_depth_sum = slurmctld_diag_stats.schedule_cycle_depth;
+	raw.bf_cycles = slurmctld_diag_stats.bf_cycle_counter;
+	raw.bf_cycle_sum = slurmctld_diag_stats.bf_cycle_sum;
+	raw.bf_depth_sum = slurmctld_diag_stats.bf_depth_sum;
+	raw.bf_backfilled_jobs = slurmctld_diag_stats.backfilled_jobs;
+	raw.jobs_submitted = slurmctld_diag_stats.jobs_submitted;
+	raw.jobs_started = slurmctld_diag_stats.jobs_started;
+	raw.jobs_completed = slurmctld_diag_stats.jobs_completed;
+	raw.jobs_canceled = slurmctld_diag_stats.jobs_canceled;
+	raw.jobs_failed = slurmctld_diag_stats.jobs_failed;
+	get_rpc_stats_totals(&raw.rpc_count, &raw.rpc_time);
+
+	slurm_mutex_lock(&history_mutex);
+	if (history_raw_time) {
+		sample.sample_time = now;
+		HISTORY_DELTA(schedule_cycles);
+		HISTORY_DELTA(schedule_cycle_sum);
+		HISTORY_DELTA(schedule_depth_sum);
+		HISTORY_DELTA(bf_cycles);
+		HISTORY_DELTA(bf_cycle_sum);
+		HISTORY_DELTA(bf_depth_sum);
+		HISTORY_DELTA(bf_backfilled_jobs);
+		HISTORY_DELTA(jobs_submitted);
+		HISTORY_DELTA(jobs_started);
+		HISTORY_DELTA(jobs_completed);
+		HISTORY_DELTA(jobs_canceled);
+		HISTORY_DELTA(jobs_failed);
+		HISTORY_DELTA(rpc_count);
+		HISTORY_DELTA(rpc_time);
+
+		sample.schedule_cycle_last =
+			slurmctld_diag_stats.schedule_cycle_last;
+		sample.schedule_queue_len =
+			slurmctld_diag_stats.schedule_queue_len;
+		sample.bf_cycle_last = slurmctld_diag_stats.bf_cycle_last;
+		sample.jobs_pending = slurmctld_diag_stats.jobs_pending;
+		sample.jobs_running = slurmctld_diag_stats.jobs_running;
+		slurm_mutex_lock(&slurmctld_config.thread_count_lock);
+		sample.server_thread_count =
+			slurmctld_config.server_thread_count;
+		slurm_mutex_unlock(&slurmctld_config.thread_count_lock);
+		sample.agent_queue_size = retry_list_size();
+
+		history[history_next] = sample;
+		history_next = (history_next + 1) % STATS_HISTORY_CNT;
+		if (history_used < STATS_HISTORY_CNT)
+			history_used++;
+	}
+	history_raw = raw;
+	history_raw_time = now;
+	slurm_mutex_unlock(&history_mutex);
+}
@@ -124,6 +124,21 @@ typedef struct trig_mgr_info {
 	time_t   orig_time;	/* offset (pending) or time stamp (complete) */
 } trig_mgr_info_t;
 
+/*
+ * Node event state computed once per trigger_process() pass and shared by
+ * all node triggers, rather than rescanned for each trigger.
+ */
+typedef struct {
+	bool down;		/* trigger_down_nodes_bitmap has bits set */
+	bool drained;		/* trigger_drained_nodes_bitmap has bits set */
+	bool draining;		/* trigger_draining_nodes_bitmap has bits set */
+	bool fail;		/* trigger_fail_nodes_bitmap has bits set */
+	bool resume;		/* trigger_resume_nodes_bitmap has bits set */
+	bool up;		/* trigger_up_nodes_bitmap has bits set */
+	bitstr_t *idle_bitmap;	/* nodes idle since idle_min */
+	time_t idle_min;	/* last_busy cutoff used for idle_bitmap */
+} trig_node_pass_t;
+
 static void _trig_del(void *x)
 {
 	trig_mgr_info_t *tmp = x;
@@ -847,7 +862,7 @@ extern int trigger_state_save(void)
 	xstrcat(new_file, "/trigger_state.new");
 	unlock_slurmctld(config_read_lock);
 
-	lock_state_files();
+	lock_state_file(STATE_FILE_TRIGGER);
 	log_fd = creat(new_file, 0600);
 	if (log_fd < 0) {
 		error("Can't save state, create file %s error %m",
@@ -890,7 +905,7 @@ extern int trigger_state_save(void)
 	xfree(old_file);
 	xfree(reg_file);
 	xfree(new_file);
-	unlock_state_files();
+	unlock_state_file(STATE_FILE_TRIGGER);
 	FREE_NULL_BUFFER(buffer);
 	return error_code;
 }
@@ -905,7 +920,7 @@ static buf_t *_open_trigger_state_file(char **state_file)
 
 	*state_file = xstrdup(slurm_conf.state_save_location);
 	xstrcat(*state_file, "/trigger_state");
-	if (!(buf = create_mmap_buf(*state_file)))
+	if (!(buf = state_file_open(*state_file)))
 		error("Could not open trigger state file %s: %m",
 		      *state_file);
 	else
@@ -913,7 +928,7 @@ static buf_t *_open_trigger_state_file(char **state_file)
 
 	error("NOTE: Trying backup state save file. Triggers may be lost!");
 	xstrcat(*state_file, ".old");
-	return create_mmap_buf(*state_file);;
+	return state_file_open(*state_file);;
 }
 
 extern void trigger_state_restore(void)
@@ -928,15 +943,15 @@ extern void trigger_state_restore(void)
 	/* read the file */
 	xassert(verify_lock(CONF_LOCK, READ_LOCK));
 
-	lock_state_files();
+	lock_state_file(STATE_FILE_TRIGGER);
 	if (!(buffer = _open_trigger_state_file(&state_file))) {
 		info("No trigger state file (%s) to recover", state_file);
 		xfree(state_file);
-		unlock_state_files();
+		unlock_state_file(STATE_FILE_TRIGGER);
 		return;
 	}
 	xfree(state_file);
-	unlock_state_files();
+	unlock_state_file(STATE_FILE_TRIGGER);
 
 	safe_unpackstr(&ver_str, buffer);
 	if (ver_str && !xstrcmp(ver_str, TRIGGER_STATE_VERSION))
@@ -1139,13 +1154,18 @@ static void _trigger_other_event(trig_mgr_info_t *trig_in, time_t now)
 	}
 }
 
-static void _trigger_node_event(trig_mgr_info_t *trig_in, time_t now)
+static bool _event_bitmap_set(bitstr_t *event_bitmap)
+{
+	return (event_bitmap && (bit_ffs(event_bitmap) != -1));
+}
+
+static void _trigger_node_event(trig_mgr_info_t *trig_in, time_t now,
+				trig_node_pass_t *pass)
 {
 	xassert(verify_lock(NODE_LOCK, READ_LOCK));
 
 	if ((trig_in->trig_type & TRIGGER_TYPE_DOWN) &&
-	    trigger_down_nodes_bitmap                &&
-	    (bit_ffs(trigger_down_nodes_bitmap) != -1)) {
+	    pass->down) {
 		if (trig_in->nodes_bitmap == NULL) {	/* all nodes */
 			xfree(trig_in->res_id);
 			trig_in->res_id = bitmap2node_name(
@@ -1170,8 +1190,7 @@ static void _trigger_node_event(trig_mgr_info_t *trig_in, time_t now)
 	}
 
 	if ((trig_in->trig_type & TRIGGER_TYPE_DRAINED) &&
-	    trigger_drained_nodes_bitmap                &&
-	    (bit_ffs(trigger_drained_nodes_bitmap) != -1)) {
+	    pass->drained) {
 		if (trig_in->nodes_bitmap == NULL) {	/* all nodes */
 			xfree(trig_in->res_id);
 			trig_in->res_id = bitmap2node_name(
@@ -1196,8 +1215,7 @@ static void _trigger_node_event(trig_mgr_info_t *trig_in, time_t now)
 	}
 
 	if ((trig_in->trig_type & TRIGGER_TYPE_FAIL) &&
-	    trigger_fail_nodes_bitmap                &&
-	    (bit_ffs(trigger_fail_nodes_bitmap) != -1)) {
+	    pass->fail) {
 		if (trig_in->nodes_bitmap == NULL) {	/* all nodes */
 			xfree(trig_in->res_id);
 			trig_in->res_id = bitmap2node_name(
@@ -1229,13 +1247,22 @@ static void _trigger_node_event(trig_mgr_info_t *trig_in, time_t now)
 		node_record_t *node_ptr;
 		bitstr_t *trigger_idle_node_bitmap;
 
-		trigger_idle_node_bitmap = bit_alloc(node_record_count);
-		for (i = 0; (node_ptr = next_node(&i)); i++) {
-			if (!IS_NODE_IDLE(node_ptr) ||
-			    (node_ptr->last_busy > min_idle))
-				continue;
-			bit_set(trigger_idle_node_bitmap, node_ptr->index);
+		/* Triggers with the same offset share the idle node scan */
+		if (!pass->idle_bitmap || (pass->idle_min != min_idle)) {
+			if (!pass->idle_bitmap)
+				pass->idle_bitmap =
+					bit_alloc(node_record_count);
+			else
+				bit_clear_all(pass->idle_bitmap);
+			for (i = 0; (node_ptr = next_node(&i)); i++) {
+				if (!IS_NODE_IDLE(node_ptr) ||
+				    (node_ptr->last_busy > min_idle))
+					continue;
+				bit_set(pass->idle_bitmap, node_ptr->index);
+			}
+			pass->idle_min = min_idle;
 		}
+		trigger_idle_node_bitmap = pass->idle_bitmap;
 		if (trig_in->nodes_bitmap == NULL) {    /* all nodes */
 			xfree(trig_in->res_id);
 			trig_in->res_id = bitmap2node_name(
@@ -1250,7 +1277,6 @@ static void _trigger_node_event(trig_mgr_info_t *trig_in, time_t now)
 					  trig_in->nodes_bitmap);
 			trig_in->state = 1;
 		}
-		FREE_NULL_BITMAP(trigger_idle_node_bitmap);
 		if (trig_in->state == 1) {
 			trig_in->trig_time = now;
 			log_flag(TRIGGERS, "trigger[%u] for node %s idle",
@@ -1260,8 +1286,7 @@ static void _trigger_node_event(trig_mgr_info_t *trig_in, time_t now)
 	}
 
 	if ((trig_in->trig_type & TRIGGER_TYPE_UP) &&
-	    trigger_up_nodes_bitmap                &&
-	    (bit_ffs(trigger_up_nodes_bitmap) != -1)) {
+	    pass->up) {
 		if (trig_in->nodes_bitmap == NULL) {	/* all nodes */
 			xfree(trig_in->res_id);
 			trig_in->res_id = bitmap2node_name(
@@ -1286,8 +1311,7 @@ static void _trigger_node_event(trig_mgr_info_t *trig_in, time_t now)
 	}
 
 	if ((trig_in->trig_type & TRIGGER_TYPE_DRAINING) &&
-	    trigger_draining_nodes_bitmap &&
-	    (bit_ffs(trigger_draining_nodes_bitmap) != -1)) {
+	    pass->draining) {
 		if (!trig_in->nodes_bitmap) { /* all nodes */
 			xfree(trig_in->res_id);
 			trig_in->res_id =
@@ -1312,8 +1336,7 @@ static void _trigger_node_event(trig_mgr_info_t *trig_in, time_t now)
 	}
 
 	if ((trig_in->trig_type & TRIGGER_TYPE_RESUME) &&
-	    trigger_resume_nodes_bitmap &&
-	    (bit_ffs(trigger_resume_nodes_bitmap) != -1)) {
+	    pass->resume) {
 		if (!trig_in->nodes_bitmap) { /* all nodes */
 			xfree(trig_in->res_id);
 			trig_in->res_id =
@@ -1612,11 +1635,19 @@ extern void trigger_process(void)
 	bool state_change = false;
 	pid_t rc;
 	int prog_stat;
+	trig_node_pass_t node_pass = { 0 };
 
 	slurm_mutex_lock(&trigger_mutex);
 	if (trigger_list == NULL)
 		trigger_list = list_create(_trig_del);
 
+	node_pass.down = _event_bitmap_set(trigger_down_nodes_bitmap);
+	node_pass.drained = _event_bitmap_set(trigger_drained_nodes_bitmap);
+	node_pass.draining = _event_bitmap_set(trigger_draining_nodes_bitmap);
+	node_pass.fail = _event_bitmap_set(trigger_fail_nodes_bitmap);
+	node_pass.resume = _event_bitmap_set(trigger_resume_nodes_bitmap);
+	node_pass.up = _event_bitmap_set(trigger_up_nodes_bitmap);
+
 	trig_iter = list_iterator_create(trigger_list);
 	while ((trig_in = list_next(trig_iter))) {
 		if (trig_in->state == 0) {
@@ -1625,7 +1656,7 @@ extern void trigger_process(void)
 			else if (trig_in->res_type == TRIGGER_RES_TYPE_JOB)
 				_trigger_job_event(trig_in, now);
 			else if (trig_in->res_type == TRIGGER_RES_TYPE_NODE)
-				_trigger_node_event(trig_in, now);
+				_trigger_node_event(trig_in, now, &node_pass);
 			else if (trig_in->res_type ==
 				 TRIGGER_RES_TYPE_SLURMCTLD)
 				_trigger_slurmctld_event(trig_in, now);
@@ -1697,6 +1728,7 @@ extern void trigger_process(void)
 		}
 	}
 	list_iterator_destroy(trig_iter);
+	FREE_NULL_BITMAP(node_pass.idle_bitmap);
 	_clear_event_triggers();
 	slurm_mutex_unlock(&trigger_mutex);
 	if (state_change)
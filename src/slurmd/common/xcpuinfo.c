@@ -229,6 +229,55 @@ static void _remove_ecores(hwloc_topology_t *topology)
 #endif
 }
 
+/*
+ * Build this process's topology from the whole system topology slurmd already
+ * discovered, restricted to the CPUs this process is allowed to use, instead
+ * of discovering the hardware again.
+ */
+static int _load_restricted_whole(hwloc_topology_t *topology)
+{
+	char *whole_file = xstrdup_printf("%s/hwloc_topo_whole.xml",
+					  conf->spooldir);
+	hwloc_bitmap_t cpuset = NULL;
+	int rc = SLURM_ERROR;
+
+	if (hwloc_topology_init(topology)) {
+		xfree(whole_file);
+		return SLURM_ERROR;
+	}
+
+	/* Allow binding queries on the topology loaded from XML */
+	hwloc_topology_set_flags(*topology, HWLOC_TOPOLOGY_FLAG_IS_THISSYSTEM);
+
+	if (hwloc_topology_set_xml(*topology, whole_file) ||
+	    hwloc_topology_load(*topology)) {
+		debug2("%s: unable to load %s", __func__, whole_file);
+		goto end_it;
+	}
+
+	cpuset = hwloc_bitmap_alloc();
+	if (hwloc_get_cpubind(*topology, cpuset, HWLOC_CPUBIND_PROCESS)) {
+		debug2("%s: hwloc_get_cpubind() failed", __func__);
+		goto end_it;
+	}
+	if (hwloc_topology_restrict(*topology, cpuset, 0)) {
+		debug2("%s: hwloc_topology_restrict() failed", __func__);
+		goto end_it;
+	}
+
+	debug2("%s: topology restricted from %s", __func__, whole_file);
+	rc = SLURM_SUCCESS;
+
+end_it:
+	if (cpuset)
+		hwloc_bitmap_free(cpuset);
+	if (rc != SLURM_SUCCESS)
+		hwloc_topology_destroy(*topology);
+	xfree(whole_file);
+
+	return rc;
+}
+
 /* read or load topology and write if needed
  * init and destroy topology must be outside this function */
 extern int xcpuinfo_hwloc_topo_load(
@@ -245,6 +294,14 @@ extern int xcpuinfo_hwloc_topo_load(
 
 	if (!topology_in) {
 		topology = &tmp_topo;
+		if (!conf->def_config &&
+		    (_load_restricted_whole(topology) == SLURM_SUCCESS)) {
+			if (_internal_hwloc_topology_export_xml(*topology,
+								topo_file))
+				error("%s: failed to export %s",
+				      __func__, topo_file);
+			goto end_it;
+		}
 		goto handle_write;
 	}
 
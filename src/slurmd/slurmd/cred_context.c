@@ -33,8 +33,11 @@
  *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA.
 \*****************************************************************************/
 
+#include <stddef.h>
+
 #include "src/common/pack.h"
 #include "src/common/slurm_protocol_pack.h"
+#include "src/common/xhash.h"
 #include "src/common/xmalloc.h"
 #include "src/common/xstring.h"
 
@@ -47,10 +50,14 @@
 
 typedef struct {
 	time_t ctime;		/* Time that the cred was created	*/
-	time_t expiration;	/* Time at which cred is no longer good	*/
 	slurm_step_id_t step_id;/* Slurm step id for this credential	*/
+	time_t expiration;	/* Time at which cred is no longer good	*/
 } cred_state_t;
 
+/* ctime and step_id identify a credential, and have no padding between them */
+#define CRED_STATE_KEY_LEN \
+	(offsetof(cred_state_t, step_id) + sizeof(slurm_step_id_t))
+
 typedef struct {
 	time_t ctime;		/* Time that this entry was created         */
 	time_t expiration;	/* Time at which credentials can be purged  */
@@ -61,6 +68,10 @@ typedef struct {
 static pthread_mutex_t cred_cache_mutex = PTHREAD_MUTEX_INITIALIZER;
 static list_t *cred_job_list = NULL;
 static list_t *cred_state_list = NULL;
+static xhash_t *cred_job_hash = NULL;	/* cred_job_list by jobid */
+static xhash_t *cred_state_hash = NULL;	/* cred_state_list by ctime/step_id */
+static time_t last_job_state_clear = 0;
+static time_t last_cred_state_clear = 0;
 
 static void _drain_node(char *reason)
 {
@@ -85,7 +96,22 @@ static cred_state_t *_cred_state_create(slurm_cred_t *cred)
 	return s;
 }
 
-static job_state_t *_job_state_create(uint32_t jobid)
+static void _job_state_id(void *item, const char **key, uint32_t *key_len)
+{
+	job_state_t *j = item;
+
+	*key = (const char *) &j->jobid;
+	*key_len = sizeof(j->jobid);
+}
+
+static void _cred_state_id(void *item, const char **key, uint32_t *key_len)
+{
+	*key = item;
+	*key_len = CRED_STATE_KEY_LEN;
+}
+
+/* Create a job state and add it to cred_job_list */
+static job_state_t *_add_job_state(uint32_t jobid)
 {
 	job_state_t *j = xmalloc(sizeof(*j));
 
@@ -94,6 +120,9 @@ static job_state_t *_job_state_create(uint32_t jobid)
 	j->ctime = time(NULL);
 	j->expiration = (time_t) MAX_TIME;
 
+	list_append(cred_job_list, j);
+	xhash_add(cred_job_hash, j);
+
 	return j;
 }
 
@@ -102,29 +131,31 @@ static int _list_find_expired_job_state(void *x, void *key)
 	job_state_t *j = x;
 	time_t curr_time = *(time_t *) key;
 
-	if (j->revoked && (curr_time > j->expiration))
-		return 1;
-	return 0;
-}
-
-static int _list_find_job_state(void *x, void *key)
-{
-	job_state_t *j = x;
-	uint32_t jobid = *(uint32_t *) key;
-
-	if (j->jobid == jobid)
+	if (j->revoked && (curr_time > j->expiration)) {
+		xhash_pop(cred_job_hash, (const char *) &j->jobid,
+			  sizeof(j->jobid));
 		return 1;
+	}
 	return 0;
 }
 
 static job_state_t *_find_job_state(uint32_t jobid)
 {
-	return list_find_first(cred_job_list, _list_find_job_state, &jobid);
+	return xhash_get(cred_job_hash, (const char *) &jobid, sizeof(jobid));
 }
 
+/*
+ * Expiration times have a one second resolution, so the lists only need to be
+ * scanned for expired entries once per second.
+ */
 static void _clear_expired_job_states(void)
 {
 	time_t now = time(NULL);
+
+	if (now == last_job_state_clear)
+		return;
+	last_job_state_clear = now;
+
 	list_delete_all(cred_job_list, _list_find_expired_job_state, &now);
 }
 
@@ -133,17 +164,37 @@ static int _list_find_expired_cred_state(void *x, void *key)
 	cred_state_t *s = x;
 	time_t curr_time = *(time_t *) key;
 
-	if (curr_time > s->expiration)
+	if (curr_time > s->expiration) {
+		xhash_pop(cred_state_hash, (const char *) s,
+			  CRED_STATE_KEY_LEN);
 		return 1;
+	}
 	return 0;
 }
 
 static void _clear_expired_credential_states(void)
 {
 	time_t now = time(NULL);
+
+	if (now == last_cred_state_clear)
+		return;
+	last_cred_state_clear = now;
+
 	list_delete_all(cred_state_list, _list_find_expired_cred_state, &now);
 }
 
+static int _hash_job_state(void *x, void *arg)
+{
+	xhash_add(cred_job_hash, x);
+	return SLURM_SUCCESS;
+}
+
+static int _hash_cred_state(void *x, void *arg)
+{
+	xhash_add(cred_state_hash, x);
+	return SLURM_SUCCESS;
+}
+
 static void _job_state_pack(void *x, uint16_t protocol_version, buf_t *buffer)
 {
 	job_state_t *j = x;
@@ -230,17 +281,25 @@ static void _cred_context_unpack(buf_t *buffer)
 	slurm_mutex_lock(&cred_cache_mutex);
 
 	FREE_NULL_LIST(cred_job_list);
+	xhash_clear(cred_job_hash);
 	if (slurm_unpack_list(&cred_job_list, _job_state_unpack,
 			      xfree_ptr, buffer, version)) {
 		warning("%s: failed to restore job state from file", __func__);
 	}
+	if (cred_job_list)
+		(void) list_for_each(cred_job_list, _hash_job_state, NULL);
+	last_job_state_clear = 0;
 	_clear_expired_job_states();
 
 	FREE_NULL_LIST(cred_state_list);
+	xhash_clear(cred_state_hash);
 	if (slurm_unpack_list(&cred_state_list, _cred_state_unpack,
 			      xfree_ptr, buffer, version)) {
 		warning("%s: failed to restore job state from file", __func__);
 	}
+	if (cred_state_list)
+		(void) list_for_each(cred_state_list, _hash_cred_state, NULL);
+	last_cred_state_clear = 0;
 	_clear_expired_credential_states();
 
 	slurm_mutex_unlock(&cred_cache_mutex);
@@ -310,6 +369,9 @@ cleanup:
 
 extern void cred_state_init(void)
 {
+	cred_job_hash = xhash_init(_job_state_id, NULL);
+	cred_state_hash = xhash_init(_cred_state_id, NULL);
+
 	if (!conf->cleanstart)
 		_restore_cred_state();
 
@@ -322,6 +384,8 @@ extern void cred_state_init(void)
 extern void cred_state_fini(void)
 {
 	save_cred_state();
+	xhash_free(cred_job_hash);
+	xhash_free(cred_state_hash);
 	FREE_NULL_LIST(cred_job_list);
 	FREE_NULL_LIST(cred_state_list);
 }
@@ -346,8 +410,7 @@ extern int cred_insert_jobid(uint32_t jobid)
 		debug2("%s: we already have a job state for job %u.",
 		       __func__, jobid);
 	} else {
-		job_state_t *j = _job_state_create(jobid);
-		list_append(cred_job_list, j);
+		(void) _add_job_state(jobid);
 	}
 	slurm_mutex_unlock(&cred_cache_mutex);
 
@@ -368,8 +431,7 @@ extern int cred_revoke(uint32_t jobid, time_t time, time_t start_time)
 		 * Insert a job state object so that we can revoke any future
 		 * credentials.
 		 */
-		j = _job_state_create(jobid);
-		list_append(cred_job_list, j);
+		j = _add_job_state(jobid);
 	}
 	if (j->revoked) {
 		if (start_time && (j->revoked < start_time)) {
@@ -451,6 +513,8 @@ extern void cred_handle_reissue(slurm_cred_t *cred, bool locked)
 		 * old record so that "cred" will look like a new
 		 * credential to any ensuing commands. */
 		info("reissued job credential for job %u", j->jobid);
+		xhash_pop(cred_job_hash, (const char *) &j->jobid,
+			  sizeof(j->jobid));
 		list_delete_ptr(cred_job_list, j);
 	}
 
@@ -463,8 +527,7 @@ static bool _credential_revoked(slurm_cred_t *cred)
 	job_state_t *j = NULL;
 
 	if (!(j = _find_job_state(cred->arg->step_id.job_id))) {
-		j = _job_state_create(cred->arg->step_id.job_id);
-		list_append(cred_job_list, j);
+		(void) _add_job_state(cred->arg->step_id.job_id);
 		return false;
 	}
 
@@ -477,23 +540,14 @@ static bool _credential_revoked(slurm_cred_t *cred)
 	return false;
 }
 
-static int _list_find_cred_state(void *x, void *key)
-{
-	cred_state_t *s = x;
-	slurm_cred_t *cred = key;
-
-	if (!memcmp(&s->step_id, &cred->arg->step_id, sizeof(s->step_id)) &&
-	    (s->ctime == cred->ctime))
-		return 1;
-
-	return 0;
-}
-
 static bool _credential_replayed(slurm_cred_t *cred)
 {
-	cred_state_t *s = NULL;
+	cred_state_t *s = NULL, key;
 
-	s = list_find_first(cred_state_list, _list_find_cred_state, cred);
+	memset(&key, 0, sizeof(key));
+	key.ctime = cred->ctime;
+	memcpy(&key.step_id, &cred->arg->step_id, sizeof(key.step_id));
+	s = xhash_get(cred_state_hash, (const char *) &key, CRED_STATE_KEY_LEN);
 
 	/*
 	 * If we found a match, this credential is being replayed.
@@ -506,6 +560,7 @@ static bool _credential_replayed(slurm_cred_t *cred)
 	 */
 	s = _cred_state_create(cred);
 	list_append(cred_state_list, s);
+	xhash_add(cred_state_hash, s);
 
 	return false;
 }
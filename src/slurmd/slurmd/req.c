@@ -261,6 +261,23 @@ static list_t *bcast_libdir_list = NULL;
 
 static pthread_mutex_t waiter_mutex = PTHREAD_MUTEX_INITIALIZER;
 
+/*
+ * Idle slurmstepd processes which have already received the node
+ * configuration and loaded their plugins, see LaunchParameters=stepd_pool.
+ */
+typedef struct {
+	int to_stepd;
+	int to_slurmd;
+} stepd_pool_t;
+
+#define STEPD_POOL_MAX 64
+static pthread_mutex_t stepd_pool_mutex = PTHREAD_MUTEX_INITIALIZER;
+static stepd_pool_t stepd_pool[STEPD_POOL_MAX];
+static int stepd_pool_cnt = 0;		/* idle slurmstepds in stepd_pool */
+static bool stepd_pool_enabled = false;
+static bool stepd_pool_filling = false;	/* _stepd_pool_fill_thread() runs */
+static uint32_t stepd_pool_gen = 0;	/* incremented when pool is cleared */
+
 static int _stepmgr_connect(slurm_step_id_t *step_id,
 			    uint16_t *protocol_version)
 {
@@ -626,6 +643,36 @@ rwfail:
 	return (-1);
 }
 
+/*
+ * Send the node configuration to a new slurmstepd. This is the part of the
+ * initialization data which does not depend on the step, so a pooled
+ * slurmstepd can receive it ahead of time, load its plugins and then wait for
+ * the rest of the initialization data from _send_slurmstepd_init().
+ */
+static int _send_slurmstepd_conf(int fd, int pooled)
+{
+	/* send conf over to slurmstepd */
+	if (send_slurmd_conf_lite(fd, conf)) {
+		error("%s: send_slurmd_conf_lite(%d) failed: %m", __func__, fd);
+		return SLURM_ERROR;
+	}
+
+	/* send conf_hashtbl */
+	if (read_conf_send_stepd(fd)) {
+		error("%s: read_conf_send_stepd(%d) failed: %m", __func__, fd);
+		return SLURM_ERROR;
+	}
+
+	/* tell slurmstepd whether to wait in the pool */
+	safe_write(fd, &pooled, sizeof(int));
+
+	return SLURM_SUCCESS;
+
+rwfail:
+	error("%s: failed: %m", __func__);
+	return SLURM_ERROR;
+}
+
 static int
 _send_slurmstepd_init(int fd, int type, void *req, slurm_addr_t *cli,
 		      hostlist_t *step_hset, uint16_t protocol_version)
@@ -640,18 +687,6 @@ _send_slurmstepd_init(int fd, int type, void *req, slurm_addr_t *cli,
 
 	slurm_msg_t_init(&msg);
 
-	/* send conf over to slurmstepd */
-	if (send_slurmd_conf_lite(fd, conf)) {
-		error("%s: send_slurmd_conf_lite(%d) failed: %m", __func__, fd);
-		goto fail;
-	}
-
-	/* send conf_hashtbl */
-	if (read_conf_send_stepd(fd)) {
-		error("%s: read_conf_send_stepd(%d) failed: %m", __func__, fd);
-		goto fail;
-	}
-
 	/* send type over to slurmstepd */
 	safe_write(fd, &type, sizeof(int));
 
@@ -822,19 +857,16 @@ fail:
 
 
 /*
- * Fork and exec the slurmstepd, then send the slurmstepd its
- * initialization data.  Then wait for slurmstepd to send an "ok"
- * message before returning.  When the "ok" message is received,
- * the slurmstepd has created and begun listening on its unix
- * domain socket.
+ * Fork and exec a slurmstepd. On success, to_stepd_fd and to_slurmd_fd are
+ * set to the pipes used to send the slurmstepd its initialization data and to
+ * read its return code.
  *
  * Note that this code forks twice and it is the grandchild that
  * becomes the slurmstepd process, so the slurmstepd's parent process
  * will be init, not slurmd.
  */
-static int
-_forkexec_slurmstepd(uint16_t type, void *req, slurm_addr_t *cli,
-		      hostlist_t *step_hset, uint16_t protocol_version)
+static int _spawn_slurmstepd(uint16_t type, void *req, int *to_stepd_fd,
+			     int *to_slurmd_fd)
 {
 	pid_t pid;
 	int to_stepd[2] = {-1, -1};
@@ -845,87 +877,26 @@ _forkexec_slurmstepd(uint16_t type, void *req, slurm_addr_t *cli,
 		return SLURM_ERROR;
 	}
 
-	if (_add_starting_step(type, req)) {
-		error("%s: failed in _add_starting_step: %m", __func__);
-		return SLURM_ERROR;
-	}
-
 	if ((pid = fork()) < 0) {
 		error("%s: fork: %m", __func__);
 		close(to_stepd[0]);
 		close(to_stepd[1]);
 		close(to_slurmd[0]);
 		close(to_slurmd[1]);
-		_remove_starting_step(type, req);
 		return SLURM_ERROR;
 	} else if (pid > 0) {
-		int rc = SLURM_SUCCESS;
-#if (SLURMSTEPD_MEMCHECK != 1)
-		int i;
-		time_t start_time = time(NULL);
-#endif
-		/*
-		 * Parent sends initialization data to the slurmstepd
-		 * over the to_stepd pipe, and waits for the return code
-		 * reply on the to_slurmd pipe.
-		 */
 		if (close(to_stepd[0]) < 0)
 			error("Unable to close read to_stepd in parent: %m");
 		if (close(to_slurmd[1]) < 0)
 			error("Unable to close write to_slurmd in parent: %m");
 
-		if ((rc = _send_slurmstepd_init(to_stepd[1], type,
-						req, cli, step_hset,
-						protocol_version)) != 0) {
-			error("Unable to init slurmstepd");
-			goto done;
-		}
-
-		/*
-		 * If running under memcheck, this pipe doesn't work correctly
-		 * so just skip it.
-		 */
-#if (SLURMSTEPD_MEMCHECK != 1)
-		i = read(to_slurmd[0], &rc, sizeof(int));
-		if (i < 0) {
-			error("%s: Can not read return code from slurmstepd "
-			      "got %d: %m", __func__, i);
-			rc = SLURM_ERROR;
-		} else if (i != sizeof(int)) {
-			error("%s: slurmstepd failed to send return code "
-			      "got %d: %m", __func__, i);
-			rc = SLURM_ERROR;
-		} else {
-			int delta_time = time(NULL) - start_time;
-			int cc;
-			if (delta_time > 5) {
-				warning("slurmstepd startup took %d sec, possible file system problem or full memory",
-					delta_time);
-			}
-			if (rc != SLURM_SUCCESS)
-				error("slurmstepd return code %d: %s",
-				      rc, slurm_strerror(rc));
-
-			cc = SLURM_SUCCESS;
-			cc = write(to_stepd[1], &cc, sizeof(int));
-			if (cc != sizeof(int)) {
-				error("%s: failed to send ack to stepd %d: %m",
-				      __func__, cc);
-			}
-		}
-#endif
-	done:
-		if (_remove_starting_step(type, req))
-			error("Error cleaning up starting_step list");
-
-		/* Reap child */
+		/* Reap child, the grandchild is the slurmstepd */
 		if (waitpid(pid, NULL, 0) < 0)
 			error("Unable to reap slurmd child process");
-		if (close(to_stepd[1]) < 0)
-			error("close write to_stepd in parent: %m");
-		if (close(to_slurmd[0]) < 0)
-			error("close read to_slurmd in parent: %m");
-		return rc;
+
+		*to_stepd_fd = to_stepd[1];
+		*to_slurmd_fd = to_slurmd[0];
+		return SLURM_SUCCESS;
 	} else {
 #if (SLURMSTEPD_MEMCHECK == 1)
 		/* memcheck test of slurmstepd, option #1 */
@@ -1073,6 +1044,254 @@ _forkexec_slurmstepd(uint16_t type, void *req, slurm_addr_t *cli,
 	}
 }
 
+static int _stepd_pool_size(void)
+{
+#if (SLURMSTEPD_MEMCHECK == 0)
+	char *tmp_ptr;
+	int size = 0;
+
+	if ((tmp_ptr = conf_get_opt_str(slurm_conf.launch_params,
+					 "stepd_pool="))) {
+		size = atoi(tmp_ptr);
+		xfree(tmp_ptr);
+	}
+
+	return MAX(0, MIN(size, STEPD_POOL_MAX));
+#else
+	/* memory checkers are started per step, see _spawn_slurmstepd() */
+	return 0;
+#endif
+}
+
+static void _stepd_pool_close(stepd_pool_t *stepd)
+{
+	/* slurmstepd exits once it reads EOF while waiting in the pool */
+	if (close(stepd->to_stepd) < 0)
+		error("close write to_stepd of pooled slurmstepd: %m");
+	if (close(stepd->to_slurmd) < 0)
+		error("close read to_slurmd of pooled slurmstepd: %m");
+}
+
+static void *_stepd_pool_fill_thread(void *arg)
+{
+	while (true) {
+		stepd_pool_t stepd;
+		uint32_t gen;
+
+		slurm_mutex_lock(&stepd_pool_mutex);
+		if (!stepd_pool_enabled ||
+		    (stepd_pool_cnt >= _stepd_pool_size())) {
+			stepd_pool_filling = false;
+			slurm_mutex_unlock(&stepd_pool_mutex);
+			break;
+		}
+		gen = stepd_pool_gen;
+		slurm_mutex_unlock(&stepd_pool_mutex);
+
+		if (_spawn_slurmstepd(LAUNCH_TASKS, NULL, &stepd.to_stepd,
+				      &stepd.to_slurmd)) {
+			slurm_mutex_lock(&stepd_pool_mutex);
+			stepd_pool_filling = false;
+			slurm_mutex_unlock(&stepd_pool_mutex);
+			break;
+		}
+		fd_set_close_on_exec(stepd.to_stepd);
+		fd_set_close_on_exec(stepd.to_slurmd);
+
+		if (_send_slurmstepd_conf(stepd.to_stepd, 1)) {
+			_stepd_pool_close(&stepd);
+			slurm_mutex_lock(&stepd_pool_mutex);
+			stepd_pool_filling = false;
+			slurm_mutex_unlock(&stepd_pool_mutex);
+			break;
+		}
+
+		slurm_mutex_lock(&stepd_pool_mutex);
+		if (stepd_pool_enabled && (gen == stepd_pool_gen) &&
+		    (stepd_pool_cnt < STEPD_POOL_MAX)) {
+			stepd_pool[stepd_pool_cnt++] = stepd;
+			stepd.to_stepd = -1;
+		}
+		slurm_mutex_unlock(&stepd_pool_mutex);
+
+		/* Configuration changed while the slurmstepd was starting */
+		if (stepd.to_stepd != -1)
+			_stepd_pool_close(&stepd);
+	}
+
+	return NULL;
+}
+
+static void _stepd_pool_fill(void)
+{
+	slurm_mutex_lock(&stepd_pool_mutex);
+	if (stepd_pool_enabled && !stepd_pool_filling &&
+	    (stepd_pool_cnt < _stepd_pool_size())) {
+		stepd_pool_filling = true;
+		slurm_thread_create_detached(_stepd_pool_fill_thread, NULL);
+	}
+	slurm_mutex_unlock(&stepd_pool_mutex);
+}
+
+/* Take an idle slurmstepd from the pool, if one is available */
+static int _stepd_pool_get(int *to_stepd_fd, int *to_slurmd_fd)
+{
+	int rc = SLURM_ERROR;
+
+	slurm_mutex_lock(&stepd_pool_mutex);
+	if (stepd_pool_cnt) {
+		stepd_pool_t *stepd = &stepd_pool[--stepd_pool_cnt];
+
+		*to_stepd_fd = stepd->to_stepd;
+		*to_slurmd_fd = stepd->to_slurmd;
+		rc = SLURM_SUCCESS;
+	}
+	slurm_mutex_unlock(&stepd_pool_mutex);
+
+	return rc;
+}
+
+extern void stepd_pool_init(void)
+{
+	slurm_mutex_lock(&stepd_pool_mutex);
+	stepd_pool_enabled = true;
+	slurm_mutex_unlock(&stepd_pool_mutex);
+
+	_stepd_pool_fill();
+}
+
+static void _stepd_pool_clear(void)
+{
+	stepd_pool_gen++;
+	for (int i = 0; i < stepd_pool_cnt; i++)
+		_stepd_pool_close(&stepd_pool[i]);
+	stepd_pool_cnt = 0;
+}
+
+extern void stepd_pool_purge(void)
+{
+	slurm_mutex_lock(&stepd_pool_mutex);
+	_stepd_pool_clear();
+	slurm_mutex_unlock(&stepd_pool_mutex);
+
+	_stepd_pool_fill();
+}
+
+extern void stepd_pool_fini(void)
+{
+	slurm_mutex_lock(&stepd_pool_mutex);
+	stepd_pool_enabled = false;
+	_stepd_pool_clear();
+	slurm_mutex_unlock(&stepd_pool_mutex);
+}
+
+/*
+ * Start a slurmstepd, or take an idle one from the pool, then send the
+ * slurmstepd its initialization data.  Then wait for slurmstepd to send an
+ * "ok" message before returning.  When the "ok" message is received,
+ * the slurmstepd has created and begun listening on its unix
+ * domain socket.
+ */
+static int
+_forkexec_slurmstepd(uint16_t type, void *req, slurm_addr_t *cli,
+		      hostlist_t *step_hset, uint16_t protocol_version)
+{
+	int to_stepd = -1, to_slurmd = -1;
+	int rc = SLURM_SUCCESS;
+#if (SLURMSTEPD_MEMCHECK != 1)
+	int i;
+	time_t start_time = time(NULL);
+#endif
+
+	if (_add_starting_step(type, req)) {
+		error("%s: failed in _add_starting_step: %m", __func__);
+		return SLURM_ERROR;
+	}
+
+	/*
+	 * Parent sends initialization data to the slurmstepd
+	 * over the to_stepd pipe, and waits for the return code
+	 * reply on the to_slurmd pipe.
+	 */
+	if (!_stepd_pool_get(&to_stepd, &to_slurmd)) {
+		rc = _send_slurmstepd_init(to_stepd, type, req, cli, step_hset,
+					   protocol_version);
+		if (rc == EPIPE) {
+			/* Pooled slurmstepd is gone, start a new one */
+			debug("%s: pooled slurmstepd exited, starting a new one",
+			      __func__);
+			(void) close(to_stepd);
+			(void) close(to_slurmd);
+			to_stepd = to_slurmd = -1;
+			rc = SLURM_SUCCESS;
+		} else if (rc) {
+			error("Unable to init slurmstepd");
+			goto done;
+		}
+	}
+
+	if (to_stepd == -1) {
+		if (_spawn_slurmstepd(type, req, &to_stepd, &to_slurmd)) {
+			_remove_starting_step(type, req);
+			return SLURM_ERROR;
+		}
+
+		if ((rc = _send_slurmstepd_conf(to_stepd, 0)) ||
+		    (rc = _send_slurmstepd_init(to_stepd, type, req, cli,
+						step_hset, protocol_version))) {
+			error("Unable to init slurmstepd");
+			goto done;
+		}
+	}
+
+	/*
+	 * If running under memcheck, this pipe doesn't work correctly
+	 * so just skip it.
+	 */
+#if (SLURMSTEPD_MEMCHECK != 1)
+	i = read(to_slurmd, &rc, sizeof(int));
+	if (i < 0) {
+		error("%s: Can not read return code from slurmstepd "
+		      "got %d: %m", __func__, i);
+		rc = SLURM_ERROR;
+	} else if (i != sizeof(int)) {
+		error("%s: slurmstepd failed to send return code "
+		      "got %d: %m", __func__, i);
+		rc = SLURM_ERROR;
+	} else {
+		int delta_time = time(NULL) - start_time;
+		int cc;
+		if (delta_time > 5) {
+			warning("slurmstepd startup took %d sec, possible file system problem or full memory",
+				delta_time);
+		}
+		if (rc != SLURM_SUCCESS)
+			error("slurmstepd return code %d: %s",
+			      rc, slurm_strerror(rc));
+
+		cc = SLURM_SUCCESS;
+		cc = write(to_stepd, &cc, sizeof(int));
+		if (cc != sizeof(int)) {
+			error("%s: failed to send ack to stepd %d: %m",
+			      __func__, cc);
+		}
+	}
+#endif
+done:
+	if (_remove_starting_step(type, req))
+		error("Error cleaning up starting_step list");
+
+	if (close(to_stepd) < 0)
+		error("close write to_stepd in parent: %m");
+	if (close(to_slurmd) < 0)
+		error("close read to_slurmd in parent: %m");
+
+	/* Replace the slurmstepd taken from the pool */
+	_stepd_pool_fill();
+
+	return rc;
+}
+
 static void _setup_x11_display(uint32_t job_id, uint32_t step_id_in,
 			       char ***env, uint32_t *envc)
 {
@@ -4030,11 +4249,25 @@ static void _rpc_list_pids(slurm_msg_t *msg)
 
 	debug3("Entering _rpc_list_pids");
 
-	job_uid = _get_job_uid(req->job_id);
+	/*
+	 * Use the one connection to the step both to check the owner and to
+	 * list the pids, rather than looking the owner up through another
+	 * step of the job first.
+	 */
+	fd = stepd_connect(conf->spooldir, conf->node_name,
+			   req, &protocol_version);
+	if (fd == -1) {
+		error("stepd_connect to %ps failed: %m", req);
+		slurm_send_rc_msg(msg, ESLURM_INVALID_JOB_ID);
+		return;
+	}
+
+	job_uid = stepd_get_uid(fd, protocol_version);
 
 	if (job_uid == INFINITE) {
 		error("stat_pid for invalid job_id: %u",
 		      req->job_id);
+		close(fd);
 		if (msg->conn_fd >= 0)
 			slurm_send_rc_msg(msg, ESLURM_INVALID_JOB_ID);
 		return;
@@ -4051,6 +4284,7 @@ static void _rpc_list_pids(slurm_msg_t *msg)
 		if (msg->conn_fd >= 0) {
 			slurm_send_rc_msg(msg, ESLURM_USER_ID_MISSING);
 			/* or bad in this case */
+			close(fd);
 			return;
 		}
 	}
@@ -4060,14 +4294,6 @@ static void _rpc_list_pids(slurm_msg_t *msg)
 	resp->node_name = xstrdup(conf->node_name);
 	resp->pid_cnt = 0;
 	resp->pid = NULL;
-	fd = stepd_connect(conf->spooldir, conf->node_name,
-			   req, &protocol_version);
-	if (fd == -1) {
-		error("stepd_connect to %ps failed: %m", req);
-		slurm_send_rc_msg(msg, ESLURM_INVALID_JOB_ID);
-		slurm_free_job_step_pids(resp);
-		return;
-	}
 
 	if (stepd_list_pids(fd, protocol_version,
 			    &resp->pid, &resp->pid_cnt) == SLURM_ERROR) {
@@ -4219,10 +4445,24 @@ static sbcast_cred_arg_t *_valid_sbcast_cred(file_bcast_msg_t *req,
 					     gid_t req_gid,
 					     uint16_t protocol_version)
 {
+	static pthread_mutex_t nodes_mutex = PTHREAD_MUTEX_INITIALIZER;
+	static char *last_valid_nodes = NULL;
 	sbcast_cred_arg_t *arg = &req->cred->arg;
 	hostset_t *hset = NULL;
+	bool cached;
+
+	/*
+	 * Every block of a transfer carries the same credential, so remember
+	 * the last node list found to contain this node rather than parsing
+	 * it again for each block.
+	 */
+	slurm_mutex_lock(&nodes_mutex);
+	cached = (last_valid_nodes && !xstrcmp(arg->nodes, last_valid_nodes));
+	slurm_mutex_unlock(&nodes_mutex);
 
-	if (!(hset = hostset_create(arg->nodes))) {
+	if (cached) {
+		;
+	} else if (!(hset = hostset_create(arg->nodes))) {
 		error("Unable to parse sbcast_cred hostlist %s", arg->nodes);
 		return NULL;
 	} else if (!hostset_within(hset, conf->node_name)) {
@@ -4230,8 +4470,13 @@ static sbcast_cred_arg_t *_valid_sbcast_cred(file_bcast_msg_t *req,
 		      "bad hostset %s", req_uid, arg->nodes);
 		hostset_destroy(hset);
 		return NULL;
+	} else {
+		hostset_destroy(hset);
+		slurm_mutex_lock(&nodes_mutex);
+		xfree(last_valid_nodes);
+		last_valid_nodes = xstrdup(arg->nodes);
+		slurm_mutex_unlock(&nodes_mutex);
 	}
-	hostset_destroy(hset);
 
 	if ((arg->id->uid != req_uid) || (arg->id->gid != req_gid)) {
 		error("Security violation: sbcast cred from %u/%u but rpc from %u/%u",
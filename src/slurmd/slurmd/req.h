@@ -60,6 +60,18 @@ extern void record_launched_jobs(void);
 void file_bcast_init(void);
 void file_bcast_purge(void);
 
+/*
+ * Start keeping idle slurmstepd processes ready for launches, as configured by
+ * LaunchParameters=stepd_pool=<count>.
+ */
+extern void stepd_pool_init(void);
+
+/* Replace idle slurmstepd processes after a configuration change */
+extern void stepd_pool_purge(void);
+
+/* Stop keeping idle slurmstepd processes and terminate any idle ones */
+extern void stepd_pool_fini(void);
+
 /*
  * ume_notify - Notify all jobs and steps on this node that a Uncorrectable
  *	Memory Error (UME) has occurred by sending SIG_UME (to log event in
@@ -83,6 +83,7 @@
 #include "src/common/list.h"
 #include "src/common/log.h"
 #include "src/common/macros.h"
+#include "src/common/metrics.h"
 #include "src/common/node_conf.h"
 #include "src/common/pack.h"
 #include "src/common/parse_time.h"
@@ -96,6 +97,7 @@
 #include "src/common/spank.h"
 #include "src/common/stepd_api.h"
 #include "src/common/uid.h"
+#include "src/common/util-net.h"
 #include "src/common/xmalloc.h"
 #include "src/common/xstring.h"
 #include "src/common/xsystemd.h"
@@ -526,6 +528,13 @@ static void _run(conmgr_callback_args_t conmgr_args, void *arg)
 
 	_create_msg_socket(args);
 
+	metric_register_src("threads", NULL, METRIC_GAUGE,
+			    "Active RPC processing threads", &active_threads,
+			    sizeof(active_threads));
+	if (slurm_conf.slurmd_params)
+		(void) conmgr_metrics_listen(slurm_conf.slurmd_params,
+					     "slurmd");
+
 	conf->pid = getpid();
 
 	rfc2822_timestamp(time_stamp, sizeof(time_stamp));
@@ -547,6 +556,7 @@ static void _run(conmgr_callback_args_t conmgr_args, void *arg)
 		run_script_health_check();
 
 	record_launched_jobs();
+	stepd_pool_init();
 	slurm_thread_create_detached(_registration_engine, &registration_arg);
 
 	slurm_mutex_lock(&listener.mutex);
@@ -584,10 +594,12 @@ static void _run_fini(conmgr_callback_args_t conmgr_args, void *arg)
 	 * failure.
 	 */
 	run_command_shutdown();
+	stepd_pool_fini();
 	_slurmd_fini();
 	_destroy_conf();
 	cred_g_fini();	/* must be after _destroy_conf() */
 	group_cache_purge();
+	getaddrinfo_cache_purge();
 	file_bcast_purge();
 
 	/*
@@ -698,6 +710,121 @@ static int _wait_for_all_threads(int secs)
 	return SLURM_SUCCESS;
 }
 
+static void _on_finish(conmgr_fd_t *con, void *arg);
+static void _service_keep_alive(conmgr_callback_args_t conmgr_args,
+				int input_fd, int output_fd, void *arg);
+
+static void *_on_keep_alive_connection(conmgr_fd_t *con, void *arg)
+{
+	debug3("%s: [%s] Kept alive RPC connection",
+	       __func__, conmgr_fd_get_name(con));
+
+	return con;
+}
+
+static int _on_keep_alive_msg(conmgr_fd_t *con, slurm_msg_t *msg, void *arg)
+{
+	int rc;
+
+	if ((rc = conmgr_queue_extract_con_fd(con, _service_keep_alive,
+					      XSTRINGIFY(_service_keep_alive),
+					      msg))) {
+		error("%s: [%s] Extracting FDs failed: %s",
+		      __func__, conmgr_fd_get_name(con), slurm_strerror(rc));
+		slurm_free_msg(msg);
+	}
+
+	return rc;
+}
+
+/* Hand fd to conmgr to wait for the next RPC from the sender */
+static void _keep_alive_connection(int fd)
+{
+	static const conmgr_events_t events = {
+		.on_connection = _on_keep_alive_connection,
+		.on_msg = _on_keep_alive_msg,
+		.on_finish = _on_finish,
+	};
+	slurm_addr_t addr = {
+		.ss_family = AF_UNSPEC,
+	};
+	int rc;
+
+	(void) slurm_get_peer_addr(fd, &addr);
+
+	if ((rc = conmgr_process_fd(CON_TYPE_RPC, fd, fd, &events,
+				    CON_FLAG_RPC_KEEP_BUFFER, &addr,
+				    sizeof(addr), NULL))) {
+		error("%s: [fd:%d] unable to keep connection alive: %s",
+		      __func__, fd, slurm_strerror(rc));
+		fd_close(&fd);
+	}
+}
+
+/*
+ * Process msg received on msg->conn_fd. If the sender asked to reuse the
+ * connection and the RPC allows it, keep the connection open afterwards.
+ */
+static void _process_msg(slurm_msg_t *msg)
+{
+	bool keep_alive = ((msg->flags & SLURM_MSG_KEEP_ALIVE) &&
+			   !msg->forward.cnt &&
+			   forward_keep_alive_type(msg->msg_type));
+
+	/* The response echoes the flag only if the connection is kept */
+	if (!keep_alive)
+		msg->flags &= ~SLURM_MSG_KEEP_ALIVE;
+
+	slurmd_req(msg);
+
+	if (keep_alive && (msg->conn_fd >= 0)) {
+		_keep_alive_connection(msg->conn_fd);
+		msg->conn_fd = -1;
+	}
+}
+
+/* Process RPC unpacked by conmgr on a kept alive connection */
+static void _service_keep_alive(conmgr_callback_args_t conmgr_args,
+				int input_fd, int output_fd, void *arg)
+{
+	slurm_msg_t *msg = arg;
+
+	if ((conmgr_args.status == CONMGR_WORK_STATUS_CANCELLED) ||
+	    (input_fd < 0) || (output_fd < 0)) {
+		debug3("%s: [fd:%d] connection work cancelled",
+		       __func__, input_fd);
+		if (input_fd != output_fd)
+			fd_close(&output_fd);
+		fd_close(&input_fd);
+		slurm_free_msg(msg);
+		return;
+	}
+
+	/* The fd was extracted so the conmgr connection is invalid */
+	msg->conmgr_fd = NULL;
+	msg->conn_fd = input_fd;
+
+	/* force blocking mode for blocking handlers */
+	fd_set_blocking(input_fd);
+
+	debug2("Start processing kept alive RPC: %s",
+	       rpc_num2string(msg->msg_type));
+
+	if (slurm_conf.debug_flags & DEBUG_FLAG_AUDIT_RPCS) {
+		log_flag(AUDIT_RPCS, "msg_type=%s uid=%u client=[%pA] protocol=%u",
+			 rpc_num2string(msg->msg_type), msg->auth_uid,
+			 &msg->address, msg->protocol_version);
+	}
+
+	_process_msg(msg);
+
+	if ((msg->conn_fd >= 0) && close(msg->conn_fd) < 0)
+		error("close(%d): %m", input_fd);
+
+	debug2("Finish processing RPC: %s", rpc_num2string(msg->msg_type));
+	slurm_free_msg(msg);
+}
+
 static void _service_connection(conmgr_callback_args_t conmgr_args,
 				int input_fd, int output_fd, void *arg)
 {
@@ -770,7 +897,7 @@ static void _service_connection(conmgr_callback_args_t conmgr_args,
 			 &addr, msg->protocol_version);
 	}
 
-	slurmd_req(msg);
+	_process_msg(msg);
 
 cleanup:
 	if ((msg->conn_fd >= 0) && close(msg->conn_fd) < 0)
@@ -1444,6 +1571,9 @@ extern void update_stepd_logging(bool reconfig)
 	steps = stepd_available(conf->spooldir, conf->node_name);
 	list_for_each(steps, _reconfig_stepd, &reconfig);
 	FREE_NULL_LIST(steps);
+
+	/* Replace idle slurmstepds started with the old configuration */
+	stepd_pool_purge();
 }
 
 static void _notify_parent_of_success(void)
@@ -35,6 +35,7 @@
 
 #include "config.h"
 
+#include <ctype.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <unistd.h>
@@ -42,6 +43,7 @@
 #include "src/common/data.h"
 #include "src/common/fd.h"
 #include "src/common/oci_config.h"
+#include "src/common/proc_args.h"
 #include "src/common/read_config.h"
 #include "src/common/run_command.h"
 #include "src/common/xmalloc.h"
@@ -78,6 +80,17 @@ static char *run_argv[] = {
 static char *start_argv[] = {
 	"/bin/sh", "-c", "echo 'RunTimeStart never configured in oci.conf'; exit 1", NULL };
 
+/* argv to exec runtime directly when RunTimeDirectExec=true (or NULL) */
+static char **create_dargv = NULL;
+static char **delete_dargv = NULL;
+static char **kill_dargv = NULL;
+static char **query_dargv = NULL;
+static char **run_dargv = NULL;
+static char **start_dargv = NULL;
+
+/* Unquoted characters that require /bin/sh to interpret the pattern */
+#define SHELL_META_CHARS "|&;<>()$`*?[#~{"
+
 static char *_get_config_path(stepd_step_rec_t *step);
 static char *_generate_spooldir(stepd_step_rec_t *step,
 				stepd_step_task_info_t *task);
@@ -94,6 +107,131 @@ static void _dump_command_args(run_command_args_t *args, const char *caller)
 		       caller, i, args->script_argv[i]);
 }
 
+static void _free_argv(char **argv)
+{
+	for (int i = 0; argv && argv[i]; i++)
+		xfree(argv[i]);
+	xfree(argv);
+}
+
+static void _append_argv(char ***argv, int *argc, char **arg, char **pos)
+{
+	xrecalloc(*argv, (*argc + 2), sizeof(**argv));
+	(*argv)[(*argc)++] = (*arg ? *arg : xstrdup(""));
+	*arg = NULL;
+	*pos = NULL;
+}
+
+/*
+ * Split generated command into argv the same way /bin/sh would for simple
+ * commands composed only of words and quoting.
+ * IN cmd - command generated by _generate_pattern()
+ * IN cwd - directory to search last if command is not found in PATH
+ * RET argv (caller must free) or NULL if command requires /bin/sh
+ */
+static char **_split_pattern(const char *cmd, char *cwd)
+{
+	char **argv = NULL, *arg = NULL, *pos = NULL, *path;
+	int argc = 0;
+	bool in_arg = false;
+	char quote = '\0';
+
+	for (const char *c = cmd; *c; c++) {
+		if (quote == '\'') {
+			if (*c == '\'')
+				quote = '\0';
+			else
+				xstrfmtcatat(arg, &pos, "%c", *c);
+			continue;
+		}
+
+		if (quote == '"') {
+			if (*c == '"') {
+				quote = '\0';
+				continue;
+			} else if ((*c == '$') || (*c == '`')) {
+				goto shell;
+			} else if ((*c == '\\') && c[1] &&
+				   strchr("\"\\", c[1])) {
+				c++;
+			} else if (*c == '\\') {
+				goto shell;
+			}
+
+			xstrfmtcatat(arg, &pos, "%c", *c);
+			continue;
+		}
+
+		if (isspace(*c)) {
+			if (in_arg)
+				_append_argv(&argv, &argc, &arg, &pos);
+			in_arg = false;
+			continue;
+		}
+
+		in_arg = true;
+
+		if ((*c == '\'') || (*c == '"')) {
+			quote = *c;
+			continue;
+		}
+
+		if (*c == '\\') {
+			if (!c[1] || (c[1] == '\n'))
+				goto shell;
+			c++;
+		} else if (strchr(SHELL_META_CHARS, *c)) {
+			goto shell;
+		}
+
+		xstrfmtcatat(arg, &pos, "%c", *c);
+	}
+
+	if (quote)
+		goto shell;
+
+	if (in_arg)
+		_append_argv(&argv, &argc, &arg, &pos);
+
+	/* variable assignments are left for the shell */
+	if (!argc || xstrstr(argv[0], "="))
+		goto shell;
+
+	if (argv[0][0] != '/') {
+		if (!(path = search_path(cwd, argv[0], true, X_OK, true)))
+			goto shell;
+
+		xfree(argv[0]);
+		argv[0] = path;
+	}
+
+	return argv;
+
+shell:
+	xfree(arg);
+	_free_argv(argv);
+	return NULL;
+}
+
+static void _set_direct_argv(char ***dargv, const char *cmd,
+			     stepd_step_rec_t *step)
+{
+	_free_argv(*dargv);
+	*dargv = NULL;
+
+	if (!oci_conf->runtime_direct_exec)
+		return;
+
+	if (!(*dargv = _split_pattern(cmd, step->container->spool_dir)))
+		debug("%s: RunTimeDirectExec unable to directly execute. Falling back to /bin/sh: %s",
+		      __func__, cmd);
+}
+
+static char **_get_argv(char **argv, char **dargv)
+{
+	return (dargv ? dargv : argv);
+}
+
 static void _pattern_argv(char **buffer, char **offset, char **cmd_args)
 {
 	for (char **arg = cmd_args; arg && *arg; arg++) {
@@ -316,10 +454,15 @@ static int _write_config(const stepd_step_rec_t *step, const char *jconfig,
 
 	safe_write(outfd, out, strlen(out));
 
-	if (fsync_and_close(outfd, jconfig)) {
+	/*
+	 * config.json is only read by the OCI runtime on this node right after
+	 * being written and is removed with the spool directory. Avoid the
+	 * latency of syncing it to disk for every task.
+	 */
+	if (close(outfd)) {
 		outfd = -1;
-		error("%s: failure sync and close of config: %s",
-		      __func__, slurm_strerror(rc));
+		error("%s: failure to close config %s: %m",
+		      __func__, jconfig);
 		goto rwfail;
 	}
 
@@ -782,12 +925,13 @@ static data_t *_get_container_state()
 	char *out;
 	run_command_args_t run_command_args = {
 		.max_wait = -1,
-		.script_argv = query_argv,
-		.script_path = query_argv[0],
+		.script_argv = _get_argv(query_argv, query_dargv),
 		.script_type = "RunTimeQuery",
 		.status = &rc,
 	};
 
+	run_command_args.script_path = run_command_args.script_argv[0];
+
 	/* request container get deleted if known at all any more */
 	_dump_command_args(&run_command_args, __func__);
 	out = run_command(&run_command_args);
@@ -837,8 +981,8 @@ static void _kill_container()
 	    !(status = _get_container_status())) {
 		debug("container already dead");
 	} else if (!xstrcasecmp(status, "running")) {
-		run_command_args.script_argv = kill_argv;
-		run_command_args.script_path = kill_argv[0];
+		run_command_args.script_argv = _get_argv(kill_argv, kill_dargv);
+		run_command_args.script_path = run_command_args.script_argv[0];
 		run_command_args.script_type = "RunTimeKill";
 
 		for (int t = 0; t < 10; t++) {
@@ -884,8 +1028,9 @@ static void _kill_container()
 		char *out;
 
 		/* request container get deleted if known at all any more */
-		run_command_args.script_argv = delete_argv;
-		run_command_args.script_path = delete_argv[0];
+		run_command_args.script_argv = _get_argv(delete_argv,
+							 delete_dargv);
+		run_command_args.script_path = run_command_args.script_argv[0];
 		run_command_args.script_type = "RunTimeDelete";
 		run_command_args.status = &delete_status;
 		_dump_command_args(&run_command_args, __func__);
@@ -899,9 +1044,11 @@ static void _kill_container()
 
 static void _run(stepd_step_rec_t *step, stepd_step_task_info_t *task)
 {
+	char **argv = _get_argv(run_argv, run_dargv);
+
 	debug3("%s: executing: %s", __func__, run_argv[2]);
-	execv(run_argv[0], run_argv);
-	fatal("execv(%s) failed: %m", run_argv[0]);
+	execv(argv[0], argv);
+	fatal("execv(%s) failed: %m", argv[0]);
 }
 
 static void _create_start(stepd_step_rec_t *step,
@@ -917,8 +1064,8 @@ static void _create_start(stepd_step_rec_t *step,
 	if (oci_conf->ignore_config_json)
 		fatal("IgnoreFileConfigJson=true and RunTimeStart are mutually exclusive");
 
-	run_command_args.script_argv = create_argv;
-	run_command_args.script_path = create_argv[0];
+	run_command_args.script_argv = _get_argv(create_argv, create_dargv);
+	run_command_args.script_path = run_command_args.script_argv[0];
 	run_command_args.script_type = "RunTimeCreate";
 	_dump_command_args(&run_command_args, __func__);
 	out = run_command(&run_command_args);
@@ -958,8 +1105,8 @@ static void _create_start(stepd_step_rec_t *step,
 		}
 	}
 
-	run_command_args.script_argv = start_argv;
-	run_command_args.script_path = start_argv[0];
+	run_command_args.script_argv = _get_argv(start_argv, start_dargv);
+	run_command_args.script_path = run_command_args.script_argv[0];
 	run_command_args.script_type = "RunTimeStart";
 	_dump_command_args(&run_command_args, __func__);
 	out = run_command(&run_command_args);
@@ -1023,6 +1170,7 @@ static void _generate_patterns(stepd_step_rec_t *step,
 			xfree(create_argv[2]);
 		create_argv[2] = gen;
 		set = true;
+		_set_direct_argv(&create_dargv, gen, step);
 	}
 
 	gen = _generate_pattern(oci_conf->runtime_delete, step, id, argv);
@@ -1032,6 +1180,7 @@ static void _generate_patterns(stepd_step_rec_t *step,
 			xfree(delete_argv[2]);
 		delete_argv[2] = gen;
 		set = true;
+		_set_direct_argv(&delete_dargv, gen, step);
 	}
 
 	gen = _generate_pattern(oci_conf->runtime_kill, step, id, argv);
@@ -1041,6 +1190,7 @@ static void _generate_patterns(stepd_step_rec_t *step,
 			xfree(kill_argv[2]);
 		kill_argv[2] = gen;
 		set = true;
+		_set_direct_argv(&kill_dargv, gen, step);
 	}
 
 	gen = _generate_pattern(oci_conf->runtime_query, step, id, argv);
@@ -1050,6 +1200,7 @@ static void _generate_patterns(stepd_step_rec_t *step,
 			xfree(query_argv[2]);
 		query_argv[2] = gen;
 		set = true;
+		_set_direct_argv(&query_dargv, gen, step);
 	}
 
 	gen = _generate_pattern(oci_conf->runtime_run, step, id, argv);
@@ -1059,6 +1210,7 @@ static void _generate_patterns(stepd_step_rec_t *step,
 			xfree(run_argv[2]);
 		run_argv[2] = gen;
 		set = true;
+		_set_direct_argv(&run_dargv, gen, step);
 	}
 
 	gen = _generate_pattern(oci_conf->runtime_start, step, id, argv);
@@ -1068,6 +1220,7 @@ static void _generate_patterns(stepd_step_rec_t *step,
 			xfree(start_argv[2]);
 		start_argv[2] = gen;
 		set = true;
+		_set_direct_argv(&start_dargv, gen, step);
 	}
 }
 
@@ -1108,7 +1261,7 @@ extern void container_run(stepd_step_rec_t *step,
 
 		if ((rc = serialize_g_data_to_string(&out, NULL, c->config,
 						     MIME_TYPE_JSON,
-						     SER_FLAGS_PRETTY))) {
+						     SER_FLAGS_COMPACT))) {
 			fatal("%s: serialization of config failed: %s",
 			      __func__, slurm_strerror(rc));
 		}
@@ -56,6 +56,7 @@
 #include <sys/socket.h>
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <sys/uio.h>
 #include <termios.h>
 #include <unistd.h>
 
@@ -80,10 +81,17 @@
 /*
  * The message cache uses up free message buffers, so STDIO_MAX_MSG_CACHE
  * must be a number smaller than STDIO_MAX_FREE_BUF.
+ *
+ * The free buffer limit grows by STDIO_FREE_BUF_PER_TASK for each local task
+ * so steps with many tasks don't throttle their output on a shared pool.
  */
 #define STDIO_MAX_FREE_BUF 1024
+#define STDIO_FREE_BUF_PER_TASK 16
 #define STDIO_MAX_MSG_CACHE 128
 
+/* Most queued messages written to a client with a single writev() */
+#define STDIO_MAX_WRITEV 64
+
 struct io_buf {
 	int ref_count;
 	uint32_t length;
@@ -438,14 +446,65 @@ static int _client_read(eio_obj_t *obj, list_t *objs)
 	return SLURM_SUCCESS;
 }
 
+/*
+ * Write the rest of client->out_msg followed by the messages queued behind it
+ * with a single writev(). The first skip bytes of each queued message are not
+ * written, and a queued message with no data past them ends the batch.
+ *
+ * Fully written messages are freed, and client->out_msg is left pointing to
+ * the first message not completely written, if any.
+ *
+ * RET SLURM_SUCCESS or SLURM_ERROR with errno set by writev().
+ */
+static int _write_msg_batch(int fd, struct client_io_info *client,
+			    uint32_t skip)
+{
+	struct iovec iov[STDIO_MAX_WRITEV];
+	struct io_buf *msg;
+	list_itr_t *itr;
+	int iovcnt = 1;
+	ssize_t n;
+
+	iov[0].iov_base = client->out_msg->data +
+		(client->out_msg->length - client->out_remaining);
+	iov[0].iov_len = client->out_remaining;
+
+	itr = list_iterator_create(client->msg_queue);
+	while ((iovcnt < STDIO_MAX_WRITEV) && (msg = list_next(itr))) {
+		if (msg->length <= skip)
+			break;
+		iov[iovcnt].iov_base = msg->data + skip;
+		iov[iovcnt].iov_len = msg->length - skip;
+		iovcnt++;
+	}
+	list_iterator_destroy(itr);
+
+	while ((n = writev(fd, iov, iovcnt)) < 0) {
+		if (errno != EINTR)
+			return SLURM_ERROR;
+	}
+	debug5("Wrote %zd bytes from up to %d messages", n, iovcnt);
+
+	while (n >= client->out_remaining) {
+		n -= client->out_remaining;
+		_free_outgoing_msg(client->out_msg, client->step);
+		client->out_msg = NULL;
+		if (!--iovcnt)
+			return SLURM_SUCCESS;
+		client->out_msg = list_dequeue(client->msg_queue);
+		client->out_remaining = client->out_msg->length - skip;
+	}
+	client->out_remaining -= n;
+
+	return SLURM_SUCCESS;
+}
+
 /*
  * Write outgoing packed messages to the client socket.
  */
 static int _client_write(eio_obj_t *obj, list_t *objs)
 {
 	struct client_io_info *client = (struct client_io_info *) obj->arg;
-	void *buf;
-	int n;
 
 	xassert(client->magic == CLIENT_IO_MAGIC);
 
@@ -469,35 +528,16 @@ static int _client_write(eio_obj_t *obj, list_t *objs)
 	debug5("  client->out_remaining = %d", client->out_remaining);
 
 	/*
-	 * Write message to socket.
+	 * Write messages to socket.
 	 */
-	buf = client->out_msg->data +
-		(client->out_msg->length - client->out_remaining);
-again:
-	if ((n = write(obj->fd, buf, client->out_remaining)) < 0) {
-		if (errno == EINTR) {
-			goto again;
-		} else if ((errno == EAGAIN) || (errno == EWOULDBLOCK)) {
+	if (_write_msg_batch(obj->fd, client, 0) != SLURM_SUCCESS) {
+		if ((errno == EAGAIN) || (errno == EWOULDBLOCK)) {
 			debug5("_client_write returned EAGAIN");
 			return SLURM_SUCCESS;
-		} else {
-			client->out_eof = true;
-			_free_all_outgoing_msgs(client->msg_queue,
-						client->step);
-			return SLURM_SUCCESS;
 		}
+		client->out_eof = true;
+		_free_all_outgoing_msgs(client->msg_queue, client->step);
 	}
-	if (n < client->out_remaining) {
-		error("Only wrote %d of %d bytes to socket",
-		      n, client->out_remaining);
-	} else
-		debug5("Wrote %d bytes to socket", n);
-	client->out_remaining -= n;
-	if (client->out_remaining > 0)
-		return SLURM_SUCCESS;
-
-	_free_outgoing_msg(client->out_msg, client->step);
-	client->out_msg = NULL;
 
 	return SLURM_SUCCESS;
 }
@@ -569,6 +609,21 @@ static int _local_file_write(eio_obj_t *obj, list_t *objs)
 		return SLURM_SUCCESS;
 	}
 
+	/*
+	 * Without labels the message payloads are written as they are, so
+	 * write as many of the queued messages as possible at once.
+	 */
+	if (!client->labelio) {
+		if (_write_msg_batch(obj->fd, client, IO_HDR_PACKET_BYTES) !=
+		    SLURM_SUCCESS) {
+			client->out_eof = true;
+			_free_all_outgoing_msgs(client->msg_queue,
+						client->step);
+			return SLURM_ERROR;
+		}
+		return SLURM_SUCCESS;
+	}
+
 	/* Write the message to the file. */
 	buf = client->out_msg->data +
 		(client->out_msg->length - client->out_remaining);
@@ -920,6 +975,56 @@ _spawn_window_manager(stepd_step_task_info_t *task, stepd_step_rec_t *step)
  * General fuctions
  **********************************************************************/
 
+/*
+ * Find a task on this node whose stdout or stderr is already opened on name.
+ * RET a close-on-exec duplicate of its file descriptor or -1 if none.
+ */
+static int _dup_task_file(stepd_step_rec_t *step, const char *name)
+{
+	for (int i = 0; i < step->node_tasks; i++) {
+		stepd_step_task_info_t *task = step->task[i];
+
+		if ((task->stdout_fd >= 0) && (task->from_stdout == -1) &&
+		    !xstrcmp(task->ofname, name))
+			return fcntl(task->stdout_fd, F_DUPFD_CLOEXEC, 0);
+		if ((task->stderr_fd >= 0) && (task->from_stderr == -1) &&
+		    !xstrcmp(task->efname, name))
+			return fcntl(task->stderr_fd, F_DUPFD_CLOEXEC, 0);
+	}
+
+	return -1;
+}
+
+/*
+ * Open the file a task writes its stdout or stderr to directly. Files are
+ * always opened with O_APPEND, so tasks writing to the same file share a
+ * single open of it instead of each opening it again.
+ */
+static int _open_task_file(stepd_step_rec_t *step, const char *name,
+			   int file_flags)
+{
+	int fd, count = 0;
+
+	xassert(file_flags & O_APPEND);
+
+	if (!(step->flags & LAUNCH_PTY) &&
+	    ((fd = _dup_task_file(step, name)) >= 0)) {
+		debug5("  sharing open file %s", name);
+		return fd;
+	}
+
+	do {
+		fd = open(name, file_flags | O_CLOEXEC, 0666);
+		if (!count && (errno == ENOENT)) {
+			mkdirpath(name, 0755, false);
+			errno = EINTR;
+		}
+		++count;
+	} while (fd == -1 && errno == EINTR && count < 10);
+
+	return fd;
+}
+
 /*
  * This function sets the close-on-exec flag on all opened file descriptors.
  * io_dup_stdio will remove the close-on-exec flags for just one task's
@@ -1044,18 +1149,10 @@ _init_task_stdio_fds(stepd_step_task_info_t *task, stepd_step_rec_t *step)
 	    (((step->flags & LAUNCH_LABEL_IO) == 0) ||
 	     xstrcmp(task->ofname, "/dev/null") == 0)) {
 #endif
-		int count = 0;
 		/* open file on task's stdout */
 		debug5("  stdout file name = %s", task->ofname);
-		do {
-			task->stdout_fd = open(task->ofname,
-					       file_flags | O_CLOEXEC, 0666);
-			if (!count && (errno == ENOENT)) {
-				mkdirpath(task->ofname, 0755, false);
-				errno = EINTR;
-			}
-			++count;
-		} while (task->stdout_fd == -1 && errno == EINTR && count < 10);
+		task->stdout_fd = _open_task_file(step, task->ofname,
+						  file_flags);
 		if (task->stdout_fd == -1) {
 			error("Could not open stdout file %s: %m",
 			      task->ofname);
@@ -1143,18 +1240,10 @@ _init_task_stdio_fds(stepd_step_task_info_t *task, stepd_step_rec_t *step)
 	    (((step->flags & LAUNCH_LABEL_IO) == 0) ||
 	     (xstrcmp(task->efname, "/dev/null") == 0))) {
 #endif
-		int count = 0;
-		/* open file on task's stdout */
+		/* open file on task's stderr */
 		debug5("  stderr file name = %s", task->efname);
-		do {
-			task->stderr_fd = open(task->efname,
-					       file_flags | O_CLOEXEC, 0666);
-			if (!count && (errno == ENOENT)) {
-				mkdirpath(task->efname, 0755, false);
-				errno = EINTR;
-			}
-			++count;
-		} while (task->stderr_fd == -1 && errno == EINTR && count < 10);
+		task->stderr_fd = _open_task_file(step, task->efname,
+						  file_flags);
 		if (task->stderr_fd == -1) {
 			error("Could not open stderr file %s: %m",
 			      task->efname);
@@ -1880,6 +1969,13 @@ static void _free_io_buf(struct io_buf *buf)
 	}
 }
 
+/* Most message buffers allocated in each direction for the step */
+static int _max_free_buf(stepd_step_rec_t *step)
+{
+	return MAX(STDIO_MAX_FREE_BUF,
+		   step->node_tasks * STDIO_FREE_BUF_PER_TASK);
+}
+
 /* This just determines if there's space to hold more of the stdin stream */
 static bool
 _incoming_buf_free(stepd_step_rec_t *step)
@@ -1888,7 +1984,7 @@ _incoming_buf_free(stepd_step_rec_t *step)
 
 	if (list_count(step->free_incoming) > 0) {
 		return true;
-	} else if (step->incoming_count < STDIO_MAX_FREE_BUF) {
+	} else if (step->incoming_count < _max_free_buf(step)) {
 		buf = _alloc_io_buf();
 		list_enqueue(step->free_incoming, buf);
 		step->incoming_count++;
@@ -1905,7 +2001,7 @@ _outgoing_buf_free(stepd_step_rec_t *step)
 
 	if (list_count(step->free_outgoing) > 0) {
 		return true;
-	} else if (step->outgoing_count < STDIO_MAX_FREE_BUF) {
+	} else if (step->outgoing_count < _max_free_buf(step)) {
 		buf = _alloc_io_buf();
 		list_enqueue(step->free_outgoing, buf);
 		step->outgoing_count++;
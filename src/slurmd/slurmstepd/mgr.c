@@ -662,6 +662,32 @@ _send_exit_msg(stepd_step_rec_t *step, uint32_t *tid, int n, int status)
 	return SLURM_SUCCESS;
 }
 
+/*
+ * Seconds this rank waits for its children's step completions. The base
+ * timeout plus an extra amount for every level of tree below this level, both
+ * configurable with LaunchParameters.
+ */
+static int _children_timeout(void)
+{
+	char *tmp_ptr;
+	int timeout = REVERSE_TREE_CHILDREN_TIMEOUT;
+	int level_timeout = REVERSE_TREE_LEVEL_TIMEOUT;
+
+	if ((tmp_ptr = conf_get_opt_str(slurm_conf.launch_params,
+					 "step_complete_timeout="))) {
+		timeout = MAX(atoi(tmp_ptr), 0);
+		xfree(tmp_ptr);
+	}
+	if ((tmp_ptr = conf_get_opt_str(slurm_conf.launch_params,
+					 "step_complete_level_timeout="))) {
+		level_timeout = MAX(atoi(tmp_ptr), 0);
+		xfree(tmp_ptr);
+	}
+
+	return timeout + (level_timeout *
+			  (step_complete.max_depth - step_complete.depth));
+}
+
 extern void stepd_wait_for_children_slurmstepd(stepd_step_rec_t *step)
 {
 	int left = 0;
@@ -670,10 +696,8 @@ extern void stepd_wait_for_children_slurmstepd(stepd_step_rec_t *step)
 
 	slurm_mutex_lock(&step_complete.lock);
 
-	/* wait an extra 3 seconds for every level of tree below this level */
 	if (step_complete.bits && (step_complete.children > 0)) {
-		ts.tv_sec += 3 * (step_complete.max_depth-step_complete.depth);
-		ts.tv_sec += time(NULL) + REVERSE_TREE_CHILDREN_TIMEOUT;
+		ts.tv_sec = time(NULL) + _children_timeout();
 
 		while((left = bit_clear_count(step_complete.bits)) > 0) {
 			debug3("Rank %d waiting for %d (of %d) children",
@@ -734,9 +758,14 @@ _one_step_complete_msg(stepd_step_rec_t *step, int first, int last)
 		msg.step_rc = SIG_OOM;
 	else
 		msg.step_rc = step_complete.step_rc;
-	msg.jobacct = jobacctinfo_create(NULL);
 	/************* acct stuff ********************/
+	/*
+	 * Only the first message carries the aggregate for this subtree, any
+	 * further ranges are sent without accounting instead of with an empty
+	 * record of every TRES array.
+	 */
 	if (!acct_sent) {
+		msg.jobacct = jobacctinfo_create(NULL);
 		/*
 		 * No need to call _local_jobaccinfo_aggregate, step->jobacct
 		 * already has the modified total for this node in the step.
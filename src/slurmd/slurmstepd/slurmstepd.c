@@ -828,9 +828,52 @@ static void _set_job_log_prefix(slurm_step_id_t *step_id)
 	log_set_prefix(&buf);
 }
 
+/* Init plugins needed to unpack the launch request */
+static void _init_unpack_plugins(void)
+{
+	static bool loaded = false;
+
+	if (loaded)
+		return;
+	loaded = true;
+
+	/* Init switch before unpack_msg to only init the default */
+	if (switch_g_init(true) != SLURM_SUCCESS)
+		fatal("failed to initialize switch plugin");
+
+	if (cred_g_init() != SLURM_SUCCESS)
+		fatal("failed to initialize credential plugin");
+
+	if (gres_init() != SLURM_SUCCESS)
+		fatal("failed to initialize gres plugins");
+}
+
+static void _init_plugins(void)
+{
+	static bool loaded = false;
+
+	if (loaded)
+		return;
+	loaded = true;
+
+	if ((auth_g_init() != SLURM_SUCCESS) ||
+	    (cgroup_g_init() != SLURM_SUCCESS) ||
+	    (hash_g_init() != SLURM_SUCCESS) ||
+	    (acct_gather_conf_init() != SLURM_SUCCESS) ||
+	    (prep_g_init(NULL) != SLURM_SUCCESS) ||
+	    (proctrack_g_init() != SLURM_SUCCESS) ||
+	    (task_g_init() != SLURM_SUCCESS) ||
+	    (jobacct_gather_init() != SLURM_SUCCESS) ||
+	    (acct_gather_profile_init() != SLURM_SUCCESS) ||
+	    (job_container_init() != SLURM_SUCCESS) ||
+	    (topology_g_init() != SLURM_SUCCESS))
+		fatal("Couldn't load all plugins");
+}
+
 /*
  *  This function handles the initialization information from slurmd
- *  sent by _send_slurmstepd_init() in src/slurmd/slurmd/req.c.
+ *  sent by _send_slurmstepd_conf() and _send_slurmstepd_init() in
+ *  src/slurmd/slurmd/req.c.
  */
 static int
 _init_from_slurmd(int sock, char **argv, slurm_addr_t **_cli,
@@ -840,6 +883,7 @@ _init_from_slurmd(int sock, char **argv, slurm_addr_t **_cli,
 	buf_t *buffer;
 	int step_type;
 	int len;
+	int pooled = 0;
 	uint16_t proto;
 	slurm_addr_t *cli = NULL;
 	slurm_msg_t *msg = NULL;
@@ -871,8 +915,34 @@ _init_from_slurmd(int sock, char **argv, slurm_addr_t **_cli,
 	/* receive conf_hashtbl from slurmd */
 	read_conf_recv_stepd(sock);
 
+	/* receive whether to wait in the slurmd's pool */
+	safe_read(sock, &pooled, sizeof(int));
+
 	/* receive job type from slurmd */
-	safe_read(sock, &step_type, sizeof(int));
+	if (pooled) {
+		ssize_t rc;
+
+		/*
+		 * Load the plugins now so only the step specific setup is left
+		 * once slurmd hands a launch to this slurmstepd. slurmd closes
+		 * the pipe to retire an idle slurmstepd.
+		 */
+		setproctitle("[pool]");
+		_init_unpack_plugins();
+		_init_plugins();
+
+		while (((rc = read(sock, &step_type, sizeof(int))) < 0) &&
+		       (errno == EINTR))
+			;
+		if (!rc) {
+			debug("%s: retired from slurmd pool", __func__);
+			exit(0);
+		}
+		if (rc != sizeof(int))
+			goto rwfail;
+	} else {
+		safe_read(sock, &step_type, sizeof(int));
+	}
 	debug3("step_type = %d", step_type);
 
 	/* receive reverse-tree info from slurmd */
@@ -938,15 +1008,7 @@ _init_from_slurmd(int sock, char **argv, slurm_addr_t **_cli,
 		break;
 	}
 
-	/* Init switch before unpack_msg to only init the default */
-	if (switch_g_init(true) != SLURM_SUCCESS)
-		fatal("failed to initialize switch plugin");
-
-	if (cred_g_init() != SLURM_SUCCESS)
-		fatal("failed to initialize credential plugin");
-
-	if (gres_init() != SLURM_SUCCESS)
-		fatal("failed to initialize gres plugins");
+	_init_unpack_plugins();
 
 	if (unpack_msg(msg, buffer) == SLURM_ERROR)
 		fatal("slurmstepd: we didn't unpack the request correctly");
@@ -985,18 +1047,7 @@ _init_from_slurmd(int sock, char **argv, slurm_addr_t **_cli,
 	/*
 	 * Init all plugins after receiving the slurm.conf from the slurmd.
 	 */
-	if ((auth_g_init() != SLURM_SUCCESS) ||
-	    (cgroup_g_init() != SLURM_SUCCESS) ||
-	    (hash_g_init() != SLURM_SUCCESS) ||
-	    (acct_gather_conf_init() != SLURM_SUCCESS) ||
-	    (prep_g_init(NULL) != SLURM_SUCCESS) ||
-	    (proctrack_g_init() != SLURM_SUCCESS) ||
-	    (task_g_init() != SLURM_SUCCESS) ||
-	    (jobacct_gather_init() != SLURM_SUCCESS) ||
-	    (acct_gather_profile_init() != SLURM_SUCCESS) ||
-	    (job_container_init() != SLURM_SUCCESS) ||
-	    (topology_g_init() != SLURM_SUCCESS))
-		fatal("Couldn't load all plugins");
+	_init_plugins();
 
 	/*
 	 * Receive all secondary conf files from the slurmd.
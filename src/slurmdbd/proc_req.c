@@ -47,6 +47,7 @@
 #include "src/interfaces/auth.h"
 #include "src/interfaces/gres.h"
 #include "src/common/macros.h"
+#include "src/common/metrics.h"
 #include "src/common/pack.h"
 #include "src/common/slurmdbd_defs.h"
 #include "src/common/slurmdbd_pack.h"
@@ -73,6 +74,8 @@ static int   _find_rpc_obj_in_list(void *x, void *key);
 static void _process_job_start(slurmdbd_conn_t *slurmdbd_conn,
 			       dbd_job_start_msg_t *job_start_msg,
 			       dbd_id_rc_msg_t *id_rc_msg);
+static int _proc_req(slurmdbd_conn_t *slurmdbd_conn, persist_msg_t *msg,
+		     buf_t **out_buffer, bool in_mult_msg);
 
 /*
  * _validate_slurm_user - validate that the uid is authorized to see
@@ -1095,6 +1098,34 @@ static int _get_instances(slurmdbd_conn_t *slurmdbd_conn, persist_msg_t *msg,
 	return rc;
 }
 
+typedef struct {
+	buf_t *buffer;
+	int rc;
+	uint16_t rpc_version;
+} pack_jobs_args_t;
+
+/*
+ * Pack a job record and let list_delete_all() free it, so the job list
+ * shrinks while the response buffer grows instead of both being held at
+ * full size.
+ */
+static int _pack_and_free_job(void *x, void *arg)
+{
+	pack_jobs_args_t *args = arg;
+
+	if (args->rc != SLURM_SUCCESS)
+		return 0;
+
+	slurmdb_pack_job_rec(x, args->rpc_version, args->buffer);
+	if (size_buf(args->buffer) > REASONABLE_BUF_SIZE) {
+		error("%s: size limit exceeded", __func__);
+		args->rc = ESLURM_RESULT_TOO_LARGE;
+		return 0;
+	}
+
+	return 1;
+}
+
 static int _get_jobs_cond(slurmdbd_conn_t *slurmdbd_conn, persist_msg_t *msg,
 			  buf_t **out_buffer)
 {
@@ -1145,12 +1176,27 @@ static int _get_jobs_cond(slurmdbd_conn_t *slurmdbd_conn, persist_msg_t *msg,
 		job_cond);
 
 	if (!errno) {
-		if (!list_msg.my_list)
-			list_msg.my_list = list_create(NULL);
-		*out_buffer = init_buf(1024);
+		/* Same layout as slurmdbd_pack_list_msg() for DBD_GOT_JOBS */
+		pack_jobs_args_t args = {
+			.rc = SLURM_SUCCESS,
+			.rpc_version = slurmdbd_conn->conn->version,
+		};
+		uint32_t header_position;
+
+		*out_buffer = args.buffer = init_buf(1024);
 		pack16((uint16_t) DBD_GOT_JOBS, *out_buffer);
-		slurmdbd_pack_list_msg(&list_msg, slurmdbd_conn->conn->version,
-				       DBD_GOT_JOBS, *out_buffer);
+		header_position = get_buf_offset(args.buffer);
+		pack32(list_count(list_msg.my_list), *out_buffer);
+		if (list_msg.my_list)
+			(void) list_delete_all(list_msg.my_list,
+					       _pack_and_free_job, &args);
+		if (args.rc != SLURM_SUCCESS) {
+			/* rewind buffer, pack NO_VAL as count instead */
+			set_buf_offset(args.buffer, header_position);
+			pack32(NO_VAL, *out_buffer);
+			list_msg.return_code = args.rc;
+		}
+		pack32(list_msg.return_code, *out_buffer);
 	} else {
 		*out_buffer = slurm_persist_make_rc_msg(slurmdbd_conn->conn,
 							errno,
@@ -3104,6 +3150,307 @@ end_it:
 	return rc;
 }
 
+/* Process item inx of a multi message on the given (worker) connection */
+typedef void (*mult_proc_f)(slurmdbd_conn_t *slurmdbd_conn, int inx,
+			    void *arg);
+
+typedef struct {
+	slurmdbd_conn_t conn; /* copy of the parent with a worker db_conn */
+	persist_conn_t persist_conn; /* copy so flags are never shared */
+	int *inx;
+	int cnt;
+	mult_proc_f proc;
+	void *arg;
+	pthread_t tid;
+} mult_worker_t;
+
+typedef struct {
+	persist_msg_t msg;
+	bool unpacked;
+	int rc;
+	buf_t *ret_buf;
+} mult_msg_item_t;
+
+typedef struct {
+	dbd_job_start_msg_t **job_start_msgs;
+	dbd_id_rc_msg_t **id_rc_msgs;
+} mult_job_start_args_t;
+
+/*
+ * Open the extra database connections used to process multi messages in
+ * parallel. Only done for registered slurmctld connections, as unregistered
+ * ones register themselves while handling job messages.
+ * RET number of worker connections available, 0 to process sequentially
+ */
+static int _get_worker_db_conns(slurmdbd_conn_t *slurmdbd_conn, int msg_cnt)
+{
+	int threads = slurmdbd_conf->mult_msg_threads;
+
+	if ((threads <= 1) || (msg_cnt < 2) || !slurmdbd_conn->conn->rem_port)
+		return 0;
+
+	if (slurmdbd_conn->worker_db_conn_cnt >= threads)
+		return threads;
+
+	xrecalloc(slurmdbd_conn->worker_db_conns, threads,
+		  sizeof(*slurmdbd_conn->worker_db_conns));
+	while (slurmdbd_conn->worker_db_conn_cnt < threads) {
+		void *db_conn;
+
+		errno = 0;
+		db_conn = acct_storage_g_get_connection(
+			slurmdbd_conn->conn->fd, NULL, true,
+			slurmdbd_conn->conn->cluster_name);
+		if (!db_conn || errno) {
+			error("CONN:%d unable to open worker database connection, processing multi messages sequentially",
+			      slurmdbd_conn->conn->fd);
+			acct_storage_g_close_connection(&db_conn);
+			break;
+		}
+		slurmdbd_conn->worker_db_conns[
+			slurmdbd_conn->worker_db_conn_cnt++] = db_conn;
+	}
+
+	if (slurmdbd_conn->worker_db_conn_cnt < 2)
+		return 0;
+
+	return slurmdbd_conn->worker_db_conn_cnt;
+}
+
+extern void proc_req_close_worker_db_conns(slurmdbd_conn_t *slurmdbd_conn)
+{
+	for (int i = 0; i < slurmdbd_conn->worker_db_conn_cnt; i++)
+		acct_storage_g_close_connection(
+			&slurmdbd_conn->worker_db_conns[i]);
+	xfree(slurmdbd_conn->worker_db_conns);
+	slurmdbd_conn->worker_db_conn_cnt = 0;
+}
+
+static void *_mult_worker(void *x)
+{
+	mult_worker_t *worker = x;
+
+	for (int i = 0; i < worker->cnt; i++)
+		worker->proc(&worker->conn, worker->inx[i], worker->arg);
+
+	/*
+	 * Each worker is its own transaction. Commit now so the messages
+	 * processed after this run, on any connection, see the changes.
+	 */
+	acct_storage_g_commit(worker->conn.db_conn, 1);
+
+	return NULL;
+}
+
+/*
+ * Process the items listed in run[] on worker_cnt database connections.
+ * Items with the same key (job id) go to the same worker in their original
+ * order, so per job ordering is kept.
+ */
+static void _proc_mult_parallel(slurmdbd_conn_t *slurmdbd_conn, int worker_cnt,
+				int *run, uint32_t *keys, int run_cnt,
+				mult_proc_f proc, void *arg)
+{
+	mult_worker_t *workers = xcalloc(worker_cnt, sizeof(*workers));
+
+	for (int i = 0; i < worker_cnt; i++) {
+		mult_worker_t *worker = &workers[i];
+
+		worker->persist_conn = *slurmdbd_conn->conn;
+		worker->conn.conn = &worker->persist_conn;
+		worker->conn.db_conn = slurmdbd_conn->worker_db_conns[i];
+		worker->conn.tres_str = slurmdbd_conn->tres_str;
+		worker->inx = xcalloc(run_cnt, sizeof(*worker->inx));
+		worker->proc = proc;
+		worker->arg = arg;
+	}
+
+	for (int i = 0; i < run_cnt; i++) {
+		mult_worker_t *worker = &workers[keys[i] % worker_cnt];
+
+		worker->inx[worker->cnt++] = run[i];
+	}
+
+	/* The calling thread handles the first worker itself */
+	for (int i = 1; i < worker_cnt; i++)
+		if (workers[i].cnt)
+			slurm_thread_create(&workers[i].tid, _mult_worker,
+					    &workers[i]);
+	if (workers[0].cnt)
+		(void) _mult_worker(&workers[0]);
+
+	for (int i = 0; i < worker_cnt; i++) {
+		if (workers[i].tid)
+			slurm_thread_join(workers[i].tid);
+		xfree(workers[i].inx);
+	}
+	xfree(workers);
+}
+
+/*
+ * Messages about a single job can be processed in parallel with messages
+ * about other jobs. Everything else is processed in order on the main
+ * connection, once all previous messages are done.
+ * RET true and set job_id if msg can be processed in parallel
+ */
+static bool _mult_msg_job_id(persist_msg_t *msg, uint32_t *job_id)
+{
+	switch (msg->msg_type) {
+	case DBD_JOB_START:
+		*job_id = ((dbd_job_start_msg_t *) msg->data)->job_id;
+		return true;
+	case DBD_JOB_COMPLETE:
+		*job_id = ((dbd_job_comp_msg_t *) msg->data)->job_id;
+		return true;
+	case DBD_JOB_SUSPEND:
+		*job_id = ((dbd_job_suspend_msg_t *) msg->data)->job_id;
+		return true;
+	case DBD_STEP_START:
+		*job_id = ((dbd_step_start_msg_t *) msg->data)->step_id.job_id;
+		return true;
+	case DBD_STEP_COMPLETE:
+		*job_id = ((dbd_step_comp_msg_t *) msg->data)->step_id.job_id;
+		return true;
+	default:
+		return false;
+	}
+}
+
+static void _proc_mult_msg_item(slurmdbd_conn_t *slurmdbd_conn, int inx,
+				void *arg)
+{
+	mult_msg_item_t *item = &((mult_msg_item_t *) arg)[inx];
+
+	item->rc = _proc_req(slurmdbd_conn, &item->msg, &item->ret_buf, true);
+}
+
+static void _proc_mult_job_start(slurmdbd_conn_t *slurmdbd_conn, int inx,
+				 void *arg)
+{
+	mult_job_start_args_t *args = arg;
+
+	_process_job_start(slurmdbd_conn, args->job_start_msgs[inx],
+			   args->id_rc_msgs[inx]);
+}
+
+static void _send_mult_job_start_parallel(slurmdbd_conn_t *slurmdbd_conn,
+					  list_t *job_start_list,
+					  list_t *ret_list, int worker_cnt)
+{
+	int cnt = list_count(job_start_list), i = 0;
+	mult_job_start_args_t args = {
+		.job_start_msgs = xcalloc(cnt, sizeof(*args.job_start_msgs)),
+		.id_rc_msgs = xcalloc(cnt, sizeof(*args.id_rc_msgs)),
+	};
+	int *run = xcalloc(cnt, sizeof(*run));
+	uint32_t *keys = xcalloc(cnt, sizeof(*keys));
+	list_itr_t *itr = list_iterator_create(job_start_list);
+	dbd_job_start_msg_t *job_start_msg;
+
+	while ((job_start_msg = list_next(itr))) {
+		args.job_start_msgs[i] = job_start_msg;
+		args.id_rc_msgs[i] = xmalloc(sizeof(dbd_id_rc_msg_t));
+		list_append(ret_list, args.id_rc_msgs[i]);
+		run[i] = i;
+		keys[i] = job_start_msg->job_id;
+		i++;
+	}
+	list_iterator_destroy(itr);
+
+	_proc_mult_parallel(slurmdbd_conn, worker_cnt, run, keys, cnt,
+			    _proc_mult_job_start, &args);
+
+	xfree(args.job_start_msgs);
+	xfree(args.id_rc_msgs);
+	xfree(run);
+	xfree(keys);
+}
+
+/*
+ * Process a DBD_SEND_MULT_MSG with job messages spread over worker
+ * connections. A message that is not about a job waits for all previous
+ * ones to finish and is processed on the main connection, as is the reply to
+ * the first message that fails.
+ */
+static void _send_mult_msg_parallel(slurmdbd_conn_t *slurmdbd_conn,
+				    list_t *req_list, list_t *ret_list,
+				    int worker_cnt)
+{
+	int cnt = list_count(req_list), done = 0, run_cnt = 0;
+	mult_msg_item_t *items = xcalloc(cnt, sizeof(*items));
+	int *run = xcalloc(cnt, sizeof(*run));
+	uint32_t *keys = xcalloc(cnt, sizeof(*keys));
+	bool main_dirty = false;
+	list_itr_t *itr = list_iterator_create(req_list);
+	buf_t *req_buf;
+
+	while ((req_buf = list_next(itr))) {
+		mult_msg_item_t *item = &items[done++];
+		uint32_t job_id;
+
+		item->rc = slurm_persist_conn_process_msg(
+			slurmdbd_conn->conn, &item->msg,
+			get_buf_data(req_buf), size_buf(req_buf),
+			&item->ret_buf, 0);
+		if (item->rc != SLURM_SUCCESS)
+			break;
+		item->unpacked = true;
+
+		if (_mult_msg_job_id(&item->msg, &job_id)) {
+			keys[run_cnt] = job_id;
+			run[run_cnt++] = (done - 1);
+			continue;
+		}
+
+		if (run_cnt) {
+			if (main_dirty) {
+				acct_storage_g_commit(slurmdbd_conn->db_conn,
+						      1);
+				main_dirty = false;
+			}
+			_proc_mult_parallel(slurmdbd_conn, worker_cnt, run,
+					    keys, run_cnt, _proc_mult_msg_item,
+					    items);
+			run_cnt = 0;
+		}
+
+		item->rc = _proc_req(slurmdbd_conn, &item->msg, &item->ret_buf,
+				     true);
+		main_dirty = true;
+		if (item->rc != SLURM_SUCCESS)
+			break;
+	}
+	list_iterator_destroy(itr);
+
+	if (run_cnt) {
+		if (main_dirty)
+			acct_storage_g_commit(slurmdbd_conn->db_conn, 1);
+		_proc_mult_parallel(slurmdbd_conn, worker_cnt, run, keys,
+				    run_cnt, _proc_mult_msg_item, items);
+	}
+
+	/* Reply in order up to and including the first failure */
+	for (int i = 0; i < done; i++) {
+		mult_msg_item_t *item = &items[i];
+
+		if (item->ret_buf) {
+			list_append(ret_list, item->ret_buf);
+			item->ret_buf = NULL;
+		}
+		if (item->rc != SLURM_SUCCESS)
+			break;
+	}
+
+	for (int i = 0; i < done; i++) {
+		if (items[i].unpacked)
+			slurmdbd_free_msg(&items[i].msg);
+		FREE_NULL_BUFFER(items[i].ret_buf);
+	}
+	xfree(items);
+	xfree(run);
+	xfree(keys);
+}
+
 static int _send_mult_job_start(slurmdbd_conn_t *slurmdbd_conn,
 				persist_msg_t *msg, buf_t **out_buffer)
 {
@@ -3113,6 +3460,7 @@ static int _send_mult_job_start(slurmdbd_conn_t *slurmdbd_conn,
 	list_itr_t *itr = NULL;
 	dbd_job_start_msg_t *job_start_msg;
 	dbd_id_rc_msg_t *id_rc_msg;
+	int worker_cnt;
 	/* DEF_TIMERS; */
 
 	if (!_validate_slurm_user(slurmdbd_conn)) {
@@ -3127,6 +3475,12 @@ static int _send_mult_job_start(slurmdbd_conn_t *slurmdbd_conn,
 
 	list_msg.my_list = list_create(slurmdbd_free_id_rc_msg);
 	/* START_TIMER; */
+	if ((worker_cnt = _get_worker_db_conns(slurmdbd_conn,
+					       list_count(get_msg->my_list)))) {
+		_send_mult_job_start_parallel(slurmdbd_conn, get_msg->my_list,
+					      list_msg.my_list, worker_cnt);
+		goto pack;
+	}
 	itr = list_iterator_create(get_msg->my_list);
 	while ((job_start_msg = list_next(itr))) {
 	        id_rc_msg = xmalloc(sizeof(dbd_id_rc_msg_t));
@@ -3135,6 +3489,7 @@ static int _send_mult_job_start(slurmdbd_conn_t *slurmdbd_conn,
 		_process_job_start(slurmdbd_conn, job_start_msg, id_rc_msg);
 	}
 	list_iterator_destroy(itr);
+pack:
 	/* END_TIMER; */
 	/* info("%d multi job took %s", */
 	/*      list_count(get_msg->my_list), TIME_STR); */
@@ -3156,7 +3511,7 @@ static int _send_mult_msg(slurmdbd_conn_t *slurmdbd_conn, persist_msg_t *msg,
 	char *comment = NULL;
 	list_itr_t *itr = NULL;
 	buf_t *req_buf = NULL, *ret_buf = NULL;
-	int rc = SLURM_SUCCESS;
+	int rc = SLURM_SUCCESS, worker_cnt;
 	/* DEF_TIMERS; */
 
 	if (!_validate_slurm_user(slurmdbd_conn)) {
@@ -3171,6 +3526,12 @@ static int _send_mult_msg(slurmdbd_conn_t *slurmdbd_conn, persist_msg_t *msg,
 
 	list_msg.my_list = list_create(slurmdbd_free_buffer);
 	/* START_TIMER; */
+	if ((worker_cnt = _get_worker_db_conns(slurmdbd_conn,
+					       list_count(get_msg->my_list)))) {
+		_send_mult_msg_parallel(slurmdbd_conn, get_msg->my_list,
+					list_msg.my_list, worker_cnt);
+		goto pack;
+	}
 	itr = list_iterator_create(get_msg->my_list);
 	while ((req_buf = list_next(itr))) {
 		persist_msg_t sub_msg;
@@ -3183,7 +3544,8 @@ static int _send_mult_msg(slurmdbd_conn_t *slurmdbd_conn, persist_msg_t *msg,
 			size_buf(req_buf), &ret_buf, 0);
 
 		if (rc == SLURM_SUCCESS) {
-			rc = proc_req(slurmdbd_conn, &sub_msg, &ret_buf);
+			rc = _proc_req(slurmdbd_conn, &sub_msg, &ret_buf,
+				       true);
 			slurmdbd_free_msg(&sub_msg);
 		}
 
@@ -3193,6 +3555,7 @@ static int _send_mult_msg(slurmdbd_conn_t *slurmdbd_conn, persist_msg_t *msg,
 			break;
 	}
 	list_iterator_destroy(itr);
+pack:
 	/* END_TIMER; */
 	/* info("%d multi took %s", list_count(get_msg->my_list), TIME_STR); */
 
@@ -3449,9 +3812,13 @@ static int _shutdown(slurmdbd_conn_t *slurmdbd_conn, persist_msg_t *msg,
  * buffer OUT - outgoing response, must be freed by caller
  * uid IN/OUT - user ID who initiated the RPC
  * RET SLURM_SUCCESS or error code */
-extern int proc_req(void *conn, persist_msg_t *msg, buf_t **out_buffer)
+/*
+ * in_mult_msg IN - msg is part of a DBD_SEND_MULT_MSG, leave the commit to
+ *	the enclosing request so the whole batch is one transaction.
+ */
+static int _proc_req(slurmdbd_conn_t *slurmdbd_conn, persist_msg_t *msg,
+		     buf_t **out_buffer, bool in_mult_msg)
 {
-	slurmdbd_conn_t *slurmdbd_conn = conn;
 	int rc = SLURM_SUCCESS;
 	char *comment = NULL;
 	slurmdb_rpc_obj_t *rpc_obj;
@@ -3728,7 +4095,7 @@ extern int proc_req(void *conn, persist_msg_t *msg, buf_t **out_buffer)
 		      slurmdbd_conn->conn->fd,
 		      slurmdbd_msg_type_2_str(msg->msg_type, 1));
 	else if (slurmdbd_conn->conn->rem_port &&
-		 (!slurmdbd_conf->commit_delay ||
+		 ((!slurmdbd_conf->commit_delay && !in_mult_msg) ||
 		  (msg->msg_type == DBD_REGISTER_CTLD))) {
 		/* If we are dealing with the slurmctld do the
 		   commit (SUCCESS or NOT) afterwards since we
@@ -3770,5 +4137,13 @@ extern int proc_req(void *conn, persist_msg_t *msg, buf_t **out_buffer)
 
 	slurm_mutex_unlock(&rpc_mutex);
 
+	metric_add(rpc_cnt_metric, 1);
+	metric_add(rpc_usec_metric, DELTA_TIMER);
+
 	return rc;
 }
+
+extern int proc_req(void *conn, persist_msg_t *msg, buf_t **out_buffer)
+{
+	return _proc_req(conn, msg, out_buffer, false);
+}
@@ -49,6 +49,8 @@ typedef struct {
 	pthread_mutex_t conn_send_lock;
 	void *db_conn; /* database connection */
 	char *tres_str;
+	void **worker_db_conns; /* extra connections for multi messages */
+	int worker_db_conn_cnt;
 } slurmdbd_conn_t;
 
 /* Process an incoming RPC
@@ -61,4 +63,7 @@ typedef struct {
  * RET SLURM_SUCCESS or error code */
 extern int proc_req(void *conn, persist_msg_t *msg, buf_t **out_buffer);
 
+/* Close the worker database connections used for multi messages */
+extern void proc_req_close_worker_db_conns(slurmdbd_conn_t *slurmdbd_conn);
+
 #endif /* !_PROC_REQ */
@@ -399,11 +399,23 @@ extern int read_slurmdbd_conf(void)
 			warning("MessageTimeout is too high for effective fault-tolerance");
 
 		s_p_get_string(&slurmdbd_conf->parameters, "Parameters", tbl);
+		slurmdbd_conf->mult_msg_threads = 1;
 		if (slurmdbd_conf->parameters) {
 			if (xstrcasestr(slurmdbd_conf->parameters,
 					"PreserveCaseUser"))
 				slurmdbd_conf->persist_conn_rc_flags |=
 					PERSIST_FLAG_P_USER_CASE;
+			if ((temp_str = xstrcasestr(slurmdbd_conf->parameters,
+						    "mult_msg_threads="))) {
+				long tmp_val = strtol(temp_str + 17, NULL, 10);
+				if ((tmp_val >= 1) &&
+				    (tmp_val <= MAX_MULT_MSG_THREADS))
+					slurmdbd_conf->mult_msg_threads =
+						tmp_val;
+				else
+					error("Parameters option mult_msg_threads=%ld is invalid, ignored",
+					      tmp_val);
+			}
 		}
 
 		s_p_get_string(&slurmdbd_conf->pid_file, "PidFile", tbl);
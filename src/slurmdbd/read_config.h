@@ -60,6 +60,9 @@
 #define DBD_CONF_FLAG_ALL_RES_ABS SLURM_BIT(1)
 #define DBD_CONF_FLAG_DISABLE_COORD_DBD SLURM_BIT(2)
 
+/* Max database connections used to process one multi message */
+#define MAX_MULT_MSG_THREADS 64
+
 /* SlurmDBD configuration parameters */
 typedef struct {
 	char *		archive_dir;    /* location to locally store
@@ -78,6 +81,8 @@ typedef struct {
 	uint32_t flags;			/* Various flags see DBD_CONF_FLAG_* */
 	char *		log_file;	/* Log file			*/
 	uint32_t	max_time_range;	/* max time range for user queries */
+	uint16_t	mult_msg_threads; /* database connections used to
+					   * process one multi message */
 	char *		parameters;	/* parameters to change behavior with
 					 * the slurmdbd directly	*/
 	uint16_t        persist_conn_rc_flags; /* flags to be sent back on any
@@ -174,6 +174,7 @@ static void _connection_fini_callback(void *arg)
 		acct_storage_g_commit(conn->db_conn, 1);
 	}
 
+	proc_req_close_worker_db_conns(conn);
 	acct_storage_g_close_connection(&conn->db_conn);
 
 	if (stay_locked)
@@ -56,6 +56,7 @@
 #include "src/common/daemonize.h"
 #include "src/common/fd.h"
 #include "src/common/log.h"
+#include "src/common/metrics.h"
 #include "src/common/proc_args.h"
 #include "src/common/read_config.h"
 #include "src/interfaces/accounting_storage.h"
@@ -89,6 +90,8 @@ list_t *registered_clusters = NULL;
 pthread_mutex_t rpc_mutex = PTHREAD_MUTEX_INITIALIZER;
 slurmdb_stats_rec_t rpc_stats;
 pthread_mutex_t registered_lock = PTHREAD_MUTEX_INITIALIZER;
+uint64_t *rpc_cnt_metric = NULL;
+uint64_t *rpc_usec_metric = NULL;
 
 /* Local variables */
 static int    debug_level = 0;		/* incremented for -v on command line */
@@ -234,6 +237,14 @@ int main(int argc, char **argv)
 
 	conmgr_init(0, 0, (conmgr_callbacks_t) {0});
 
+	rpc_cnt_metric = metric_register("rpcs", NULL, METRIC_COUNTER,
+					 "RPCs processed");
+	rpc_usec_metric = metric_register("rpc_usec", NULL, METRIC_COUNTER,
+					  "Time spent processing RPCs");
+	if (slurmdbd_conf->parameters)
+		(void) conmgr_metrics_listen(slurmdbd_conf->parameters,
+					     "slurmdbd");
+
 	conmgr_add_work_fifo(_run, &args);
 	_register_signal_handlers();
 
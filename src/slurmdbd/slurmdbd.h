@@ -45,6 +45,8 @@ extern pthread_mutex_t registered_lock;
 extern list_t *registered_clusters;
 extern pthread_mutex_t rpc_mutex;
 extern slurmdb_stats_rec_t rpc_stats;
+extern uint64_t *rpc_cnt_metric;
+extern uint64_t *rpc_usec_metric;
 
 extern void shutdown_threads(void);
 
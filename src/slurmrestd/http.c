@@ -73,7 +73,7 @@ typedef struct {
 	list_t *headers;
 	/* state tracking of last header received */
 	char *last_header;
-	/* client requested to keep_alive header or -1 to disable */
+	/* client requested keep_alive seconds or 0 if not requested */
 	int keep_alive;
 	/* RFC7230-6.1 "Connection: Close" */
 	bool connection_close;
@@ -225,6 +225,31 @@ static int _on_header_field(http_parser *parser, const char *at, size_t length)
 	return 0;
 }
 
+/* RFC7230-6.1 Connection header is a comma delimited list of options */
+static void _on_connection_header(request_t *request, const char *value)
+{
+	char *save_ptr = NULL, *tok, *options = xstrdup(value);
+
+	for (tok = strtok_r(options, ",", &save_ptr); tok;
+	     tok = strtok_r(NULL, ",", &save_ptr)) {
+		xstrtrim(tok);
+
+		if (!xstrcasecmp(tok, "Keep-Alive")) {
+			if (!request->keep_alive)
+				request->keep_alive = DEFAULT_KEEP_ALIVE;
+		} else if (!xstrcasecmp(tok, "Close")) {
+			request->connection_close = true;
+		} else {
+			log_flag(NET, "%s: [%s] ignoring unsupported connection option: %s",
+				 __func__,
+				 conmgr_fd_get_name(request->context->con),
+				 tok);
+		}
+	}
+
+	xfree(options);
+}
+
 static int _on_header_value(http_parser *parser, const char *at, size_t length)
 {
 	request_t *request = parser->data;
@@ -253,28 +278,20 @@ static int _on_header_value(http_parser *parser, const char *at, size_t length)
 
 	/* Watch for connection headers */
 	if (!xstrcasecmp(buffer->name, "Connection")) {
-		if (!xstrcasecmp(buffer->value, "Keep-Alive")) {
-			if (request->keep_alive == -1)
-				request->keep_alive = DEFAULT_KEEP_ALIVE;
-		} else if (!xstrcasecmp(buffer->value, "Close")) {
-			request->connection_close = true;
-		} else {
-			error("%s: [%s] ignoring unsupported header request: %s",
-			      __func__,
-			      conmgr_fd_get_name(request->context->con),
-			      buffer->value);
-		}
+		_on_connection_header(request, buffer->value);
 	} else if (!xstrcasecmp(buffer->name, "Keep-Alive")) {
-		int ibuffer = atoi(buffer->value);
-		//FIXME: figure out correct bounds!
-		if (ibuffer > 1) {
+		/* Only a hint: "Keep-Alive: timeout=5, max=100" */
+		const char *timeout = xstrcasestr(buffer->value, "timeout=");
+		int ibuffer = atoi(timeout ? (timeout + strlen("timeout=")) :
+				   buffer->value);
+
+		if (ibuffer > 0) {
 			request->keep_alive = ibuffer;
 		} else {
-			error("%s: [%s] invalid Keep-Alive value %s",
-			      __func__,
-			      conmgr_fd_get_name(request->context->con),
-			      buffer->value);
-			return 1;
+			log_flag(NET, "%s: [%s] ignoring invalid Keep-Alive value %s",
+				 __func__,
+				 conmgr_fd_get_name(request->context->con),
+				 buffer->value);
 		}
 	} else if (!xstrcasecmp(buffer->name, "Content-Type")) {
 		xfree(request->content_type);
@@ -330,15 +347,18 @@ static int _on_headers_complete(http_parser *parser)
 			 __func__,
 			 conmgr_fd_get_name(request->context->con));
 
-		/* 1.0 defaults to close w/o keep_alive */
-		if (!request->keep_alive)
-			request->connection_close = true;
+		/*
+		 * 1.0 defaults to close. Keep-Alive for 1.0 requires echoing
+		 * the Connection header in every response which is not done.
+		 */
+		request->keep_alive = 0;
+		request->connection_close = true;
 	} else if (parser->http_major == 1 && parser->http_minor == 1) {
 		log_flag(NET, "%s: [%s] HTTP/1.1 connection",
 			 __func__, conmgr_fd_get_name(request->context->con));
 
 		/* keep alive is assumed for 1.1 */
-		if (request->keep_alive == -1)
+		if (!request->keep_alive && !request->connection_close)
 			request->keep_alive = DEFAULT_KEEP_ALIVE;
 	} else {
 		error("%s: [%s] unsupported HTTP/%d.%d",
@@ -556,13 +576,19 @@ extern int send_http_response(const send_http_response_args_t *args)
 		if ((rc = conmgr_queue_write_data(args->con, args->body,
 						  args->body_length)))
 			return rc;
-	} else if (((args->status_code >= 100) && (args->status_code < 200)) ||
-		   (args->status_code == 204) ||
-		   (args->status_code == 304)) {
+	} else {
 		/*
-		 * RFC2616 requires empty line after headers for return code
-		 * that "MUST NOT" include a message body
+		 * RFC7230-3.3.3 requires an explicit zero length for responses
+		 * without a body to keep pipelined responses delimited on
+		 * persistent connections.
 		 */
+		if ((args->status_code >= 200) && (args->status_code != 204) &&
+		    (args->status_code != 304) &&
+		    (rc = _write_fmt_num_header(args->con, "Content-Length",
+						0)))
+			return rc;
+
+		/* RFC2616 requires empty line after headers */
 		if ((rc = conmgr_queue_write_data(args->con, CRLF,
 						  strlen(CRLF))))
 			return rc;
@@ -590,15 +616,19 @@ static int _send_reject(const http_parser *parser,
 	if ((args.http_major == 0) && (args.http_minor == 0))
 		args.http_minor = 9;
 
+	if (request->connection_close ||
+	    ((parser->http_major == 1) && (parser->http_minor >= 1)) ||
+	     (parser->http_major > 1)) {
+		http_header_entry_t *close = xmalloc(sizeof(*close));
+		close->name = xstrdup("Connection");
+		close->value = xstrdup("Close");
+		list_append(args.headers, close);
+	}
+
 	/* Ignore response since this connection is already dead */
 	(void) send_http_response(&args);
 	FREE_NULL_LIST(args.headers);
 
-	if (request->connection_close ||
-	    ((parser->http_major == 1) && (parser->http_minor >= 1)) ||
-	     (parser->http_major > 1))
-		send_http_connection_close(request->context);
-
 	/* ensure connection gets closed */
 	(void) conmgr_queue_close_fd(request->context->con);
 
@@ -702,16 +732,12 @@ static int _on_message_complete(http_parser *parser)
 	if ((rc = _on_message_complete_request(parser, method, request)))
 		return rc;
 
-	if (request->keep_alive) {
-		//TODO: implement keep alive correctly
-		log_flag(NET, "%s: [%s] keep alive not currently implemented",
-			 __func__, conmgr_fd_get_name(request->context->con));
-	}
-
-	if (!request->connection_close) {
+	if (!request->connection_close && request->keep_alive) {
 		/*
 		 * Create a new HTTP request to allow persistent connections to
-		 * continue but without inheirting previous requests.
+		 * continue but without inheirting previous requests. Any
+		 * pipelined requests already in the input buffer will be
+		 * parsed by the same http_parser_execute() call.
 		 */
 		request_t *nrequest = xmalloc(sizeof(*request));
 		nrequest->magic = MAGIC_REQUEST_T;
@@ -721,9 +747,8 @@ static int _on_message_complete(http_parser *parser)
 		parser->data = nrequest;
 		_free_request_t(request);
 	} else {
-		/* Notify client that this connection will be closed now */
-		if (request->connection_close)
-			send_http_connection_close(request->context);
+		log_flag(NET, "%s: [%s] closing connection after response",
+			 __func__, conmgr_fd_get_name(request->context->con));
 
 		conmgr_queue_close_fd(request->context->con);
 
@@ -927,6 +952,61 @@ extern const char *find_http_header(list_t *headers, const char *name)
 		return NULL;
 }
 
+extern char *http_etag(const char *body, size_t body_length)
+{
+	/* 64-bit FNV-1a */
+	uint64_t hash = 0xcbf29ce484222325ULL;
+
+	for (size_t i = 0; i < body_length; i++) {
+		hash ^= (uint8_t) body[i];
+		hash *= 0x100000001b3ULL;
+	}
+
+	return xstrdup_printf("\"%016"PRIx64"\"", hash);
+}
+
+extern bool http_etag_matches(list_t *headers, const char *etag)
+{
+	const char *match = find_http_header(headers, "If-None-Match");
+	size_t etag_len;
+
+	if (!match || !etag)
+		return false;
+
+	etag_len = strlen(etag);
+
+	/* header is comma delimited list of (possibly weak) entity tags */
+	while (*match) {
+		const char *end;
+
+		while (isspace(*match) || (*match == ','))
+			match++;
+
+		if (*match == '*')
+			return true;
+
+		/* weak comparison is allowed for If-None-Match */
+		if (!strncmp(match, "W/", 2))
+			match += 2;
+
+		if (!(end = strchr(match, ',')))
+			end = match + strlen(match);
+
+		while ((end > match) && isspace(*(end - 1)))
+			end--;
+
+		if (((end - match) == etag_len) &&
+		    !strncmp(match, etag, etag_len))
+			return true;
+
+		match = end;
+		while (*match && (*match != ','))
+			match++;
+	}
+
+	return false;
+}
+
 extern http_context_t *setup_http_context(conmgr_fd_t *con,
 					  on_http_request_t on_http_request)
 {
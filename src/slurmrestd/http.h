@@ -99,6 +99,23 @@ extern void free_http_header(http_header_entry_t *);
  */
 extern const char *find_http_header(list_t *headers, const char *name);
 
+/*
+ * Generate strong entity tag for response body per RFC#7232 Section:2.3
+ * IN body response body
+ * IN body_length bytes in body
+ * RET quoted entity tag (caller must xfree)
+ */
+extern char *http_etag(const char *body, size_t body_length);
+
+/*
+ * Check if client If-None-Match header matches entity tag
+ * RFC#7232 Section:3.2
+ * IN headers List of http_header_entry_t from client
+ * IN etag quoted entity tag of current representation
+ * RET true if client already has current representation
+ */
+extern bool http_etag_matches(list_t *headers, const char *etag);
+
 /*
  * Call back for new connection to setup HTTP
  *
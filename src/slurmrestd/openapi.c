@@ -84,6 +84,7 @@ typedef struct {
 typedef struct {
 	const openapi_path_binding_method_t *bound;
 	entry_t *entries;
+	int entries_count; /* number of entries before the terminator */
 	http_request_method_t method;
 } entry_method_t;
 
@@ -99,6 +100,7 @@ typedef struct {
 
 typedef struct {
 	const data_t *dpath;
+	size_t dpath_count; /* number of entries in dpath */
 	path_t *path;
 	data_t *params;
 	http_request_method_t method;
@@ -652,6 +654,8 @@ extern int register_path_binding(const char *in_path,
 		}
 
 		for (; e->type; e++) {
+			t->entries_count++;
+
 			if (e->type == OPENAPI_PATH_ENTRY_MATCH_PARAMETER)
 				e->parameter =
 					data_parser_g_resolve_openapi_type(
@@ -817,8 +821,6 @@ static int _match_path_from_data(void *x, void *key)
 
 	args->path = path;
 	for (method = path->methods; method->entries; method++) {
-		int entries = 0;
-
 		if (get_log_level() >= LOG_LEVEL_DEBUG5) {
 			xfree(src_path);
 			src_path = _entry_to_string(method->entries);
@@ -833,14 +835,10 @@ static int _match_path_from_data(void *x, void *key)
 			continue;
 		}
 
-		for (args->entry = method->entries; args->entry->type;
-		     entries++, args->entry++)
-			/* do nothing */;
-
-		if (data_get_list_length(args->dpath) != entries) {
+		if (args->dpath_count != method->entries_count) {
 			debug5("%s: skip non-matching subdirectories: registered=%u requested=%zu ",
-			       __func__, entries,
-			       data_get_list_length(args->dpath));
+			       __func__, method->entries_count,
+			       args->dpath_count);
 			continue;
 		}
 
@@ -885,13 +883,18 @@ extern int find_path_tag(const data_t *dpath, data_t *params,
 	match_path_from_data_t args = {
 		.params = params,
 		.dpath = dpath,
+		.dpath_count = data_get_list_length(dpath),
 		.method = method,
 		.tag = -1,
 	};
 
 	xassert(data_get_type(params) == DATA_TYPE_DICT);
 
-	(void) list_find_first(paths, _match_path_from_data, &args);
+	/*
+	 * Paths are only added while binding at startup. Only take the read
+	 * lock so concurrent requests can be matched in parallel.
+	 */
+	(void) list_find_first_ro(paths, _match_path_from_data, &args);
 
 	return args.tag;
 }
@@ -492,6 +492,87 @@ static int _resolve_mime(on_http_request_args_t *args, const char **read_mime,
 	return SLURM_SUCCESS;
 }
 
+static data_for_each_cmd_t _add_field(const data_t *data, void *arg)
+{
+	data_t *fields = arg;
+	char *str = NULL, *tok, *save_ptr = NULL;
+
+	if (data_get_string_converted(data, &str))
+		return DATA_FOR_EACH_FAIL;
+
+	for (tok = strtok_r(str, ",", &save_ptr); tok;
+	     tok = strtok_r(NULL, ",", &save_ptr)) {
+		xstrtrim(tok);
+		if (tok[0])
+			data_set_null(data_key_set(fields, tok));
+	}
+
+	xfree(str);
+	return DATA_FOR_EACH_CONT;
+}
+
+/*
+ * Remove "fields" from query as a comma delimited list of fields (or list of
+ * lists) to keep in every returned object.
+ * RET dictionary of fields or NULL if all fields requested
+ */
+static data_t *_pop_fields(on_http_request_args_t *args, data_t *query)
+{
+	data_t *dfields, *fields;
+
+	if ((args->method != HTTP_REQUEST_GET) || !query ||
+	    (data_get_type(query) != DATA_TYPE_DICT) ||
+	    !(dfields = data_key_get(query, "fields")))
+		return NULL;
+
+	fields = data_set_dict(data_new());
+
+	if (data_get_type(dfields) == DATA_TYPE_LIST)
+		(void) data_list_for_each_const(dfields, _add_field, fields);
+	else
+		(void) _add_field(dfields, fields);
+
+	(void) data_key_unset(query, "fields");
+
+	if (!data_get_dict_length(fields))
+		FREE_NULL_DATA(fields);
+
+	return fields;
+}
+
+static data_for_each_cmd_t _project_field(const char *key, data_t *data,
+					  void *arg)
+{
+	const data_t *fields = arg;
+
+	if (!data_key_get_const(fields, key))
+		return DATA_FOR_EACH_DELETE;
+
+	return DATA_FOR_EACH_CONT;
+}
+
+static data_for_each_cmd_t _project_object(data_t *data, void *arg)
+{
+	if (data_get_type(data) == DATA_TYPE_DICT)
+		(void) data_dict_for_each(data, _project_field, arg);
+
+	return DATA_FOR_EACH_CONT;
+}
+
+static data_for_each_cmd_t _project_resp(const char *key, data_t *data,
+					 void *arg)
+{
+	/* never strip the common response fields */
+	if (!xstrcmp(key, "meta") || !xstrcmp(key, "errors") ||
+	    !xstrcmp(key, "warnings"))
+		return DATA_FOR_EACH_CONT;
+
+	if (data_get_type(data) == DATA_TYPE_LIST)
+		(void) data_list_for_each(data, _project_object, arg);
+
+	return DATA_FOR_EACH_CONT;
+}
+
 static int _call_handler(on_http_request_args_t *args, data_t *params,
 			 data_t *query, const openapi_path_binding_t *op_path,
 			 int callback_tag, const char *write_mime,
@@ -502,6 +583,7 @@ static int _call_handler(on_http_request_args_t *args, data_t *params,
 	data_t *resp = data_new();
 	char *body = NULL;
 	http_status_code_t e;
+	data_t *fields = _pop_fields(args, query);
 
 	xassert(op_path);
 	debug3("%s: [%s] BEGIN: calling ctxt handler: 0x%"PRIXPTR"[%d] for path: %s",
@@ -519,6 +601,9 @@ static int _call_handler(on_http_request_args_t *args, data_t *params,
 	 */
 	FREE_NULL_REST_AUTH(args->context->auth);
 
+	if (fields && (data_get_type(resp) == DATA_TYPE_DICT))
+		(void) data_dict_for_each(resp, _project_resp, fields);
+
 	if (data_get_type(resp) != DATA_TYPE_NULL) {
 		int rc2;
 		serializer_flags_t sflags = SER_FLAGS_PRETTY;
@@ -574,15 +659,40 @@ static int _call_handler(on_http_request_args_t *args, data_t *params,
 			.body = NULL,
 			.body_length = 0,
 		};
+		http_header_entry_t etag = {
+			.name = "ETag",
+		};
 
 		if (body) {
 			send_args.body = body;
 			send_args.body_length = strlen(body);
 			send_args.body_encoding = write_mime;
+
+			/*
+			 * RFC#7232 Section:2.3
+			 *
+			 * Tag the representation to allow clients to poll with
+			 * If-None-Match and only get the body when it changed
+			 */
+			etag.value = http_etag(body, send_args.body_length);
+			send_args.headers = list_create(NULL);
+			list_append(send_args.headers, &etag);
+
+			if ((args->method == HTTP_REQUEST_GET) &&
+			    http_etag_matches(args->headers, etag.value)) {
+				send_args.status_code =
+					HTTP_STATUS_CODE_REDIRECT_NOT_MODIFIED;
+				send_args.body = NULL;
+				send_args.body_length = 0;
+				send_args.body_encoding = NULL;
+			}
 		}
 
 		rc = send_http_response(&send_args);
 		e = send_args.status_code;
+
+		FREE_NULL_LIST(send_args.headers);
+		xfree(etag.value);
 	}
 
 	debug3("%s: [%s] END: calling handler: (0x%"PRIXPTR") callback_tag %d for path: %s rc[%d]=%s status[%d]=%s",
@@ -592,6 +702,7 @@ static int _call_handler(on_http_request_args_t *args, data_t *params,
 
 	xfree(body);
 	FREE_NULL_DATA(resp);
+	FREE_NULL_DATA(fields);
 
 	return rc;
 }
@@ -630,7 +741,7 @@ extern int operations_router(on_http_request_args_t *args)
 	 */
 	slurm_rwlock_rdlock(&paths_lock);
 
-	if (!(path = list_find_first(paths, _match_path_key, &path_tag)))
+	if (!(path = list_find_first_ro(paths, _match_path_key, &path_tag)))
 		fatal_abort("%s: found tag but missing path handler", __func__);
 	_check_path_magic(path);
 
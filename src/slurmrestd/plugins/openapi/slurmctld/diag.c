@@ -54,7 +54,7 @@ extern int op_handler_diag(openapi_ctxt_t *ctxt)
 	} else {
 		stats_info_response_msg_t *stats = NULL;
 		stats_info_request_msg_t req = {
-			.command_id = STAT_COMMAND_GET,
+			.command_id = STAT_COMMAND_HISTORY,
 		};
 
 		if ((rc = slurm_get_statistics(&stats, &req))) {
@@ -292,6 +292,72 @@ cleanup:
 	return rc;
 }
 
+/*
+ * Load the jobs of each user in params.user_list with one
+ * slurm_load_job_user() call per distinct user and merge the responses, so
+ * the controller only packs the jobs that will be reported.
+ */
+static int _load_job_users(job_info_msg_t **job_info_msg_pptr,
+			   uint16_t show_flags)
+{
+	job_info_msg_t *orig_msg = NULL, *new_msg = NULL;
+	uint32_t *uid_ptr, *uids;
+	uint32_t new_rec_cnt;
+	int uid_cnt = 0, rc = SLURM_SUCCESS;
+	list_itr_t *iter;
+
+	uids = xcalloc(list_count(params.user_list), sizeof(uint32_t));
+	iter = list_iterator_create(params.user_list);
+	while ((uid_ptr = list_next(iter))) {
+		int i;
+
+		for (i = 0; i < uid_cnt; i++) {
+			if (uids[i] == *uid_ptr)
+				break;
+		}
+		if (i < uid_cnt)
+			continue;	/* Duplicate user */
+		uids[uid_cnt++] = *uid_ptr;
+
+		if ((rc = slurm_load_job_user(&new_msg, *uid_ptr,
+					      show_flags)))
+			break;
+		if (!orig_msg) {
+			orig_msg = new_msg;
+			continue;
+		}
+
+		/* Merge job records into a single response message */
+		orig_msg->last_update = MIN(orig_msg->last_update,
+					    new_msg->last_update);
+		new_rec_cnt = orig_msg->record_count + new_msg->record_count;
+		if (new_msg->record_count) {
+			orig_msg->job_array =
+				xrealloc(orig_msg->job_array,
+					 sizeof(slurm_job_info_t) *
+					 new_rec_cnt);
+			(void) memcpy(orig_msg->job_array +
+				      orig_msg->record_count,
+				      new_msg->job_array,
+				      sizeof(slurm_job_info_t) *
+				      new_msg->record_count);
+			orig_msg->record_count = new_rec_cnt;
+		}
+		xfree(new_msg->job_array);
+		xfree(new_msg);
+	}
+	list_iterator_destroy(iter);
+	xfree(uids);
+
+	if (rc) {
+		slurm_free_job_info_msg(orig_msg);
+		orig_msg = NULL;
+	}
+	*job_info_msg_pptr = orig_msg;
+
+	return rc;
+}
+
 /* _print_job - print the specified job's information */
 static int _print_job(bool clear_old, bool log_cluster_name, int argc,
 		      char **argv)
@@ -325,6 +391,8 @@ static int _print_job(bool clear_old, bool log_cluster_name, int argc,
 			error_code = slurm_load_job_user(&new_job_ptr,
 							 params.user_id,
 							 show_flags);
+		} else if (params.user_list && list_count(params.user_list)) {
+			error_code = _load_job_users(&new_job_ptr, show_flags);
 		} else {
 			if (params.clusters)
 				show_flags |= SHOW_LOCAL;
@@ -346,6 +414,8 @@ static int _print_job(bool clear_old, bool log_cluster_name, int argc,
 	} else if (params.user_id) {
 		error_code = slurm_load_job_user(&new_job_ptr, params.user_id,
 						 show_flags);
+	} else if (params.user_list && list_count(params.user_list)) {
+		error_code = _load_job_users(&new_job_ptr, show_flags);
 	} else {
 		error_code = slurm_load_jobs((time_t) NULL, &new_job_ptr,
 					     show_flags);
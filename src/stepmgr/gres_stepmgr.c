@@ -2351,10 +2351,9 @@ static int _set_step_gres_bit_alloc(gres_step_state_t *gres_ss,
 			    gres_js->gres_bit_step_alloc[node_offset]);
 	}
 
-	for (int i = 0; i < len && gres_alloc; i++) {
-		if (!bit_test(gres_bit_avail, i) ||
-		    bit_test(gres_bit_alloc, i) ||
-		    !_cores_on_gres(core_bitmap, NULL, gres_ns, i, gres_js))
+	for (int i = 0; gres_alloc &&
+	     ((i = bit_ffs_from_bit(gres_bit_avail, i)) >= 0); i++) {
+		if (!_cores_on_gres(core_bitmap, NULL, gres_ns, i, gres_js))
 			continue;
 
 		if (gres_id_shared(gres_state_job->config_flags)) {
@@ -2704,7 +2703,7 @@ static int _step_dealloc(gres_state_t *gres_state_step, list_t *job_gres_list,
 	gres_step_state_t *gres_ss =
 		(gres_step_state_t *)gres_state_step->gres_data;
 	gres_job_state_t *gres_js;
-	uint32_t j;
+	int j;
 	uint64_t gres_cnt;
 	int len_j, len_s;
 	gres_key_t job_search_key;
@@ -2790,16 +2789,20 @@ static int _step_dealloc(gres_state_t *gres_state_step, list_t *job_gres_list,
 		      step_id, node_offset, len_j, len_s);
 		len_j = MIN(len_j, len_s);
 	}
-	for (j = 0; j < len_j; j++) {
-		if (!bit_test(gres_ss->gres_bit_alloc[node_offset], j))
-			continue;
-		if (gres_js->gres_bit_step_alloc &&
-		    gres_js->gres_bit_step_alloc[node_offset]) {
+	if (gres_js->gres_bit_step_alloc &&
+	    gres_js->gres_bit_step_alloc[node_offset]) {
+		bitstr_t *step_bit_alloc = gres_ss->gres_bit_alloc[node_offset];
+		bool per_bit = gres_id_shared(gres_state_job->config_flags) &&
+			gres_js->gres_per_bit_step_alloc &&
+			gres_js->gres_per_bit_step_alloc[node_offset] &&
+			gres_ss->gres_per_bit_alloc &&
+			gres_ss->gres_per_bit_alloc[node_offset];
+
+		for (j = 0; ((j = bit_ffs_from_bit(step_bit_alloc, j)) >= 0) &&
+			     (j < len_j); j++) {
 			bit_clear(gres_js->gres_bit_step_alloc[node_offset],
 				  j);
-			if (gres_id_shared(gres_state_job->config_flags) &&
-			    gres_js->gres_per_bit_step_alloc[node_offset] &&
-			    gres_ss->gres_per_bit_alloc[node_offset])
+			if (per_bit)
 				gres_js->gres_per_bit_step_alloc[node_offset]
 								[j] -=
 					gres_ss->gres_per_bit_alloc[node_offset]
@@ -914,10 +914,15 @@ static bitstr_t *_pick_step_nodes_cpus(job_record_t *job_ptr,
 	return NULL;
 }
 
+typedef struct {
+	bitstr_t *avail;	/* nodes the step may be placed on */
+	bitstr_t *busy;		/* nodes running some other step */
+} mark_busy_args_t;
+
 static int _mark_busy_nodes(void *x, void *arg)
 {
 	step_record_t *step_ptr = (step_record_t *) x;
-	bitstr_t *busy = (bitstr_t *) arg;
+	mark_busy_args_t *args = arg;
 
 	if (step_ptr->state < JOB_RUNNING)
 		return 0;
@@ -938,7 +943,7 @@ static int _mark_busy_nodes(void *x, void *arg)
 		return 0;
 	}
 
-	bit_or(busy, step_ptr->step_node_bitmap);
+	bit_or(args->busy, step_ptr->step_node_bitmap);
 
 	if (slurm_conf.debug_flags & DEBUG_FLAG_STEPS) {
 		char *temp;
@@ -948,6 +953,13 @@ static int _mark_busy_nodes(void *x, void *arg)
 		xfree(temp);
 	}
 
+	/*
+	 * Once every available node is busy no idle node can remain, so the
+	 * rest of a long step list does not need to be walked.
+	 */
+	if (bit_super_set(args->avail, args->busy))
+		return -1;
+
 	return 0;
 }
 
@@ -1571,8 +1583,13 @@ static bitstr_t *_pick_step_nodes(job_record_t *job_ptr,
 		bit_and_not(nodes_avail, relative_nodes);
 		FREE_NULL_BITMAP(relative_nodes);
 	} else {
+		mark_busy_args_t busy_args = {
+			.avail = nodes_avail,
+		};
+
 		nodes_idle = bit_alloc (bit_size (nodes_avail) );
-		list_for_each(job_ptr->step_list, _mark_busy_nodes, nodes_idle);
+		busy_args.busy = nodes_idle;
+		list_for_each(job_ptr->step_list, _mark_busy_nodes, &busy_args);
 		bit_not(nodes_idle);
 		bit_and(nodes_idle, nodes_avail);
 	}
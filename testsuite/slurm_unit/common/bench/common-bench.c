@@ -0,0 +1,746 @@
+/*****************************************************************************\
+ *  common-bench.c - microbenchmarks for common hot path primitives
+ *****************************************************************************
+ *  Copyright (C) SchedMD LLC.
+ *
+ *  This file is part of Slurm, a resource management program.
+ *  For details, see <https://slurm.schedmd.com/>.
+ *  Please also read the included file: DISCLAIMER.
+ *
+ *  Slurm is free software; you can redistribute it and/or modify it under
+ *  the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the License, or (at your option)
+ *  any later version.
+ *
+ *  In addition, as a special exception, the copyright holders give permission
+ *  to link the code of portions of this program with the OpenSSL library under
+ *  certain conditions as described in each individual source file, and
+ *  distribute linked combinations including the two. You must obey the GNU
+ *  General Public License in all respects for all of the code used other than
+ *  OpenSSL. If you modify file(s) with this exception, you may extend this
+ *  exception to your version of the file(s), but you are not obligated to do
+ *  so. If you do not wish to do so, delete this exception statement from your
+ *  version.  If you delete this exception statement from all source files in
+ *  the program, then also delete it here.
+ *
+ *  Slurm is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with Slurm; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA.
+\*****************************************************************************/
+
+/*
+ * Every benchmark input is generated from a fixed seed so that results are
+ * comparable between builds and releases. Each benchmark is repeated until it
+ * has run for at least the minimum time and is reported as one JSON object
+ * with the time per operation.
+ */
+
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "src/common/bitstring.h"
+#include "src/common/data.h"
+#include "src/common/hostlist.h"
+#include "src/common/list.h"
+#include "src/common/log.h"
+#include "src/common/pack.h"
+#include "src/common/read_config.h"
+#include "src/common/slurm_protocol_defs.h"
+#include "src/common/slurm_protocol_pack.h"
+#include "src/common/xmalloc.h"
+#include "src/common/xstring.h"
+
+#include "src/interfaces/hash.h"
+#include "src/interfaces/serializer.h"
+
+#define DEFAULT_SEED 20241111
+#define DEFAULT_MIN_USEC 200000
+
+typedef void (*bench_op_t)(void *arg);
+
+static uint64_t seed = DEFAULT_SEED;
+static uint64_t rand_state = DEFAULT_SEED;
+static uint64_t min_usec = DEFAULT_MIN_USEC;
+static char *filter = NULL;
+static int results = 0;
+
+/* xorshift64, so inputs do not depend on the libc random() implementation */
+static uint64_t _rand(void)
+{
+	rand_state ^= rand_state << 13;
+	rand_state ^= rand_state >> 7;
+	rand_state ^= rand_state << 17;
+	return rand_state;
+}
+
+/* Restart the generator so each benchmark gets the same inputs alone */
+static void _reseed(void)
+{
+	rand_state = seed ? seed : DEFAULT_SEED;
+}
+
+static uint64_t _now_nsec(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ((uint64_t) ts.tv_sec * NSEC_IN_SEC) + ts.tv_nsec;
+}
+
+static void _run(const char *group, const char *name, uint64_t size,
+		 bench_op_t op, void *arg)
+{
+	uint64_t iterations = 0, batch = 1, start, elapsed = 0;
+	char *full_name = NULL;
+
+	xstrfmtcat(full_name, "%s/%s", group, name);
+	if (filter && !xstrstr(full_name, filter)) {
+		xfree(full_name);
+		return;
+	}
+
+	/* warm up caches and lazily allocated state */
+	op(arg);
+
+	start = _now_nsec();
+	while (elapsed < (min_usec * NSEC_IN_USEC)) {
+		for (uint64_t i = 0; i < batch; i++)
+			op(arg);
+		iterations += batch;
+		elapsed = _now_nsec() - start;
+		if (batch < (1 << 20))
+			batch *= 2;
+	}
+
+	printf("%s\n    {\"name\": \"%s\", \"size\": %"PRIu64", \"iterations\": %"PRIu64", \"nsec_per_op\": %.1f}",
+	       (results ? "," : ""), full_name, size, iterations,
+	       ((double) elapsed / iterations));
+	fflush(stdout);
+	results++;
+	xfree(full_name);
+}
+
+/*
+ * bitstring
+ */
+
+typedef struct {
+	bitstr_t *a;
+	bitstr_t *b;
+	char *str;
+	int str_len;
+} bit_args_t;
+
+static void _op_bit_set_count(void *arg)
+{
+	bit_args_t *args = arg;
+
+	(void) bit_set_count(args->a);
+}
+
+static void _op_bit_ffs(void *arg)
+{
+	bit_args_t *args = arg;
+
+	(void) bit_ffs(args->b);
+}
+
+static void _op_bit_and(void *arg)
+{
+	bit_args_t *args = arg;
+	bitstr_t *tmp = bit_copy(args->a);
+
+	bit_and(tmp, args->b);
+	FREE_NULL_BITMAP(tmp);
+}
+
+static void _op_bit_or(void *arg)
+{
+	bit_args_t *args = arg;
+	bitstr_t *tmp = bit_copy(args->a);
+
+	bit_or(tmp, args->b);
+	FREE_NULL_BITMAP(tmp);
+}
+
+static void _op_bit_fmt(void *arg)
+{
+	bit_args_t *args = arg;
+
+	(void) bit_fmt(args->str, args->str_len, args->b);
+}
+
+static void _bench_bitstring(void)
+{
+	static const bitoff_t sizes[] = { 64, 1024, 65536, 1048576 };
+
+	for (int i = 0; i < ARRAY_SIZE(sizes); i++) {
+		bitoff_t size = sizes[i];
+		bit_args_t args = {
+			.a = bit_alloc(size),
+			.b = bit_alloc(size),
+			.str_len = 8192,
+		};
+
+		_reseed();
+		/* a is half full, b is sparse with its first bit set late */
+		for (bitoff_t j = 0; j < size; j++) {
+			if (_rand() & 1)
+				bit_set(args.a, j);
+		}
+		for (bitoff_t j = (size / 2); j < size; j++) {
+			if (!(_rand() % 32))
+				bit_set(args.b, j);
+		}
+		args.str = xmalloc(args.str_len);
+
+		_run("bitstring", "bit_set_count", size, _op_bit_set_count,
+		     &args);
+		_run("bitstring", "bit_ffs", size, _op_bit_ffs, &args);
+		_run("bitstring", "bit_and", size, _op_bit_and, &args);
+		_run("bitstring", "bit_or", size, _op_bit_or, &args);
+		_run("bitstring", "bit_fmt", size, _op_bit_fmt, &args);
+
+		FREE_NULL_BITMAP(args.a);
+		FREE_NULL_BITMAP(args.b);
+		xfree(args.str);
+	}
+}
+
+/*
+ * hostlist
+ */
+
+#define FIND_NAME_CNT 64
+
+typedef struct {
+	char *ranged;
+	hostlist_t *hl;
+	char *names[FIND_NAME_CNT];
+	int next;
+} hostlist_args_t;
+
+static void _op_hostlist_create(void *arg)
+{
+	hostlist_args_t *args = arg;
+	hostlist_t *hl = hostlist_create(args->ranged);
+
+	FREE_NULL_HOSTLIST(hl);
+}
+
+static void _op_hostlist_ranged_string(void *arg)
+{
+	hostlist_args_t *args = arg;
+	char *str = hostlist_ranged_string_xmalloc(args->hl);
+
+	xfree(str);
+}
+
+static void _op_hostlist_find(void *arg)
+{
+	hostlist_args_t *args = arg;
+
+	(void) hostlist_find(args->hl, args->names[args->next]);
+	args->next = (args->next + 1) % FIND_NAME_CNT;
+}
+
+static void _bench_hostlist(void)
+{
+	static const int sizes[] = { 16, 1024, 16384 };
+
+	for (int i = 0; i < ARRAY_SIZE(sizes); i++) {
+		int size = sizes[i];
+		hostlist_args_t args = { 0 };
+
+		_reseed();
+		/* leave holes in the ranges, as with real node lists */
+		args.hl = hostlist_create(NULL);
+		for (int j = 0, n = 0; j < size; n++) {
+			char name[32];
+
+			if (!(_rand() % 8))
+				continue;
+			snprintf(name, sizeof(name), "node%05d", n);
+			hostlist_push_host(args.hl, name);
+			j++;
+		}
+		args.ranged = hostlist_ranged_string_xmalloc(args.hl);
+		for (int j = 0; j < FIND_NAME_CNT; j++)
+			args.names[j] = xstrdup_printf(
+				"node%05"PRIu64, (_rand() % (size + (size / 7))));
+
+		_run("hostlist", "create", size, _op_hostlist_create, &args);
+		_run("hostlist", "ranged_string", size,
+		     _op_hostlist_ranged_string, &args);
+		_run("hostlist", "find", size, _op_hostlist_find, &args);
+
+		FREE_NULL_HOSTLIST(args.hl);
+		xfree(args.ranged);
+		for (int j = 0; j < FIND_NAME_CNT; j++)
+			xfree(args.names[j]);
+	}
+}
+
+/*
+ * pack and unpack of RPC messages
+ */
+
+typedef struct {
+	slurm_msg_t msg;
+	buf_t *buffer;
+} pack_args_t;
+
+static void _op_pack(void *arg)
+{
+	pack_args_t *args = arg;
+
+	set_buf_offset(args->buffer, 0);
+	if (pack_msg(&args->msg, args->buffer))
+		fatal("%s: pack_msg(%s) failed", __func__,
+		      rpc_num2string(args->msg.msg_type));
+}
+
+static void _op_unpack(void *arg)
+{
+	pack_args_t *args = arg;
+	slurm_msg_t msg;
+
+	slurm_msg_t_init(&msg);
+	msg.msg_type = args->msg.msg_type;
+	msg.protocol_version = args->msg.protocol_version;
+
+	set_buf_offset(args->buffer, 0);
+	if (unpack_msg(&msg, args->buffer))
+		fatal("%s: unpack_msg(%s) failed", __func__,
+		      rpc_num2string(msg.msg_type));
+	slurm_free_msg_data(msg.msg_type, msg.data);
+}
+
+static void _bench_msg(const char *name, uint16_t msg_type, void *data,
+		       bool unpack)
+{
+	pack_args_t args = {
+		.buffer = init_buf(BUF_SIZE),
+	};
+	char *pack_name = NULL, *unpack_name = NULL;
+
+	slurm_msg_t_init(&args.msg);
+	args.msg.msg_type = msg_type;
+	args.msg.protocol_version = SLURM_PROTOCOL_VERSION;
+	args.msg.data = data;
+
+	_op_pack(&args);
+
+	xstrfmtcat(pack_name, "%s_pack", name);
+	xstrfmtcat(unpack_name, "%s_unpack", name);
+	_run("pack", pack_name, get_buf_offset(args.buffer), _op_pack, &args);
+	/* leave the buffer packed for unpacking */
+	_op_pack(&args);
+	if (unpack)
+		_run("pack", unpack_name, get_buf_offset(args.buffer),
+		     _op_unpack, &args);
+
+	xfree(pack_name);
+	xfree(unpack_name);
+	FREE_NULL_BUFFER(args.buffer);
+}
+
+static void _bench_pack(bool plugins)
+{
+	job_desc_msg_t *job_desc = xmalloc(sizeof(*job_desc));
+	slurm_node_registration_status_msg_t *reg = xmalloc(sizeof(*reg));
+	char *script = NULL;
+
+	_reseed();
+
+	/* a typical batch submission: script, environment and options */
+	slurm_init_job_desc_msg(job_desc);
+	job_desc->name = xstrdup("bench");
+	job_desc->account = xstrdup("physics");
+	job_desc->partition = xstrdup("batch,debug");
+	job_desc->work_dir = xstrdup("/home/user/run");
+	job_desc->std_out = xstrdup("/home/user/run/slurm-%j.out");
+	job_desc->min_nodes = 4;
+	job_desc->num_tasks = 128;
+	job_desc->time_limit = 60;
+	job_desc->user_id = 1000;
+	job_desc->group_id = 1000;
+	xstrcat(script, "#!/bin/bash\n");
+	for (int i = 0; i < 64; i++)
+		xstrfmtcat(script, "srun ./step_%d --input=data.%"PRIu64"\n",
+			   i, (_rand() % 100000));
+	job_desc->script = script;
+	job_desc->env_size = 128;
+	job_desc->environment = xcalloc(job_desc->env_size, sizeof(char *));
+	for (int i = 0; i < job_desc->env_size; i++)
+		job_desc->environment[i] = xstrdup_printf(
+			"VAR_%d=%016"PRIx64, i, _rand());
+
+	_bench_msg("job_desc", REQUEST_SUBMIT_BATCH_JOB, job_desc, plugins);
+
+	/* node registration with running steps */
+	reg->hostname = xstrdup("node00001");
+	reg->node_name = xstrdup("node00001");
+	reg->arch = xstrdup("x86_64");
+	reg->os = xstrdup("Linux 6.1.0 #1 SMP");
+	reg->version = xstrdup(SLURM_VERSION_STRING);
+	reg->features_avail = xstrdup("gpu,ib,nvme");
+	reg->features_active = xstrdup("gpu,ib,nvme");
+	reg->cpus = 128;
+	reg->sockets = 2;
+	reg->cores = 32;
+	reg->threads = 2;
+	reg->real_memory = 512000;
+	reg->job_count = 32;
+	reg->step_id = xcalloc(reg->job_count, sizeof(*reg->step_id));
+	for (int i = 0; i < reg->job_count; i++) {
+		reg->step_id[i].job_id = (_rand() % 1000000) + 1;
+		reg->step_id[i].step_id = i % 4;
+		reg->step_id[i].step_het_comp = NO_VAL;
+	}
+
+	_bench_msg("node_registration", MESSAGE_NODE_REGISTRATION_STATUS,
+		   reg, true);
+
+	slurm_free_job_desc_msg(job_desc);
+	slurm_free_node_registration_status_msg(reg);
+}
+
+/*
+ * list
+ */
+
+typedef struct {
+	list_t *list;
+	int size;
+	int next;
+} list_args_t;
+
+static int _find_int(void *x, void *key)
+{
+	return (*(int *) x == *(int *) key);
+}
+
+static int _cmp_int(void *x, void *y)
+{
+	int a = **(int **) x, b = **(int **) y;
+
+	return (a > b) - (a < b);
+}
+
+static int _sum_int(void *x, void *arg)
+{
+	*(uint64_t *) arg += *(int *) x;
+	return 0;
+}
+
+static list_t *_create_int_list(int size)
+{
+	list_t *list = list_create(xfree_ptr);
+
+	for (int i = 0; i < size; i++) {
+		int *value = xmalloc(sizeof(*value));
+
+		*value = _rand() % size;
+		list_append(list, value);
+	}
+
+	return list;
+}
+
+static void _op_list_create(void *arg)
+{
+	list_args_t *args = arg;
+	list_t *list = list_create(NULL);
+
+	for (int i = 0; i < args->size; i++)
+		list_append(list, args);
+	FREE_NULL_LIST(list);
+}
+
+static void _op_list_find_first(void *arg)
+{
+	list_args_t *args = arg;
+	int key = args->next;
+
+	(void) list_find_first(args->list, _find_int, &key);
+	args->next = (args->next + 7) % args->size;
+}
+
+static void _op_list_for_each(void *arg)
+{
+	list_args_t *args = arg;
+	uint64_t sum = 0;
+
+	(void) list_for_each(args->list, _sum_int, &sum);
+}
+
+static void _op_list_sort(void *arg)
+{
+	list_args_t *args = arg;
+	list_t *list;
+
+	_reseed();
+	list = _create_int_list(args->size);
+	list_sort(list, _cmp_int);
+	FREE_NULL_LIST(list);
+}
+
+static void _bench_list(void)
+{
+	static const int sizes[] = { 16, 1024, 65536 };
+
+	for (int i = 0; i < ARRAY_SIZE(sizes); i++) {
+		list_args_t args = {
+			.size = sizes[i],
+		};
+
+		_reseed();
+		args.list = _create_int_list(args.size);
+
+		_run("list", "create", args.size, _op_list_create, &args);
+		_run("list", "find_first", args.size, _op_list_find_first,
+		     &args);
+		_run("list", "for_each", args.size, _op_list_for_each, &args);
+		_run("list", "create_sort", args.size, _op_list_sort, &args);
+
+		FREE_NULL_LIST(args.list);
+	}
+}
+
+/*
+ * data_t and serializers
+ */
+
+typedef struct {
+	int size;
+	data_t *data;
+	char *str;
+	size_t str_len;
+	const char *mime_type;
+} data_args_t;
+
+/* Build a list of dictionaries resembling a job listing */
+static data_t *_build_data(int size)
+{
+	data_t *data = data_set_list(data_new());
+
+	for (int i = 0; i < size; i++) {
+		data_t *job = data_set_dict(data_list_append(data));
+
+		data_set_int(data_key_set(job, "job_id"), (i + 1));
+		data_set_string(data_key_set(job, "name"), "bench");
+		data_set_string(data_key_set(job, "partition"), "batch");
+		data_set_int(data_key_set(job, "priority"), (_rand() % 100000));
+		data_set_bool(data_key_set(job, "requeue"), (_rand() & 1));
+		data_set_float(data_key_set(job, "load"),
+			       ((_rand() % 10000) / 100.0));
+		data_set_list(data_key_set(job, "nodes"));
+		for (int j = 0; j < 4; j++)
+			data_set_string_fmt(
+				data_list_append(data_key_get(job, "nodes")),
+				"node%05"PRIu64, (_rand() % 100000));
+	}
+
+	return data;
+}
+
+static void _op_data_build(void *arg)
+{
+	data_args_t *args = arg;
+	data_t *data;
+
+	_reseed();
+	data = _build_data(args->size);
+	FREE_NULL_DATA(data);
+}
+
+static void _op_data_copy(void *arg)
+{
+	data_args_t *args = arg;
+	data_t *data = data_copy(NULL, args->data);
+
+	FREE_NULL_DATA(data);
+}
+
+static void _op_serialize(void *arg)
+{
+	data_args_t *args = arg;
+	char *str = NULL;
+	size_t len = 0;
+
+	if (serialize_g_data_to_string(&str, &len, args->data,
+				       args->mime_type, SER_FLAGS_COMPACT))
+		fatal("%s: unable to serialize to %s", __func__,
+		      args->mime_type);
+	xfree(str);
+}
+
+static void _op_deserialize(void *arg)
+{
+	data_args_t *args = arg;
+	data_t *data = NULL;
+
+	if (serialize_g_string_to_data(&data, args->str, args->str_len,
+				       args->mime_type))
+		fatal("%s: unable to parse %s", __func__, args->mime_type);
+	FREE_NULL_DATA(data);
+}
+
+static void _bench_data(bool plugins)
+{
+	static const int sizes[] = { 1, 100, 10000 };
+	static const struct {
+		const char *name;
+		const char *mime_type;
+	} types[] = {
+		{ "json", MIME_TYPE_JSON },
+		{ "yaml", MIME_TYPE_YAML },
+	};
+
+	for (int i = 0; i < ARRAY_SIZE(sizes); i++) {
+		data_args_t args = {
+			.size = sizes[i],
+		};
+
+		_reseed();
+		args.data = _build_data(args.size);
+
+		_run("data", "build", args.size, _op_data_build, &args);
+		_run("data", "copy", args.size, _op_data_copy, &args);
+
+		for (int t = 0; plugins && (t < ARRAY_SIZE(types)); t++) {
+			char *name = NULL;
+
+			args.mime_type = types[t].mime_type;
+			if (serialize_g_data_to_string(&args.str,
+						       &args.str_len,
+						       args.data,
+						       args.mime_type,
+						       SER_FLAGS_COMPACT)) {
+				debug("%s: skipping %s", __func__,
+				      types[t].name);
+				continue;
+			}
+
+			xstrfmtcat(name, "%s_serialize", types[t].name);
+			_run("serializer", name, args.size, _op_serialize,
+			     &args);
+			xfree(name);
+
+			xstrfmtcat(name, "%s_parse", types[t].name);
+			_run("serializer", name, args.size, _op_deserialize,
+			     &args);
+			xfree(name);
+			xfree(args.str);
+		}
+
+		FREE_NULL_DATA(args.data);
+	}
+}
+
+static void _usage(void)
+{
+	fprintf(stderr,
+"Usage: common-bench [-f filter] [-s seed] [-t min_usec]\n"
+"  -f filter   only run benchmarks whose group/name contains filter\n"
+"  -s seed     seed used to generate inputs (default %u)\n"
+"  -t min_usec minimum run time of each benchmark (default %u)\n",
+		DEFAULT_SEED, DEFAULT_MIN_USEC);
+}
+
+extern int main(int argc, char **argv)
+{
+	log_options_t log_opts = LOG_OPTS_INITIALIZER;
+	const char *debug_env = getenv("SLURM_DEBUG");
+	char *conf_content = NULL, *conf_filename;
+	bool plugins = !access(SLURM_PREFIX "/lib/slurm", R_OK);
+	int c, fd;
+
+	while ((c = getopt(argc, argv, "f:hs:t:")) != -1) {
+		switch (c) {
+		case 'f':
+			filter = xstrdup(optarg);
+			break;
+		case 's':
+			seed = strtoull(optarg, NULL, 10);
+			break;
+		case 't':
+			min_usec = strtoull(optarg, NULL, 10);
+			break;
+		default:
+			_usage();
+			return (c == 'h') ? EXIT_SUCCESS : EXIT_FAILURE;
+		}
+	}
+
+	log_opts.stderr_level = LOG_LEVEL_ERROR;
+	if (debug_env)
+		log_opts.stderr_level = log_string2num(debug_env);
+	log_init("common-bench", log_opts, 0, NULL);
+
+	/*
+	 * Use a mock slurm.conf, as done by the unit tests. PluginDir must
+	 * exist, so use "." when Slurm has not been installed yet.
+	 */
+	xstrfmtcat(conf_content,
+		   "ClusterName=slurm_bench\nSlurmctldHost=slurm_bench\nPluginDir=%s\n",
+		   (plugins ? SLURM_PREFIX "/lib/slurm" : "."));
+	conf_filename = xstrdup("/tmp/slurm_bench.conf-XXXXXX");
+	if ((fd = mkstemp(conf_filename)) < 0) {
+		error("unable to create %s: %m", conf_filename);
+		return EXIT_FAILURE;
+	}
+	if (write(fd, conf_content, strlen(conf_content)) !=
+	    strlen(conf_content)) {
+		error("unable to write %s: %m", conf_filename);
+		return EXIT_FAILURE;
+	}
+	close(fd);
+	xfree(conf_content);
+	if (slurm_conf_init(conf_filename)) {
+		error("slurm_conf_init() failed");
+		return EXIT_FAILURE;
+	}
+	unlink(conf_filename);
+	xfree(conf_filename);
+
+	/*
+	 * Unpacking a job_desc hashes its environment and the serializers are
+	 * plugins, so these are only benchmarked once Slurm is installed.
+	 */
+	if (plugins && (hash_g_init() || serializer_g_init(NULL, NULL))) {
+		error("unable to load plugins from %s/lib/slurm", SLURM_PREFIX);
+		return EXIT_FAILURE;
+	} else if (!plugins) {
+		info("Slurm not installed, skipping benchmarks needing plugins");
+	}
+
+	printf("{\n  \"version\": \"%s\",\n  \"seed\": %"PRIu64",\n  \"min_usec\": %"PRIu64",\n  \"benchmarks\": [",
+	       SLURM_VERSION_STRING, seed, min_usec);
+
+	_bench_bitstring();
+	_bench_hostlist();
+	_bench_pack(plugins);
+	_bench_list();
+	_bench_data(plugins);
+
+	printf("\n  ]\n}\n");
+
+	if (plugins) {
+		serializer_g_fini();
+		hash_g_fini();
+	}
+	slurm_fini();
+	log_fini();
+	xfree(filter);
+	return EXIT_SUCCESS;
+}
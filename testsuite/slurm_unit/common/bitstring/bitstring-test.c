@@ -3,6 +3,7 @@
 #include <stdlib.h>
 #include <src/common/log.h>
 #include <src/common/bitstring.h>
+#include <src/common/macros.h>
 #include <sys/time.h>
 #include <check.h>
 
@@ -331,6 +332,83 @@ START_TEST(test_bit_ffs_from_bit)
 }
 END_TEST
 
+static int32_t _ref_nffs(bitstr_t *b, int32_t n)
+{
+	int32_t cnt = 0;
+
+	for (bitoff_t bit = 0; bit < bit_size(b); bit++) {
+		if (!bit_test(b, bit))
+			cnt = 0;
+		else if (++cnt >= n)
+			return bit - (cnt - 1);
+	}
+
+	return -1;
+}
+
+START_TEST(test_bulk_ops)
+{
+	const int sizes[] = { 1, 63, 64, 65, 1000, 4096, 10007 };
+	const int loops = 2000;
+	struct timeval tv1, tv2;
+	int32_t sum = 0;
+
+	srandom(1);
+	for (int i = 0; i < ARRAY_SIZE(sizes); i++) {
+		bitstr_t *b1 = bit_alloc(sizes[i]);
+		bitstr_t *b2 = bit_alloc(sizes[i]);
+		int32_t cnt = 0, overlap = 0;
+
+		/* mix of sparse bits and long runs */
+		for (bitoff_t bit = 0; bit < sizes[i]; bit++) {
+			if ((bit / 200) % 2 ? (random() % 8) : (random() % 2))
+				bit_set(b1, bit);
+			if (random() % 3)
+				bit_set(b2, bit);
+			if (bit_test(b1, bit))
+				cnt++;
+			if (bit_test(b1, bit) && bit_test(b2, bit))
+				overlap++;
+		}
+
+		ck_assert_int_eq(bit_set_count(b1), cnt);
+		ck_assert_int_eq(bit_overlap(b1, b2), overlap);
+		ck_assert_int_eq(bit_overlap_any(b1, b2), (overlap != 0));
+		ck_assert_int_eq(bit_super_set(b1, b1), 1);
+		for (int n = 1; n <= MIN(sizes[i], 130); n++)
+			ck_assert_int_eq(bit_nffs(b1, n), _ref_nffs(b1, n));
+
+		bit_free(b1);
+		bit_free(b2);
+	}
+
+	/* report rough timing of the bulk operations on a large bitmap */
+	{
+		bitstr_t *b1 = bit_alloc(100000), *b2 = bit_alloc(100000);
+
+		bit_nset(b1, 0, 49999);
+		bit_nset(b2, 25000, 99999);
+		bit_set(b1, 99999);
+
+		gettimeofday(&tv1, NULL);
+		for (int i = 0; i < loops; i++) {
+			sum += bit_set_count(b1);
+			sum += bit_overlap(b1, b2);
+			sum += bit_super_set(b1, b2);
+			sum += bit_nffs(b1, 60000);
+		}
+		gettimeofday(&tv2, NULL);
+		info("%d loops of bit_set_count, bit_overlap, bit_super_set and bit_nffs on 100000 bits: %ld usec",
+		     loops, ((tv2.tv_sec - tv1.tv_sec) * 1000000) +
+			    (tv2.tv_usec - tv1.tv_usec));
+		ck_assert_int_ne(sum, 0);
+
+		bit_free(b1);
+		bit_free(b2);
+	}
+}
+END_TEST
+
 int main(void)
 {
 	int number_failed;
@@ -353,6 +431,7 @@ int main(void)
 	tcase_add_test(tc_core, test_bit_overlap);
 	tcase_add_test(tc_core, test_bit_set_count_range);
 	tcase_add_test(tc_core, test_bit_ffs_from_bit);
+	tcase_add_test(tc_core, test_bulk_ops);
 
 	suite_add_tcase(s, tc_core);
 
@@ -81,6 +81,104 @@ START_TEST(test_pack)
 }
 END_TEST
 
+START_TEST(test_pack_borrowed)
+{
+	buf_t *buffer;
+	char *env[] = { "A=1", "B=2", NULL };
+	char **outenv = NULL, *outstring = NULL, *nullstr = NULL;
+	uint32_t cnt, byte_cnt;
+
+	buffer = init_buf(0);
+	packstr("TEST STRING", buffer);
+	packstr_array(env, 2, buffer);
+	packstr(nullstr, buffer);
+	pack32(3, buffer);
+	packmem("abc", 3, buffer);
+	set_buf_offset(buffer, 0);
+
+	ck_assert(!unpackstr_ptr(&outstring, &byte_cnt, buffer));
+	ck_assert_str_eq(outstring, "TEST STRING");
+	ck_assert(outstring > get_buf_data(buffer));
+	ck_assert(outstring < (get_buf_data(buffer) + size_buf(buffer)));
+
+	ck_assert(!unpackstr_array_ptr(&outenv, &cnt, buffer));
+	ck_assert_int_eq(cnt, 2);
+	ck_assert_str_eq(outenv[0], "A=1");
+	ck_assert_str_eq(outenv[1], "B=2");
+	ck_assert(outenv[2] == NULL);
+	xfree(outenv);
+
+	ck_assert(!unpackstr_ptr(&outstring, &byte_cnt, buffer));
+	ck_assert(outstring == NULL);
+
+	/* array count and one element without NUL termination */
+	ck_assert(unpackstr_array_ptr(&outenv, &cnt, buffer));
+	ck_assert(outenv == NULL);
+	ck_assert_int_eq(cnt, 0);
+
+	free_buf(buffer);
+}
+END_TEST
+
+START_TEST(test_pack_ref)
+{
+	buf_t *buffer, *flat;
+	struct iovec *iov = NULL;
+	char *big = xmalloc(PACK_REF_MIN_LEN);
+	char *outmem = NULL;
+	uint32_t byte_cnt, num;
+	int iovcnt;
+
+	memset(big, 'x', PACK_REF_MIN_LEN);
+
+	/* Buffers that do not allow references copy everything */
+	buffer = init_buf(0);
+	packmem_ref(big, PACK_REF_MIN_LEN, buffer);
+	ck_assert_int_eq(buffer->ref_cnt, 0);
+	ck_assert_int_eq(get_buf_packed_size(buffer), get_buf_offset(buffer));
+	free_buf(buffer);
+
+	buffer = init_buf(0);
+	buffer->allow_refs = true;
+	pack32(1, buffer);
+	packmem_ref("small", 6, buffer);
+	packmem_ref(big, PACK_REF_MIN_LEN, buffer);
+	pack32(2, buffer);
+	ck_assert_int_eq(buffer->ref_cnt, 1);
+	ck_assert_int_eq(get_buf_packed_size(buffer),
+			 (get_buf_offset(buffer) + PACK_REF_MIN_LEN));
+
+	/* Flattening the iovecs must match what packmem() would produce */
+	iovcnt = get_buf_iovec(buffer, &iov);
+	ck_assert_int_eq(iovcnt, 3);
+	ck_assert(iov[1].iov_base == big);
+	flat = init_buf(0);
+	for (int i = 0; i < iovcnt; i++) {
+		grow_buf(flat, iov[i].iov_len);
+		memcpy(get_buf_data(flat) + get_buf_offset(flat),
+		       iov[i].iov_base, iov[i].iov_len);
+		set_buf_offset(flat, get_buf_offset(flat) + iov[i].iov_len);
+	}
+	xfree(iov);
+	ck_assert_int_eq(get_buf_offset(flat), get_buf_packed_size(buffer));
+	set_buf_offset(flat, 0);
+
+	ck_assert(!unpack32(&num, flat));
+	ck_assert_int_eq(num, 1);
+	ck_assert(!unpackmem_ptr(&outmem, &byte_cnt, flat));
+	ck_assert_str_eq(outmem, "small");
+	ck_assert(!unpackmem_ptr(&outmem, &byte_cnt, flat));
+	ck_assert_int_eq(byte_cnt, PACK_REF_MIN_LEN);
+	ck_assert(!memcmp(outmem, big, PACK_REF_MIN_LEN));
+	ck_assert(!unpack32(&num, flat));
+	ck_assert_int_eq(num, 2);
+
+	free_buf(flat);
+	free_buf(buffer);
+	xfree(big);
+}
+END_TEST
+
 int main(void)
 {
 	int number_failed;
@@ -93,6 +191,8 @@ int main(void)
 	TCase *tc_core = tcase_create("pack");
 
 	tcase_add_test(tc_core, test_pack);
+	tcase_add_test(tc_core, test_pack_borrowed);
+	tcase_add_test(tc_core, test_pack_ref);
 
 	suite_add_tcase(s, tc_core);
 
@@ -47,6 +47,7 @@
 #include <check.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <sys/resource.h>
 #include <unistd.h>
 
 #include "slurm/slurm_errno.h"
@@ -548,7 +549,7 @@ typedef struct {int a; int b;} mem_track_t;
 #endif /* !HAVE_MALLINFO2 */
 
 static void _test_bandwidth_str(const char *tag, const char *source,
-				const int run_count)
+				const char *mime_type, const int run_count)
 {
 	DEF_TIMERS;
 	int rc;
@@ -573,7 +574,7 @@ static void _test_bandwidth_str(const char *tag, const char *source,
 
 		START_TIMER;
 		rc = serialize_g_string_to_data(&data, source,
-						test_json_len, MIME_TYPE_JSON);
+						test_json_len, mime_type);
 		END_TIMER3(__func__, INFINITE);
 
 		_track_mem(&read_mem);
@@ -592,8 +593,7 @@ static void _test_bandwidth_str(const char *tag, const char *source,
 
 		START_TIMER;
 		rc = serialize_g_data_to_string(&output, &output_len, data,
-						MIME_TYPE_JSON,
-						SER_FLAGS_PRETTY);
+						mime_type, SER_FLAGS_PRETTY);
 		END_TIMER3(__func__, INFINITE);
 
 		_track_mem(&write_mem);
@@ -651,7 +651,113 @@ START_TEST(test_bandwidth)
 {
 	for (int i = 0; i < ARRAY_SIZE(test_json); i++)
 		_test_bandwidth_str(test_json[i].tag, test_json[i].source,
-				    test_json[i].run_count);
+				    MIME_TYPE_JSON, test_json[i].run_count);
+}
+END_TEST
+
+static void _add_number(data_t *dict, const char *key, int64_t value)
+{
+	data_t *d = data_set_dict(data_key_set(dict, key));
+
+	data_set_bool(data_key_set(d, "set"), true);
+	data_set_bool(data_key_set(d, "infinite"), false);
+	data_set_int(data_key_set(d, "number"), value);
+}
+
+/* Generate dataset shaped like the slurmrestd job and node responses */
+static data_t *_synthetic_dataset(const int count)
+{
+	data_t *resp = data_set_dict(data_new());
+	data_t *jobs = data_set_list(data_key_set(resp, "jobs"));
+	data_t *nodes = data_set_list(data_key_set(resp, "nodes"));
+	data_t *meta = data_set_dict(data_key_set(resp, "meta"));
+
+	data_set_string(data_key_set(meta, "plugin"), "data_parser/v0.0.42");
+	(void) data_set_list(data_key_set(resp, "errors"));
+	(void) data_set_list(data_key_set(resp, "warnings"));
+
+	for (int i = 0; i < count; i++) {
+		data_t *job = data_set_dict(data_list_append(jobs));
+		data_t *node = data_set_dict(data_list_append(nodes));
+		data_t *list;
+
+		data_set_int(data_key_set(job, "job_id"), (i + 1000));
+		data_set_string_fmt(data_key_set(job, "name"), "job-%d", i);
+		data_set_string_fmt(data_key_set(job, "user_name"), "user%d",
+				    (i % 97));
+		data_set_string_fmt(data_key_set(job, "account"), "account%d",
+				    (i % 13));
+		data_set_string(data_key_set(job, "partition"), "debug");
+		list = data_set_list(data_key_set(job, "job_state"));
+		data_set_string(data_list_append(list),
+				((i % 3) ? "RUNNING" : "PENDING"));
+		data_set_string_fmt(data_key_set(job, "nodes"),
+				    "node[%04d-%04d]", i, (i + 3));
+		data_set_string(data_key_set(job, "tres_req_str"),
+				"cpu=4,mem=16G,node=4,billing=4");
+		data_set_string(data_key_set(job, "command"),
+				"/home/user/bin/simulation --input=data.in");
+		_add_number(job, "submit_time", (1700000000 + i));
+		_add_number(job, "time_limit", 1440);
+		_add_number(job, "priority", (4294000000 - i));
+		_add_number(job, "cpus", 4);
+		_add_number(job, "memory_per_node", 16384);
+		data_set_float(data_key_set(job, "billable_tres"), (i * 0.25));
+
+		data_set_string_fmt(data_key_set(node, "name"), "node%04d", i);
+		data_set_string(data_key_set(node, "architecture"), "x86_64");
+		list = data_set_list(data_key_set(node, "state"));
+		data_set_string(data_list_append(list), "IDLE");
+		list = data_set_list(data_key_set(node, "partitions"));
+		data_set_string(data_list_append(list), "debug");
+		data_set_string(data_list_append(list), "batch");
+		data_set_int(data_key_set(node, "cpus"), 128);
+		data_set_int(data_key_set(node, "real_memory"), 515000);
+		data_set_float(data_key_set(node, "cpu_load"), (i % 100) * 1.5);
+		_add_number(node, "last_busy", (1700000000 + i));
+	}
+
+	return resp;
+}
+
+START_TEST(test_bandwidth_synthetic)
+{
+	static const int counts[] = { 1000, 10000 };
+	struct rusage ru;
+
+	for (int i = 0; i < ARRAY_SIZE(counts); i++) {
+		data_t *data = _synthetic_dataset(counts[i]);
+
+		for (int m = 0; m < ARRAY_SIZE(mime_types); m++) {
+			const char *mptr = NULL;
+			const char *mime_type =
+				resolve_mime_type(mime_types[m], &mptr);
+			char *source = NULL, *tag = NULL;
+			int rc;
+
+			if (!mime_type) {
+				debug("skipping test with %s", mime_types[m]);
+				continue;
+			}
+
+			rc = serialize_g_data_to_string(&source, NULL, data,
+							mime_type,
+							SER_FLAGS_COMPACT);
+			assert_int_eq(rc, 0);
+
+			tag = xstrdup_printf("synthetic-%d-%s", counts[i],
+					     mime_type);
+			_test_bandwidth_str(tag, source, mime_type, 5);
+
+			xfree(tag);
+			xfree(source);
+		}
+
+		FREE_NULL_DATA(data);
+	}
+
+	if (!getrusage(RUSAGE_SELF, &ru))
+		printf("peak RSS: %ld KiB\n\n", ru.ru_maxrss);
 }
 END_TEST
 
@@ -706,6 +812,7 @@ extern Suite *suite_data(void)
 	tcase_add_test(tc_core, test_parse);
 	tcase_add_test(tc_core, test_compliance);
 	tcase_add_test(tc_core, test_bandwidth);
+	tcase_add_test(tc_core, test_bandwidth_synthetic);
 
 	suite_add_tcase(s, tc_core);
 	return s;
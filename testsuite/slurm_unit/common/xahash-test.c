@@ -38,10 +38,15 @@
 #include "src/common/macros.h"
 #include "src/common/read_config.h"
 #include "src/common/slurm_protocol_defs.h"
+#include "src/common/timers.h"
 #include "src/common/xahash.h"
+#include "src/common/xhash.h"
+#include "src/common/xmalloc.h"
 
 #define FIXED_STATE_ENTRIES 1024
 #define FIXED_STATE_OVERCOMMIT_ENTRIES 512
+#define DYNAMIC_STATE_ENTRIES 100000
+#define BENCH_ENTRIES 200000
 #define KEY_SIZE sizeof(void *)
 
 #define GLOBAL_STATE_MAGIC 0xeae0eef0
@@ -281,6 +286,255 @@ START_TEST(test_fixed_mass)
 }
 END_TEST
 
+START_TEST(test_dynamic_basic)
+{
+	xahash_table_t *ht;
+	global_state_t *gs;
+	state_t *s, *f;
+
+	ht = xahash_new_table(_hash, _match, _on_insert, _on_free,
+			      sizeof(global_state_t), sizeof(state_t), 0);
+	ck_assert_msg(ht != NULL, "hashtable created");
+
+	gs = xahash_get_state_ptr(ht);
+	*gs = (global_state_t) {
+		.magic = GLOBAL_STATE_MAGIC,
+	};
+
+	/* verify we don't find anything in an empty table */
+	ck_assert(!xahash_find_entry(ht, NULL, KEY_SIZE));
+	ck_assert(!xahash_find_entry(ht, &ht, KEY_SIZE));
+	ck_assert(!xahash_free_entry(ht, &ht, KEY_SIZE));
+	ck_assert(xahash_foreach_entry(ht, _foreach, NULL) == 0);
+
+	s = xahash_insert_entry(ht, &s, KEY_SIZE);
+	ck_assert(s->magic == STATE_MAGIC);
+	ck_assert(s->key == &s);
+	ck_assert(s->caller_magic == 0);
+	s->caller_magic = STATE_CALLER_MAGIC;
+
+	/* duplicate insert returns the existing entry */
+	ck_assert(xahash_insert_entry(ht, &s, KEY_SIZE) == s);
+	ck_assert(s->caller_magic == STATE_CALLER_MAGIC);
+
+	f = xahash_find_entry(ht, &s, KEY_SIZE);
+	ck_assert(f == s);
+	ck_assert(f->caller_magic == STATE_CALLER_MAGIC);
+	ck_assert(!xahash_find_entry(ht, &ht, KEY_SIZE));
+	ck_assert(xahash_foreach_entry(ht, _foreach, NULL) == 1);
+
+	ck_assert(xahash_free_entry(ht, &s, KEY_SIZE));
+	ck_assert(!xahash_free_entry(ht, &s, KEY_SIZE));
+	ck_assert(!xahash_find_entry(ht, &s, KEY_SIZE));
+	ck_assert(xahash_foreach_entry(ht, _foreach, NULL) == 0);
+
+	ck_assert(gs == xahash_get_state_ptr(ht));
+	ck_assert(gs->magic == GLOBAL_STATE_MAGIC);
+
+	FREE_NULL_XAHASH_TABLE(ht);
+}
+END_TEST
+
+START_TEST(test_dynamic_mass)
+{
+	global_state_t *gs;
+	xahash_table_t *ht;
+	state_t **s = xcalloc(DYNAMIC_STATE_ENTRIES, sizeof(*s));
+
+	ht = xahash_new_table(_hash, _match, _on_insert, _on_free,
+			      sizeof(global_state_t), sizeof(state_t), 0);
+	gs = xahash_get_state_ptr(ht);
+	*gs = (global_state_t) {
+		.magic = GLOBAL_STATE_MAGIC,
+	};
+
+	/* insert all entries while the table grows */
+	for (int i = 0; i < DYNAMIC_STATE_ENTRIES; i++) {
+		state_t *f = xahash_insert_entry(ht, &s[i], KEY_SIZE);
+
+		ck_assert(f->magic == STATE_MAGIC);
+		ck_assert(f->key == &s[i]);
+		f->caller_magic = i;
+	}
+
+	/* entries are moved on resize so only check them by key */
+	for (int i = 0; i < DYNAMIC_STATE_ENTRIES; i++) {
+		state_t *f = xahash_find_entry(ht, &s[i], KEY_SIZE);
+
+		ck_assert(f != NULL);
+		ck_assert(f->magic == STATE_MAGIC);
+		ck_assert(f->key == &s[i]);
+		ck_assert(f->caller_magic == i);
+	}
+
+	ck_assert(xahash_foreach_entry(ht, _foreach, NULL) ==
+		  DYNAMIC_STATE_ENTRIES);
+
+	/* release every other entry */
+	for (int i = 0; i < DYNAMIC_STATE_ENTRIES; i += 2)
+		ck_assert(xahash_free_entry(ht, &s[i], KEY_SIZE));
+
+	for (int i = 0; i < DYNAMIC_STATE_ENTRIES; i++) {
+		state_t *f = xahash_find_entry(ht, &s[i], KEY_SIZE);
+
+		if (i % 2) {
+			ck_assert(f != NULL);
+			ck_assert(f->caller_magic == i);
+		} else {
+			ck_assert(f == NULL);
+		}
+	}
+
+	ck_assert(xahash_foreach_entry(ht, _foreach, NULL) ==
+		  (DYNAMIC_STATE_ENTRIES / 2));
+
+	/* reuse released slots */
+	for (int i = 0; i < DYNAMIC_STATE_ENTRIES; i += 2) {
+		state_t *f = xahash_insert_entry(ht, &s[i], KEY_SIZE);
+
+		ck_assert(f->key == &s[i]);
+		f->caller_magic = i;
+	}
+
+	for (int i = 0; i < DYNAMIC_STATE_ENTRIES; i++) {
+		state_t *f = xahash_find_entry(ht, &s[i], KEY_SIZE);
+
+		ck_assert(f != NULL);
+		ck_assert(f->caller_magic == i);
+	}
+
+	/* remove all entries */
+	for (int i = 0; i < DYNAMIC_STATE_ENTRIES; i++) {
+		ck_assert(xahash_free_entry(ht, &s[i], KEY_SIZE));
+		ck_assert(!xahash_find_entry(ht, &s[i], KEY_SIZE));
+	}
+
+	ck_assert(xahash_foreach_entry(ht, _foreach, NULL) == 0);
+	ck_assert(gs == xahash_get_state_ptr(ht));
+	ck_assert(gs->magic == GLOBAL_STATE_MAGIC);
+
+	FREE_NULL_XAHASH_TABLE(ht);
+	xfree(s);
+}
+END_TEST
+
+typedef struct {
+	uint32_t key;
+	uint32_t value;
+} bench_entry_t;
+
+static void _bench_xhash_id(void *item, const char **key, uint32_t *key_len)
+{
+	bench_entry_t *e = item;
+
+	*key = (const char *) &e->key;
+	*key_len = sizeof(e->key);
+}
+
+static xahash_hash_t _bench_hash(const void *key, const size_t key_bytes,
+				 void *state)
+{
+	return *(const uint32_t *) key;
+}
+
+static bool _bench_match(void *ptr, const void *key, const size_t key_bytes,
+			 void *state)
+{
+	bench_entry_t *e = ptr;
+
+	return (e->key == *(const uint32_t *) key);
+}
+
+static void _bench_on_insert(void *ptr, const void *key,
+			     const size_t key_bytes, void *state)
+{
+	bench_entry_t *e = ptr;
+
+	e->key = *(const uint32_t *) key;
+	e->value = 0;
+}
+
+static void _bench_print(const char *name, const char *op, long usec)
+{
+	printf("\t%-16s %-8s %d entries: %8ld usec %6.1f nsec/op\n",
+	       name, op, BENCH_ENTRIES, usec,
+	       ((usec * 1000.0) / BENCH_ENTRIES));
+}
+
+static void _bench_xahash(const char *name, size_t fixed_size)
+{
+	DEF_TIMERS;
+	xahash_table_t *ht = xahash_new_table(_bench_hash, _bench_match,
+					      _bench_on_insert, NULL, 0,
+					      sizeof(bench_entry_t),
+					      fixed_size);
+
+	START_TIMER;
+	for (uint32_t i = 0; i < BENCH_ENTRIES; i++) {
+		bench_entry_t *e = xahash_insert_entry(ht, &i, sizeof(i));
+		e->value = i;
+	}
+	END_TIMER3(__func__, INFINITE);
+	_bench_print(name, "insert", DELTA_TIMER);
+
+	START_TIMER;
+	for (uint32_t i = 0; i < BENCH_ENTRIES; i++) {
+		bench_entry_t *e = xahash_find_entry(ht, &i, sizeof(i));
+		ck_assert(e && (e->value == i));
+	}
+	END_TIMER3(__func__, INFINITE);
+	_bench_print(name, "find", DELTA_TIMER);
+
+	START_TIMER;
+	for (uint32_t i = 0; i < BENCH_ENTRIES; i++)
+		ck_assert(xahash_free_entry(ht, &i, sizeof(i)));
+	END_TIMER3(__func__, INFINITE);
+	_bench_print(name, "remove", DELTA_TIMER);
+
+	FREE_NULL_XAHASH_TABLE(ht);
+}
+
+static void _bench_xhash(void)
+{
+	DEF_TIMERS;
+	xhash_t *ht = xhash_init(_bench_xhash_id, xfree_ptr);
+
+	START_TIMER;
+	for (uint32_t i = 0; i < BENCH_ENTRIES; i++) {
+		bench_entry_t *e = xmalloc(sizeof(*e));
+		e->key = e->value = i;
+		xhash_add(ht, e);
+	}
+	END_TIMER3(__func__, INFINITE);
+	_bench_print("xhash", "insert", DELTA_TIMER);
+
+	START_TIMER;
+	for (uint32_t i = 0; i < BENCH_ENTRIES; i++) {
+		bench_entry_t *e = xhash_get(ht, (char *) &i, sizeof(i));
+		ck_assert(e && (e->value == i));
+	}
+	END_TIMER3(__func__, INFINITE);
+	_bench_print("xhash", "find", DELTA_TIMER);
+
+	START_TIMER;
+	for (uint32_t i = 0; i < BENCH_ENTRIES; i++)
+		xhash_delete(ht, (char *) &i, sizeof(i));
+	END_TIMER3(__func__, INFINITE);
+	_bench_print("xhash", "remove", DELTA_TIMER);
+	ck_assert(!xhash_count(ht));
+
+	xhash_free(ht);
+}
+
+START_TEST(test_benchmark)
+{
+	printf("xahash benchmark:\n");
+	_bench_xhash();
+	_bench_xahash("xahash fixed", BENCH_ENTRIES);
+	_bench_xahash("xahash dynamic", 0);
+}
+END_TEST
+
 Suite *suite_xahash(void)
 {
 	Suite *s = suite_create("xahash");
@@ -288,6 +542,9 @@ Suite *suite_xahash(void)
 
 	tcase_add_test(tc_core, test_fixed_basic);
 	tcase_add_test(tc_core, test_fixed_mass);
+	tcase_add_test(tc_core, test_dynamic_basic);
+	tcase_add_test(tc_core, test_dynamic_mass);
+	tcase_add_test(tc_core, test_benchmark);
 
 	suite_add_tcase(s, tc_core);
 	return s;